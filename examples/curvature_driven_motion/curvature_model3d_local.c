@@ -23,6 +23,8 @@
 #include "lsm_reinitialization3d_local.h"
 #include "lsm_geometry3d.h"
 #include "lsm_localization3d.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_anderson.h"
 
 /* LSMLIB Serial package headers */
 #include "lsm_boundary_conditions.h"
@@ -41,7 +43,19 @@
 #define AVE_GRAD_PHI_MIN 0.9
 #define AVE_GRAD_PHI_MAX 1.1
 
-static unsigned char mark_gb=127, mark_D1=126, mark_D2=125, mark_fb=124;
+/* narrow band marks (boundary layer bits are set by determineNarrowBand3d) */
+static unsigned char mark_D1=LSM_NB_MARK_D1, mark_D2=LSM_NB_MARK_D2,
+                     mark_fb=LSM_NB_MARK_FB;
+
+static void computeCurvatureModelRhs3dLocal(
+     LSMLIB_REAL      *phi,
+     LSM_DataArrays   *data_arrays,
+     Grid             *grid,
+     Options          *options,
+     LSMLIB_REAL      beta,
+     LSMLIB_REAL      gamma,
+     LSMLIB_REAL      dt_corr,
+     LSMLIB_REAL      *dt);
  
 /* 
 *  Main loop for localized constant curvature level set method model in 3D.
@@ -56,16 +70,14 @@ void curvatureModelMedium3dLocalMainLoop(
      Grid             *grid,
      FILE             *fp_out)
 {
-  LSMLIB_REAL   cfl_number = 0.5;
-  
   /* time variables */
-  LSMLIB_REAL   t, dt, dt_sub, max_H, dt_corr;
+  LSMLIB_REAL   t, dt, dt_stage2, dt_sub, dt_corr;
   LSMLIB_REAL   tplot, dt_min, dt_max;
   
   LSMLIB_REAL   max_abs_err, eps, eps_stop;
  
   LSMLIB_REAL   zero = 0.0;
-  LSMLIB_REAL   vel_n, vol_phi, vol_max, vol_phi_prev, rel_vol_diff;
+  LSMLIB_REAL   vol_phi, vol_max, vol_phi_prev, rel_vol_diff;
   int      i, nx, nxy;  
   
   int      bdry_location_idx = 9; /* extrapolate all boundaries */
@@ -81,7 +93,7 @@ void curvatureModelMedium3dLocalMainLoop(
    
   /* variables specific for localization */
   LSMLIB_REAL   beta, gamma;
-  int      nlo_index, nhi_index, level; 
+  int      level; 
   
   LSMLIB_REAL   frac_nb, last_reinit_time, grad_phi_ave;  
   int      nb_level0, nb_level1, nb_level2;
@@ -161,8 +173,6 @@ void curvatureModelMedium3dLocalMainLoop(
   reinitializeMedium3d(d,g,o,gamma + g->dx[0]); 	 
 
   /* localization - allocated number of index points array elements */
-  nlo_index = 0; 
-  nhi_index = g->num_gridpts - 1;
   nlo_index_outer = 0;
   nhi_index_outer = d->num_alloc_index_outer_pts-1;
   
@@ -187,202 +197,16 @@ void curvatureModelMedium3dLocalMainLoop(
       TOTAL_STEP++;
       
        /* localization : determine T0 */	   
-      LSM3D_DETERMINE_NARROW_BAND(d->phi,
-           &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
-	   d->narrow_band,
-	   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
+      determineNarrowBand3d(d->phi, d->narrow_band,
 	   d->index_x, d->index_y, d->index_z,
-	   &nlo_index, &nhi_index,	   
-	   d->n_lo,d->n_hi,
-	   d->index_outer_pts,
-	   &nlo_index_outer, &nhi_index_outer,
+	   d->n_lo, d->n_hi,
+	   d->index_outer_pts, d->num_alloc_index_outer_pts,
 	   &(d->nlo_outer_plus),  &(d->nhi_outer_plus),
 	   &(d->nlo_outer_minus), &(d->nhi_outer_minus),
-           &gamma,&beta,&level);
-	   
-     
-      /* mark boundary layers in narrow_band array 
-      *  These layer marks to be used in Fortran functions for checking if the
-      *	 point is in the correct fill box.
-     */     	   	   
-      LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER(d->narrow_band,
-       	   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
-	   &(g->ilo_D2_fb), &(g->ihi_D2_fb), &(g->jlo_D2_fb), &(g->jhi_D2_fb),
-           &(g->klo_D2_fb), &(g->khi_D2_fb),
-	   &mark_D2);
-	   
-      LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER(d->narrow_band,
-       	   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
-	   &(g->ilo_D1_fb), &(g->ihi_D1_fb), &(g->jlo_D1_fb), &(g->jhi_D1_fb),
-           &(g->klo_D1_fb), &(g->khi_D1_fb),
-	   &mark_D1);
-	   
-      LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER(d->narrow_band,
-       	   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
-	   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-           &(g->klo_gb), &(g->khi_gb),
-	   &mark_gb);	   	   
-	   
-      LSM3D_ZERO_OUT_LEVEL_SET_EQN_RHS_LOCAL(d->lse_rhs,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-                    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0]);
-     
-      if(o->a > 0)
-      {  
-         /* Compute upwinding gradient approximations */ 
-          LSM3D_HJ_ENO2_LOCAL(d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-                    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->D1,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->D2,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    &(d->n_lo)[1],&(d->n_hi)[1],
-		    &(d->n_lo)[2],&(d->n_hi)[2],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb,&mark_D1,&mark_D2); 
-	 
-	 vel_n = o->a;
-	 
-	 LSM3D_ADD_CONST_NORMAL_VEL_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &vel_n,
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],		    
-                    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb);
-                  
-	 /* figure out time spacing for hyperbolic term */
-	 LSM3D_COMPUTE_STABLE_CONST_NORMAL_VEL_DT_LOCAL(&dt,&vel_n,
-		    d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x_minus, d->phi_y_minus,  d->phi_z_minus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),		    
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),&cfl_number,
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],		    
-                    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),	
-		    &mark_fb);  
-      }
-      else dt = tplot;
-     
-      if( o->b > 0)
-      {
-	/* Compute derivatives needed for curvature */	
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_x, d->phi_y, d->phi_z,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z, 
-		    &(d->n_lo)[0],&(d->n_hi)[1],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D1);	
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xx, d->phi_xy, d->phi_xz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z, 
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);		
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xy, d->phi_yy, d->phi_yz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_y,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);	
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xz, d->phi_yz, d->phi_zz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_z,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);
-		    
-	LSM3D_ADD_CONST_CURV_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
-	            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x,d->phi_y,d->phi_z,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_xx,d->phi_xy,d->phi_xz,
-		    d->phi_yy,d->phi_yz,d->phi_zz,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &(o->b),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0], &(d->n_hi)[0],
-                    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb);
-		    	
-	/* correct dt due to parabolic (curvature) term */
-        if( o->a > 0 )
-	   max_H = cfl_number / dt;
-	else 
-	   max_H = 0;
+	   gamma, beta, level, g);
 	   
-	dt =  cfl_number / (max_H + dt_corr);
-      }	    
-
-      if( dt < DT_MIN_TO_CORRECT ) dt = DT_MIN; 
+      computeCurvatureModelRhs3dLocal(d->phi,d,g,o,beta,gamma,dt_corr,&dt);
+      if( (o->a <= 0) && (o->b <= 0) ) dt = tplot;
        
       if(dt_sub + dt > tplot) 
       {
@@ -393,18 +217,6 @@ void curvatureModelMedium3dLocalMainLoop(
       if(dt > dt_max) dt_max = dt;
       if(dt < dt_min) dt_min = dt;
       
-      /* localization: modify equation by a cut-off function */
-      LSM3D_MULTIPLY_CUT_OFF_LSE_RHS_LOCAL(d->phi, d->lse_rhs,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb,
-		    &beta,&gamma);
-      
       LSM3D_TVD_RK2_STAGE1_LOCAL(d->phi_stage1,
                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
 		   &(g->klo_gb), &(g->khi_gb),
@@ -428,190 +240,57 @@ void curvatureModelMedium3dLocalMainLoop(
       /* masking enforced so that the interface stays within pore space */
       if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi_stage1,d->mask,d->phi_stage1,g,d);       
 
-      LSM3D_ZERO_OUT_LEVEL_SET_EQN_RHS_LOCAL(d->lse_rhs,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-                    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[2]);  
+      computeCurvatureModelRhs3dLocal(d->phi_stage1,d,g,o,beta,gamma,dt_corr,
+                                      &dt_stage2);
+		    
+      LSM3D_TVD_RK2_STAGE2_LOCAL(d->phi_next,
+                   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->phi_stage1,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->phi,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->lse_rhs,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &dt,
+		   d->index_x, d->index_y, d->index_z,
+		   &(d->n_lo)[0],&(d->n_hi)[0],
+		   d->narrow_band,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &mark_fb);
+        
+      /* boundary conditions */
+       signedLinearExtrapolationBC(d->phi_next,g,bdry_location_idx);	 
+           
+      /* masking enforced so that the interface stays within pore space */
+      if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi,d->mask,d->phi_next,g,d)
+      else           COPY_DATA(d->phi,d->phi_next,g)
+           
+      /* localization : check if the sign of the level set function
+                       changes in the outer layer of the narrow band
+		       where  gamma > |phi| >= beta  */
+      LSM3D_CHECK_OUTER_NARROW_BAND_LAYER(&change_sgn,
+            d->phi,
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            &(g->klo_gb), &(g->khi_gb),
+            d->index_x, d->index_y, d->index_z,
+            &(d->n_lo)[0],&(d->n_hi)[0],
+            d->index_outer_pts,
+	    &nlo_index_outer, &nhi_index_outer,
+	    &(d->nlo_outer_plus),  &(d->nhi_outer_plus),
+	    &(d->nlo_outer_minus), &(d->nhi_outer_minus));      
       
-      if(o->a)
-      {
-	  LSM3D_HJ_ENO2_LOCAL(d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-                    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_stage1,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->D1,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->D2,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    &(d->n_lo)[1],&(d->n_hi)[1],
-		    &(d->n_lo)[2],&(d->n_hi)[2],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb,&mark_D1,&mark_D2);   
-		        
-	 LSM3D_ADD_CONST_NORMAL_VEL_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &vel_n,
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],		    
-                    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb);	    
-      }
-      
-      if( o->b )
-      {       
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_x,d->phi_y,d->phi_z,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_stage1,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[1],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D1);		
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xx,d->phi_xy,d->phi_xz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);		
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xy,d->phi_yy,d->phi_yz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_y,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);	
-	LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xz, d->phi_yz, d->phi_zz,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_z,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_D2);
-
-	LSM3D_ADD_CONST_CURV_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
-	            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_x,d->phi_y,d->phi_z,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->phi_xx,d->phi_xy,d->phi_xz,
-		    d->phi_yy,d->phi_yz,d->phi_zz,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &(o->b),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0], &(d->n_hi)[0],
-                    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb);
-      }     
-     
-      /* localization: modify equation by a cut-off function */
-      LSM3D_MULTIPLY_CUT_OFF_LSE_RHS_LOCAL(d->phi_stage1, d->lse_rhs,
-                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    d->index_x, d->index_y, d->index_z,
-		    &(d->n_lo)[0],&(d->n_hi)[0],		    
-		    d->narrow_band,
-		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		    &(g->klo_gb), &(g->khi_gb),
-		    &mark_fb,&beta,&gamma);
-		    
-      LSM3D_TVD_RK2_STAGE2_LOCAL(d->phi_next,
-                   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		   &(g->klo_gb), &(g->khi_gb),
-		   d->phi_stage1,
-		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		   &(g->klo_gb), &(g->khi_gb),
-		   d->phi,
-		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		   &(g->klo_gb), &(g->khi_gb),
-		   d->lse_rhs,
-		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		   &(g->klo_gb), &(g->khi_gb),
-		   &dt,
-		   d->index_x, d->index_y, d->index_z,
-		   &(d->n_lo)[0],&(d->n_hi)[0],
-		   d->narrow_band,
-		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-		   &(g->klo_gb), &(g->khi_gb),
-		   &mark_fb);
-        
-      /* boundary conditions */
-       signedLinearExtrapolationBC(d->phi_next,g,bdry_location_idx);	 
-           
-      /* masking enforced so that the interface stays within pore space */
-      if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi,d->mask,d->phi_next,g,d)
-      else           COPY_DATA(d->phi,d->phi_next,g)
-           
-      /* localization : check if the sign of the level set function
-                       changes in the outer layer of the narrow band
-		       where  gamma > |phi| >= beta  */
-      LSM3D_CHECK_OUTER_NARROW_BAND_LAYER(&change_sgn,
-            d->phi,
-            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
-            &(g->klo_gb), &(g->khi_gb),
-            d->index_x, d->index_y, d->index_z,
-            &(d->n_lo)[0],&(d->n_hi)[0],
-            d->index_outer_pts,
-	    &nlo_index_outer, &nhi_index_outer,
-	    &(d->nlo_outer_plus),  &(d->nhi_outer_plus),
-	    &(d->nlo_outer_minus), &(d->nhi_outer_minus));      
-      
-      if(change_sgn)
-      {  /* if the sign changed, the interface is close to the narrow
-            band border so reinitialization needs to be triggerred */
-         reinit_trigger = 1;
-	 change_sgn_steps++; 
-      }	 
-      else
+      if(change_sgn)
+      {  /* if the sign changed, the interface is close to the narrow
+            band border so reinitialization needs to be triggerred */
+         reinit_trigger = 1;
+	 change_sgn_steps++; 
+      }	 
+      else
       {
          /* localization : compute the average value of the norm
 	 of the gradient */	  
@@ -932,3 +611,494 @@ void reinitializeMedium3dLocal(
     }
 }	 
 
+
+
+/* 
+*  computeCurvatureModelRhs3dLocal() computes the right hand side of the
+*  (cut-off) level set equation  phi_t + a |grad_phi| = b kappa |grad_phi|
+*  for phi in the narrow band and the stable time step.
+*  
+*  Arguments:
+*   phi          - level set function
+*   data_arrays  - LSMLIB Serial package data arrays structure (lse_rhs
+*                  holds the result, derivative arrays are used as work space)
+*   grid         - LSMLIB Serial package Grid structure
+*   options      - (local) Options structure; 'a' and 'b' are used
+*   beta, gamma  - narrow band cut-off parameters
+*   dt_corr      - time step correction due to the curvature term
+*   dt           - (out) stable time step
+*     
+*/
+
+static void computeCurvatureModelRhs3dLocal(
+     LSMLIB_REAL      *phi,
+     LSM_DataArrays   *data_arrays,
+     Grid             *grid,
+     Options          *options,
+     LSMLIB_REAL      beta,
+     LSMLIB_REAL      gamma,
+     LSMLIB_REAL      dt_corr,
+     LSMLIB_REAL      *dt)
+{
+  LSMLIB_REAL   cfl_number = 0.5;
+  LSMLIB_REAL   vel_n, max_H;
+  
+  /* writing shortcuts */
+  Grid             *g = grid;
+  LSM_DataArrays   *d = data_arrays;
+  Options          *o = options;
+  
+  LSM3D_ZERO_OUT_LEVEL_SET_EQN_RHS_LOCAL(d->lse_rhs,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+                    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0]);
+  *dt = 0;
+  
+  if(o->a > 0)
+  {  
+      LSM3D_HJ_ENO2_LOCAL(d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+                    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    phi,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->D1,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->D2,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],
+		    &(d->n_lo)[1],&(d->n_hi)[1],
+		    &(d->n_lo)[2],&(d->n_hi)[2],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_fb,&mark_D1,&mark_D2); 
+	 
+      vel_n = o->a;
+	 
+      LSM3D_ADD_CONST_NORMAL_VEL_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_x_minus, d->phi_y_minus, d->phi_z_minus,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &vel_n,
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],		    
+                    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_fb);
+                  
+      LSM3D_COMPUTE_STABLE_CONST_NORMAL_VEL_DT_LOCAL(dt,&vel_n,
+		    d->phi_x_plus, d->phi_y_plus, d->phi_z_plus,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_x_minus, d->phi_y_minus,  d->phi_z_minus,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),		    
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),&cfl_number,
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],		    
+                    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),	
+		    &mark_fb);  
+  }
+     
+  if( o->b > 0)
+  {
+      LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_x, d->phi_y, d->phi_z,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    phi,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+		    d->index_x, d->index_y, d->index_z, 
+		    &(d->n_lo)[0],&(d->n_hi)[1],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_D1);	
+      LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xx, d->phi_xy, d->phi_xz,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_x,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+		    d->index_x, d->index_y, d->index_z, 
+		    &(d->n_lo)[0],&(d->n_hi)[0],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_D2);		
+      LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xy, d->phi_yy, d->phi_yz,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_y,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_D2);	
+      LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(d->phi_xz, d->phi_yz, d->phi_zz,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_z,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_D2);
+		    
+      LSM3D_ADD_CONST_CURV_TERM_TO_LSE_RHS_LOCAL(d->lse_rhs,
+	            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_x,d->phi_y,d->phi_z,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->phi_xx,d->phi_xy,d->phi_xz,
+		    d->phi_yy,d->phi_yz,d->phi_zz,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &(o->b),
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0], &(d->n_hi)[0],
+                    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_fb);
+		    	
+      /* correct dt due to parabolic (curvature) term */
+      max_H = ( o->a > 0 ) ? cfl_number / (*dt) : 0;
+      *dt =  cfl_number / (max_H + dt_corr);
+  }	    
+
+  if( *dt < DT_MIN_TO_CORRECT ) *dt = DT_MIN; 
+      
+  /* localization: modify equation by a cut-off function */
+  LSM3D_MULTIPLY_CUT_OFF_LSE_RHS_LOCAL(phi, d->lse_rhs,
+                    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    d->index_x, d->index_y, d->index_z,
+		    &(d->n_lo)[0],&(d->n_hi)[0],
+		    d->narrow_band,
+		    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		    &(g->klo_gb), &(g->khi_gb),
+		    &mark_fb,
+		    &beta,&gamma);
+}
+
+
+
+/* 
+*  reinitializeWideBand3dLocal() reinitializes the level set function on 
+*  the level 0 and level 1 narrow band (tube T0 plus its first neighbors).
+*/
+
+static void reinitializeWideBand3dLocal(
+     LSM_DataArrays *data_arrays,
+     Grid           *grid,
+     Options        *options,
+     LSMLIB_REAL         tmax_r)
+{
+   LSM_DataArrays   *d = data_arrays;
+   int      i, n_lo_copy[6], n_hi_copy[6];
+   
+   for(i = 0; i < 6; i++)
+   {
+     n_lo_copy[i] = d->n_lo[i];    n_hi_copy[i] = d->n_hi[i];
+   }
+   
+   /* shift limits in order to reinitialize on wider narrow band */
+   d->n_hi[0] = d->n_hi[1];
+   d->n_lo[1] = d->n_lo[2];   d->n_hi[1] = d->n_hi[2];
+   d->n_lo[2] = d->n_lo[3];   d->n_hi[2] = d->n_hi[3];
+	 
+   reinitializeMedium3dLocal(d,grid,options,tmax_r);
+   
+   /* copy old limit values back */
+   for(i = 0; i < 6; i++)
+   {
+      d->n_lo[i] = n_lo_copy[i];  d->n_hi[i] = n_hi_copy[i];
+   }
+}
+
+
+/* 
+*  Steady state solver for the localized constant curvature model in 3D.
+*
+*  The time stepping loop stops when max|phi(t) - phi(t-TPLOT)| in the narrow
+*  band is small, i.e. it looks for a fixed point of the map
+*
+*     G(phi) = reinitialization of phi advanced by TPLOT
+*
+*  (only the zero level set is steady; the other level sets keep moving 
+*  between reinitializations, so G includes the reinitialization).  Here the 
+*  fixed-point iteration phi <- G(phi) is accelerated by Anderson mixing of 
+*  the last options->anderson_depth iterates (see lsm_anderson.h), which 
+*  typically reaches the same stopping criterion in fewer TPLOT intervals.
+*
+*  Iterations stop when max|G(phi) - phi| < EMAX_STOP*dx, the criterion of
+*  the time stepping loop, or when the total pseudo-time reaches tmax.
+*/
+
+void curvatureModelMedium3dLocalSteadyState(
+     Options          *options,
+     LSM_DataArrays   *data_arrays,
+     Grid             *grid,
+     FILE             *fp_out)
+{
+  /* pseudo-time variables */
+  LSMLIB_REAL   t, dt, dt_stage2, dt_sub, dt_corr, tplot;
+  
+  LSMLIB_REAL   max_abs_err, eps_stop;
+  LSMLIB_REAL   eps, vol_phi, vol_max;
+  int      nx, nxy;
+  
+  int      bdry_location_idx = 9; /* extrapolate all boundaries */
+  
+  int      OUTER_STEP, TOTAL_STEP, reinit_steps;
+  
+  /* writing shortcuts */
+  Grid             *g = grid;
+  LSM_DataArrays   *d = data_arrays;
+  Options          *o = options;
+   
+  /* variables specific for localization */
+  LSMLIB_REAL   beta, gamma, grad_phi_ave;
+  int      level, change_sgn;
+  int      nlo_index_outer, nhi_index_outer;
+  
+  LSM_AndersonAcceleration *acc;
+  
+  eps_stop = EMAX_STOP*(g->dx)[0];
+  if( options->print_details)
+  {    
+    fprintf(fp_out,"\nSteady state solve, Anderson depth %d\n",
+                                                            o->anderson_depth);
+    fprintf(fp_out,"TPLOT %g eps_stop %g set internally\n",TPLOT,eps_stop);
+    fprintf(fp_out,"Iterations continue until the pseudo-time tmax is reached\n"); 
+    fprintf(fp_out,"or max.abs.error for G(phi) - phi is less than eps_stop,\n");
+    fprintf(fp_out,"where G advances phi by TPLOT and reinitializes it.\n");
+    fprintf(fp_out,"-----------------------------------------------------\n");
+  }
+  
+  acc = createAndersonAcceleration(g->num_gridpts,o->anderson_depth,1.0);
+  if( !acc )
+  {
+    fprintf(fp_out,"\nCould not allocate Anderson acceleration.\n");
+    return;
+  }
+  
+  /* correction for time spacing due to parabolic (curvature) term */
+  dt_corr = 1.0/((g->dx)[0]*(g->dx)[0]) + 1.0/((g->dx)[1]*(g->dx)[1]) + 
+            1.0/((g->dx)[2]*(g->dx)[2]);
+  dt_corr *= 2.0*o->b;
+  
+  eps = 1.5*(g->dx[0]);
+  nx = (g->grid_dims_ghostbox)[0];
+  nxy = (g->grid_dims_ghostbox)[0]*(g->grid_dims_ghostbox)[1];
+  
+  LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO(&vol_max,
+	        d->mask,
+		&(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		&(g->klo_gb), &(g->khi_gb),
+		&(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+		&(g->klo_fb), &(g->khi_fb),
+		&(g->dx[0]),&(g->dx[1]),&(g->dx[2]),
+		&eps);
+  
+  tplot = (TPLOT < o->tmax ) ? TPLOT : o->tmax;
+  
+  /* localization: narrow band parameters as in the time stepping loop */
+  beta = 2*(g->dx)[0]; gamma = 4*(g->dx)[0];
+  level = 3; 
+  
+  reinitializeMedium3d(d,g,o,gamma + g->dx[0]); 	 
+
+  nlo_index_outer = 0;
+  nhi_index_outer = d->num_alloc_index_outer_pts-1;
+  
+  t = 0;
+  OUTER_STEP = TOTAL_STEP = reinit_steps = 0;
+  max_abs_err = 1000.0;
+  
+  while( (t < o->tmax) && (max_abs_err > eps_stop) )
+  {  /* one fixed-point iteration:  phi_prev = phi, phi = G(phi) */
+    OUTER_STEP++;
+    dt_sub = 0;
+    
+    COPY_DATA(d->phi_prev,d->phi,g)
+    
+    while( dt_sub < tplot )
+    {
+      TOTAL_STEP++;
+      
+      determineNarrowBand3d(d->phi, d->narrow_band,
+	   d->index_x, d->index_y, d->index_z,
+	   d->n_lo, d->n_hi,
+	   d->index_outer_pts, d->num_alloc_index_outer_pts,
+	   &(d->nlo_outer_plus),  &(d->nhi_outer_plus),
+	   &(d->nlo_outer_minus), &(d->nhi_outer_minus),
+	   gamma, beta, level, g);
+      
+      computeCurvatureModelRhs3dLocal(d->phi,d,g,o,beta,gamma,dt_corr,&dt);
+      if(dt_sub + dt > tplot) dt = tplot - dt_sub;
+      
+      LSM3D_TVD_RK2_STAGE1_LOCAL(d->phi_stage1,
+                   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->phi,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->lse_rhs,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &dt,
+		   d->index_x, d->index_y, d->index_z,
+		   &(d->n_lo)[0],&(d->n_hi)[0],
+		   d->narrow_band,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &mark_fb);	
+      signedLinearExtrapolationBC(d->phi_stage1,g,bdry_location_idx);
+      if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi_stage1,d->mask,d->phi_stage1,g,d);       
+      
+      computeCurvatureModelRhs3dLocal(d->phi_stage1,d,g,o,beta,gamma,dt_corr,
+                                      &dt_stage2);
+      
+      LSM3D_TVD_RK2_STAGE2_LOCAL(d->phi_next,
+                   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->phi_stage1,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->phi,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   d->lse_rhs,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &dt,
+		   d->index_x, d->index_y, d->index_z,
+		   &(d->n_lo)[0],&(d->n_hi)[0],
+		   d->narrow_band,
+		   &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+		   &(g->klo_gb), &(g->khi_gb),
+		   &mark_fb);
+      signedLinearExtrapolationBC(d->phi_next,g,bdry_location_idx);	 
+      if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi,d->mask,d->phi_next,g,d)
+      else           COPY_DATA(d->phi,d->phi_next,g)
+      
+      /* localization : reinitialize if the interface reached the outer
+                        layer of the narrow band */
+      LSM3D_CHECK_OUTER_NARROW_BAND_LAYER(&change_sgn,
+            d->phi,
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            &(g->klo_gb), &(g->khi_gb),
+            d->index_x, d->index_y, d->index_z,
+            &(d->n_lo)[0],&(d->n_hi)[0],
+            d->index_outer_pts,
+	    &nlo_index_outer, &nhi_index_outer,
+	    &(d->nlo_outer_plus),  &(d->nhi_outer_plus),
+	    &(d->nlo_outer_minus), &(d->nhi_outer_minus));      
+      if(change_sgn)
+      {
+         reinitializeWideBand3dLocal(d,g,o,gamma + 2*g->dx[0]);
+         reinit_steps++;
+      }
+      
+      dt_sub = dt_sub + dt;
+    }
+    t = t + dt_sub;
+    
+    /* G includes reinitialization */
+    reinitializeWideBand3dLocal(d,g,o,gamma + 2*g->dx[0]);
+    reinit_steps++;
+    
+    LSM3D_MAX_NORM_DIFF_LOCAL(&max_abs_err,d->phi,
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+	    &(g->klo_gb), &(g->khi_gb),
+	    d->phi_prev,
+	    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+	    &(g->klo_gb), &(g->khi_gb),
+	    d->index_x, d->index_y, d->index_z,
+            &(d->n_lo)[0],&(d->n_hi)[0],
+            d->narrow_band,
+	    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            &(g->klo_gb), &(g->khi_gb),	
+            &mark_fb);
+    
+    if( max_abs_err > eps_stop )
+    {
+       /* Anderson update:  phi_prev is the iterate, phi = G(phi_prev); 
+          values outside of the narrow band do not change */
+       applyAndersonAcceleration(acc,d->phi_prev,d->phi,g->num_gridpts);
+       COPY_DATA(d->phi,d->phi_prev,g)
+       signedLinearExtrapolationBC(d->phi,g,bdry_location_idx);
+       if(o->do_mask) IMPOSE_MASK_LOCAL(d->phi,d->mask,d->phi,g,d)
+       
+       /* extrapolated iterate may be far from a distance function */
+       LSM3D_COMPUTE_AVE_GRAD_PHI_LOCAL(&grad_phi_ave,
+	      d->phi,
+              &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+              &(g->klo_gb), &(g->khi_gb),	 
+              &((g->dx)[0]),&((g->dx)[1]),&((g->dx)[2]),
+              d->index_x, d->index_y, d->index_z,
+              &(d->n_lo)[0],&(d->n_hi)[0],
+              d->narrow_band,
+              &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+	      &(g->klo_gb), &(g->khi_gb),
+	      &mark_fb);
+       if(( grad_phi_ave < AVE_GRAD_PHI_MIN ) || 
+	  ( grad_phi_ave > AVE_GRAD_PHI_MAX ))
+       {
+	  reinitializeWideBand3dLocal(d,g,o,gamma + 2*g->dx[0]);
+          reinit_steps++;
+       }
+    }
+    
+    LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO(&vol_phi,
+	    d->phi,
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+	    &(g->klo_gb), &(g->khi_gb),
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            &(g->klo_gb), &(g->khi_gb),
+            &(g->dx[0]),&(g->dx[1]),&(g->dx[2]),
+	    &eps);
+    printf("Iteration %d pseudo-time %g, max. abs. error %g\n",
+                                                  OUTER_STEP,t,max_abs_err);
+    fprintf(fp_out,"Iteration %d pseudo-time %g, max. abs. error %g\n",
+                                                  OUTER_STEP,t,max_abs_err);
+    fprintf(fp_out," vol_phi %g vol_frac %g\n",vol_phi,vol_phi/vol_max);
+    fflush(stdout); fflush(fp_out);
+  }
+  
+  fprintf(fp_out,"\nIterations %d  Total steps %d  Reinit. steps %d\n",
+                                        OUTER_STEP,TOTAL_STEP,reinit_steps);
+  fflush(fp_out);
+  
+  destroyAndersonAcceleration(acc);
+}
@@ -11,6 +11,7 @@
 #define INCLUDED_CURV_MODEL3D_LOCAL_H
 
 void  curvatureModelMedium3dLocalMainLoop(Options *,LSM_DataArrays  *,Grid  *,FILE *);
+void  curvatureModelMedium3dLocalSteadyState(Options *,LSM_DataArrays  *,Grid  *,FILE *);
 void  reinitializeMedium3dLocal(LSM_DataArrays *,Grid *,Options *,LSMLIB_REAL);
 
 #endif
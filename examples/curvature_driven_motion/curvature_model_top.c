@@ -135,7 +135,9 @@ int  curvatureModelTop(
   /* Run the curvature model, only 3d supported so far */
   if( grid->num_dims == 3 )
   {
-    if(options->narrow_band)
+    if(options->narrow_band && options->anderson_depth)
+      curvatureModelMedium3dLocalSteadyState(options,data_arrays,grid,fp_out);
+    else if(options->narrow_band)
       curvatureModelMedium3dLocalMainLoop(options,data_arrays,grid,fp_out);
     else
       curvatureModelMedium3dMainLoop(options,data_arrays,grid,fp_out);								
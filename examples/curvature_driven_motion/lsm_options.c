@@ -16,6 +16,7 @@
 
 #include "lsm_options.h"
 #include "lsm_grid.h"
+#include "lsm_anderson.h"
 
 
 #define DSZ sizeof(LSMLIB_REAL)
@@ -68,6 +69,7 @@ Options *createOptionsDefault(void)
   options->do_mask = 1;
 
   options->narrow_band = 0;
+  options->anderson_depth = 0;
   
   /* User additions */
   
@@ -103,6 +105,7 @@ Options *copyOptions(Options *options_src)
   options->do_mask = options_src->do_mask;	
 
   options->narrow_band = options_src->narrow_band;
+  options->anderson_depth = options_src->anderson_depth;
   
   /* User additions */
   
@@ -144,7 +147,7 @@ Options *createOptionsFromInputFile(char *filename)
      /* Main part of the structure */
 
     if ( c == 'a' )
-    { /* could be 'a' or 'accuracy' */
+    { /* could be 'a', 'accuracy' or 'anderson_depth' */
       if ( tolower(line[n+1]) == 'c' )
       {
         sscanf(line+n,"accuracy %s",word);
@@ -167,6 +170,17 @@ Options *createOptionsFromInputFile(char *filename)
           printf("\nAccuracy type %s not found, set to default.",word);
         }
       }
+      else if ( tolower(line[n+1]) == 'n' )
+      {
+        sscanf(line+n,"%*s %d ",&tmp1);
+        if ( (tmp1 >= 0) && (tmp1 <= LSM_ANDERSON_MAX_DEPTH) )
+          options->anderson_depth = tmp1;
+        else
+        {
+          printf("\nIncorrect anderson_depth option %d, set to default.\n",
+                                                                    tmp1);
+        }
+      }
       else
       {
         sscanf(line+n,"%*s %lf ",&tmp);
@@ -302,7 +316,9 @@ void  printOptions(Options *options,FILE *fp)
   fprintf(fp,"  do_mask   %8d  [ impose mask (1) or not (0)]\n",
                                                               options->do_mask);
   fprintf(fp,"  narrow_band   %4d [ apply narrow banding (1) or not (0)]\n",
-                                                          options->narrow_band);							      							    
+                                                          options->narrow_band);
+  fprintf(fp,"  anderson_depth %3d [ steady state solve depth (0 - time stepping)]\n",
+                                                       options->anderson_depth);							      							    
 
   /* User additions */
   fprintf(fp,"  print_details %4d [ print details (1) or not (0)   ]\n",
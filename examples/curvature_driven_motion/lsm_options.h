@@ -67,6 +67,10 @@ typedef struct _Options
 			   LSM_DataArrays structure */
 			   
    int    narrow_band;      /* use narrow banding or no */			   
+   int    anderson_depth;   /* 0 - time stepping; > 0 - solve for the
+                               steady state by Anderson accelerated
+                               pseudo-time stepping using this depth
+                               (narrow banding only) */
    
    /* User additions */
    
@@ -0,0 +1,466 @@
+/*
+ * File:        lsm_cxx.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header-only C++17 interface to LSMLIB kernels
+ */
+
+#ifndef included_lsm_cxx_h
+#define included_lsm_cxx_h
+
+#if !defined(__cplusplus) || (__cplusplus < 201703L)
+#error "lsm_cxx.h requires C++17"
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "lsmlib_config.h"
+#include "lsm_fast_marching_method.h"
+#include "lsm_grid.h"
+#include "lsm_spatial_derivatives2d.h"
+#include "lsm_spatial_derivatives3d.h"
+#include "lsm_tvd_runge_kutta2d.h"
+#include "lsm_tvd_runge_kutta3d.h"
+
+/*! \file lsm_cxx.h
+ *
+ * \brief
+ * @ref lsm_cxx.h provides a header-only C++17 interface to a subset of
+ * the LSMLIB kernels with the dimension and the floating-point type as
+ * template parameters.
+ *
+ * - lsm::Grid<Dim> holds the index space (ghostbox and fillbox) and
+ *   grid spacing of a C Grid.
+ *
+ * - lsm::Field<T,Dim> is a non-owning view of a ghostboxed array with
+ *   the same memory layout as the arrays used by the C API (first index
+ *   varying fastest).
+ *
+ * - Each kernel comes in two forms.  The field form (e.g. hj_eno2())
+ *   processes the whole fillbox; when T is LSMLIB_REAL it calls the
+ *   same Fortran routine as the C API (e.g. LSM3D_HJ_ENO2), otherwise it
+ *   uses the point form.  The point form (e.g. hj_eno2_at()) computes
+ *   the result at a single grid point and is defined inline, so that
+ *   adjacent kernels can be fused into a single loop over the grid
+ *   (see for_each_point()).
+ *
+ * <h3> Usage: </h3>
+ *
+ * \code
+ *   lsm::Grid<3> g(*grid);
+ *   lsm::Field<double,3> phi(g, phi_data), rhs(g, rhs_data);
+ *   double inv_dx[3] = {1/g.dx[0], 1/g.dx[1], 1/g.dx[2]};
+ *   lsm::for_each_point(g, [&](std::ptrdiff_t p) {
+ *     auto d = lsm::hj_eno2_at<0>(phi, p, inv_dx[0]);
+ *     rhs[p] = -(vel_x > 0 ? vel_x*d.minus : vel_x*d.plus);
+ *   });
+ * \endcode
+ *
+ */
+
+namespace lsm {
+
+/*!
+ * Grid<Dim> holds the index space and grid spacing of a Dim-dimensional
+ * grid.  Indices are ghostbox indices (0 <= i < gb_dims[0], ...), as in
+ * the C Grid.
+ */
+template <int Dim>
+struct Grid
+{
+  static_assert((Dim == 2) || (Dim == 3), "lsm::Grid supports 2D and 3D");
+
+  int           gb_dims[Dim];
+  int           fb_lo[Dim];
+  int           fb_hi[Dim];
+  LSMLIB_REAL   dx[Dim];
+
+  /*!
+   * Constructs the index space of a C Grid.  grid.num_dims must equal
+   * Dim.
+   */
+  explicit Grid(const ::Grid &grid)
+  {
+    const int lo[3] = {grid.ilo_fb, grid.jlo_fb, grid.klo_fb};
+    const int hi[3] = {grid.ihi_fb, grid.jhi_fb, grid.khi_fb};
+    for (int d = 0; d < Dim; d++) {
+      gb_dims[d] = grid.grid_dims_ghostbox[d];
+      fb_lo[d] = lo[d];
+      fb_hi[d] = hi[d];
+      dx[d] = grid.dx[d];
+    }
+  }
+
+  /*!
+   * Constructs a grid with num_ghostcells ghostcells on each side of
+   * the interior dims.
+   */
+  Grid(const int (&dims)[Dim], int num_ghostcells,
+       const LSMLIB_REAL (&spacing)[Dim])
+  {
+    for (int d = 0; d < Dim; d++) {
+      gb_dims[d] = dims[d] + 2*num_ghostcells;
+      fb_lo[d] = num_ghostcells;
+      fb_hi[d] = num_ghostcells + dims[d] - 1;
+      dx[d] = spacing[d];
+    }
+  }
+
+  /*! Number of grid points in the ghostbox. */
+  std::size_t num_gridpts() const
+  {
+    std::size_t n = 1;
+    for (int d = 0; d < Dim; d++) n *= gb_dims[d];
+    return n;
+  }
+
+  /*! Distance in memory between neighbors in direction dir. */
+  std::ptrdiff_t stride(int dir) const
+  {
+    std::ptrdiff_t s = 1;
+    for (int d = 0; d < dir; d++) s *= gb_dims[d];
+    return s;
+  }
+};
+
+
+/*!
+ * Field<T,Dim> is a view of an array of values of type T over the
+ * ghostbox of a Grid<Dim>.  The view does not own the data.
+ */
+template <typename T, int Dim>
+struct Field
+{
+  static_assert(std::is_floating_point<T>::value,
+                "lsm::Field requires a floating-point type");
+
+  T               *data;
+  std::ptrdiff_t   strides[Dim];
+
+  Field(const Grid<Dim> &grid, T *values) : data(values)
+  {
+    for (int d = 0; d < Dim; d++) strides[d] = grid.stride(d);
+  }
+
+  /*! Value at the linear index p. */
+  T &operator[](std::ptrdiff_t p) const { return data[p]; }
+
+  /*! Linear index of the grid point (idx[0], idx[1], ...). */
+  template <typename... Index>
+  std::ptrdiff_t offset(Index... idx) const
+  {
+    static_assert(sizeof...(Index) == Dim,
+                  "number of indices must equal the dimension");
+    const std::ptrdiff_t i[Dim] = {static_cast<std::ptrdiff_t>(idx)...};
+    std::ptrdiff_t p = 0;
+    for (int d = 0; d < Dim; d++) p += i[d]*strides[d];
+    return p;
+  }
+
+  /*! Value at the grid point (idx[0], idx[1], ...). */
+  template <typename... Index>
+  T &operator()(Index... idx) const { return data[offset(idx...)]; }
+};
+
+
+/*!
+ * Upwind<T> holds the plus (forward) and minus (backward) approximations
+ * of a derivative.
+ */
+template <typename T>
+struct Upwind
+{
+  T plus;
+  T minus;
+};
+
+
+/*!
+ * for_each_point() calls f(p) for the linear index p of every grid point
+ * in the fillbox of grid, with the first index varying fastest.
+ */
+template <int Dim, typename F>
+inline void for_each_point(const Grid<Dim> &grid, F &&f)
+{
+  const std::ptrdiff_t sy = grid.stride(1);
+  if constexpr (Dim == 2) {
+    for (int j = grid.fb_lo[1]; j <= grid.fb_hi[1]; j++) {
+      for (int i = grid.fb_lo[0]; i <= grid.fb_hi[0]; i++) {
+        f(i + j*sy);
+      }
+    }
+  } else {
+    const std::ptrdiff_t sz = grid.stride(2);
+    for (int k = grid.fb_lo[2]; k <= grid.fb_hi[2]; k++) {
+      for (int j = grid.fb_lo[1]; j <= grid.fb_hi[1]; j++) {
+        for (int i = grid.fb_lo[0]; i <= grid.fb_hi[0]; i++) {
+          f(i + j*sy + k*sz);
+        }
+      }
+    }
+  }
+}
+
+
+/*!
+ * hj_eno2_at() computes the plus and minus HJ ENO2 approximations to
+ * the derivative of phi in direction Dir at the linear index p.  The
+ * arithmetic is the same as in LSM2D_HJ_ENO2 and LSM3D_HJ_ENO2.
+ *
+ * NOTES:
+ *  - phi must be valid within two grid points of p in direction Dir.
+ */
+template <int Dir, typename T, int Dim>
+inline Upwind<T> hj_eno2_at(const Field<T,Dim> &phi, std::ptrdiff_t p,
+                            T inv_dx)
+{
+  static_assert((Dir >= 0) && (Dir < Dim), "invalid direction");
+  const T half = T(0.5);
+  const std::ptrdiff_t s = phi.strides[Dir];
+  const T *u = phi.data + p;
+
+  // first undivided differences D1(i-1), D1(i), D1(i+1), D1(i+2)
+  const T d1_m1 = u[-s] - u[-2*s];
+  const T d1_0  = u[0] - u[-s];
+  const T d1_p1 = u[s] - u[0];
+  const T d1_p2 = u[2*s] - u[s];
+
+  // second undivided differences D2(i-1), D2(i), D2(i+1)
+  const T d2_m1 = d1_0 - d1_m1;
+  const T d2_0  = d1_p1 - d1_0;
+  const T d2_p1 = d1_p2 - d1_p1;
+
+  Upwind<T> result;
+  result.plus = (std::abs(d2_0) < std::abs(d2_p1))
+              ? (d1_p1 - half*d2_0)*inv_dx
+              : (d1_p1 - half*d2_p1)*inv_dx;
+  result.minus = (std::abs(d2_m1) < std::abs(d2_0))
+               ? (d1_0 + half*d2_m1)*inv_dx
+               : (d1_0 + half*d2_0)*inv_dx;
+  return result;
+}
+
+
+/*!
+ * rk3_stage_at() returns the value of stage Stage of the third-order TVD
+ * Runge-Kutta method at a single grid point (the same update as
+ * LSM3D_TVD_RK3_STAGE1, LSM3D_TVD_RK3_STAGE2 and LSM3D_TVD_RK3_STAGE3).
+ *
+ * Arguments:
+ *  - u_cur (in):    u(t_cur)
+ *  - u_stage (in):  result of the previous stage (ignored for Stage 1)
+ *  - rhs (in):      right-hand side evaluated at the previous stage
+ *  - dt (in):       time step
+ */
+template <int Stage, typename T>
+inline T rk3_stage_at(T u_cur, T u_stage, T rhs, T dt)
+{
+  static_assert((Stage >= 1) && (Stage <= 3), "invalid TVD RK3 stage");
+  if constexpr (Stage == 1) {
+    (void) u_stage;
+    return u_cur + dt*rhs;
+  } else if constexpr (Stage == 2) {
+    return T(0.75)*u_cur + T(0.25)*(u_stage + dt*rhs);
+  } else {
+    return T(1.0/3.0)*u_cur + T(2.0/3.0)*(u_stage + dt*rhs);
+  }
+}
+
+
+/*!
+ * hj_eno2() computes the plus and minus HJ ENO2 approximations to
+ * grad(phi) on the fillbox of grid.
+ *
+ * Arguments:
+ *  - phi_plus (out):   forward approximations (one field per direction)
+ *  - phi_minus (out):  backward approximations
+ *  - phi (in):         level set function
+ *  - grid (in):        grid
+ *
+ * NOTES:
+ *  - phi must be valid within two grid points of the fillbox.
+ *
+ *  - For T = LSMLIB_REAL the computation is carried out by
+ *    LSM2D_HJ_ENO2 or LSM3D_HJ_ENO2 using temporary arrays for the
+ *    undivided differences.
+ */
+template <typename T, int Dim>
+inline void hj_eno2(const Field<T,Dim> (&phi_plus)[Dim],
+                    const Field<T,Dim> (&phi_minus)[Dim],
+                    const Field<T,Dim> &phi,
+                    const Grid<Dim> &grid)
+{
+  if constexpr (std::is_same<T, LSMLIB_REAL>::value) {
+    std::vector<LSMLIB_REAL> D1(grid.num_gridpts());
+    std::vector<LSMLIB_REAL> D2(grid.num_gridpts());
+    const int lo = 0;
+    const int ihi_gb = grid.gb_dims[0]-1, jhi_gb = grid.gb_dims[1]-1;
+    if constexpr (Dim == 2) {
+      LSM2D_HJ_ENO2(phi_plus[0].data, phi_plus[1].data,
+        &lo, &ihi_gb, &lo, &jhi_gb,
+        phi_minus[0].data, phi_minus[1].data,
+        &lo, &ihi_gb, &lo, &jhi_gb,
+        phi.data, &lo, &ihi_gb, &lo, &jhi_gb,
+        D1.data(), &lo, &ihi_gb, &lo, &jhi_gb,
+        D2.data(), &lo, &ihi_gb, &lo, &jhi_gb,
+        &grid.fb_lo[0], &grid.fb_hi[0], &grid.fb_lo[1], &grid.fb_hi[1],
+        &grid.dx[0], &grid.dx[1]);
+    } else {
+      const int khi_gb = grid.gb_dims[2]-1;
+      LSM3D_HJ_ENO2(phi_plus[0].data, phi_plus[1].data, phi_plus[2].data,
+        &lo, &ihi_gb, &lo, &jhi_gb, &lo, &khi_gb,
+        phi_minus[0].data, phi_minus[1].data, phi_minus[2].data,
+        &lo, &ihi_gb, &lo, &jhi_gb, &lo, &khi_gb,
+        phi.data, &lo, &ihi_gb, &lo, &jhi_gb, &lo, &khi_gb,
+        D1.data(), &lo, &ihi_gb, &lo, &jhi_gb, &lo, &khi_gb,
+        D2.data(), &lo, &ihi_gb, &lo, &jhi_gb, &lo, &khi_gb,
+        &grid.fb_lo[0], &grid.fb_hi[0], &grid.fb_lo[1], &grid.fb_hi[1],
+        &grid.fb_lo[2], &grid.fb_hi[2],
+        &grid.dx[0], &grid.dx[1], &grid.dx[2]);
+    }
+  } else {
+    T inv_dx[Dim];
+    for (int d = 0; d < Dim; d++) inv_dx[d] = T(1)/T(grid.dx[d]);
+    for_each_point(grid, [&](std::ptrdiff_t p) {
+      Upwind<T> d0 = hj_eno2_at<0>(phi, p, inv_dx[0]);
+      Upwind<T> d1 = hj_eno2_at<1>(phi, p, inv_dx[1]);
+      phi_plus[0][p] = d0.plus;  phi_minus[0][p] = d0.minus;
+      phi_plus[1][p] = d1.plus;  phi_minus[1][p] = d1.minus;
+      if constexpr (Dim == 3) {
+        Upwind<T> d2 = hj_eno2_at<2>(phi, p, inv_dx[2]);
+        phi_plus[2][p] = d2.plus;  phi_minus[2][p] = d2.minus;
+      }
+    });
+  }
+}
+
+
+/*!
+ * rk3_stage() carries out stage Stage of the third-order TVD Runge-Kutta
+ * method on the fillbox of grid.
+ *
+ * Arguments:
+ *  - u_next (out):  result of the stage
+ *  - u_stage (in):  result of the previous stage (ignored for Stage 1)
+ *  - u_cur (in):    u(t_cur)
+ *  - rhs (in):      right-hand side evaluated at the previous stage
+ *  - dt (in):       time step
+ *  - grid (in):     grid
+ *
+ * NOTES:
+ *  - For T = LSMLIB_REAL the update is carried out by
+ *    LSM{2,3}D_TVD_RK3_STAGE{1,2,3}.
+ */
+template <int Stage, typename T, int Dim>
+inline void rk3_stage(const Field<T,Dim> &u_next,
+                      const Field<T,Dim> &u_stage,
+                      const Field<T,Dim> &u_cur,
+                      const Field<T,Dim> &rhs,
+                      T dt,
+                      const Grid<Dim> &grid)
+{
+  static_assert((Stage >= 1) && (Stage <= 3), "invalid TVD RK3 stage");
+  if constexpr (std::is_same<T, LSMLIB_REAL>::value) {
+    const int lo = 0;
+    const int ihi = grid.gb_dims[0]-1, jhi = grid.gb_dims[1]-1;
+    const int *fb = &grid.fb_lo[0];
+    if constexpr (Dim == 2) {
+#define LSM_CXX_GB2 &lo, &ihi, &lo, &jhi
+#define LSM_CXX_FB2 &fb[0], &grid.fb_hi[0], &fb[1], &grid.fb_hi[1]
+      if constexpr (Stage == 1) {
+        LSM2D_TVD_RK3_STAGE1(u_next.data, LSM_CXX_GB2,
+          u_cur.data, LSM_CXX_GB2, rhs.data, LSM_CXX_GB2,
+          LSM_CXX_FB2, &dt);
+      } else if constexpr (Stage == 2) {
+        LSM2D_TVD_RK3_STAGE2(u_next.data, LSM_CXX_GB2,
+          u_stage.data, LSM_CXX_GB2, u_cur.data, LSM_CXX_GB2,
+          rhs.data, LSM_CXX_GB2, LSM_CXX_FB2, &dt);
+      } else {
+        LSM2D_TVD_RK3_STAGE3(u_next.data, LSM_CXX_GB2,
+          u_stage.data, LSM_CXX_GB2, u_cur.data, LSM_CXX_GB2,
+          rhs.data, LSM_CXX_GB2, LSM_CXX_FB2, &dt);
+      }
+#undef LSM_CXX_GB2
+#undef LSM_CXX_FB2
+    } else {
+      const int khi = grid.gb_dims[2]-1;
+#define LSM_CXX_GB3 &lo, &ihi, &lo, &jhi, &lo, &khi
+#define LSM_CXX_FB3 &fb[0], &grid.fb_hi[0], &fb[1], &grid.fb_hi[1], \
+                    &fb[2], &grid.fb_hi[2]
+      if constexpr (Stage == 1) {
+        LSM3D_TVD_RK3_STAGE1(u_next.data, LSM_CXX_GB3,
+          u_cur.data, LSM_CXX_GB3, rhs.data, LSM_CXX_GB3,
+          LSM_CXX_FB3, &dt);
+      } else if constexpr (Stage == 2) {
+        LSM3D_TVD_RK3_STAGE2(u_next.data, LSM_CXX_GB3,
+          u_stage.data, LSM_CXX_GB3, u_cur.data, LSM_CXX_GB3,
+          rhs.data, LSM_CXX_GB3, LSM_CXX_FB3, &dt);
+      } else {
+        LSM3D_TVD_RK3_STAGE3(u_next.data, LSM_CXX_GB3,
+          u_stage.data, LSM_CXX_GB3, u_cur.data, LSM_CXX_GB3,
+          rhs.data, LSM_CXX_GB3, LSM_CXX_FB3, &dt);
+      }
+#undef LSM_CXX_GB3
+#undef LSM_CXX_FB3
+    }
+  } else {
+    for_each_point(grid, [&](std::ptrdiff_t p) {
+      u_next[p] = rk3_stage_at<Stage>(
+        u_cur[p], (Stage == 1) ? T(0) : u_stage[p], rhs[p], dt);
+    });
+  }
+}
+
+
+/*!
+ * fmm_distance() computes the distance function for the zero level set
+ * of phi using the fast marching method (computeDistanceFunction2d()
+ * or computeDistanceFunction3d()).
+ *
+ * Arguments:
+ *  - distance (out):  distance function
+ *  - phi (in):        level set function
+ *  - grid (in):       grid
+ *  - order (in):      order of the finite differences (1 or 2)
+ *  - mask (in):       mask for the domain of the problem (may be NULL)
+ *
+ * Return value:       error code of the C function
+ *
+ * NOTES:
+ *  - The FMM operates on the entire ghostbox.
+ *
+ *  - Only T = LSMLIB_REAL is supported.
+ */
+template <typename T, int Dim>
+inline int fmm_distance(const Field<T,Dim> &distance,
+                        const Field<T,Dim> &phi,
+                        const Grid<Dim> &grid,
+                        int order = 2,
+                        T *mask = NULL)
+{
+  static_assert(std::is_same<T, LSMLIB_REAL>::value,
+                "lsm::fmm_distance requires T = LSMLIB_REAL");
+  int grid_dims[Dim];
+  LSMLIB_REAL dx[Dim];
+  for (int d = 0; d < Dim; d++) {
+    grid_dims[d] = grid.gb_dims[d];
+    dx[d] = grid.dx[d];
+  }
+  if constexpr (Dim == 2) {
+    return computeDistanceFunction2d(distance.data, phi.data, mask, order,
+                                     grid_dims, dx);
+  } else {
+    return computeDistanceFunction3d(distance.data, phi.data, mask, order,
+                                     grid_dims, dx);
+  }
+}
+
+}  /* namespace lsm */
+
+#endif
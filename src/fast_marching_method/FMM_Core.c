@@ -52,6 +52,21 @@
 }
 
 
+#define FMM_CORE_PERIODIC_WRAP(num_dims, grid_idx, grid_dims, periodic)   \
+{                                                                         \
+  int macro_i;       /* loop variable */                                  \
+  for (macro_i = 0; macro_i < num_dims; macro_i++) {                      \
+    if (periodic[macro_i]) {                                              \
+      if (grid_idx[macro_i] < 0) {                                        \
+        grid_idx[macro_i] += grid_dims[macro_i];                          \
+      } else if (grid_idx[macro_i] > grid_dims[macro_i]-1) {              \
+        grid_idx[macro_i] -= grid_dims[macro_i];                          \
+      }                                                                   \
+    }                                                                     \
+  }                                                                       \
+}
+
+
 /*=============== FMM_Core Helper Function Declarations ==============*/
 
 /* 
@@ -70,6 +85,7 @@ struct FMM_CoreData {
   FMM_FieldData *fmm_field_data;
   int grid_dims[FMM_CORE_MAX_NDIM];
   LSMLIB_REAL dx[FMM_CORE_MAX_NDIM];
+  int periodic[FMM_CORE_MAX_NDIM];
 
   /* function pointer to grid update function */
   initializeFrontFuncPtr initializeFront;
@@ -121,11 +137,14 @@ FMM_CoreData* FMM_Core_createFMM_CoreData(
   fmm_core_data->fmm_field_data = fmm_field_data;
   fmm_core_data->initializeFront = initializeFront;
   fmm_core_data->updateGridPoint = updateGridPoint;
+  fmm_core_data->known_points = FMM_CORE_NULL;
 
-  /* initialize grid_dims and dx to zero */
+  /* initialize grid_dims and dx to zero and all coordinate */
+  /* directions to be non-periodic                          */
   for (i = 0; i < FMM_CORE_MAX_NDIM; i++) {
     fmm_core_data->grid_dims[i] = 0;
     fmm_core_data->dx[i] = 0.0;
+    fmm_core_data->periodic[i] = 0;
   }
 
   /* copy of grid_dims and dx from user specified arguments */
@@ -160,6 +179,55 @@ FMM_CoreData* FMM_Core_createFMM_CoreData(
 }
 
 
+void FMM_Core_resetFMM_CoreData(
+  FMM_CoreData *fmm_core_data,
+  FMM_FieldData *fmm_field_data,
+  initializeFrontFuncPtr initializeFront,
+  updateGridPointFuncPtr updateGridPoint)
+{
+  int num_gridpoints;              /* number of grid points */
+  int i;                           /* loop variable */
+  int *ptr;                        /* integer pointer loop variable */
+
+  fmm_core_data->fmm_field_data = fmm_field_data;
+  fmm_core_data->initializeFront = initializeFront;
+  fmm_core_data->updateGridPoint = updateGridPoint;
+
+  /* compute number of grid points */
+  num_gridpoints = 1;
+  for (i = 0; i < fmm_core_data->num_dims; i++) {
+    num_gridpoints *= fmm_core_data->grid_dims[i];
+  }
+
+  /* empty the FMM_Heap of trial points without releasing its memory */
+  FMM_Heap_clear(fmm_core_data->trial_points);
+
+  /* reset heapnode handles to -1 and gridpoint status to FAR */
+  ptr = fmm_core_data->heapnode_handles;
+  for (i = 0; i < num_gridpoints; i++, ptr++) {
+    *ptr = -1;
+  }
+  ptr = fmm_core_data->gridpoint_status;
+  for (i = 0; i < num_gridpoints; i++, ptr++) {
+    *ptr = FAR;
+  }
+}
+
+
+void FMM_Core_setPeriodicDirections(
+  FMM_CoreData *fmm_core_data,
+  int *periodic)
+{
+  int i;    /* loop variable */
+
+  for (i = 0; i < FMM_CORE_MAX_NDIM; i++) {
+    fmm_core_data->periodic[i] = 
+      ( (periodic) && (i < fmm_core_data->num_dims) && (periodic[i]) ) ?
+      FMM_CORE_TRUE : FMM_CORE_FALSE;
+  }
+}
+
+
 void FMM_Core_destroyFMM_CoreData(FMM_CoreData *fmm_core_data)
 {
   free(fmm_core_data->heapnode_handles);
@@ -320,6 +388,7 @@ void FMM_Core_markPointOutsideDomain(
  *  (1) There may be some error in the update of cells on the border 
  *      of the grid, but this error is not important as long as the 
  *      zero level set is sufficiently far away from the domain border.
+ *      Along periodic coordinate directions, there is no border.
  */
 void FMM_Core_advanceFront(FMM_CoreData *fmm_core_data)
 {
@@ -364,6 +433,11 @@ int* FMM_Core_getGridPointStatusDataArray(FMM_CoreData *fmm_core_data)
   return (fmm_core_data->gridpoint_status);
 }
 
+int* FMM_Core_getPeriodicDirectionsArray(FMM_CoreData *fmm_core_data)
+{
+  return (fmm_core_data->periodic);
+}
+
 
 /*=============== FMM_Core Helper Function Definitions ==============*/
 
@@ -404,6 +478,9 @@ void FMM_Core_updateNeighbors(FMM_CoreData *fmm_core_data, int *grid_idx)
 
       for (m = 0; m < num_dims; m++) neighbor[m] = grid_idx[m]+offset[m];
 
+      /* neighbors across a periodic boundary wrap around the grid */
+      FMM_CORE_PERIODIC_WRAP(num_dims, neighbor, grid_dims, 
+                             fmm_core_data->periodic);
       FMM_CORE_IDX_OUT_OF_BOUNDS(out_of_bounds, num_dims, neighbor, grid_dims);
       if (!out_of_bounds) {
 
@@ -144,6 +144,70 @@ FMM_CoreData* FMM_Core_createFMM_CoreData(
   initializeFrontFuncPtr initializeFront,
   updateGridPointFuncPtr updateGridPoint);
 
+/*!
+ * FMM_Core_resetFMM_CoreData() returns an existing FMM_CoreData 
+ * structure to the state it had immediately after creation so that 
+ * it can be reused for another FMM calculation on a grid of the same 
+ * size without reallocating any memory.
+ *
+ * Arguments:
+ *  - fmm_core_data (in/out):       FMM_CoreData "object" to be reset
+ *  - fmm_field_data (in):          pointer to FMM_FieldData data structure
+ *                                  for the next calculation
+ *  - initializeFront (in):         callback function pointer that is 
+ *                                  used to find and initialize the front
+ *  - updateGridPoint (in):         callback function pointer that is 
+ *                                  used to update individual grid points
+ *
+ * Return value:                    none
+ *
+ * NOTES:
+ *  - The grid dimensions, grid spacing and periodic coordinate 
+ *    directions are NOT changed.  The FMM_CoreData must have been 
+ *    created with the grid_dims and dx of the next calculation.
+ *
+ *  - An FMM_CoreData created with NULL field data and NULL callback 
+ *    functions may be used purely as a reusable workspace that is 
+ *    reset before each calculation.
+ *
+ */
+void FMM_Core_resetFMM_CoreData(
+  FMM_CoreData *fmm_core_data,
+  FMM_FieldData *fmm_field_data,
+  initializeFrontFuncPtr initializeFront,
+  updateGridPointFuncPtr updateGridPoint);
+
+/*!
+ * FMM_Core_setPeriodicDirections() sets the coordinate directions
+ * along which the computational grid is periodic.
+ *
+ * Arguments:
+ *  - fmm_core_data (in/out):  FMM_CoreData "object"
+ *  - periodic (in):           integer array with a nonzero entry for 
+ *                             each periodic coordinate direction
+ *                             (NULL for none)
+ *
+ * Return value:               none
+ *
+ * NOTES:
+ *  - Along a periodic coordinate direction, the first and last grid 
+ *    points are neighbors (i.e. the period is grid_dims*dx), so the 
+ *    grid should not duplicate the first grid point at the end.
+ *
+ *  - An FMM_CoreData is created with no periodic coordinate 
+ *    directions.  FMM_Core_resetFMM_CoreData() does not change the 
+ *    periodic coordinate directions.
+ *
+ *  - Callback functions that access neighbors of a grid point should 
+ *    wrap neighbor indices along the periodic coordinate directions 
+ *    returned by FMM_Core_getPeriodicDirectionsArray() (e.g. using 
+ *    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC() in @ref FMM_Macros.h).
+ *
+ */
+void FMM_Core_setPeriodicDirections(
+  FMM_CoreData *fmm_core_data,
+  int *periodic);
+
 /*!
  * FMM_Core_destroyFMM_CoreData() frees the memory associated with an 
  * FMM_CoreData structure.
@@ -272,6 +336,21 @@ int FMM_Core_moreGridPointsToUpdate(FMM_CoreData *fmm_core_data);
  */
 int* FMM_Core_getGridPointStatusDataArray(FMM_CoreData *fmm_core_data);
 
+/*!
+ * FMM_Core_getPeriodicDirectionsArray() is an accessor function for 
+ * the periodic coordinate direction flags managed by the FMM_CoreData 
+ * structure.
+ *
+ * Arguments:
+ *  - fmm_core_data (in):  FMM_CoreData "object" actively managing the 
+ *                         FMM computation
+ * 
+ * Return value:           pointer to integer array with a nonzero entry
+ *                         for each periodic coordinate direction
+ *
+ */
+int* FMM_Core_getPeriodicDirectionsArray(FMM_CoreData *fmm_core_data);
+
 #ifdef __cplusplus
 }
 #endif
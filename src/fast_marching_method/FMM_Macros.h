@@ -91,4 +91,60 @@
   }                                                                      \
 }
 
+/*
+ * LSM_FMM_PERIODIC_WRAP() maps a grid index that lies at most one
+ * period outside of the computational domain back into the domain
+ * along the periodic coordinate directions.
+ *
+ * Arguments:
+ *   grid_idx (in/out):  grid index
+ *   grid_dims (in):     grid dimensions
+ *   periodic (in):      integer array with a nonzero entry for each
+ *                       periodic coordinate direction (may be NULL)
+ * 
+ * NOTES:
+ *  (1) grid_idx MUST be a valid l-value.
+ *  (2) FMM_NDIM MUST be defined by user code.
+ *
+ */
+#define LSM_FMM_PERIODIC_WRAP(grid_idx, grid_dims, periodic)             \
+{                                                                        \
+  int lsm_fmm_dir;                                                       \
+  if (periodic) {                                                        \
+    for (lsm_fmm_dir = 0; lsm_fmm_dir < FMM_NDIM; lsm_fmm_dir++) {       \
+      if (periodic[lsm_fmm_dir]) {                                       \
+        if (grid_idx[lsm_fmm_dir] < 0) {                                 \
+          grid_idx[lsm_fmm_dir] += grid_dims[lsm_fmm_dir];               \
+        } else if (grid_idx[lsm_fmm_dir] > grid_dims[lsm_fmm_dir]-1) {   \
+          grid_idx[lsm_fmm_dir] -= grid_dims[lsm_fmm_dir];               \
+        }                                                                \
+      }                                                                  \
+    }                                                                    \
+  }                                                                      \
+}
+
+/*
+ * LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC() wraps the given grid index
+ * along the periodic coordinate directions (see LSM_FMM_PERIODIC_WRAP())
+ * and then determines whether it lies in the computational domain.
+ *
+ * Arguments:
+ *   result (out):       1 if grid index is out of bounds; 0 otherwise.
+ *   grid_idx (in/out):  grid index
+ *   grid_dims (in):     grid dimensions
+ *   periodic (in):      integer array with a nonzero entry for each
+ *                       periodic coordinate direction (may be NULL)
+ * 
+ * NOTES:
+ *  (1) result and grid_idx MUST be valid l-values.
+ *  (2) FMM_NDIM MUST be defined by user code.
+ *
+ */
+#define LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(result, grid_idx, grid_dims,  \
+                                           periodic)                     \
+{                                                                        \
+  LSM_FMM_PERIODIC_WRAP(grid_idx, grid_dims, periodic);                  \
+  LSM_FMM_IDX_OUT_OF_BOUNDS(result, grid_idx, grid_dims);                \
+}
+
 #endif
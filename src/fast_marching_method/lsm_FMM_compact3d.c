@@ -0,0 +1,542 @@
+/*
+ * File:        lsm_FMM_compact3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of the fast marching method on a compact
+ *              list of the grid points inside the domain
+ */
+
+/*
+ * lsm_FMM_compact3d.c carries out the same first-order computation as
+ * the FMM_INITIALIZE_FRONT_ORDER1() and FMM_UPDATE_GRID_POINT_ORDER1()
+ * callbacks in lsm_FMM_field_extension.h together with FMM_Core, but
+ * all per point data of the march are indexed by the position of the
+ * grid point in the active list.  The known and trial points are
+ * inserted into the FMM_Heap in the same order, so the results are
+ * identical.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "lsm_fast_marching_method.h"
+#include "FMM_Heap.h"
+#include "FMM_Macros.h"
+
+
+/*=============== lsm_FMM_compact3d Data Structures ===================*/
+
+/*
+ * Structure 'FMM_CompactData' holds the compact representation of the
+ * grid points inside the domain.
+ */
+typedef struct FMM_CompactData {
+
+  /* active list and neighbor table */
+  int num_active;
+  int *active_idx;             /* grid index of active points (sorted) */
+  int *neighbors;              /* 6 per active point:  (dir, minus/plus) */
+                               /* active list position or -1            */
+
+  /* march data */
+  unsigned char *status;       /* PointStatus of active points          */
+  int *heapnode_handles;
+  FMM_Heap *trial_points;
+  LSMLIB_REAL dx[3];
+
+  /* distance function and extension fields of active points */
+  LSMLIB_REAL *distance_function;
+  int num_extension_fields;
+  LSMLIB_REAL *extension_fields;   /* num_extension_fields*num_active */
+  LSMLIB_REAL *extension_fields_numerator;
+  LSMLIB_REAL *extension_fields_denominator;
+
+} FMM_CompactData;
+
+
+/*================== lsm_FMM_compact3d Helper Functions ================*/
+
+/*
+ * FMM_Compact_linkRows() sets the neighbor table entries in direction
+ * dir between the active points p_lo, ..., p_hi-1 of one grid row and
+ * the active points q_lo, ..., q_hi-1 of the row that is 'stride' grid
+ * points ahead.
+ */
+static void FMM_Compact_linkRows(
+  FMM_CompactData *data,
+  int p_lo, int p_hi,
+  int q_lo, int q_hi,
+  int stride,
+  int dir)
+{
+  int p = p_lo, q = q_lo;
+
+  while ( (p < p_hi) && (q < q_hi) ) {
+    int idx_p = data->active_idx[p] + stride;
+    int idx_q = data->active_idx[q];
+    if (idx_p == idx_q) {
+      data->neighbors[6*p + 2*dir + 1] = q;
+      data->neighbors[6*q + 2*dir] = p;
+      p++; q++;
+    } else if (idx_p < idx_q) {
+      p++;
+    } else {
+      q++;
+    }
+  }
+}
+
+/*
+ * FMM_Compact_updateGridPoint() computes and returns the updated
+ * distance function and extension field values of active point a using
+ * the values of its KNOWN neighbors (same discretization as
+ * FMM_UPDATE_GRID_POINT_ORDER1() in lsm_FMM_field_extension.h).
+ */
+static LSMLIB_REAL FMM_Compact_updateGridPoint(FMM_CompactData *data, int a)
+{
+  LSMLIB_REAL *distance_function = data->distance_function;
+  int num_extension_fields = data->num_extension_fields;
+  int num_active = data->num_active;
+  LSMLIB_REAL *numerator = data->extension_fields_numerator;
+  LSMLIB_REAL *denominator = data->extension_fields_denominator;
+
+  int upwind[3];
+  LSMLIB_REAL phi_upwind[3];
+  LSMLIB_REAL inv_dx_sq;
+  LSMLIB_REAL phi_A = 0;
+  LSMLIB_REAL phi_B = 0;
+  LSMLIB_REAL phi_C = 0;
+  LSMLIB_REAL discriminant;
+  LSMLIB_REAL dist_updated;
+  int dir, k;
+
+  for (k = 0; k < num_extension_fields; k++) {
+    numerator[k] = 0;
+    denominator[k] = 0;
+  }
+
+  /* calculate update to distance function */
+  for (dir = 0; dir < 3; dir++) {
+    int minus = data->neighbors[6*a + 2*dir];
+    int plus = data->neighbors[6*a + 2*dir + 1];
+
+    upwind[dir] = -1;
+    phi_upwind[dir] = LSMLIB_REAL_MAX;
+    if ( (minus >= 0) && (KNOWN == data->status[minus]) ) {
+      phi_upwind[dir] = distance_function[minus];
+      upwind[dir] = minus;
+    }
+    if ( (plus >= 0) && (KNOWN == data->status[plus]) ) {
+      LSMLIB_REAL phi_plus = distance_function[plus];
+      if (LSM_FMM_ABS(phi_plus) < LSM_FMM_ABS(phi_upwind[dir])) {
+        phi_upwind[dir] = phi_plus;
+        upwind[dir] = plus;
+      }
+    }
+
+    if (phi_upwind[dir] < LSMLIB_REAL_MAX) {
+      inv_dx_sq = 1/data->dx[dir]; inv_dx_sq *= inv_dx_sq;
+      phi_A += inv_dx_sq;
+      phi_B += inv_dx_sq*phi_upwind[dir];
+      phi_C += inv_dx_sq*phi_upwind[dir]*phi_upwind[dir];
+    }
+  }
+
+  /* check that phi_A is nonzero */
+  if (LSM_FMM_ABS(phi_A) == 0) {
+    fprintf(stderr,"ERROR: distance update - no KNOWN neighbors!!!\n");
+    fprintf(stderr,"       distance set to 'infinity'.\n");
+    return LSMLIB_REAL_MAX;
+  }
+
+  phi_B *= -2.0;
+  phi_C -= 1.0;
+
+  /* compute updated distance function by solving quadratic equation */
+  discriminant = phi_B*phi_B - 4.0*phi_A*phi_C;
+  if (discriminant >= 0) {
+    if (phi_B == 0) {
+      dist_updated = 0;
+    } else if (phi_B < LSMLIB_ZERO_TOL) {
+      dist_updated = 0.5*(-phi_B + sqrt(discriminant))/phi_A;
+    } else {
+      dist_updated = 0.5*(-phi_B - sqrt(discriminant))/phi_A;
+    }
+  } else {
+    /* keep the previous value (see FMM_UPDATE_GRID_POINT_ORDER1()) */
+    dist_updated = distance_function[a];
+  }
+
+  /* calculate extension field values */
+  for (dir = 0; dir < 3; dir++) {
+    if (upwind[dir] >= 0) {
+      inv_dx_sq = 1/data->dx[dir]; inv_dx_sq *= inv_dx_sq;
+      for (k = 0; k < num_extension_fields; k++) {
+        LSMLIB_REAL dist_diff = dist_updated - phi_upwind[dir];
+        numerator[k] += inv_dx_sq*dist_diff
+                      * data->extension_fields[k*num_active + upwind[dir]];
+        denominator[k] += inv_dx_sq*dist_diff;
+      }
+    }
+  }
+
+  /* set updated quantities */
+  distance_function[a] = dist_updated;
+  for (k = 0; k < num_extension_fields; k++) {
+    data->extension_fields[k*num_active + a] = numerator[k]/denominator[k];
+  }
+
+  return dist_updated;
+}
+
+/*
+ * FMM_Compact_updateNeighbors() updates the neighbors of active point a
+ * (same as FMM_Core_updateNeighbors()).
+ */
+static void FMM_Compact_updateNeighbors(FMM_CompactData *data, int a)
+{
+  int grid_idx[FMM_HEAP_MAX_NDIM] = {0};
+  int n;
+
+  for (n = 0; n < 6; n++) {
+    int b = data->neighbors[6*a + n];
+    LSMLIB_REAL value;
+
+    if ( (b < 0) || (KNOWN == data->status[b]) ) continue;
+
+    value = FMM_Compact_updateGridPoint(data, b);
+    if (value < 0) value *= -1;
+
+    if (FAR == data->status[b]) {
+      data->status[b] = TRIAL;
+      grid_idx[0] = b;
+      data->heapnode_handles[b] =
+        FMM_Heap_insertNode(data->trial_points, grid_idx, value);
+    } else {
+      FMM_Heap_updateNode(data->trial_points, data->heapnode_handles[b],
+                          value);
+    }
+  }
+}
+
+
+/*==================== Function Definitions =========================*/
+
+int computeExtensionFields3dCompact(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx)
+{
+  FMM_CompactData data;
+  FMM_Heap *known_points;
+  int num_gridpoints, stride[3], num_rows;
+  int *row_start = NULL;
+  LSMLIB_REAL *ext_cur = NULL, *ext_sum = NULL;
+  LSMLIB_REAL *ext_minus = NULL, *ext_plus = NULL;
+  int err = LSM_FMM_ERR_SUCCESS;
+  int grid_idx[FMM_HEAP_MAX_NDIM] = {0};
+  int idx, a, r, dir, m;
+
+  if (spatial_discretization_order != 1) {
+    fprintf(stderr,
+           "ERROR: Invalid spatial derivative order.  Only first-order\n");
+    fprintf(stderr,
+           "       finite differences supported by compact FMM.\n");
+    return LSM_FMM_ERR_INVALID_SPATIAL_DISCRETIZATION_ORDER;
+  }
+
+  stride[0] = 1;
+  stride[1] = grid_dims[0];
+  stride[2] = grid_dims[0]*grid_dims[1];
+  num_gridpoints = stride[2]*grid_dims[2];
+  num_rows = grid_dims[1]*grid_dims[2];
+
+  /********************************************
+   * collect the active points by grid row
+   ********************************************/
+  data.num_active = 0;
+  row_start = (int*) malloc((num_rows+1)*sizeof(int));
+  if (!row_start) return LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
+  for (idx = 0; idx < num_gridpoints; idx++) {
+    if ( (!mask) || (mask[idx] >= 0) ) data.num_active++;
+  }
+
+  data.active_idx = (int*) malloc(data.num_active*sizeof(int));
+  data.neighbors = (int*) malloc(6*data.num_active*sizeof(int));
+  data.status = (unsigned char*) malloc(data.num_active);
+  data.heapnode_handles = (int*) malloc(data.num_active*sizeof(int));
+  data.distance_function =
+    (LSMLIB_REAL*) malloc(data.num_active*sizeof(LSMLIB_REAL));
+  data.num_extension_fields = num_extension_fields;
+  data.extension_fields = (LSMLIB_REAL*) malloc(
+    num_extension_fields*data.num_active*sizeof(LSMLIB_REAL) + 1);
+  data.extension_fields_numerator =
+    (LSMLIB_REAL*) malloc((6*num_extension_fields+1)*sizeof(LSMLIB_REAL));
+  data.trial_points =
+    FMM_Heap_createHeap(1, grid_dims[0]+grid_dims[1]+grid_dims[2], 0);
+  known_points =
+    FMM_Heap_createHeap(1, grid_dims[0]+grid_dims[1]+grid_dims[2], 0);
+  if ( (data.num_active > 0)
+    && ( !data.active_idx || !data.neighbors || !data.status
+      || !data.heapnode_handles || !data.distance_function ) ) {
+    err = LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
+  }
+  if ( !data.extension_fields || !data.extension_fields_numerator
+    || !data.trial_points || !known_points ) {
+    err = LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
+  }
+  if (err != LSM_FMM_ERR_SUCCESS) goto cleanup;
+
+  data.extension_fields_denominator =
+    data.extension_fields_numerator + num_extension_fields;
+  ext_cur = data.extension_fields_denominator + num_extension_fields;
+  ext_sum = ext_cur + num_extension_fields;
+  ext_minus = ext_sum + num_extension_fields;
+  ext_plus = ext_minus + num_extension_fields;
+  for (dir = 0; dir < 3; dir++) data.dx[dir] = dx[dir];
+
+  a = 0;
+  for (r = 0; r < num_rows; r++) {
+    row_start[r] = a;
+    for (idx = r*stride[1]; idx < (r+1)*stride[1]; idx++) {
+      if ( (!mask) || (mask[idx] >= 0) ) data.active_idx[a++] = idx;
+    }
+  }
+  row_start[num_rows] = a;
+
+  /********************************************
+   * build the neighbor table
+   ********************************************/
+  for (m = 0; m < 6*data.num_active; m++) data.neighbors[m] = -1;
+  for (r = 0; r < num_rows; r++) {
+    int j = r % grid_dims[1];
+    int k = r / grid_dims[1];
+
+    /* x-neighbors are consecutive in the active list */
+    for (a = row_start[r]; a < row_start[r+1]-1; a++) {
+      if (data.active_idx[a+1] == data.active_idx[a] + 1) {
+        data.neighbors[6*a + 1] = a+1;
+        data.neighbors[6*(a+1)] = a;
+      }
+    }
+
+    /* y- and z-neighbors are found by merging rows */
+    if (j < grid_dims[1]-1) {
+      FMM_Compact_linkRows(&data, row_start[r], row_start[r+1],
+                           row_start[r+1], row_start[r+2], stride[1], 1);
+    }
+    if (k < grid_dims[2]-1) {
+      int q = r + grid_dims[1];
+      FMM_Compact_linkRows(&data, row_start[r], row_start[r+1],
+                           row_start[q], row_start[q+1], stride[2], 2);
+    }
+  }
+
+  for (a = 0; a < data.num_active; a++) {
+    data.status[a] = FAR;
+    data.heapnode_handles[a] = -1;
+    data.distance_function[a] = LSM_FMM_DEFAULT_UPDATE_VALUE;
+  }
+  for (m = 0; m < num_extension_fields*data.num_active; m++) {
+    data.extension_fields[m] = LSM_FMM_DEFAULT_UPDATE_VALUE;
+  }
+
+  /********************************************
+   * initialize the front
+   * (see FMM_INITIALIZE_FRONT_ORDER1())
+   ********************************************/
+  for (a = 0; a < data.num_active; a++) {
+    int point[3];
+    int on_interface = LSM_FMM_FALSE;
+    int borders_interface = LSM_FMM_FALSE;
+    LSMLIB_REAL phi_cur;
+    LSMLIB_REAL sum_dist_inv_sq = 0;
+
+    idx = data.active_idx[a];
+    point[0] = idx % grid_dims[0];
+    point[1] = (idx / grid_dims[0]) % grid_dims[1];
+    point[2] = idx / stride[2];
+
+    phi_cur = phi[idx];
+    for (m = 0; m < num_extension_fields; m++) {
+      ext_cur[m] = source_fields[m][idx];
+      ext_sum[m] = 0;
+    }
+
+    if (LSM_FMM_ABS(phi_cur) < LSMLIB_ZERO_TOL) {
+
+      on_interface = LSM_FMM_TRUE;
+
+    } else {
+
+      for (dir = 0; dir < 3; dir++) {
+        LSMLIB_REAL dist[2];
+        LSMLIB_REAL *ext[2];
+        int side;
+
+        ext[0] = ext_minus;
+        ext[1] = ext_plus;
+
+        /* distance to interface in minus (side 0) and plus (side 1) */
+        /* directions                                                */
+        for (side = 0; side < 2; side++) {
+          int idx_neighbor;
+          LSMLIB_REAL phi_neighbor;
+
+          dist[side] = LSMLIB_REAL_MAX;
+          for (m = 0; m < num_extension_fields; m++) ext[side][m] = 0;
+
+          if ( ( (side == 0) && (point[dir] == 0) )
+            || ( (side == 1) && (point[dir] == grid_dims[dir]-1) ) ) {
+            continue;
+          }
+          idx_neighbor = idx + (side ? stride[dir] : -stride[dir]);
+          phi_neighbor = phi[idx_neighbor];
+          if (phi_neighbor*phi_cur > 0) continue;
+
+          /* locate zero level set using linear interpolant */
+          dist[side] = phi_cur/(phi_cur-phi_neighbor);
+
+          for (m = 0; m < num_extension_fields; m++) {
+            if ((extension_field_mask) && (extension_field_mask[idx] < 0)) {
+              ext[side][m] = source_fields[m][idx_neighbor];
+            } else if ((extension_field_mask) &&
+                       (extension_field_mask[idx_neighbor] < 0)) {
+              ext[side][m] = ext_cur[m];
+            } else {
+              ext[side][m] = ext_cur[m]
+                + dist[side]*(source_fields[m][idx_neighbor] - ext_cur[m]);
+            }
+          }
+          dist[side] *= dx[dir];
+        }
+
+        /* accumulate 1/dist^2 and ext_field/dist^2 */
+        if ( (dist[1] < LSMLIB_REAL_MAX) || (dist[0] < LSMLIB_REAL_MAX) ) {
+          int use_plus = (dist[1] < dist[0]);
+          LSMLIB_REAL dist_inv_sq_dir =
+            1/dist[use_plus]/dist[use_plus];
+
+          borders_interface = LSM_FMM_TRUE;
+          sum_dist_inv_sq += dist_inv_sq_dir;
+          for (m = 0; m < num_extension_fields; m++) {
+            ext_sum[m] += ext[use_plus][m]*dist_inv_sq_dir;
+          }
+        }
+      }
+    }
+
+    if ( !on_interface && !borders_interface ) continue;
+
+    if (on_interface) {
+      data.distance_function[a] =
+        (phi_cur > 0) ? LSMLIB_ZERO_TOL : -LSMLIB_ZERO_TOL;
+      for (m = 0; m < num_extension_fields; m++) {
+        data.extension_fields[m*data.num_active + a] = ext_cur[m];
+      }
+    } else {
+      data.distance_function[a] = (phi_cur > 0) ?
+        sqrt(1.0/sum_dist_inv_sq) : -sqrt(1.0/sum_dist_inv_sq);
+      for (m = 0; m < num_extension_fields; m++) {
+        data.extension_fields[m*data.num_active + a] =
+          ext_sum[m]/sum_dist_inv_sq;
+      }
+    }
+
+    /* set grid point as an initial front point */
+    data.status[a] = KNOWN;
+    grid_idx[0] = a;
+    FMM_Heap_insertNode(known_points, grid_idx, data.distance_function[a]);
+  }
+
+  /* initial trial points:  neighbors of the initial front */
+  while (!FMM_Heap_isEmpty(known_points)) {
+    FMM_HeapNode node = FMM_Heap_extractMin(known_points, NULL, NULL);
+    if (node.value < LSMLIB_REAL_MAX) {
+      FMM_Compact_updateNeighbors(&data, node.grid_idx[0]);
+    }
+  }
+
+  /********************************************
+   * march (see FMM_Core_advanceFront())
+   ********************************************/
+  while (!FMM_Heap_isEmpty(data.trial_points)) {
+    FMM_HeapNode moved_node;
+    int moved_handle;
+    FMM_HeapNode min_node = FMM_Heap_extractMin(data.trial_points,
+                                                &moved_node, &moved_handle);
+    if (-1 != moved_handle) {
+      data.heapnode_handles[moved_node.grid_idx[0]] = moved_handle;
+    }
+    data.status[min_node.grid_idx[0]] = KNOWN;
+    FMM_Compact_updateNeighbors(&data, min_node.grid_idx[0]);
+  }
+
+  /********************************************
+   * scatter results to the full grid
+   ********************************************/
+  a = 0;
+  for (idx = 0; idx < num_gridpoints; idx++) {
+    if ( (a < data.num_active) && (data.active_idx[a] == idx) ) {
+      distance_function[idx] = data.distance_function[a];
+      for (m = 0; m < num_extension_fields; m++) {
+        extension_fields[m][idx] =
+          data.extension_fields[m*data.num_active + a];
+      }
+      a++;
+    } else {
+      distance_function[idx] = LSMLIB_REAL_MAX;
+      for (m = 0; m < num_extension_fields; m++) {
+        extension_fields[m][idx] = LSMLIB_REAL_MAX;
+      }
+    }
+  }
+
+cleanup:
+  if (data.trial_points) FMM_Heap_destroyHeap(data.trial_points);
+  if (known_points) FMM_Heap_destroyHeap(known_points);
+  free(data.active_idx);
+  free(data.neighbors);
+  free(data.status);
+  free(data.heapnode_handles);
+  free(data.distance_function);
+  free(data.extension_fields);
+  free(data.extension_fields_numerator);
+  free(row_start);
+
+  return err;
+}
+
+
+int computeDistanceFunction3dCompact(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx)
+{
+  return computeExtensionFields3dCompact(
+           distance_function,
+           NULL, /* NULL extension fields pointer */
+           phi,
+           NULL, /* NULL source fields pointer */
+           0, /* zero extension fields to compute */
+           mask,
+           NULL, /* NULL extension_field_mask pointer */
+           spatial_discretization_order,
+           grid_dims,
+           dx);
+}
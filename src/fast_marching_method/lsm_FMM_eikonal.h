@@ -14,6 +14,12 @@
  *    -# FMM_NDIM:  the number of spatial dimensions.
  *    -# FMM_EIKONAL_SOLVE_EIKONAL_EQUATION:  desired name of function 
  *       that solves the Eikonal equation.
+ *    -# FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_WITH_WORKSPACE:  desired name
+ *       of function that solves the Eikonal equation using a
+ *       user-provided (reusable) FMM_CoreData workspace
+ *    -# FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_PERIODIC:  desired name
+ *       of function that solves the Eikonal equation on a grid that
+ *       is periodic along user-specified coordinate directions
  *    -# FMM_EIKONAL_INITIALIZE_FRONT:  desired name of function that
  *       initializes the values on the front.
  *    -# FMM_EIKONAL_UPDATE_GRID_POINT_ORDER1:  desired name of function 
@@ -56,6 +62,12 @@
 #ifndef FMM_EIKONAL_SOLVE_EIKONAL_EQUATION
 #error "lsm_FMM_eikonal: required macro FMM_EIKONAL_SOLVE_EIKONAL_EQUATION not defined!"
 #endif
+#ifndef FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_WITH_WORKSPACE
+#error "lsm_FMM_eikonal: required macro FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_WITH_WORKSPACE not defined!"
+#endif
+#ifndef FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_PERIODIC
+#error "lsm_FMM_eikonal: required macro FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_PERIODIC not defined!"
+#endif
 #ifndef FMM_EIKONAL_INITIALIZE_FRONT
 #error "lsm_FMM_eikonal: required macro FMM_EIKONAL_INITIALIZE_FRONT not defined!"
 #endif
@@ -76,6 +88,24 @@ struct FMM_FieldData {
 
 /*============= FMM Eikonal Equation Solver Functions ===============*/
 
+/*
+ * FMM_Eikonal_solveEikonalEquation() carries out the FMM calculation
+ * for all of the Eikonal equation drivers.  If fmm_workspace is NULL,
+ * a temporary FMM_CoreData with the specified periodic coordinate
+ * directions is created and destroyed; otherwise, fmm_workspace is
+ * reset and reused (and periodic is ignored in favor of the periodic
+ * coordinate directions of the workspace).
+ */
+static int FMM_Eikonal_solveEikonalEquation(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace,
+  int *periodic);
+
 /*
  * FMM_EIKONAL_INITIALIZE_FRONT() implements the callback
  * function required by FMM_Core::FMM_initializeFront() to find 
@@ -134,6 +164,67 @@ int FMM_EIKONAL_SOLVE_EIKONAL_EQUATION(
   int spatial_discretization_order,
   int *grid_dims,
   LSMLIB_REAL *dx)
+{
+  return FMM_Eikonal_solveEikonalEquation(
+           phi,
+           speed,
+           mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           NULL,  /* NULL workspace pointer */
+           NULL); /* no periodic directions */
+}
+
+int FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_WITH_WORKSPACE(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace)
+{
+  return FMM_Eikonal_solveEikonalEquation(
+           phi,
+           speed,
+           mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           fmm_workspace,
+           NULL); /* periodic directions taken from workspace */
+}
+
+int FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_PERIODIC(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic)
+{
+  return FMM_Eikonal_solveEikonalEquation(
+           phi,
+           speed,
+           mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           NULL,  /* NULL workspace pointer */
+           periodic);
+}
+
+static int FMM_Eikonal_solveEikonalEquation(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace,
+  int *periodic)
 {
   /* fast marching method data */
   FMM_CoreData *fmm_core_data;
@@ -177,14 +268,27 @@ int FMM_EIKONAL_SOLVE_EIKONAL_EQUATION(
   /********************************************
    * initialize FMM Core Data
    ********************************************/
-  fmm_core_data = FMM_Core_createFMM_CoreData(
-    fmm_field_data,
-    FMM_NDIM,
-    grid_dims,
-    dx,
-    initializeFront,
-    updateGridPoint);
-  if (!fmm_core_data) return LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
+  if (fmm_workspace) {
+    fmm_core_data = fmm_workspace;
+    FMM_Core_resetFMM_CoreData(
+      fmm_core_data,
+      fmm_field_data,
+      initializeFront,
+      updateGridPoint);
+  } else {
+    fmm_core_data = FMM_Core_createFMM_CoreData(
+      fmm_field_data,
+      FMM_NDIM,
+      grid_dims,
+      dx,
+      initializeFront,
+      updateGridPoint);
+    if (fmm_core_data) FMM_Core_setPeriodicDirections(fmm_core_data, periodic);
+  }
+  if (!fmm_core_data) {
+    free(fmm_field_data);
+    return LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
+  }
 
   /********************************************
    * initialize phi and mark grid points
@@ -240,7 +344,7 @@ int FMM_EIKONAL_SOLVE_EIKONAL_EQUATION(
   }
 
   /* clean up memory */
-  FMM_Core_destroyFMM_CoreData(fmm_core_data);
+  if (!fmm_workspace) FMM_Core_destroyFMM_CoreData(fmm_core_data);
   free(fmm_field_data);
 
   return LSM_FMM_ERR_SUCCESS;
@@ -312,6 +416,7 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER1(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *phi   = fmm_field_data->phi; 
@@ -360,7 +465,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER1(
     for (l = 0; l < FMM_NDIM; l++) { 
       neighbor[l] = grid_idx[l] + offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor];
@@ -374,7 +480,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER1(
     for (l = 0; l < FMM_NDIM; l++) { 
       neighbor[l] = grid_idx[l] + offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor];
@@ -455,6 +562,7 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER2(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *phi   = fmm_field_data->phi; 
@@ -511,7 +619,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER2(
       neighbor1[l] = grid_idx[l] + offset[l];
       neighbor2[l] = grid_idx[l] + 2*offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor1,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor1,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor1, neighbor1, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor1];
@@ -519,7 +628,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER2(
         phi_upwind1 = phi[idx_neighbor1];
 
         /* check for neighbor required for second-order accuracy */
-        LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor2,grid_dims);
+        LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                           neighbor2,grid_dims,periodic);
         if (!grid_idx_out_of_bounds) {
           LSM_FMM_IDX(idx_neighbor2, neighbor2, grid_dims);
           neighbor_status = (PointStatus) gridpoint_status[idx_neighbor2];
@@ -540,7 +650,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER2(
       neighbor1[l] = grid_idx[l] + offset[l];
       neighbor2[l] = grid_idx[l] + 2*offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor1,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor1,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor1, neighbor1, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor1];
@@ -558,7 +669,8 @@ LSMLIB_REAL FMM_EIKONAL_UPDATE_GRID_POINT_ORDER2(
           second_order_switch = 0;
 
           /* check for neighbor required for second-order accuracy */
-          LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor2,grid_dims);
+          LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                             neighbor2,grid_dims,periodic);
           if (!grid_idx_out_of_bounds) {
             LSM_FMM_IDX(idx_neighbor2, neighbor2, grid_dims);
             neighbor_status = (PointStatus) gridpoint_status[idx_neighbor2];
@@ -10,6 +10,10 @@
 /* Define required macros */
 #define FMM_NDIM                               3 
 #define FMM_EIKONAL_SOLVE_EIKONAL_EQUATION     solveEikonalEquation3d
+#define FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_WITH_WORKSPACE                  \
+        solveEikonalEquation3dWithWorkspace
+#define FMM_EIKONAL_SOLVE_EIKONAL_EQUATION_PERIODIC                        \
+        solveEikonalEquation3dPeriodic
 #define FMM_EIKONAL_INITIALIZE_FRONT           FMM_initializeFront_Eikonal3d
 #define FMM_EIKONAL_UPDATE_GRID_POINT_ORDER1                              \
         FMM_updateGridPoint_Eikonal3d_Order1
@@ -18,6 +18,18 @@
  *    -# FMM_COMPUTE_EXTENSION_FIELDS:  desired name of function
  *       that computes the extensions of fields off of the zero
  *       level set
+ *    -# FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE:  desired name 
+ *       of function that computes the distance function using a
+ *       user-provided (reusable) FMM_CoreData workspace
+ *    -# FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE:  desired name 
+ *       of function that computes the extension fields using a
+ *       user-provided (reusable) FMM_CoreData workspace
+ *    -# FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC:  desired name of
+ *       function that computes the distance function on a grid that
+ *       is periodic along user-specified coordinate directions
+ *    -# FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC:  desired name of
+ *       function that computes the extension fields on a grid that
+ *       is periodic along user-specified coordinate directions
  *    -# FMM_INITIALIZE_FRONT_ORDER1:  desired name of function that
  *       initializes the values on the front using a first-order scheme
  *    -# FMM_INITIALIZE_FRONT_ORDER2:  desired name of function that
@@ -73,6 +85,18 @@
 #ifndef FMM_COMPUTE_EXTENSION_FIELDS
 #error "lsm_FMM_field_extension: required macro FMM_COMPUTE_EXTENSION_FIELDS not defined!"
 #endif
+#ifndef FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE
+#error "lsm_FMM_field_extension: required macro FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE not defined!"
+#endif
+#ifndef FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE
+#error "lsm_FMM_field_extension: required macro FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE not defined!"
+#endif
+#ifndef FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC
+#error "lsm_FMM_field_extension: required macro FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC not defined!"
+#endif
+#ifndef FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC
+#error "lsm_FMM_field_extension: required macro FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC not defined!"
+#endif
 #ifndef FMM_INITIALIZE_FRONT_ORDER1
 #error "lsm_FMM_field_extension: required macro FMM_INITIALIZE_FRONT_ORDER1 not defined!"
 #endif
@@ -111,6 +135,29 @@ struct FMM_FieldData {
 
 /*============================ FMM Functions ===========================*/
 
+/*
+ * FMM_FieldExtension_computeExtensionFields() carries out the FMM
+ * calculation for all of the distance function and extension field
+ * drivers.  If fmm_workspace is NULL, a temporary FMM_CoreData with the
+ * specified periodic coordinate directions is created and destroyed;
+ * otherwise, fmm_workspace is reset and reused (and periodic is
+ * ignored in favor of the periodic coordinate directions of the
+ * workspace).
+ */
+static int FMM_FieldExtension_computeExtensionFields(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace,
+  int *periodic);
+
 /*
  * FMM_INITIALIZE_FRONT_ORDER1() implements the callback function
  * required by FMM_Core::FMM_initializeFront() to find and initialize
@@ -206,6 +253,91 @@ int FMM_COMPUTE_EXTENSION_FIELDS(
   int spatial_discretization_order,
   int *grid_dims,
   LSMLIB_REAL *dx)
+{
+  return FMM_FieldExtension_computeExtensionFields(
+           distance_function,
+           extension_fields,
+           phi,
+           source_fields,
+           num_extension_fields,
+           mask,
+           extension_field_mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           NULL,  /* NULL workspace pointer */
+           NULL); /* no periodic directions */
+}
+
+int FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace)
+{
+  return FMM_FieldExtension_computeExtensionFields(
+           distance_function,
+           extension_fields,
+           phi,
+           source_fields,
+           num_extension_fields,
+           mask,
+           extension_field_mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           fmm_workspace,
+           NULL); /* periodic directions taken from workspace */
+}
+
+int FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic)
+{
+  return FMM_FieldExtension_computeExtensionFields(
+           distance_function,
+           extension_fields,
+           phi,
+           source_fields,
+           num_extension_fields,
+           mask,
+           extension_field_mask,
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           NULL,  /* NULL workspace pointer */
+           periodic);
+}
+
+static int FMM_FieldExtension_computeExtensionFields(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace,
+  int *periodic)
 {
   /* fast marching method data */
   FMM_CoreData *fmm_core_data;
@@ -302,13 +434,23 @@ int FMM_COMPUTE_EXTENSION_FIELDS(
   /********************************************
    * initialize FMM Core Data
    ********************************************/
-  fmm_core_data = FMM_Core_createFMM_CoreData(
-    fmm_field_data,
-    FMM_NDIM,
-    grid_dims,
-    dx,
-    initializeFront,
-    updateGridPoint);
+  if (fmm_workspace) {
+    fmm_core_data = fmm_workspace;
+    FMM_Core_resetFMM_CoreData(
+      fmm_core_data,
+      fmm_field_data,
+      initializeFront,
+      updateGridPoint);
+  } else {
+    fmm_core_data = FMM_Core_createFMM_CoreData(
+      fmm_field_data,
+      FMM_NDIM,
+      grid_dims,
+      dx,
+      initializeFront,
+      updateGridPoint);
+    if (fmm_core_data) FMM_Core_setPeriodicDirections(fmm_core_data, periodic);
+  }
   if (!fmm_core_data) return LSM_FMM_ERR_FMM_DATA_CREATION_ERROR;
 
   /* mark grid points outside of domain */
@@ -346,7 +488,7 @@ int FMM_COMPUTE_EXTENSION_FIELDS(
   }
 
   /* clean up memory */
-  FMM_Core_destroyFMM_CoreData(fmm_core_data);
+  if (!fmm_workspace) FMM_Core_destroyFMM_CoreData(fmm_core_data);
   if (num_extension_fields > 0) {
     free(fmm_field_data->extension_fields_cur);
     free(fmm_field_data->extension_fields_sum_div_dist_sq);
@@ -373,7 +515,63 @@ int FMM_COMPUTE_DISTANCE_FUNCTION(
   int *grid_dims,
   LSMLIB_REAL *dx)
 {
-  return FMM_COMPUTE_EXTENSION_FIELDS(
+  return FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE(
+           distance_function,
+           NULL, /* NULL extension fields pointer */
+           phi,
+           NULL, /* NULL source fields pointer */
+           0, /* zero extension fields to compute */
+           mask,
+           NULL, /* NULL extension_field_mask pointer */
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           NULL); /* NULL workspace pointer */
+}
+
+/*
+ * FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE() just calls 
+ * FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE() with no source/extension 
+ * fields.
+ */
+int FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace)
+{
+  return FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE(
+           distance_function,
+           NULL, /* NULL extension fields pointer */
+           phi,
+           NULL, /* NULL source fields pointer */
+           0, /* zero extension fields to compute */
+           mask,
+           NULL, /* NULL extension_field_mask pointer */
+           spatial_discretization_order,
+           grid_dims,
+           dx,
+           fmm_workspace);
+}
+
+/*
+ * FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC() just calls
+ * FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC() with no source/extension
+ * fields.
+ */
+int FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic)
+{
+  return FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC(
            distance_function,
            NULL, /* NULL extension fields pointer */
            phi,
@@ -383,7 +581,8 @@ int FMM_COMPUTE_DISTANCE_FUNCTION(
            NULL, /* NULL extension_field_mask pointer */
            spatial_discretization_order,
            grid_dims,
-           dx);
+           dx,
+           periodic);
 }
 
 void FMM_INITIALIZE_FRONT_ORDER1(
@@ -394,6 +593,7 @@ void FMM_INITIALIZE_FRONT_ORDER1(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *phi = fmm_field_data->phi;
@@ -518,7 +718,8 @@ void FMM_INITIALIZE_FRONT_ORDER1(
         for (l = 0; l < FMM_NDIM; l++) {
           neighbor[l] = grid_idx[l] + offset[l];
         }
-        LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+        LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                           neighbor,grid_dims,periodic);
         if (!grid_idx_out_of_bounds) {
           LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
           phi_minus = phi[idx_neighbor];
@@ -552,7 +753,8 @@ void FMM_INITIALIZE_FRONT_ORDER1(
         for (l = 0; l < FMM_NDIM; l++) {
           neighbor[l] = grid_idx[l] + offset[l];
         }
-        LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+        LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                           neighbor,grid_dims,periodic);
         if (!grid_idx_out_of_bounds) {
           LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
           phi_plus = phi[idx_neighbor];
@@ -672,6 +874,7 @@ void FMM_INITIALIZE_FRONT_ORDER2(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *phi = fmm_field_data->phi;
@@ -790,6 +993,8 @@ void FMM_INITIALIZE_FRONT_ORDER2(
         neighbor_minus[l] = grid_idx[l];
       }
       neighbor_plus[dir]++; neighbor_minus[dir]--;
+      LSM_FMM_PERIODIC_WRAP(neighbor_plus, grid_dims, periodic);
+      LSM_FMM_PERIODIC_WRAP(neighbor_minus, grid_dims, periodic);
       LSM_FMM_IDX(idx_neighbor_plus, neighbor_plus, grid_dims);
       LSM_FMM_IDX(idx_neighbor_minus, neighbor_minus, grid_dims);
 
@@ -969,6 +1174,7 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER1(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *distance_function = fmm_field_data->distance_function;
@@ -1031,7 +1237,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER1(
     for (l = 0; l < FMM_NDIM; l++) {
       neighbor[l] = grid_idx[l] + offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor];
@@ -1047,7 +1254,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER1(
     for (l = 0; l < FMM_NDIM; l++) {
       neighbor[l] = grid_idx[l] + offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor];
@@ -1145,6 +1353,7 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER1(
         for (l = 0; l < FMM_NDIM; l++) {
           neighbor[l] = grid_idx[l] + offset[l];
         }
+        LSM_FMM_PERIODIC_WRAP(neighbor, grid_dims, periodic);
         LSM_FMM_IDX(idx_neighbor, neighbor, grid_dims);
 
         inv_dx_sq = 1/dx[dir]; inv_dx_sq *= inv_dx_sq;
@@ -1182,6 +1391,7 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
   LSMLIB_REAL *dx)
 {
   int *gridpoint_status = FMM_Core_getGridPointStatusDataArray(fmm_core_data);
+  int *periodic = FMM_Core_getPeriodicDirectionsArray(fmm_core_data);
 
   /* FMM Field Data variables */
   LSMLIB_REAL *distance_function = fmm_field_data->distance_function;
@@ -1252,7 +1462,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
       neighbor1[l] = grid_idx[l] + offset[l];
       neighbor2[l] = grid_idx[l] + 2*offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor1,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor1,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor1, neighbor1, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor1];
@@ -1262,7 +1473,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
         dir_used[dir] = LSM_FMM_TRUE;
 
         /* check for neighbor required for second-order accuracy */
-        LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor2,grid_dims);
+        LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                           neighbor2,grid_dims,periodic);
         if (!grid_idx_out_of_bounds) {
           LSM_FMM_IDX(idx_neighbor2, neighbor2, grid_dims);
           neighbor_status = (PointStatus) gridpoint_status[idx_neighbor2];
@@ -1283,7 +1495,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
       neighbor1[l] = grid_idx[l] + offset[l];
       neighbor2[l] = grid_idx[l] + 2*offset[l];
     }
-    LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor1,grid_dims);
+    LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                       neighbor1,grid_dims,periodic);
     if (!grid_idx_out_of_bounds) {
       LSM_FMM_IDX(idx_neighbor1, neighbor1, grid_dims);
       neighbor_status = (PointStatus) gridpoint_status[idx_neighbor1];
@@ -1303,7 +1516,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
           dir_used[dir] = LSM_FMM_TRUE;
 
           /* check for neighbor required for second-order accuracy */
-          LSM_FMM_IDX_OUT_OF_BOUNDS(grid_idx_out_of_bounds,neighbor2,grid_dims);
+          LSM_FMM_IDX_OUT_OF_BOUNDS_PERIODIC(grid_idx_out_of_bounds,
+                                             neighbor2,grid_dims,periodic);
           if (!grid_idx_out_of_bounds) {
             LSM_FMM_IDX(idx_neighbor2, neighbor2, grid_dims);
             neighbor_status = (PointStatus) gridpoint_status[idx_neighbor2];
@@ -1410,6 +1624,8 @@ LSMLIB_REAL FMM_UPDATE_GRID_POINT_ORDER2(
           neighbor1[l] = grid_idx[l] + offset[l];
           neighbor2[l] = grid_idx[l] + 2*offset[l];
         }
+        LSM_FMM_PERIODIC_WRAP(neighbor1, grid_dims, periodic);
+        LSM_FMM_PERIODIC_WRAP(neighbor2, grid_dims, periodic);
         LSM_FMM_IDX(idx_neighbor1, neighbor1, grid_dims);
         LSM_FMM_IDX(idx_neighbor2, neighbor2, grid_dims);
 
@@ -11,6 +11,14 @@
 #define FMM_NDIM                         2
 #define FMM_COMPUTE_DISTANCE_FUNCTION    computeDistanceFunction2d
 #define FMM_COMPUTE_EXTENSION_FIELDS     computeExtensionFields2d
+#define FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE                        \
+        computeDistanceFunction2dWithWorkspace
+#define FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE                         \
+        computeExtensionFields2dWithWorkspace
+#define FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC                              \
+        computeDistanceFunction2dPeriodic
+#define FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC                               \
+        computeExtensionFields2dPeriodic
 #define FMM_INITIALIZE_FRONT_ORDER1                                         \
         FMM_initializeFront_FieldExtension2d_Order1
 #define FMM_INITIALIZE_FRONT_ORDER2                                         \
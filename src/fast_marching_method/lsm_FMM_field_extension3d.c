@@ -11,6 +11,14 @@
 #define FMM_NDIM                         3
 #define FMM_COMPUTE_DISTANCE_FUNCTION    computeDistanceFunction3d
 #define FMM_COMPUTE_EXTENSION_FIELDS     computeExtensionFields3d
+#define FMM_COMPUTE_DISTANCE_FUNCTION_WITH_WORKSPACE                        \
+        computeDistanceFunction3dWithWorkspace
+#define FMM_COMPUTE_EXTENSION_FIELDS_WITH_WORKSPACE                         \
+        computeExtensionFields3dWithWorkspace
+#define FMM_COMPUTE_DISTANCE_FUNCTION_PERIODIC                              \
+        computeDistanceFunction3dPeriodic
+#define FMM_COMPUTE_EXTENSION_FIELDS_PERIODIC                               \
+        computeExtensionFields3dPeriodic
 #define FMM_INITIALIZE_FRONT_ORDER1                                         \
         FMM_initializeFront_FieldExtension3d_Order1
 #define FMM_INITIALIZE_FRONT_ORDER2                                         \
@@ -468,6 +468,311 @@ int solveEikonalEquation3d(
   int *grid_dims,
   LSMLIB_REAL *dx);
 
+/*!
+ * computeExtensionFields2dWithWorkspace() and 
+ * computeExtensionFields3dWithWorkspace() are identical to
+ * computeExtensionFields2d() and computeExtensionFields3d() except
+ * that the internal FMM data structures (heap, grid point status and 
+ * heap node handles) are taken from a user-provided FMM_CoreData 
+ * workspace instead of being allocated and freed on every call.
+ *
+ * Arguments:
+ *  - fmm_workspace (in/out):  FMM_CoreData created by 
+ *                             FMM_Core_createFMM_CoreData() with the
+ *                             same num_dims, grid_dims and dx as the 
+ *                             calculation (field data and callback 
+ *                             functions may be NULL).  If fmm_workspace
+ *                             is NULL, a temporary workspace is used.
+ *  - all other arguments:     see computeExtensionFields2d() and
+ *                             computeExtensionFields3d()
+ *
+ * Return value:               error code (see NOTES for translation)
+ *
+ * NOTES:
+ *  - A workspace may be reused for any number of calculations but 
+ *    must not be shared by calculations that run concurrently.
+ *
+ */
+int computeExtensionFields2dWithWorkspace(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+int computeExtensionFields3dWithWorkspace(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+/*!
+ * computeDistanceFunction2dWithWorkspace() and 
+ * computeDistanceFunction3dWithWorkspace() are identical to
+ * computeDistanceFunction2d() and computeDistanceFunction3d() except
+ * that they reuse a user-provided FMM_CoreData workspace (see
+ * computeExtensionFields2dWithWorkspace()).
+ *
+ * Arguments:
+ *  - fmm_workspace (in/out):  reusable FMM_CoreData workspace (or NULL)
+ *  - all other arguments:     see computeDistanceFunction2d() and
+ *                             computeDistanceFunction3d()
+ *
+ * Return value:               error code (see NOTES for translation)
+ *
+ */
+int computeDistanceFunction2dWithWorkspace(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+int computeDistanceFunction3dWithWorkspace(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+/*!
+ * solveEikonalEquation2dWithWorkspace() and
+ * solveEikonalEquation3dWithWorkspace() are identical to
+ * solveEikonalEquation2d() and solveEikonalEquation3d() except
+ * that they reuse a user-provided FMM_CoreData workspace (see
+ * computeExtensionFields2dWithWorkspace()).
+ *
+ * Arguments:
+ *  - fmm_workspace (in/out):  reusable FMM_CoreData workspace (or NULL)
+ *  - all other arguments:     see solveEikonalEquation2d() and
+ *                             solveEikonalEquation3d()
+ *
+ * Return value:               error code (see NOTES for translation)
+ *
+ */
+int solveEikonalEquation2dWithWorkspace(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+int solveEikonalEquation3dWithWorkspace(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  FMM_CoreData *fmm_workspace);
+
+/*!
+ * computeExtensionFields2dPeriodic() and 
+ * computeExtensionFields3dPeriodic() are identical to
+ * computeExtensionFields2d() and computeExtensionFields3d() except
+ * that the grid is periodic along the specified coordinate directions.
+ *
+ * Arguments:
+ *  - periodic (in):       integer array with a nonzero entry for each
+ *                         periodic coordinate direction (NULL for none)
+ *  - all other arguments: see computeExtensionFields2d() and
+ *                         computeExtensionFields3d()
+ *
+ * Return value:           error code (see NOTES for translation)
+ *
+ * NOTES:
+ *  - Along a periodic coordinate direction, the first and last grid 
+ *    points are neighbors, both when the front is initialized and 
+ *    when the front is advanced.  The period is grid_dims*dx, so the 
+ *    grid should hold exactly one period of the data (without ghost
+ *    cells or a duplicate of the first grid point at the end).
+ *
+ *  - Distance functions on periodic representative volumes can thus
+ *    be computed without tiling copies of the domain around the grid.
+ *
+ *  - To reuse a workspace for periodic calculations, set the periodic
+ *    coordinate directions of the workspace using 
+ *    FMM_Core_setPeriodicDirections() and use 
+ *    computeExtensionFields2dWithWorkspace() or
+ *    computeExtensionFields3dWithWorkspace().
+ *
+ */
+int computeExtensionFields2dPeriodic(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+int computeExtensionFields3dPeriodic(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+/*!
+ * computeDistanceFunction2dPeriodic() and 
+ * computeDistanceFunction3dPeriodic() are identical to
+ * computeDistanceFunction2d() and computeDistanceFunction3d() except
+ * that the grid is periodic along the specified coordinate directions
+ * (see computeExtensionFields2dPeriodic()).
+ *
+ * Arguments:
+ *  - periodic (in):       integer array with a nonzero entry for each
+ *                         periodic coordinate direction (NULL for none)
+ *  - all other arguments: see computeDistanceFunction2d() and
+ *                         computeDistanceFunction3d()
+ *
+ * Return value:           error code (see NOTES for translation)
+ *
+ */
+int computeDistanceFunction2dPeriodic(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+int computeDistanceFunction3dPeriodic(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+/*!
+ * solveEikonalEquation2dPeriodic() and
+ * solveEikonalEquation3dPeriodic() are identical to
+ * solveEikonalEquation2d() and solveEikonalEquation3d() except
+ * that the grid is periodic along the specified coordinate directions
+ * (see computeExtensionFields2dPeriodic()).
+ *
+ * Arguments:
+ *  - periodic (in):       integer array with a nonzero entry for each
+ *                         periodic coordinate direction (NULL for none)
+ *  - all other arguments: see solveEikonalEquation2d() and
+ *                         solveEikonalEquation3d()
+ *
+ * Return value:           error code (see NOTES for translation)
+ *
+ */
+int solveEikonalEquation2dPeriodic(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+int solveEikonalEquation3dPeriodic(
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *speed,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx,
+  int *periodic);
+
+/*!
+ * computeExtensionFields3dCompact() is identical to
+ * computeExtensionFields3d() except that the fast marching method is
+ * carried out on a compact list of the grid points inside the domain
+ * (mask >= 0) instead of on the full grid.
+ *
+ * Arguments:
+ *  - all arguments:  see computeExtensionFields3d()
+ *
+ * Return value:      error code (see NOTES for translation)
+ *
+ * NOTES:
+ *  - The grid points inside the domain are first collected in an
+ *    active list together with a table of their six neighbors in the
+ *    active list.  The grid point status, heap node handles, distance
+ *    function and extension fields are stored for the active points
+ *    only and the results are scattered to the full grid at the end,
+ *    so the memory and the work of the march scale with the number of
+ *    points inside the domain (e.g. the pore space of a porous medium)
+ *    rather than with the size of the grid.
+ *
+ *  - The full grid is only scanned to build the active list, to
+ *    initialize the front (which reads phi at masked neighbors in the
+ *    same way as computeExtensionFields3d()) and to write the results.
+ *
+ *  - The results are identical to those of computeExtensionFields3d().
+ *
+ *  - Only the first-order spatial discretization is supported;
+ *    spatial_discretization_order = 2 returns error code 2.
+ *
+ */
+int computeExtensionFields3dCompact(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL **extension_fields,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL **source_fields,
+  int num_extension_fields,
+  LSMLIB_REAL *mask,
+  LSMLIB_REAL *extension_field_mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx);
+
+/*!
+ * computeDistanceFunction3dCompact() is identical to
+ * computeDistanceFunction3d() except that the fast marching method is
+ * carried out on a compact list of the grid points inside the domain
+ * (see computeExtensionFields3dCompact()).
+ *
+ * Arguments:
+ *  - all arguments:  see computeDistanceFunction3d()
+ *
+ * Return value:      error code (see NOTES for translation)
+ *
+ */
+int computeDistanceFunction3dCompact(
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *mask,
+  int spatial_discretization_order,
+  int *grid_dims,
+  LSMLIB_REAL *dx);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,495 @@
+/*
+ * File:        lsm_cut_cells3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of 3D cut cell geometry routines
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "lsmlib_config.h"
+#include "lsm_cut_cells3d.h"
+#include "lsm_geometry3d.h"
+#include "lsm_runtime.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Number of candidate cells per chunk.  Cut cells are counted per chunk
+ * in a first pass and written at the prefix sum of the counts in a
+ * second pass, so the chunks fix the output order.
+ */
+#define LSM_CUT_CELLS_CHUNK_SIZE                    (256)
+
+/*
+ * Structure 'LSM_CutCellsArgs' holds the arguments shared by all
+ * threads.
+ */
+typedef struct _LSM_CutCellsArgs
+{
+  LSM_CutCell3d *cut_cells;
+  const LSMLIB_REAL *phi;
+  const Grid *grid;
+  const int *index_x, *index_y, *index_z;
+  int nlo_index, nhi_index;
+  int *chunk_counts;
+} LSM_CutCellsArgs;
+
+
+/*
+ * sampleCell() computes the samples s[c][b][a] of phi at the points
+ * x_(i,j,k) + ((a-1)*dx/2, (b-1)*dy/2, (c-1)*dz/2) of the cell of grid
+ * point (i,j,k) by averaging the neighboring grid point values, one
+ * coordinate direction at a time.  Returns 1 if phi changes sign among
+ * the samples (the cell is cut) and 0 otherwise.
+ */
+static int sampleCell(
+  LSMLIB_REAL s[3][3][3],
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  int i, int j, int k)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  LSMLIB_REAL sx[3][3][3], sy[3][3][3];
+  LSMLIB_REAL s_min, s_max;
+  int a, b, c;
+
+  for (c = 0; c < 3; c++) {
+    for (b = 0; b < 3; b++) {
+      const LSMLIB_REAL *row = &(phi[i + (j+b-1)*nx + (k+c-1)*nxy]);
+      sx[c][b][0] = 0.5*(row[-1] + row[0]);
+      sx[c][b][1] = row[0];
+      sx[c][b][2] = 0.5*(row[0] + row[1]);
+    }
+  }
+  for (c = 0; c < 3; c++) {
+    for (a = 0; a < 3; a++) {
+      sy[c][0][a] = 0.5*(sx[c][0][a] + sx[c][1][a]);
+      sy[c][1][a] = sx[c][1][a];
+      sy[c][2][a] = 0.5*(sx[c][1][a] + sx[c][2][a]);
+    }
+  }
+  for (b = 0; b < 3; b++) {
+    for (a = 0; a < 3; a++) {
+      s[0][b][a] = 0.5*(sy[0][b][a] + sy[1][b][a]);
+      s[1][b][a] = sy[1][b][a];
+      s[2][b][a] = 0.5*(sy[1][b][a] + sy[2][b][a]);
+    }
+  }
+
+  s_min = s_max = s[0][0][0];
+  for (c = 0; c < 3; c++) {
+    for (b = 0; b < 3; b++) {
+      for (a = 0; a < 3; a++) {
+        if (s[c][b][a] < s_min) s_min = s[c][b][a];
+        if (s[c][b][a] > s_max) s_max = s[c][b][a];
+      }
+    }
+  }
+  return (s_min < 0) && (s_max > 0);
+}
+
+
+/*
+ * computeCrossingFraction() returns the position of the zero of the
+ * linear interpolant between a corner with value phi_a and a corner with
+ * value phi_b (of opposite sign or zero) as a fraction of the edge
+ * measured from the first corner.
+ */
+static LSMLIB_REAL computeCrossingFraction(
+  LSMLIB_REAL phi_a,
+  LSMLIB_REAL phi_b)
+{
+  return phi_a/(phi_a - phi_b);
+}
+
+
+/*
+ * computeTriangleFraction() returns the fraction of the area of a
+ * triangle where the linear interpolant of the corner values phi is
+ * negative.
+ */
+static LSMLIB_REAL computeTriangleFraction(const LSMLIB_REAL *phi)
+{
+  int neg[3], pos[3];
+  int num_neg = 0, num_pos = 0;
+  int m;
+
+  for (m = 0; m < 3; m++) {
+    if (phi[m] < 0) neg[num_neg++] = m; else pos[num_pos++] = m;
+  }
+
+  if (num_neg == 0) return 0.0;
+  if (num_pos == 0) return 1.0;
+  if (num_neg == 1) {
+    return computeCrossingFraction(phi[neg[0]], phi[pos[0]])
+         * computeCrossingFraction(phi[neg[0]], phi[pos[1]]);
+  }
+  return 1.0 - computeCrossingFraction(phi[pos[0]], phi[neg[0]])
+             * computeCrossingFraction(phi[pos[0]], phi[neg[1]]);
+}
+
+
+/*
+ * computeDeterminant4() returns the determinant of the 4x4 matrix whose
+ * rows are p, q, r and t.
+ */
+static LSMLIB_REAL computeDeterminant4(
+  const LSMLIB_REAL *p,
+  const LSMLIB_REAL *q,
+  const LSMLIB_REAL *r,
+  const LSMLIB_REAL *t)
+{
+  LSMLIB_REAL m01 = r[0]*t[1] - r[1]*t[0];
+  LSMLIB_REAL m02 = r[0]*t[2] - r[2]*t[0];
+  LSMLIB_REAL m03 = r[0]*t[3] - r[3]*t[0];
+  LSMLIB_REAL m12 = r[1]*t[2] - r[2]*t[1];
+  LSMLIB_REAL m13 = r[1]*t[3] - r[3]*t[1];
+  LSMLIB_REAL m23 = r[2]*t[3] - r[3]*t[2];
+
+  return p[0]*(q[1]*m23 - q[2]*m13 + q[3]*m12)
+       - p[1]*(q[0]*m23 - q[2]*m03 + q[3]*m02)
+       + p[2]*(q[0]*m13 - q[1]*m03 + q[3]*m01)
+       - p[3]*(q[0]*m12 - q[1]*m02 + q[2]*m01);
+}
+
+
+/*
+ * computeTetrahedronFraction() returns the fraction of the volume of a
+ * tetrahedron where the linear interpolant of the corner values phi is
+ * negative.
+ */
+static LSMLIB_REAL computeTetrahedronFraction(const LSMLIB_REAL *phi)
+{
+  int neg[4], pos[4];
+  int num_neg = 0, num_pos = 0;
+  int m;
+
+  for (m = 0; m < 4; m++) {
+    if (phi[m] < 0) neg[num_neg++] = m; else pos[num_pos++] = m;
+  }
+
+  if (num_neg == 0) return 0.0;
+  if (num_pos == 0) return 1.0;
+  if (num_neg == 1) {
+    LSMLIB_REAL fraction = 1.0;
+    for (m = 0; m < 3; m++) {
+      fraction *= computeCrossingFraction(phi[neg[0]], phi[pos[m]]);
+    }
+    return fraction;
+  }
+  if (num_neg == 3) {
+    LSMLIB_REAL fraction = 1.0;
+    for (m = 0; m < 3; m++) {
+      fraction *= computeCrossingFraction(phi[pos[0]], phi[neg[m]]);
+    }
+    return 1.0 - fraction;
+  }
+
+  /*
+   * two negative corners a and b:  the negative region is a prism with
+   * the triangles (a, on a-c, on a-d) and (b, on b-c, on b-d) as ends;
+   * its volume is the sum of the volumes of three tetrahedra, computed
+   * in barycentric coordinates
+   */
+  {
+    LSMLIB_REAL v[6][4] = {{0}};
+    int a = neg[0], b = neg[1], c = pos[0], d = pos[1];
+    LSMLIB_REAL t;
+
+    v[0][a] = 1.0;
+    t = computeCrossingFraction(phi[a], phi[c]);
+    v[1][a] = 1.0 - t;  v[1][c] = t;
+    t = computeCrossingFraction(phi[a], phi[d]);
+    v[2][a] = 1.0 - t;  v[2][d] = t;
+    v[3][b] = 1.0;
+    t = computeCrossingFraction(phi[b], phi[c]);
+    v[4][b] = 1.0 - t;  v[4][c] = t;
+    t = computeCrossingFraction(phi[b], phi[d]);
+    v[5][b] = 1.0 - t;  v[5][d] = t;
+
+    return fabs(computeDeterminant4(v[0], v[1], v[2], v[5]))
+         + fabs(computeDeterminant4(v[0], v[1], v[4], v[5]))
+         + fabs(computeDeterminant4(v[0], v[3], v[4], v[5]));
+  }
+}
+
+
+/*
+ * computeCutCell() computes the geometry of the cut cell of grid point
+ * (i,j,k) from its samples (see sampleCell()).
+ */
+static void computeCutCell(
+  LSM_CutCell3d *cell,
+  LSMLIB_REAL s[3][3][3],
+  const Grid *grid,
+  int i, int j, int k)
+{
+  const LSMLIB_REAL *dx = grid->dx;
+  LSMLIB_REAL h[3], x_center[3];
+  LSMLIB_REAL volume_sum = 0.0;
+  LSMLIB_REAL area_vector[3] = {0.0, 0.0, 0.0};
+  LSMLIB_REAL centroid_sum[3] = {0.0, 0.0, 0.0};
+  LSMLIB_REAL area_sum = 0.0, area;
+  int octant, tet, face, n;
+
+  cell->index[0] = i;  cell->index[1] = j;  cell->index[2] = k;
+  for (n = 0; n < 3; n++) {
+    h[n] = 0.5*dx[n];
+    x_center[n] = grid->x_lo_ghostbox[n] + (cell->index[n] + 0.5)*dx[n];
+  }
+
+  /* volume fraction and interface:  six tetrahedra in each octant */
+  for (octant = 0; octant < 8; octant++) {
+    int o[3] = {octant & 1, (octant >> 1) & 1, (octant >> 2) & 1};
+    LSMLIB_REAL phi_corner[8], x_corner[8][3];
+    int corner;
+
+    for (corner = 0; corner < 8; corner++) {
+      int c[3] = {o[0] + (corner & 1), o[1] + ((corner >> 1) & 1),
+                  o[2] + ((corner >> 2) & 1)};
+      phi_corner[corner] = s[c[2]][c[1]][c[0]];
+      for (n = 0; n < 3; n++) x_corner[corner][n] = (c[n] - 1)*h[n];
+    }
+
+    for (tet = 0; tet < LSM3D_NUM_CUBE_TETRAHEDRA; tet++) {
+      LSMLIB_REAL phi_tet[4], vertices[12], piece[3] = {0.0, 0.0, 0.0};
+      LSMLIB_REAL x_in[3] = {0.0, 0.0, 0.0}, x_out[3] = {0.0, 0.0, 0.0};
+      LSMLIB_REAL piece_area, orientation = 0.0;
+      int corners[4], num_vertices, m;
+
+      LSM3D_getCubeTetrahedron(tet, corners);
+      for (m = 0; m < 4; m++) phi_tet[m] = phi_corner[corners[m]];
+      volume_sum += computeTetrahedronFraction(phi_tet);
+
+      num_vertices = LSM3D_findSurfaceInTetrahedron(vertices,
+        x_corner[corners[0]], x_corner[corners[1]],
+        x_corner[corners[2]], x_corner[corners[3]], phi_tet);
+      if (num_vertices == 0) continue;
+
+      /* area vector of the (planar) triangle or quadrilateral */
+      for (m = 1; m < num_vertices - 1; m++) {
+        LSMLIB_REAL e1[3], e2[3];
+        for (n = 0; n < 3; n++) {
+          e1[n] = vertices[3*m+n] - vertices[n];
+          e2[n] = vertices[3*(m+1)+n] - vertices[n];
+        }
+        piece[0] += 0.5*(e1[1]*e2[2] - e1[2]*e2[1]);
+        piece[1] += 0.5*(e1[2]*e2[0] - e1[0]*e2[2]);
+        piece[2] += 0.5*(e1[0]*e2[1] - e1[1]*e2[0]);
+      }
+
+      /* orient the area vector from phi < 0 to phi >= 0 */
+      for (m = 0; m < 4; m++) {
+        for (n = 0; n < 3; n++) {
+          if (phi_tet[m] < 0) x_in[n] = x_corner[corners[m]][n];
+          else x_out[n] = x_corner[corners[m]][n];
+        }
+      }
+      for (n = 0; n < 3; n++) orientation += piece[n]*(x_out[n] - x_in[n]);
+      if (orientation < 0) {
+        for (n = 0; n < 3; n++) piece[n] = -piece[n];
+      }
+
+      /* accumulate area vector and area-weighted centroid */
+      piece_area = sqrt(piece[0]*piece[0] + piece[1]*piece[1]
+                      + piece[2]*piece[2]);
+      for (n = 0; n < 3; n++) {
+        LSMLIB_REAL x_mean = 0.0;
+        for (m = 0; m < num_vertices; m++) x_mean += vertices[3*m+n];
+        area_vector[n] += piece[n];
+        centroid_sum[n] += piece_area*x_mean/num_vertices;
+      }
+      area_sum += piece_area;
+    }
+  }
+  cell->volume_fraction = volume_sum/(8*LSM3D_NUM_CUBE_TETRAHEDRA);
+
+  area = sqrt(area_vector[0]*area_vector[0] + area_vector[1]*area_vector[1]
+            + area_vector[2]*area_vector[2]);
+  cell->interface_area = area;
+  for (n = 0; n < 3; n++) {
+    cell->interface_centroid[n] = x_center[n]
+      + ( (area_sum > 0) ? centroid_sum[n]/area_sum : 0.0 );
+    cell->interface_normal[n] = (area > 0) ? area_vector[n]/area : 0.0;
+  }
+  if (area == 0) cell->interface_normal[0] = 1.0;
+
+  /*
+   * face apertures:  each face consists of four quarters, which are
+   * split into two triangles along the diagonal from the lower to the
+   * upper corner (the faces of the tetrahedra of the adjacent octants)
+   */
+  for (face = 0; face < 6; face++) {
+    int axis = face/2;
+    int u = (axis == 0) ? 1 : 0;
+    int v = (axis == 2) ? 1 : 2;
+    LSMLIB_REAL aperture_sum = 0.0;
+    int quarter;
+
+    for (quarter = 0; quarter < 4; quarter++) {
+      LSMLIB_REAL phi_quad[2][2], phi_tri[3];
+      int du, dv;
+
+      for (du = 0; du < 2; du++) {
+        for (dv = 0; dv < 2; dv++) {
+          int c[3];
+          c[axis] = 2*(face % 2);
+          c[u] = (quarter & 1) + du;
+          c[v] = ((quarter >> 1) & 1) + dv;
+          phi_quad[du][dv] = s[c[2]][c[1]][c[0]];
+        }
+      }
+
+      phi_tri[0] = phi_quad[0][0];
+      phi_tri[1] = phi_quad[1][0];
+      phi_tri[2] = phi_quad[1][1];
+      aperture_sum += computeTriangleFraction(phi_tri);
+      phi_tri[1] = phi_quad[0][1];
+      aperture_sum += computeTriangleFraction(phi_tri);
+    }
+    cell->aperture[face] = aperture_sum/8;
+  }
+}
+
+
+/*
+ * isInteriorCandidate() returns 1 if the cell of grid point (i,j,k) has
+ * all neighbors needed by sampleCell().
+ */
+static int isInteriorCandidate(const Grid *grid, int i, int j, int k)
+{
+  return (i > grid->ilo_gb) && (i < grid->ihi_gb)
+      && (j > grid->jlo_gb) && (j < grid->jhi_gb)
+      && (k > grid->klo_gb) && (k < grid->khi_gb);
+}
+
+
+/*
+ * countCutCells() is the LSM_Runtime_parallelFor() body for the first
+ * pass of computeCutCells3d().  Iterations correspond to chunks of
+ * candidate cells.
+ */
+static void countCutCells(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_CutCellsArgs *args = (LSM_CutCellsArgs *) user_data;
+  int chunk, m;
+
+  (void) thread_num;
+
+  for (chunk = begin; chunk < end; chunk++) {
+    int m_lo = args->nlo_index + chunk*LSM_CUT_CELLS_CHUNK_SIZE;
+    int m_hi = m_lo + LSM_CUT_CELLS_CHUNK_SIZE - 1;
+    int count = 0;
+    if (m_hi > args->nhi_index) m_hi = args->nhi_index;
+
+    for (m = m_lo; m <= m_hi; m++) {
+      LSMLIB_REAL s[3][3][3];
+      int i = args->index_x[m], j = args->index_y[m], k = args->index_z[m];
+      if (!isInteriorCandidate(args->grid, i, j, k)) continue;
+      count += sampleCell(s, args->phi, args->grid, i, j, k);
+    }
+    args->chunk_counts[chunk] = count;
+  }
+}
+
+
+/*
+ * writeCutCells() is the LSM_Runtime_parallelFor() body for the second
+ * pass of computeCutCells3d().  chunk_counts holds the position of the
+ * first cut cell of each chunk in the output.
+ */
+static void writeCutCells(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_CutCellsArgs *args = (LSM_CutCellsArgs *) user_data;
+  int chunk, m;
+
+  (void) thread_num;
+
+  for (chunk = begin; chunk < end; chunk++) {
+    int m_lo = args->nlo_index + chunk*LSM_CUT_CELLS_CHUNK_SIZE;
+    int m_hi = m_lo + LSM_CUT_CELLS_CHUNK_SIZE - 1;
+    LSM_CutCell3d *cell = args->cut_cells + args->chunk_counts[chunk];
+    if (m_hi > args->nhi_index) m_hi = args->nhi_index;
+
+    for (m = m_lo; m <= m_hi; m++) {
+      LSMLIB_REAL s[3][3][3];
+      int i = args->index_x[m], j = args->index_y[m], k = args->index_z[m];
+      if (!isInteriorCandidate(args->grid, i, j, k)) continue;
+      if (!sampleCell(s, args->phi, args->grid, i, j, k)) continue;
+      computeCutCell(cell++, s, args->grid, i, j, k);
+    }
+  }
+}
+
+
+/*======================== Cut Cell Functions ========================*/
+
+int computeCutCells3d(
+  LSM_CutCell3d *cut_cells,
+  int *num_cut_cells,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index)
+{
+  LSM_CutCellsArgs args;
+  int num_chunks, chunk, offset;
+
+  if ( (!num_cut_cells) || (!phi) || (!grid) || (grid->num_dims != 3) ) {
+    return LSM_CUT_CELLS_ERR_INVALID_ARGUMENT;
+  }
+  *num_cut_cells = 0;
+  if (nhi_index < nlo_index) return LSM_CUT_CELLS_ERR_SUCCESS;
+  if ( (!cut_cells) || (!index_x) || (!index_y) || (!index_z) ) {
+    return LSM_CUT_CELLS_ERR_INVALID_ARGUMENT;
+  }
+
+  num_chunks = (nhi_index - nlo_index + LSM_CUT_CELLS_CHUNK_SIZE)
+             / LSM_CUT_CELLS_CHUNK_SIZE;
+  args.chunk_counts = (int *) malloc(num_chunks*sizeof(int));
+  if (!args.chunk_counts) return LSM_CUT_CELLS_ERR_MEMORY_ALLOCATION;
+
+  args.cut_cells = cut_cells;
+  args.phi = phi;
+  args.grid = grid;
+  args.index_x = index_x;
+  args.index_y = index_y;
+  args.index_z = index_z;
+  args.nlo_index = nlo_index;
+  args.nhi_index = nhi_index;
+
+  /* count cut cells per chunk and convert counts to output positions */
+  LSM_Runtime_parallelFor(0, num_chunks, LSM_SCHEDULE_STATIC, 0, 0,
+                          countCutCells, &args);
+  offset = 0;
+  for (chunk = 0; chunk < num_chunks; chunk++) {
+    int count = args.chunk_counts[chunk];
+    args.chunk_counts[chunk] = offset;
+    offset += count;
+  }
+
+  LSM_Runtime_parallelFor(0, num_chunks, LSM_SCHEDULE_DYNAMIC, 0, 0,
+                          writeCutCells, &args);
+
+  free(args.chunk_counts);
+  *num_cut_cells = offset;
+  return LSM_CUT_CELLS_ERR_SUCCESS;
+}
@@ -0,0 +1,146 @@
+/*
+ * File:        lsm_cut_cells3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for 3D cut cell geometry (volume fractions,
+ *              face apertures and interface centroids/normals)
+ */
+
+#ifndef INCLUDED_LSM_CUT_CELLS_3D_H
+#define INCLUDED_LSM_CUT_CELLS_3D_H
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lsm_cut_cells3d.h
+ *
+ * \brief
+ * @ref lsm_cut_cells3d.h provides support for computing the embedded
+ * boundary geometry of the region \f$ \{ \phi < 0 \} \f$ in the grid
+ * cells cut by the zero level set:  volume fractions, face apertures,
+ * and the area, centroid and unit normal of the interface in each cell.
+ *
+ * The cell of grid point (i,j,k) is its control volume (the box of size
+ * dx by dy by dz centered on the grid point), i.e. the cells are the
+ * same as the ones summed over by LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO()
+ * (see @ref lsm_geometry3d.h).  \f$ \phi \f$ is sampled at the center,
+ * face centers, edge midpoints and corners of the cell by averaging the
+ * neighboring grid point values.  Each of the eight octants of the cell
+ * is decomposed into six tetrahedra (see LSM3D_getCubeTetrahedron()),
+ * and all quantities are computed exactly for the linear interpolant of
+ * \f$ \phi \f$ in each tetrahedron.  Because the samples on a face are
+ * shared by the two cells that contain it, the apertures of the face
+ * computed from both sides are identical.
+ *
+ * All quantities are computed in a single pass over the level 0 narrow
+ * band, which is distributed across the threads of the LSMLIB runtime
+ * (see @ref lsm_runtime.h).  Only cut cells are written to the output.
+ *
+ */
+
+#include "lsm_grid.h"
+
+
+/*!
+ * Error codes returned by cut cell functions.
+ */
+#define LSM_CUT_CELLS_ERR_SUCCESS                   (0)
+#define LSM_CUT_CELLS_ERR_INVALID_ARGUMENT          (1)
+#define LSM_CUT_CELLS_ERR_MEMORY_ALLOCATION         (2)
+
+/*!
+ * Faces of a cell in the aperture array of LSM_CutCell3d.
+ */
+#define LSM_CUT_CELL_FACE_X_LO                      (0)
+#define LSM_CUT_CELL_FACE_X_HI                      (1)
+#define LSM_CUT_CELL_FACE_Y_LO                      (2)
+#define LSM_CUT_CELL_FACE_Y_HI                      (3)
+#define LSM_CUT_CELL_FACE_Z_LO                      (4)
+#define LSM_CUT_CELL_FACE_Z_HI                      (5)
+
+/*!
+ * Structure 'LSM_CutCell3d' holds the geometry of one cut cell.
+ */
+typedef struct _LSM_CutCell3d
+{
+  int          index[3];               /* grid point (i,j,k) of the cell  */
+  LSMLIB_REAL  volume_fraction;        /* fraction of the cell volume     */
+                                       /* with phi < 0                    */
+  LSMLIB_REAL  aperture[6];            /* fraction of the area of each    */
+                                       /* face with phi < 0               */
+  LSMLIB_REAL  interface_area;         /* area of the zero level set      */
+  LSMLIB_REAL  interface_centroid[3];  /* centroid of the zero level set  */
+  LSMLIB_REAL  interface_normal[3];    /* unit normal pointing out of     */
+                                       /* the region phi < 0              */
+} LSM_CutCell3d;
+
+
+/*!
+ * computeCutCells3d() computes the cut cell geometry of the region
+ * \f$ \{ \phi < 0 \} \f$ for the cells of the level 0 narrow band.
+ *
+ * Arguments:
+ *  - cut_cells (out):      geometry of the cut cells
+ *  - num_cut_cells (out):  number of cut cells
+ *  - phi (in):             level set function
+ *  - grid (in):            pointer to Grid
+ *  - index_* (in):         narrow band indices (see
+ *                          LSM3D_DETERMINE_NARROW_BAND())
+ *  - nlo_index,
+ *    nhi_index (in):       index range of the candidate cells in the
+ *                          index_* arrays (usually n_lo[0] and n_hi[0])
+ *
+ * Return value:            error code
+ *
+ * NOTES:
+ *  - A cell is cut if \f$ \phi \f$ changes sign among its samples.
+ *    The narrow band must contain all cut cells; for a signed distance
+ *    function, a narrow band width of sqrt(dx^2 + dy^2 + dz^2) is
+ *    sufficient.
+ *
+ *  - cut_cells must have (nhi_index - nlo_index + 1) elements.  The cut
+ *    cells are written in the order of the index_* arrays, so the
+ *    result does not depend on the number of threads.
+ *
+ *  - Cells on the boundary of the ghostbox are skipped because their
+ *    samples require the neighboring grid points.
+ *
+ *  - interface_area is the magnitude of the sum of the area vectors of
+ *    the pieces of the interface in the cell, so the discrete divergence
+ *    theorem holds exactly:  for each coordinate direction,
+ *    (aperture[hi] - aperture[lo]) * (face area) + interface_area *
+ *    interface_normal = 0.
+ *
+ *  - The sum of the volume fractions of the cut cells and the number of
+ *    cells with \f$ \phi < 0 \f$ at all samples, times the cell volume,
+ *    is the volume of the same region that
+ *    LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO() approximates with a
+ *    smoothed Heaviside function.
+ *
+ *  - If the interface area is zero (e.g. when the pieces of the
+ *    interface cancel), the unit normal is arbitrarily set to be
+ *    (1.0, 0.0, 0.0).
+ *
+ */
+int computeCutCells3d(
+  LSM_CutCell3d *cut_cells,
+  int *num_cut_cells,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,6 +24,11 @@ extern "C" {
  * @ref lsm_geometry1d.h provides support for computing various geometric
  * quantities in one space dimension.
  *
+ * Sums over grid points (e.g. the size of the zero level set and of the
+ * regions where phi is positive or negative) use compensated (Kahan)
+ * summation with a double-precision accumulator (see the
+ * USE_DOUBLE_PRECISION_ACCUMULATION build option).
+ *
  */
 
 
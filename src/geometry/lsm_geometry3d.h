@@ -24,6 +24,11 @@ extern "C" {
  * @ref lsm_geometry3d.h provides support for computing various geometric
  * quantities in three space dimensions.
  *
+ * Sums over grid points (e.g. the size of the zero level set and of the
+ * regions where phi is positive or negative) use compensated (Kahan)
+ * summation with a double-precision accumulator (see the
+ * USE_DOUBLE_PRECISION_ACCUMULATION build option).
+ *
  */
 
 
@@ -664,6 +669,90 @@ int LSM3D_findLineInTetrahedron(
   const LSMLIB_REAL *phi,
   const LSMLIB_REAL *psi);
 
+/*!
+ * LSM3D_NUM_CUBE_TETRAHEDRA is the number of tetrahedra in the
+ * decomposition of a grid cell used by LSM3D_getCubeTetrahedron().
+ */
+#define LSM3D_NUM_CUBE_TETRAHEDRA  (6)
+
+/*!
+ * LSM3D_getCubeTetrahedron() returns the corners of one of the
+ * tetrahedra in the Kuhn (Freudenthal) decomposition of a grid cell.
+ * All six tetrahedra share the diagonal from corner 0 to corner 7, so
+ * the decompositions of neighboring cells match on shared faces and the
+ * piecewise-linear interface reconstructed from them is continuous.
+ *
+ * Arguments:
+ *  - tet (in):       index of tetrahedron
+ *                    (0 <= tet < LSM3D_NUM_CUBE_TETRAHEDRA)
+ *  - corners (out):  indices of the four corners of the tetrahedron;
+ *                    bit 0, 1 and 2 of a corner index is set if the corner
+ *                    is at the upper x, y and z face of the cell,
+ *                    respectively
+ *
+ * Return value:      none
+ *
+ */
+void LSM3D_getCubeTetrahedron(
+  int tet,
+  int *corners);
+
+/*!
+ * LSM3D_findSurfaceInTetrahedron() computes the piece of the zero level
+ * set of the linear interpolant of \f$ \phi \f$ contained by the
+ * specified tetrahedron.
+ *
+ * Arguments:
+ *  - vertices (out):  coordinates of the vertices of the planar polygon
+ *                     (triangle or quadrilateral) approximating the zero
+ *                     level set; vertex m is stored in
+ *                     vertices[3*m],...,vertices[3*m+2] and consecutive
+ *                     vertices are connected by edges
+ *  - x1 (in):         coordinate corner #1 of tetrahedron
+ *  - x2 (in):         coordinate corner #2 of tetrahedron
+ *  - x3 (in):         coordinate corner #3 of tetrahedron
+ *  - x4 (in):         coordinate corner #4 of tetrahedron
+ *  - phi (in):        value of \f$ \phi \f$ at x1, x2, x3, and x4 (in that
+ *                     order)
+ *
+ * Return value:       number of vertices (0, 3 or 4)
+ *
+ * NOTES:
+ *  - Corners with \f$ \phi \ge 0 \f$ are treated as lying outside the
+ *    interface, so degenerate (zero-area) pieces are not returned when
+ *    the zero level set only touches the tetrahedron.
+ *
+ *  - It is the user's responsibility to ensure that vertices is an
+ *    array of size at least 12.
+ *
+ */
+int LSM3D_findSurfaceInTetrahedron(
+  LSMLIB_REAL *vertices,
+  const LSMLIB_REAL *x1,
+  const LSMLIB_REAL *x2,
+  const LSMLIB_REAL *x3,
+  const LSMLIB_REAL *x4,
+  const LSMLIB_REAL *phi);
+
+/*!
+ * LSM3D_computeDistanceToTriangle() computes the exact Euclidean distance
+ * from a point to a triangle.
+ *
+ * Arguments:
+ *  - x (in):   coordinate of point
+ *  - v1 (in):  coordinate of vertex #1 of triangle
+ *  - v2 (in):  coordinate of vertex #2 of triangle
+ *  - v3 (in):  coordinate of vertex #3 of triangle
+ *
+ * Return value:  distance from x to the closest point of the triangle
+ *
+ */
+LSMLIB_REAL LSM3D_computeDistanceToTriangle(
+  const LSMLIB_REAL *x,
+  const LSMLIB_REAL *v1,
+  const LSMLIB_REAL *v2,
+  const LSMLIB_REAL *v3);
+
 #ifdef __cplusplus
 }
 #endif
@@ -905,3 +905,161 @@ int LSM3D_findLineInTetrahedron(
   return count;
 }
 
+
+
+/* LSM3D_getCubeTetrahedron() */
+void LSM3D_getCubeTetrahedron(
+  int tet,
+  int *corners)
+{
+  /* 
+   * each tetrahedron corresponds to a path from corner 0 to corner 7
+   * that increments the coordinates in the order (first, second, third)
+   */
+  static const int axis_order[LSM3D_NUM_CUBE_TETRAHEDRA][2] = {
+    {0,1}, {0,2}, {1,0}, {1,2}, {2,0}, {2,1} };
+
+  int first = axis_order[tet][0];
+  int second = axis_order[tet][1];
+
+  corners[0] = 0;
+  corners[1] = (1 << first);
+  corners[2] = (1 << first) | (1 << second);
+  corners[3] = 7;
+}
+
+
+/* LSM3D_findSurfaceInTetrahedron() */
+int LSM3D_findSurfaceInTetrahedron(
+  LSMLIB_REAL *vertices,
+  const LSMLIB_REAL *x1,
+  const LSMLIB_REAL *x2,
+  const LSMLIB_REAL *x3,
+  const LSMLIB_REAL *x4,
+  const LSMLIB_REAL *phi)
+{
+  const LSMLIB_REAL *x[4];
+  int inside[4], outside[4];
+  int num_inside = 0, num_outside = 0;
+  int edges[4][2];
+  int num_edges, m, n;
+
+  x[0] = x1; x[1] = x2; x[2] = x3; x[3] = x4;
+
+  /* classify corners */
+  for (m = 0; m < 4; m++) {
+    if (phi[m] < 0) {
+      inside[num_inside++] = m;
+    } else {
+      outside[num_outside++] = m;
+    }
+  }
+  if ( (num_inside == 0) || (num_outside == 0) ) return 0;
+
+  /* collect edges crossed by the zero level set (in cyclic order) */
+  if (num_inside == 1) {
+    for (m = 0; m < 3; m++) {
+      edges[m][0] = inside[0];  edges[m][1] = outside[m];
+    }
+    num_edges = 3;
+  } else if (num_inside == 3) {
+    for (m = 0; m < 3; m++) {
+      edges[m][0] = inside[m];  edges[m][1] = outside[0];
+    }
+    num_edges = 3;
+  } else {
+    edges[0][0] = inside[0];  edges[0][1] = outside[0];
+    edges[1][0] = inside[0];  edges[1][1] = outside[1];
+    edges[2][0] = inside[1];  edges[2][1] = outside[1];
+    edges[3][0] = inside[1];  edges[3][1] = outside[0];
+    num_edges = 4;
+  }
+
+  /* compute intersections by linear interpolation along each edge */
+  for (m = 0; m < num_edges; m++) {
+    int a = edges[m][0];
+    int b = edges[m][1];
+    LSMLIB_REAL theta = phi[a]/(phi[a] - phi[b]);
+    for (n = 0; n < 3; n++) {
+      vertices[3*m+n] = x[a][n] + theta*(x[b][n] - x[a][n]);
+    }
+  }
+
+  return num_edges;
+}
+
+
+/* LSM3D_computeDistanceToTriangle() */
+LSMLIB_REAL LSM3D_computeDistanceToTriangle(
+  const LSMLIB_REAL *x,
+  const LSMLIB_REAL *v1,
+  const LSMLIB_REAL *v2,
+  const LSMLIB_REAL *v3)
+{
+  LSMLIB_REAL ab[3], ac[3], ap[3], bp[3], cp[3], closest[3];
+  LSMLIB_REAL d1, d2, d3, d4, d5, d6;
+  LSMLIB_REAL va, vb, vc, denom, v, w;
+  LSMLIB_REAL dist_sq = 0.0;
+  int n;
+
+  /*
+   * find the closest point by determining the Voronoi region of the
+   * triangle (vertex, edge or face) that contains x
+   */
+  for (n = 0; n < 3; n++) {
+    ab[n] = v2[n] - v1[n];
+    ac[n] = v3[n] - v1[n];
+    ap[n] = x[n] - v1[n];
+    bp[n] = x[n] - v2[n];
+    cp[n] = x[n] - v3[n];
+  }
+
+  d1 = ab[0]*ap[0] + ab[1]*ap[1] + ab[2]*ap[2];
+  d2 = ac[0]*ap[0] + ac[1]*ap[1] + ac[2]*ap[2];
+  d3 = ab[0]*bp[0] + ab[1]*bp[1] + ab[2]*bp[2];
+  d4 = ac[0]*bp[0] + ac[1]*bp[1] + ac[2]*bp[2];
+  d5 = ab[0]*cp[0] + ab[1]*cp[1] + ab[2]*cp[2];
+  d6 = ac[0]*cp[0] + ac[1]*cp[1] + ac[2]*cp[2];
+
+  vc = d1*d4 - d3*d2;
+  vb = d5*d2 - d1*d6;
+  va = d3*d6 - d5*d4;
+
+  if ( (d1 <= 0) && (d2 <= 0) ) {
+    /* vertex v1 */
+    for (n = 0; n < 3; n++) closest[n] = v1[n];
+  } else if ( (d3 >= 0) && (d4 <= d3) ) {
+    /* vertex v2 */
+    for (n = 0; n < 3; n++) closest[n] = v2[n];
+  } else if ( (d6 >= 0) && (d5 <= d6) ) {
+    /* vertex v3 */
+    for (n = 0; n < 3; n++) closest[n] = v3[n];
+  } else if ( (vc <= 0) && (d1 >= 0) && (d3 <= 0) ) {
+    /* edge v1-v2 */
+    v = d1/(d1 - d3);
+    for (n = 0; n < 3; n++) closest[n] = v1[n] + v*ab[n];
+  } else if ( (vb <= 0) && (d2 >= 0) && (d6 <= 0) ) {
+    /* edge v1-v3 */
+    w = d2/(d2 - d6);
+    for (n = 0; n < 3; n++) closest[n] = v1[n] + w*ac[n];
+  } else if ( (va <= 0) && ((d4 - d3) >= 0) && ((d5 - d6) >= 0) ) {
+    /* edge v2-v3 */
+    w = (d4 - d3)/((d4 - d3) + (d5 - d6));
+    for (n = 0; n < 3; n++) closest[n] = v2[n] + w*(v3[n] - v2[n]);
+  } else {
+    /* interior of face */
+    denom = va + vb + vc;
+    if (LSM_GEOM_3D_ABS(denom) > 0) {
+      v = vb/denom;
+      w = vc/denom;
+    } else {
+      v = w = 0;   /* degenerate triangle */
+    }
+    for (n = 0; n < 3; n++) closest[n] = v1[n] + v*ab[n] + w*ac[n];
+  }
+
+  for (n = 0; n < 3; n++) {
+    dist_sq += (x[n] - closest[n])*(x[n] - closest[n]);
+  }
+  return sqrt(dist_sq);
+}
@@ -0,0 +1,691 @@
+/*
+ * File:        lsm_autotune.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of the kernel autotuner
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "lsmlib_config.h"
+#include "lsm_autotune.h"
+#include "lsm_runtime.h"
+#include "lsm_strided_view.h"
+
+
+/*====================== Autotuner Constants ========================*/
+
+/* number of timed calls per candidate (after one warm-up call) */
+#define LSM_AUTOTUNE_NUM_REPETITIONS                (3)
+
+/* smallest extent of a cache key shape */
+#define LSM_AUTOTUNE_MIN_SHAPE                      (8)
+
+/* maximum length of a line of the cache file */
+#define LSM_AUTOTUNE_MAX_LINE_LENGTH                (512)
+
+/* tile size candidates; a value of 0 stands for the full extent */
+#define LSM_AUTOTUNE_NUM_TILE_CANDIDATES            (7)
+static const int lsm_autotune_tile_candidates[][3] = {
+  {8, 8, 8},
+  {16, 16, 16},
+  {32, 32, 32},
+  {64, 64, 64},
+  {64, 16, 8},
+  {128, 8, 4},
+  {0, 8, 8}
+};
+
+
+/*================== Autotuner Data Structures ======================*/
+
+/*
+ * Structure 'LSM_AutotuneEntry' is an entry of the cache.
+ */
+typedef struct _LSM_AutotuneEntry
+{
+  char                cpu_model[LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH];
+  int                 num_runtime_threads;
+  int                 kernel;
+  int                 variant;
+  int                 shape[3];
+  LSM_AutotuneConfig  config;
+} LSM_AutotuneEntry;
+
+/*
+ * Structure 'LSM_AutotuneState' holds the global state of the
+ * autotuner.  All fields are protected by lsm_autotune_mutex.
+ */
+typedef struct _LSM_AutotuneState
+{
+  int                 initialized;
+  LSM_AutotuneMode    mode;
+  char               *cache_file;
+  char                cpu_model[LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH];
+  LSM_AutotuneEntry  *entries;
+  int                 num_entries;
+  int                 max_entries;
+} LSM_AutotuneState;
+
+static LSM_AutotuneState lsm_autotune;
+static pthread_mutex_t lsm_autotune_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*================ Autotuner Helper Function Declarations ===========*/
+
+/*
+ * detectCPUModel() writes the CPU model name (or "unknown") into model.
+ * Tabs and newlines are replaced by spaces since they delimit the
+ * fields of the cache file.
+ */
+static void detectCPUModel(char *model, size_t model_length);
+
+/*
+ * computeShapeKey() rounds each extent of dims up to a power of two
+ * (at least LSM_AUTOTUNE_MIN_SHAPE).
+ */
+static void computeShapeKey(int *shape, const int *dims);
+
+/*
+ * ensureAutotuneInitialized() reads the configuration from the
+ * environment and loads the cache file.  Must be called with
+ * lsm_autotune_mutex held.
+ */
+static void ensureAutotuneInitialized(void);
+
+/*
+ * loadCacheFile() appends the entries of the cache file to the in-memory
+ * cache.  Must be called with lsm_autotune_mutex held.
+ */
+static void loadCacheFile(void);
+
+/*
+ * writeCacheFile() writes all entries of the in-memory cache to the
+ * cache file.  Must be called with lsm_autotune_mutex held.
+ */
+static int writeCacheFile(void);
+
+/*
+ * findEntry() returns the entry with the given key or NULL.  Must be
+ * called with lsm_autotune_mutex held.
+ */
+static LSM_AutotuneEntry *findEntry(
+  const char *cpu_model,
+  int num_runtime_threads,
+  int kernel,
+  int variant,
+  const int *shape);
+
+/*
+ * storeEntry() adds (or replaces) an entry.  Must be called with
+ * lsm_autotune_mutex held.
+ */
+static int storeEntry(const LSM_AutotuneEntry *entry);
+
+/*
+ * benchmarkKernel() returns the smallest time of
+ * LSM_AUTOTUNE_NUM_REPETITIONS calls of a kernel with the given
+ * configuration (or a negative value if the kernel fails).
+ */
+static double benchmarkKernel(
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const LSM_AutotuneConfig *config,
+  LSM_StridedView3d *views,
+  const LSM_ViewBoundary3d *bdry);
+
+/*
+ * getTime() returns the time in seconds from a monotonic clock.
+ */
+static double getTime(void);
+
+
+/*================ Autotuner Helper Function Definitions ============*/
+
+static void detectCPUModel(char *model, size_t model_length)
+{
+  char *c;
+
+  strncpy(model, "unknown", model_length);
+  model[model_length-1] = '\0';
+
+#ifdef __linux__
+  {
+    FILE *fp = fopen("/proc/cpuinfo", "r");
+    char line[LSM_AUTOTUNE_MAX_LINE_LENGTH];
+    if (fp) {
+      while (fgets(line, sizeof(line), fp)) {
+        if ( !strncmp(line, "model name", 10)
+          || !strncmp(line, "Model", 5)
+          || !strncmp(line, "cpu model", 9) ) {
+          char *value = strchr(line, ':');
+          if (value) {
+            value++;
+            while (*value == ' ' || *value == '\t') value++;
+            strncpy(model, value, model_length);
+            model[model_length-1] = '\0';
+            break;
+          }
+        }
+      }
+      fclose(fp);
+    }
+  }
+#endif
+
+  for (c = model; *c; c++) {
+    if (*c == '\t' || *c == '\n' || *c == '\r') *c = ' ';
+  }
+  /* strip trailing spaces */
+  while ( (c > model) && (*(c-1) == ' ') ) *(--c) = '\0';
+}
+
+
+static void computeShapeKey(int *shape, const int *dims)
+{
+  int l;
+  for (l = 0; l < 3; l++) {
+    int s = LSM_AUTOTUNE_MIN_SHAPE;
+    while (s < dims[l]) s *= 2;
+    shape[l] = s;
+  }
+}
+
+
+static void ensureAutotuneInitialized(void)
+{
+  char *env;
+
+  if (lsm_autotune.initialized) return;
+
+  lsm_autotune.mode = LSM_AUTOTUNE_CACHED;
+  env = getenv("LSMLIB_AUTOTUNE");
+  if (env) {
+    if (!strcmp(env, "off")) lsm_autotune.mode = LSM_AUTOTUNE_OFF;
+    if (!strcmp(env, "auto")) lsm_autotune.mode = LSM_AUTOTUNE_AUTO;
+  }
+
+  detectCPUModel(lsm_autotune.cpu_model, LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH);
+
+  lsm_autotune.cache_file = NULL;
+  env = getenv("LSMLIB_AUTOTUNE_CACHE");
+  if (env && *env) {
+    lsm_autotune.cache_file = strdup(env);
+  } else {
+    char *home = getenv("HOME");
+    if (home && *home) {
+      const char *name = "/.lsmlib_autotune";
+      lsm_autotune.cache_file = (char *) malloc(
+        strlen(home) + strlen(name) + 1);
+      if (lsm_autotune.cache_file) {
+        strcpy(lsm_autotune.cache_file, home);
+        strcat(lsm_autotune.cache_file, name);
+      }
+    }
+  }
+
+  lsm_autotune.entries = NULL;
+  lsm_autotune.num_entries = 0;
+  lsm_autotune.max_entries = 0;
+  loadCacheFile();
+
+  lsm_autotune.initialized = 1;
+}
+
+
+static void loadCacheFile(void)
+{
+  FILE *fp;
+  char line[LSM_AUTOTUNE_MAX_LINE_LENGTH];
+
+  if (!lsm_autotune.cache_file) return;
+  fp = fopen(lsm_autotune.cache_file, "r");
+  if (!fp) return;
+
+  while (fgets(line, sizeof(line), fp)) {
+    LSM_AutotuneEntry entry;
+    char *key, *value;
+    size_t len;
+
+    if ( (line[0] == '#') || (line[0] == '\n') ) continue;
+
+    /* fields:  cpu model TAB key TAB configuration */
+    key = strchr(line, '\t');
+    if (!key) continue;
+    value = strchr(key+1, '\t');
+    if (!value) continue;
+
+    len = key - line;
+    if (len >= LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH) continue;
+    memcpy(entry.cpu_model, line, len);
+    entry.cpu_model[len] = '\0';
+
+    if (sscanf(key+1, "%d %d %d %d %d %d", &entry.num_runtime_threads,
+               &entry.kernel, &entry.variant, &entry.shape[0],
+               &entry.shape[1], &entry.shape[2]) != 6) {
+      continue;
+    }
+    if (sscanf(value+1, "%d %d %d %d %lf", &entry.config.tile_dims[0],
+               &entry.config.tile_dims[1], &entry.config.tile_dims[2],
+               &entry.config.num_threads, &entry.config.time) != 5) {
+      continue;
+    }
+    if ( (entry.kernel < 0) || (entry.kernel >= LSM_AUTOTUNE_NUM_KERNELS)
+      || (entry.config.tile_dims[0] < 1) || (entry.config.tile_dims[1] < 1)
+      || (entry.config.tile_dims[2] < 1) ) {
+      continue;
+    }
+    storeEntry(&entry);
+  }
+  fclose(fp);
+}
+
+
+static int writeCacheFile(void)
+{
+  FILE *fp;
+  char *tmp_file;
+  int n, err = LSM_AUTOTUNE_ERR_SUCCESS;
+
+  if (!lsm_autotune.cache_file) return LSM_AUTOTUNE_ERR_SUCCESS;
+
+  /* write to a temporary file and rename it so that readers never */
+  /* see a partially written cache file                            */
+  tmp_file = (char *) malloc(strlen(lsm_autotune.cache_file) + 5);
+  if (!tmp_file) return LSM_AUTOTUNE_ERR_MEMORY_ALLOCATION;
+  strcpy(tmp_file, lsm_autotune.cache_file);
+  strcat(tmp_file, ".tmp");
+
+  fp = fopen(tmp_file, "w");
+  if (!fp) {
+    free(tmp_file);
+    return LSM_AUTOTUNE_ERR_FILE_IO;
+  }
+  fprintf(fp, "# LSMLIB autotune cache\n");
+  fprintf(fp, "# cpu model <TAB> runtime threads, kernel, variant, shape "
+              "<TAB> tile size, threads, time [s]\n");
+  for (n = 0; n < lsm_autotune.num_entries; n++) {
+    const LSM_AutotuneEntry *e = &(lsm_autotune.entries[n]);
+    fprintf(fp, "%s\t%d %d %d %d %d %d\t%d %d %d %d %.6e\n",
+            e->cpu_model, e->num_runtime_threads, e->kernel, e->variant,
+            e->shape[0], e->shape[1], e->shape[2],
+            e->config.tile_dims[0], e->config.tile_dims[1],
+            e->config.tile_dims[2], e->config.num_threads, e->config.time);
+  }
+  if (fclose(fp) != 0) err = LSM_AUTOTUNE_ERR_FILE_IO;
+
+  if ( (err == LSM_AUTOTUNE_ERR_SUCCESS)
+    && (rename(tmp_file, lsm_autotune.cache_file) != 0) ) {
+    err = LSM_AUTOTUNE_ERR_FILE_IO;
+  }
+  if (err != LSM_AUTOTUNE_ERR_SUCCESS) remove(tmp_file);
+  free(tmp_file);
+
+  return err;
+}
+
+
+static LSM_AutotuneEntry *findEntry(
+  const char *cpu_model,
+  int num_runtime_threads,
+  int kernel,
+  int variant,
+  const int *shape)
+{
+  int n;
+
+  for (n = 0; n < lsm_autotune.num_entries; n++) {
+    LSM_AutotuneEntry *e = &(lsm_autotune.entries[n]);
+    if ( (e->kernel == kernel) && (e->variant == variant)
+      && (e->num_runtime_threads == num_runtime_threads)
+      && (e->shape[0] == shape[0]) && (e->shape[1] == shape[1])
+      && (e->shape[2] == shape[2])
+      && !strcmp(e->cpu_model, cpu_model) ) {
+      return e;
+    }
+  }
+  return NULL;
+}
+
+
+static int storeEntry(const LSM_AutotuneEntry *entry)
+{
+  LSM_AutotuneEntry *e = findEntry(entry->cpu_model,
+                                   entry->num_runtime_threads,
+                                   entry->kernel, entry->variant,
+                                   entry->shape);
+
+  if (!e) {
+    if (lsm_autotune.num_entries == lsm_autotune.max_entries) {
+      int max_entries = lsm_autotune.max_entries ?
+                        2*lsm_autotune.max_entries : 16;
+      LSM_AutotuneEntry *entries = (LSM_AutotuneEntry *) realloc(
+        lsm_autotune.entries, max_entries*sizeof(LSM_AutotuneEntry));
+      if (!entries) return LSM_AUTOTUNE_ERR_MEMORY_ALLOCATION;
+      lsm_autotune.entries = entries;
+      lsm_autotune.max_entries = max_entries;
+    }
+    e = &(lsm_autotune.entries[lsm_autotune.num_entries++]);
+  }
+  *e = *entry;
+
+  return LSM_AUTOTUNE_ERR_SUCCESS;
+}
+
+
+static double getTime(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.0e-9*ts.tv_nsec;
+}
+
+
+static double benchmarkKernel(
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const LSM_AutotuneConfig *config,
+  LSM_StridedView3d *views,
+  const LSM_ViewBoundary3d *bdry)
+{
+  double best_time = -1.0;
+  LSMLIB_REAL dx = 0.1;
+  int rep;
+
+  for (rep = 0; rep <= LSM_AUTOTUNE_NUM_REPETITIONS; rep++) {
+    double start = getTime(), elapsed;
+    int err;
+
+    switch (kernel) {
+      case LSM_AUTOTUNE_UPWIND_GRADIENT_3D:
+        err = computeUpwindGradientStridedView3d(
+          &views[1], &views[2], &views[3], &views[4], &views[5], &views[6],
+          &views[0], bdry, (LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE) variant,
+          dx, dx, dx, config->tile_dims, config->num_threads);
+        break;
+      case LSM_AUTOTUNE_CENTRAL_GRADIENT_3D:
+        err = computeCentralGradientStridedView3d(
+          &views[1], &views[2], &views[3], &views[0], bdry, variant,
+          dx, dx, dx, config->tile_dims, config->num_threads);
+        break;
+      default:
+        err = advanceTVDRKStridedView3d(
+          3, 2, &views[1], &views[2], &views[0], &views[3], dx,
+          config->num_threads);
+        break;
+    }
+    if (err != LSM_VIEW_ERR_SUCCESS) return -1.0;
+
+    /* the first call is a warm-up call */
+    elapsed = getTime() - start;
+    if ( (rep > 0) && ((best_time < 0) || (elapsed < best_time)) ) {
+      best_time = elapsed;
+    }
+  }
+
+  return best_time;
+}
+
+
+/*================ Autotuner Function Definitions ===================*/
+
+int LSM_Autotune_setMode(LSM_AutotuneMode mode)
+{
+  if ( (mode < LSM_AUTOTUNE_OFF) || (mode > LSM_AUTOTUNE_AUTO) ) {
+    return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+  }
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  lsm_autotune.mode = mode;
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return LSM_AUTOTUNE_ERR_SUCCESS;
+}
+
+
+LSM_AutotuneMode LSM_Autotune_getMode(void)
+{
+  LSM_AutotuneMode mode;
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  mode = lsm_autotune.mode;
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return mode;
+}
+
+
+int LSM_Autotune_setCacheFile(const char *path)
+{
+  char *cache_file = NULL;
+
+  if (path) {
+    cache_file = strdup(path);
+    if (!cache_file) return LSM_AUTOTUNE_ERR_MEMORY_ALLOCATION;
+  }
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  free(lsm_autotune.cache_file);
+  lsm_autotune.cache_file = cache_file;
+  lsm_autotune.num_entries = 0;
+  loadCacheFile();
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return LSM_AUTOTUNE_ERR_SUCCESS;
+}
+
+
+int LSM_Autotune_getCPUModel(char *model, size_t model_length)
+{
+  if (!model || (model_length < 1)) return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  strncpy(model, lsm_autotune.cpu_model, model_length);
+  model[model_length-1] = '\0';
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return LSM_AUTOTUNE_ERR_SUCCESS;
+}
+
+
+void LSM_Autotune_getDefaultConfig(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel)
+{
+  int l;
+
+  (void) kernel;
+  if (!config) return;
+  for (l = 0; l < 3; l++) config->tile_dims[l] = LSM_VIEW_DEFAULT_TILE_SIZE;
+  config->num_threads = 0;
+  config->time = 0.0;
+}
+
+
+int LSM_Autotune_getConfig(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const int *dims)
+{
+  LSM_AutotuneEntry *e;
+  LSM_AutotuneMode mode;
+  int shape[3];
+  int num_runtime_threads;
+
+  if ( !config || !dims || (kernel < 0)
+    || (kernel >= LSM_AUTOTUNE_NUM_KERNELS) ) {
+    return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+  }
+  LSM_Autotune_getDefaultConfig(config, kernel);
+
+  computeShapeKey(shape, dims);
+  num_runtime_threads = LSM_Runtime_getNumThreads();
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  mode = lsm_autotune.mode;
+  e = (mode == LSM_AUTOTUNE_OFF) ? NULL :
+      findEntry(lsm_autotune.cpu_model, num_runtime_threads, kernel,
+                variant, shape);
+  if (e) *config = e->config;
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  if (e) return LSM_AUTOTUNE_ERR_SUCCESS;
+
+  /* timings taken inside of a parallel loop would be meaningless */
+  if ( (mode == LSM_AUTOTUNE_AUTO) && !LSM_Runtime_inParallel()
+    && (LSM_Autotune_tune(config, kernel, variant, dims)
+        == LSM_AUTOTUNE_ERR_SUCCESS) ) {
+    return LSM_AUTOTUNE_ERR_SUCCESS;
+  }
+
+  LSM_Autotune_getDefaultConfig(config, kernel);
+  return LSM_AUTOTUNE_ERR_NOT_FOUND;
+}
+
+
+int LSM_Autotune_tune(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const int *dims)
+{
+  LSM_StridedView3d views[7];
+  LSM_ViewBoundary3d bdry;
+  LSM_AutotuneEntry entry;
+  LSMLIB_REAL *data;
+  size_t num_gridpts;
+  int num_arrays, num_threads, num_tile_candidates;
+  int tiles[LSM_AUTOTUNE_NUM_TILE_CANDIDATES][3];
+  int t, c, l, err;
+  size_t p;
+
+  if ( !dims || (dims[0] < 1) || (dims[1] < 1) || (dims[2] < 1)
+    || (kernel < 0) || (kernel >= LSM_AUTOTUNE_NUM_KERNELS) ) {
+    return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+  }
+  if ( ( (kernel == LSM_AUTOTUNE_UPWIND_GRADIENT_3D)
+      && ((variant < LOW) || (variant > VERY_HIGH)) )
+    || ( (kernel == LSM_AUTOTUNE_CENTRAL_GRADIENT_3D)
+      && (variant != 2) && (variant != 4) ) ) {
+    return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+  }
+  if (kernel == LSM_AUTOTUNE_TVD_RK_3D) variant = 0;
+
+  /* arrays:  phi (u_cur) and the outputs (u_next, u_stage, rhs) */
+  num_arrays = (kernel == LSM_AUTOTUNE_UPWIND_GRADIENT_3D) ? 7 : 4;
+  num_gridpts = (size_t) dims[0]*dims[1]*dims[2];
+  data = (LSMLIB_REAL *) malloc(num_arrays*num_gridpts*sizeof(LSMLIB_REAL));
+  if (!data) return LSM_AUTOTUNE_ERR_MEMORY_ALLOCATION;
+  for (p = 0; p < num_arrays*num_gridpts; p++) {
+    data[p] = sin(0.01*(p % 9973));
+  }
+  for (l = 0; l < num_arrays; l++) {
+    views[l] = makeStridedView3d(data + l*num_gridpts,
+                                 dims[0], dims[1], dims[2],
+                                 1, dims[0], dims[0]*dims[1]);
+  }
+  setViewBoundary3d(&bdry, LSM_VIEW_BC_LINEAR_EXTRAPOLATION, 0);
+
+  /* tile size candidates clipped to the shape (without duplicates) */
+  num_tile_candidates = 0;
+  if (kernel == LSM_AUTOTUNE_TVD_RK_3D) {
+    for (l = 0; l < 3; l++) tiles[0][l] = LSM_VIEW_DEFAULT_TILE_SIZE;
+    num_tile_candidates = 1;
+  } else {
+    for (c = 0; c < LSM_AUTOTUNE_NUM_TILE_CANDIDATES; c++) {
+      int duplicate = 0;
+      for (l = 0; l < 3; l++) {
+        int size = lsm_autotune_tile_candidates[c][l];
+        if ( (size == 0) || (size > dims[l]) ) size = dims[l];
+        tiles[num_tile_candidates][l] = size;
+      }
+      for (t = 0; t < num_tile_candidates; t++) {
+        if ( (tiles[t][0] == tiles[num_tile_candidates][0])
+          && (tiles[t][1] == tiles[num_tile_candidates][1])
+          && (tiles[t][2] == tiles[num_tile_candidates][2]) ) {
+          duplicate = 1;
+        }
+      }
+      if (!duplicate) num_tile_candidates++;
+    }
+  }
+
+  /* search all combinations of tile size and number of threads */
+  /* (powers of two and the number of runtime threads)          */
+  entry.config.time = -1.0;
+  num_threads = LSM_Runtime_getNumThreads();
+  for (t = 1; ; t = (2*t < num_threads) ? 2*t : num_threads) {
+    for (c = 0; c < num_tile_candidates; c++) {
+      LSM_AutotuneConfig candidate;
+      for (l = 0; l < 3; l++) candidate.tile_dims[l] = tiles[c][l];
+      candidate.num_threads = t;
+      candidate.time = benchmarkKernel(kernel, variant, &candidate, views,
+                                       &bdry);
+      if ( (candidate.time >= 0)
+        && ( (entry.config.time < 0)
+          || (candidate.time < entry.config.time) ) ) {
+        entry.config = candidate;
+      }
+    }
+    if (t == num_threads) break;
+  }
+  free(data);
+
+  if (entry.config.time < 0) return LSM_AUTOTUNE_ERR_INVALID_ARGUMENT;
+  if (config) *config = entry.config;
+
+  /* store the result */
+  entry.num_runtime_threads = num_threads;
+  entry.kernel = kernel;
+  entry.variant = variant;
+  computeShapeKey(entry.shape, dims);
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  strcpy(entry.cpu_model, lsm_autotune.cpu_model);
+  err = storeEntry(&entry);
+  if (err == LSM_AUTOTUNE_ERR_SUCCESS) err = writeCacheFile();
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return err;
+}
+
+
+int LSM_Autotune_saveCache(void)
+{
+  int err;
+
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  err = writeCacheFile();
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+
+  return err;
+}
+
+
+void LSM_Autotune_clearCache(void)
+{
+  pthread_mutex_lock(&lsm_autotune_mutex);
+  ensureAutotuneInitialized();
+  lsm_autotune.num_entries = 0;
+  pthread_mutex_unlock(&lsm_autotune_mutex);
+}
@@ -0,0 +1,251 @@
+/*
+ * File:        lsm_autotune.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for the kernel autotuner
+ */
+
+#ifndef included_lsm_autotune_h
+#define included_lsm_autotune_h
+
+#include <stddef.h>
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_autotune.h
+ *
+ * \brief
+ * @ref lsm_autotune.h selects the tile size and number of threads of
+ * the tiled and threaded kernels by benchmarking candidate
+ * configurations on the machine that runs them.
+ *
+ * The best configuration found for a kernel is stored in a cache keyed
+ * by the CPU model, the number of runtime threads (see
+ * @ref lsm_runtime.h), the kernel, its variant (e.g. the accuracy of
+ * an upwind gradient) and the problem shape.  Each extent of the shape
+ * is rounded up to a power of two (at least 8), so that similar
+ * problems share one entry.  The cache is kept in memory and persisted
+ * in a text file, so that tuning only happens once per machine.
+ *
+ * Kernels consult the cache when they are called with default
+ * parameters (e.g. tile_dims = NULL and max_threads <= 0 for
+ * computeUpwindGradientStridedView3d()); explicit parameters are always
+ * used as given.
+ *
+ * <h3> Configuration </h3>
+ *
+ * The autotuner is configured by LSM_Autotune_setMode() and
+ * LSM_Autotune_setCacheFile() or, if they are not called, from the
+ * environment:
+ *
+ * - LSMLIB_AUTOTUNE:  one of "off" (always use the built-in defaults),
+ *   "cached" (default; use tuned configurations from the cache file but
+ *   never benchmark) or "auto" (benchmark on the first use of a kernel
+ *   for a shape that is not in the cache)
+ * - LSMLIB_AUTOTUNE_CACHE:  path of the cache file (default:
+ *   $HOME/.lsmlib_autotune; no file is used if HOME is not set)
+ *
+ * The lsm_autotune program fills the cache for a list of problem
+ * shapes ahead of time.
+ *
+ */
+
+
+/*!
+ * Error codes returned by autotuner functions.
+ */
+#define LSM_AUTOTUNE_ERR_SUCCESS                    (0)
+#define LSM_AUTOTUNE_ERR_INVALID_ARGUMENT           (1)
+#define LSM_AUTOTUNE_ERR_MEMORY_ALLOCATION          (2)
+#define LSM_AUTOTUNE_ERR_FILE_IO                    (3)
+#define LSM_AUTOTUNE_ERR_NOT_FOUND                  (4)
+
+/*!
+ * Maximum length of a CPU model string (including the terminating
+ * null character).
+ */
+#define LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH           (128)
+
+/*!
+ * LSM_AutotuneKernel identifies a tunable kernel.
+ *
+ * - LSM_AUTOTUNE_UPWIND_GRADIENT_3D:   computeUpwindGradientStridedView3d()
+ *                                      (variant:  accuracy)
+ * - LSM_AUTOTUNE_CENTRAL_GRADIENT_3D:  computeCentralGradientStridedView3d()
+ *                                      (variant:  order)
+ * - LSM_AUTOTUNE_TVD_RK_3D:            advanceTVDRKStridedView3d()
+ *                                      (variant:  ignored; only the number
+ *                                      of threads is tuned)
+ */
+typedef enum {
+  LSM_AUTOTUNE_UPWIND_GRADIENT_3D  = 0,
+  LSM_AUTOTUNE_CENTRAL_GRADIENT_3D = 1,
+  LSM_AUTOTUNE_TVD_RK_3D           = 2
+} LSM_AutotuneKernel;
+
+#define LSM_AUTOTUNE_NUM_KERNELS                    (3)
+
+/*!
+ * LSM_AutotuneMode determines when the autotuner benchmarks kernels
+ * (see the description of LSMLIB_AUTOTUNE above).
+ */
+typedef enum {
+  LSM_AUTOTUNE_OFF    = 0,
+  LSM_AUTOTUNE_CACHED = 1,
+  LSM_AUTOTUNE_AUTO   = 2
+} LSM_AutotuneMode;
+
+/*!
+ * Structure 'LSM_AutotuneConfig' holds a kernel configuration.
+ */
+typedef struct _LSM_AutotuneConfig
+{
+  /* tile size in each direction (unused for LSM_AUTOTUNE_TVD_RK_3D) */
+  int           tile_dims[3];
+
+  /* number of threads */
+  int           num_threads;
+
+  /* measured time per kernel call in seconds (0 if not measured) */
+  double        time;
+} LSM_AutotuneConfig;
+
+
+/*!
+ * LSM_Autotune_setMode() sets the autotuning mode.
+ *
+ * Arguments:
+ *  - mode (in):  autotuning mode
+ *
+ * Return value:  error code
+ *
+ */
+int LSM_Autotune_setMode(LSM_AutotuneMode mode);
+
+/*!
+ * LSM_Autotune_getMode() returns the autotuning mode.
+ */
+LSM_AutotuneMode LSM_Autotune_getMode(void);
+
+/*!
+ * LSM_Autotune_setCacheFile() sets the path of the cache file and
+ * (re)loads the in-memory cache from it.
+ *
+ * Arguments:
+ *  - path (in):  path of the cache file (NULL to keep the cache in
+ *                memory only)
+ *
+ * Return value:  error code
+ *
+ * NOTES:
+ *  - Entries in memory that have not been saved are discarded.
+ *
+ *  - A missing cache file is not an error.
+ *
+ */
+int LSM_Autotune_setCacheFile(const char *path);
+
+/*!
+ * LSM_Autotune_getCPUModel() writes the CPU model used as part of the
+ * cache keys into model (at most model_length characters including the
+ * terminating null character).
+ *
+ * Return value:  error code
+ */
+int LSM_Autotune_getCPUModel(char *model, size_t model_length);
+
+/*!
+ * LSM_Autotune_getDefaultConfig() returns the built-in configuration of
+ * a kernel.
+ *
+ * Arguments:
+ *  - config (out):  default configuration (tile size
+ *                   LSM_VIEW_DEFAULT_TILE_SIZE and all runtime threads)
+ *  - kernel (in):   kernel
+ *
+ * Return value:     none
+ *
+ */
+void LSM_Autotune_getDefaultConfig(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel);
+
+/*!
+ * LSM_Autotune_getConfig() returns the configuration to use for a
+ * kernel and problem shape.
+ *
+ * Arguments:
+ *  - config (out):  configuration
+ *  - kernel (in):   kernel
+ *  - variant (in):  kernel variant (see LSM_AutotuneKernel)
+ *  - dims (in):     problem shape (number of grid points in each
+ *                   direction)
+ *
+ * Return value:     LSM_AUTOTUNE_ERR_SUCCESS if a tuned configuration
+ *                   was found (or, in "auto" mode, computed);
+ *                   LSM_AUTOTUNE_ERR_NOT_FOUND if the default
+ *                   configuration is returned
+ *
+ */
+int LSM_Autotune_getConfig(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const int *dims);
+
+/*!
+ * LSM_Autotune_tune() benchmarks the candidate configurations of a
+ * kernel for a problem shape, stores the fastest one in the cache and
+ * saves the cache file.
+ *
+ * Arguments:
+ *  - config (out):  fastest configuration (may be NULL)
+ *  - kernel (in):   kernel
+ *  - variant (in):  kernel variant
+ *  - dims (in):     problem shape
+ *
+ * Return value:     error code
+ *
+ * NOTES:
+ *  - The benchmark allocates the arrays of the kernel for the given
+ *    shape and runs every candidate a few times.
+ *
+ *  - Tuning is carried out regardless of the autotuning mode.
+ *
+ */
+int LSM_Autotune_tune(
+  LSM_AutotuneConfig *config,
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const int *dims);
+
+/*!
+ * LSM_Autotune_saveCache() writes the in-memory cache to the cache file.
+ *
+ * Return value:  error code
+ *
+ * NOTES:
+ *  - Entries of other machines that share the cache file are kept.
+ *
+ */
+int LSM_Autotune_saveCache(void);
+
+/*!
+ * LSM_Autotune_clearCache() removes all entries from the in-memory
+ * cache (the cache file is not modified).
+ */
+void LSM_Autotune_clearCache(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
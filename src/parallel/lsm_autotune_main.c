@@ -0,0 +1,130 @@
+/*
+ * File:        lsm_autotune_main.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Program that fills the autotune cache for a list of
+ *              problem shapes
+ */
+
+/*
+ * Usage:  lsm_autotune [-c cache_file] [nx ny nz] ...
+ *
+ * Tunes all tunable kernels and variants (see lsm_autotune.h) for each
+ * problem shape (default:  64^3 and 128^3) and saves the results in the
+ * cache file (default:  LSMLIB_AUTOTUNE_CACHE or $HOME/.lsmlib_autotune).
+ * The number of threads is taken from LSMLIB_NUM_THREADS.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsmlib_config.h"
+#include "lsm_autotune.h"
+#include "lsm_grid.h"
+#include "lsm_runtime.h"
+
+
+/*
+ * tuneKernel() tunes a kernel variant and prints the result.
+ */
+static int tuneKernel(
+  const char *name,
+  LSM_AutotuneKernel kernel,
+  int variant,
+  const int *dims)
+{
+  LSM_AutotuneConfig config;
+  int err = LSM_Autotune_tune(&config, kernel, variant, dims);
+
+  if (err != LSM_AUTOTUNE_ERR_SUCCESS) {
+    printf("  %-24s  failed (error %d)\n", name, err);
+    return err;
+  }
+  if (kernel == LSM_AUTOTUNE_TVD_RK_3D) {
+    printf("  %-24s  threads %3d                   %10.3e s\n",
+           name, config.num_threads, config.time);
+  } else {
+    printf("  %-24s  threads %3d  tile %4d %4d %4d  %10.3e s\n",
+           name, config.num_threads, config.tile_dims[0],
+           config.tile_dims[1], config.tile_dims[2], config.time);
+  }
+  return err;
+}
+
+
+int main(int argc, char **argv)
+{
+  int default_shapes[2][3] = {{64, 64, 64}, {128, 128, 128}};
+  int (*shapes)[3] = default_shapes;
+  int num_shapes = 2;
+  char cpu_model[LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH];
+  int arg = 1, s, num_errors = 0;
+
+  if ( (argc > 2) && !strcmp(argv[1], "-c") ) {
+    if (LSM_Autotune_setCacheFile(argv[2]) != LSM_AUTOTUNE_ERR_SUCCESS) {
+      fprintf(stderr, "lsm_autotune: could not set cache file '%s'\n",
+              argv[2]);
+      return 1;
+    }
+    arg = 3;
+  }
+  if ( (argc - arg) % 3 != 0 ) {
+    fprintf(stderr, "Usage:  %s [-c cache_file] [nx ny nz] ...\n", argv[0]);
+    return 1;
+  }
+  if (argc > arg) {
+    num_shapes = (argc - arg)/3;
+    shapes = (int (*)[3]) malloc(num_shapes*sizeof(*shapes));
+    if (!shapes) return 1;
+    for (s = 0; s < num_shapes; s++) {
+      int l;
+      for (l = 0; l < 3; l++) {
+        shapes[s][l] = atoi(argv[arg + 3*s + l]);
+        if (shapes[s][l] < 1) {
+          fprintf(stderr, "lsm_autotune: invalid shape\n");
+          free(shapes);
+          return 1;
+        }
+      }
+    }
+  }
+
+  LSM_Autotune_getCPUModel(cpu_model, sizeof(cpu_model));
+  printf("CPU model:       %s\n", cpu_model);
+  printf("Runtime threads: %d\n", LSM_Runtime_getNumThreads());
+
+  for (s = 0; s < num_shapes; s++) {
+    printf("\nShape %d x %d x %d\n", shapes[s][0], shapes[s][1],
+           shapes[s][2]);
+    num_errors += (tuneKernel("upwind gradient (ENO1)",
+                              LSM_AUTOTUNE_UPWIND_GRADIENT_3D, LOW,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("upwind gradient (ENO2)",
+                              LSM_AUTOTUNE_UPWIND_GRADIENT_3D, MEDIUM,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("upwind gradient (ENO3)",
+                              LSM_AUTOTUNE_UPWIND_GRADIENT_3D, HIGH,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("upwind gradient (WENO5)",
+                              LSM_AUTOTUNE_UPWIND_GRADIENT_3D, VERY_HIGH,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("central gradient (2)",
+                              LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("central gradient (4)",
+                              LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 4,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+    num_errors += (tuneKernel("TVD Runge-Kutta stage",
+                              LSM_AUTOTUNE_TVD_RK_3D, 0,
+                              shapes[s]) != LSM_AUTOTUNE_ERR_SUCCESS);
+  }
+
+  if (shapes != default_shapes) free(shapes);
+  LSM_Runtime_finalize();
+
+  return (num_errors > 0) ? 1 : 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * File:        lsm_distance_server_main.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Program that runs the local distance-transform service
+ */
+
+/*
+ * Usage:  lsm_distance_server [-j max_concurrent_jobs] [-q max_queued_jobs]
+ *                             socket_path
+ *
+ * Serves distance function and Eikonal equation jobs submitted through
+ * the client library (see lsm_distance_service.h) until it receives
+ * SIGINT or SIGTERM.  By default, one job per processor runs at a time
+ * and up to four jobs per worker are queued.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsmlib_config.h"
+#include "lsm_distance_service.h"
+
+
+static LSM_DistanceServer *lsm_server = NULL;
+
+/*
+ * stopServer() is the handler for SIGINT and SIGTERM.
+ */
+static void stopServer(int sig)
+{
+  (void) sig;
+  stopLSMDistanceServer(lsm_server);
+}
+
+
+int main(int argc, char **argv)
+{
+  int max_concurrent_jobs = 0, max_queued_jobs = 0;
+  LSM_DistanceServerStatistics statistics;
+  struct sigaction action;
+  int arg = 1, err;
+
+  while ( (arg + 1 < argc) && (argv[arg][0] == '-') ) {
+    if (!strcmp(argv[arg], "-j")) {
+      max_concurrent_jobs = atoi(argv[arg + 1]);
+    } else if (!strcmp(argv[arg], "-q")) {
+      max_queued_jobs = atoi(argv[arg + 1]);
+    } else {
+      break;
+    }
+    arg += 2;
+  }
+  if (arg != argc - 1) {
+    fprintf(stderr, "Usage:  %s [-j max_concurrent_jobs] "
+                    "[-q max_queued_jobs] socket_path\n", argv[0]);
+    return 1;
+  }
+
+  lsm_server = createLSMDistanceServer(argv[arg], max_concurrent_jobs,
+                                       max_queued_jobs);
+  if (!lsm_server) {
+    fprintf(stderr, "lsm_distance_server: could not listen on '%s'\n",
+            argv[arg]);
+    return 1;
+  }
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = stopServer;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+
+  printf("lsm_distance_server: listening on '%s'\n", argv[arg]);
+  fflush(stdout);
+  err = runLSMDistanceServer(lsm_server);
+
+  getLSMDistanceServerStatistics(lsm_server, &statistics);
+  printf("lsm_distance_server: %ld jobs completed, %ld failed, "
+         "%ld rejected\n", statistics.jobs_completed, statistics.jobs_failed,
+         statistics.jobs_rejected);
+  destroyLSMDistanceServer(lsm_server);
+
+  return (err == LSM_SERVICE_ERR_SUCCESS) ? 0 : 1;
+}
@@ -0,0 +1,1021 @@
+/*
+ * File:        lsm_distance_service.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of the local distance-transform service
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "lsmlib_config.h"
+#include "lsm_distance_service.h"
+#include "lsm_fast_marching_method.h"
+#include "FMM_Core.h"
+#include "FMM_Macros.h"
+#include "lsm_runtime.h"
+
+
+/*======================= Service Constants =========================*/
+#define LSM_SERVICE_MAGIC                    (0x4c534d44)  /* "LSMD" */
+#define LSM_SERVICE_PROTOCOL_VERSION         (1)
+#define LSM_SERVICE_STOP_REQUEST             (-1)
+
+
+/*===================== Service Data Structures =====================*/
+
+/*
+ * Structure 'LSM_ServiceRequest' is the message sent by a client to
+ * submit a job.  The file descriptor of the buffer is attached to the
+ * message.
+ */
+typedef struct _LSM_ServiceRequest
+{
+  uint32_t magic;
+  uint32_t version;
+  int32_t  real_size;      /* sizeof(LSMLIB_REAL) of the client */
+  int32_t  type;
+  int32_t  spatial_discretization_order;
+  int32_t  num_dims;
+  int32_t  grid_dims[3];
+  int32_t  num_fields;
+  int32_t  phi_field;
+  int32_t  output_field;
+  int32_t  speed_field;
+  int32_t  mask_field;
+  double   dx[3];
+} LSM_ServiceRequest;
+
+/*
+ * Structure 'LSM_ServiceReply' is the message sent by the server when
+ * a job is complete (or rejected).
+ */
+typedef struct _LSM_ServiceReply
+{
+  uint32_t magic;
+  int32_t  status;
+} LSM_ServiceReply;
+
+struct _LSM_ServiceClient
+{
+  int fd;
+};
+
+/*
+ * Structure 'LSM_ServiceQueuedJob' holds a job waiting for a worker.
+ */
+typedef struct _LSM_ServiceQueuedJob
+{
+  int                conn_fd;    /* connection to reply on */
+  int                shm_fd;     /* shared memory of the buffer */
+  LSM_ServiceRequest request;
+} LSM_ServiceQueuedJob;
+
+/*
+ * Structure 'LSM_ServiceWorkspace' holds a cached FMM workspace and the
+ * grid it was created for.
+ */
+typedef struct _LSM_ServiceWorkspace
+{
+  int           num_dims;
+  int           grid_dims[3];
+  LSMLIB_REAL   dx[3];
+  FMM_CoreData *fmm_core_data;
+  long          last_used;
+} LSM_ServiceWorkspace;
+
+/*
+ * Structure 'LSM_ServiceWorker' holds the state owned by one worker
+ * thread.
+ */
+typedef struct _LSM_ServiceWorker
+{
+  LSM_DistanceServer   *server;
+  pthread_t             thread;
+  int                   started;
+  LSM_ServiceWorkspace  workspaces[LSM_SERVICE_NUM_CACHED_WORKSPACES];
+  long                  num_jobs;
+} LSM_ServiceWorker;
+
+/*
+ * Structure 'LSM_ServiceConnection' holds a client connection.  A
+ * connection is busy while one of its jobs is queued or running; busy
+ * connections are not polled.
+ */
+typedef struct _LSM_ServiceConnection
+{
+  int fd;
+  int busy;
+} LSM_ServiceConnection;
+
+struct _LSM_DistanceServer
+{
+  char                          socket_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+  int                           listen_fd;
+
+  /* wake-up pipe of the main loop:  workers write the fds of the   */
+  /* connections they have replied on; stopLSMDistanceServer()     */
+  /* writes LSM_SERVICE_STOP_REQUEST                                */
+  int                           wake_pipe[2];
+
+  LSM_ServiceConnection        *connections;
+  int                           num_connections;
+  int                           max_connections;
+
+  /* job queue (ring buffer) */
+  pthread_mutex_t               lock;
+  pthread_cond_t                job_available;
+  LSM_ServiceQueuedJob         *queue;
+  int                           queue_capacity;
+  int                           queue_head;
+  int                           queue_count;
+  int                           shutting_down;
+
+  LSM_ServiceWorker            *workers;
+  int                           num_workers;
+
+  LSM_DistanceServerStatistics  statistics;
+};
+
+
+/*==================== Helper Function Declarations =================*/
+
+/*
+ * lsm_service_sendRequest() sends a request with an attached file
+ * descriptor.
+ */
+static int lsm_service_sendRequest(
+  int sock_fd,
+  const LSM_ServiceRequest *request,
+  int shm_fd);
+
+/*
+ * lsm_service_receiveRequest() receives a request and its attached
+ * file descriptor (-1 if none).  Returns the number of bytes received
+ * (0 if the peer has closed the connection, -1 on error).
+ */
+static ssize_t lsm_service_receiveRequest(
+  int sock_fd,
+  LSM_ServiceRequest *request,
+  int *shm_fd);
+
+/*
+ * lsm_service_sendReply() sends the status of a job.
+ */
+static void lsm_service_sendReply(int sock_fd, int status);
+
+/*
+ * lsm_service_validateRequest() checks a request against the buffer it
+ * refers to.
+ */
+static int lsm_service_validateRequest(
+  const LSM_ServiceRequest *request,
+  int shm_fd);
+
+/*
+ * lsm_service_workerMain() is the main function of the worker threads.
+ */
+static void *lsm_service_workerMain(void *arg);
+
+/*
+ * lsm_service_executeJob() maps the buffer of a job and runs it.
+ */
+static int lsm_service_executeJob(
+  LSM_ServiceWorker *worker,
+  const LSM_ServiceQueuedJob *job);
+
+/*
+ * lsm_service_getWorkspace() returns a cached FMM workspace of the
+ * worker that matches the grid of a request, creating one (and
+ * evicting the least recently used one) if necessary.
+ */
+static FMM_CoreData *lsm_service_getWorkspace(
+  LSM_ServiceWorker *worker,
+  const LSM_ServiceRequest *request);
+
+/*
+ * lsm_service_handleRequest() receives a request on a connection and
+ * queues or rejects it.  Returns 1 if the connection should be closed.
+ */
+static int lsm_service_handleRequest(
+  LSM_DistanceServer *server,
+  LSM_ServiceConnection *connection);
+
+
+/*======================= Client Functions ==========================*/
+
+LSM_ServiceBuffer *createLSMServiceBuffer(
+  int num_dims,
+  const int *grid_dims,
+  int num_fields)
+{
+  LSM_ServiceBuffer *buffer;
+  size_t num_gridpts = 1;
+  int l;
+
+  if ( (num_dims < 2) || (num_dims > 3) || (!grid_dims)
+    || (num_fields < 1) ) {
+    return NULL;
+  }
+  for (l = 0; l < num_dims; l++) {
+    if (grid_dims[l] < 1) return NULL;
+    num_gridpts *= grid_dims[l];
+    if (num_gridpts > INT_MAX) return NULL;
+  }
+
+  buffer = (LSM_ServiceBuffer*) malloc(sizeof(LSM_ServiceBuffer));
+  if (!buffer) return NULL;
+  buffer->num_dims = num_dims;
+  for (l = 0; l < 3; l++) {
+    buffer->grid_dims[l] = (l < num_dims) ? grid_dims[l] : 1;
+  }
+  buffer->num_gridpts = (int) num_gridpts;
+  buffer->num_fields = num_fields;
+  buffer->size = num_gridpts*num_fields*sizeof(LSMLIB_REAL);
+
+  buffer->fd = memfd_create("lsmlib_service_buffer",
+                            MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (buffer->fd < 0) {
+    free(buffer);
+    return NULL;
+  }
+  /* the server maps the buffer, so it must not shrink under the mapping */
+  if ( (ftruncate(buffer->fd, (off_t) buffer->size) != 0)
+    || (fcntl(buffer->fd, F_ADD_SEALS, F_SEAL_SHRINK) != 0) ) {
+    close(buffer->fd);
+    free(buffer);
+    return NULL;
+  }
+  buffer->data = (LSMLIB_REAL*) mmap(NULL, buffer->size,
+                                     PROT_READ | PROT_WRITE, MAP_SHARED,
+                                     buffer->fd, 0);
+  if (buffer->data == MAP_FAILED) {
+    close(buffer->fd);
+    free(buffer);
+    return NULL;
+  }
+
+  return buffer;
+}
+
+
+void destroyLSMServiceBuffer(LSM_ServiceBuffer *buffer)
+{
+  if (!buffer) return;
+  munmap(buffer->data, buffer->size);
+  close(buffer->fd);
+  free(buffer);
+}
+
+
+LSMLIB_REAL *getLSMServiceBufferField(
+  LSM_ServiceBuffer *buffer,
+  int field)
+{
+  if ( (!buffer) || (field < 0) || (field >= buffer->num_fields) ) {
+    return NULL;
+  }
+  return buffer->data + (size_t) field*buffer->num_gridpts;
+}
+
+
+LSM_ServiceClient *connectLSMServiceClient(const char *socket_path)
+{
+  LSM_ServiceClient *client;
+  struct sockaddr_un addr;
+
+  if ( (!socket_path) || (strlen(socket_path) >= sizeof(addr.sun_path)) ) {
+    return NULL;
+  }
+
+  client = (LSM_ServiceClient*) malloc(sizeof(LSM_ServiceClient));
+  if (!client) return NULL;
+
+  client->fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (client->fd < 0) {
+    free(client);
+    return NULL;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path);
+  if (connect(client->fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+    close(client->fd);
+    free(client);
+    return NULL;
+  }
+
+  return client;
+}
+
+
+void disconnectLSMServiceClient(LSM_ServiceClient *client)
+{
+  if (!client) return;
+  close(client->fd);
+  free(client);
+}
+
+
+int submitLSMServiceJob(
+  LSM_ServiceClient *client,
+  LSM_ServiceBuffer *buffer,
+  const LSM_ServiceJob *job)
+{
+  LSM_ServiceRequest request;
+  LSM_ServiceReply reply;
+  ssize_t n;
+  int l;
+
+  if ( (!client) || (!buffer) || (!job) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+
+  memset(&request, 0, sizeof(request));
+  request.magic = LSM_SERVICE_MAGIC;
+  request.version = LSM_SERVICE_PROTOCOL_VERSION;
+  request.real_size = (int32_t) sizeof(LSMLIB_REAL);
+  request.type = job->type;
+  request.spatial_discretization_order = job->spatial_discretization_order;
+  request.num_dims = buffer->num_dims;
+  for (l = 0; l < 3; l++) {
+    request.grid_dims[l] = buffer->grid_dims[l];
+    request.dx[l] = (l < buffer->num_dims) ? job->dx[l] : 1.0;
+  }
+  request.num_fields = buffer->num_fields;
+  request.phi_field = job->phi_field;
+  request.output_field = job->output_field;
+  request.speed_field = job->speed_field;
+  request.mask_field = job->mask_field;
+
+  if (lsm_service_sendRequest(client->fd, &request, buffer->fd) != 0) {
+    return LSM_SERVICE_ERR_CONNECTION;
+  }
+
+  do {
+    n = recv(client->fd, &reply, sizeof(reply), 0);
+  } while ( (n < 0) && (errno == EINTR) );
+  if ( (n != (ssize_t) sizeof(reply)) || (reply.magic != LSM_SERVICE_MAGIC) ) {
+    return LSM_SERVICE_ERR_CONNECTION;
+  }
+
+  return reply.status;
+}
+
+
+/*======================= Server Functions ==========================*/
+
+LSM_DistanceServer *createLSMDistanceServer(
+  const char *socket_path,
+  int max_concurrent_jobs,
+  int max_queued_jobs)
+{
+  LSM_DistanceServer *server;
+  struct sockaddr_un addr;
+  int flags, i;
+  int num_runtime_threads;
+
+  if ( (!socket_path) || (strlen(socket_path) >= sizeof(addr.sun_path)) ) {
+    return NULL;
+  }
+  num_runtime_threads = LSM_Runtime_getNumThreads();
+  if ( (max_concurrent_jobs <= 0)
+    || (max_concurrent_jobs > num_runtime_threads) ) {
+    max_concurrent_jobs = num_runtime_threads;
+  }
+  if (max_queued_jobs <= 0) max_queued_jobs = 4*max_concurrent_jobs;
+
+  server = (LSM_DistanceServer*) calloc(1, sizeof(LSM_DistanceServer));
+  if (!server) return NULL;
+  server->listen_fd = -1;
+  server->wake_pipe[0] = server->wake_pipe[1] = -1;
+  pthread_mutex_init(&server->lock, NULL);
+  pthread_cond_init(&server->job_available, NULL);
+
+  /* job queue and workers */
+  server->queue_capacity = max_queued_jobs;
+  server->queue = (LSM_ServiceQueuedJob*)
+    malloc(max_queued_jobs*sizeof(LSM_ServiceQueuedJob));
+  server->workers = (LSM_ServiceWorker*)
+    calloc(max_concurrent_jobs, sizeof(LSM_ServiceWorker));
+  if ( (!server->queue) || (!server->workers) ) {
+    destroyLSMDistanceServer(server);
+    return NULL;
+  }
+
+  /* wake-up pipe (non-blocking read end) */
+  if (pipe2(server->wake_pipe, O_CLOEXEC) != 0) {
+    server->wake_pipe[0] = server->wake_pipe[1] = -1;
+    destroyLSMDistanceServer(server);
+    return NULL;
+  }
+  flags = fcntl(server->wake_pipe[0], F_GETFL);
+  fcntl(server->wake_pipe[0], F_SETFL, flags | O_NONBLOCK);
+
+  /* listening socket */
+  server->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (server->listen_fd < 0) {
+    destroyLSMDistanceServer(server);
+    return NULL;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socket_path);
+  if (bind(server->listen_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+    /* replace a stale socket file if nobody is listening on it */
+    int probe_fd = -1, stale = 0;
+    if (errno == EADDRINUSE) {
+      probe_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    }
+    if (probe_fd >= 0) {
+      stale = (connect(probe_fd, (struct sockaddr*) &addr,
+                       sizeof(addr)) != 0)
+           && (errno == ECONNREFUSED);
+      close(probe_fd);
+    }
+    if ( (!stale) || (unlink(socket_path) != 0)
+      || (bind(server->listen_fd, (struct sockaddr*) &addr,
+               sizeof(addr)) != 0) ) {
+      destroyLSMDistanceServer(server);
+      return NULL;
+    }
+  }
+  strcpy(server->socket_path, socket_path);
+  if (listen(server->listen_fd, SOMAXCONN) != 0) {
+    destroyLSMDistanceServer(server);
+    return NULL;
+  }
+
+  /* start workers */
+  for (i = 0; i < max_concurrent_jobs; i++) {
+    LSM_ServiceWorker *worker = &server->workers[i];
+    worker->server = server;
+    if (pthread_create(&worker->thread, NULL, lsm_service_workerMain,
+                       worker) != 0) {
+      destroyLSMDistanceServer(server);
+      return NULL;
+    }
+    worker->started = 1;
+    server->num_workers++;
+  }
+
+  return server;
+}
+
+
+int runLSMDistanceServer(LSM_DistanceServer *server)
+{
+  struct pollfd *pollfds = NULL;
+  int max_pollfds = 0;
+  int stop = 0;
+
+  if (!server) return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+
+  while (!stop) {
+    int num_pollfds = 0, num_polled, i, c;
+
+    /* wake-up pipe, listening socket and idle connections */
+    if (server->num_connections + 2 > max_pollfds) {
+      struct pollfd *new_pollfds;
+      max_pollfds = 2*(server->num_connections + 2);
+      new_pollfds = (struct pollfd*)
+        realloc(pollfds, max_pollfds*sizeof(struct pollfd));
+      if (!new_pollfds) {
+        free(pollfds);
+        return LSM_SERVICE_ERR_MEMORY_ALLOCATION;
+      }
+      pollfds = new_pollfds;
+    }
+    pollfds[num_pollfds].fd = server->wake_pipe[0];
+    pollfds[num_pollfds++].events = POLLIN;
+    pollfds[num_pollfds].fd = server->listen_fd;
+    pollfds[num_pollfds++].events = POLLIN;
+    for (c = 0; c < server->num_connections; c++) {
+      if (!server->connections[c].busy) {
+        pollfds[num_pollfds].fd = server->connections[c].fd;
+        pollfds[num_pollfds++].events = POLLIN;
+      }
+    }
+    num_polled = num_pollfds;
+
+    if (poll(pollfds, num_pollfds, -1) < 0) {
+      if (errno == EINTR) continue;
+      free(pollfds);
+      return LSM_SERVICE_ERR_CONNECTION;
+    }
+
+    /* connections whose jobs are complete and stop requests */
+    if (pollfds[0].revents & POLLIN) {
+      int fd;
+      while (read(server->wake_pipe[0], &fd, sizeof(fd))
+             == (ssize_t) sizeof(fd)) {
+        if (fd == LSM_SERVICE_STOP_REQUEST) {
+          stop = 1;
+          continue;
+        }
+        for (c = 0; c < server->num_connections; c++) {
+          if (server->connections[c].fd == fd) {
+            server->connections[c].busy = 0;
+          }
+        }
+      }
+    }
+    if (stop) break;
+
+    /* requests on idle connections (before new connections are added) */
+    for (i = 2; i < num_polled; i++) {
+      if (!pollfds[i].revents) continue;
+      for (c = 0; c < server->num_connections; c++) {
+        LSM_ServiceConnection *connection = &server->connections[c];
+        if (connection->fd != pollfds[i].fd) continue;
+        if (lsm_service_handleRequest(server, connection)) {
+          close(connection->fd);
+          server->connections[c] =
+            server->connections[--server->num_connections];
+        }
+        break;
+      }
+    }
+
+    /* new connections */
+    if (pollfds[1].revents & POLLIN) {
+      int fd = accept4(server->listen_fd, NULL, NULL, SOCK_CLOEXEC);
+      if (fd >= 0) {
+        if (server->num_connections == server->max_connections) {
+          int max_connections = 2*server->max_connections + 4;
+          LSM_ServiceConnection *connections = (LSM_ServiceConnection*)
+            realloc(server->connections,
+                    max_connections*sizeof(LSM_ServiceConnection));
+          if (!connections) {
+            close(fd);
+            continue;
+          }
+          server->connections = connections;
+          server->max_connections = max_connections;
+        }
+        server->connections[server->num_connections].fd = fd;
+        server->connections[server->num_connections].busy = 0;
+        server->num_connections++;
+      }
+    }
+  }
+
+  free(pollfds);
+  return LSM_SERVICE_ERR_SUCCESS;
+}
+
+
+void stopLSMDistanceServer(LSM_DistanceServer *server)
+{
+  int request = LSM_SERVICE_STOP_REQUEST;
+  ssize_t n;
+  if ( (!server) || (server->wake_pipe[1] < 0) ) return;
+  n = write(server->wake_pipe[1], &request, sizeof(request));
+  (void) n;
+}
+
+
+void destroyLSMDistanceServer(LSM_DistanceServer *server)
+{
+  int i, w;
+
+  if (!server) return;
+
+  /* let the workers drain the queue and exit */
+  pthread_mutex_lock(&server->lock);
+  server->shutting_down = 1;
+  pthread_cond_broadcast(&server->job_available);
+  pthread_mutex_unlock(&server->lock);
+  if (server->workers) {
+    for (i = 0; i < server->num_workers; i++) {
+      LSM_ServiceWorker *worker = &server->workers[i];
+      if (!worker->started) continue;
+      pthread_join(worker->thread, NULL);
+      for (w = 0; w < LSM_SERVICE_NUM_CACHED_WORKSPACES; w++) {
+        if (worker->workspaces[w].fmm_core_data) {
+          FMM_Core_destroyFMM_CoreData(worker->workspaces[w].fmm_core_data);
+        }
+      }
+    }
+    free(server->workers);
+  }
+  free(server->queue);
+
+  for (i = 0; i < server->num_connections; i++) {
+    close(server->connections[i].fd);
+  }
+  free(server->connections);
+
+  if (server->listen_fd >= 0) close(server->listen_fd);
+  if (server->socket_path[0]) unlink(server->socket_path);
+  if (server->wake_pipe[0] >= 0) close(server->wake_pipe[0]);
+  if (server->wake_pipe[1] >= 0) close(server->wake_pipe[1]);
+
+  pthread_cond_destroy(&server->job_available);
+  pthread_mutex_destroy(&server->lock);
+  free(server);
+}
+
+
+void getLSMDistanceServerStatistics(
+  LSM_DistanceServer *server,
+  LSM_DistanceServerStatistics *statistics)
+{
+  if ( (!server) || (!statistics) ) return;
+  pthread_mutex_lock(&server->lock);
+  *statistics = server->statistics;
+  pthread_mutex_unlock(&server->lock);
+}
+
+
+/*==================== Helper Function Definitions ==================*/
+
+static int lsm_service_sendRequest(
+  int sock_fd,
+  const LSM_ServiceRequest *request,
+  int shm_fd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union {
+    char buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  ssize_t n;
+
+  memset(&msg, 0, sizeof(msg));
+  memset(&control, 0, sizeof(control));
+  iov.iov_base = (void*) request;
+  iov.iov_len = sizeof(*request);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(cmsg), &shm_fd, sizeof(int));
+
+  do {
+    n = sendmsg(sock_fd, &msg, MSG_NOSIGNAL);
+  } while ( (n < 0) && (errno == EINTR) );
+
+  return (n == (ssize_t) sizeof(*request)) ? 0 : -1;
+}
+
+
+static ssize_t lsm_service_receiveRequest(
+  int sock_fd,
+  LSM_ServiceRequest *request,
+  int *shm_fd)
+{
+  struct msghdr msg;
+  struct iovec iov;
+  struct cmsghdr *cmsg;
+  union {
+    char buf[CMSG_SPACE(sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  ssize_t n;
+
+  *shm_fd = -1;
+  memset(&msg, 0, sizeof(msg));
+  iov.iov_base = request;
+  iov.iov_len = sizeof(*request);
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+
+  do {
+    n = recvmsg(sock_fd, &msg, MSG_CMSG_CLOEXEC);
+  } while ( (n < 0) && (errno == EINTR) );
+  if (n <= 0) return n;
+
+  for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if ( (cmsg->cmsg_level == SOL_SOCKET)
+      && (cmsg->cmsg_type == SCM_RIGHTS)
+      && (cmsg->cmsg_len == CMSG_LEN(sizeof(int))) ) {
+      memcpy(shm_fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+  }
+  if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) return -1;
+
+  return n;
+}
+
+
+static void lsm_service_sendReply(int sock_fd, int status)
+{
+  LSM_ServiceReply reply;
+  ssize_t n;
+
+  reply.magic = LSM_SERVICE_MAGIC;
+  reply.status = status;
+  do {
+    n = send(sock_fd, &reply, sizeof(reply), MSG_NOSIGNAL);
+  } while ( (n < 0) && (errno == EINTR) );
+}
+
+
+static int lsm_service_validateRequest(
+  const LSM_ServiceRequest *request,
+  int shm_fd)
+{
+  struct stat st;
+  int seals;
+  size_t num_gridpts = 1;
+  int num_fields = request->num_fields;
+  int l;
+
+  if ( (request->magic != LSM_SERVICE_MAGIC)
+    || (request->version != LSM_SERVICE_PROTOCOL_VERSION)
+    || (request->real_size != (int32_t) sizeof(LSMLIB_REAL)) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+  if ( (request->type != LSM_SERVICE_DISTANCE_FUNCTION)
+    && (request->type != LSM_SERVICE_EIKONAL_EQUATION) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+  if ( (request->spatial_discretization_order < 1)
+    || (request->spatial_discretization_order > 2) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+  if ( (request->num_dims < 2) || (request->num_dims > 3) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+  for (l = 0; l < request->num_dims; l++) {
+    if ( (request->grid_dims[l] < 1) || (!(request->dx[l] > 0)) ) {
+      return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+    }
+    num_gridpts *= request->grid_dims[l];
+    if (num_gridpts > INT_MAX) return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+
+  /* fields */
+  if ( (num_fields < 1)
+    || (request->phi_field < 0) || (request->phi_field >= num_fields)
+    || (request->mask_field < -1) || (request->mask_field >= num_fields)
+    || (request->mask_field == request->phi_field) ) {
+    return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+  }
+  if (request->type == LSM_SERVICE_DISTANCE_FUNCTION) {
+    if ( (request->output_field < 0) || (request->output_field >= num_fields)
+      || (request->output_field == request->phi_field)
+      || (request->output_field == request->mask_field) ) {
+      return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+    }
+  } else {
+    if ( (request->speed_field < 0) || (request->speed_field >= num_fields)
+      || (request->speed_field == request->phi_field) ) {
+      return LSM_SERVICE_ERR_INVALID_ARGUMENT;
+    }
+  }
+
+  /* shared memory must hold all fields */
+  if (shm_fd < 0) return LSM_SERVICE_ERR_SHARED_MEMORY;
+  seals = fcntl(shm_fd, F_GET_SEALS);
+  if ( (seals < 0) || (!(seals & F_SEAL_SHRINK)) ) {
+    return LSM_SERVICE_ERR_SHARED_MEMORY;
+  }
+  if ( (fstat(shm_fd, &st) != 0)
+    || ((size_t) st.st_size < num_gridpts*num_fields*sizeof(LSMLIB_REAL)) ) {
+    return LSM_SERVICE_ERR_SHARED_MEMORY;
+  }
+
+  return LSM_SERVICE_ERR_SUCCESS;
+}
+
+
+static int lsm_service_handleRequest(
+  LSM_DistanceServer *server,
+  LSM_ServiceConnection *connection)
+{
+  LSM_ServiceQueuedJob job;
+  ssize_t n;
+  int status;
+
+  n = lsm_service_receiveRequest(connection->fd, &job.request, &job.shm_fd);
+  if (n <= 0) {
+    if (job.shm_fd >= 0) close(job.shm_fd);
+    return 1;
+  }
+
+  status = (n == (ssize_t) sizeof(job.request))
+         ? lsm_service_validateRequest(&job.request, job.shm_fd)
+         : LSM_SERVICE_ERR_INVALID_ARGUMENT;
+
+  pthread_mutex_lock(&server->lock);
+  if (status != LSM_SERVICE_ERR_SUCCESS) {
+    server->statistics.jobs_failed++;
+  } else if (server->queue_count == server->queue_capacity) {
+    server->statistics.jobs_rejected++;
+    status = LSM_SERVICE_ERR_QUEUE_FULL;
+  } else {
+    int tail = (server->queue_head + server->queue_count)
+             % server->queue_capacity;
+    job.conn_fd = connection->fd;
+    server->queue[tail] = job;
+    server->queue_count++;
+    connection->busy = 1;
+    pthread_cond_signal(&server->job_available);
+  }
+  pthread_mutex_unlock(&server->lock);
+
+  if (status != LSM_SERVICE_ERR_SUCCESS) {
+    if (job.shm_fd >= 0) close(job.shm_fd);
+    lsm_service_sendReply(connection->fd, status);
+  }
+
+  return 0;
+}
+
+
+static void *lsm_service_workerMain(void *arg)
+{
+  LSM_ServiceWorker *worker = (LSM_ServiceWorker*) arg;
+  LSM_DistanceServer *server = worker->server;
+
+  while (1) {
+    LSM_ServiceQueuedJob job;
+    int status;
+    ssize_t n;
+
+    pthread_mutex_lock(&server->lock);
+    while ( (server->queue_count == 0) && (!server->shutting_down) ) {
+      pthread_cond_wait(&server->job_available, &server->lock);
+    }
+    if (server->queue_count == 0) {
+      pthread_mutex_unlock(&server->lock);
+      break;
+    }
+    job = server->queue[server->queue_head];
+    server->queue_head = (server->queue_head + 1) % server->queue_capacity;
+    server->queue_count--;
+    pthread_mutex_unlock(&server->lock);
+
+    status = lsm_service_executeJob(worker, &job);
+
+    pthread_mutex_lock(&server->lock);
+    if (status == LSM_SERVICE_ERR_SUCCESS) {
+      server->statistics.jobs_completed++;
+    } else {
+      server->statistics.jobs_failed++;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    /* reply and hand the connection back to the main loop */
+    lsm_service_sendReply(job.conn_fd, status);
+    n = write(server->wake_pipe[1], &job.conn_fd, sizeof(job.conn_fd));
+    (void) n;
+  }
+
+  return NULL;
+}
+
+
+static int lsm_service_executeJob(
+  LSM_ServiceWorker *worker,
+  const LSM_ServiceQueuedJob *job)
+{
+  const LSM_ServiceRequest *request = &job->request;
+  size_t num_gridpts = (size_t) request->grid_dims[0]*request->grid_dims[1]
+                     * (request->num_dims == 3 ? request->grid_dims[2] : 1);
+  size_t size = num_gridpts*request->num_fields*sizeof(LSMLIB_REAL);
+  LSMLIB_REAL *data, *phi, *mask;
+  LSMLIB_REAL dx[3];
+  int grid_dims[3];
+  FMM_CoreData *fmm_workspace;
+  int l, err, status = LSM_SERVICE_ERR_SUCCESS;
+
+  data = (LSMLIB_REAL*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                             job->shm_fd, 0);
+  close(job->shm_fd);
+  if (data == MAP_FAILED) return LSM_SERVICE_ERR_SHARED_MEMORY;
+
+  fmm_workspace = lsm_service_getWorkspace(worker, request);
+  if (!fmm_workspace) {
+    munmap(data, size);
+    return LSM_SERVICE_ERR_MEMORY_ALLOCATION;
+  }
+
+  for (l = 0; l < 3; l++) {
+    grid_dims[l] = request->grid_dims[l];
+    dx[l] = (LSMLIB_REAL) request->dx[l];
+  }
+  phi = data + request->phi_field*num_gridpts;
+  mask = (request->mask_field >= 0)
+       ? data + request->mask_field*num_gridpts : NULL;
+
+  if (request->type == LSM_SERVICE_DISTANCE_FUNCTION) {
+    LSMLIB_REAL *distance_function = data + request->output_field*num_gridpts;
+    if (request->num_dims == 2) {
+      err = computeDistanceFunction2dWithWorkspace(
+              distance_function, phi, mask,
+              request->spatial_discretization_order, grid_dims, dx,
+              fmm_workspace);
+    } else {
+      err = computeDistanceFunction3dWithWorkspace(
+              distance_function, phi, mask,
+              request->spatial_discretization_order, grid_dims, dx,
+              fmm_workspace);
+    }
+  } else {
+    LSMLIB_REAL *speed = data + request->speed_field*num_gridpts;
+    if (request->num_dims == 2) {
+      err = solveEikonalEquation2dWithWorkspace(
+              phi, speed, mask,
+              request->spatial_discretization_order, grid_dims, dx,
+              fmm_workspace);
+    } else {
+      err = solveEikonalEquation3dWithWorkspace(
+              phi, speed, mask,
+              request->spatial_discretization_order, grid_dims, dx,
+              fmm_workspace);
+    }
+  }
+  if (err != LSM_FMM_ERR_SUCCESS) status = LSM_SERVICE_ERR_JOB_FAILURE;
+
+  munmap(data, size);
+  return status;
+}
+
+
+static FMM_CoreData *lsm_service_getWorkspace(
+  LSM_ServiceWorker *worker,
+  const LSM_ServiceRequest *request)
+{
+  LSM_ServiceWorkspace *workspace = NULL;
+  LSMLIB_REAL dx[3];
+  int grid_dims[3];
+  int l, w;
+
+  for (l = 0; l < 3; l++) {
+    grid_dims[l] = (l < request->num_dims) ? request->grid_dims[l] : 1;
+    dx[l] = (l < request->num_dims) ? (LSMLIB_REAL) request->dx[l] : 1;
+  }
+  worker->num_jobs++;
+
+  /* look for a workspace for the same grid */
+  for (w = 0; w < LSM_SERVICE_NUM_CACHED_WORKSPACES; w++) {
+    LSM_ServiceWorkspace *candidate = &worker->workspaces[w];
+    int match = (candidate->fmm_core_data != NULL)
+             && (candidate->num_dims == request->num_dims);
+    for (l = 0; match && (l < 3); l++) {
+      match = (candidate->grid_dims[l] == grid_dims[l])
+           && (candidate->dx[l] == dx[l]);
+    }
+    if (match) {
+      candidate->last_used = worker->num_jobs;
+      return candidate->fmm_core_data;
+    }
+  }
+
+  /* replace an unused or the least recently used workspace */
+  for (w = 0; w < LSM_SERVICE_NUM_CACHED_WORKSPACES; w++) {
+    LSM_ServiceWorkspace *candidate = &worker->workspaces[w];
+    if ( (!workspace) || (!candidate->fmm_core_data)
+      || ( (workspace->fmm_core_data)
+        && (candidate->last_used < workspace->last_used) ) ) {
+      workspace = candidate;
+    }
+  }
+  if (workspace->fmm_core_data) {
+    FMM_Core_destroyFMM_CoreData(workspace->fmm_core_data);
+  }
+  workspace->fmm_core_data = FMM_Core_createFMM_CoreData(
+    NULL, request->num_dims, grid_dims, dx, NULL, NULL);
+  if (!workspace->fmm_core_data) return NULL;
+
+  workspace->num_dims = request->num_dims;
+  for (l = 0; l < 3; l++) {
+    workspace->grid_dims[l] = grid_dims[l];
+    workspace->dx[l] = dx[l];
+  }
+  workspace->last_used = worker->num_jobs;
+
+  pthread_mutex_lock(&worker->server->lock);
+  worker->server->statistics.workspaces_created++;
+  pthread_mutex_unlock(&worker->server->lock);
+
+  return workspace->fmm_core_data;
+}
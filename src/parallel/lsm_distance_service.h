@@ -0,0 +1,319 @@
+/*
+ * File:        lsm_distance_service.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for the local distance-transform service
+ */
+
+#ifndef included_lsm_distance_service_h
+#define included_lsm_distance_service_h
+
+#include <stddef.h>
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_distance_service.h
+ *
+ * \brief
+ * @ref lsm_distance_service.h provides a long-running server that
+ * computes distance functions and solves Eikonal equations for client
+ * processes on the same machine, together with a small client library.
+ *
+ * The server keeps a fixed pool of worker threads and, for each worker,
+ * the FMM workspaces (see computeDistanceFunction3dWithWorkspace()) of
+ * the most recently used grid shapes, so that repeated jobs on grids
+ * of the same shape do not allocate any FMM data structures.
+ *
+ * Clients connect to the server through a Unix domain socket.  Field
+ * data are not sent over the socket:  they live in an LSM_ServiceBuffer,
+ * which is an anonymous shared memory file (memfd) mapped into the
+ * client.  Submitting a job passes the file descriptor of the buffer to
+ * the server, which maps the same memory and writes its results in
+ * place.
+ *
+ * Jobs are placed in a bounded queue and executed by at most
+ * max_concurrent_jobs workers at a time.  When the queue is full, new
+ * jobs are rejected with LSM_SERVICE_ERR_QUEUE_FULL instead of being
+ * buffered without limit.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Start the server (e.g. the lsm_distance_server program, or
+ *    createLSMDistanceServer() and runLSMDistanceServer()).
+ * -# In the client, connect using connectLSMServiceClient().
+ * -# Create a buffer using createLSMServiceBuffer() and fill its
+ *    fields through getLSMServiceBufferField().
+ * -# Describe the job in an LSM_ServiceJob and submit it using
+ *    submitLSMServiceJob().  On return, the results are in the buffer.
+ * -# Free the buffer and the connection using destroyLSMServiceBuffer()
+ *    and disconnectLSMServiceClient().
+ *
+ * <h3> NOTES: </h3>
+ *  - The service is only available on Linux (it relies on memfd_create()
+ *    and on passing file descriptors over Unix domain sockets).
+ *
+ *  - A client connection executes one job at a time.  Clients that want
+ *    to run several jobs concurrently open several connections.
+ *
+ *  - The server only accepts shared memory files sealed against
+ *    shrinking (F_SEAL_SHRINK), so that a client cannot truncate a
+ *    buffer while a worker is using it.  Buffers created by
+ *    createLSMServiceBuffer() are sealed.
+ *
+ */
+
+
+/*!
+ * Error codes returned by distance service functions.
+ */
+#define LSM_SERVICE_ERR_SUCCESS                     (0)
+#define LSM_SERVICE_ERR_INVALID_ARGUMENT            (1)
+#define LSM_SERVICE_ERR_MEMORY_ALLOCATION           (2)
+#define LSM_SERVICE_ERR_CONNECTION                  (3)
+#define LSM_SERVICE_ERR_SHARED_MEMORY               (4)
+#define LSM_SERVICE_ERR_QUEUE_FULL                  (5)
+#define LSM_SERVICE_ERR_JOB_FAILURE                 (6)
+
+/*!
+ * Number of FMM workspaces cached by each worker thread of the server.
+ */
+#define LSM_SERVICE_NUM_CACHED_WORKSPACES           (4)
+
+/*!
+ * LSM_ServiceJobType identifies the calculation carried out by a job.
+ *
+ * - LSM_SERVICE_DISTANCE_FUNCTION:  computeDistanceFunction2d() or
+ *                                   computeDistanceFunction3d() of the
+ *                                   phi field; the result is written to
+ *                                   the output field
+ * - LSM_SERVICE_EIKONAL_EQUATION:   solveEikonalEquation2d() or
+ *                                   solveEikonalEquation3d() with the
+ *                                   speed field; the phi field is
+ *                                   overwritten with the solution
+ */
+typedef enum {
+  LSM_SERVICE_DISTANCE_FUNCTION = 0,
+  LSM_SERVICE_EIKONAL_EQUATION  = 1
+} LSM_ServiceJobType;
+
+/*!
+ * Structure 'LSM_ServiceBuffer' holds field data in memory that is
+ * shared with the server.  The buffer contains num_fields fields of
+ * num_gridpts values each; the data for a single field are contiguous
+ * and stored in the same order as for the rest of LSMLIB.
+ */
+typedef struct _LSM_ServiceBuffer
+{
+  /* file descriptor of the shared memory file */
+  int           fd;
+
+  /* grid shape */
+  int           num_dims;
+  int           grid_dims[3];
+  int           num_gridpts;
+
+  /* number of fields */
+  int           num_fields;
+
+  /* size of the mapping in bytes and pointer to the first field */
+  size_t        size;
+  LSMLIB_REAL  *data;
+} LSM_ServiceBuffer;
+
+/*!
+ * Structure 'LSM_ServiceJob' describes a job.  Fields of the buffer are
+ * referred to by index; unused fields are set to -1.
+ */
+typedef struct _LSM_ServiceJob
+{
+  /* calculation to carry out */
+  LSM_ServiceJobType  type;
+
+  /* order of the finite differences (1 or 2) */
+  int                 spatial_discretization_order;
+
+  /* grid cell sizes (only the first num_dims entries are used) */
+  LSMLIB_REAL         dx[3];
+
+  /* field indices */
+  int                 phi_field;      /* level set function or Eikonal
+                                         solution (in/out) */
+  int                 output_field;   /* distance function (distance
+                                         jobs only) */
+  int                 speed_field;    /* speed function (Eikonal jobs
+                                         only) */
+  int                 mask_field;     /* domain mask (-1 for none) */
+} LSM_ServiceJob;
+
+/*!
+ * Structure 'LSM_DistanceServerStatistics' holds counters that describe
+ * the work done by a server.
+ */
+typedef struct _LSM_DistanceServerStatistics
+{
+  long  jobs_completed;        /* jobs that ran successfully       */
+  long  jobs_failed;           /* jobs that were invalid or failed */
+  long  jobs_rejected;         /* jobs rejected by a full queue    */
+  long  workspaces_created;    /* FMM workspaces allocated         */
+} LSM_DistanceServerStatistics;
+
+/*! Opaque client connection. */
+typedef struct _LSM_ServiceClient LSM_ServiceClient;
+
+/*! Opaque server. */
+typedef struct _LSM_DistanceServer LSM_DistanceServer;
+
+
+/*============================ Client API ===========================*/
+
+/*!
+ * createLSMServiceBuffer() allocates a shared memory buffer for fields
+ * on a grid.
+ *
+ * Arguments:
+ *  - num_dims (in):    number of spatial dimensions (2 or 3)
+ *  - grid_dims (in):   number of grid points in each direction
+ *  - num_fields (in):  number of fields
+ *
+ * Return value:        pointer to new LSM_ServiceBuffer (NULL on error)
+ *
+ * NOTES:
+ *  - The fields are initialized to zero.
+ *
+ *  - The shared memory file is sealed with F_SEAL_SHRINK, so its size
+ *    cannot be reduced.
+ *
+ */
+LSM_ServiceBuffer *createLSMServiceBuffer(
+  int num_dims,
+  const int *grid_dims,
+  int num_fields);
+
+/*!
+ * destroyLSMServiceBuffer() unmaps and closes a buffer.
+ */
+void destroyLSMServiceBuffer(LSM_ServiceBuffer *buffer);
+
+/*!
+ * getLSMServiceBufferField() returns a pointer to a field of a buffer
+ * (NULL if the field index is out of range).
+ */
+LSMLIB_REAL *getLSMServiceBufferField(
+  LSM_ServiceBuffer *buffer,
+  int field);
+
+/*!
+ * connectLSMServiceClient() connects to a server.
+ *
+ * Arguments:
+ *  - socket_path (in):  path of the Unix domain socket of the server
+ *
+ * Return value:         pointer to new LSM_ServiceClient (NULL on error)
+ *
+ */
+LSM_ServiceClient *connectLSMServiceClient(const char *socket_path);
+
+/*!
+ * disconnectLSMServiceClient() closes a connection.
+ */
+void disconnectLSMServiceClient(LSM_ServiceClient *client);
+
+/*!
+ * submitLSMServiceJob() submits a job to the server and waits until it
+ * is complete.
+ *
+ * Arguments:
+ *  - client (in):      connection to the server
+ *  - buffer (in/out):  buffer holding the fields of the job
+ *  - job (in):         job description
+ *
+ * Return value:        error code.  LSM_SERVICE_ERR_QUEUE_FULL is
+ *                      returned if the server is too busy to accept the
+ *                      job; the job may be resubmitted later.
+ *
+ */
+int submitLSMServiceJob(
+  LSM_ServiceClient *client,
+  LSM_ServiceBuffer *buffer,
+  const LSM_ServiceJob *job);
+
+
+/*============================ Server API ===========================*/
+
+/*!
+ * createLSMDistanceServer() creates a server listening on a Unix domain
+ * socket and starts its worker threads.
+ *
+ * Arguments:
+ *  - socket_path (in):          path of the socket
+ *  - max_concurrent_jobs (in):  number of worker threads (if <= 0 or
+ *                               larger than the number of LSM_Runtime
+ *                               threads, the number of LSM_Runtime
+ *                               threads)
+ *  - max_queued_jobs (in):      maximum number of jobs waiting for a
+ *                               worker (if <= 0, 4*max_concurrent_jobs)
+ *
+ * Return value:                 pointer to new LSM_DistanceServer (NULL
+ *                               on error)
+ *
+ * NOTES:
+ *  - A stale socket file left behind by a server that is no longer
+ *    running is replaced.  Creation fails if another server is
+ *    listening on socket_path.
+ *
+ *  - The workers are dedicated threads that block waiting for jobs, so
+ *    they are not taken from the LSM_Runtime pool (see
+ *    @ref lsm_runtime.h).  Their number is capped at
+ *    LSM_Runtime_getNumThreads() so that the server does not run more
+ *    jobs than the runtime is configured to use cores.  Each job is
+ *    executed serially by its worker; LSMLIB kernels called from a
+ *    worker while the pool is busy run serially, so concurrent jobs do
+ *    not oversubscribe the processors.
+ *
+ */
+LSM_DistanceServer *createLSMDistanceServer(
+  const char *socket_path,
+  int max_concurrent_jobs,
+  int max_queued_jobs);
+
+/*!
+ * runLSMDistanceServer() accepts connections and jobs until
+ * stopLSMDistanceServer() is called.
+ *
+ * Return value:  error code
+ */
+int runLSMDistanceServer(LSM_DistanceServer *server);
+
+/*!
+ * stopLSMDistanceServer() makes runLSMDistanceServer() return.  It may
+ * be called from any thread or from a signal handler.
+ */
+void stopLSMDistanceServer(LSM_DistanceServer *server);
+
+/*!
+ * destroyLSMDistanceServer() waits for the queued jobs to complete,
+ * stops the worker threads, closes all connections, removes the socket
+ * file and frees the server.
+ */
+void destroyLSMDistanceServer(LSM_DistanceServer *server);
+
+/*!
+ * getLSMDistanceServerStatistics() returns the counters of a server.
+ */
+void getLSMDistanceServerStatistics(
+  LSM_DistanceServer *server,
+  LSM_DistanceServerStatistics *statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
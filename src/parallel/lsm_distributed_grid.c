@@ -0,0 +1,666 @@
+/*
+ * File:        lsm_distributed_grid.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for block-decomposed grids that support
+ *              distributed-memory (MPI) LSMLIB calculations
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lsmlib_config.h"
+#include "lsm_distributed_grid.h"
+
+
+/*===================== Distributed Grid Constants ===================*/
+#ifdef LSMLIB_DOUBLE_PRECISION
+#define LSM_DISTRIBUTED_MPI_REAL            MPI_DOUBLE
+#else
+#define LSM_DISTRIBUTED_MPI_REAL            MPI_FLOAT
+#endif
+
+#define LSM_DISTRIBUTED_HALO_TAG            (7301)
+#define LSM_DISTRIBUTED_GATHER_TAG          (7302)
+#define LSM_DISTRIBUTED_INFINITY            (LSMLIB_REAL_MAX)
+
+
+/*================= Helper Function Declarations =====================*/
+
+/*
+ * computeBlockExtent() computes the offset and size of block
+ * 'block_coord' when 'n' grid points are divided among 'num_blocks'
+ * blocks.
+ */
+static void computeBlockExtent(
+  int n,
+  int num_blocks,
+  int block_coord,
+  int *offset,
+  int *size);
+
+/*
+ * createSlabType() creates an MPI datatype for the subarray of the
+ * local ghostbox with the specified starting indices and sizes.
+ */
+static int createSlabType(
+  Grid *grid,
+  int *starts,
+  int *sizes,
+  MPI_Datatype *type);
+
+/*
+ * solveEikonalUpdate() computes the first-order upwind solution of
+ * |grad u| = 1 given the smallest neighboring value 'a' and grid
+ * spacing 'h' in each of 'n' directions.
+ */
+static LSMLIB_REAL solveEikonalUpdate(
+  LSMLIB_REAL *a,
+  LSMLIB_REAL *h,
+  int n);
+
+
+/*==================== Distributed Grid Management ===================*/
+
+LSM_DistributedGrid *createDistributedGrid(
+  MPI_Comm comm,
+  int num_dims,
+  int *grid_dims,
+  LSMLIB_REAL *x_lo,
+  LSMLIB_REAL *x_hi,
+  LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy,
+  int *proc_dims,
+  int *periodic)
+{
+  LSM_DistributedGrid *dgrid;
+  Grid *local_grid;
+  int local_dims[3];
+  LSMLIB_REAL local_x_lo[3], local_x_hi[3];
+  int local_error = 0, error = 0;
+  int dir, side, g;
+
+  if ( (num_dims != 2) && (num_dims != 3) ) return NULL;
+
+  dgrid = (LSM_DistributedGrid *) calloc(1, sizeof(LSM_DistributedGrid));
+  if (!dgrid) return NULL;
+
+  /* set up Cartesian process topology */
+  for (dir = 0; dir < 3; dir++) {
+    dgrid->proc_dims[dir] = (proc_dims && (dir < num_dims)) ?
+                            proc_dims[dir] : 0;
+    dgrid->periodic[dir] = (periodic && (dir < num_dims)) ?
+                           (periodic[dir] != 0) : 0;
+    dgrid->proc_coords[dir] = 0;
+  }
+  MPI_Comm_size(comm, &(dgrid->num_procs));
+  if (MPI_Dims_create(dgrid->num_procs, num_dims, dgrid->proc_dims)
+      != MPI_SUCCESS) {
+    free(dgrid);
+    return NULL;
+  }
+  if (num_dims == 2) dgrid->proc_dims[2] = 1;
+
+  if (MPI_Cart_create(comm, num_dims, dgrid->proc_dims, dgrid->periodic,
+                      0, &(dgrid->comm)) != MPI_SUCCESS) {
+    free(dgrid);
+    return NULL;
+  }
+  MPI_Comm_rank(dgrid->comm, &(dgrid->rank));
+  MPI_Cart_coords(dgrid->comm, dgrid->rank, num_dims, dgrid->proc_coords);
+
+  for (dir = 0; dir < 3; dir++) {
+    if (dir < num_dims) {
+      MPI_Cart_shift(dgrid->comm, dir, 1, &(dgrid->neighbors[2*dir]),
+                     &(dgrid->neighbors[2*dir+1]));
+    } else {
+      dgrid->neighbors[2*dir] = MPI_PROC_NULL;
+      dgrid->neighbors[2*dir+1] = MPI_PROC_NULL;
+    }
+  }
+
+  /* create global grid and grid for the local block */
+  /* (allocation failures are reported through the collective error   */
+  /* check below so that the other processes do not wait forever)     */
+  dgrid->global_grid = createGridSetGridDims(num_dims, grid_dims,
+                                             x_lo, x_hi, accuracy);
+  local_grid = NULL;
+  if (dgrid->global_grid) {
+    for (dir = 0; dir < num_dims; dir++) {
+      computeBlockExtent(grid_dims[dir], dgrid->proc_dims[dir],
+                         dgrid->proc_coords[dir],
+                         &(dgrid->global_offset[dir]), &(local_dims[dir]));
+      local_x_lo[dir] = x_lo[dir]
+                      + dgrid->global_offset[dir]
+                      * dgrid->global_grid->dx[dir];
+      local_x_hi[dir] = local_x_lo[dir]
+                      + local_dims[dir]*dgrid->global_grid->dx[dir];
+      if (local_dims[dir] < 1) local_error = 1;
+    }
+    if (local_error) local_dims[0] = local_dims[1] = local_dims[2] = 1;
+    local_grid = createGridSetGridDims(num_dims, local_dims,
+                                       local_x_lo, local_x_hi, accuracy);
+  }
+  dgrid->local_grid = local_grid;
+
+  if (local_grid) {
+    /* use exactly the same grid spacing as the global grid */
+    g = (local_grid->grid_dims_ghostbox[0] - local_grid->grid_dims[0])/2;
+    dgrid->num_ghostcells = g;
+    for (dir = 0; dir < num_dims; dir++) {
+      local_grid->dx[dir] = dgrid->global_grid->dx[dir];
+      local_grid->x_lo_ghostbox[dir] = local_grid->x_lo[dir]
+                                     - g*local_grid->dx[dir];
+      local_grid->x_hi_ghostbox[dir] = local_grid->x_hi[dir]
+                                     + g*local_grid->dx[dir];
+
+      /* blocks must be at least as wide as the halo */
+      if (local_dims[dir] < g) local_error = 1;
+    }
+  } else {
+    local_error = 1;
+  }
+
+  /* all processes must agree on success */
+  MPI_Allreduce(&local_error, &error, 1, MPI_INT, MPI_MAX, dgrid->comm);
+  if (error) {
+    destroyGrid(dgrid->global_grid);
+    destroyGrid(dgrid->local_grid);
+    MPI_Comm_free(&(dgrid->comm));
+    free(dgrid);
+    return NULL;
+  }
+
+  /*
+   * create halo datatypes:  direction 'dir' covers the full ghostbox in
+   * the directions exchanged before it and the interior in the
+   * directions exchanged after it
+   */
+  for (dir = 0; dir < num_dims; dir++) {
+    for (side = 0; side < 2; side++) {
+      int send_starts[3], recv_starts[3], sizes[3];
+      int other;
+
+      for (other = 0; other < num_dims; other++) {
+        if (other < dir) {
+          send_starts[other] = recv_starts[other] = 0;
+          sizes[other] = local_grid->grid_dims_ghostbox[other];
+        } else if (other > dir) {
+          send_starts[other] = recv_starts[other] = g;
+          sizes[other] = local_grid->grid_dims[other];
+        } else {
+          sizes[other] = g;
+          send_starts[other] = (side == 0) ? g : local_grid->grid_dims[dir];
+          recv_starts[other] = (side == 0) ? 0
+                                           : g + local_grid->grid_dims[dir];
+        }
+      }
+
+      createSlabType(local_grid, send_starts, sizes,
+                     &(dgrid->send_types[2*dir+side]));
+      createSlabType(local_grid, recv_starts, sizes,
+                     &(dgrid->recv_types[2*dir+side]));
+    }
+  }
+  for (dir = num_dims; dir < 3; dir++) {
+    for (side = 0; side < 2; side++) {
+      dgrid->send_types[2*dir+side] = MPI_DATATYPE_NULL;
+      dgrid->recv_types[2*dir+side] = MPI_DATATYPE_NULL;
+    }
+  }
+
+  return dgrid;
+}
+
+
+void destroyDistributedGrid(LSM_DistributedGrid *dgrid)
+{
+  int i;
+
+  if (!dgrid) return;
+
+  for (i = 0; i < 6; i++) {
+    if (dgrid->send_types[i] != MPI_DATATYPE_NULL) {
+      MPI_Type_free(&(dgrid->send_types[i]));
+    }
+    if (dgrid->recv_types[i] != MPI_DATATYPE_NULL) {
+      MPI_Type_free(&(dgrid->recv_types[i]));
+    }
+  }
+  destroyGrid(dgrid->global_grid);
+  destroyGrid(dgrid->local_grid);
+  MPI_Comm_free(&(dgrid->comm));
+  free(dgrid);
+}
+
+
+/*========================= Ghostcell Functions ======================*/
+
+int exchangeDistributedGridHalos(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *field)
+{
+  int num_dims;
+  int dir;
+
+  if ( (!dgrid) || (!field) ) return LSM_DISTRIBUTED_ERR_INVALID_ARGUMENT;
+
+  /*
+   * the send and receive regions of field are disjoint, but MPI does not
+   * allow the same buffer to be passed as both the send and receive
+   * buffer of a single call, so nonblocking operations are used.  The
+   * directions are processed in order so that edge and corner ghostcells
+   * are filled by the later directions.
+   */
+  num_dims = dgrid->local_grid->num_dims;
+  for (dir = 0; dir < num_dims; dir++) {
+    MPI_Request requests[4];
+    int lo = dgrid->neighbors[2*dir];
+    int hi = dgrid->neighbors[2*dir+1];
+    int error = MPI_SUCCESS;
+
+    /* receive upper ghostcells from above, lower ghostcells from below */
+    error |= MPI_Irecv(field, 1, dgrid->recv_types[2*dir+1], hi,
+                       LSM_DISTRIBUTED_HALO_TAG, dgrid->comm, &requests[0]);
+    error |= MPI_Irecv(field, 1, dgrid->recv_types[2*dir], lo,
+                       LSM_DISTRIBUTED_HALO_TAG, dgrid->comm, &requests[1]);
+
+    /* send lower interior slab down, upper interior slab up */
+    error |= MPI_Isend(field, 1, dgrid->send_types[2*dir], lo,
+                       LSM_DISTRIBUTED_HALO_TAG, dgrid->comm, &requests[2]);
+    error |= MPI_Isend(field, 1, dgrid->send_types[2*dir+1], hi,
+                       LSM_DISTRIBUTED_HALO_TAG, dgrid->comm, &requests[3]);
+
+    error |= MPI_Waitall(4, requests, MPI_STATUSES_IGNORE);
+    if (error != MPI_SUCCESS) return LSM_DISTRIBUTED_ERR_MPI;
+  }
+
+  return LSM_DISTRIBUTED_ERR_SUCCESS;
+}
+
+
+void imposeDistributedBoundaryConditions(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *field,
+  LSM_BoundaryConditionFuncPtr bc_func)
+{
+  int num_dims = dgrid->local_grid->num_dims;
+  int dir;
+
+  /* boundary location index is 2*dir (lower face) or 2*dir+1 (upper) */
+  for (dir = 0; dir < num_dims; dir++) {
+    if (dgrid->periodic[dir]) continue;
+    if (dgrid->proc_coords[dir] == 0) {
+      bc_func(field, dgrid->local_grid, 2*dir);
+    }
+    if (dgrid->proc_coords[dir] == dgrid->proc_dims[dir]-1) {
+      bc_func(field, dgrid->local_grid, 2*dir+1);
+    }
+  }
+}
+
+
+/*========================= Global Reductions ========================*/
+
+LSMLIB_REAL computeDistributedMin(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value)
+{
+  LSMLIB_REAL global_value = local_value;
+  MPI_Allreduce(&local_value, &global_value, 1, LSM_DISTRIBUTED_MPI_REAL,
+                MPI_MIN, dgrid->comm);
+  return global_value;
+}
+
+
+LSMLIB_REAL computeDistributedMax(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value)
+{
+  LSMLIB_REAL global_value = local_value;
+  MPI_Allreduce(&local_value, &global_value, 1, LSM_DISTRIBUTED_MPI_REAL,
+                MPI_MAX, dgrid->comm);
+  return global_value;
+}
+
+
+LSMLIB_REAL computeDistributedSum(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value)
+{
+  LSMLIB_REAL global_value = local_value;
+  MPI_Allreduce(&local_value, &global_value, 1, LSM_DISTRIBUTED_MPI_REAL,
+                MPI_SUM, dgrid->comm);
+  return global_value;
+}
+
+
+/*======================== Distributed Algorithms ====================*/
+
+int computeDistributedDistanceFunction(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  int max_iterations)
+{
+  Grid *grid;
+  LSMLIB_REAL *dist = distance_function;
+  unsigned char *fixed;
+  int num_dims, g;
+  int lo[3], hi[3];           /* interior index range */
+  int valid_lo[3], valid_hi[3];  /* index range usable as neighbors */
+  int stride[3];
+  int idx_ijk[3];
+  int dir, iteration, sweep;
+  int error = LSM_DISTRIBUTED_ERR_NOT_CONVERGED;
+
+  if ( (!dgrid) || (!distance_function) || (!phi) ) {
+    return LSM_DISTRIBUTED_ERR_INVALID_ARGUMENT;
+  }
+
+  grid = dgrid->local_grid;
+  num_dims = grid->num_dims;
+  g = dgrid->num_ghostcells;
+
+  for (dir = 0; dir < 3; dir++) {
+    if (dir < num_dims) {
+      lo[dir] = g;
+      hi[dir] = g + grid->grid_dims[dir] - 1;
+      valid_lo[dir] = (dgrid->neighbors[2*dir] == MPI_PROC_NULL) ? lo[dir] : 0;
+      valid_hi[dir] = (dgrid->neighbors[2*dir+1] == MPI_PROC_NULL) ?
+                      hi[dir] : grid->grid_dims_ghostbox[dir] - 1;
+    } else {
+      lo[dir] = hi[dir] = valid_lo[dir] = valid_hi[dir] = 0;
+    }
+  }
+  stride[0] = 1;
+  stride[1] = grid->grid_dims_ghostbox[0];
+  stride[2] = grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+
+  if (max_iterations <= 0) {
+    max_iterations = 16;
+    for (dir = 0; dir < num_dims; dir++) {
+      max_iterations += 4*dgrid->proc_dims[dir];
+    }
+  }
+
+  fixed = (unsigned char *) calloc(grid->num_gridpts, sizeof(unsigned char));
+  if (!fixed) return LSM_DISTRIBUTED_ERR_MEMORY_ALLOCATION;
+
+  /* make sure phi is valid in ghostcells shared with other blocks */
+  if (exchangeDistributedGridHalos(dgrid, phi)) {
+    free(fixed);
+    return LSM_DISTRIBUTED_ERR_MPI;
+  }
+
+  /* initialize grid points adjacent to the zero level set */
+  {
+    int idx;
+    for (idx = 0; idx < grid->num_gridpts; idx++) {
+      dist[idx] = LSM_DISTRIBUTED_INFINITY;
+    }
+  }
+  for (idx_ijk[2] = lo[2]; idx_ijk[2] <= hi[2]; idx_ijk[2]++) {
+    for (idx_ijk[1] = lo[1]; idx_ijk[1] <= hi[1]; idx_ijk[1]++) {
+      for (idx_ijk[0] = lo[0]; idx_ijk[0] <= hi[0]; idx_ijk[0]++) {
+        int idx = idx_ijk[0] + idx_ijk[1]*stride[1] + idx_ijk[2]*stride[2];
+        LSMLIB_REAL phi_cur = phi[idx];
+        LSMLIB_REAL inv_dist_sq = 0.0;
+        int found = 0;
+
+        if (phi_cur == 0.0) {
+          dist[idx] = 0.0;
+          fixed[idx] = 1;
+          continue;
+        }
+
+        for (dir = 0; dir < num_dims; dir++) {
+          LSMLIB_REAL s = LSM_DISTRIBUTED_INFINITY;
+          int side;
+          for (side = -1; side <= 1; side += 2) {
+            int nb = idx_ijk[dir] + side;
+            LSMLIB_REAL phi_nb;
+            if ( (nb < valid_lo[dir]) || (nb > valid_hi[dir]) ) continue;
+            phi_nb = phi[idx + side*stride[dir]];
+            if (phi_cur*phi_nb <= 0.0) {
+              LSMLIB_REAL s_nb = grid->dx[dir]*fabs(phi_cur)
+                               / (fabs(phi_cur) + fabs(phi_nb));
+              if (s_nb < s) s = s_nb;
+            }
+          }
+          if (s < LSM_DISTRIBUTED_INFINITY) {
+            inv_dist_sq += 1.0/(s*s);
+            found = 1;
+          }
+        }
+
+        if (found) {
+          dist[idx] = 1.0/sqrt(inv_dist_sq);
+          fixed[idx] = 1;
+        }
+      }
+    }
+  }
+
+  if (exchangeDistributedGridHalos(dgrid, dist)) {
+    free(fixed);
+    return LSM_DISTRIBUTED_ERR_MPI;
+  }
+
+  /* sweep and exchange until the distance function stops changing */
+  for (iteration = 0; iteration < max_iterations; iteration++) {
+    LSMLIB_REAL local_change = 0.0;
+    LSMLIB_REAL global_change;
+
+    for (sweep = 0; sweep < (1 << num_dims); sweep++) {
+      int start[3], end[3], step[3];
+
+      for (dir = 0; dir < 3; dir++) {
+        if (sweep & (1 << dir)) {
+          start[dir] = hi[dir];  end[dir] = lo[dir]-1;  step[dir] = -1;
+        } else {
+          start[dir] = lo[dir];  end[dir] = hi[dir]+1;  step[dir] = 1;
+        }
+      }
+
+      for (idx_ijk[2] = start[2]; idx_ijk[2] != end[2];
+           idx_ijk[2] += step[2]) {
+        for (idx_ijk[1] = start[1]; idx_ijk[1] != end[1];
+             idx_ijk[1] += step[1]) {
+          for (idx_ijk[0] = start[0]; idx_ijk[0] != end[0];
+               idx_ijk[0] += step[0]) {
+            int idx = idx_ijk[0] + idx_ijk[1]*stride[1]
+                    + idx_ijk[2]*stride[2];
+            LSMLIB_REAL a[3], h[3];
+            LSMLIB_REAL dist_new;
+
+            if (fixed[idx]) continue;
+
+            for (dir = 0; dir < num_dims; dir++) {
+              a[dir] = LSM_DISTRIBUTED_INFINITY;
+              h[dir] = grid->dx[dir];
+              if (idx_ijk[dir] - 1 >= valid_lo[dir]) {
+                a[dir] = dist[idx - stride[dir]];
+              }
+              if ( (idx_ijk[dir] + 1 <= valid_hi[dir]) &&
+                   (dist[idx + stride[dir]] < a[dir]) ) {
+                a[dir] = dist[idx + stride[dir]];
+              }
+            }
+
+            dist_new = solveEikonalUpdate(a, h, num_dims);
+            if (dist_new < dist[idx]) {
+              LSMLIB_REAL change = dist[idx] - dist_new;
+              if (change > local_change) local_change = change;
+              dist[idx] = dist_new;
+            }
+          }
+        }
+      }
+    }
+
+    if (exchangeDistributedGridHalos(dgrid, dist)) {
+      error = LSM_DISTRIBUTED_ERR_MPI;
+      break;
+    }
+
+    global_change = computeDistributedMax(dgrid, local_change);
+    if (global_change <= LSMLIB_ZERO_TOL) {
+      error = LSM_DISTRIBUTED_ERR_SUCCESS;
+      break;
+    }
+  }
+
+  /* restore sign */
+  {
+    int idx;
+    for (idx = 0; idx < grid->num_gridpts; idx++) {
+      if (phi[idx] < 0.0) dist[idx] = -dist[idx];
+    }
+  }
+
+  free(fixed);
+  return error;
+}
+
+
+int gatherDistributedField(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *global_field,
+  LSMLIB_REAL *local_field,
+  int root)
+{
+  Grid *local_grid = dgrid->local_grid;
+  Grid *global_grid = dgrid->global_grid;
+  int num_dims = local_grid->num_dims;
+  int g = dgrid->num_ghostcells;
+  int starts[3], sizes[3];
+  MPI_Datatype send_type;
+  MPI_Request request;
+  int dir, error = LSM_DISTRIBUTED_ERR_SUCCESS;
+
+  /* send interior of local block */
+  for (dir = 0; dir < num_dims; dir++) {
+    starts[dir] = g;
+    sizes[dir] = local_grid->grid_dims[dir];
+  }
+  if (createSlabType(local_grid, starts, sizes, &send_type)) {
+    return LSM_DISTRIBUTED_ERR_MPI;
+  }
+  MPI_Isend(local_field, 1, send_type, root, LSM_DISTRIBUTED_GATHER_TAG,
+            dgrid->comm, &request);
+
+  /* receive blocks on root */
+  if (dgrid->rank == root) {
+    int proc;
+    for (proc = 0; proc < dgrid->num_procs; proc++) {
+      int coords[3];
+      MPI_Datatype recv_type;
+
+      MPI_Cart_coords(dgrid->comm, proc, num_dims, coords);
+      for (dir = 0; dir < num_dims; dir++) {
+        int offset;
+        computeBlockExtent(global_grid->grid_dims[dir],
+                           dgrid->proc_dims[dir], coords[dir],
+                           &offset, &(sizes[dir]));
+        starts[dir] = g + offset;
+      }
+      if (createSlabType(global_grid, starts, sizes, &recv_type)) {
+        error = LSM_DISTRIBUTED_ERR_MPI;
+        continue;
+      }
+      MPI_Recv(global_field, 1, recv_type, proc, LSM_DISTRIBUTED_GATHER_TAG,
+               dgrid->comm, MPI_STATUS_IGNORE);
+      MPI_Type_free(&recv_type);
+    }
+  }
+
+  MPI_Wait(&request, MPI_STATUS_IGNORE);
+  MPI_Type_free(&send_type);
+
+  return error;
+}
+
+
+/*================= Helper Function Definitions ======================*/
+
+static void computeBlockExtent(
+  int n,
+  int num_blocks,
+  int block_coord,
+  int *offset,
+  int *size)
+{
+  int base = n/num_blocks;
+  int remainder = n % num_blocks;
+
+  *size = base + ( (block_coord < remainder) ? 1 : 0 );
+  *offset = block_coord*base
+          + ( (block_coord < remainder) ? block_coord : remainder );
+}
+
+
+static int createSlabType(
+  Grid *grid,
+  int *starts,
+  int *sizes,
+  MPI_Datatype *type)
+{
+  if (MPI_Type_create_subarray(grid->num_dims, grid->grid_dims_ghostbox,
+                               sizes, starts, MPI_ORDER_FORTRAN,
+                               LSM_DISTRIBUTED_MPI_REAL, type)
+      != MPI_SUCCESS) {
+    return LSM_DISTRIBUTED_ERR_MPI;
+  }
+  if (MPI_Type_commit(type) != MPI_SUCCESS) {
+    return LSM_DISTRIBUTED_ERR_MPI;
+  }
+  return LSM_DISTRIBUTED_ERR_SUCCESS;
+}
+
+
+static LSMLIB_REAL solveEikonalUpdate(
+  LSMLIB_REAL *a,
+  LSMLIB_REAL *h,
+  int n)
+{
+  LSMLIB_REAL A = 0.0, B = 0.0, C = 0.0;
+  LSMLIB_REAL u;
+  int m, l;
+
+  /* sort neighboring values in increasing order */
+  for (m = 1; m < n; m++) {
+    for (l = m; (l > 0) && (a[l] < a[l-1]); l--) {
+      LSMLIB_REAL tmp;
+      tmp = a[l];  a[l] = a[l-1];  a[l-1] = tmp;
+      tmp = h[l];  h[l] = h[l-1];  h[l-1] = tmp;
+    }
+  }
+
+  if (a[0] >= LSM_DISTRIBUTED_INFINITY) return LSM_DISTRIBUTED_INFINITY;
+
+  /* add directions while the solution exceeds the next neighbor value */
+  u = a[0] + h[0];
+  for (m = 0; m < n; m++) {
+    LSMLIB_REAL inv_h_sq, discriminant;
+
+    if ( (m > 0) && ( (a[m] >= LSM_DISTRIBUTED_INFINITY) || (u <= a[m]) ) ) {
+      break;
+    }
+
+    inv_h_sq = 1.0/(h[m]*h[m]);
+    A += inv_h_sq;
+    B += a[m]*inv_h_sq;
+    C += a[m]*a[m]*inv_h_sq;
+
+    discriminant = B*B - A*(C - 1.0);
+    if (discriminant < 0.0) break;
+    u = (B + sqrt(discriminant))/A;
+  }
+
+  return u;
+}
@@ -0,0 +1,351 @@
+/*
+ * File:        lsm_distributed_grid.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for block-decomposed grids that support
+ *              distributed-memory (MPI) LSMLIB calculations
+ */
+
+#ifndef included_lsm_distributed_grid_h
+#define included_lsm_distributed_grid_h
+
+#include "lsmlib_config.h"
+
+#ifndef LSMLIB_HAVE_MPI
+#error "lsm_distributed_grid.h requires LSMLIB to be built with USE_MPI=ON"
+#endif
+
+#include <mpi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_distributed_grid.h
+ *
+ * \brief
+ * @ref lsm_distributed_grid.h provides support for level set method
+ * calculations on grids that are too large for a single node.  The
+ * global grid is decomposed into rectangular blocks (one per MPI
+ * process).  Each process stores its block as an ordinary Grid whose
+ * ghostcells hold copies of the data of neighboring blocks (halos).
+ *
+ * Because the local Grid is an ordinary Grid, all of the serial LSMLIB
+ * kernels (full-grid and narrow-band "local" versions) can be applied
+ * unchanged to the data on each process.  A typical time step is:
+ *
+ * -# exchangeDistributedGridHalos() to fill ghostcells shared with
+ *    neighboring processes.
+ * -# imposeDistributedBoundaryConditions() to fill ghostcells on the
+ *    boundary of the global domain.
+ * -# apply the serial kernels to the local Grid.
+ * -# combine per-process results (e.g. stable time step, norms,
+ *    volumes) with computeDistributedMin(), computeDistributedMax() and
+ *    computeDistributedSum().
+ *
+ * Reinitialization is provided by computeDistributedDistanceFunction(),
+ * a parallel fast sweeping method that alternates Gauss-Seidel sweeps
+ * on each block with halo exchanges.
+ *
+ */
+
+#include "lsm_grid.h"
+
+
+/*!
+ * Error codes returned by distributed grid functions.
+ */
+#define LSM_DISTRIBUTED_ERR_SUCCESS                 (0)
+#define LSM_DISTRIBUTED_ERR_INVALID_ARGUMENT        (1)
+#define LSM_DISTRIBUTED_ERR_MEMORY_ALLOCATION       (2)
+#define LSM_DISTRIBUTED_ERR_MPI                     (3)
+#define LSM_DISTRIBUTED_ERR_NOT_CONVERGED           (4)
+
+/*!
+ * Structure 'LSM_DistributedGrid' describes the decomposition of a
+ * global grid into blocks and the block owned by the calling process.
+ */
+typedef struct _LSM_DistributedGrid
+{
+  /* Cartesian communicator (one process per block) */
+  MPI_Comm      comm;
+  int           rank;
+  int           num_procs;
+
+  /* number of blocks in each direction and coordinates of local block */
+  int           proc_dims[3];
+  int           proc_coords[3];
+  int           periodic[3];
+
+  /* ranks of neighboring blocks (MPI_PROC_NULL at physical boundaries) */
+  /* neighbors[2*dir] is the lower neighbor, neighbors[2*dir+1] the upper */
+  int           neighbors[6];
+
+  /* global grid (meta-data only; no field data is associated with it) */
+  Grid         *global_grid;
+
+  /* grid for the local block (including halo ghostcells) */
+  Grid         *local_grid;
+
+  /* global index of the first interior grid point of the local block */
+  int           global_offset[3];
+
+  /* number of ghostcells on each side of the local block */
+  int           num_ghostcells;
+
+  /* MPI datatypes for halo exchange:  send_types[2*dir+side] and */
+  /* recv_types[2*dir+side] describe ghostbox slabs (side 0 = lo) */
+  MPI_Datatype  send_types[6];
+  MPI_Datatype  recv_types[6];
+
+} LSM_DistributedGrid;
+
+/*!
+ * LSM_BoundaryConditionFuncPtr has the signature of the serial boundary
+ * condition functions in @ref lsm_boundary_conditions.h (e.g.
+ * signedLinearExtrapolationBC()).
+ */
+typedef void (*LSM_BoundaryConditionFuncPtr)(
+  LSMLIB_REAL *phi,
+  Grid *grid,
+  int bdry_location_idx);
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Distributed grid management functions
+ *
+ ****************************************************************/
+
+/*!
+ * createDistributedGrid() decomposes a global grid into blocks and
+ * creates the LSM_DistributedGrid for the calling process.
+ *
+ * Arguments:
+ *  - comm (in):       MPI communicator containing all processes that
+ *                     share the grid
+ *  - num_dims (in):   spatial dimension (2 or 3)
+ *  - grid_dims (in):  number of grid points in each direction for the
+ *                     interior of the global domain
+ *  - x_lo (in):       lower corner of the interior of the global domain
+ *  - x_hi (in):       upper corner of the interior of the global domain
+ *  - accuracy (in):   desired accuracy ("LOW","MEDIUM","HIGH" or
+ *                     "VERY_HIGH"); determines the halo width
+ *  - proc_dims (in):  number of blocks in each direction; set to NULL
+ *                     (or set entries to 0) to let MPI choose
+ *  - periodic (in):   flags indicating periodic directions; set to NULL
+ *                     for a non-periodic domain
+ *
+ * Return value:       pointer to new LSM_DistributedGrid (NULL on
+ *                     failure)
+ *
+ * NOTES:
+ *  - createDistributedGrid() is collective over comm.
+ *
+ *  - Every block must contain at least as many interior grid points
+ *    as the halo width in each direction.
+ *
+ */
+LSM_DistributedGrid *createDistributedGrid(
+  MPI_Comm comm,
+  int num_dims,
+  int *grid_dims,
+  LSMLIB_REAL *x_lo,
+  LSMLIB_REAL *x_hi,
+  LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy,
+  int *proc_dims,
+  int *periodic);
+
+/*!
+ * destroyDistributedGrid() frees the memory associated with an
+ * LSM_DistributedGrid (including its Cartesian communicator).
+ *
+ * Arguments:
+ *  - dgrid (in):  pointer to LSM_DistributedGrid
+ *
+ * Return value:   none
+ *
+ * NOTES:
+ *  - destroyDistributedGrid() is collective.
+ *
+ */
+void destroyDistributedGrid(LSM_DistributedGrid *dgrid);
+
+/*! @} */
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Ghostcell functions
+ *
+ ****************************************************************/
+
+/*!
+ * exchangeDistributedGridHalos() fills the ghostcells of a field that
+ * overlap neighboring blocks (including periodic images) with data
+ * from the interiors of those blocks.
+ *
+ * Arguments:
+ *  - dgrid (in):      pointer to LSM_DistributedGrid
+ *  - field (in/out):  field on the local grid
+ *
+ * Return value:       error code
+ *
+ * NOTES:
+ *  - Directions are exchanged one at a time over the full ghostbox
+ *    extent of the previously exchanged directions, so edge and corner
+ *    ghostcells are also filled.
+ *
+ *  - Ghostcells on the boundary of the global domain are not modified.
+ *
+ */
+int exchangeDistributedGridHalos(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *field);
+
+/*!
+ * imposeDistributedBoundaryConditions() applies a serial boundary
+ * condition function to the faces of the local block that lie on the
+ * (non-periodic) boundary of the global domain.
+ *
+ * Arguments:
+ *  - dgrid (in):      pointer to LSM_DistributedGrid
+ *  - field (in/out):  field on the local grid
+ *  - bc_func (in):    serial boundary condition function
+ *
+ * Return value:       none
+ *
+ */
+void imposeDistributedBoundaryConditions(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *field,
+  LSM_BoundaryConditionFuncPtr bc_func);
+
+/*! @} */
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Global reductions
+ *
+ ****************************************************************/
+
+/*!
+ * computeDistributedMin(), computeDistributedMax() and
+ * computeDistributedSum() combine a value computed on each block
+ * (e.g. by a serial LSMLIB kernel applied to the local grid) into a
+ * global value that is returned on all processes.
+ *
+ * Typical uses:
+ *  - stable time step:  computeDistributedMin() of the local result of
+ *    LSM3D_COMPUTE_STABLE_ADVECTION_DT (or similar)
+ *  - max norms:         computeDistributedMax() of the local result of
+ *    LSM3D_MAX_NORM_DIFF
+ *  - volume and surface integrals:  computeDistributedSum() of the
+ *    local result of LSM3D_VOLUME_INTEGRAL_PHI_LESS_THAN_ZERO (or
+ *    similar) evaluated over the local fillbox
+ *
+ * Arguments:
+ *  - dgrid (in):        pointer to LSM_DistributedGrid
+ *  - local_value (in):  value computed on the local block
+ *
+ * Return value:         global minimum, maximum or sum
+ *
+ */
+LSMLIB_REAL computeDistributedMin(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value);
+
+LSMLIB_REAL computeDistributedMax(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value);
+
+LSMLIB_REAL computeDistributedSum(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL local_value);
+
+/*! @} */
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Distributed algorithms
+ *
+ ****************************************************************/
+
+/*!
+ * computeDistributedDistanceFunction() computes the signed distance
+ * function for the zero level set of phi using a parallel first-order
+ * fast sweeping method.
+ *
+ * Arguments:
+ *  - dgrid (in):              pointer to LSM_DistributedGrid
+ *  - distance_function (out): signed distance function
+ *  - phi (in/out):            level set function (ghostcells shared
+ *                             with other blocks are updated)
+ *  - max_iterations (in):     maximum number of sweep/exchange
+ *                             iterations (if max_iterations <= 0, a
+ *                             default based on the number of blocks
+ *                             is used)
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - Grid points adjacent to the zero level set are initialized using
+ *    linear interpolation of phi and are held fixed.  The remaining
+ *    grid points are computed by Gauss-Seidel sweeps in all 2^num_dims
+ *    orderings on each block.  Halos are exchanged after each set of
+ *    sweeps until the distance function stops changing on every block.
+ *
+ *  - The ghostcells of distance_function shared with other blocks are
+ *    valid on return.  Ghostcells on the global boundary are not set.
+ *
+ *  - computeDistributedDistanceFunction() is collective.
+ *
+ */
+int computeDistributedDistanceFunction(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *distance_function,
+  LSMLIB_REAL *phi,
+  int max_iterations);
+
+/*!
+ * gatherDistributedField() collects the interior data of a field from
+ * all blocks into a single array on the root process.
+ *
+ * Arguments:
+ *  - dgrid (in):          pointer to LSM_DistributedGrid
+ *  - global_field (out):  array on the root process with the layout of
+ *                         dgrid->global_grid (ignored on other
+ *                         processes; ghostcells are not set)
+ *  - local_field (in):    field on the local grid
+ *  - root (in):           rank of the root process
+ *
+ * Return value:           error code
+ *
+ * NOTES:
+ *  - gatherDistributedField() is intended for output and testing; it
+ *    requires the root process to hold the entire global field.
+ *
+ */
+int gatherDistributedField(
+  LSM_DistributedGrid *dgrid,
+  LSMLIB_REAL *global_field,
+  LSMLIB_REAL *local_field,
+  int root);
+
+/*! @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
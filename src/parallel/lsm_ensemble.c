@@ -0,0 +1,444 @@
+/*
+ * File:        lsm_ensemble.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for LSM_Ensemble data structure and
+ *              batch operations
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "lsmlib_config.h"
+#include "lsm_ensemble.h"
+#include "lsm_runtime.h"
+#include "lsm_fast_marching_method.h"
+#include "lsm_spatial_derivatives2d.h"
+#include "lsm_tvd_runge_kutta2d.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Structure 'LSM_EnsembleTask' is shared by all threads processing
+ * an ensemble.
+ */
+typedef struct _LSM_EnsembleTask
+{
+  LSM_Ensemble *ensemble;
+  LSM_EnsembleKernelFuncPtr kernel;
+  void *user_data;
+  atomic_int error;
+} LSM_EnsembleTask;
+
+
+/*
+ * allocateWorkspace() allocates the scratch arrays of a workspace.  It
+ * is called by the thread that owns the workspace so that the memory
+ * is first touched by that thread.
+ */
+static int allocateWorkspace(
+  LSM_EnsembleWorkspace *workspace,
+  Grid *grid)
+{
+  int i;
+
+  for (i = 0; i < LSM_ENSEMBLE_NUM_SCRATCH_ARRAYS; i++) {
+    if (workspace->scratch[i]) continue;
+    workspace->scratch[i] =
+      (LSMLIB_REAL *) calloc(grid->num_gridpts, sizeof(LSMLIB_REAL));
+    if (!workspace->scratch[i]) return LSM_ENSEMBLE_ERR_MEMORY_ALLOCATION;
+  }
+
+  return LSM_ENSEMBLE_ERR_SUCCESS;
+}
+
+
+/*
+ * processEnsembleMembers() is the LSM_Runtime_parallelFor() body that 
+ * applies the kernel to the members in [begin, end).
+ */
+static void processEnsembleMembers(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_EnsembleTask *task = (LSM_EnsembleTask *) user_data;
+  LSM_Ensemble *ensemble = task->ensemble;
+  LSM_EnsembleWorkspace *workspace = &(ensemble->workspaces[thread_num]);
+  int member;
+
+  if (allocateWorkspace(workspace, ensemble->grid)) {
+    atomic_store(&(task->error), LSM_ENSEMBLE_ERR_MEMORY_ALLOCATION);
+    return;
+  }
+
+  for (member = begin; member < end; member++) {
+    if (task->kernel(ensemble, member, workspace, task->user_data)) {
+      atomic_store(&(task->error), LSM_ENSEMBLE_ERR_KERNEL_FAILURE);
+    }
+  }
+}
+
+
+/*======================== Ensemble Management =======================*/
+
+LSM_Ensemble *createLSMEnsemble(
+  Grid *grid,
+  int num_members,
+  int num_fields,
+  int num_threads)
+{
+  LSM_Ensemble *ensemble;
+  size_t num_values;
+
+  if ( (!grid) || (num_members < 1) || (num_fields < 1) ) return NULL;
+
+  ensemble = (LSM_Ensemble *) calloc(1, sizeof(LSM_Ensemble));
+  if (!ensemble) return NULL;
+
+  ensemble->grid = grid;
+  ensemble->num_members = num_members;
+  ensemble->num_fields = num_fields;
+
+  /* allocate contiguous storage for all fields of all members */
+  num_values = (size_t) num_members * num_fields * grid->num_gridpts;
+  ensemble->data = (LSMLIB_REAL *) calloc(num_values, sizeof(LSMLIB_REAL));
+  if (!ensemble->data) {
+    free(ensemble);
+    return NULL;
+  }
+
+  /* workspaces are allocated when the ensemble is first processed */
+  ensemble->num_threads = (num_threads > 0) ? num_threads : 0;
+  ensemble->num_workspaces = 0;
+  ensemble->workspaces = NULL;
+
+  return ensemble;
+}
+
+
+void destroyLSMEnsemble(LSM_Ensemble *ensemble)
+{
+  int t, i;
+
+  if (!ensemble) return;
+
+  for (t = 0; t < ensemble->num_workspaces; t++) {
+    LSM_EnsembleWorkspace *workspace = &(ensemble->workspaces[t]);
+    for (i = 0; i < LSM_ENSEMBLE_NUM_SCRATCH_ARRAYS; i++) {
+      free(workspace->scratch[i]);
+    }
+    if (workspace->fmm_workspace) {
+      FMM_Core_destroyFMM_CoreData(workspace->fmm_workspace);
+    }
+  }
+  free(ensemble->workspaces);
+  free(ensemble->data);
+  free(ensemble);
+}
+
+
+/*
+ * isValidEnsembleField() determines whether field is a valid field
+ * index of the ensemble.
+ */
+static int isValidEnsembleField(const LSM_Ensemble *ensemble, int field)
+{
+  return (field >= 0) && (field < ensemble->num_fields);
+}
+
+
+LSMLIB_REAL *getLSMEnsembleField(
+  LSM_Ensemble *ensemble,
+  int member,
+  int field)
+{
+  size_t offset;
+
+  if ( (!ensemble) || (member < 0) || (member >= ensemble->num_members)
+    || (!isValidEnsembleField(ensemble, field)) ) {
+    return NULL;
+  }
+
+  offset = ((size_t) member * ensemble->num_fields + field)
+                * ensemble->grid->num_gridpts;
+  return ensemble->data + offset;
+}
+
+
+int runLSMEnsembleKernel(
+  LSM_Ensemble *ensemble,
+  LSM_EnsembleKernelFuncPtr kernel,
+  void *user_data)
+{
+  LSM_EnsembleTask task;
+  int num_workspaces;
+
+  if ( (!ensemble) || (!kernel) ) return LSM_ENSEMBLE_ERR_INVALID_ARGUMENT;
+
+  /* make sure there is a workspace for every runtime thread */
+  num_workspaces = LSM_Runtime_getNumThreads();
+  if (num_workspaces > ensemble->num_workspaces) {
+    LSM_EnsembleWorkspace *workspaces = (LSM_EnsembleWorkspace *)
+      realloc(ensemble->workspaces,
+              num_workspaces*sizeof(LSM_EnsembleWorkspace));
+    if (!workspaces) return LSM_ENSEMBLE_ERR_MEMORY_ALLOCATION;
+    memset(workspaces + ensemble->num_workspaces, 0,
+      (num_workspaces - ensemble->num_workspaces)
+      *sizeof(LSM_EnsembleWorkspace));
+    ensemble->workspaces = workspaces;
+    ensemble->num_workspaces = num_workspaces;
+  }
+
+  task.ensemble = ensemble;
+  task.kernel = kernel;
+  task.user_data = user_data;
+  atomic_init(&(task.error), LSM_ENSEMBLE_ERR_SUCCESS);
+
+  /* one member per task */
+  LSM_Runtime_parallelFor(0, ensemble->num_members,
+                          LSM_SCHEDULE_DYNAMIC, 1, ensemble->num_threads,
+                          processEnsembleMembers, &task);
+
+  return atomic_load(&(task.error));
+}
+
+
+/*====================== Built-in Ensemble Kernels ===================*/
+
+typedef struct _LSM_EnsembleDistanceArgs
+{
+  int distance_function_field;
+  int phi_field;
+  int mask_field;
+  int spatial_discretization_order;
+} LSM_EnsembleDistanceArgs;
+
+static int ensembleDistanceFunction2dKernel(
+  LSM_Ensemble *ensemble,
+  int member,
+  LSM_EnsembleWorkspace *workspace,
+  void *user_data)
+{
+  LSM_EnsembleDistanceArgs *args = (LSM_EnsembleDistanceArgs *) user_data;
+  Grid *grid = ensemble->grid;
+  LSMLIB_REAL *mask = (args->mask_field < 0) ? NULL :
+    getLSMEnsembleField(ensemble, member, args->mask_field);
+
+  if (!workspace->fmm_workspace) {
+    workspace->fmm_workspace = FMM_Core_createFMM_CoreData(
+      NULL, 2, grid->grid_dims_ghostbox, grid->dx, NULL, NULL);
+  }
+
+  return computeDistanceFunction2dWithWorkspace(
+    getLSMEnsembleField(ensemble, member, args->distance_function_field),
+    getLSMEnsembleField(ensemble, member, args->phi_field),
+    mask,
+    args->spatial_discretization_order,
+    grid->grid_dims_ghostbox,
+    grid->dx,
+    workspace->fmm_workspace);
+}
+
+int computeLSMEnsembleDistanceFunction2d(
+  LSM_Ensemble *ensemble,
+  int distance_function_field,
+  int phi_field,
+  int mask_field,
+  int spatial_discretization_order)
+{
+  LSM_EnsembleDistanceArgs args;
+
+  if ( (!ensemble) || (ensemble->grid->num_dims != 2)
+    || (!isValidEnsembleField(ensemble, distance_function_field))
+    || (!isValidEnsembleField(ensemble, phi_field))
+    || (mask_field >= ensemble->num_fields) ) {
+    return LSM_ENSEMBLE_ERR_INVALID_ARGUMENT;
+  }
+
+  args.distance_function_field = distance_function_field;
+  args.phi_field = phi_field;
+  args.mask_field = mask_field;
+  args.spatial_discretization_order = spatial_discretization_order;
+
+  return runLSMEnsembleKernel(ensemble, ensembleDistanceFunction2dKernel,
+                              &args);
+}
+
+
+typedef struct _LSM_EnsembleHJENO2Args
+{
+  int phi_x_plus_field, phi_y_plus_field;
+  int phi_x_minus_field, phi_y_minus_field;
+  int phi_field;
+} LSM_EnsembleHJENO2Args;
+
+static int ensembleHJENO2_2dKernel(
+  LSM_Ensemble *ensemble,
+  int member,
+  LSM_EnsembleWorkspace *workspace,
+  void *user_data)
+{
+  LSM_EnsembleHJENO2Args *args = (LSM_EnsembleHJENO2Args *) user_data;
+  Grid *g = ensemble->grid;
+
+  LSM2D_HJ_ENO2(
+    getLSMEnsembleField(ensemble, member, args->phi_x_plus_field),
+    getLSMEnsembleField(ensemble, member, args->phi_y_plus_field),
+    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+    getLSMEnsembleField(ensemble, member, args->phi_x_minus_field),
+    getLSMEnsembleField(ensemble, member, args->phi_y_minus_field),
+    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+    getLSMEnsembleField(ensemble, member, args->phi_field),
+    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+    workspace->scratch[0],
+    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+    workspace->scratch[1],
+    &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+    &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+    &(g->dx[0]), &(g->dx[1]));
+
+  return LSM_ENSEMBLE_ERR_SUCCESS;
+}
+
+int computeLSMEnsembleHJENO2_2d(
+  LSM_Ensemble *ensemble,
+  int phi_x_plus_field,
+  int phi_y_plus_field,
+  int phi_x_minus_field,
+  int phi_y_minus_field,
+  int phi_field)
+{
+  LSM_EnsembleHJENO2Args args;
+
+  if ( (!ensemble) || (ensemble->grid->num_dims != 2)
+    || (!isValidEnsembleField(ensemble, phi_x_plus_field))
+    || (!isValidEnsembleField(ensemble, phi_y_plus_field))
+    || (!isValidEnsembleField(ensemble, phi_x_minus_field))
+    || (!isValidEnsembleField(ensemble, phi_y_minus_field))
+    || (!isValidEnsembleField(ensemble, phi_field)) ) {
+    return LSM_ENSEMBLE_ERR_INVALID_ARGUMENT;
+  }
+
+  args.phi_x_plus_field = phi_x_plus_field;
+  args.phi_y_plus_field = phi_y_plus_field;
+  args.phi_x_minus_field = phi_x_minus_field;
+  args.phi_y_minus_field = phi_y_minus_field;
+  args.phi_field = phi_field;
+
+  return runLSMEnsembleKernel(ensemble, ensembleHJENO2_2dKernel, &args);
+}
+
+
+typedef struct _LSM_EnsembleTVDRKArgs
+{
+  int rk_order, stage;
+  int u_next_field, u_stage_field, u_cur_field, rhs_field;
+  const LSMLIB_REAL *dt;
+} LSM_EnsembleTVDRKArgs;
+
+static int ensembleTVDRK2dKernel(
+  LSM_Ensemble *ensemble,
+  int member,
+  LSM_EnsembleWorkspace *workspace,
+  void *user_data)
+{
+  LSM_EnsembleTVDRKArgs *args = (LSM_EnsembleTVDRKArgs *) user_data;
+  Grid *g = ensemble->grid;
+  LSMLIB_REAL *u_next =
+    getLSMEnsembleField(ensemble, member, args->u_next_field);
+  LSMLIB_REAL *u_stage = (args->stage == 1) ? NULL :
+    getLSMEnsembleField(ensemble, member, args->u_stage_field);
+  LSMLIB_REAL *u_cur =
+    getLSMEnsembleField(ensemble, member, args->u_cur_field);
+  LSMLIB_REAL *rhs =
+    getLSMEnsembleField(ensemble, member, args->rhs_field);
+  const LSMLIB_REAL *dt = &(args->dt[member]);
+
+  (void) workspace;
+
+  if (args->stage == 1) {
+    if (args->rk_order == 3) {
+      LSM2D_TVD_RK3_STAGE1(
+        u_next, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        u_cur, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        rhs, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+        dt);
+    } else {
+      /* first stage of RK1 and TVD RK2 is a forward Euler step */
+      LSM2D_RK1_STEP(
+        u_next, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        u_cur, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        rhs, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+        &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+        dt);
+    }
+  } else if ( (args->rk_order == 2) && (args->stage == 2) ) {
+    LSM2D_TVD_RK2_STAGE2(
+      u_next, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_stage, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_cur, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      rhs, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+      dt);
+  } else if (args->stage == 2) {
+    LSM2D_TVD_RK3_STAGE2(
+      u_next, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_stage, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_cur, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      rhs, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+      dt);
+  } else {
+    LSM2D_TVD_RK3_STAGE3(
+      u_next, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_stage, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      u_cur, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      rhs, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+      &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+      dt);
+  }
+
+  return LSM_ENSEMBLE_ERR_SUCCESS;
+}
+
+int advanceLSMEnsembleTVDRK2d(
+  LSM_Ensemble *ensemble,
+  int rk_order,
+  int stage,
+  int u_next_field,
+  int u_stage_field,
+  int u_cur_field,
+  int rhs_field,
+  const LSMLIB_REAL *dt)
+{
+  LSM_EnsembleTVDRKArgs args;
+
+  if ( (!ensemble) || (ensemble->grid->num_dims != 2) || (!dt)
+    || (rk_order < 1) || (rk_order > 3)
+    || (stage < 1) || (stage > rk_order)
+    || (!isValidEnsembleField(ensemble, u_next_field))
+    || ( (stage > 1) && (!isValidEnsembleField(ensemble, u_stage_field)) )
+    || (!isValidEnsembleField(ensemble, u_cur_field))
+    || (!isValidEnsembleField(ensemble, rhs_field)) ) {
+    return LSM_ENSEMBLE_ERR_INVALID_ARGUMENT;
+  }
+
+  args.rk_order = rk_order;
+  args.stage = stage;
+  args.u_next_field = u_next_field;
+  args.u_stage_field = u_stage_field;
+  args.u_cur_field = u_cur_field;
+  args.rhs_field = rhs_field;
+  args.dt = dt;
+
+  return runLSMEnsembleKernel(ensemble, ensembleTVDRK2dKernel, &args);
+}
@@ -0,0 +1,309 @@
+/*
+ * File:        lsm_ensemble.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for LSM_Ensemble data structure and functions
+ *              for batch solution of many small independent problems
+ */
+
+#ifndef included_lsm_ensemble_h
+#define included_lsm_ensemble_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_ensemble.h
+ *
+ * \brief
+ * @ref lsm_ensemble.h provides support for solving a large batch
+ * ("ensemble") of small, independent level set problems that are all
+ * posed on grids with the same shape.
+ *
+ * The field data for all members of the ensemble are stored in a single
+ * contiguous allocation.  The data for a single member are contiguous,
+ * so each member may be passed directly to any LSMLIB routine that
+ * operates on a single grid.  Ensemble operations are scheduled across
+ * the threads of the LSMLIB runtime (see @ref lsm_runtime.h) with one 
+ * member per task.  Each thread owns a workspace (scratch arrays and 
+ * an FMM_CoreData) that is allocated once and reused for every member 
+ * the thread processes.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create a Grid that describes the shape of a single member.
+ * -# Create the ensemble using createLSMEnsemble().
+ * -# Initialize member data through getLSMEnsembleField().
+ * -# Apply the built-in batch operations (e.g.
+ *    computeLSMEnsembleDistanceFunction2d()) or user-defined kernels
+ *    via runLSMEnsembleKernel().
+ * -# Free the ensemble using destroyLSMEnsemble().
+ *
+ */
+
+#include "lsm_grid.h"
+#include "FMM_Core.h"
+
+
+/*!
+ * Error codes returned by ensemble functions.
+ */
+#define LSM_ENSEMBLE_ERR_SUCCESS                    (0)
+#define LSM_ENSEMBLE_ERR_INVALID_ARGUMENT           (1)
+#define LSM_ENSEMBLE_ERR_MEMORY_ALLOCATION          (2)
+/* (3) was LSM_ENSEMBLE_ERR_THREAD_CREATION; reserved since the ensemble
+ *     runs on the shared LSM_Runtime thread pool */
+#define LSM_ENSEMBLE_ERR_KERNEL_FAILURE             (4)
+
+/*!
+ * Number of grid-sized scratch arrays contained in each
+ * LSM_EnsembleWorkspace.
+ */
+#define LSM_ENSEMBLE_NUM_SCRATCH_ARRAYS             (3)
+
+/*!
+ * Structure 'LSM_EnsembleWorkspace' holds the per-thread scratch memory
+ * used by ensemble kernels.  Its contents persist between calls so
+ * that no memory is allocated while an ensemble is being processed.
+ */
+typedef struct _LSM_EnsembleWorkspace
+{
+  /* scratch arrays of size (grid->num_gridpts) (e.g. D1, D2, D3) */
+  LSMLIB_REAL  *scratch[LSM_ENSEMBLE_NUM_SCRATCH_ARRAYS];
+
+  /* reusable FMM workspace (created on first use) */
+  FMM_CoreData *fmm_workspace;
+
+} LSM_EnsembleWorkspace;
+
+/*!
+ * Structure 'LSM_Ensemble' stores the field data for a batch of
+ * same-shaped problems.
+ */
+typedef struct _LSM_Ensemble
+{
+  /* grid shared by all members of the ensemble (not owned) */
+  Grid  *grid;
+
+  /* number of members and number of fields per member */
+  int    num_members;
+  int    num_fields;
+
+  /* contiguous field data:  (num_members x num_fields x num_gridpts) */
+  LSMLIB_REAL  *data;
+
+  /* maximum number of threads (0 to use all runtime threads) */
+  int    num_threads;
+
+  /* per-thread workspaces (indexed by runtime thread number) */
+  int    num_workspaces;
+  LSM_EnsembleWorkspace  *workspaces;
+
+} LSM_Ensemble;
+
+/*!
+ * LSM_EnsembleKernelFuncPtr is a function that processes a single member
+ * of an ensemble.
+ *
+ * Arguments:
+ *  - ensemble (in/out):  ensemble being processed
+ *  - member (in):        index of member to process
+ *  - workspace (in):     workspace owned by the calling thread
+ *  - user_data (in):     pointer passed through from runLSMEnsembleKernel()
+ *
+ * Return value:          0 on success; non-zero error code otherwise
+ *
+ */
+typedef int (*LSM_EnsembleKernelFuncPtr)(
+  LSM_Ensemble *ensemble,
+  int member,
+  LSM_EnsembleWorkspace *workspace,
+  void *user_data);
+
+
+/*!
+ * createLSMEnsemble() allocates an LSM_Ensemble and the contiguous
+ * memory for all of its field data.
+ *
+ * Arguments:
+ *  - grid (in):         Grid describing the shape of each member
+ *  - num_members (in):  number of problems in the ensemble
+ *  - num_fields (in):   number of data arrays per problem
+ *  - num_threads (in):  maximum number of threads to use for ensemble 
+ *                       operations; if num_threads <= 0, all threads of
+ *                       the LSMLIB runtime are used
+ *
+ * Return value:         pointer to new LSM_Ensemble (NULL on failure)
+ *
+ * NOTES:
+ *  - All field data are initialized to zero.
+ *
+ *  - The grid is NOT copied, so it must not be destroyed before the
+ *    ensemble is destroyed.
+ *
+ */
+LSM_Ensemble *createLSMEnsemble(
+  Grid *grid,
+  int num_members,
+  int num_fields,
+  int num_threads);
+
+
+/*!
+ * destroyLSMEnsemble() frees all memory associated with an LSM_Ensemble
+ * (including the per-thread workspaces).
+ *
+ * Arguments:
+ *  - ensemble (in):  pointer to LSM_Ensemble
+ *
+ * Return value:      none
+ *
+ */
+void destroyLSMEnsemble(LSM_Ensemble *ensemble);
+
+
+/*!
+ * getLSMEnsembleField() returns a pointer to the data array for the
+ * specified field of the specified member.
+ *
+ * Arguments:
+ *  - ensemble (in):  pointer to LSM_Ensemble
+ *  - member (in):    member index (0 <= member < num_members)
+ *  - field (in):     field index (0 <= field < num_fields)
+ *
+ * Return value:      pointer to data array of size (grid->num_gridpts)
+ *                    (NULL if member or field is out of range)
+ *
+ */
+LSMLIB_REAL *getLSMEnsembleField(
+  LSM_Ensemble *ensemble,
+  int member,
+  int field);
+
+
+/*!
+ * runLSMEnsembleKernel() applies a kernel to every member of the
+ * ensemble.  Members are distributed dynamically across the threads
+ * of the LSMLIB runtime (one member per task).
+ *
+ * Arguments:
+ *  - ensemble (in/out):  pointer to LSM_Ensemble
+ *  - kernel (in):        kernel function to apply
+ *  - user_data (in):     pointer passed through to kernel
+ *
+ * Return value:          LSM_ENSEMBLE_ERR_SUCCESS if the kernel succeeds
+ *                        for all members; LSM_ENSEMBLE_ERR_KERNEL_FAILURE
+ *                        if the kernel fails for any member
+ *
+ * NOTES:
+ *  - The kernel is called concurrently from multiple threads.  It must
+ *    only modify data belonging to its member and its workspace.
+ *
+ */
+int runLSMEnsembleKernel(
+  LSM_Ensemble *ensemble,
+  LSM_EnsembleKernelFuncPtr kernel,
+  void *user_data);
+
+
+/*!
+ * computeLSMEnsembleDistanceFunction2d() computes the distance function
+ * for every member of a 2D ensemble using computeDistanceFunction2d().
+ *
+ * Arguments:
+ *  - ensemble (in/out):                  pointer to LSM_Ensemble
+ *  - distance_function_field (in):       field index for the distance
+ *                                        function (output)
+ *  - phi_field (in):                     field index for phi (input)
+ *  - mask_field (in):                    field index for mask (input);
+ *                                        set to -1 if there is no mask
+ *  - spatial_discretization_order (in):  order of the FMM discretization
+ *
+ * Return value:                          error code
+ *
+ * NOTES:
+ *  - distance_function_field and phi_field may be the same.
+ *
+ */
+int computeLSMEnsembleDistanceFunction2d(
+  LSM_Ensemble *ensemble,
+  int distance_function_field,
+  int phi_field,
+  int mask_field,
+  int spatial_discretization_order);
+
+
+/*!
+ * computeLSMEnsembleHJENO2_2d() computes the plus and minus second-order
+ * HJ ENO approximations to grad(phi) for every member of a 2D ensemble
+ * using LSM2D_HJ_ENO2().
+ *
+ * Arguments:
+ *  - ensemble (in/out):  pointer to LSM_Ensemble
+ *  - phi_x_plus_field, phi_y_plus_field (in):    field indices for the
+ *                                                plus derivatives (output)
+ *  - phi_x_minus_field, phi_y_minus_field (in):  field indices for the
+ *                                                minus derivatives (output)
+ *  - phi_field (in):     field index for phi (input)
+ *
+ * Return value:          error code
+ *
+ * NOTES:
+ *  - The fillbox is taken from the ensemble grid (i.e. the index space
+ *    limits set by setIndexSpaceLimits()).
+ *
+ *  - The D1 and D2 scratch arrays are taken from the thread workspaces.
+ *
+ */
+int computeLSMEnsembleHJENO2_2d(
+  LSM_Ensemble *ensemble,
+  int phi_x_plus_field,
+  int phi_y_plus_field,
+  int phi_x_minus_field,
+  int phi_y_minus_field,
+  int phi_field);
+
+
+/*!
+ * advanceLSMEnsembleTVDRK2d() carries out a single stage of a TVD
+ * Runge-Kutta time integrator for every member of a 2D ensemble using
+ * the LSM2D_RK1_STEP, LSM2D_TVD_RK2_STAGE* and LSM2D_TVD_RK3_STAGE*
+ * routines.
+ *
+ * Arguments:
+ *  - ensemble (in/out):  pointer to LSM_Ensemble
+ *  - rk_order (in):      order of the TVD Runge-Kutta scheme (1, 2 or 3)
+ *  - stage (in):         stage to carry out (1 <= stage <= rk_order)
+ *  - u_next_field (in):  field index for the result of the stage
+ *  - u_stage_field (in): field index for the result of the previous
+ *                        stage (ignored for the first stage)
+ *  - u_cur_field (in):   field index for the solution at the beginning
+ *                        of the time step
+ *  - rhs_field (in):     field index for the right-hand side evaluated
+ *                        at the previous stage
+ *  - dt (in):            array of time steps (one per member)
+ *
+ * Return value:          error code
+ *
+ */
+int advanceLSMEnsembleTVDRK2d(
+  LSM_Ensemble *ensemble,
+  int rk_order,
+  int stage,
+  int u_next_field,
+  int u_stage_field,
+  int u_cur_field,
+  int rhs_field,
+  const LSMLIB_REAL *dt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
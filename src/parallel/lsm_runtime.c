@@ -0,0 +1,702 @@
+/*
+ * File:        lsm_runtime.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of the LSMLIB thread pool runtime
+ */
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "lsmlib_config.h"
+#include "lsm_runtime.h"
+
+
+/*======================= Runtime Constants =========================*/
+#define LSM_RUNTIME_CACHE_LINE_SIZE          (64)
+#define LSM_RUNTIME_DYNAMIC_CHUNKS_PER_THREAD (8)
+#define LSM_RUNTIME_MAX_NUMA_NODES           (64)
+
+
+/*===================== Runtime Data Structures =====================*/
+
+/*
+ * Structure 'LSM_RuntimeRange' holds the iterations [next, end) that
+ * remain to be executed by one thread during a dynamically scheduled
+ * loop.  Other threads may steal from the top of the range.  Ranges
+ * are padded to avoid false sharing.
+ */
+typedef struct _LSM_RuntimeRange
+{
+  pthread_mutex_t lock;
+  int next;
+  int end;
+  char pad[LSM_RUNTIME_CACHE_LINE_SIZE];
+} LSM_RuntimeRange;
+
+/*
+ * Structure 'LSM_RuntimeLoop' describes the loop currently being
+ * executed by the pool.
+ */
+typedef struct _LSM_RuntimeLoop
+{
+  LSM_ParallelForBodyFuncPtr body;
+  void *user_data;
+  int begin, end;
+  int chunk_size;
+  int num_threads;
+  LSM_ScheduleType schedule;
+  LSM_RuntimeRange *ranges;
+} LSM_RuntimeLoop;
+
+/*
+ * Structure 'LSM_RuntimeState' holds the state of the (single) pool.
+ */
+typedef struct _LSM_RuntimeState
+{
+  /* set (with release semantics) once the pool has been started */
+  atomic_int initialized;
+  int num_threads;
+  LSM_AffinityPolicy affinity;
+  pthread_t *workers;
+
+  /* loop dispatch */
+  pthread_mutex_t mutex;
+  pthread_cond_t start_cond;
+  pthread_cond_t done_cond;
+  unsigned long generation;
+  unsigned long start_generation;
+  int shutdown;
+  int num_remaining;
+  LSM_RuntimeLoop *loop;
+
+  /* set while the pool is executing a loop */
+  atomic_int busy;
+
+  /* CPU sets for the worker threads (one per thread, may be empty) */
+#ifdef __linux__
+  cpu_set_t *cpu_sets;
+#endif
+} LSM_RuntimeState;
+
+static LSM_RuntimeState lsm_runtime = {
+  .initialized = 0,
+  .num_threads = 0,
+  .affinity = LSM_AFFINITY_NONE,
+  .workers = NULL,
+  .mutex = PTHREAD_MUTEX_INITIALIZER,
+  .start_cond = PTHREAD_COND_INITIALIZER,
+  .done_cond = PTHREAD_COND_INITIALIZER,
+  .generation = 0,
+  .start_generation = 0,
+  .shutdown = 0,
+  .num_remaining = 0,
+  .loop = NULL,
+  .busy = 0,
+#ifdef __linux__
+  .cpu_sets = NULL,
+#endif
+};
+
+/* serializes initialization and finalization of the pool */
+static pthread_mutex_t lsm_runtime_init_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* per-thread loop state */
+static _Thread_local int lsm_runtime_thread_num = 0;
+static _Thread_local int lsm_runtime_in_parallel = 0;
+
+
+/*=============== Runtime Helper Function Declarations ===============*/
+
+/*
+ * getDefaultNumThreads() returns the number of threads specified by
+ * LSMLIB_NUM_THREADS or, if it is not set, the number of online
+ * processors.
+ */
+static int getDefaultNumThreads(void);
+
+/*
+ * getDefaultAffinity() returns the affinity policy specified by
+ * LSMLIB_AFFINITY.
+ */
+static LSM_AffinityPolicy getDefaultAffinity(void);
+
+/*
+ * computeCPUSets() fills lsm_runtime.cpu_sets according to the
+ * affinity policy.  It returns LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED
+ * if pinning is requested but not available.
+ */
+static int computeCPUSets(void);
+
+/*
+ * workerMain() is the main loop of the worker threads.
+ */
+static void *workerMain(void *arg);
+
+/*
+ * executeLoop() executes the share of the loop assigned to thread_num.
+ */
+static void executeLoop(LSM_RuntimeLoop *loop, int thread_num);
+
+/*
+ * startRuntime() and stopRuntime() create and join the worker threads.
+ * They must be called with lsm_runtime_init_mutex held.
+ */
+static int startRuntime(int num_threads, LSM_AffinityPolicy affinity);
+static void stopRuntime(void);
+
+/*
+ * ensureRuntimeInitialized() initializes the runtime from the
+ * environment if it has not already been initialized.
+ */
+static void ensureRuntimeInitialized(void);
+
+
+/*==================== Runtime API Function Definitions ===============*/
+
+int LSM_Runtime_initialize(int num_threads, LSM_AffinityPolicy affinity)
+{
+  int error;
+
+  pthread_mutex_lock(&lsm_runtime_init_mutex);
+  stopRuntime();
+  error = startRuntime(num_threads, affinity);
+  pthread_mutex_unlock(&lsm_runtime_init_mutex);
+
+  return error;
+}
+
+
+void LSM_Runtime_finalize(void)
+{
+  pthread_mutex_lock(&lsm_runtime_init_mutex);
+  stopRuntime();
+  pthread_mutex_unlock(&lsm_runtime_init_mutex);
+}
+
+
+int LSM_Runtime_setNumThreads(int num_threads)
+{
+  LSM_AffinityPolicy affinity;
+
+  pthread_mutex_lock(&lsm_runtime_init_mutex);
+  affinity = atomic_load(&(lsm_runtime.initialized)) ? lsm_runtime.affinity
+                                     : getDefaultAffinity();
+  pthread_mutex_unlock(&lsm_runtime_init_mutex);
+
+  return LSM_Runtime_initialize(num_threads, affinity);
+}
+
+
+int LSM_Runtime_getNumThreads(void)
+{
+  ensureRuntimeInitialized();
+  return lsm_runtime.num_threads;
+}
+
+
+int LSM_Runtime_getThreadNum(void)
+{
+  return lsm_runtime_thread_num;
+}
+
+
+int LSM_Runtime_inParallel(void)
+{
+  return lsm_runtime_in_parallel;
+}
+
+
+int LSM_Runtime_parallelFor(
+  int begin,
+  int end,
+  LSM_ScheduleType schedule,
+  int chunk_size,
+  int max_threads,
+  LSM_ParallelForBodyFuncPtr body,
+  void *user_data)
+{
+  LSM_RuntimeLoop loop;
+  LSM_RuntimeRange *ranges = NULL;
+  int num_iterations = end - begin;
+  int num_threads;
+  int expected_busy = 0;
+  int t;
+
+  if (num_iterations <= 0) return 0;
+
+  /* nested loops are executed serially by the calling thread */
+  if (lsm_runtime_in_parallel) {
+    body(begin, end, lsm_runtime_thread_num, user_data);
+    return 1;
+  }
+
+  ensureRuntimeInitialized();
+
+  num_threads = lsm_runtime.num_threads;
+  if ( (max_threads > 0) && (max_threads < num_threads) ) {
+    num_threads = max_threads;
+  }
+  if (num_threads > num_iterations) num_threads = num_iterations;
+
+  /*
+   * run serially if only one thread is needed or if the pool is busy
+   * with a loop submitted by another application thread
+   */
+  if ( (num_threads <= 1) ||
+       (!atomic_compare_exchange_strong(&(lsm_runtime.busy),
+                                        &expected_busy, 1)) ) {
+    lsm_runtime_in_parallel = 1;
+    lsm_runtime_thread_num = 0;
+    body(begin, end, 0, user_data);
+    lsm_runtime_in_parallel = 0;
+    return 1;
+  }
+
+  /* set up loop */
+  if (chunk_size <= 0) {
+    if (schedule == LSM_SCHEDULE_DYNAMIC) {
+      chunk_size = num_iterations
+                 / (LSM_RUNTIME_DYNAMIC_CHUNKS_PER_THREAD*num_threads);
+      if (chunk_size < 1) chunk_size = 1;
+    } else {
+      chunk_size = 0;
+    }
+  }
+
+  if (schedule == LSM_SCHEDULE_DYNAMIC) {
+    ranges = (LSM_RuntimeRange *)
+      malloc(num_threads*sizeof(LSM_RuntimeRange));
+    if (!ranges) {
+      atomic_store(&(lsm_runtime.busy), 0);
+      lsm_runtime_in_parallel = 1;
+      body(begin, end, 0, user_data);
+      lsm_runtime_in_parallel = 0;
+      return 1;
+    }
+    for (t = 0; t < num_threads; t++) {
+      pthread_mutex_init(&(ranges[t].lock), NULL);
+      ranges[t].next = begin
+        + (int) (((long long) num_iterations*t)/num_threads);
+      ranges[t].end  = begin
+        + (int) (((long long) num_iterations*(t+1))/num_threads);
+    }
+  }
+
+  loop.body = body;
+  loop.user_data = user_data;
+  loop.begin = begin;
+  loop.end = end;
+  loop.chunk_size = chunk_size;
+  loop.num_threads = num_threads;
+  loop.schedule = schedule;
+  loop.ranges = ranges;
+
+  /* wake up workers */
+  pthread_mutex_lock(&(lsm_runtime.mutex));
+  lsm_runtime.loop = &loop;
+  lsm_runtime.num_remaining = lsm_runtime.num_threads - 1;
+  lsm_runtime.generation++;
+  pthread_cond_broadcast(&(lsm_runtime.start_cond));
+  pthread_mutex_unlock(&(lsm_runtime.mutex));
+
+  /* calling thread participates as thread 0 */
+  executeLoop(&loop, 0);
+
+  /* wait for workers to finish */
+  pthread_mutex_lock(&(lsm_runtime.mutex));
+  while (lsm_runtime.num_remaining > 0) {
+    pthread_cond_wait(&(lsm_runtime.done_cond), &(lsm_runtime.mutex));
+  }
+  lsm_runtime.loop = NULL;
+  pthread_mutex_unlock(&(lsm_runtime.mutex));
+
+  if (ranges) {
+    for (t = 0; t < num_threads; t++) {
+      pthread_mutex_destroy(&(ranges[t].lock));
+    }
+    free(ranges);
+  }
+
+  atomic_store(&(lsm_runtime.busy), 0);
+
+  return num_threads;
+}
+
+
+/*=============== Runtime Helper Function Definitions ===============*/
+
+static int getDefaultNumThreads(void)
+{
+  char *env = getenv("LSMLIB_NUM_THREADS");
+  long num_threads;
+
+  if (env) {
+    num_threads = strtol(env, NULL, 10);
+    if (num_threads > 0) return (int) num_threads;
+  }
+
+  num_threads = sysconf(_SC_NPROCESSORS_ONLN);
+  return (num_threads > 0) ? (int) num_threads : 1;
+}
+
+
+static LSM_AffinityPolicy getDefaultAffinity(void)
+{
+  char *env = getenv("LSMLIB_AFFINITY");
+
+  if (!env) return LSM_AFFINITY_NONE;
+  if (!strcmp(env, "compact")) return LSM_AFFINITY_COMPACT;
+  if (!strcmp(env, "scatter")) return LSM_AFFINITY_SCATTER;
+  if (!strcmp(env, "numa")) return LSM_AFFINITY_NUMA;
+  return LSM_AFFINITY_NONE;
+}
+
+
+static void ensureRuntimeInitialized(void)
+{
+  if (atomic_load(&(lsm_runtime.initialized))) return;
+
+  pthread_mutex_lock(&lsm_runtime_init_mutex);
+  if (!atomic_load(&(lsm_runtime.initialized))) {
+    startRuntime(0, getDefaultAffinity());
+  }
+  pthread_mutex_unlock(&lsm_runtime_init_mutex);
+}
+
+
+#ifdef __linux__
+/*
+ * readCPUList() parses a Linux CPU list (e.g. "0-3,8-11") into a CPU set.
+ */
+static int readCPUList(const char *file_name, cpu_set_t *cpu_set)
+{
+  FILE *fp = fopen(file_name, "r");
+  int first, last, cpu;
+  char sep;
+
+  CPU_ZERO(cpu_set);
+  if (!fp) return 0;
+
+  while (fscanf(fp, "%d", &first) == 1) {
+    last = first;
+    sep = (char) fgetc(fp);
+    if (sep == '-') {
+      if (fscanf(fp, "%d", &last) != 1) break;
+      sep = (char) fgetc(fp);
+    }
+    for (cpu = first; (cpu <= last) && (cpu < CPU_SETSIZE); cpu++) {
+      CPU_SET(cpu, cpu_set);
+    }
+    if (sep != ',') break;
+  }
+
+  fclose(fp);
+  return CPU_COUNT(cpu_set);
+}
+#endif
+
+
+static int computeCPUSets(void)
+{
+#ifdef __linux__
+  cpu_set_t allowed;
+  cpu_set_t nodes[LSM_RUNTIME_MAX_NUMA_NODES];
+  int *node_cpus;
+  int num_node_cpus[LSM_RUNTIME_MAX_NUMA_NODES];
+  int *cpus;
+  int num_cpus = 0;
+  int num_nodes = 0;
+  int num_threads = lsm_runtime.num_threads;
+  int n, t, cpu;
+
+  lsm_runtime.cpu_sets = (cpu_set_t *) calloc(num_threads, sizeof(cpu_set_t));
+  if (!lsm_runtime.cpu_sets) return LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED;
+  if (lsm_runtime.affinity == LSM_AFFINITY_NONE) {
+    return LSM_RUNTIME_ERR_SUCCESS;
+  }
+
+  /* CPUs the process is allowed to run on */
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &allowed)) {
+    return LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED;
+  }
+
+  /* NUMA nodes (restricted to allowed CPUs) */
+  for (n = 0; n < LSM_RUNTIME_MAX_NUMA_NODES; n++) {
+    char file_name[128];
+    sprintf(file_name, "/sys/devices/system/node/node%d/cpulist", n);
+    if (!readCPUList(file_name, &(nodes[num_nodes]))) {
+      if (access(file_name, F_OK)) break;
+      continue;
+    }
+    CPU_AND(&(nodes[num_nodes]), &(nodes[num_nodes]), &allowed);
+    if (CPU_COUNT(&(nodes[num_nodes])) > 0) num_nodes++;
+  }
+  if (num_nodes == 0) {
+    nodes[0] = allowed;
+    num_nodes = 1;
+  }
+
+  /* list of allowed CPUs per node (node n starts at n*CPU_SETSIZE) */
+  node_cpus = (int *) malloc(num_nodes*CPU_SETSIZE*sizeof(int));
+  if (!node_cpus) return LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED;
+  for (n = 0; n < num_nodes; n++) {
+    num_node_cpus[n] = 0;
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &(nodes[n]))) {
+        node_cpus[n*CPU_SETSIZE + num_node_cpus[n]++] = cpu;
+      }
+    }
+  }
+
+  /* ordered CPU list for the compact and scatter policies */
+  cpus = (int *) malloc(CPU_SETSIZE*sizeof(int));
+  if (!cpus) {
+    free(node_cpus);
+    return LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED;
+  }
+  if (lsm_runtime.affinity == LSM_AFFINITY_SCATTER) {
+    int k, more = 1;
+    for (k = 0; more; k++) {
+      more = 0;
+      for (n = 0; n < num_nodes; n++) {
+        if (k < num_node_cpus[n]) {
+          cpus[num_cpus++] = node_cpus[n*CPU_SETSIZE + k];
+          more = 1;
+        }
+      }
+    }
+  } else {
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed)) cpus[num_cpus++] = cpu;
+    }
+  }
+
+  /* assign a CPU set to each thread */
+  for (t = 0; t < num_threads; t++) {
+    CPU_ZERO(&(lsm_runtime.cpu_sets[t]));
+    if (lsm_runtime.affinity == LSM_AFFINITY_NUMA) {
+      lsm_runtime.cpu_sets[t] = nodes[t % num_nodes];
+    } else if (num_cpus > 0) {
+      CPU_SET(cpus[t % num_cpus], &(lsm_runtime.cpu_sets[t]));
+    }
+  }
+
+  free(cpus);
+  free(node_cpus);
+  return LSM_RUNTIME_ERR_SUCCESS;
+#else
+  return (lsm_runtime.affinity == LSM_AFFINITY_NONE) ?
+    LSM_RUNTIME_ERR_SUCCESS : LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED;
+#endif
+}
+
+
+static int startRuntime(int num_threads, LSM_AffinityPolicy affinity)
+{
+  int error = LSM_RUNTIME_ERR_SUCCESS;
+  int t;
+
+  if (num_threads <= 0) num_threads = getDefaultNumThreads();
+  if (num_threads > LSM_RUNTIME_MAX_THREADS) {
+    num_threads = LSM_RUNTIME_MAX_THREADS;
+  }
+
+  lsm_runtime.num_threads = num_threads;
+  lsm_runtime.affinity = affinity;
+  lsm_runtime.shutdown = 0;
+  lsm_runtime.loop = NULL;
+  atomic_store(&(lsm_runtime.busy), 0);
+
+  error = computeCPUSets();
+
+  /*
+   * workers start from the current generation so that a loop submitted
+   * before a worker begins executing is not missed
+   */
+  lsm_runtime.start_generation = lsm_runtime.generation;
+
+  /* create worker threads (thread 0 is the calling thread) */
+  lsm_runtime.workers = (pthread_t *) malloc(num_threads*sizeof(pthread_t));
+  if (!lsm_runtime.workers) {
+    lsm_runtime.num_threads = 1;
+    atomic_store(&(lsm_runtime.initialized), 1);
+    return LSM_RUNTIME_ERR_THREAD_CREATION;
+  }
+  for (t = 1; t < num_threads; t++) {
+    if (pthread_create(&(lsm_runtime.workers[t]), NULL, workerMain,
+                       (void *) (intptr_t) t)) {
+      /* run with the threads that were successfully created */
+      lsm_runtime.num_threads = t;
+      error = LSM_RUNTIME_ERR_THREAD_CREATION;
+      break;
+    }
+  }
+
+  atomic_store(&(lsm_runtime.initialized), 1);
+  return error;
+}
+
+
+static void stopRuntime(void)
+{
+  int t;
+
+  if (!atomic_load(&(lsm_runtime.initialized))) return;
+
+  pthread_mutex_lock(&(lsm_runtime.mutex));
+  lsm_runtime.shutdown = 1;
+  pthread_cond_broadcast(&(lsm_runtime.start_cond));
+  pthread_mutex_unlock(&(lsm_runtime.mutex));
+
+  for (t = 1; t < lsm_runtime.num_threads; t++) {
+    pthread_join(lsm_runtime.workers[t], NULL);
+  }
+
+  free(lsm_runtime.workers);
+  lsm_runtime.workers = NULL;
+#ifdef __linux__
+  free(lsm_runtime.cpu_sets);
+  lsm_runtime.cpu_sets = NULL;
+#endif
+  lsm_runtime.num_threads = 0;
+  atomic_store(&(lsm_runtime.initialized), 0);
+}
+
+
+static void *workerMain(void *arg)
+{
+  int thread_num = (int) (intptr_t) arg;
+  unsigned long generation_seen;
+  LSM_RuntimeLoop *loop;
+
+#ifdef __linux__
+  if ( (lsm_runtime.cpu_sets) &&
+       (CPU_COUNT(&(lsm_runtime.cpu_sets[thread_num])) > 0) ) {
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                           &(lsm_runtime.cpu_sets[thread_num]));
+  }
+#endif
+
+  pthread_mutex_lock(&(lsm_runtime.mutex));
+  generation_seen = lsm_runtime.start_generation;
+  while (1) {
+
+    while ( (lsm_runtime.generation == generation_seen)
+         && (!lsm_runtime.shutdown) ) {
+      pthread_cond_wait(&(lsm_runtime.start_cond), &(lsm_runtime.mutex));
+    }
+    if (lsm_runtime.shutdown) break;
+
+    generation_seen = lsm_runtime.generation;
+    loop = lsm_runtime.loop;
+    pthread_mutex_unlock(&(lsm_runtime.mutex));
+
+    if (thread_num < loop->num_threads) executeLoop(loop, thread_num);
+
+    pthread_mutex_lock(&(lsm_runtime.mutex));
+    if (--lsm_runtime.num_remaining == 0) {
+      pthread_cond_signal(&(lsm_runtime.done_cond));
+    }
+  }
+  pthread_mutex_unlock(&(lsm_runtime.mutex));
+
+  return NULL;
+}
+
+
+static void executeLoop(LSM_RuntimeLoop *loop, int thread_num)
+{
+  int num_threads = loop->num_threads;
+  int chunk_size = loop->chunk_size;
+  int num_iterations = loop->end - loop->begin;
+
+  lsm_runtime_in_parallel = 1;
+  lsm_runtime_thread_num = thread_num;
+
+  if (loop->schedule == LSM_SCHEDULE_STATIC) {
+
+    if (chunk_size <= 0) {
+      /* one contiguous block per thread */
+      int begin = loop->begin
+        + (int) (((long long) num_iterations*thread_num)/num_threads);
+      int end = loop->begin
+        + (int) (((long long) num_iterations*(thread_num+1))/num_threads);
+      if (end > begin) loop->body(begin, end, thread_num, loop->user_data);
+    } else {
+      /* round-robin chunks */
+      long long begin;
+      for (begin = loop->begin + (long long) thread_num*chunk_size;
+           begin < loop->end;
+           begin += (long long) num_threads*chunk_size) {
+        int end = (begin + chunk_size < loop->end) ?
+                  (int) (begin + chunk_size) : loop->end;
+        loop->body((int) begin, end, thread_num, loop->user_data);
+      }
+    }
+
+  } else {
+
+    /* dynamic schedule with work stealing */
+    LSM_RuntimeRange *own = &(loop->ranges[thread_num]);
+    while (1) {
+      int begin, end, victim;
+
+      /* take a chunk from the bottom of the own range */
+      pthread_mutex_lock(&(own->lock));
+      begin = own->next;
+      end = (own->end - begin > chunk_size) ? begin + chunk_size : own->end;
+      own->next = end;
+      pthread_mutex_unlock(&(own->lock));
+
+      if (end > begin) {
+        loop->body(begin, end, thread_num, loop->user_data);
+        continue;
+      }
+
+      /* own range is empty:  steal half of another thread's range */
+      for (victim = (thread_num+1) % num_threads; victim != thread_num;
+           victim = (victim+1) % num_threads) {
+        LSM_RuntimeRange *other = &(loop->ranges[victim]);
+        int remaining;
+
+        pthread_mutex_lock(&(other->lock));
+        remaining = other->end - other->next;
+        if (remaining > 0) {
+          begin = (remaining > chunk_size) ? other->next + remaining/2
+                                           : other->next;
+          end = other->end;
+          other->end = begin;
+        }
+        pthread_mutex_unlock(&(other->lock));
+
+        if (remaining > 0) break;
+      }
+      if (victim == thread_num) break;    /* no work left anywhere */
+
+      pthread_mutex_lock(&(own->lock));
+      own->next = begin;
+      own->end = end;
+      pthread_mutex_unlock(&(own->lock));
+    }
+
+  }
+
+  lsm_runtime_in_parallel = 0;
+  lsm_runtime_thread_num = 0;
+}
@@ -0,0 +1,261 @@
+/*
+ * File:        lsm_runtime.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for the LSMLIB thread pool runtime
+ */
+
+#ifndef included_lsm_runtime_h
+#define included_lsm_runtime_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_runtime.h
+ *
+ * \brief
+ * @ref lsm_runtime.h provides the thread pool shared by all threaded
+ * LSMLIB subsystems.  Modules never create their own threads; they
+ * submit loops to the runtime using LSM_Runtime_parallelFor().
+ *
+ * The runtime consists of a single, lazily created pool of worker
+ * threads.  The thread that calls LSM_Runtime_parallelFor() always
+ * participates in the loop as thread 0.  Loop iterations are
+ * distributed either statically (fixed contiguous blocks or
+ * round-robin chunks) or dynamically (each thread starts with a
+ * contiguous block and idle threads steal half of the remaining
+ * iterations of another thread).
+ *
+ * <h3> Cooperation with application threading </h3>
+ *
+ * To avoid oversubscription when LSMLIB is used inside a larger
+ * threaded application:
+ *
+ * - A parallel loop started from inside another parallel loop
+ *   (nested parallelism) is executed serially by the calling thread.
+ *
+ * - If the pool is already executing a loop submitted by a different
+ *   application thread, the new loop is executed serially by the
+ *   calling thread rather than waiting for (or competing with) the
+ *   busy pool.
+ *
+ * - Applications that manage their own threads can call
+ *   LSM_Runtime_setNumThreads(1) to make all LSMLIB kernels serial.
+ *
+ * <h3> Configuration </h3>
+ *
+ * The runtime is configured by LSM_Runtime_initialize() or, if that
+ * function is not called, from the environment when the first loop is
+ * submitted:
+ *
+ * - LSMLIB_NUM_THREADS:  number of threads (default:  number of online
+ *   processors)
+ * - LSMLIB_AFFINITY:  one of "none" (default), "compact", "scatter"
+ *   or "numa"
+ *
+ */
+
+
+/*!
+ * Error codes returned by runtime functions.
+ */
+#define LSM_RUNTIME_ERR_SUCCESS                     (0)
+#define LSM_RUNTIME_ERR_INVALID_ARGUMENT            (1)
+#define LSM_RUNTIME_ERR_THREAD_CREATION             (2)
+#define LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED      (3)
+
+/*!
+ * Maximum number of threads supported by the runtime.
+ */
+#define LSM_RUNTIME_MAX_THREADS                     (1024)
+
+/*!
+ * LSM_AffinityPolicy determines how worker threads are pinned to CPUs.
+ *
+ * - LSM_AFFINITY_NONE:     threads are not pinned
+ * - LSM_AFFINITY_COMPACT:  thread t is pinned to the t-th allowed CPU
+ * - LSM_AFFINITY_SCATTER:  consecutive threads are pinned to CPUs on
+ *                          different NUMA nodes (round-robin over nodes)
+ * - LSM_AFFINITY_NUMA:     threads are distributed round-robin over NUMA
+ *                          nodes and pinned to all CPUs of their node
+ */
+typedef enum {
+  LSM_AFFINITY_NONE,
+  LSM_AFFINITY_COMPACT,
+  LSM_AFFINITY_SCATTER,
+  LSM_AFFINITY_NUMA
+} LSM_AffinityPolicy;
+
+/*!
+ * LSM_ScheduleType determines how loop iterations are distributed.
+ *
+ * - LSM_SCHEDULE_STATIC:   iterations are divided into one contiguous
+ *                          block per thread (chunk_size <= 0) or into
+ *                          chunks of chunk_size iterations that are
+ *                          assigned round-robin
+ * - LSM_SCHEDULE_DYNAMIC:  each thread begins with a contiguous block and
+ *                          takes chunk_size iterations at a time; idle
+ *                          threads steal half of the remaining
+ *                          iterations from other threads
+ */
+typedef enum {
+  LSM_SCHEDULE_STATIC,
+  LSM_SCHEDULE_DYNAMIC
+} LSM_ScheduleType;
+
+/*!
+ * LSM_ParallelForBodyFuncPtr is the loop body executed by
+ * LSM_Runtime_parallelFor().
+ *
+ * Arguments:
+ *  - begin (in):       first iteration of the range to execute
+ *  - end (in):         one past the last iteration of the range
+ *  - thread_num (in):  number of the executing thread
+ *                      (0 <= thread_num < LSM_Runtime_getNumThreads())
+ *  - user_data (in):   pointer passed through from
+ *                      LSM_Runtime_parallelFor()
+ *
+ * Return value:        none
+ *
+ * NOTES:
+ *  - The body may be called several times by the same thread (with
+ *    different ranges).
+ *
+ */
+typedef void (*LSM_ParallelForBodyFuncPtr)(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data);
+
+
+/*!
+ * LSM_Runtime_initialize() creates the thread pool.
+ *
+ * Arguments:
+ *  - num_threads (in):  number of threads (including the calling thread);
+ *                       if num_threads <= 0, LSMLIB_NUM_THREADS or the
+ *                       number of online processors is used
+ *  - affinity (in):     CPU affinity policy for the worker threads
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - If the runtime is already initialized, it is finalized and then
+ *    reinitialized with the new configuration.
+ *
+ *  - If the requested affinity policy is not supported on the platform,
+ *    the pool is still created (without pinning) and
+ *    LSM_RUNTIME_ERR_AFFINITY_NOT_SUPPORTED is returned.
+ *
+ *  - Must not be called while a parallel loop is executing.
+ *
+ */
+int LSM_Runtime_initialize(int num_threads, LSM_AffinityPolicy affinity);
+
+/*!
+ * LSM_Runtime_finalize() stops and joins all worker threads.
+ *
+ * Arguments:     none
+ *
+ * Return value:  none
+ *
+ */
+void LSM_Runtime_finalize(void);
+
+/*!
+ * LSM_Runtime_setNumThreads() changes the number of threads used by
+ * subsequent parallel loops (the current affinity policy is retained).
+ *
+ * Arguments:
+ *  - num_threads (in):  number of threads (see LSM_Runtime_initialize())
+ *
+ * Return value:         error code
+ *
+ */
+int LSM_Runtime_setNumThreads(int num_threads);
+
+/*!
+ * LSM_Runtime_getNumThreads() returns the number of threads in the pool
+ * (initializing the runtime from the environment if necessary).
+ *
+ * Arguments:     none
+ *
+ * Return value:  number of threads
+ *
+ */
+int LSM_Runtime_getNumThreads(void);
+
+/*!
+ * LSM_Runtime_getThreadNum() returns the number of the calling thread
+ * within the currently executing parallel loop.
+ *
+ * Arguments:     none
+ *
+ * Return value:  thread number (0 outside of parallel loops)
+ *
+ */
+int LSM_Runtime_getThreadNum(void);
+
+/*!
+ * LSM_Runtime_inParallel() determines whether the calling thread is
+ * executing the body of a parallel loop.
+ *
+ * Arguments:     none
+ *
+ * Return value:  true (1) if inside a parallel loop; false (0) otherwise
+ *
+ */
+int LSM_Runtime_inParallel(void);
+
+/*!
+ * LSM_Runtime_parallelFor() executes a loop over the iterations
+ * [begin, end) using the thread pool.
+ *
+ * Arguments:
+ *  - begin (in):        first iteration
+ *  - end (in):          one past the last iteration
+ *  - schedule (in):     loop schedule (see LSM_ScheduleType)
+ *  - chunk_size (in):   number of iterations per chunk; if chunk_size <= 0,
+ *                       a default is used
+ *  - max_threads (in):  maximum number of threads to use; if
+ *                       max_threads <= 0, all threads in the pool are used
+ *  - body (in):         loop body
+ *  - user_data (in):    pointer passed through to body
+ *
+ * Return value:         number of threads that executed the loop
+ *
+ * NOTES:
+ *  - The function returns after all iterations have been executed.
+ *
+ *  - Thread numbers passed to body are always less than
+ *    LSM_Runtime_getNumThreads(), so per-thread data may be indexed by 
+ *    thread number.
+ *
+ *  - Nested calls are executed serially by the calling thread, which
+ *    keeps its thread number from the enclosing loop.  Calls made while
+ *    the pool is busy with a loop submitted by another application 
+ *    thread are executed serially by the calling thread as thread 0.
+ *
+ */
+int LSM_Runtime_parallelFor(
+  int begin,
+  int end,
+  LSM_ScheduleType schedule,
+  int chunk_size,
+  int max_threads,
+  LSM_ParallelForBodyFuncPtr body,
+  void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,654 @@
+/*
+ * File:        lsm_strided_view.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for kernels operating on strided views
+ *              of unpadded (interior-only) data
+ */
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "lsmlib_config.h"
+#include "lsm_strided_view.h"
+#include "lsm_autotune.h"
+#include "lsm_runtime.h"
+#include "lsm_spatial_derivatives3d.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Kernels that can be applied tile by tile.
+ */
+typedef enum {
+  LSM_VIEW_KERNEL_HJ_ENO1,
+  LSM_VIEW_KERNEL_HJ_ENO2,
+  LSM_VIEW_KERNEL_HJ_ENO3,
+  LSM_VIEW_KERNEL_HJ_WENO5,
+  LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER2,
+  LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER4
+} LSM_ViewKernelType;
+
+/*
+ * Structure 'LSM_ViewTileTask' is shared by all threads processing the
+ * tiles of a kernel.
+ */
+typedef struct _LSM_ViewTileTask
+{
+  LSM_ViewKernelType        kernel;
+  int                       num_ghostcells;
+  int                       num_outputs;
+  const LSM_StridedView3d  *outputs[6];
+  const LSM_StridedView3d  *phi;
+  const LSM_ViewBoundary3d *bdry;
+  LSMLIB_REAL               dx[3];
+  int                       tile_dims[3];
+  int                       num_tiles[3];
+  atomic_int                error;
+} LSM_ViewTileTask;
+
+/*
+ * Structure 'LSM_ViewRKTask' holds the arguments of a TVD Runge-Kutta
+ * stage.
+ */
+typedef struct _LSM_ViewRKTask
+{
+  int                       rk_order;
+  int                       stage;
+  const LSM_StridedView3d  *u_next;
+  const LSM_StridedView3d  *u_stage;
+  const LSM_StridedView3d  *u_cur;
+  const LSM_StridedView3d  *rhs;
+  LSMLIB_REAL               dt;
+} LSM_ViewRKTask;
+
+
+#define LSM_VIEW_VALUE(view, i, j, k)                                    \
+  ((view)->data[(i)*(view)->strides[0] + (j)*(view)->strides[1]          \
+              + (k)*(view)->strides[2]])
+
+
+/*
+ * viewsHaveSameDims() returns 1 if both views are valid and have the
+ * same dims.
+ */
+static int viewsHaveSameDims(
+  const LSM_StridedView3d *a,
+  const LSM_StridedView3d *b)
+{
+  return ( a && b && a->data && b->data
+        && (a->dims[0] == b->dims[0]) && (a->dims[1] == b->dims[1])
+        && (a->dims[2] == b->dims[2]) );
+}
+
+
+/*
+ * getBoundaryValue3d() returns the value of phi at the index (i,j,k),
+ * which lies outside of the domain in direction dir only.
+ */
+static LSMLIB_REAL getBoundaryValue3d(
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  int dir,
+  int idx[3])
+{
+  int n = phi->dims[dir];
+  int side = (idx[dir] < 0) ? 0 : 1;
+  int face = 2*dir + side;
+  int dist = side ? idx[dir] - (n-1) : -idx[dir];
+  int inner[3];
+  LSMLIB_REAL v0, v1;
+
+  inner[0] = idx[0]; inner[1] = idx[1]; inner[2] = idx[2];
+
+  switch (bdry->type[face]) {
+    case LSM_VIEW_BC_PERIODIC:
+      inner[dir] = ((idx[dir] % n) + n) % n;
+      return LSM_VIEW_VALUE(phi, inner[0], inner[1], inner[2]);
+
+    case LSM_VIEW_BC_HALO:
+      if ( (bdry->halo[face]) && (dist <= bdry->halo_width) ) {
+        int w = bdry->halo_width;
+        int h = side ? dist - 1 : w - dist;  /* position in halo layer */
+        size_t offset;
+        if (dir == 0) {
+          offset = h + (size_t) w*(idx[1] + (size_t) phi->dims[1]*idx[2]);
+        } else if (dir == 1) {
+          offset = idx[0] + (size_t) phi->dims[0]*(h + (size_t) w*idx[2]);
+        } else {
+          offset = idx[0] + (size_t) phi->dims[0]*(idx[1]
+                 + (size_t) phi->dims[1]*h);
+        }
+        return bdry->halo[face][offset];
+      }
+      /* missing halo values are copied from the boundary */
+      inner[dir] = side ? n-1 : 0;
+      return LSM_VIEW_VALUE(phi, inner[0], inner[1], inner[2]);
+
+    case LSM_VIEW_BC_LINEAR_EXTRAPOLATION:
+      inner[dir] = side ? n-1 : 0;
+      v0 = LSM_VIEW_VALUE(phi, inner[0], inner[1], inner[2]);
+      if (n < 2) return v0;
+      inner[dir] = side ? n-2 : 1;
+      v1 = LSM_VIEW_VALUE(phi, inner[0], inner[1], inner[2]);
+      return v0 + dist*(v0 - v1);
+
+    case LSM_VIEW_BC_COPY_EXTRAPOLATION:
+    default:
+      inner[dir] = side ? n-1 : 0;
+      return LSM_VIEW_VALUE(phi, inner[0], inner[1], inner[2]);
+  }
+}
+
+
+/*
+ * gatherTile3d() copies phi on the tile [lo, lo+n) plus num_ghostcells
+ * ghostcells into the contiguous buffer.
+ */
+static void gatherTile3d(
+  LSMLIB_REAL *buffer,
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  const int lo[3],
+  const int n[3],
+  int num_ghostcells)
+{
+  int g = num_ghostcells;
+  int idx[3];
+  int i, j, k, l;
+
+  for (k = lo[2]-g; k < lo[2]+n[2]+g; k++) {
+    for (j = lo[1]-g; j < lo[1]+n[1]+g; j++) {
+      for (i = lo[0]-g; i < lo[0]+n[0]+g; i++) {
+        int num_out = 0, out_dir = 0;
+
+        idx[0] = i; idx[1] = j; idx[2] = k;
+        for (l = 0; l < 3; l++) {
+          if ( (idx[l] < 0) || (idx[l] >= phi->dims[l]) ) {
+            num_out++;
+            out_dir = l;
+          }
+        }
+
+        if (num_out == 0) {
+          *buffer = LSM_VIEW_VALUE(phi, i, j, k);
+        } else if (num_out == 1) {
+          *buffer = getBoundaryValue3d(phi, bdry, out_dir, idx);
+        } else {
+          /* edges and corners are not used by the kernels; */
+          /* fill them with the nearest (or periodic) value  */
+          for (l = 0; l < 3; l++) {
+            int m = phi->dims[l];
+            if (bdry->type[2*l] == LSM_VIEW_BC_PERIODIC) {
+              idx[l] = ((idx[l] % m) + m) % m;
+            } else if (idx[l] < 0) {
+              idx[l] = 0;
+            } else if (idx[l] >= m) {
+              idx[l] = m-1;
+            }
+          }
+          *buffer = LSM_VIEW_VALUE(phi, idx[0], idx[1], idx[2]);
+        }
+        buffer++;
+      }
+    }
+  }
+}
+
+
+/*
+ * scatterTile3d() copies a contiguous tile-sized buffer into a view.
+ */
+static void scatterTile3d(
+  const LSM_StridedView3d *view,
+  const LSMLIB_REAL *buffer,
+  const int lo[3],
+  const int n[3])
+{
+  int i, j, k;
+
+  for (k = 0; k < n[2]; k++) {
+    for (j = 0; j < n[1]; j++) {
+      LSMLIB_REAL *dst = &LSM_VIEW_VALUE(view, lo[0], lo[1]+j, lo[2]+k);
+      ptrdiff_t s = view->strides[0];
+      for (i = 0; i < n[0]; i++) dst[i*s] = buffer[i];
+      buffer += n[0];
+    }
+  }
+}
+
+
+/*
+ * applyKernelToTile3d() applies the Fortran kernel to the gathered
+ * tile.  The tile is indexed from 0 to n-1 (fillbox) and the ghostbox
+ * extends num_ghostcells beyond it; outputs only cover the fillbox.
+ */
+static void applyKernelToTile3d(
+  LSM_ViewTileTask *task,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *D[3],
+  LSMLIB_REAL *out[6],
+  const int n[3])
+{
+  int g = task->num_ghostcells;
+  int ilo_gb = -g, ihi_gb = n[0]-1+g;
+  int jlo_gb = -g, jhi_gb = n[1]-1+g;
+  int klo_gb = -g, khi_gb = n[2]-1+g;
+  int ilo_fb = 0, ihi_fb = n[0]-1;
+  int jlo_fb = 0, jhi_fb = n[1]-1;
+  int klo_fb = 0, khi_fb = n[2]-1;
+  LSMLIB_REAL *dx = &(task->dx[0]), *dy = &(task->dx[1]);
+  LSMLIB_REAL *dz = &(task->dx[2]);
+
+  switch (task->kernel) {
+    case LSM_VIEW_KERNEL_HJ_ENO1:
+      LSM3D_HJ_ENO1(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        out[3], out[4], out[5],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[0], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+
+    case LSM_VIEW_KERNEL_HJ_ENO2:
+      LSM3D_HJ_ENO2(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        out[3], out[4], out[5],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[0], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[1], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+
+    case LSM_VIEW_KERNEL_HJ_ENO3:
+      LSM3D_HJ_ENO3(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        out[3], out[4], out[5],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[0], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[1], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[2], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+
+    case LSM_VIEW_KERNEL_HJ_WENO5:
+      LSM3D_HJ_WENO5(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        out[3], out[4], out[5],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        D[0], &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+
+    case LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER2:
+      LSM3D_CENTRAL_GRAD_ORDER2(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+
+    case LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER4:
+      LSM3D_CENTRAL_GRAD_ORDER4(out[0], out[1], out[2],
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        phi, &ilo_gb, &ihi_gb, &jlo_gb, &jhi_gb, &klo_gb, &khi_gb,
+        &ilo_fb, &ihi_fb, &jlo_fb, &jhi_fb, &klo_fb, &khi_fb,
+        dx, dy, dz);
+      break;
+  }
+}
+
+
+/*
+ * processTiles3d() is the LSM_Runtime_parallelFor() body that processes
+ * the tiles in [begin, end).  The tile buffers are allocated once per
+ * call and reused for all tiles of the range.
+ */
+static void processTiles3d(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_ViewTileTask *task = (LSM_ViewTileTask *) user_data;
+  int g = task->num_ghostcells;
+  size_t tile_size = (size_t) task->tile_dims[0]*task->tile_dims[1]
+                   * task->tile_dims[2];
+  size_t ghost_size = (size_t) (task->tile_dims[0]+2*g)
+                    * (task->tile_dims[1]+2*g) * (task->tile_dims[2]+2*g);
+  LSMLIB_REAL *buffer, *phi, *D[3], *out[6];
+  int t, l;
+
+  (void) thread_num;
+
+  buffer = (LSMLIB_REAL *) malloc(
+    (4*ghost_size + task->num_outputs*tile_size)*sizeof(LSMLIB_REAL));
+  if (!buffer) {
+    atomic_store(&(task->error), LSM_VIEW_ERR_MEMORY_ALLOCATION);
+    return;
+  }
+  phi = buffer;
+  for (l = 0; l < 3; l++) D[l] = buffer + (l+1)*ghost_size;
+  for (l = 0; l < 6; l++) {
+    out[l] = (l < task->num_outputs) ? buffer + 4*ghost_size + l*tile_size
+                                     : NULL;
+  }
+
+  for (t = begin; t < end; t++) {
+    int tile[3], lo[3], n[3];
+
+    tile[0] = t % task->num_tiles[0];
+    tile[1] = (t / task->num_tiles[0]) % task->num_tiles[1];
+    tile[2] = t / (task->num_tiles[0]*task->num_tiles[1]);
+    for (l = 0; l < 3; l++) {
+      lo[l] = tile[l]*task->tile_dims[l];
+      n[l] = task->phi->dims[l] - lo[l];
+      if (n[l] > task->tile_dims[l]) n[l] = task->tile_dims[l];
+    }
+
+    gatherTile3d(phi, task->phi, task->bdry, lo, n, g);
+    applyKernelToTile3d(task, phi, D, out, n);
+    for (l = 0; l < task->num_outputs; l++) {
+      scatterTile3d(task->outputs[l], out[l], lo, n);
+    }
+  }
+
+  free(buffer);
+}
+
+
+/*
+ * runTiledKernel3d() checks the arguments and applies the kernel to all
+ * tiles.
+ */
+static int runTiledKernel3d(
+  LSM_ViewTileTask *task,
+  const int *tile_dims,
+  int max_threads)
+{
+  LSM_AutotuneConfig config;
+  int l, num_tiles;
+
+  if ( !task->phi || !task->bdry || !task->phi->data ) {
+    return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+  for (l = 0; l < 3; l++) {
+    if (task->phi->dims[l] < 1) return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+  for (l = 0; l < task->num_outputs; l++) {
+    if (!viewsHaveSameDims(task->outputs[l], task->phi)) {
+      return LSM_VIEW_ERR_INVALID_ARGUMENT;
+    }
+  }
+  for (l = 0; l < 6; l++) {
+    LSM_ViewBoundaryType type = task->bdry->type[l];
+    if ( (type < LSM_VIEW_BC_LINEAR_EXTRAPOLATION)
+      || (type > LSM_VIEW_BC_HALO) ) {
+      return LSM_VIEW_ERR_INVALID_ARGUMENT;
+    }
+    if ( (type == LSM_VIEW_BC_PERIODIC)
+      && (task->bdry->type[l^1] != LSM_VIEW_BC_PERIODIC) ) {
+      return LSM_VIEW_ERR_INVALID_ARGUMENT;
+    }
+    if ( (type == LSM_VIEW_BC_HALO)
+      && ( !task->bdry->halo[l]
+        || (task->bdry->halo_width < task->num_ghostcells) ) ) {
+      return LSM_VIEW_ERR_INVALID_ARGUMENT;
+    }
+  }
+
+  /* default parameters are taken from the autotuner */
+  if ( !tile_dims || (max_threads <= 0) ) {
+    LSM_AutotuneKernel tune_kernel = LSM_AUTOTUNE_UPWIND_GRADIENT_3D;
+    int variant = LOW + (task->kernel - LSM_VIEW_KERNEL_HJ_ENO1);
+    if (task->kernel == LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER2) {
+      tune_kernel = LSM_AUTOTUNE_CENTRAL_GRADIENT_3D;
+      variant = 2;
+    } else if (task->kernel == LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER4) {
+      tune_kernel = LSM_AUTOTUNE_CENTRAL_GRADIENT_3D;
+      variant = 4;
+    }
+    LSM_Autotune_getConfig(&config, tune_kernel, variant, task->phi->dims);
+    if (!tile_dims) tile_dims = config.tile_dims;
+    if (max_threads <= 0) max_threads = config.num_threads;
+  }
+
+  num_tiles = 1;
+  for (l = 0; l < 3; l++) {
+    int size = tile_dims[l];
+    if (size < 1) return LSM_VIEW_ERR_INVALID_ARGUMENT;
+    if (size > task->phi->dims[l]) size = task->phi->dims[l];
+    task->tile_dims[l] = size;
+    task->num_tiles[l] = (task->phi->dims[l] + size - 1)/size;
+    num_tiles *= task->num_tiles[l];
+  }
+
+  atomic_init(&(task->error), LSM_VIEW_ERR_SUCCESS);
+  LSM_Runtime_parallelFor(0, num_tiles, LSM_SCHEDULE_DYNAMIC, 1,
+                          max_threads, processTiles3d, task);
+
+  return atomic_load(&(task->error));
+}
+
+
+/*
+ * advanceTVDRKLines3d() is the LSM_Runtime_parallelFor() body for a TVD
+ * Runge-Kutta stage; iterations are (j,k) lines of the domain.
+ */
+static void advanceTVDRKLines3d(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_ViewRKTask *task = (LSM_ViewRKTask *) user_data;
+  int nx = task->u_cur->dims[0], ny = task->u_cur->dims[1];
+  LSMLIB_REAL dt = task->dt;
+  int line, i;
+
+  (void) thread_num;
+
+  for (line = begin; line < end; line++) {
+    int j = line % ny, k = line / ny;
+    LSMLIB_REAL *u_next = &LSM_VIEW_VALUE(task->u_next, 0, j, k);
+    const LSMLIB_REAL *u_cur = &LSM_VIEW_VALUE(task->u_cur, 0, j, k);
+    const LSMLIB_REAL *rhs = &LSM_VIEW_VALUE(task->rhs, 0, j, k);
+    const LSMLIB_REAL *u_stage = (task->stage > 1) ?
+      &LSM_VIEW_VALUE(task->u_stage, 0, j, k) : NULL;
+    ptrdiff_t s_next = task->u_next->strides[0];
+    ptrdiff_t s_cur = task->u_cur->strides[0];
+    ptrdiff_t s_rhs = task->rhs->strides[0];
+    ptrdiff_t s_stage = (task->stage > 1) ? task->u_stage->strides[0] : 0;
+
+    if (task->stage == 1) {
+      for (i = 0; i < nx; i++) {
+        u_next[i*s_next] = u_cur[i*s_cur] + dt*rhs[i*s_rhs];
+      }
+    } else if (task->rk_order == 2) {
+      for (i = 0; i < nx; i++) {
+        u_next[i*s_next] = 0.5*( u_cur[i*s_cur]
+                               + u_stage[i*s_stage] + dt*rhs[i*s_rhs] );
+      }
+    } else if (task->stage == 2) {
+      for (i = 0; i < nx; i++) {
+        u_next[i*s_next] = 0.75*u_cur[i*s_cur]
+                         + 0.25*(u_stage[i*s_stage] + dt*rhs[i*s_rhs]);
+      }
+    } else {
+      for (i = 0; i < nx; i++) {
+        u_next[i*s_next] = (1.0/3.0)*u_cur[i*s_cur]
+                         + (2.0/3.0)*(u_stage[i*s_stage] + dt*rhs[i*s_rhs]);
+      }
+    }
+  }
+}
+
+
+/*==================== Function Definitions ==========================*/
+
+LSM_StridedView3d makeStridedView3d(
+  LSMLIB_REAL *data,
+  int nx, int ny, int nz,
+  ptrdiff_t sx, ptrdiff_t sy, ptrdiff_t sz)
+{
+  LSM_StridedView3d view;
+
+  view.data = data;
+  view.dims[0] = nx; view.dims[1] = ny; view.dims[2] = nz;
+  view.strides[0] = sx; view.strides[1] = sy; view.strides[2] = sz;
+
+  return view;
+}
+
+
+void setViewBoundary3d(
+  LSM_ViewBoundary3d *bdry,
+  LSM_ViewBoundaryType type,
+  int halo_width)
+{
+  int l;
+
+  if (!bdry) return;
+  for (l = 0; l < 6; l++) {
+    bdry->type[l] = type;
+    bdry->halo[l] = NULL;
+  }
+  bdry->halo_width = halo_width;
+}
+
+
+int computeUpwindGradientStridedView3d(
+  const LSM_StridedView3d *phi_x_plus,
+  const LSM_StridedView3d *phi_y_plus,
+  const LSM_StridedView3d *phi_z_plus,
+  const LSM_StridedView3d *phi_x_minus,
+  const LSM_StridedView3d *phi_y_minus,
+  const LSM_StridedView3d *phi_z_minus,
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy,
+  LSMLIB_REAL dx,
+  LSMLIB_REAL dy,
+  LSMLIB_REAL dz,
+  const int *tile_dims,
+  int max_threads)
+{
+  LSM_ViewTileTask task;
+
+  switch (accuracy) {
+    case LOW:
+      task.kernel = LSM_VIEW_KERNEL_HJ_ENO1;  task.num_ghostcells = 1;
+      break;
+    case MEDIUM:
+      task.kernel = LSM_VIEW_KERNEL_HJ_ENO2;  task.num_ghostcells = 2;
+      break;
+    case HIGH:
+      task.kernel = LSM_VIEW_KERNEL_HJ_ENO3;  task.num_ghostcells = 3;
+      break;
+    case VERY_HIGH:
+      task.kernel = LSM_VIEW_KERNEL_HJ_WENO5; task.num_ghostcells = 3;
+      break;
+    default:
+      return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+
+  task.num_outputs = 6;
+  task.outputs[0] = phi_x_plus;  task.outputs[1] = phi_y_plus;
+  task.outputs[2] = phi_z_plus;  task.outputs[3] = phi_x_minus;
+  task.outputs[4] = phi_y_minus; task.outputs[5] = phi_z_minus;
+  task.phi = phi;
+  task.bdry = bdry;
+  task.dx[0] = dx; task.dx[1] = dy; task.dx[2] = dz;
+
+  return runTiledKernel3d(&task, tile_dims, max_threads);
+}
+
+
+int computeCentralGradientStridedView3d(
+  const LSM_StridedView3d *phi_x,
+  const LSM_StridedView3d *phi_y,
+  const LSM_StridedView3d *phi_z,
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  int order,
+  LSMLIB_REAL dx,
+  LSMLIB_REAL dy,
+  LSMLIB_REAL dz,
+  const int *tile_dims,
+  int max_threads)
+{
+  LSM_ViewTileTask task;
+
+  if (order == 2) {
+    task.kernel = LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER2;
+    task.num_ghostcells = 1;
+  } else if (order == 4) {
+    task.kernel = LSM_VIEW_KERNEL_CENTRAL_GRAD_ORDER4;
+    task.num_ghostcells = 2;
+  } else {
+    return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+
+  task.num_outputs = 3;
+  task.outputs[0] = phi_x; task.outputs[1] = phi_y; task.outputs[2] = phi_z;
+  task.phi = phi;
+  task.bdry = bdry;
+  task.dx[0] = dx; task.dx[1] = dy; task.dx[2] = dz;
+
+  return runTiledKernel3d(&task, tile_dims, max_threads);
+}
+
+
+int advanceTVDRKStridedView3d(
+  int rk_order,
+  int stage,
+  const LSM_StridedView3d *u_next,
+  const LSM_StridedView3d *u_stage,
+  const LSM_StridedView3d *u_cur,
+  const LSM_StridedView3d *rhs,
+  LSMLIB_REAL dt,
+  int max_threads)
+{
+  LSM_ViewRKTask task;
+
+  if ( (rk_order < 1) || (rk_order > 3) || (stage < 1)
+    || (stage > rk_order) ) {
+    return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+  if ( !viewsHaveSameDims(u_next, u_cur) || !viewsHaveSameDims(rhs, u_cur)
+    || ((stage > 1) && !viewsHaveSameDims(u_stage, u_cur)) ) {
+    return LSM_VIEW_ERR_INVALID_ARGUMENT;
+  }
+
+  task.rk_order = rk_order;
+  task.stage = stage;
+  task.u_next = u_next;
+  task.u_stage = u_stage;
+  task.u_cur = u_cur;
+  task.rhs = rhs;
+  task.dt = dt;
+
+  if (max_threads <= 0) {
+    LSM_AutotuneConfig config;
+    LSM_Autotune_getConfig(&config, LSM_AUTOTUNE_TVD_RK_3D, 0, u_cur->dims);
+    max_threads = config.num_threads;
+  }
+
+  LSM_Runtime_parallelFor(0, u_cur->dims[1]*u_cur->dims[2],
+                          LSM_SCHEDULE_STATIC, 0, max_threads,
+                          advanceTVDRKLines3d, &task);
+
+  return LSM_VIEW_ERR_SUCCESS;
+}
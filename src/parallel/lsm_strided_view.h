@@ -0,0 +1,294 @@
+/*
+ * File:        lsm_strided_view.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for kernels operating on strided views of
+ *              unpadded (interior-only) data
+ */
+
+#ifndef included_lsm_strided_view_h
+#define included_lsm_strided_view_h
+
+#include <stddef.h>
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_strided_view.h
+ *
+ * \brief
+ * @ref lsm_strided_view.h provides entry points to the LSMLIB spatial
+ * derivative and TVD Runge-Kutta kernels for data that is NOT stored
+ * in an array padded to the Grid ghostbox, e.g. the arrays of a flow
+ * solver or an image pipeline.
+ *
+ * A LSM_StridedView3d describes the interior values only (no
+ * ghostcells) through a base pointer, the number of values in each
+ * direction and arbitrary element strides, so that sub-arrays, arrays
+ * with padding of a different width and arrays stored in C (row-major)
+ * order can be used in place.
+ *
+ * Kernels that need ghostcells process the domain in tiles.  For each
+ * tile, the values of phi (including a layer of ghostcells) are
+ * gathered into a small contiguous buffer owned by the executing
+ * thread, the standard Fortran kernel is applied to the buffer and the
+ * results are scattered into the output views.  Values outside of the
+ * domain are synthesized on the fly from the boundary condition of the
+ * face (see LSM_ViewBoundary3d) or read from a thin halo buffer.  Only
+ * tile-sized temporary arrays are used, so the two full-grid copies
+ * into and out of a padded array are avoided.  Tiles are distributed
+ * across the threads of the LSMLIB runtime (see @ref lsm_runtime.h).
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Describe the input and output arrays using makeStridedView3d().
+ * -# Set the boundary conditions using setViewBoundary3d() (and, for
+ *    LSM_VIEW_BC_HALO faces, the halo buffers).
+ * -# Call the kernels (e.g. computeUpwindGradientStridedView3d()).
+ *
+ */
+
+
+/*!
+ * Error codes returned by strided view functions.
+ */
+#define LSM_VIEW_ERR_SUCCESS                        (0)
+#define LSM_VIEW_ERR_INVALID_ARGUMENT               (1)
+#define LSM_VIEW_ERR_MEMORY_ALLOCATION              (2)
+
+/*!
+ * Default tile size in each direction.
+ */
+#define LSM_VIEW_DEFAULT_TILE_SIZE                  (32)
+
+
+/*!
+ * Structure 'LSM_StridedView3d' describes a 3D array of interior values.
+ * The value with index (i,j,k) (0 <= i < dims[0], ...) is
+ *
+ *   data[i*strides[0] + j*strides[1] + k*strides[2]]
+ *
+ * Strides are measured in elements and may be negative.
+ */
+typedef struct _LSM_StridedView3d
+{
+  LSMLIB_REAL  *data;
+  int           dims[3];
+  ptrdiff_t     strides[3];
+} LSM_StridedView3d;
+
+/*!
+ * LSM_ViewBoundaryType determines how values outside of a face of the
+ * domain are obtained.
+ *
+ * - LSM_VIEW_BC_LINEAR_EXTRAPOLATION:  linear extrapolation (as in
+ *                                      linearExtrapolationBC())
+ * - LSM_VIEW_BC_COPY_EXTRAPOLATION:    value at the boundary (as in
+ *                                      copyExtrapolationBC())
+ * - LSM_VIEW_BC_PERIODIC:              value at the periodic image (must
+ *                                      be set for both faces of a
+ *                                      direction)
+ * - LSM_VIEW_BC_HALO:                  value from the halo buffer of the
+ *                                      face
+ */
+typedef enum {
+  LSM_VIEW_BC_LINEAR_EXTRAPOLATION = 0,
+  LSM_VIEW_BC_COPY_EXTRAPOLATION   = 1,
+  LSM_VIEW_BC_PERIODIC             = 2,
+  LSM_VIEW_BC_HALO                 = 3
+} LSM_ViewBoundaryType;
+
+/*!
+ * Structure 'LSM_ViewBoundary3d' describes the boundary conditions on
+ * the faces of the domain.  Faces are numbered as the boundary location
+ * indices in @ref lsm_boundary_conditions.h (0 = x_lo, 1 = x_hi,
+ * 2 = y_lo, ..., 5 = z_hi).
+ *
+ * The halo buffer of face 2*dir+side is a contiguous array with
+ * halo_width values in direction dir and the interior number of values
+ * in the other two directions, stored with the x index varying fastest
+ * and the z index slowest.  The halo values are ordered by increasing
+ * index, e.g. for face 0 the first value corresponds to
+ * i = -halo_width and for face 1 to i = dims[0].
+ */
+typedef struct _LSM_ViewBoundary3d
+{
+  LSM_ViewBoundaryType  type[6];
+  int                   halo_width;
+  const LSMLIB_REAL    *halo[6];
+} LSM_ViewBoundary3d;
+
+
+/*!
+ * makeStridedView3d() returns a view of the given array.
+ *
+ * Arguments:
+ *  - data (in):       address of the value with index (0,0,0)
+ *  - nx, ny, nz (in): number of values in each direction
+ *  - sx, sy, sz (in): element strides in each direction
+ *
+ * Return value:       strided view
+ *
+ * NOTES:
+ *  - A contiguous array with the x index varying fastest has strides
+ *    (1, nx, nx*ny); a C array a[nz][ny][nx] is the same, and a C
+ *    array a[nx][ny][nz] has strides (ny*nz, nz, 1).
+ *
+ */
+LSM_StridedView3d makeStridedView3d(
+  LSMLIB_REAL *data,
+  int nx, int ny, int nz,
+  ptrdiff_t sx, ptrdiff_t sy, ptrdiff_t sz);
+
+/*!
+ * setViewBoundary3d() sets all faces to the same boundary condition and
+ * clears the halo buffers.
+ *
+ * Arguments:
+ *  - bdry (out):      boundary description
+ *  - type (in):       boundary condition for all faces
+ *  - halo_width (in): width of the halo buffers (ignored unless
+ *                     LSM_VIEW_BC_HALO faces are used)
+ *
+ * Return value:       none
+ *
+ */
+void setViewBoundary3d(
+  LSM_ViewBoundary3d *bdry,
+  LSM_ViewBoundaryType type,
+  int halo_width);
+
+/*!
+ * computeUpwindGradientStridedView3d() computes the plus and minus HJ
+ * ENO/WENO approximations to grad(phi) using LSM3D_HJ_ENO1,
+ * LSM3D_HJ_ENO2, LSM3D_HJ_ENO3 or LSM3D_HJ_WENO5.
+ *
+ * Arguments:
+ *  - phi_*_plus (out):  views for the plus derivatives
+ *  - phi_*_minus (out): views for the minus derivatives
+ *  - phi (in):          view of phi
+ *  - bdry (in):         boundary conditions
+ *  - accuracy (in):     LOW (HJ ENO1), MEDIUM (HJ ENO2), HIGH (HJ ENO3)
+ *                       or VERY_HIGH (HJ WENO5)
+ *  - dx, dy, dz (in):   grid spacing
+ *  - tile_dims (in):    tile size in each direction (NULL for the
+ *                       autotuned or default tile size)
+ *  - max_threads (in):  maximum number of threads (<= 0 for the
+ *                       autotuned number of threads or all runtime
+ *                       threads)
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - All views must have the same dims.  Output views must not overlap
+ *    each other or phi.
+ *
+ *  - The stencil requires 1 (LOW), 2 (MEDIUM) or 3 (HIGH, VERY_HIGH)
+ *    ghostcells; halo buffers must be at least that wide.
+ *
+ *  - The kernels only use ghostcells along the coordinate directions,
+ *    so no values are needed at the edges and corners of the ghostbox.
+ *
+ *  - Default parameters are looked up with LSM_Autotune_getConfig()
+ *    (see @ref lsm_autotune.h); if the kernel has not been tuned for
+ *    the shape, LSM_VIEW_DEFAULT_TILE_SIZE and all runtime threads are
+ *    used.
+ *
+ */
+int computeUpwindGradientStridedView3d(
+  const LSM_StridedView3d *phi_x_plus,
+  const LSM_StridedView3d *phi_y_plus,
+  const LSM_StridedView3d *phi_z_plus,
+  const LSM_StridedView3d *phi_x_minus,
+  const LSM_StridedView3d *phi_y_minus,
+  const LSM_StridedView3d *phi_z_minus,
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy,
+  LSMLIB_REAL dx,
+  LSMLIB_REAL dy,
+  LSMLIB_REAL dz,
+  const int *tile_dims,
+  int max_threads);
+
+/*!
+ * computeCentralGradientStridedView3d() computes the central difference
+ * approximation to grad(phi) using LSM3D_CENTRAL_GRAD_ORDER2 or
+ * LSM3D_CENTRAL_GRAD_ORDER4.
+ *
+ * Arguments:
+ *  - phi_x, phi_y, phi_z (out):  views for the derivatives
+ *  - phi (in):                   view of phi
+ *  - bdry (in):                  boundary conditions
+ *  - order (in):                 order of accuracy (2 or 4)
+ *  - dx, dy, dz (in):            grid spacing
+ *  - tile_dims (in):             tile size (NULL for the autotuned or
+ *                                default tile size)
+ *  - max_threads (in):           maximum number of threads (<= 0 for
+ *                                the autotuned number of threads)
+ *
+ * Return value:                  error code
+ *
+ * NOTES:
+ *  - The stencil requires order/2 ghostcells.
+ *
+ */
+int computeCentralGradientStridedView3d(
+  const LSM_StridedView3d *phi_x,
+  const LSM_StridedView3d *phi_y,
+  const LSM_StridedView3d *phi_z,
+  const LSM_StridedView3d *phi,
+  const LSM_ViewBoundary3d *bdry,
+  int order,
+  LSMLIB_REAL dx,
+  LSMLIB_REAL dy,
+  LSMLIB_REAL dz,
+  const int *tile_dims,
+  int max_threads);
+
+/*!
+ * advanceTVDRKStridedView3d() carries out a single stage of a TVD
+ * Runge-Kutta time integrator (the same updates as LSM3D_RK1_STEP,
+ * LSM3D_TVD_RK2_STAGE* and LSM3D_TVD_RK3_STAGE*).
+ *
+ * Arguments:
+ *  - rk_order (in):  order of the TVD Runge-Kutta scheme (1, 2 or 3)
+ *  - stage (in):     stage to carry out (1 <= stage <= rk_order)
+ *  - u_next (out):   result of the stage
+ *  - u_stage (in):   result of the previous stage (ignored for stage 1;
+ *                    may be NULL)
+ *  - u_cur (in):     solution at the beginning of the time step
+ *  - rhs (in):       right-hand side evaluated at the previous stage
+ *  - dt (in):        time step
+ *  - max_threads (in):  maximum number of threads (<= 0 for the
+ *                       autotuned number of threads)
+ *
+ * Return value:      error code
+ *
+ * NOTES:
+ *  - u_next may be the same view as u_stage or u_cur.
+ *
+ */
+int advanceTVDRKStridedView3d(
+  int rk_order,
+  int stage,
+  const LSM_StridedView3d *u_next,
+  const LSM_StridedView3d *u_stage,
+  const LSM_StridedView3d *u_cur,
+  const LSM_StridedView3d *rhs,
+  LSMLIB_REAL dt,
+  int max_threads);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
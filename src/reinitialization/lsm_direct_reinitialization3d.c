@@ -0,0 +1,632 @@
+/*
+ * File:        lsm_direct_reinitialization3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of 3D direct geometric reinitialization
+ *              routines
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "lsmlib_config.h"
+#include "lsm_direct_reinitialization3d.h"
+#include "lsm_geometry3d.h"
+#include "lsm_runtime.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Structure 'LSM_DirectReinitArgs' holds the arguments shared by all
+ * threads.
+ */
+typedef struct _LSM_DirectReinitArgs
+{
+  LSMLIB_REAL *distance_function;
+  const LSMLIB_REAL *phi;
+  const Grid *grid;
+  const int *index_x, *index_y, *index_z;
+  int search_radius;
+  LSMLIB_REAL cutoff;
+} LSM_DirectReinitArgs;
+
+
+/*
+ * getMinGridSpacing() returns the smallest grid spacing of the grid.
+ */
+static LSMLIB_REAL getMinGridSpacing(const Grid *grid)
+{
+  LSMLIB_REAL h_min = grid->dx[0];
+  if (grid->dx[1] < h_min) h_min = grid->dx[1];
+  if (grid->dx[2] < h_min) h_min = grid->dx[2];
+  return h_min;
+}
+
+
+/*
+ * computeDirectDistanceAtPoint() computes the signed distance from grid
+ * point (i,j,k) to the zero level set reconstructed in the cells within
+ * the search radius.  Grid points with no zero level set within the
+ * search radius are set to sign(phi)*LSMLIB_REAL_MAX unless the cutoff
+ * does not exceed the searched distance (in which case the cutoff is
+ * the exact result).
+ */
+static LSMLIB_REAL computeDirectDistanceAtPoint(
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  int i, int j, int k,
+  int search_radius,
+  LSMLIB_REAL cutoff)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const LSMLIB_REAL *dx = grid->dx;
+  LSMLIB_REAL phi_cur = phi[i + j*nx + k*nxy];
+  LSMLIB_REAL h_min = getMinGridSpacing(grid);
+  LSMLIB_REAL dist_min = LSMLIB_REAL_MAX;
+  LSMLIB_REAL x[3];
+  int ci_lo, ci_hi, cj_lo, cj_hi, ck_lo, ck_hi;
+  int ci, cj, ck;
+
+  if (phi_cur == 0) return 0.0;
+
+  /* coordinates are measured relative to the grid point */
+  x[0] = 0.0; x[1] = 0.0; x[2] = 0.0;
+
+  /* range of cells (identified by lower corner) to search */
+  ci_lo = i - search_radius;  ci_hi = i + search_radius - 1;
+  cj_lo = j - search_radius;  cj_hi = j + search_radius - 1;
+  ck_lo = k - search_radius;  ck_hi = k + search_radius - 1;
+  if (ci_lo < grid->ilo_gb) ci_lo = grid->ilo_gb;
+  if (cj_lo < grid->jlo_gb) cj_lo = grid->jlo_gb;
+  if (ck_lo < grid->klo_gb) ck_lo = grid->klo_gb;
+  if (ci_hi > grid->ihi_gb - 1) ci_hi = grid->ihi_gb - 1;
+  if (cj_hi > grid->jhi_gb - 1) cj_hi = grid->jhi_gb - 1;
+  if (ck_hi > grid->khi_gb - 1) ck_hi = grid->khi_gb - 1;
+
+  for (ck = ck_lo; ck <= ck_hi; ck++) {
+    for (cj = cj_lo; cj <= cj_hi; cj++) {
+      for (ci = ci_lo; ci <= ci_hi; ci++) {
+        LSMLIB_REAL phi_corner[8], x_corner[8][3];
+        LSMLIB_REAL phi_min = LSMLIB_REAL_MAX, phi_max = -LSMLIB_REAL_MAX;
+        LSMLIB_REAL box_dist_sq = 0.0;
+        int offset[3], corner, tet, n;
+
+        /* skip cells that cannot contain a closer point */
+        offset[0] = ci - i;  offset[1] = cj - j;  offset[2] = ck - k;
+        for (n = 0; n < 3; n++) {
+          LSMLIB_REAL gap = 0.0;
+          if (offset[n] > 0) gap = offset[n]*dx[n];
+          else if (offset[n] < -1) gap = (-offset[n] - 1)*dx[n];
+          box_dist_sq += gap*gap;
+        }
+        if (box_dist_sq >= dist_min*dist_min) continue;
+
+        /* gather corner data */
+        for (corner = 0; corner < 8; corner++) {
+          int di = corner & 1, dj = (corner >> 1) & 1, dk = (corner >> 2) & 1;
+          phi_corner[corner] = phi[(ci+di) + (cj+dj)*nx + (ck+dk)*nxy];
+          x_corner[corner][0] = (offset[0] + di)*dx[0];
+          x_corner[corner][1] = (offset[1] + dj)*dx[1];
+          x_corner[corner][2] = (offset[2] + dk)*dx[2];
+          if (phi_corner[corner] < phi_min) phi_min = phi_corner[corner];
+          if (phi_corner[corner] > phi_max) phi_max = phi_corner[corner];
+        }
+        if ( (phi_min > 0) || (phi_max < 0) ) continue;
+
+        /* grid points that lie on the zero level set */
+        if (phi_min == 0) {
+          for (corner = 0; corner < 8; corner++) {
+            if (phi_corner[corner] == 0) {
+              LSMLIB_REAL dist = sqrt(
+                x_corner[corner][0]*x_corner[corner][0]
+              + x_corner[corner][1]*x_corner[corner][1]
+              + x_corner[corner][2]*x_corner[corner][2]);
+              if (dist < dist_min) dist_min = dist;
+            }
+          }
+        }
+
+        /* distance to the interface in each tetrahedron */
+        for (tet = 0; tet < LSM3D_NUM_CUBE_TETRAHEDRA; tet++) {
+          LSMLIB_REAL phi_tet[4], vertices[12], dist;
+          int corners[4], num_vertices;
+
+          LSM3D_getCubeTetrahedron(tet, corners);
+          for (n = 0; n < 4; n++) phi_tet[n] = phi_corner[corners[n]];
+
+          num_vertices = LSM3D_findSurfaceInTetrahedron(vertices,
+            x_corner[corners[0]], x_corner[corners[1]],
+            x_corner[corners[2]], x_corner[corners[3]], phi_tet);
+          if (num_vertices == 0) continue;
+
+          dist = LSM3D_computeDistanceToTriangle(x,
+            &(vertices[0]), &(vertices[3]), &(vertices[6]));
+          if (dist < dist_min) dist_min = dist;
+
+          if (num_vertices == 4) {
+            dist = LSM3D_computeDistanceToTriangle(x,
+              &(vertices[0]), &(vertices[6]), &(vertices[9]));
+            if (dist < dist_min) dist_min = dist;
+          }
+        }
+      }
+    }
+  }
+
+  /*
+   * grid points with no interface within the search radius are at least
+   * search_radius*h_min from the zero level set
+   */
+  if ( (dist_min == LSMLIB_REAL_MAX) && (cutoff > 0)
+    && (cutoff <= search_radius*h_min) ) {
+    dist_min = cutoff;
+  }
+
+  /* cutoff (points outside of the search radius are handled later) */
+  if ( (cutoff > 0) && (dist_min > cutoff)
+    && (dist_min < LSMLIB_REAL_MAX) ) {
+    dist_min = cutoff;
+  }
+
+  return (phi_cur > 0) ? dist_min : -dist_min;
+}
+
+
+/*
+ * isOuterLayerNeighbor() returns 1 if the distance function at grid
+ * point (i,j,k) has been computed by the current call:  a point in the
+ * fillbox (narrow_band == NULL) or a point in narrow band levels 0
+ * through num_levels-1.
+ */
+static int isOuterLayerNeighbor(
+  const Grid *grid,
+  const unsigned char *narrow_band,
+  int num_levels,
+  int i, int j, int k)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  int level_bits;
+
+  if (!narrow_band) {
+    return (i >= grid->ilo_fb) && (i <= grid->ihi_fb)
+        && (j >= grid->jlo_fb) && (j <= grid->jhi_fb)
+        && (k >= grid->klo_fb) && (k <= grid->khi_fb);
+  }
+
+  if ( (i < grid->ilo_gb) || (i > grid->ihi_gb)
+    || (j < grid->jlo_gb) || (j > grid->jhi_gb)
+    || (k < grid->klo_gb) || (k > grid->khi_gb) ) {
+    return 0;
+  }
+  level_bits = narrow_band[i + j*nx + k*nxy] & LSM_NB_LEVEL_BITS;
+  return (level_bits > 0) && (level_bits <= num_levels);
+}
+
+
+/*
+ * computeOuterLayerUpdate() computes the first-order upwind (Godunov)
+ * solution of |grad d| = 1 at grid point (i,j,k) from the magnitude of
+ * the distance function at its neighbors.  Returns LSMLIB_REAL_MAX if
+ * no neighbor has a finite distance.
+ */
+static LSMLIB_REAL computeOuterLayerUpdate(
+  const LSMLIB_REAL *distance_function,
+  const Grid *grid,
+  const unsigned char *narrow_band,
+  int num_levels,
+  int i, int j, int k)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const int stride[3] = {1, nx, nxy};
+  LSMLIB_REAL a[3], h[3];
+  LSMLIB_REAL sum_w = 0.0, sum_wa = 0.0, sum_waa = 0.0;
+  LSMLIB_REAL u = LSMLIB_REAL_MAX;
+  int num_dirs = 0;
+  int dir, m, n;
+
+  /* smallest neighbor value in each coordinate direction */
+  for (dir = 0; dir < 3; dir++) {
+    int off[3] = {0, 0, 0};
+    LSMLIB_REAL a_dir = LSMLIB_REAL_MAX;
+    int side;
+    for (side = -1; side <= 1; side += 2) {
+      off[dir] = side;
+      if (isOuterLayerNeighbor(grid, narrow_band, num_levels,
+                               i+off[0], j+off[1], k+off[2])) {
+        LSMLIB_REAL d = fabs(distance_function[i + j*nx + k*nxy
+                                               + side*stride[dir]]);
+        if (d < a_dir) a_dir = d;
+      }
+    }
+    if (a_dir < LSMLIB_REAL_MAX) {
+      a[num_dirs] = a_dir;
+      h[num_dirs] = grid->dx[dir];
+      num_dirs++;
+    }
+  }
+
+  /* sort directions by neighbor value */
+  for (m = 1; m < num_dirs; m++) {
+    for (n = m; (n > 0) && (a[n] < a[n-1]); n--) {
+      LSMLIB_REAL tmp;
+      tmp = a[n]; a[n] = a[n-1]; a[n-1] = tmp;
+      tmp = h[n]; h[n] = h[n-1]; h[n-1] = tmp;
+    }
+  }
+
+  /* add directions while the solution exceeds their neighbor value */
+  for (m = 0; m < num_dirs; m++) {
+    LSMLIB_REAL w = 1.0/(h[m]*h[m]);
+    LSMLIB_REAL disc;
+    if ( (m > 0) && (u <= a[m]) ) break;
+    sum_w += w;
+    sum_wa += w*a[m];
+    sum_waa += w*a[m]*a[m];
+    disc = sum_wa*sum_wa - sum_w*(sum_waa - 1.0);
+    u = (sum_wa + sqrt(disc > 0 ? disc : 0.0))/sum_w;
+  }
+
+  return u;
+}
+
+
+/*
+ * updateOuterLayerPoint() replaces the distance function at grid point
+ * (i,j,k) by computeOuterLayerUpdate() if that decreases its magnitude.
+ * Returns 1 if the value changed.
+ */
+static int updateOuterLayerPoint(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const unsigned char *narrow_band,
+  int num_levels,
+  int i, int j, int k,
+  LSMLIB_REAL tol)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int idx = i + j*nx + k*nx*grid->grid_dims_ghostbox[1];
+  LSMLIB_REAL u = computeOuterLayerUpdate(distance_function, grid,
+                                          narrow_band, num_levels, i, j, k);
+
+  if (u < fabs(distance_function[idx]) - tol) {
+    distance_function[idx] = (phi[idx] > 0) ? u : -u;
+    return 1;
+  }
+  return 0;
+}
+
+
+/*
+ * finishOuterLayerPoint() sets grid points not reached by the outer
+ * layer sweeps (no zero level set anywhere nearby) to the fallback value
+ * and applies the cutoff.
+ */
+static void finishOuterLayerPoint(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  int idx,
+  LSMLIB_REAL fallback,
+  LSMLIB_REAL cutoff)
+{
+  LSMLIB_REAL d = fabs(distance_function[idx]);
+
+  if (d == LSMLIB_REAL_MAX) d = (cutoff > 0) ? cutoff : fallback;
+  if ( (cutoff > 0) && (d > cutoff) ) d = cutoff;
+  distance_function[idx] = (phi[idx] > 0) ? d : -d;
+}
+
+
+/*
+ * sweepFillboxOuterLayers() computes the distance function at the
+ * fillbox points with is_outer set (points with no zero level set within
+ * the search radius) by Gauss-Seidel sweeps of |grad d| = 1 in all eight
+ * orderings of the fillbox, holding the directly computed values fixed.
+ * is_outer is indexed by the linear index of the point in the fillbox.
+ */
+static void sweepFillboxOuterLayers(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const unsigned char *is_outer,
+  LSMLIB_REAL fallback,
+  LSMLIB_REAL cutoff)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const int ni = grid->ihi_fb - grid->ilo_fb + 1;
+  const int nj = grid->jhi_fb - grid->jlo_fb + 1;
+  const int nk = grid->khi_fb - grid->klo_fb + 1;
+  const LSMLIB_REAL tol = LSMLIB_ZERO_TOL*fallback;
+  int changed = 1;
+  int ii, jj, kk;
+
+  while (changed) {
+    int ordering;
+    changed = 0;
+    for (ordering = 0; ordering < 8; ordering++) {
+      for (kk = 0; kk < nk; kk++) {
+        int k = (ordering & 4) ? nk - 1 - kk : kk;
+        for (jj = 0; jj < nj; jj++) {
+          int j = (ordering & 2) ? nj - 1 - jj : jj;
+          for (ii = 0; ii < ni; ii++) {
+            int i = (ordering & 1) ? ni - 1 - ii : ii;
+            if (!is_outer[i + ni*(j + nj*k)]) continue;
+            changed |= updateOuterLayerPoint(distance_function, phi, grid,
+                                             NULL, 0, grid->ilo_fb + i,
+                                             grid->jlo_fb + j,
+                                             grid->klo_fb + k, tol);
+          }
+        }
+      }
+    }
+  }
+
+  for (kk = 0; kk < nk; kk++) {
+    for (jj = 0; jj < nj; jj++) {
+      for (ii = 0; ii < ni; ii++) {
+        if (!is_outer[ii + ni*(jj + nj*kk)]) continue;
+        finishOuterLayerPoint(distance_function, phi,
+                              (grid->ilo_fb + ii) + (grid->jlo_fb + jj)*nx
+                              + (grid->klo_fb + kk)*nxy,
+                              fallback, cutoff);
+      }
+    }
+  }
+}
+
+
+/*
+ * sweepBandOuterLayers() is the narrow band version of
+ * sweepFillboxOuterLayers().  The points to update are given as
+ * positions in the index_* arrays (outer_pts) in order of increasing
+ * narrow band level, so forward and backward passes are alternated.
+ * Only neighbors in narrow band levels 0 through num_levels-1 are used;
+ * without a narrow_band array, the points are set to the fallback value.
+ */
+static void sweepBandOuterLayers(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const unsigned char *narrow_band,
+  int num_levels,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *outer_pts,
+  int num_outer,
+  LSMLIB_REAL fallback,
+  LSMLIB_REAL cutoff)
+{
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const LSMLIB_REAL tol = LSMLIB_ZERO_TOL*fallback;
+  int changed = (narrow_band != NULL);
+  int pass = 0;
+  int n;
+
+  while (changed) {
+    changed = 0;
+    for (n = 0; n < num_outer; n++) {
+      int m = outer_pts[(pass & 1) ? num_outer - 1 - n : n];
+      changed |= updateOuterLayerPoint(distance_function, phi, grid,
+                                       narrow_band, num_levels,
+                                       index_x[m], index_y[m], index_z[m],
+                                       tol);
+    }
+    pass++;
+  }
+
+  for (n = 0; n < num_outer; n++) {
+    int m = outer_pts[n];
+    finishOuterLayerPoint(distance_function, phi,
+                          index_x[m] + index_y[m]*nx + index_z[m]*nxy,
+                          fallback, cutoff);
+  }
+}
+
+
+/*
+ * processBandPoints() is the LSM_Runtime_parallelFor() body for
+ * computeDirectDistanceFunction3dLocal().
+ */
+static void processBandPoints(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_DirectReinitArgs *args = (LSM_DirectReinitArgs *) user_data;
+  const Grid *grid = args->grid;
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  int m;
+
+  (void) thread_num;
+
+  for (m = begin; m < end; m++) {
+    int i = args->index_x[m];
+    int j = args->index_y[m];
+    int k = args->index_z[m];
+    args->distance_function[i + j*nx + k*nxy] =
+      computeDirectDistanceAtPoint(args->phi, grid, i, j, k,
+                                   args->search_radius, args->cutoff);
+  }
+}
+
+
+/*
+ * processFillboxPoints() is the LSM_Runtime_parallelFor() body for
+ * computeDirectDistanceFunction3d().  Iterations correspond to (j,k)
+ * lines of the fillbox.
+ */
+static void processFillboxPoints(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_DirectReinitArgs *args = (LSM_DirectReinitArgs *) user_data;
+  const Grid *grid = args->grid;
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const int num_j = grid->jhi_fb - grid->jlo_fb + 1;
+  int line, i;
+
+  (void) thread_num;
+
+  for (line = begin; line < end; line++) {
+    int j = grid->jlo_fb + line % num_j;
+    int k = grid->klo_fb + line / num_j;
+    for (i = grid->ilo_fb; i <= grid->ihi_fb; i++) {
+      args->distance_function[i + j*nx + k*nxy] =
+        computeDirectDistanceAtPoint(args->phi, grid, i, j, k,
+                                     args->search_radius, args->cutoff);
+    }
+  }
+}
+
+
+/*================== Direct Reinitialization Functions ===============*/
+
+int computeDirectDistanceFunction3dLocal(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *n_lo,
+  const int *n_hi,
+  const unsigned char *narrow_band,
+  int num_levels,
+  int search_radius,
+  LSMLIB_REAL cutoff)
+{
+  const int nx = grid ? grid->grid_dims_ghostbox[0] : 0;
+  const int nxy = grid ? nx*grid->grid_dims_ghostbox[1] : 0;
+  LSM_DirectReinitArgs args;
+  int *outer_pts;
+  int num_outer = 0;
+  int begin = -1, end = -1;
+  int level, m;
+
+  if ( (!distance_function) || (!phi) || (!grid) ||
+       (distance_function == phi) || (search_radius < 1) ) {
+    return LSM_DIRECT_REINIT_ERR_INVALID_ARGUMENT;
+  }
+
+  /* narrow band levels are stored consecutively */
+  for (level = 0; level < num_levels; level++) {
+    if (n_hi[level] < n_lo[level]) continue;
+    if ( (begin < 0) || (n_lo[level] < begin) ) begin = n_lo[level];
+    if (n_hi[level] + 1 > end) end = n_hi[level] + 1;
+  }
+  if (begin < 0) return LSM_DIRECT_REINIT_ERR_SUCCESS;
+
+  args.distance_function = distance_function;
+  args.phi = phi;
+  args.grid = grid;
+  args.index_x = index_x;
+  args.index_y = index_y;
+  args.index_z = index_z;
+  args.search_radius = search_radius;
+  args.cutoff = cutoff;
+
+  LSM_Runtime_parallelFor(begin, end, LSM_SCHEDULE_DYNAMIC, 0, 0,
+                          processBandPoints, &args);
+
+  /* outer layers:  points with no zero level set within search radius */
+  for (level = 0; level < num_levels; level++) {
+    for (m = n_lo[level]; m <= n_hi[level]; m++) {
+      int idx = index_x[m] + index_y[m]*nx + index_z[m]*nxy;
+      if (fabs(distance_function[idx]) == LSMLIB_REAL_MAX) num_outer++;
+    }
+  }
+  if (num_outer == 0) return LSM_DIRECT_REINIT_ERR_SUCCESS;
+
+  outer_pts = (int *) malloc(num_outer*sizeof(int));
+  if (!outer_pts) return LSM_DIRECT_REINIT_ERR_MEMORY_ALLOCATION;
+  num_outer = 0;
+  for (level = 0; level < num_levels; level++) {
+    for (m = n_lo[level]; m <= n_hi[level]; m++) {
+      int idx = index_x[m] + index_y[m]*nx + index_z[m]*nxy;
+      if (fabs(distance_function[idx]) == LSMLIB_REAL_MAX) {
+        outer_pts[num_outer++] = m;
+      }
+    }
+  }
+
+  sweepBandOuterLayers(distance_function, phi, grid,
+                       narrow_band, num_levels,
+                       index_x, index_y, index_z, outer_pts, num_outer,
+                       search_radius*getMinGridSpacing(grid), cutoff);
+
+  free(outer_pts);
+  return LSM_DIRECT_REINIT_ERR_SUCCESS;
+}
+
+
+int computeDirectDistanceFunction3d(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  int search_radius,
+  LSMLIB_REAL cutoff)
+{
+  LSM_DirectReinitArgs args;
+  unsigned char *is_outer;
+  int num_lines, num_outer = 0;
+  int i, j, k;
+
+  if ( (!distance_function) || (!phi) || (!grid) ||
+       (distance_function == phi) || (search_radius < 1) ) {
+    return LSM_DIRECT_REINIT_ERR_INVALID_ARGUMENT;
+  }
+
+  args.distance_function = distance_function;
+  args.phi = phi;
+  args.grid = grid;
+  args.index_x = args.index_y = args.index_z = NULL;
+  args.search_radius = search_radius;
+  args.cutoff = cutoff;
+
+  num_lines = (grid->jhi_fb - grid->jlo_fb + 1)
+            * (grid->khi_fb - grid->klo_fb + 1);
+  LSM_Runtime_parallelFor(0, num_lines, LSM_SCHEDULE_DYNAMIC, 0, 0,
+                          processFillboxPoints, &args);
+
+  /* outer layers:  points with no zero level set within search radius */
+  is_outer = (unsigned char *) malloc(
+    (grid->ihi_fb - grid->ilo_fb + 1)*num_lines*sizeof(unsigned char));
+  if (!is_outer) return LSM_DIRECT_REINIT_ERR_MEMORY_ALLOCATION;
+  for (k = grid->klo_fb; k <= grid->khi_fb; k++) {
+    for (j = grid->jlo_fb; j <= grid->jhi_fb; j++) {
+      for (i = grid->ilo_fb; i <= grid->ihi_fb; i++) {
+        int idx = i + j*grid->grid_dims_ghostbox[0]
+                + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+        int outer = (fabs(distance_function[idx]) == LSMLIB_REAL_MAX);
+        is_outer[(i - grid->ilo_fb) + (grid->ihi_fb - grid->ilo_fb + 1)
+                 * ((j - grid->jlo_fb) + (grid->jhi_fb - grid->jlo_fb + 1)
+                    * (k - grid->klo_fb))] = (unsigned char) outer;
+        num_outer += outer;
+      }
+    }
+  }
+
+  if (num_outer > 0) {
+    sweepFillboxOuterLayers(distance_function, phi, grid, is_outer,
+                            search_radius*getMinGridSpacing(grid), cutoff);
+  }
+
+  free(is_outer);
+  return LSM_DIRECT_REINIT_ERR_SUCCESS;
+}
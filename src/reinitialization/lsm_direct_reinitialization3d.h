@@ -0,0 +1,150 @@
+/*
+ * File:        lsm_direct_reinitialization3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for 3D direct geometric reinitialization
+ *              routines
+ */
+
+#ifndef INCLUDED_LSM_DIRECT_REINITIALIZATION_3D_H
+#define INCLUDED_LSM_DIRECT_REINITIALIZATION_3D_H
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lsm_direct_reinitialization3d.h
+ *
+ * \brief
+ * @ref lsm_direct_reinitialization3d.h provides support for
+ * reinitializing a level set function to a signed distance function by
+ * directly computing the distance to a piecewise-linear reconstruction
+ * of the zero level set (i.e. without solving the reinitialization
+ * equation or using the fast marching method).
+ *
+ * Each grid cell is decomposed into six tetrahedra (see
+ * LSM3D_getCubeTetrahedron()).  Within each tetrahedron, the zero level
+ * set of the linear interpolant of \f$ \phi \f$ is a triangle or a
+ * quadrilateral.  For each grid point, the distance is computed exactly
+ * as the minimum distance to the pieces of the reconstructed interface
+ * in the cells within a fixed search radius of the grid point.  Because
+ * every grid point is processed independently, the computation is
+ * distributed across the threads of the LSMLIB runtime (see
+ * @ref lsm_runtime.h).
+ *
+ */
+
+#include "lsm_grid.h"
+
+
+/*!
+ * Error codes returned by direct reinitialization functions.
+ */
+#define LSM_DIRECT_REINIT_ERR_SUCCESS               (0)
+#define LSM_DIRECT_REINIT_ERR_INVALID_ARGUMENT      (1)
+#define LSM_DIRECT_REINIT_ERR_MEMORY_ALLOCATION     (2)
+
+/*!
+ * computeDirectDistanceFunction3dLocal() computes the signed distance
+ * function at the narrow band grid points by direct computation of the
+ * distance to the reconstructed zero level set of \f$ \phi \f$.
+ *
+ * Arguments:
+ *  - distance_function (out):  signed distance function
+ *  - phi (in):                 level set function
+ *  - grid (in):                pointer to Grid
+ *  - index_* (in):             narrow band indices (see
+ *                              LSM3D_DETERMINE_NARROW_BAND())
+ *  - n_lo, n_hi (in):          index ranges of narrow band levels
+ *  - narrow_band (in):         narrow band array (see
+ *                              determineNarrowBand3d()); may be NULL
+ *  - num_levels (in):          number of narrow band levels to process
+ *                              (levels 0 through num_levels-1)
+ *  - search_radius (in):       number of grid cells in each direction
+ *                              searched for the zero level set
+ *  - cutoff (in):              maximum magnitude of the distance function;
+ *                              set to 0 (or a negative number) to disable
+ *                              the cutoff
+ *
+ * Return value:                error code
+ *
+ * NOTES:
+ *  - The distance is exact (for the reconstructed interface) at grid
+ *    points within search_radius*min(dx) of the zero level set.
+ *
+ *  - Grid points with no zero level set within the search radius (outer
+ *    layers) are set to sign(phi)*cutoff if the cutoff does not exceed
+ *    search_radius*min(dx).  Otherwise, they are computed by a
+ *    first-order upwind (fast sweeping) solution of |grad d| = 1 that
+ *    holds the directly computed values fixed and only uses neighbors in
+ *    the processed narrow band levels.  If narrow_band is NULL, the
+ *    sweeps are skipped and outer layer points are set to
+ *    sign(phi)*search_radius*min(dx) (a lower bound on the distance).
+ *
+ *  - When a cutoff is specified, the magnitude of the distance function
+ *    is limited to the cutoff (e.g. for the outer layers of the narrow
+ *    band).
+ *
+ *  - Grid points that do not belong to the processed narrow band levels
+ *    are not modified.
+ *
+ *  - distance_function and phi must not be the same array.
+ *
+ */
+int computeDirectDistanceFunction3dLocal(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *n_lo,
+  const int *n_hi,
+  const unsigned char *narrow_band,
+  int num_levels,
+  int search_radius,
+  LSMLIB_REAL cutoff);
+
+/*!
+ * computeDirectDistanceFunction3d() computes the signed distance
+ * function at every grid point in the fillbox by direct computation of
+ * the distance to the reconstructed zero level set of \f$ \phi \f$.
+ *
+ * Arguments:
+ *  - distance_function (out):  signed distance function
+ *  - phi (in):                 level set function
+ *  - grid (in):                pointer to Grid
+ *  - search_radius (in):       number of grid cells in each direction
+ *                              searched for the zero level set
+ *  - cutoff (in):              maximum magnitude of the distance function;
+ *                              set to 0 (or a negative number) to disable
+ *                              the cutoff
+ *
+ * Return value:                error code
+ *
+ * NOTES:
+ *  - See computeDirectDistanceFunction3dLocal() for the treatment of
+ *    grid points far from the zero level set.  The outer layer sweeps
+ *    use all fillbox points as neighbors.
+ *
+ *  - The cost grows with the cube of search_radius, so this function is
+ *    intended for thin bands around the interface (e.g. with a cutoff).
+ *
+ */
+int computeDirectDistanceFunction3d(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const Grid *grid,
+  int search_radius,
+  LSMLIB_REAL cutoff);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
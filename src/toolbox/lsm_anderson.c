@@ -0,0 +1,256 @@
+/*
+ * File:        lsm_anderson.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for Anderson acceleration of
+ *              fixed-point iterations
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "lsm_anderson.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Relative regularization added to the diagonal of the normal
+ * equations and relative pivot size below which they are treated as
+ * singular.
+ */
+#define LSM_ANDERSON_REGULARIZATION                 (1.0e-12)
+#define LSM_ANDERSON_MIN_PIVOT                      (1.0e-14)
+
+
+/*
+ * solveAndersonNormalEquations() solves the n x n system A gamma = b
+ * (A is overwritten) by Gaussian elimination with partial pivoting.
+ * Returns 0 on success and 1 if A is numerically singular.
+ */
+static int solveAndersonNormalEquations(
+  LSMLIB_REAL A[LSM_ANDERSON_MAX_DEPTH][LSM_ANDERSON_MAX_DEPTH],
+  LSMLIB_REAL *b,
+  LSMLIB_REAL *gamma,
+  int n)
+{
+  LSMLIB_REAL max_diag = 0.0;
+  int i, j, k;
+
+  for (i = 0; i < n; i++) {
+    if (A[i][i] > max_diag) max_diag = A[i][i];
+  }
+  if (max_diag <= 0) return 1;
+  for (i = 0; i < n; i++) A[i][i] += LSM_ANDERSON_REGULARIZATION*max_diag;
+
+  for (k = 0; k < n; k++) {
+    int p = k;
+    for (i = k+1; i < n; i++) {
+      if (fabs(A[i][k]) > fabs(A[p][k])) p = i;
+    }
+    if (fabs(A[p][k]) <= LSM_ANDERSON_MIN_PIVOT*max_diag) return 1;
+    if (p != k) {
+      LSMLIB_REAL tmp;
+      for (j = k; j < n; j++) {
+        tmp = A[k][j]; A[k][j] = A[p][j]; A[p][j] = tmp;
+      }
+      tmp = b[k]; b[k] = b[p]; b[p] = tmp;
+    }
+    for (i = k+1; i < n; i++) {
+      LSMLIB_REAL factor = A[i][k]/A[k][k];
+      for (j = k; j < n; j++) A[i][j] -= factor*A[k][j];
+      b[i] -= factor*b[k];
+    }
+  }
+
+  for (k = n-1; k >= 0; k--) {
+    LSMLIB_REAL sum = b[k];
+    for (j = k+1; j < n; j++) sum -= A[k][j]*gamma[j];
+    gamma[k] = sum/A[k][k];
+  }
+  return 0;
+}
+
+
+/*==================== Function Definitions ==========================*/
+
+LSM_AndersonAcceleration *createAndersonAcceleration(
+  int max_num_unknowns,
+  int depth,
+  LSMLIB_REAL mixing)
+{
+  LSM_AndersonAcceleration *acc;
+
+  if ( (max_num_unknowns <= 0) || (depth < 0)
+    || (depth > LSM_ANDERSON_MAX_DEPTH) || !(mixing > 0)
+    || (mixing > 1) ) {
+    return NULL;
+  }
+
+  acc = (LSM_AndersonAcceleration *) calloc(
+    1, sizeof(LSM_AndersonAcceleration));
+  if (!acc) return NULL;
+
+  acc->x_prev = (LSMLIB_REAL *) malloc(
+    (2*depth+4)*((size_t) max_num_unknowns)*sizeof(LSMLIB_REAL));
+  if (!acc->x_prev) {
+    free(acc);
+    return NULL;
+  }
+  acc->f_prev = acc->x_prev + max_num_unknowns;
+  acc->x_work = acc->f_prev + max_num_unknowns;
+  acc->g_work = acc->x_work + max_num_unknowns;
+  acc->dX = acc->g_work + max_num_unknowns;
+  acc->dF = acc->dX + ((size_t) depth)*max_num_unknowns;
+
+  acc->depth = depth;
+  acc->mixing = mixing;
+  acc->max_num_unknowns = max_num_unknowns;
+  resetAndersonAcceleration(acc);
+
+  return acc;
+}
+
+
+void destroyAndersonAcceleration(LSM_AndersonAcceleration *acc)
+{
+  if (acc) {
+    free(acc->x_prev);
+    free(acc);
+  }
+}
+
+
+void resetAndersonAcceleration(LSM_AndersonAcceleration *acc)
+{
+  if (acc) {
+    acc->num_unknowns = 0;
+    acc->have_prev = 0;
+    acc->num_cols = 0;
+    acc->next_col = 0;
+  }
+}
+
+
+int applyAndersonAcceleration(
+  LSM_AndersonAcceleration *acc,
+  LSMLIB_REAL *x,
+  const LSMLIB_REAL *g,
+  int num_unknowns)
+{
+  LSMLIB_REAL A[LSM_ANDERSON_MAX_DEPTH][LSM_ANDERSON_MAX_DEPTH];
+  LSMLIB_REAL b[LSM_ANDERSON_MAX_DEPTH], gamma[LSM_ANDERSON_MAX_DEPTH];
+  LSMLIB_REAL beta;
+  size_t n;
+  int i, j;
+  size_t m;
+
+  if ( !acc || !x || !g || (num_unknowns <= 0)
+    || (num_unknowns > acc->max_num_unknowns) ) {
+    return LSM_ANDERSON_ERR_INVALID_ARGUMENT;
+  }
+  if (num_unknowns != acc->num_unknowns) {
+    resetAndersonAcceleration(acc);
+    acc->num_unknowns = num_unknowns;
+  }
+  n = (size_t) num_unknowns;
+  beta = acc->mixing;
+
+  /* store the differences to the previous iterate and residual;  */
+  /* f_prev is replaced by the current residual f = g - x         */
+  if (acc->have_prev && (acc->depth > 0)) {
+    LSMLIB_REAL *dX = acc->dX + acc->next_col*n;
+    LSMLIB_REAL *dF = acc->dF + acc->next_col*n;
+    for (m = 0; m < n; m++) {
+      LSMLIB_REAL f = g[m] - x[m];
+      dX[m] = x[m] - acc->x_prev[m];
+      dF[m] = f - acc->f_prev[m];
+    }
+    acc->next_col = (acc->next_col + 1) % acc->depth;
+    if (acc->num_cols < acc->depth) acc->num_cols++;
+  }
+  for (m = 0; m < n; m++) {
+    acc->x_prev[m] = x[m];
+    acc->f_prev[m] = g[m] - x[m];
+  }
+  acc->have_prev = 1;
+
+  /* least squares problem:  min |f - dF gamma| (normal equations) */
+  if (acc->num_cols > 0) {
+    for (i = 0; i < acc->num_cols; i++) {
+      const LSMLIB_REAL *dF_i = acc->dF + i*n;
+      for (j = 0; j <= i; j++) {
+        const LSMLIB_REAL *dF_j = acc->dF + j*n;
+        LSMLIB_REAL sum = 0.0;
+        for (m = 0; m < n; m++) sum += dF_i[m]*dF_j[m];
+        A[i][j] = A[j][i] = sum;
+      }
+      b[i] = 0.0;
+      for (m = 0; m < n; m++) b[i] += dF_i[m]*acc->f_prev[m];
+    }
+    if (solveAndersonNormalEquations(A, b, gamma, acc->num_cols)) {
+      acc->num_cols = 0;
+      acc->next_col = 0;
+    }
+  }
+
+  /* next iterate */
+  for (m = 0; m < n; m++) x[m] += beta*acc->f_prev[m];
+  for (i = 0; i < acc->num_cols; i++) {
+    const LSMLIB_REAL *dX_i = acc->dX + i*n;
+    const LSMLIB_REAL *dF_i = acc->dF + i*n;
+    for (m = 0; m < n; m++) x[m] -= gamma[i]*(dX_i[m] + beta*dF_i[m]);
+  }
+
+  return LSM_ANDERSON_ERR_SUCCESS;
+}
+
+
+int applyAndersonAccelerationLocal3d(
+  LSM_AndersonAcceleration *acc,
+  LSMLIB_REAL *phi,
+  const LSMLIB_REAL *phi_g,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index,
+  const Grid *grid)
+{
+  int nx, ny, l, err;
+
+  if ( !acc || !phi || !phi_g || !index_x || !index_y || !index_z
+    || !grid || (grid->num_dims != 3) ) {
+    return LSM_ANDERSON_ERR_INVALID_ARGUMENT;
+  }
+  if (nhi_index < nlo_index) return LSM_ANDERSON_ERR_SUCCESS;
+
+  nx = grid->grid_dims_ghostbox[0];
+  ny = grid->grid_dims_ghostbox[1];
+
+  /* gather */
+  for (l = nlo_index; l <= nhi_index; l++) {
+    int idx = (index_x[l] - grid->ilo_gb)
+            + nx*((index_y[l] - grid->jlo_gb)
+            + ny*(index_z[l] - grid->klo_gb));
+    acc->x_work[l - nlo_index] = phi[idx];
+    acc->g_work[l - nlo_index] = phi_g[idx];
+  }
+
+  err = applyAndersonAcceleration(acc, acc->x_work, acc->g_work,
+                                  nhi_index - nlo_index + 1);
+  if (err != LSM_ANDERSON_ERR_SUCCESS) return err;
+
+  /* scatter */
+  for (l = nlo_index; l <= nhi_index; l++) {
+    int idx = (index_x[l] - grid->ilo_gb)
+            + nx*((index_y[l] - grid->jlo_gb)
+            + ny*(index_z[l] - grid->klo_gb));
+    phi[idx] = acc->x_work[l - nlo_index];
+  }
+
+  return LSM_ANDERSON_ERR_SUCCESS;
+}
@@ -0,0 +1,199 @@
+/*
+ * File:        lsm_anderson.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for Anderson acceleration of fixed-point
+ *              iterations
+ */
+
+#ifndef included_lsm_anderson_h
+#define included_lsm_anderson_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_anderson.h
+ *
+ * \brief
+ * @ref lsm_anderson.h provides Anderson acceleration for fixed-point
+ * iterations x = G(x), e.g. pseudo-time stepping of a level set
+ * equation towards a steady state (G is then one pseudo-time step).
+ *
+ * Given the iterate x_k and g_k = G(x_k), the next iterate is
+ *
+ *   x_{k+1} = x_k + beta f_k - sum_j gamma_j (dX_j + beta dF_j)
+ *
+ * where f_k = g_k - x_k is the residual, dX_j and dF_j are the
+ * differences of the last (at most depth) iterates and residuals, beta
+ * is the mixing parameter and gamma minimizes |f_k - sum_j gamma_j dF_j|
+ * in the least squares sense.  With depth = 0, this is the (damped)
+ * fixed-point iteration x_{k+1} = x_k + beta f_k.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create an accelerator using createAndersonAcceleration().
+ * -# In each iteration, evaluate g = G(x) and call
+ *    applyAndersonAcceleration() (contiguous vectors) or
+ *    applyAndersonAccelerationLocal3d() (values at narrow band points)
+ *    to replace x by the next iterate.
+ * -# Call resetAndersonAcceleration() when the unknowns change (e.g.
+ *    after the narrow band has been rebuilt).
+ * -# Free the accelerator using destroyAndersonAcceleration().
+ *
+ */
+
+
+/*!
+ * Error codes returned by Anderson acceleration functions.
+ */
+#define LSM_ANDERSON_ERR_SUCCESS                    (0)
+#define LSM_ANDERSON_ERR_INVALID_ARGUMENT           (1)
+
+/*!
+ * Maximum number of stored differences.
+ */
+#define LSM_ANDERSON_MAX_DEPTH                      (16)
+
+
+/*!
+ * Structure 'LSM_AndersonAcceleration' stores the iteration history.
+ */
+typedef struct _LSM_AndersonAcceleration
+{
+  int           depth;            /* maximum number of differences      */
+  LSMLIB_REAL   mixing;           /* mixing parameter beta              */
+  int           max_num_unknowns; /* allocated vector length            */
+
+  int           num_unknowns;     /* length of the current vectors      */
+  int           have_prev;        /* x_prev and f_prev are set          */
+  int           num_cols;         /* number of stored differences       */
+  int           next_col;         /* column of the next difference      */
+
+  LSMLIB_REAL  *x_prev;           /* previous iterate                   */
+  LSMLIB_REAL  *f_prev;           /* previous residual                  */
+  LSMLIB_REAL  *dX;               /* depth columns of iterate diffs     */
+  LSMLIB_REAL  *dF;               /* depth columns of residual diffs    */
+  LSMLIB_REAL  *x_work;           /* work vectors for the local version */
+  LSMLIB_REAL  *g_work;
+} LSM_AndersonAcceleration;
+
+
+/*!
+ * createAndersonAcceleration() allocates an Anderson accelerator.
+ *
+ * Arguments:
+ *  - max_num_unknowns (in):  maximum length of the iterates
+ *  - depth (in):             maximum number of stored differences
+ *                            (0 <= depth <= LSM_ANDERSON_MAX_DEPTH)
+ *  - mixing (in):            mixing parameter (0 < mixing <= 1)
+ *
+ * Return value:              pointer to new accelerator (NULL on failure)
+ *
+ * NOTES:
+ *  - Memory for (2*depth+4)*max_num_unknowns values is allocated.
+ *
+ */
+LSM_AndersonAcceleration *createAndersonAcceleration(
+  int max_num_unknowns,
+  int depth,
+  LSMLIB_REAL mixing);
+
+/*!
+ * destroyAndersonAcceleration() frees an Anderson accelerator.
+ *
+ * Arguments:
+ *  - acc (in):  pointer to accelerator (may be NULL)
+ *
+ * Return value:  none
+ *
+ */
+void destroyAndersonAcceleration(LSM_AndersonAcceleration *acc);
+
+/*!
+ * resetAndersonAcceleration() discards the iteration history.
+ *
+ * Arguments:
+ *  - acc (in/out):  pointer to accelerator
+ *
+ * Return value:  none
+ *
+ */
+void resetAndersonAcceleration(LSM_AndersonAcceleration *acc);
+
+/*!
+ * applyAndersonAcceleration() computes the next iterate from the
+ * current iterate x and g = G(x).
+ *
+ * Arguments:
+ *  - acc (in/out):      pointer to accelerator
+ *  - x (in/out):        current iterate on input, next iterate on output
+ *  - g (in):            G(x)
+ *  - num_unknowns (in): length of x and g
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - If num_unknowns differs from the length in the previous call, the
+ *    history is discarded.
+ *
+ *  - If the least squares problem is (numerically) singular, the
+ *    history is discarded and x + mixing*(g - x) is returned.
+ *
+ */
+int applyAndersonAcceleration(
+  LSM_AndersonAcceleration *acc,
+  LSMLIB_REAL *x,
+  const LSMLIB_REAL *g,
+  int num_unknowns);
+
+/*!
+ * applyAndersonAccelerationLocal3d() is the same as
+ * applyAndersonAcceleration() for the values of phi and G(phi) at the
+ * narrow band points nlo_index, ..., nhi_index.
+ *
+ * Arguments:
+ *  - acc (in/out):     pointer to accelerator
+ *  - phi (in/out):     current iterate on input; on output, the values
+ *                      at the narrow band points are replaced by the
+ *                      next iterate
+ *  - phi_g (in):       G(phi)
+ *  - index_* (in):     coordinates of narrow band points
+ *  - nlo_index,
+ *    nhi_index (in):   index range of narrow band points
+ *  - grid (in):        pointer to Grid data structure
+ *
+ * Return value:        error code
+ *
+ * NOTES:
+ *  - The narrow band points must be the same in consecutive calls
+ *    (call resetAndersonAcceleration() when the narrow band changes).
+ *
+ *  - phi is not modified outside of the narrow band points.
+ *
+ */
+int applyAndersonAccelerationLocal3d(
+  LSM_AndersonAcceleration *acc,
+  LSMLIB_REAL *phi,
+  const LSMLIB_REAL *phi_g,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index,
+  const Grid *grid);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -24,6 +24,9 @@ extern "C" {
 
 
 #define LSM3D_DELTA_FUNCTION_ORDER1 lsm3ddeltafunctionorder1_
+#define LSM3D_DELTA_FUNCTION_ORDER2 lsm3ddeltafunctionorder2_
+#define LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2 lsm3dsurfaceintegraldeltaorder2_
+#define LSM3D_SURFACE_AREA_DELTA_ORDER2 lsm3dsurfaceareadeltaorder2_
 
   
 /*!
@@ -70,6 +73,159 @@ void LSM3D_DELTA_FUNCTION_ORDER1(
   const int *khi_fb,
   const LSMLIB_REAL    *dx,
   const LSMLIB_REAL    *dy,
+  const LSMLIB_REAL    *dz);  
+
+/*!
+*
+*  LSM3D_DELTA_FUNCTION_ORDER2() computes second order accurate delta
+*  function discretization following Smereka, "The numerical approximation
+*  of a delta function with application to level set methods", JCP, 2006.
+*  The function is supported at a minimal set of points around the zero
+*  level set.
+*
+*  Arguments:
+*    phi(in):           level set function
+*    delta(out):        discretized delta function corresp. to zero level
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    *_fb (in):        index range for fillbox
+*    dx,dy,dz(in):     grid spacing
+*
+*  Notes: 
+*    - Along each grid line, the zero crossing is located with the
+*      quadratic approximation of Smereka's formula (48) and the normal
+*      component is interpolated to the crossing, so that the zeroth
+*      and first moments of the 1D delta function are exact.
+*    - phi must be available within 2 points and norm_phi_* within 1
+*      point of the fillbox.
+*
+*/
+void LSM3D_DELTA_FUNCTION_ORDER2(
+  const LSMLIB_REAL *phi,
+  LSMLIB_REAL *delta,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const int *ilo_fb,
+  const int *ihi_fb,
+  const int *jlo_fb,
+  const int *jhi_fb,
+  const int *klo_fb,
+  const int *khi_fb,
+  const LSMLIB_REAL    *dx,
+  const LSMLIB_REAL    *dy,
+  const LSMLIB_REAL    *dz);
+
+
+/*!
+*
+*  LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2() computes the surface integral of
+*  F over the zero level set using the delta function of
+*  LSM3D_DELTA_FUNCTION_ORDER2(), which is evaluated on the fly (no delta
+*  function array is required).
+*
+*  Arguments:
+*    int_F(out):        value of integral of F over the zero level set
+*    F(in):             function to be integrated
+*    phi(in):           level set function
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    *_fb (in):        index range for box to include in integral
+*    dx,dy,dz(in):     grid spacing
+*
+*/
+void LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2(
+  LSMLIB_REAL *int_F,
+  const LSMLIB_REAL *F,
+  const int *ilo_F_gb, 
+  const int *ihi_F_gb,
+  const int *jlo_F_gb, 
+  const int *jhi_F_gb,
+  const int *klo_F_gb, 
+  const int *khi_F_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const int *ilo_fb,
+  const int *ihi_fb,
+  const int *jlo_fb,
+  const int *jhi_fb,
+  const int *klo_fb,
+  const int *khi_fb,
+  const LSMLIB_REAL    *dx,
+  const LSMLIB_REAL    *dy,
+  const LSMLIB_REAL    *dz);
+
+
+/*!
+*
+*  LSM3D_SURFACE_AREA_DELTA_ORDER2() computes the area of the zero level
+*  set using the delta function of LSM3D_DELTA_FUNCTION_ORDER2(), which
+*  is evaluated on the fly (no delta function array is required).
+*
+*  Arguments:
+*    area(out):         area of the zero level set
+*    phi(in):           level set function
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    *_fb (in):        index range for box to include in area
+*    dx,dy,dz(in):     grid spacing
+*
+*/
+void LSM3D_SURFACE_AREA_DELTA_ORDER2(
+  LSMLIB_REAL *area,
+  const LSMLIB_REAL *phi,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const int *ilo_fb,
+  const int *ihi_fb,
+  const int *jlo_fb,
+  const int *jhi_fb,
+  const int *klo_fb,
+  const int *khi_fb,
+  const LSMLIB_REAL    *dx,
+  const LSMLIB_REAL    *dy,
   const LSMLIB_REAL    *dz);
   
 #ifdef __cplusplus
@@ -0,0 +1,226 @@
+/*
+ * File:        lsm_calculus_toolbox3d_local.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file level set method calculus toolbox functions
+ */
+
+#ifndef INCLUDED_LSM_CALCULUS_TOOLBOX3D_LOCAL
+#define INCLUDED_LSM_CALCULUS_TOOLBOX3D_LOCAL
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \file lsm_calculus_toolbox3d_local.h
+ *
+ * \brief Provides higher order implementation of delta function in 3D
+ * (narrow band versions).
+ */
+
+
+#define LSM3D_DELTA_FUNCTION_ORDER2_LOCAL lsm3ddeltafunctionorder2local_
+#define LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2_LOCAL                           \
+                                      lsm3dsurfaceintegraldeltaorder2local_
+#define LSM3D_SURFACE_AREA_DELTA_ORDER2_LOCAL                               \
+                                      lsm3dsurfaceareadeltaorder2local_
+
+
+/*!
+*
+*  LSM3D_DELTA_FUNCTION_ORDER2_LOCAL() computes the second order accurate
+*  delta function of LSM3D_DELTA_FUNCTION_ORDER2() (see
+*  @ref lsm_calculus_toolbox3d.h) at the local (narrow band) points.
+*
+*  Arguments:
+*    delta(out):        discretized delta function corresp. to zero level
+*    phi(in):           level set function
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    dx,dy,dz(in):     grid spacing
+*    index_[xyz](in):   [xyz] coordinates of local (narrow band) points
+*    n*_index    (in):  index range of points to loop over in index_*
+*    narrow_band(in):   array that marks voxels outside desired fillbox
+*    mark_fb(in):      upper limit narrow band value for voxels in 
+*                      fillbox
+*
+*  Notes: 
+*    - delta is only set at narrow band points in the fillbox.
+*
+*/
+void LSM3D_DELTA_FUNCTION_ORDER2_LOCAL(
+  LSMLIB_REAL *delta,
+  const LSMLIB_REAL *phi,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index,
+  const int *nhi_index,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb);
+
+
+/*!
+*
+*  LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2_LOCAL() computes the surface
+*  integral of F over the zero level set using the second order accurate
+*  delta function evaluated on the fly at the local (narrow band) points
+*  (no delta function array is required).
+*
+*  Arguments:
+*    int_F(out):        value of integral of F over the zero level set
+*    F(in):             function to be integrated
+*    phi(in):           level set function
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    dx,dy,dz(in):     grid spacing
+*    index_[xyz](in):   [xyz] coordinates of local (narrow band) points
+*    n*_index    (in):  index range of points to loop over in index_*
+*    narrow_band(in):   array that marks voxels outside desired fillbox
+*    mark_fb(in):      upper limit narrow band value for voxels in 
+*                      fillbox
+*
+*  Notes: 
+*    - the narrow band should contain all points within 1 grid cell of
+*      the zero level set.
+*
+*/
+void LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2_LOCAL(
+  LSMLIB_REAL *int_F,
+  const LSMLIB_REAL *F,
+  const int *ilo_F_gb, 
+  const int *ihi_F_gb,
+  const int *jlo_F_gb, 
+  const int *jhi_F_gb,
+  const int *klo_F_gb, 
+  const int *khi_F_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index,
+  const int *nhi_index,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb);
+
+
+/*!
+*
+*  LSM3D_SURFACE_AREA_DELTA_ORDER2_LOCAL() computes the area of the zero
+*  level set using the second order accurate delta function evaluated on
+*  the fly at the local (narrow band) points (no delta function array is
+*  required).
+*
+*  Arguments:
+*    area(out):         area of the zero level set
+*    phi(in):           level set function
+*    norm_phi_* (in):   components of grad(phi)/|grad(phi)|, 
+*                       obtained by 2nd order central diff
+*    *_gb (in):        index range for ghostbox
+*    dx,dy,dz(in):     grid spacing
+*    index_[xyz](in):   [xyz] coordinates of local (narrow band) points
+*    n*_index    (in):  index range of points to loop over in index_*
+*    narrow_band(in):   array that marks voxels outside desired fillbox
+*    mark_fb(in):      upper limit narrow band value for voxels in 
+*                      fillbox
+*
+*  Notes: 
+*    - the narrow band should contain all points within 1 grid cell of
+*      the zero level set.
+*
+*/
+void LSM3D_SURFACE_AREA_DELTA_ORDER2_LOCAL(
+  LSMLIB_REAL *area,
+  const LSMLIB_REAL *phi,
+  const int *ilo_gb,
+  const int *ihi_gb,
+  const int *jlo_gb,
+  const int *jhi_gb, 
+  const int *klo_gb,
+  const int *khi_gb, 
+  const LSMLIB_REAL *norm_phi_x,
+  const LSMLIB_REAL *norm_phi_y,
+  const LSMLIB_REAL *norm_phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index,
+  const int *nhi_index,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,742 @@
+/*
+ * File:        lsm_csg3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for 3D constructive solid geometry
+ *              (CSG) initialization functions
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "lsm_csg3d.h"
+#include "lsm_runtime.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Structure 'LSM_CSGBrick' describes the grid points in a brick.
+ */
+typedef struct _LSM_CSGBrick
+{
+  int ilo, ihi, jlo, jhi, klo, khi;
+  int num_gridpts;
+  LSMLIB_REAL x_lo[3], x_hi[3];
+} LSM_CSGBrick;
+
+/*
+ * Structure 'LSM_CSGEvaluationArgs' holds the arguments shared by all
+ * threads during evaluateCSGTree3d().
+ */
+typedef struct _LSM_CSGEvaluationArgs
+{
+  LSMLIB_REAL        *phi;
+  const LSM_CSGNode  *root;
+  LSMLIB_REAL         band_width;
+  Grid               *grid;
+  int                 num_bricks[3];
+  LSMLIB_REAL       **scratch;   /* one buffer per thread */
+} LSM_CSGEvaluationArgs;
+
+
+/*
+ * allocateCSGNode() allocates a CSG node with infinite bounding box.
+ */
+static LSM_CSGNode *allocateCSGNode(LSM_CSGNodeType type)
+{
+  LSM_CSGNode *node = (LSM_CSGNode *) calloc(1, sizeof(LSM_CSGNode));
+  int dir;
+
+  if (!node) return NULL;
+  node->type = type;
+  node->depth = 1;
+  for (dir = 0; dir < 3; dir++) {
+    node->bbox_lo[dir] = -LSMLIB_REAL_MAX;
+    node->bbox_hi[dir] = LSMLIB_REAL_MAX;
+  }
+  return node;
+}
+
+
+/*
+ * createCSGOperation() creates an operation node that takes ownership
+ * of its children.
+ */
+static LSM_CSGNode *createCSGOperation(
+  LSM_CSGNodeType type,
+  LSM_CSGNode *a,
+  LSM_CSGNode *b)
+{
+  LSM_CSGNode *node;
+  int binary = (type != LSM_CSG_COMPLEMENT);
+
+  if ( (!a) || (binary && !b) ) {
+    destroyCSGTree(a);
+    destroyCSGTree(b);
+    return NULL;
+  }
+
+  node = allocateCSGNode(type);
+  if (!node) {
+    destroyCSGTree(a);
+    destroyCSGTree(b);
+    return NULL;
+  }
+
+  node->left = a;
+  node->right = b;
+  node->depth = a->depth + 1;
+  if (binary && (b->depth + 1 > node->depth)) node->depth = b->depth + 1;
+
+  return node;
+}
+
+
+/*
+ * csgFaceIsAboveBand() determines whether the signed distance to the
+ * plane with unit normal n through p is at least band_width at every
+ * point of a brick (the minimum over the brick is at a corner).
+ */
+static int csgFaceIsAboveBand(
+  const LSMLIB_REAL *n,
+  const LSMLIB_REAL *p,
+  const LSM_CSGBrick *brick,
+  LSMLIB_REAL band_width)
+{
+  LSMLIB_REAL min_dist = 0.0;
+  int dir;
+
+  for (dir = 0; dir < 3; dir++) {
+    LSMLIB_REAL x = (n[dir] > 0) ? brick->x_lo[dir] : brick->x_hi[dir];
+    min_dist += n[dir]*(x - p[dir]);
+  }
+  return (min_dist >= band_width);
+}
+
+
+/*
+ * csgNodeMayBeBelowBand() determines whether the level set function of
+ * a CSG subtree can be less than band_width within a brick.  The test
+ * is based on the bounding boxes of the primitives in the subtree and,
+ * for half-spaces and polyhedra, on the face planes (the level set
+ * function is at least the signed distance to each face plane).
+ */
+static int csgNodeMayBeBelowBand(
+  const LSM_CSGNode *node,
+  const LSM_CSGBrick *brick,
+  LSMLIB_REAL band_width)
+{
+  int dir;
+
+  switch (node->type) {
+    case LSM_CSG_UNION:
+      return csgNodeMayBeBelowBand(node->left, brick, band_width)
+          || csgNodeMayBeBelowBand(node->right, brick, band_width);
+
+    case LSM_CSG_INTERSECTION:
+      return csgNodeMayBeBelowBand(node->left, brick, band_width)
+          && csgNodeMayBeBelowBand(node->right, brick, band_width);
+
+    case LSM_CSG_DIFFERENCE:
+      return csgNodeMayBeBelowBand(node->left, brick, band_width);
+
+    case LSM_CSG_COMPLEMENT:
+      return 1;
+
+    case LSM_CSG_HALF_SPACE:
+      return !csgFaceIsAboveBand(node->params, node->params + 3,
+                                 brick, band_width);
+
+    case LSM_CSG_POLYHEDRON:
+      for (dir = 0; dir < node->num_faces; dir++) {
+        if (csgFaceIsAboveBand(node->face_normals + 3*dir,
+                               node->face_points + 3*dir,
+                               brick, band_width)) {
+          return 0;
+        }
+      }
+      return 1;
+
+    default:
+      /* primitives:  phi < band_width only within band_width of bbox */
+      for (dir = 0; dir < 3; dir++) {
+        if ( (brick->x_hi[dir] < node->bbox_lo[dir] - band_width) ||
+             (brick->x_lo[dir] > node->bbox_hi[dir] + band_width) ) {
+          return 0;
+        }
+      }
+      return 1;
+  }
+}
+
+
+/*
+ * evaluateCSGPrimitiveOnBrick() computes the level set function of a
+ * primitive at the grid points in a brick.
+ */
+static void evaluateCSGPrimitiveOnBrick(
+  const LSM_CSGNode *node,
+  const LSM_CSGBrick *brick,
+  const Grid *grid,
+  LSMLIB_REAL *values)
+{
+  const LSMLIB_REAL *p = node->params;
+  const LSMLIB_REAL *dx = grid->dx;
+  const LSMLIB_REAL *x_lo = grid->x_lo_ghostbox;
+  int i, j, k, l, m = 0;
+
+  for (k = brick->klo; k <= brick->khi; k++) {
+    LSMLIB_REAL z = x_lo[2] + dx[2]*k;
+    for (j = brick->jlo; j <= brick->jhi; j++) {
+      LSMLIB_REAL y = x_lo[1] + dx[1]*j;
+      LSMLIB_REAL *line = values + m;
+      int n = brick->ihi - brick->ilo + 1;
+
+      switch (node->type) {
+        case LSM_CSG_SPHERE:
+          for (i = 0; i < n; i++) {
+            LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+            line[i] = sqrt( (x-p[0])*(x-p[0]) + (y-p[1])*(y-p[1])
+                          + (z-p[2])*(z-p[2]) ) - p[3];
+          }
+          break;
+
+        case LSM_CSG_CYLINDER:
+          for (i = 0; i < n; i++) {
+            LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+            LSMLIB_REAL norm_sq_x_minus_p = (x-p[3])*(x-p[3])
+                                          + (y-p[4])*(y-p[4])
+                                          + (z-p[5])*(z-p[5]);
+            LSMLIB_REAL x_minus_p_dot_tangent = (x-p[3])*p[0]
+                                              + (y-p[4])*p[1]
+                                              + (z-p[5])*p[2];
+            LSMLIB_REAL dist_sq_to_axis = norm_sq_x_minus_p
+              - x_minus_p_dot_tangent*x_minus_p_dot_tangent;
+            if (dist_sq_to_axis < 0) dist_sq_to_axis = 0;
+            line[i] = sqrt(dist_sq_to_axis) - p[6];
+          }
+          break;
+
+        case LSM_CSG_BOX:
+          for (i = 0; i < n; i++) {
+            LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+            LSMLIB_REAL max = p[0] - x;
+            if (x - p[3] > max) max = x - p[3];
+            if (p[1] - y > max) max = p[1] - y;
+            if (y - p[4] > max) max = y - p[4];
+            if (p[2] - z > max) max = p[2] - z;
+            if (z - p[5] > max) max = z - p[5];
+            line[i] = max;
+          }
+          break;
+
+        case LSM_CSG_HALF_SPACE:
+          for (i = 0; i < n; i++) {
+            LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+            line[i] = (x-p[3])*p[0] + (y-p[4])*p[1] + (z-p[5])*p[2];
+          }
+          break;
+
+        case LSM_CSG_CONE:
+        case LSM_CSG_HYPERBOLOID:
+          for (i = 0; i < n; i++) {
+            LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+            LSMLIB_REAL norm_sq_x_minus_center = (x-p[3])*(x-p[3])
+                                               + (y-p[4])*(y-p[4])
+                                               + (z-p[5])*(z-p[5]);
+            LSMLIB_REAL dist_along_axis = (x-p[3])*p[0] + (y-p[4])*p[1]
+                                        + (z-p[5])*p[2];
+            LSMLIB_REAL sq_dist_to_axis = norm_sq_x_minus_center
+              - dist_along_axis*dist_along_axis;
+            if (sq_dist_to_axis < 0) sq_dist_to_axis = 0;
+            line[i] = - dist_along_axis*dist_along_axis/p[6]/p[6]
+                      + sq_dist_to_axis/p[7]/p[7];
+            if (node->type == LSM_CSG_HYPERBOLOID) line[i] -= 1;
+          }
+          break;
+
+        case LSM_CSG_POLYHEDRON:
+          for (i = 0; i < n; i++) line[i] = -LSMLIB_REAL_MAX;
+          for (l = 0; l < node->num_faces; l++) {
+            const LSMLIB_REAL *normal = node->face_normals + 3*l;
+            const LSMLIB_REAL *point = node->face_points + 3*l;
+            LSMLIB_REAL yz_part = (y-point[1])*normal[1]
+                                + (z-point[2])*normal[2];
+            for (i = 0; i < n; i++) {
+              LSMLIB_REAL x = x_lo[0] + dx[0]*(brick->ilo + i);
+              LSMLIB_REAL dist = (x-point[0])*normal[0] + yz_part;
+              if (dist > line[i]) line[i] = dist;
+            }
+          }
+          break;
+
+        default:
+          break;
+      }
+
+      m += n;
+    }
+  }
+}
+
+
+/*
+ * evaluateCSGNodeOnBrick() computes the level set function of a CSG
+ * subtree at the grid points in a brick.
+ *
+ * Return value:  1 if the subtree was culled and the level set function
+ *                is represented by the constant values[0]; 0 if values
+ *                contains the level set function at every grid point
+ *
+ * NOTES:
+ *  - scratch must have room for (node->depth - 1)*brick->num_gridpts
+ *    values.
+ */
+static int evaluateCSGNodeOnBrick(
+  const LSM_CSGNode *node,
+  const LSM_CSGBrick *brick,
+  const Grid *grid,
+  LSMLIB_REAL band_width,
+  LSMLIB_REAL *values,
+  LSMLIB_REAL *scratch)
+{
+  const int n = brick->num_gridpts;
+  LSMLIB_REAL *a, *b;
+  int a_is_const, b_is_const;
+  int m;
+
+  /* cull subtrees that are at least band_width from the brick */
+  if ( (band_width > 0) &&
+       !csgNodeMayBeBelowBand(node, brick, band_width) ) {
+    values[0] = band_width;
+    return 1;
+  }
+
+  switch (node->type) {
+    case LSM_CSG_COMPLEMENT:
+      a_is_const = evaluateCSGNodeOnBrick(node->left, brick, grid,
+                                          band_width, values, scratch);
+      if (a_is_const) {
+        values[0] = -values[0];
+      } else {
+        for (m = 0; m < n; m++) values[m] = -values[m];
+      }
+      return a_is_const;
+
+    case LSM_CSG_UNION:
+    case LSM_CSG_INTERSECTION:
+    case LSM_CSG_DIFFERENCE:
+      a = values;
+      b = scratch;
+      a_is_const = evaluateCSGNodeOnBrick(node->left, brick, grid,
+                                          band_width, a, scratch);
+      b_is_const = evaluateCSGNodeOnBrick(node->right, brick, grid,
+                                          band_width, b, scratch + n);
+
+      /* difference is the intersection with the complement */
+      if (node->type == LSM_CSG_DIFFERENCE) {
+        if (b_is_const) {
+          b[0] = -b[0];
+        } else {
+          for (m = 0; m < n; m++) b[m] = -b[m];
+        }
+      }
+
+      /* order operands so that a constant operand (if any) is b */
+      if (a_is_const && !b_is_const) {
+        LSMLIB_REAL a_const = a[0];
+        for (m = 0; m < n; m++) a[m] = b[m];
+        b[0] = a_const;
+        a_is_const = 0;
+        b_is_const = 1;
+      }
+
+      if (node->type == LSM_CSG_UNION) {
+        if (a_is_const) {
+          if (b[0] < a[0]) a[0] = b[0];
+        } else if (b_is_const) {
+          LSMLIB_REAL b_const = b[0];
+          for (m = 0; m < n; m++) if (b_const < a[m]) a[m] = b_const;
+        } else {
+          for (m = 0; m < n; m++) if (b[m] < a[m]) a[m] = b[m];
+        }
+      } else {
+        if (a_is_const) {
+          if (b[0] > a[0]) a[0] = b[0];
+        } else if (b_is_const) {
+          LSMLIB_REAL b_const = b[0];
+          for (m = 0; m < n; m++) if (b_const > a[m]) a[m] = b_const;
+        } else {
+          for (m = 0; m < n; m++) if (b[m] > a[m]) a[m] = b[m];
+        }
+      }
+      return a_is_const;
+
+    default:
+      evaluateCSGPrimitiveOnBrick(node, brick, grid, values);
+      return 0;
+  }
+}
+
+
+/*
+ * evaluateCSGBricks() is the LSM_Runtime_parallelFor() body for
+ * evaluateCSGTree3d().
+ */
+static void evaluateCSGBricks(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_CSGEvaluationArgs *args = (LSM_CSGEvaluationArgs *) user_data;
+  Grid *grid = args->grid;
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  const int brick_size[3] = {LSM_CSG_BRICK_SIZE_X,
+                             LSM_CSG_BRICK_SIZE_Y,
+                             LSM_CSG_BRICK_SIZE_Z};
+  LSMLIB_REAL *values = args->scratch[thread_num];
+  LSMLIB_REAL *scratch = values
+    + LSM_CSG_BRICK_SIZE_X*LSM_CSG_BRICK_SIZE_Y*LSM_CSG_BRICK_SIZE_Z;
+  int brick_idx;
+
+  for (brick_idx = begin; brick_idx < end; brick_idx++) {
+    LSM_CSGBrick brick;
+    int brick_coords[3], lo[3], hi[3];
+    int dir, i, j, k, m, is_const;
+
+    brick_coords[0] = brick_idx % args->num_bricks[0];
+    brick_coords[1] = (brick_idx / args->num_bricks[0])
+                    % args->num_bricks[1];
+    brick_coords[2] = brick_idx / (args->num_bricks[0]*args->num_bricks[1]);
+    for (dir = 0; dir < 3; dir++) {
+      lo[dir] = brick_coords[dir]*brick_size[dir];
+      hi[dir] = lo[dir] + brick_size[dir] - 1;
+      if (hi[dir] > grid->grid_dims_ghostbox[dir] - 1) {
+        hi[dir] = grid->grid_dims_ghostbox[dir] - 1;
+      }
+      brick.x_lo[dir] = grid->x_lo_ghostbox[dir] + grid->dx[dir]*lo[dir];
+      brick.x_hi[dir] = grid->x_lo_ghostbox[dir] + grid->dx[dir]*hi[dir];
+    }
+    brick.ilo = lo[0]; brick.ihi = hi[0];
+    brick.jlo = lo[1]; brick.jhi = hi[1];
+    brick.klo = lo[2]; brick.khi = hi[2];
+    brick.num_gridpts = (hi[0]-lo[0]+1)*(hi[1]-lo[1]+1)*(hi[2]-lo[2]+1);
+
+    is_const = evaluateCSGNodeOnBrick(args->root, &brick, grid,
+                                      args->band_width, values, scratch);
+
+    /* copy brick data into phi */
+    m = 0;
+    for (k = brick.klo; k <= brick.khi; k++) {
+      for (j = brick.jlo; j <= brick.jhi; j++) {
+        LSMLIB_REAL *phi_line = args->phi + j*nx + k*nxy;
+        if (is_const) {
+          for (i = brick.ilo; i <= brick.ihi; i++) phi_line[i] = values[0];
+        } else {
+          for (i = brick.ilo; i <= brick.ihi; i++) {
+            phi_line[i] = values[m++];
+          }
+        }
+      }
+    }
+  }
+}
+
+
+/*
+ * createCSGQuadric() creates a cone or hyperboloid node.
+ */
+static LSM_CSGNode *createCSGQuadric(
+  LSM_CSGNodeType type,
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL alpha, LSMLIB_REAL beta)
+{
+  LSM_CSGNode *node;
+  LSMLIB_REAL norm = sqrt( tangent_x*tangent_x + tangent_y*tangent_y
+                         + tangent_z*tangent_z );
+
+  if ( (norm == 0) || (alpha == 0) || (beta == 0) ) return NULL;
+
+  node = allocateCSGNode(type);
+  if (!node) return NULL;
+
+  node->params[0] = tangent_x/norm;
+  node->params[1] = tangent_y/norm;
+  node->params[2] = tangent_z/norm;
+  node->params[3] = center_x;
+  node->params[4] = center_y;
+  node->params[5] = center_z;
+  node->params[6] = alpha;
+  node->params[7] = beta;
+
+  return node;
+}
+
+
+/*========================== CSG Primitives ==========================*/
+
+LSM_CSGNode *createCSGSphere(
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL radius)
+{
+  LSM_CSGNode *node = allocateCSGNode(LSM_CSG_SPHERE);
+  if (!node) return NULL;
+
+  node->params[0] = center_x;
+  node->params[1] = center_y;
+  node->params[2] = center_z;
+  node->params[3] = radius;
+
+  node->bbox_lo[0] = center_x - radius;  node->bbox_hi[0] = center_x + radius;
+  node->bbox_lo[1] = center_y - radius;  node->bbox_hi[1] = center_y + radius;
+  node->bbox_lo[2] = center_z - radius;  node->bbox_hi[2] = center_z + radius;
+
+  return node;
+}
+
+
+LSM_CSGNode *createCSGCylinder(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL point_x, LSMLIB_REAL point_y, LSMLIB_REAL point_z,
+  LSMLIB_REAL radius)
+{
+  LSM_CSGNode *node;
+  LSMLIB_REAL norm = sqrt( tangent_x*tangent_x + tangent_y*tangent_y
+                         + tangent_z*tangent_z );
+
+  if (norm == 0) return NULL;
+
+  node = allocateCSGNode(LSM_CSG_CYLINDER);
+  if (!node) return NULL;
+
+  node->params[0] = tangent_x/norm;
+  node->params[1] = tangent_y/norm;
+  node->params[2] = tangent_z/norm;
+  node->params[3] = point_x;
+  node->params[4] = point_y;
+  node->params[5] = point_z;
+  node->params[6] = radius;
+
+  return node;
+}
+
+
+LSM_CSGNode *createCSGBox(
+  LSMLIB_REAL corner_x, LSMLIB_REAL corner_y, LSMLIB_REAL corner_z,
+  LSMLIB_REAL side_length_x, LSMLIB_REAL side_length_y,
+  LSMLIB_REAL side_length_z)
+{
+  LSM_CSGNode *node = allocateCSGNode(LSM_CSG_BOX);
+  int dir;
+
+  if (!node) return NULL;
+
+  node->params[0] = corner_x;
+  node->params[1] = corner_y;
+  node->params[2] = corner_z;
+  node->params[3] = corner_x + side_length_x;
+  node->params[4] = corner_y + side_length_y;
+  node->params[5] = corner_z + side_length_z;
+
+  for (dir = 0; dir < 3; dir++) {
+    node->bbox_lo[dir] = node->params[dir];
+    node->bbox_hi[dir] = node->params[dir+3];
+  }
+
+  return node;
+}
+
+
+LSM_CSGNode *createCSGHalfSpace(
+  LSMLIB_REAL normal_x, LSMLIB_REAL normal_y, LSMLIB_REAL normal_z,
+  LSMLIB_REAL point_x, LSMLIB_REAL point_y, LSMLIB_REAL point_z)
+{
+  LSM_CSGNode *node;
+  LSMLIB_REAL norm = sqrt( normal_x*normal_x + normal_y*normal_y
+                         + normal_z*normal_z );
+
+  if (norm == 0) return NULL;
+
+  node = allocateCSGNode(LSM_CSG_HALF_SPACE);
+  if (!node) return NULL;
+
+  node->params[0] = normal_x/norm;
+  node->params[1] = normal_y/norm;
+  node->params[2] = normal_z/norm;
+  node->params[3] = point_x;
+  node->params[4] = point_y;
+  node->params[5] = point_z;
+
+  return node;
+}
+
+
+LSM_CSGNode *createCSGPolyhedron(
+  int num_faces,
+  const LSMLIB_REAL *normal_x, const LSMLIB_REAL *normal_y,
+  const LSMLIB_REAL *normal_z,
+  const LSMLIB_REAL *point_x, const LSMLIB_REAL *point_y,
+  const LSMLIB_REAL *point_z)
+{
+  LSM_CSGNode *node;
+  int l;
+
+  if ( (num_faces < 1) || (!normal_x) || (!normal_y) || (!normal_z) ||
+       (!point_x) || (!point_y) || (!point_z) ) {
+    return NULL;
+  }
+
+  node = allocateCSGNode(LSM_CSG_POLYHEDRON);
+  if (!node) return NULL;
+
+  node->num_faces = num_faces;
+  node->face_normals =
+    (LSMLIB_REAL *) malloc(3*num_faces*sizeof(LSMLIB_REAL));
+  node->face_points =
+    (LSMLIB_REAL *) malloc(3*num_faces*sizeof(LSMLIB_REAL));
+  if ( (!node->face_normals) || (!node->face_points) ) {
+    destroyCSGTree(node);
+    return NULL;
+  }
+
+  for (l = 0; l < num_faces; l++) {
+    LSMLIB_REAL norm = sqrt( normal_x[l]*normal_x[l]
+                           + normal_y[l]*normal_y[l]
+                           + normal_z[l]*normal_z[l] );
+    if (norm == 0) {
+      destroyCSGTree(node);
+      return NULL;
+    }
+    node->face_normals[3*l]   = normal_x[l]/norm;
+    node->face_normals[3*l+1] = normal_y[l]/norm;
+    node->face_normals[3*l+2] = normal_z[l]/norm;
+    node->face_points[3*l]    = point_x[l];
+    node->face_points[3*l+1]  = point_y[l];
+    node->face_points[3*l+2]  = point_z[l];
+  }
+
+  return node;
+}
+
+
+LSM_CSGNode *createCSGCone(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL alpha, LSMLIB_REAL beta)
+{
+  return createCSGQuadric(LSM_CSG_CONE, tangent_x, tangent_y, tangent_z,
+                          center_x, center_y, center_z, alpha, beta);
+}
+
+
+LSM_CSGNode *createCSGHyperboloid(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL alpha, LSMLIB_REAL beta)
+{
+  return createCSGQuadric(LSM_CSG_HYPERBOLOID,
+                          tangent_x, tangent_y, tangent_z,
+                          center_x, center_y, center_z, alpha, beta);
+}
+
+
+/*========================== CSG Operations ==========================*/
+
+LSM_CSGNode *createCSGUnion(LSM_CSGNode *a, LSM_CSGNode *b)
+{
+  return createCSGOperation(LSM_CSG_UNION, a, b);
+}
+
+
+LSM_CSGNode *createCSGIntersection(LSM_CSGNode *a, LSM_CSGNode *b)
+{
+  return createCSGOperation(LSM_CSG_INTERSECTION, a, b);
+}
+
+
+LSM_CSGNode *createCSGDifference(LSM_CSGNode *a, LSM_CSGNode *b)
+{
+  return createCSGOperation(LSM_CSG_DIFFERENCE, a, b);
+}
+
+
+LSM_CSGNode *createCSGComplement(LSM_CSGNode *a)
+{
+  return createCSGOperation(LSM_CSG_COMPLEMENT, a, NULL);
+}
+
+
+void destroyCSGTree(LSM_CSGNode *root)
+{
+  if (!root) return;
+
+  destroyCSGTree(root->left);
+  destroyCSGTree(root->right);
+  free(root->face_normals);
+  free(root->face_points);
+  free(root);
+}
+
+
+/*========================== CSG Evaluation ==========================*/
+
+int evaluateCSGTree3d(
+  LSMLIB_REAL *phi,
+  const LSM_CSGNode *root,
+  LSMLIB_REAL band_width,
+  Grid *grid)
+{
+  LSM_CSGEvaluationArgs args;
+  const int brick_size[3] = {LSM_CSG_BRICK_SIZE_X,
+                             LSM_CSG_BRICK_SIZE_Y,
+                             LSM_CSG_BRICK_SIZE_Z};
+  const int max_brick_gridpts =
+    LSM_CSG_BRICK_SIZE_X*LSM_CSG_BRICK_SIZE_Y*LSM_CSG_BRICK_SIZE_Z;
+  LSMLIB_REAL *scratch_data;
+  int num_threads, total_num_bricks;
+  int dir, t;
+
+  if ( (!phi) || (!root) || (!grid) ) return LSM_CSG_ERR_INVALID_ARGUMENT;
+
+  /* per-thread brick buffers:  one for the result and one for each */
+  /* level of the tree below the root                               */
+  num_threads = LSM_Runtime_getNumThreads();
+  args.scratch = (LSMLIB_REAL **) malloc(num_threads*sizeof(LSMLIB_REAL *));
+  scratch_data = (LSMLIB_REAL *) malloc(
+    num_threads*root->depth*max_brick_gridpts*sizeof(LSMLIB_REAL));
+  if ( (!args.scratch) || (!scratch_data) ) {
+    free(args.scratch);
+    free(scratch_data);
+    return LSM_CSG_ERR_MEMORY_ALLOCATION;
+  }
+  for (t = 0; t < num_threads; t++) {
+    args.scratch[t] = scratch_data + t*root->depth*max_brick_gridpts;
+  }
+
+  args.phi = phi;
+  args.root = root;
+  args.band_width = band_width;
+  args.grid = grid;
+  total_num_bricks = 1;
+  for (dir = 0; dir < 3; dir++) {
+    args.num_bricks[dir] =
+      (grid->grid_dims_ghostbox[dir] + brick_size[dir] - 1)/brick_size[dir];
+    total_num_bricks *= args.num_bricks[dir];
+  }
+
+  LSM_Runtime_parallelFor(0, total_num_bricks, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                          evaluateCSGBricks, &args);
+
+  free(scratch_data);
+  free(args.scratch);
+
+  return LSM_CSG_ERR_SUCCESS;
+}
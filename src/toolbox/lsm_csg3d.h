@@ -0,0 +1,419 @@
+/*
+ * File:        lsm_csg3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for 3D constructive solid geometry (CSG)
+ *              initialization functions
+ */
+
+#ifndef included_lsm_csg3d_h
+#define included_lsm_csg3d_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_csg3d.h
+ *
+ * \brief
+ * @ref lsm_csg3d.h provides support for building level set functions
+ * for complex geometries from constructive solid geometry (CSG)
+ * expressions over simple primitives (spheres, cylinders, boxes,
+ * half-spaces, polyhedra, cones and hyperboloids).
+ *
+ * Unlike the functions in @ref lsm_initialization3d.h, which require one
+ * grid-sized array and one pass over the grid per primitive, a CSG tree
+ * is evaluated in a single pass over the grid.  The grid is divided
+ * into bricks that are distributed across the threads of the LSMLIB
+ * runtime (see @ref lsm_runtime.h).  Within each brick, the tree is
+ * evaluated with brick-sized temporary arrays, and subtrees whose
+ * bounding boxes do not intersect the brick are skipped.
+ *
+ * The level set function for each primitive is negative inside the
+ * primitive.  CSG operations are implemented as:
+ *
+ * - union:         min(phi_a, phi_b)
+ * - intersection:  max(phi_a, phi_b)
+ * - difference:    max(phi_a, -phi_b)
+ * - complement:    -phi_a
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Build the CSG tree from primitives (e.g. createCSGSphere()) and
+ *    operations (e.g. createCSGUnion()).  Operation nodes take
+ *    ownership of their children.
+ * -# Evaluate the tree on a grid using evaluateCSGTree3d().
+ * -# Free the tree using destroyCSGTree().
+ *
+ */
+
+
+/*!
+ * Error codes returned by CSG functions.
+ */
+#define LSM_CSG_ERR_SUCCESS                         (0)
+#define LSM_CSG_ERR_INVALID_ARGUMENT                (1)
+#define LSM_CSG_ERR_MEMORY_ALLOCATION               (2)
+
+/*!
+ * Number of grid points in each coordinate direction of the bricks
+ * used by evaluateCSGTree3d().
+ */
+#define LSM_CSG_BRICK_SIZE_X                        (32)
+#define LSM_CSG_BRICK_SIZE_Y                        (8)
+#define LSM_CSG_BRICK_SIZE_Z                        (8)
+
+/*!
+ * Types of CSG tree nodes.
+ */
+typedef enum {
+  LSM_CSG_SPHERE,
+  LSM_CSG_CYLINDER,
+  LSM_CSG_BOX,
+  LSM_CSG_HALF_SPACE,
+  LSM_CSG_POLYHEDRON,
+  LSM_CSG_UNION,
+  LSM_CSG_INTERSECTION,
+  LSM_CSG_DIFFERENCE,
+  LSM_CSG_COMPLEMENT,
+  LSM_CSG_CONE,
+  LSM_CSG_HYPERBOLOID
+} LSM_CSGNodeType;
+
+/*!
+ * Structure 'LSM_CSGNode' is a node of a CSG tree.
+ */
+typedef struct _LSM_CSGNode
+{
+  LSM_CSGNodeType      type;
+
+  /* primitive parameters:                                             */
+  /*   sphere:      center (0-2), radius (3)                           */
+  /*   cylinder:    unit tangent (0-2), point on axis (3-5), radius (6) */
+  /*   box:         lower corner (0-2), upper corner (3-5)             */
+  /*   half-space:  unit normal (0-2), point on plane (3-5)            */
+  /*   cone,                                                          */
+  /*   hyperboloid: unit tangent (0-2), center (3-5), alpha (6),      */
+  /*                beta (7)                                          */
+  LSMLIB_REAL          params[8];
+
+  /* polyhedron faces (unit normals and points on planes) */
+  int                  num_faces;
+  LSMLIB_REAL         *face_normals;   /* 3*num_faces */
+  LSMLIB_REAL         *face_points;    /* 3*num_faces */
+
+  /* children of operation nodes (right is NULL for complement) */
+  struct _LSM_CSGNode *left;
+  struct _LSM_CSGNode *right;
+
+  /* bounding box of the region where phi < 0 (primitives only);   */
+  /* infinite extents are represented by -LSMLIB_REAL_MAX and       */
+  /* LSMLIB_REAL_MAX                                                */
+  LSMLIB_REAL          bbox_lo[3];
+  LSMLIB_REAL          bbox_hi[3];
+
+  /* height of the subtree rooted at this node (1 for primitives) */
+  int                  depth;
+
+} LSM_CSGNode;
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Primitives
+ *
+ ****************************************************************/
+
+/*!
+ * createCSGSphere() creates a CSG node for a solid sphere.
+ *
+ * Arguments:
+ *  - center_x, center_y, center_z (in):  center of the sphere
+ *  - radius (in):                        radius of the sphere
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the signed distance function for the sphere (see
+ *    createSphere()).
+ *
+ */
+LSM_CSGNode *createCSGSphere(
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL radius);
+
+/*!
+ * createCSGCylinder() creates a CSG node for a solid, infinitely long
+ * cylinder with an arbitrary axis.
+ *
+ * Arguments:
+ *  - tangent_x, tangent_y, tangent_z (in):  direction of the axis
+ *  - point_x, point_y, point_z (in):        point on the axis
+ *  - radius (in):                           radius of the cylinder
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the signed distance function for the cylinder (see
+ *    createCylinder()).  Finite cylinders may be constructed by
+ *    intersecting a cylinder with half-spaces.
+ *
+ */
+LSM_CSGNode *createCSGCylinder(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL point_x, LSMLIB_REAL point_y, LSMLIB_REAL point_z,
+  LSMLIB_REAL radius);
+
+/*!
+ * createCSGBox() creates a CSG node for a solid cuboid with faces
+ * parallel to the coordinate axes.
+ *
+ * Arguments:
+ *  - corner_x, corner_y, corner_z (in):  lower corner of the cuboid
+ *  - side_length_x, side_length_y,
+ *    side_length_z (in):                 side lengths of the cuboid
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the same level set function as the one computed by
+ *    createBox().
+ *
+ */
+LSM_CSGNode *createCSGBox(
+  LSMLIB_REAL corner_x, LSMLIB_REAL corner_y, LSMLIB_REAL corner_z,
+  LSMLIB_REAL side_length_x, LSMLIB_REAL side_length_y,
+  LSMLIB_REAL side_length_z);
+
+/*!
+ * createCSGHalfSpace() creates a CSG node for the half-space
+ *
+ *     normal_x * (x - point_x) + normal_y * (y - point_y)
+ *   + normal_z * (z - point_z) < 0
+ *
+ * Arguments:
+ *  - normal_x, normal_y, normal_z (in):  outward normal of the plane
+ *  - point_x, point_y, point_z (in):     point on the plane
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ */
+LSM_CSGNode *createCSGHalfSpace(
+  LSMLIB_REAL normal_x, LSMLIB_REAL normal_y, LSMLIB_REAL normal_z,
+  LSMLIB_REAL point_x, LSMLIB_REAL point_y, LSMLIB_REAL point_z);
+
+/*!
+ * createCSGPolyhedron() creates a CSG node for the (possibly unbounded)
+ * polyhedron given by the intersection of num_faces half-spaces.
+ *
+ * Arguments:
+ *  - num_faces (in):                  number of faces of polyhedron
+ *  - normal_x, normal_y, normal_z
+ *    (in):                            arrays containing the outward
+ *                                     normals of the faces
+ *  - point_x, point_y, point_z (in):  arrays containing points that lie
+ *                                     on the faces
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the same level set function as the one computed by
+ *    createPolyhedron3d().
+ *
+ *  - The face data are copied into the node.
+ *
+ *  - The bounding box is left infinite; evaluateCSGTree3d() instead
+ *    culls the polyhedron in bricks that lie at least band_width on
+ *    the outer side of one of its face planes.  (The box of the
+ *    vertices is not used because the level set function, the maximum
+ *    of the distances to the face planes, can be less than band_width
+ *    more than band_width outside of it near sharp vertices.)
+ *
+ */
+LSM_CSGNode *createCSGPolyhedron(
+  int num_faces,
+  const LSMLIB_REAL *normal_x, const LSMLIB_REAL *normal_y,
+  const LSMLIB_REAL *normal_z,
+  const LSMLIB_REAL *point_x, const LSMLIB_REAL *point_y,
+  const LSMLIB_REAL *point_z);
+
+/*!
+ * createCSGCone() creates a CSG node for the solid double cone around
+ * an arbitrary axis.  In a coordinate frame where s is the coordinate
+ * along the axis measured from the center of the cone and t is the
+ * distance from the axis, the cone is the region
+ *
+ *   - s^2/alpha^2 + t^2/beta^2 < 0
+ *
+ * Arguments:
+ *  - tangent_x, tangent_y, tangent_z (in):  direction of the axis
+ *  - center_x, center_y, center_z (in):     center (apex) of the cone
+ *  - alpha, beta (in):                      coefficients of the cone
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the same level set function as the one computed by
+ *    createCone() with inside_flag < 0.
+ *
+ */
+LSM_CSGNode *createCSGCone(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL alpha, LSMLIB_REAL beta);
+
+/*!
+ * createCSGHyperboloid() creates a CSG node for the solid one-sheet
+ * hyperboloid around an arbitrary axis.  In a coordinate frame where s
+ * is the coordinate along the axis measured from the center of the
+ * hyperboloid and t is the distance from the axis, the hyperboloid is
+ * the region
+ *
+ *   - s^2/alpha^2 + t^2/beta^2 - 1 < 0
+ *
+ * Arguments:
+ *  - tangent_x, tangent_y, tangent_z (in):  direction of the axis
+ *  - center_x, center_y, center_z (in):     center of the hyperboloid
+ *  - alpha, beta (in):                      coefficients of the
+ *                                           hyperboloid
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - phi is the same level set function as the one computed by
+ *    createHyperboloid() with inside_flag < 0.
+ *
+ */
+LSM_CSGNode *createCSGHyperboloid(
+  LSMLIB_REAL tangent_x, LSMLIB_REAL tangent_y, LSMLIB_REAL tangent_z,
+  LSMLIB_REAL center_x, LSMLIB_REAL center_y, LSMLIB_REAL center_z,
+  LSMLIB_REAL alpha, LSMLIB_REAL beta);
+
+/*! @} */
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Operations
+ *
+ ****************************************************************/
+
+/*!
+ * createCSGUnion(), createCSGIntersection() and createCSGDifference()
+ * create CSG nodes for the union, intersection and difference (a minus
+ * b) of two CSG trees.
+ *
+ * Arguments:
+ *  - a (in):  first operand
+ *  - b (in):  second operand
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - The new node takes ownership of a and b.  On failure (including
+ *    a NULL operand), the operands are destroyed, so nested calls
+ *    (e.g. createCSGUnion(createCSGSphere(...), createCSGBox(...)))
+ *    do not leak memory.
+ *
+ */
+LSM_CSGNode *createCSGUnion(LSM_CSGNode *a, LSM_CSGNode *b);
+
+LSM_CSGNode *createCSGIntersection(LSM_CSGNode *a, LSM_CSGNode *b);
+
+LSM_CSGNode *createCSGDifference(LSM_CSGNode *a, LSM_CSGNode *b);
+
+/*!
+ * createCSGComplement() creates a CSG node for the complement of a CSG
+ * tree.
+ *
+ * Arguments:
+ *  - a (in):  operand
+ *
+ * Return value:  pointer to new LSM_CSGNode (NULL on failure)
+ *
+ * NOTES:
+ *  - The new node takes ownership of a (see createCSGUnion()).
+ *
+ */
+LSM_CSGNode *createCSGComplement(LSM_CSGNode *a);
+
+/*!
+ * destroyCSGTree() frees the memory associated with a CSG tree.
+ *
+ * Arguments:
+ *  - root (in):  root of the CSG tree
+ *
+ * Return value:  none
+ *
+ */
+void destroyCSGTree(LSM_CSGNode *root);
+
+/*! @} */
+
+
+/*! @{
+ ****************************************************************
+ *
+ * @name Evaluation
+ *
+ ****************************************************************/
+
+/*!
+ * evaluateCSGTree3d() sets phi to be the level set function of a CSG
+ * tree.
+ *
+ * Arguments:
+ *  - phi (out):         level set function
+ *  - root (in):         root of the CSG tree
+ *  - band_width (in):   width of the band around the zero level set
+ *                       where phi is computed exactly; set to 0 (or a
+ *                       negative number) to compute phi exactly
+ *                       everywhere
+ *  - grid (in):         pointer to Grid data structure
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - phi is set on the entire ghostbox.
+ *
+ *  - When band_width > 0, a subtree is skipped in a brick when the
+ *    brick does not intersect the bounding box of the region where the
+ *    level set function of the subtree is less than band_width.  In
+ *    this case, phi is exact at grid points where |phi| < band_width
+ *    and has the correct sign and |phi| >= band_width elsewhere, which
+ *    is sufficient for narrow band calculations and for
+ *    reinitialization.
+ *
+ *  - Spheres and boxes have finite bounding boxes.  Half-spaces and
+ *    polyhedra are culled using their face planes.  Cylinders, cones,
+ *    hyperboloids and complements are never culled; they may be bounded
+ *    by intersecting them with a bounded subtree.
+ *
+ *  - Is it the user's responsbility to ensure that memory for phi
+ *    has been allocated.
+ *
+ */
+int evaluateCSGTree3d(
+  LSMLIB_REAL *phi,
+  const LSM_CSGNode *root,
+  LSMLIB_REAL band_width,
+  Grid *grid);
+
+/*! @} */
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,474 @@
+/*
+ * File:        lsm_curve_evolution3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for narrow-band evolution of curves
+ *              in 3D
+ */
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "lsm_curve_evolution3d.h"
+#include "lsm_level_set_evolution3d_local.h"
+#include "lsm_localization3d.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_reinitialization3d_local.h"
+#include "lsm_spatial_derivatives3d_local.h"
+#include "lsm_tvd_runge_kutta3d_local.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Number of real work arrays of a tube.
+ */
+#define LSM_CURVE_TUBE_NUM_REAL_ARRAYS              (21)
+
+
+/*
+ * eulerStep() sets u = u + dt*rhs at the level 0 points of the tube
+ * (forward Euler step with LSM3D_RK1_STEP_LOCAL()).
+ */
+static void eulerStep(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *u,
+  LSMLIB_REAL dt)
+{
+  const Grid *g = tube->grid;
+
+  LSM3D_COPY_DATA_LOCAL(
+    tube->u_next, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    u, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0]);
+  LSM3D_RK1_STEP_LOCAL(
+    tube->u_next, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    u, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    tube->rhs, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &dt,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0],
+    tube->narrow_band, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &g->mark_fb);
+  LSM3D_COPY_DATA_LOCAL(
+    u, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    tube->u_next, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0]);
+}
+
+
+/*
+ * computeENO1Derivatives() computes the forward and backward first-order
+ * HJ ENO derivatives of u at the level 0 points of the tube.
+ */
+static void computeENO1Derivatives(
+  LSM_CurveTube3d *tube,
+  const LSMLIB_REAL *u,
+  LSMLIB_REAL *u_x_plus,
+  LSMLIB_REAL *u_y_plus,
+  LSMLIB_REAL *u_z_plus,
+  LSMLIB_REAL *u_x_minus,
+  LSMLIB_REAL *u_y_minus,
+  LSMLIB_REAL *u_z_minus)
+{
+  const Grid *g = tube->grid;
+
+  LSM3D_HJ_ENO1_LOCAL(
+    u_x_plus, u_y_plus, u_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    u_x_minus, u_y_minus, u_z_minus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    u,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->D1,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0], &tube->n_lo[1], &tube->n_hi[1],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_fb, &g->mark_D1);
+}
+
+
+/*
+ * advectInTube() advances u by one forward Euler step of
+ * u_t + V . grad(u) = 0 with the curve velocity V in tube->vel_*.
+ */
+static void advectInTube(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *u,
+  LSMLIB_REAL dt)
+{
+  const Grid *g = tube->grid;
+
+  LSM3D_ZERO_OUT_LEVEL_SET_EQN_RHS_LOCAL(
+    tube->rhs,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0]);
+  LSM3D_UPWIND_HJ_ENO1_LOCAL(
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    u,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->vel_x, tube->vel_y, tube->vel_z,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->D1,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0], &tube->n_lo[1], &tube->n_hi[1],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_fb, &g->mark_D1);
+  LSM3D_ADD_ADVECTION_TERM_TO_LSE_RHS_LOCAL(
+    tube->rhs,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->vel_x, tube->vel_y, tube->vel_z,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_fb);
+  eulerStep(tube, u, dt);
+}
+
+
+/*
+ * reinitializeInTube() performs one pseudo-time step of the
+ * reinitialization equation for u.
+ */
+static void reinitializeInTube(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *u,
+  LSMLIB_REAL dt)
+{
+  const Grid *g = tube->grid;
+  int use_phi0_for_sgn = 0;
+
+  computeENO1Derivatives(tube, u,
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    tube->u_x_minus, tube->u_y_minus, tube->u_z_minus);
+  LSM3D_COMPUTE_REINITIALIZATION_EQN_RHS_LOCAL(
+    tube->rhs,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    u,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    u,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->u_x_minus, tube->u_y_minus, tube->u_z_minus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    &use_phi0_for_sgn,
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_fb);
+  eulerStep(tube, u, dt);
+}
+
+
+/*
+ * orthogonalizeInTube() performs one pseudo-time step of the
+ * orthogonalization equation that makes the level sets of u orthogonal
+ * to the level sets of v.
+ */
+static void orthogonalizeInTube(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *u,
+  const LSMLIB_REAL *v,
+  LSMLIB_REAL dt)
+{
+  const Grid *g = tube->grid;
+
+  computeENO1Derivatives(tube, u,
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    tube->u_x_minus, tube->u_y_minus, tube->u_z_minus);
+  computeENO1Derivatives(tube, v,
+    tube->v_x_plus, tube->v_y_plus, tube->v_z_plus,
+    tube->v_x_minus, tube->v_y_minus, tube->v_z_minus);
+  LSM3D_COMPUTE_ORTHOGONALIZATION_EQN_RHS_LOCAL(
+    tube->rhs,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->u_x_plus, tube->u_y_plus, tube->u_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->u_x_minus, tube->u_y_minus, tube->u_z_minus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    v,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->v_x_plus, tube->v_y_plus, tube->v_z_plus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    tube->v_x_minus, tube->v_y_minus, tube->v_z_minus,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[0],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_fb);
+  eulerStep(tube, u, dt);
+}
+
+
+/*==================== Curve Evolution Functions =====================*/
+
+LSM_CurveTube3d *createCurveTube3d(
+  Grid *grid,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner)
+{
+  LSM_CurveTube3d *tube;
+  LSMLIB_REAL **arrays[LSM_CURVE_TUBE_NUM_REAL_ARRAYS];
+  int n, a;
+
+  if ( (!grid) || (grid->num_dims != 3) || (width <= 0)
+    || (width_inner > width) ) {
+    return NULL;
+  }
+
+  tube = (LSM_CurveTube3d *) calloc(1, sizeof(LSM_CurveTube3d));
+  if (!tube) return NULL;
+
+  n = grid->num_gridpts;
+  tube->grid = grid;
+  tube->width = width;
+  tube->width_inner = width_inner;
+  tube->narrow_band = (unsigned char *) malloc(n*sizeof(unsigned char));
+  tube->index_x = (int *) malloc(n*sizeof(int));
+  tube->index_y = (int *) malloc(n*sizeof(int));
+  tube->index_z = (int *) malloc(n*sizeof(int));
+  tube->index_outer = (int *) malloc(n*sizeof(int));
+  tube->work = (LSMLIB_REAL *) malloc(
+    LSM_CURVE_TUBE_NUM_REAL_ARRAYS*((size_t) n)*sizeof(LSMLIB_REAL));
+  if ( (!tube->narrow_band) || (!tube->index_x) || (!tube->index_y)
+    || (!tube->index_z) || (!tube->index_outer) || (!tube->work) ) {
+    destroyCurveTube3d(tube);
+    return NULL;
+  }
+
+  arrays[0] = &tube->vel_x;      arrays[1] = &tube->vel_y;
+  arrays[2] = &tube->vel_z;      arrays[3] = &tube->tangent_x;
+  arrays[4] = &tube->tangent_y;  arrays[5] = &tube->tangent_z;
+  arrays[6] = &tube->rhs;        arrays[7] = &tube->u_next;
+  arrays[8] = &tube->u_x_plus;   arrays[9] = &tube->u_y_plus;
+  arrays[10] = &tube->u_z_plus;  arrays[11] = &tube->u_x_minus;
+  arrays[12] = &tube->u_y_minus; arrays[13] = &tube->u_z_minus;
+  arrays[14] = &tube->v_x_plus;  arrays[15] = &tube->v_y_plus;
+  arrays[16] = &tube->v_z_plus;  arrays[17] = &tube->v_x_minus;
+  arrays[18] = &tube->v_y_minus; arrays[19] = &tube->v_z_minus;
+  arrays[20] = &tube->D1;
+  for (a = 0; a < LSM_CURVE_TUBE_NUM_REAL_ARRAYS; a++) {
+    *(arrays[a]) = tube->work + a*((size_t) n);
+  }
+
+  return tube;
+}
+
+
+void destroyCurveTube3d(LSM_CurveTube3d *tube)
+{
+  if (!tube) return;
+  free(tube->narrow_band);
+  free(tube->index_x);
+  free(tube->index_y);
+  free(tube->index_z);
+  free(tube->index_outer);
+  free(tube->work);
+  free(tube);
+}
+
+
+int buildCurveTube3d(
+  LSM_CurveTube3d *tube,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi)
+{
+  int err;
+
+  if ( (!tube) || (!phi) || (!psi) ) {
+    return LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT;
+  }
+
+  err = determineNarrowBandFromTwoLevelSets3d(phi, psi, tube->narrow_band,
+    tube->index_x, tube->index_y, tube->index_z, tube->n_lo, tube->n_hi,
+    tube->index_outer, tube->grid->num_gridpts,
+    &tube->nlo_outer_plus, &tube->nhi_outer_plus,
+    &tube->nlo_outer_minus, &tube->nhi_outer_minus,
+    tube->width, tube->width_inner, LSM_CURVE_TUBE_LEVEL, tube->grid);
+  if (err == LSM_NARROW_BAND_ERR_MEMORY_ALLOCATION) {
+    return LSM_CURVE_EVOLUTION_ERR_MEMORY_ALLOCATION;
+  } else if (err != LSM_NARROW_BAND_ERR_SUCCESS) {
+    return LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT;
+  }
+
+  return LSM_CURVE_EVOLUTION_ERR_SUCCESS;
+}
+
+
+int computeCurveVelocity3d(
+  LSM_CurveTube3d *tube,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  LSMLIB_REAL curvature_coef)
+{
+  const Grid *g;
+  LSMLIB_REAL *phi_x, *phi_y, *phi_z, *psi_x, *psi_y, *psi_z;
+  int nx, nxy, m;
+
+  if ( (!tube) || (!phi) || (!psi)
+    || ( (vel_x || vel_y || vel_z) && !(vel_x && vel_y && vel_z) ) ) {
+    return LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT;
+  }
+  g = tube->grid;
+  nx = g->grid_dims_ghostbox[0];
+  nxy = nx*g->grid_dims_ghostbox[1];
+
+  /* central gradients at levels 0 and 1 (stored in the plus arrays) */
+  phi_x = tube->u_x_plus; phi_y = tube->u_y_plus; phi_z = tube->u_z_plus;
+  psi_x = tube->v_x_plus; psi_y = tube->v_y_plus; psi_z = tube->v_z_plus;
+  LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(
+    phi_x, phi_y, phi_z,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    phi,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[1],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_D1);
+  LSM3D_CENTRAL_GRAD_ORDER2_LOCAL(
+    psi_x, psi_y, psi_z,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    psi,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->dx[0], &g->dx[1], &g->dx[2],
+    tube->index_x, tube->index_y, tube->index_z,
+    &tube->n_lo[0], &tube->n_hi[1],
+    tube->narrow_band,
+    &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb, &g->klo_gb, &g->khi_gb,
+    &g->mark_D1);
+
+  /* unit tangent T = grad(phi) x grad(psi) / |grad(phi) x grad(psi)| */
+  for (m = tube->n_lo[0]; m <= tube->n_hi[1]; m++) {
+    int idx = tube->index_x[m] + tube->index_y[m]*nx + tube->index_z[m]*nxy;
+    LSMLIB_REAL t_x, t_y, t_z, norm;
+
+    if (tube->narrow_band[idx] > g->mark_D1) continue;
+    t_x = phi_y[idx]*psi_z[idx] - phi_z[idx]*psi_y[idx];
+    t_y = phi_z[idx]*psi_x[idx] - phi_x[idx]*psi_z[idx];
+    t_z = phi_x[idx]*psi_y[idx] - phi_y[idx]*psi_x[idx];
+    norm = sqrt(t_x*t_x + t_y*t_y + t_z*t_z);
+    if (norm > 0) {
+      t_x /= norm; t_y /= norm; t_z /= norm;
+    }
+    tube->tangent_x[idx] = t_x;
+    tube->tangent_y[idx] = t_y;
+    tube->tangent_z[idx] = t_z;
+  }
+
+  /* V = vel - (vel . T) T + curvature_coef (T . grad) T */
+  for (m = tube->n_lo[0]; m <= tube->n_hi[0]; m++) {
+    int idx = tube->index_x[m] + tube->index_y[m]*nx + tube->index_z[m]*nxy;
+    const LSMLIB_REAL *T[3];
+    LSMLIB_REAL t[3], v[3], vel_dot_t = 0;
+    int offset[3], d, c;
+
+    if (tube->narrow_band[idx] > g->mark_fb) continue;
+    T[0] = tube->tangent_x; T[1] = tube->tangent_y; T[2] = tube->tangent_z;
+    offset[0] = 1; offset[1] = nx; offset[2] = nxy;
+    for (c = 0; c < 3; c++) t[c] = T[c][idx];
+
+    if (vel_x) {
+      v[0] = vel_x[idx]; v[1] = vel_y[idx]; v[2] = vel_z[idx];
+      for (c = 0; c < 3; c++) vel_dot_t += v[c]*t[c];
+      for (c = 0; c < 3; c++) v[c] -= vel_dot_t*t[c];
+    } else {
+      v[0] = v[1] = v[2] = 0;
+    }
+
+    if (curvature_coef != 0) {
+      for (d = 0; d < 3; d++) {
+        LSMLIB_REAL coef = curvature_coef*t[d]/(2*g->dx[d]);
+        for (c = 0; c < 3; c++) {
+          v[c] += coef*(T[c][idx+offset[d]] - T[c][idx-offset[d]]);
+        }
+      }
+    }
+
+    tube->vel_x[idx] = v[0];
+    tube->vel_y[idx] = v[1];
+    tube->vel_z[idx] = v[2];
+  }
+
+  return LSM_CURVE_EVOLUTION_ERR_SUCCESS;
+}
+
+
+int advanceCurve3d(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *psi,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  LSMLIB_REAL curvature_coef,
+  LSMLIB_REAL dt,
+  int num_reinit_steps)
+{
+  LSMLIB_REAL dt_reinit;
+  int err, step;
+
+  if ( (!tube) || (dt < 0) || (num_reinit_steps < 0) ) {
+    return LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT;
+  }
+
+  /* tube and curve velocity at the current time */
+  err = buildCurveTube3d(tube, phi, psi);
+  if (err != LSM_CURVE_EVOLUTION_ERR_SUCCESS) return err;
+  err = computeCurveVelocity3d(tube, phi, psi, vel_x, vel_y, vel_z,
+                               curvature_coef);
+  if (err != LSM_CURVE_EVOLUTION_ERR_SUCCESS) return err;
+
+  /* evolution */
+  advectInTube(tube, phi, dt);
+  advectInTube(tube, psi, dt);
+
+  /* reinitialization and orthogonalization */
+  dt_reinit = tube->grid->dx[0];
+  if (tube->grid->dx[1] < dt_reinit) dt_reinit = tube->grid->dx[1];
+  if (tube->grid->dx[2] < dt_reinit) dt_reinit = tube->grid->dx[2];
+  dt_reinit *= 0.5;
+  for (step = 0; step < num_reinit_steps; step++) {
+    reinitializeInTube(tube, phi, dt_reinit);
+    reinitializeInTube(tube, psi, dt_reinit);
+  }
+  for (step = 0; step < num_reinit_steps; step++) {
+    orthogonalizeInTube(tube, psi, phi, dt_reinit);
+  }
+
+  return LSM_CURVE_EVOLUTION_ERR_SUCCESS;
+}
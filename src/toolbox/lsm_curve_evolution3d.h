@@ -0,0 +1,251 @@
+/*
+ * File:        lsm_curve_evolution3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for narrow-band evolution of curves in 3D
+ */
+
+#ifndef included_lsm_curve_evolution3d_h
+#define included_lsm_curve_evolution3d_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_curve_evolution3d.h
+ *
+ * \brief
+ * @ref lsm_curve_evolution3d.h provides the evolution of curves in 3D
+ * (codimension-two problems) represented as the intersection of the
+ * zero level sets of two level set functions phi and psi.
+ *
+ * All computations are restricted to a thin tube around the curve, the
+ * narrow band of points with |phi| < width and |psi| < width (see
+ * determineNarrowBandFromTwoLevelSets3d() in @ref lsm_narrow_band3d.h).
+ * For a curve of length L, the tube has O(L width^2/dx^3) points
+ * instead of the O(N) points of the full grid.
+ *
+ * One call to advanceCurve3d() performs one time step:
+ *
+ * -# The tube is rebuilt from the current phi and psi.
+ * -# The velocity of the curve is computed in the tube
+ *    (computeCurveVelocity3d()): the component of an external velocity
+ *    field normal to the curve plus a multiple of the curvature vector
+ *    of the curve.
+ * -# phi and psi are advected with the velocity (forward Euler, first-
+ *    order upwind HJ ENO).
+ * -# phi and psi are reinitialized, and psi is orthogonalized against
+ *    phi, with a few pseudo-time steps of the local reinitialization and
+ *    orthogonalization equations (see
+ *    @ref lsm_reinitialization3d_local.h).
+ *
+ * Values of phi and psi outside of level 0 of the tube are not
+ * modified.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create a tube using createCurveTube3d().
+ * -# Advance the curve using advanceCurve3d().
+ * -# Free the tube using destroyCurveTube3d().
+ *
+ */
+
+
+/*!
+ * Error codes returned by curve evolution functions.
+ */
+#define LSM_CURVE_EVOLUTION_ERR_SUCCESS             (0)
+#define LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT    (1)
+#define LSM_CURVE_EVOLUTION_ERR_MEMORY_ALLOCATION   (2)
+
+/*!
+ * Number of narrow band levels of the tube (level 1 holds the stencil
+ * points of the level 0 points, level 2 the stencil points of the
+ * curvature vector).
+ */
+#define LSM_CURVE_TUBE_LEVEL                        (2)
+
+/*!
+ * Structure 'LSM_CurveTube3d' holds the narrow band around a curve and
+ * the work arrays of the curve evolution.
+ */
+typedef struct _LSM_CurveTube3d
+{
+  Grid         *grid;
+  LSMLIB_REAL   width;            /* tube width                         */
+  LSMLIB_REAL   width_inner;      /* inner tube width                   */
+
+  /* tube (same encoding as in determineNarrowBand3d()) */
+  unsigned char *narrow_band;
+  int          *index_x;
+  int          *index_y;
+  int          *index_z;
+  int           n_lo[LSM_CURVE_TUBE_LEVEL+1];
+  int           n_hi[LSM_CURVE_TUBE_LEVEL+1];
+  int          *index_outer;
+  int           nlo_outer_plus, nhi_outer_plus;
+  int           nlo_outer_minus, nhi_outer_minus;
+
+  /* curve velocity and unit tangent */
+  LSMLIB_REAL  *vel_x, *vel_y, *vel_z;
+  LSMLIB_REAL  *tangent_x, *tangent_y, *tangent_z;
+
+  /* work arrays (grid->num_gridpts elements) */
+  LSMLIB_REAL  *rhs;
+  LSMLIB_REAL  *u_next;
+  LSMLIB_REAL  *u_x_plus, *u_y_plus, *u_z_plus;
+  LSMLIB_REAL  *u_x_minus, *u_y_minus, *u_z_minus;
+  LSMLIB_REAL  *v_x_plus, *v_y_plus, *v_z_plus;
+  LSMLIB_REAL  *v_x_minus, *v_y_minus, *v_z_minus;
+  LSMLIB_REAL  *D1;
+  LSMLIB_REAL  *work;             /* memory of all real arrays          */
+} LSM_CurveTube3d;
+
+
+/*!
+ * createCurveTube3d() creates a curve tube.
+ *
+ * Arguments:
+ *  - grid (in):          pointer to Grid
+ *  - width (in):         tube width (distance to the zero level sets)
+ *  - width_inner (in):   inner tube width (width_inner <= width)
+ *
+ * Return value:          pointer to new tube (NULL on failure)
+ *
+ * NOTES:
+ *  - The tube allocates 21 real, 4 integer and one byte array with
+ *    grid->num_gridpts elements.
+ *
+ *  - width should be at least a few grid cells larger than the distance
+ *    that the curve moves between calls to advanceCurve3d() plus the
+ *    number of reinitialization steps times the grid spacing.
+ *
+ */
+LSM_CurveTube3d *createCurveTube3d(
+  Grid *grid,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner);
+
+/*!
+ * destroyCurveTube3d() frees a curve tube.
+ *
+ * Arguments:
+ *  - tube (in):  pointer to tube (may be NULL)
+ *
+ * Return value:  none
+ *
+ */
+void destroyCurveTube3d(LSM_CurveTube3d *tube);
+
+/*!
+ * buildCurveTube3d() builds the tube around the intersection of the zero
+ * level sets of phi and psi.
+ *
+ * Arguments:
+ *  - tube (in/out):  tube
+ *  - phi (in):       level set function 1
+ *  - psi (in):       level set function 2
+ *
+ * Return value:      error code
+ *
+ */
+int buildCurveTube3d(
+  LSM_CurveTube3d *tube,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi);
+
+/*!
+ * computeCurveVelocity3d() computes the velocity of the curve at the
+ * level 0 points of the tube.
+ *
+ * The velocity is
+ *
+ *   V = vel - (vel . T) T + curvature_coef (T . grad) T,
+ *
+ * where T = grad(phi) x grad(psi) / |grad(phi) x grad(psi)| is the unit
+ * tangent of the curve and (T . grad) T = kappa N is its curvature
+ * vector.  With vel = 0 and curvature_coef = 1, the curve moves by
+ * curve shortening flow.
+ *
+ * Arguments:
+ *  - tube (in/out):       tube (the result is stored in tube->vel_*)
+ *  - phi (in):            level set function 1
+ *  - psi (in):            level set function 2
+ *  - vel_* (in):          external velocity field (NULL for none)
+ *  - curvature_coef (in): coefficient of the curvature vector
+ *
+ * Return value:           error code
+ *
+ * NOTES:
+ *  - The tube must have been built using buildCurveTube3d().
+ *
+ *  - The tangent is computed with second-order central differences at
+ *    levels 0 and 1 of the tube and stored in tube->tangent_*; the
+ *    curvature vector is computed with second-order central differences
+ *    of the tangent.
+ *
+ *  - The tangential component of the external velocity is removed
+ *    because it does not move the curve.
+ *
+ */
+int computeCurveVelocity3d(
+  LSM_CurveTube3d *tube,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  LSMLIB_REAL curvature_coef);
+
+/*!
+ * advanceCurve3d() advances a curve by one time step.
+ *
+ * Arguments:
+ *  - tube (in/out):         tube
+ *  - phi (in/out):          level set function 1
+ *  - psi (in/out):          level set function 2
+ *  - vel_* (in):            external velocity field (NULL for none)
+ *  - curvature_coef (in):   coefficient of the curvature vector
+ *  - dt (in):               time step
+ *  - num_reinit_steps (in): number of pseudo-time steps of the
+ *                           reinitialization and orthogonalization
+ *                           equations (0 to skip them)
+ *
+ * Return value:             error code
+ *
+ * NOTES:
+ *  - The time step is not checked.  It should satisfy
+ *    dt <= 0.5 dx / max|V| and, with curvature,
+ *    dt <= dx^2 / (6 curvature_coef).
+ *
+ *  - The pseudo-time step of the reinitialization and orthogonalization
+ *    equations is half of the smallest grid spacing.  Each pseudo-time
+ *    step moves the zero level sets by a small fraction of a grid cell,
+ *    so num_reinit_steps should be nonzero only every few time steps.
+ *
+ */
+int advanceCurve3d(
+  LSM_CurveTube3d *tube,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL *psi,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  LSMLIB_REAL curvature_coef,
+  LSMLIB_REAL dt,
+  int num_reinit_steps);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -43,6 +43,9 @@ c     in that range saved in arrays index_x,index_y,index_z
 c    - voxels that are outside fillbox ARE still INCLUDED in the narrow 
 c     band; use lsm3dMarkNarrowBandBoundaryLayer() to distinguish the voxels
 c    near volume boundary
+c    - only levels up to max_nb_level (LSM_NB_MAX_LEVEL in lsm_grid.h) are
+c     marked because L+1 must fit in the level bits of 'narrow_band';
+c     higher levels are returned empty (n_hi[L] = n_lo[L] - 1)
 c
 c***********************************************************************
       subroutine lsm3dMarkNarrowBandNeighbors(
@@ -74,13 +77,18 @@ c { begin subroutine
       
       integer i, j, k, l, m, count
       integer*1 mark
-      integer start_level
+      integer start_level, end_level
+
+c     must match LSM_NB_MAX_LEVEL in lsm_grid.h
+      integer max_nb_level
+      parameter (max_nb_level=6)
 
       count = n_hi(0)+1
       start_level = 1
+      end_level = min(level,max_nb_level)
       
 c     { begin loop over all narrow band levels      
-      do l=start_level,level
+      do l=start_level,end_level
 
         mark = l+1
 c       { begin examine points from one level less
@@ -162,6 +170,12 @@ c       } end examine points one level less
 	
       enddo
 c     } end loop over all levels  
+
+c     levels that do not fit in the level bits are left empty
+      do l=end_level+1,level
+        n_lo(l) = count
+        n_hi(l) = count-1
+      enddo
   
       return
       end
@@ -217,7 +231,7 @@ c { begin subroutine
       integer level
       integer n_lo(0:level), n_hi(0:level)
       
-      integer i,j,k, count, count_outer_minus, count_outer_plus
+      integer i,j,k,l, count, count_outer_minus, count_outer_plus
       real abs_phi_val
       integer*1  one, zero
 
@@ -287,9 +301,13 @@ c      } end loop over grid
      &   level)
          
       else
-        n_hi(0) = count;
-        nhi_outer_minus = count_outer_minus
-        nlo_outer_plus  = count_outer_plus 
+c       empty narrow band:  all levels and outer ranges are empty
+        do l=0,level
+          n_lo(l) = nlo_index
+          n_hi(l) = nlo_index-1
+        enddo
+        nhi_outer_minus = count_outer_minus - 1
+        nlo_outer_plus  = count_outer_plus  + 1
       endif
        
           
@@ -299,6 +317,284 @@ c } end subroutine
 c***********************************************************************      
  
 
+c***********************************************************************
+      subroutine lsm3dDetermineNarrowBandFromTwoLevelSets(
+     &  phi, psi,
+     &  ilo_gb, ihi_gb,
+     &  jlo_gb, jhi_gb,
+     &  klo_gb, khi_gb,
+     &  narrow_band,
+     &  ilo_nb_gb, ihi_nb_gb,
+     &  jlo_nb_gb, jhi_nb_gb,
+     &  klo_nb_gb, khi_nb_gb,
+     &  index_x,
+     &  index_y, 
+     &  index_z,
+     &  nlo_index, nhi_index,
+     &  n_lo, n_hi,
+     &  index_outer,
+     &  nlo_index_outer, nhi_index_outer,
+     &  nlo_outer_plus, nhi_outer_plus,
+     &  nlo_outer_minus, nhi_outer_minus,
+     &  width,
+     &  width_inner,
+     &  level)
+c***********************************************************************
+c { begin subroutine
+      implicit none
+      
+      integer ilo_gb, ihi_gb
+      integer jlo_gb, jhi_gb
+      integer klo_gb, khi_gb
+      integer ilo_nb_gb, ihi_nb_gb
+      integer jlo_nb_gb, jhi_nb_gb
+      integer klo_nb_gb, khi_nb_gb
+      real phi(ilo_gb:ihi_gb,jlo_gb:jhi_gb,klo_gb:khi_gb)
+      real psi(ilo_gb:ihi_gb,jlo_gb:jhi_gb,klo_gb:khi_gb)
+      integer*1 narrow_band(ilo_nb_gb:ihi_nb_gb,jlo_nb_gb:jhi_nb_gb,
+     &                      klo_nb_gb:khi_nb_gb)
+      integer nlo_index, nhi_index
+      integer index_x(nlo_index:nhi_index)
+      integer index_y(nlo_index:nhi_index)
+      integer index_z(nlo_index:nhi_index)
+      real width, width_inner
+      integer nlo_index_outer, nhi_index_outer
+      integer nlo_outer_plus, nhi_outer_plus
+      integer nlo_outer_minus, nhi_outer_minus
+      integer index_outer(nlo_index_outer:nhi_index_outer)
+      integer level
+      integer n_lo(0:level), n_hi(0:level)
+      
+      integer i,j,k,l, count, count_outer_minus, count_outer_plus
+      real abs_phi_val
+      integer*1  one, zero
+
+c     get level 0 narrow band points 
+      count = nlo_index
+      n_lo(0) = nlo_index
+      one = 1
+      zero = 0
+      
+c     index_outer is essentially allocated beforehand to hold all gridpts
+c     outer narrow band points with negative phi will be stored at the front
+c     and the positive at the end of the array
+      
+      count_outer_minus = nlo_index_outer
+      nlo_outer_minus =   nlo_index_outer
+      
+      count_outer_plus =  nhi_index_outer
+      nhi_outer_plus =    nhi_index_outer
+      
+c     begin loop over grid      
+      do k=klo_gb,khi_gb
+	do j=jlo_gb,jhi_gb
+          do i=ilo_gb,ihi_gb  
+	      
+	    abs_phi_val = abs(phi(i,j,k))  
+	    if ( (abs_phi_val .lt. width) .and. 
+     &           (abs(psi(i,j,k)) .lt. width) ) then
+	       index_x(count) = i
+	       index_y(count) = j
+	       index_z(count) = k
+	       narrow_band(i,j,k) = one
+	       
+	       if( abs_phi_val .ge. width_inner )  then
+	       	       
+	          if(phi(i,j,k) .le. 0d0 ) then
+		      index_outer(count_outer_minus) = count
+		      count_outer_minus = count_outer_minus+1
+		  else
+		      index_outer(count_outer_plus) = count
+		      count_outer_plus = count_outer_plus-1
+		  endif     
+	       
+	       endif 
+	       
+	       count = count+1       
+	    else
+	       narrow_band(i,j,k) = zero  
+	    endif
+	      
+          enddo
+	enddo
+      enddo
+c      } end loop over grid 
+
+      if( count .gt. nlo_index ) then
+      
+         n_hi(0) = count-1
+         nhi_outer_minus = count_outer_minus - 1
+         nlo_outer_plus  = count_outer_plus  + 1
+  
+         call  lsm3dMarkNarrowBandNeighbors(
+     &   narrow_band,
+     &   ilo_nb_gb, ihi_nb_gb, jlo_nb_gb, jhi_nb_gb, 
+     &   klo_nb_gb, khi_nb_gb,
+     &   index_x, index_y, index_z,
+     &   nlo_index, nhi_index,
+     &   n_lo, n_hi,
+     &   level)
+         
+      else
+c       empty narrow band:  all levels and outer ranges are empty
+        do l=0,level
+          n_lo(l) = nlo_index
+          n_hi(l) = nlo_index-1
+        enddo
+        nhi_outer_minus = count_outer_minus - 1
+        nlo_outer_plus  = count_outer_plus  + 1
+      endif
+       
+          
+      return
+      end     
+c } end subroutine
+c***********************************************************************      
+
+
+c***********************************************************************
+      subroutine lsm3dDetermineNarrowBandAwayFromMask(
+     &  phi, mask,
+     &  ilo_gb, ihi_gb,
+     &  jlo_gb, jhi_gb,
+     &  klo_gb, khi_gb,
+     &  narrow_band,
+     &  ilo_nb_gb, ihi_nb_gb,
+     &  jlo_nb_gb, jhi_nb_gb,
+     &  klo_nb_gb, khi_nb_gb,
+     &  index_x,
+     &  index_y, 
+     &  index_z,
+     &  nlo_index, nhi_index,
+     &  n_lo, n_hi,
+     &  index_outer,
+     &  nlo_index_outer, nhi_index_outer,
+     &  nlo_outer_plus, nhi_outer_plus,
+     &  nlo_outer_minus, nhi_outer_minus,
+     &  width,
+     &  width_inner,
+     &  level,
+     &  dx,dy,dz)
+c***********************************************************************
+c { begin subroutine
+      implicit none
+      
+      integer ilo_gb, ihi_gb
+      integer jlo_gb, jhi_gb
+      integer klo_gb, khi_gb
+      integer ilo_nb_gb, ihi_nb_gb
+      integer jlo_nb_gb, jhi_nb_gb
+      integer klo_nb_gb, khi_nb_gb
+      real phi(ilo_gb:ihi_gb,jlo_gb:jhi_gb,klo_gb:khi_gb)
+      real mask(ilo_gb:ihi_gb,jlo_gb:jhi_gb,klo_gb:khi_gb)
+      integer*1 narrow_band(ilo_nb_gb:ihi_nb_gb,jlo_nb_gb:jhi_nb_gb,
+     &                      klo_nb_gb:khi_nb_gb)
+      integer nlo_index, nhi_index
+      integer index_x(nlo_index:nhi_index)
+      integer index_y(nlo_index:nhi_index)
+      integer index_z(nlo_index:nhi_index)
+      real width, width_inner
+      integer nlo_index_outer, nhi_index_outer
+      integer nlo_outer_plus, nhi_outer_plus
+      integer nlo_outer_minus, nhi_outer_minus
+      integer index_outer(nlo_index_outer:nhi_index_outer)
+      integer level
+      integer n_lo(0:level), n_hi(0:level)
+      real dx,dy,dz
+      
+      integer i,j,k,l, count, count_outer_minus, count_outer_plus
+      real abs_phi_val, diff, max_dx
+      integer*1  one, zero
+
+c     get level 0 narrow band points 
+      count = nlo_index
+      n_lo(0) = nlo_index
+      one = 1
+      zero = 0
+      
+      max_dx = max(dx,dy,dz)
+      
+c     index_outer is essentially allocated beforehand to hold all gridpts
+c     outer narrow band points with negative phi will be stored at the front
+c     and the positive at the end of the array
+      
+      count_outer_minus = nlo_index_outer
+      nlo_outer_minus =   nlo_index_outer
+      
+      count_outer_plus =  nhi_index_outer
+      nhi_outer_plus =    nhi_index_outer
+      
+c     begin loop over grid      
+      do k=klo_gb,khi_gb
+	do j=jlo_gb,jhi_gb
+          do i=ilo_gb,ihi_gb  
+	      
+	    abs_phi_val = abs(phi(i,j,k))  
+	    if ( abs_phi_val .lt. width ) then
+	       diff = abs( phi(i,j,k) - mask(i,j,k) )
+	       if ( diff .gt. max_dx ) then
+	         index_x(count) = i
+	         index_y(count) = j
+	         index_z(count) = k
+	         narrow_band(i,j,k) = one
+	       
+	         if( abs_phi_val .ge. width_inner )  then
+	       	       
+	            if(phi(i,j,k) .le. 0d0 ) then
+		        index_outer(count_outer_minus) = count
+		        count_outer_minus = count_outer_minus+1
+		    else
+		        index_outer(count_outer_plus) = count
+		        count_outer_plus = count_outer_plus-1
+		    endif     
+	       
+	         endif 
+	       
+	         count = count+1       
+	       else
+	         narrow_band(i,j,k) = zero  
+	       endif
+	    else
+	       narrow_band(i,j,k) = zero  
+	    endif
+	      
+          enddo
+	enddo
+      enddo
+c      } end loop over grid 
+
+      if( count .gt. nlo_index ) then
+      
+         n_hi(0) = count-1
+         nhi_outer_minus = count_outer_minus - 1
+         nlo_outer_plus  = count_outer_plus  + 1
+  
+         call  lsm3dMarkNarrowBandNeighbors(
+     &   narrow_band,
+     &   ilo_nb_gb, ihi_nb_gb, jlo_nb_gb, jhi_nb_gb, 
+     &   klo_nb_gb, khi_nb_gb,
+     &   index_x, index_y, index_z,
+     &   nlo_index, nhi_index,
+     &   n_lo, n_hi,
+     &   level)
+         
+      else
+c       empty narrow band:  all levels and outer ranges are empty
+        do l=0,level
+          n_lo(l) = nlo_index
+          n_hi(l) = nlo_index-1
+        enddo
+        nhi_outer_minus = count_outer_minus - 1
+        nlo_outer_plus  = count_outer_plus  + 1
+      endif
+       
+          
+      return
+      end     
+c } end subroutine
+c***********************************************************************      
+
+
 c***********************************************************************
       subroutine lsm3dMarkNarrowBandBoundaryLayer(
      &  narrow_band,
@@ -721,6 +1017,176 @@ c } end subroutine
 c***********************************************************************
 
 
+c***********************************************************************
+      subroutine lsm3dComputeSolidNormalsLocal(
+     &  normal_x, normal_y, normal_z,
+     &  ilo_normal_gb, ihi_normal_gb,
+     &  jlo_normal_gb, jhi_normal_gb,
+     &  klo_normal_gb, khi_normal_gb,
+     &  mask,
+     &  ilo_mask_gb, ihi_mask_gb,
+     &  jlo_mask_gb, jhi_mask_gb,
+     &  klo_mask_gb, khi_mask_gb,
+     &  index_x,
+     &  index_y, 
+     &  index_z,
+     &  nlo_index, nhi_index,
+     &  dx,dy,dz)
+c***********************************************************************
+c { begin subroutine
+      implicit none
+      
+      integer ilo_normal_gb, ihi_normal_gb
+      integer jlo_normal_gb, jhi_normal_gb
+      integer klo_normal_gb, khi_normal_gb
+      integer ilo_mask_gb, ihi_mask_gb
+      integer jlo_mask_gb, jhi_mask_gb
+      integer klo_mask_gb, khi_mask_gb
+      real normal_x(ilo_normal_gb:ihi_normal_gb,
+     &              jlo_normal_gb:jhi_normal_gb,
+     &              klo_normal_gb:khi_normal_gb)
+      real normal_y(ilo_normal_gb:ihi_normal_gb,
+     &              jlo_normal_gb:jhi_normal_gb,
+     &              klo_normal_gb:khi_normal_gb)
+      real normal_z(ilo_normal_gb:ihi_normal_gb,
+     &              jlo_normal_gb:jhi_normal_gb,
+     &              klo_normal_gb:khi_normal_gb)
+      real mask(ilo_mask_gb:ihi_mask_gb,
+     &          jlo_mask_gb:jhi_mask_gb,     
+     &          klo_mask_gb:khi_mask_gb)
+      integer nlo_index, nhi_index
+      integer index_x(nlo_index:nhi_index)
+      integer index_y(nlo_index:nhi_index)
+      integer index_z(nlo_index:nhi_index)
+      real dx,dy,dz
+            
+c     local variables      
+      integer i,j,k,l
+      integer im,ip,jm,jp,km,kp
+      real grad_x, grad_y, grad_z, grad_mag
+
+c     { begin loop over indexed points
+      do l=nlo_index, nhi_index      
+        i=index_x(l)
+	j=index_y(l)
+	k=index_z(l)        
+
+c       central differences (one-sided at the ghostbox boundary)
+        im = max(i-1,ilo_mask_gb)
+        ip = min(i+1,ihi_mask_gb)
+        jm = max(j-1,jlo_mask_gb)
+        jp = min(j+1,jhi_mask_gb)
+        km = max(k-1,klo_mask_gb)
+        kp = min(k+1,khi_mask_gb)
+
+        grad_x = (mask(ip,j,k)-mask(im,j,k))/((ip-im)*dx)
+        grad_y = (mask(i,jp,k)-mask(i,jm,k))/((jp-jm)*dy)
+        grad_z = (mask(i,j,kp)-mask(i,j,km))/((kp-km)*dz)
+        grad_mag = sqrt(grad_x*grad_x + grad_y*grad_y + grad_z*grad_z)
+	   
+        if (grad_mag .gt. 0d0) then
+          normal_x(i,j,k) = grad_x/grad_mag
+          normal_y(i,j,k) = grad_y/grad_mag
+          normal_z(i,j,k) = grad_z/grad_mag
+        else
+          normal_x(i,j,k) = 0d0
+          normal_y(i,j,k) = 0d0
+          normal_z(i,j,k) = 0d0
+        endif
+	   
+      enddo 
+c     } end loop over indexed points
+    
+      return
+      end
+c } end subroutine
+c***********************************************************************
+
+
+c***********************************************************************
+      subroutine lsm3dImposeMaskContactLocal(
+     &  dest,
+     &  ilo_dest_gb, ihi_dest_gb,
+     &  jlo_dest_gb, jhi_dest_gb,
+     &  klo_dest_gb, khi_dest_gb,
+     &  src,
+     &  ilo_src_gb, ihi_src_gb,
+     &  jlo_src_gb, jhi_src_gb,
+     &  klo_src_gb, khi_src_gb,
+     &  mask,
+     &  ilo_mask_gb, ihi_mask_gb,
+     &  jlo_mask_gb, jhi_mask_gb,
+     &  klo_mask_gb, khi_mask_gb,
+     &  solid_narrow_band,
+     &  ilo_nb_gb, ihi_nb_gb,
+     &  jlo_nb_gb, jhi_nb_gb,
+     &  klo_nb_gb, khi_nb_gb,
+     &  index_x,
+     &  index_y, 
+     &  index_z,
+     &  nlo_index, nhi_index,
+     &  level_bits)
+c***********************************************************************
+c { begin subroutine
+      implicit none
+      
+      integer ilo_dest_gb, ihi_dest_gb
+      integer jlo_dest_gb, jhi_dest_gb
+      integer klo_dest_gb, khi_dest_gb
+      integer ilo_src_gb,  ihi_src_gb
+      integer jlo_src_gb,  jhi_src_gb
+      integer klo_src_gb,  khi_src_gb
+      integer ilo_mask_gb, ihi_mask_gb
+      integer jlo_mask_gb, jhi_mask_gb
+      integer klo_mask_gb, khi_mask_gb
+      integer ilo_nb_gb, ihi_nb_gb
+      integer jlo_nb_gb, jhi_nb_gb
+      integer klo_nb_gb, khi_nb_gb
+      real dest(ilo_dest_gb:ihi_dest_gb,
+     &                      jlo_dest_gb:jhi_dest_gb,
+     &                      klo_dest_gb:khi_dest_gb)
+      real src(ilo_src_gb:ihi_src_gb,
+     &                     jlo_src_gb:jhi_src_gb,
+     &                     klo_src_gb:khi_src_gb)
+      real mask(ilo_mask_gb:ihi_mask_gb,
+     &                      jlo_mask_gb:jhi_mask_gb,     
+     &                      klo_mask_gb:khi_mask_gb)
+      integer*1 solid_narrow_band(ilo_nb_gb:ihi_nb_gb,
+     &                            jlo_nb_gb:jhi_nb_gb,
+     &                            klo_nb_gb:khi_nb_gb)
+      integer nlo_index, nhi_index
+      integer index_x(nlo_index:nhi_index)
+      integer index_y(nlo_index:nhi_index)
+      integer index_z(nlo_index:nhi_index)
+      integer*1 level_bits
+            
+c     local variables      
+      integer i,j,k,l
+
+c     { begin loop over indexed points
+      do l=nlo_index, nhi_index      
+        i=index_x(l)
+	j=index_y(l)
+	k=index_z(l)        
+
+c       only level 0 solid narrow band points are in the contact region
+c       (the boundary layer bits of the narrow band value are ignored)
+	if (iand(int(solid_narrow_band(i,j,k)),int(level_bits))
+     &      .eq. 1) then
+	  dest(i,j,k) = max(mask(i,j,k),src(i,j,k))
+	else
+	  dest(i,j,k) = src(i,j,k)
+	endif
+	   
+      enddo 
+c     } end loop over indexed points
+    
+      return
+      end
+c } end subroutine
+c***********************************************************************
+
+
 c***********************************************************************
       subroutine lsm3dCopyDataLocal(
      &  dest,
@@ -35,18 +35,20 @@ extern "C" {
  */
  
  #define LSM3D_DETERMINE_NARROW_BAND           lsm3ddeterminenarrowband_
+ #define LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS \
+                                       lsm3ddeterminenarrowbandfromtwolevelsets_
+ #define LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK \
+                                       lsm3ddeterminenarrowbandawayfrommask_
  #define LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER lsm3dmarknarrowbandboundarylayer_
  #define LSM3D_DETERMINE_NARROW_BAND_FROM_MASK lsm3ddeterminenarrowbandfrommask_
  #define LSM3D_MULTIPLY_CUT_OFF_LSE_RHS_LOCAL  lsm3dmultiplycutofflserhslocal_
  #define LSM3D_CHECK_OUTER_NARROW_BAND_LAYER   lsm3dcheckouternarrowbandlayer_ 
  
  #define LSM3D_IMPOSE_MASK_LOCAL               lsm3dimposemasklocal_
+ #define LSM3D_IMPOSE_MASK_CONTACT_LOCAL       lsm3dimposemaskcontactlocal_
+ #define LSM3D_COMPUTE_SOLID_NORMALS_LOCAL     lsm3dcomputesolidnormalslocal_
  #define LSM3D_COPY_DATA_LOCAL                 lsm3dcopydatalocal_
  
-#ifdef __cplusplus
-extern "C" {
-#endif
- 
 /*!
 *
 *  LSM3D_DETERMINE_NARROW_BAND() finds the narrow band voxels around the zero
@@ -81,10 +83,15 @@ extern "C" {
 *
 *    Notes:
 *    - narrow_band, index_*, index_outer arrays assumed allocated beforehand
+*    - only levels up to LSM_NB_MAX_LEVEL (see lsm_grid.h) are marked
+*      because L+1 must fit in the level bits of narrow_band; higher
+*      levels are returned empty
 *    - index_outer stores indices of points in narrow band with positive and
 *     negative phi values separately in order to be able to identify change
 *     of signs for phi (i.e. when zero level set crosses into the outer layer),
 *     see lsm3dCheckOuterNarrowBandLayer() 
+*    - if there are no narrow band voxels, all levels and both
+*      index_outer ranges are empty (n_hi[L] = n_lo[L] - 1)
 */ 
  void LSM3D_DETERMINE_NARROW_BAND(
  const LSMLIB_REAL *phi,
@@ -120,6 +127,179 @@ extern "C" {
  const int *level);
  
  
+/*!
+*
+*  LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS() finds the narrow band
+*  voxels around the intersection of the zero level sets of two functions
+*  phi and psi (a curve in 3D) with the specified width, i.e. the voxels
+*  with both |phi| < width and |psi| < width.
+*  Outer narrow band points, however, are determined according to phi.
+*  Narrow band neighbors (up to the desired level) are marked as well.
+*  Narrow band of level 0 - actual narrow band voxels
+*  Narrow band of level L - voxels +/-L voxels in each coordinate direction
+*                         (needed for correct computation of derivatives
+*                         at the actual narrow band voxels) 
+*
+*  Arguments:
+*    phi(in):          level set function 1 (assumed signed distance function)
+*    psi(in):          level set function 2 (assumed signed distance function)
+*    narrow_band(out): array with values L+1 for narrow band level L voxels
+*                      and 0 otherwise
+*    index_*(out):     array with coordinates of narrow band voxels
+*                      indices of level L narrow band stored consecutively
+*    n*_index(in):     (allocated) index range of index_* arrays 
+*    n_lo(out):        array, n_lo[L] is starting index of the level L narrow
+*                      band voxels
+*    n_hi(out):        array, n_hi[L] is ending index of the level L narrow
+*                      band voxels  
+*    level(in):        number of narrow band levels to mark
+*    width(in):        narrow band width (distance to the zero level sets)
+*    width_inner(in):  inner narrow band width
+*    index_outer(out): indices of the narrow band voxels such that 
+*                      width_inner <= abs(phi) < width
+*    n*_plus(out):     index range of 'index_outer'  elements for which
+*                      phi values satisfy  0 < width_inner <= phi < width  
+*    n*_minus(out):    index range of 'index_outer'  elements for which
+*                      phi values satisfy  0> -width_inner >= phi > -width 
+*    *_gb (in):        index range for ghostbox
+*
+*    Notes:
+*    - phi and psi have the same ghostbox
+*    - narrow_band, index_*, index_outer arrays assumed allocated beforehand
+*    - only levels up to LSM_NB_MAX_LEVEL (see lsm_grid.h) are marked
+*      because L+1 must fit in the level bits of narrow_band; higher
+*      levels are returned empty
+*    - the narrow band of a curve of length L has O(L width^2/dx^3)
+*      voxels instead of the O(area width/dx^3) voxels of the narrow band
+*      of phi alone
+*    - if there are no narrow band voxels, all levels and both
+*      index_outer ranges are empty (n_hi[L] = n_lo[L] - 1)
+*    - see determineNarrowBandFromTwoLevelSets3d() in
+*      @ref lsm_narrow_band3d.h for a threaded version that also sets the
+*      boundary layer bits
+*/ 
+ void LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS(
+ const LSMLIB_REAL *phi,
+ const LSMLIB_REAL *psi,
+ const int *ilo_gb, 
+ const int *ihi_gb,
+ const int *jlo_gb, 
+ const int *jhi_gb,
+ const int *klo_gb, 
+ const int *khi_gb,
+ unsigned char *narrow_band,
+ const int *ilo_nb_gb, 
+ const int *ihi_nb_gb,
+ const int *jlo_nb_gb, 
+ const int *jhi_nb_gb,
+ const int *klo_nb_gb, 
+ const int *khi_nb_gb,
+ int *index_x,
+ int *index_y, 
+ int *index_z,
+ const int *nlo_index, 
+ const int *nhi_index,
+ int *n_lo,
+ int *n_hi,
+ int  *index_outer,
+ const int *nlo_index_outer, 
+ const int *nhi_index_outer,
+ int *nlo_index_outer_plus, 
+ int *nhi_index_outer_plus,
+ int *nlo_index_outer_minus, 
+ int *nhi_index_outer_minus,
+ const LSMLIB_REAL *width,
+ const LSMLIB_REAL *width_inner,
+ const int *level);
+ 
+ 
+/*!
+*
+*  LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK() finds the narrow band voxels
+*  that are away from the masking function boundary (i.e. |phi - mask| is
+*  larger than the largest grid spacing).  Voxels where phi is pinned to
+*  the mask (static solid regions) are left out of the narrow band, so
+*  local kernels skip them entirely.
+*  Narrow band neighbors (up to the desired level) are marked as well.
+*  Narrow band of level 0 - actual narrow band voxels
+*  Narrow band of level L - voxels +/-L voxels in each coordinate direction
+*                         (needed for correct computation of derivatives
+*                         at the actual narrow band voxels) 
+*
+*  Arguments:
+*    phi(in):          level set function (assumed signed distance function)
+*    mask(in):         masking level set function (assumed signed distance 
+*                      function)
+*    narrow_band(out): array with values L+1 for narrow band level L voxels
+*                      and 0 otherwise
+*    index_*(out):     array with coordinates of narrow band voxels
+*                      indices of level L narrow band stored consecutively
+*    n*_index(in):     (allocated) index range of index_* arrays 
+*    n_lo(out):        array, n_lo[L] is starting index of the level L narrow
+*                      band voxels
+*    n_hi(out):        array, n_hi[L] is ending index of the level L narrow
+*                      band voxels  
+*    level(in):        number of narrow band levels to mark
+*    width(in):        narrow band width (distance to the zero level set)
+*    width_inner(in):  inner narrow band width
+*    index_outer(out): indices of the narrow band voxels such that 
+*                      width_inner <= abs(phi) < width
+*    n*_plus(out):     index range of 'index_outer'  elements for which
+*                      phi values satisfy  0 < width_inner <= phi < width  
+*    n*_minus(out):    index range of 'index_outer'  elements for which
+*                      phi values satisfy  0> -width_inner >= phi > -width 
+*    dx, dy, dz(in):   grid spacing
+*    *_gb (in):        index range for ghostbox
+*
+*    Notes:
+*    - phi and mask have the same ghostbox
+*    - narrow_band, index_*, index_outer arrays assumed allocated beforehand
+*    - only levels up to LSM_NB_MAX_LEVEL (see lsm_grid.h) are marked
+*      because L+1 must fit in the level bits of narrow_band; higher
+*      levels are returned empty
+*    - if there are no narrow band voxels, all levels and both
+*      index_outer ranges are empty (n_hi[L] = n_lo[L] - 1)
+*    - see determineNarrowBandAwayFromMask3d() in @ref lsm_narrow_band3d.h
+*      for a threaded version that also sets the boundary layer bits
+*/ 
+ void LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK(
+ const LSMLIB_REAL *phi,
+ const LSMLIB_REAL *mask,
+ const int *ilo_gb, 
+ const int *ihi_gb,
+ const int *jlo_gb, 
+ const int *jhi_gb,
+ const int *klo_gb, 
+ const int *khi_gb,
+ unsigned char *narrow_band,
+ const int *ilo_nb_gb, 
+ const int *ihi_nb_gb,
+ const int *jlo_nb_gb, 
+ const int *jhi_nb_gb,
+ const int *klo_nb_gb, 
+ const int *khi_nb_gb,
+ int *index_x,
+ int *index_y, 
+ int *index_z,
+ const int *nlo_index, 
+ const int *nhi_index,
+ int *n_lo,
+ int *n_hi,
+ int  *index_outer,
+ const int *nlo_index_outer, 
+ const int *nhi_index_outer,
+ int *nlo_index_outer_plus, 
+ int *nhi_index_outer_plus,
+ int *nlo_index_outer_minus, 
+ int *nhi_index_outer_minus,
+ const LSMLIB_REAL *width,
+ const LSMLIB_REAL *width_inner,
+ const int *level,
+ const LSMLIB_REAL *dx,
+ const LSMLIB_REAL *dy,
+ const LSMLIB_REAL *dz);
+ 
+ 
 /*!
 * LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER() marks planes x = ilo_fb, x = ihi_fb,
 * y = jlo_fb, y = jhi_fb, z = klo_fb and z = khi_fb in narrow band array 
@@ -182,6 +362,9 @@ extern "C" {
 *
 *    Notes:
 *    - narrow_band and index_* arrays assumed allocated beforehand
+*    - only levels up to LSM_NB_MAX_LEVEL (see lsm_grid.h) are marked
+*      because L+1 must fit in the level bits of narrow_band; higher
+*      levels are returned empty
 *
 */
  void LSM3D_DETERMINE_NARROW_BAND_FROM_MASK(
@@ -332,6 +515,116 @@ extern "C" {
  const int *nlo_index, 
  const int *nhi_index);
 
+ 
+/*!
+*  LSM3D_IMPOSE_MASK_CONTACT_LOCAL() replaces phi with the maximum of
+*  phi and mask at the narrow band points that lie in the level 0 solid
+*  narrow band (the contact region) and copies phi elsewhere.
+*
+*  Arguments:
+*    dest(out):         masked level set function
+*    src(in):           level set function
+*    mask(in):          masking level set function
+*    solid_narrow_band(in): narrow band of the mask, e.g. computed once by
+*                       LSM3D_DETERMINE_NARROW_BAND() applied to mask
+*    index_*(in):       array(s) with coordinates of narrow band voxels
+*                       indices of level L narrow band stored consecutively
+*    n*_index:          index range of index_* arrays 
+*    level_bits(in):    bits of solid_narrow_band that hold the level
+*                       (LSM_NB_LEVEL_BITS in @ref lsm_grid.h)
+*    *_gb (in):         index range for ghostbox
+*
+*  Notes:
+*    - gives the same result as LSM3D_IMPOSE_MASK_LOCAL() wherever
+*      src >= mask outside the contact region (e.g. when the mask was
+*      imposed at the previous step and the solid narrow band is wider
+*      than the narrow band)
+*    - only the level bits of solid_narrow_band are used
+*
+*/
+ void  LSM3D_IMPOSE_MASK_CONTACT_LOCAL(
+ LSMLIB_REAL *dest,
+ const int *ilo_dest_gb, 
+ const int *ihi_dest_gb,
+ const int *jlo_dest_gb, 
+ const int *jhi_dest_gb,
+ const int *klo_dest_gb, 
+ const int *khi_dest_gb,
+ LSMLIB_REAL *src,
+ const int *ilo_src_gb, 
+ const int *ihi_src_gb,
+ const int *jlo_src_gb, 
+ const int *jhi_src_gb,
+ const int *klo_src_gb, 
+ const int *khi_src_gb,
+ LSMLIB_REAL *mask,
+ const int *ilo_mask_gb, 
+ const int *ihi_mask_gb,
+ const int *jlo_mask_gb, 
+ const int *jhi_mask_gb,
+ const int *klo_mask_gb, 
+ const int *khi_mask_gb,
+ const unsigned char *solid_narrow_band,
+ const int *ilo_nb_gb, 
+ const int *ihi_nb_gb,
+ const int *jlo_nb_gb, 
+ const int *jhi_nb_gb,
+ const int *klo_nb_gb, 
+ const int *khi_nb_gb,
+ const int *index_x,
+ const int *index_y, 
+ const int *index_z,
+ const int *nlo_index, 
+ const int *nhi_index,
+ const unsigned char *level_bits);
+ 
+ 
+/*!
+*  LSM3D_COMPUTE_SOLID_NORMALS_LOCAL() computes the unit normal
+*  grad(mask)/|grad(mask)| (pointing into the region mask > 0) at the
+*  local (solid narrow band) points using central differences.
+*
+*  Arguments:
+*    normal_*(out):   components of the unit normal to the mask
+*    mask(in):        masking level set function
+*    index_*(in):     array(s) with coordinates of solid narrow band voxels
+*    n*_index:        index range of index_* arrays 
+*    dx, dy, dz(in):  grid spacing
+*    *_gb (in):       index range for ghostbox
+*
+*  Notes:
+*    - one-sided differences are used on the ghostbox boundary
+*    - the normal is set to zero where grad(mask) vanishes
+*    - the mask is static, so the normals only need to be computed once
+*      (e.g. into the solid_normal_* fields of LSM_DataArrays)
+*
+*/
+ void  LSM3D_COMPUTE_SOLID_NORMALS_LOCAL(
+ LSMLIB_REAL *normal_x,
+ LSMLIB_REAL *normal_y,
+ LSMLIB_REAL *normal_z,
+ const int *ilo_normal_gb, 
+ const int *ihi_normal_gb,
+ const int *jlo_normal_gb, 
+ const int *jhi_normal_gb,
+ const int *klo_normal_gb, 
+ const int *khi_normal_gb,
+ const LSMLIB_REAL *mask,
+ const int *ilo_mask_gb, 
+ const int *ihi_mask_gb,
+ const int *jlo_mask_gb, 
+ const int *jhi_mask_gb,
+ const int *klo_mask_gb, 
+ const int *khi_mask_gb,
+ const int *index_x,
+ const int *index_y, 
+ const int *index_z,
+ const int *nlo_index, 
+ const int *nhi_index,
+ const LSMLIB_REAL *dx,
+ const LSMLIB_REAL *dy,
+ const LSMLIB_REAL *dz);
+
 /*!
 *
 *  LSM3D_COPY_DATA_LOCAL() copies array data from source to destination 
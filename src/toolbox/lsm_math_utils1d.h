@@ -24,6 +24,12 @@ extern "C" {
  * @ref lsm_utilities1d.h provides several utility functions that support
  * level set method calculations in one space dimension.
  *
+ * The volume and surface integrals and the average differences are
+ * accumulated using compensated (Kahan) summation in double precision
+ * (unless the library is built with USE_DOUBLE_PRECISION_ACCUMULATION
+ * turned off), so their accuracy does not degrade with the number of
+ * grid points in single-precision builds.
+ *
  */
 
 
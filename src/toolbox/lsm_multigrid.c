@@ -0,0 +1,912 @@
+/*
+ * File:        lsm_multigrid.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for geometric multigrid
+ *              Poisson/Helmholtz solver and heat method distance
+ *              computation
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsm_multigrid.h"
+#include "lsm_runtime.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Number of symmetric Gauss-Seidel sweeps on the coarsest level (which
+ * has at most 3 grid points in each direction).
+ */
+#define LSM_MULTIGRID_COARSE_SWEEPS                 (20)
+
+/*
+ * Face fraction below which a face is dropped (very small faces would
+ * only couple grid points outside of the domain weakly, which makes
+ * the system badly conditioned).
+ */
+#define LSM_MULTIGRID_MIN_FACE_FRACTION             (0.1)
+
+/*
+ * Ratio of the diameter of the ghostbox to the length scale sqrt(t) of
+ * the heat method above which t is increased (see
+ * computeDistanceFunctionHeatMethod()), and tolerance of the heat solve.
+ */
+#define LSM_MULTIGRID_HEAT_MAX_DECAY                (24.0)
+#define LSM_MULTIGRID_HEAT_TOLERANCE                (1.0e-12)
+#define LSM_MULTIGRID_HEAT_SHIFT_LAYER_LO           (1.5)
+#define LSM_MULTIGRID_HEAT_SHIFT_LAYER_HI           (3.0)
+
+/*
+ * Operations executed by multigridRows().
+ */
+typedef enum {
+  LSM_MULTIGRID_OP_APPLY,         /* out = A in                         */
+  LSM_MULTIGRID_OP_SMOOTH,        /* Gauss-Seidel on points of 'color'  */
+  LSM_MULTIGRID_OP_RESIDUAL,      /* out = f - A in                     */
+  LSM_MULTIGRID_OP_RESTRICT,      /* coarse f = sum of children of in   */
+  LSM_MULTIGRID_OP_PROLONG,       /* out += coarse u of parent          */
+  LSM_MULTIGRID_OP_DOT,           /* row_sums = in . f (unknowns)       */
+  LSM_MULTIGRID_OP_SUM,           /* row_sums = sum of in (unknowns)    */
+  LSM_MULTIGRID_OP_AXPY,          /* out += scale in (unknowns)         */
+  LSM_MULTIGRID_OP_XPAY,          /* out = in + scale out (unknowns)    */
+  LSM_MULTIGRID_OP_SHIFT          /* out -= scale at unknowns, 0 else   */
+} LSM_MultigridOp;
+
+typedef struct _LSM_MultigridTask
+{
+  LSM_MultigridSolver *solver;
+  int                  level;
+  LSM_MultigridOp      op;
+  const LSMLIB_REAL   *in;
+  const LSMLIB_REAL   *f;
+  LSMLIB_REAL         *out;
+  LSMLIB_REAL          scale;
+  int                  color;
+} LSM_MultigridTask;
+
+
+/*
+ * offDiagonalSum() returns sum_q face(p,q) u_q over the neighbors q of
+ * grid point p = (i,j,k).
+ */
+static LSMLIB_REAL offDiagonalSum(
+  const LSM_MultigridLevel *level,
+  const LSMLIB_REAL *u,
+  int i, int j, int k, int p)
+{
+  const int nx = level->dims[0];
+  const int nxy = nx*level->dims[1];
+  LSMLIB_REAL sum = 0.0;
+
+  if (i > 0)                  sum += level->face[0][p-1]*u[p-1];
+  if (i < nx-1)               sum += level->face[0][p]*u[p+1];
+  if (j > 0)                  sum += level->face[1][p-nx]*u[p-nx];
+  if (j < level->dims[1]-1)   sum += level->face[1][p]*u[p+nx];
+  if (k > 0)                  sum += level->face[2][p-nxy]*u[p-nxy];
+  if (k < level->dims[2]-1)   sum += level->face[2][p]*u[p+nxy];
+
+  return sum;
+}
+
+
+/*
+ * multigridRows() executes a grid operation on the rows (fixed j and k)
+ * begin, ..., end-1 of a level.
+ */
+static void multigridRows(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_MultigridTask *task = (LSM_MultigridTask*) user_data;
+  LSM_MultigridSolver *solver = task->solver;
+  const LSM_MultigridLevel *level = &solver->levels[task->level];
+  const int nx = level->dims[0];
+  const int ny = level->dims[1];
+  const LSMLIB_REAL *diag = level->diag;
+  const LSMLIB_REAL *in = task->in;
+  LSMLIB_REAL *out = task->out;
+  int row, i;
+
+  (void) thread_num;
+  for (row = begin; row < end; row++) {
+    const int j = row % ny;
+    const int k = row / ny;
+    const int p0 = row*nx;
+    double sum = 0.0;
+
+    switch (task->op) {
+      case LSM_MULTIGRID_OP_APPLY:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          out[p] = (diag[p] > 0)
+                 ? diag[p]*in[p] - offDiagonalSum(level, in, i, j, k, p)
+                 : 0.0;
+        }
+        break;
+
+      case LSM_MULTIGRID_OP_SMOOTH:
+        for (i = (j + k + task->color) & 1; i < nx; i += 2) {
+          const int p = p0 + i;
+          if (diag[p] > 0) {
+            out[p] = (task->f[p] + offDiagonalSum(level, out, i, j, k, p))
+                   / diag[p];
+          }
+        }
+        break;
+
+      case LSM_MULTIGRID_OP_RESIDUAL:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          out[p] = (diag[p] > 0)
+                 ? task->f[p] - diag[p]*in[p]
+                   + offDiagonalSum(level, in, i, j, k, p)
+                 : 0.0;
+        }
+        break;
+
+      case LSM_MULTIGRID_OP_RESTRICT: {
+        /* rows of the coarse level; in is the fine residual */
+        const LSM_MultigridLevel *fine = &solver->levels[task->level - 1];
+        const int fnx = fine->dims[0];
+        const int fny = fine->dims[1];
+        int dj, dk, di;
+        for (i = 0; i < nx; i++) {
+          LSMLIB_REAL value = 0.0;
+          for (dk = 0; dk < 2; dk++) {
+            const int fk = 2*k + dk;
+            if (fk >= fine->dims[2]) break;
+            for (dj = 0; dj < 2; dj++) {
+              const int fj = 2*j + dj;
+              if (fj >= fny) break;
+              for (di = 0; di < 2; di++) {
+                const int fi = 2*i + di;
+                if (fi >= fnx) break;
+                value += in[fi + fnx*(fj + fny*fk)];
+              }
+            }
+          }
+          out[p0 + i] = value;
+        }
+        break;
+      }
+
+      case LSM_MULTIGRID_OP_PROLONG: {
+        /* rows of the fine level; in is the coarse correction */
+        const LSM_MultigridLevel *coarse = &solver->levels[task->level + 1];
+        const int cp0 = coarse->dims[0]*((j/2) + coarse->dims[1]*(k/2));
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          if (diag[p] > 0) out[p] += in[cp0 + i/2];
+        }
+        break;
+      }
+
+      case LSM_MULTIGRID_OP_DOT:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          if (diag[p] > 0) sum += (double) in[p]*task->f[p];
+        }
+        solver->row_sums[row] = sum;
+        break;
+
+      case LSM_MULTIGRID_OP_SUM:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          if (diag[p] > 0) sum += in[p];
+        }
+        solver->row_sums[row] = sum;
+        break;
+
+      case LSM_MULTIGRID_OP_AXPY:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          if (diag[p] > 0) out[p] += task->scale*in[p];
+        }
+        break;
+
+      case LSM_MULTIGRID_OP_XPAY:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          if (diag[p] > 0) out[p] = in[p] + task->scale*out[p];
+        }
+        break;
+
+      case LSM_MULTIGRID_OP_SHIFT:
+        for (i = 0; i < nx; i++) {
+          const int p = p0 + i;
+          out[p] = (diag[p] > 0) ? out[p] - task->scale : 0.0;
+        }
+        break;
+    }
+  }
+}
+
+
+/*
+ * runMultigridOp() executes a grid operation on all rows of a level and
+ * returns the sum of the row sums (for OP_DOT and OP_SUM).
+ */
+static double runMultigridOp(
+  LSM_MultigridSolver *solver,
+  int level,
+  LSM_MultigridOp op,
+  const LSMLIB_REAL *in,
+  const LSMLIB_REAL *f,
+  LSMLIB_REAL *out,
+  LSMLIB_REAL scale,
+  int color)
+{
+  const LSM_MultigridLevel *lvl = &solver->levels[level];
+  const int num_rows = lvl->dims[1]*lvl->dims[2];
+  LSM_MultigridTask task;
+  double sum = 0.0;
+  int row;
+
+  task.solver = solver;
+  task.level = level;
+  task.op = op;
+  task.in = in;
+  task.f = f;
+  task.out = out;
+  task.scale = scale;
+  task.color = color;
+  LSM_Runtime_parallelFor(0, num_rows, LSM_SCHEDULE_STATIC, 0, 0,
+                          multigridRows, &task);
+
+  /* sum the row sums in a fixed order so that results do not */
+  /* depend on the number of threads                          */
+  if ( (op == LSM_MULTIGRID_OP_DOT) || (op == LSM_MULTIGRID_OP_SUM) ) {
+    for (row = 0; row < num_rows; row++) sum += solver->row_sums[row];
+  }
+  return sum;
+}
+
+
+/*
+ * removeMean() subtracts the mean over the unknowns from x.
+ */
+static void removeMean(LSM_MultigridSolver *solver, LSMLIB_REAL *x,
+                       int num_unknowns)
+{
+  double mean = runMultigridOp(solver, 0, LSM_MULTIGRID_OP_SUM, x, NULL,
+                               NULL, 0.0, 0) / num_unknowns;
+  runMultigridOp(solver, 0, LSM_MULTIGRID_OP_SHIFT, NULL, NULL, x,
+                 (LSMLIB_REAL) mean, 0);
+}
+
+
+/*
+ * vCycle() applies one V-cycle with zero initial guess to f on level l.
+ * Pre-smoothing visits red, then black points and post-smoothing black,
+ * then red points, so the V-cycle is a symmetric preconditioner.
+ */
+static void vCycle(
+  LSM_MultigridSolver *solver,
+  int l,
+  LSMLIB_REAL *u,
+  const LSMLIB_REAL *f)
+{
+  LSM_MultigridLevel *level = &solver->levels[l];
+  int num_sweeps = (l == solver->num_levels - 1)
+                 ? LSM_MULTIGRID_COARSE_SWEEPS : solver->num_smoothing_sweeps;
+  int s;
+
+  memset(u, 0, level->num_pts*sizeof(LSMLIB_REAL));
+  for (s = 0; s < num_sweeps; s++) {
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_SMOOTH, NULL, f, u, 0.0, 0);
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_SMOOTH, NULL, f, u, 0.0, 1);
+  }
+
+  if (l < solver->num_levels - 1) {
+    LSM_MultigridLevel *coarse = &solver->levels[l+1];
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_RESIDUAL, u, f, level->r,
+                   0.0, 0);
+    runMultigridOp(solver, l+1, LSM_MULTIGRID_OP_RESTRICT, level->r, NULL,
+                   coarse->f, 0.0, 0);
+    vCycle(solver, l+1, coarse->u, coarse->f);
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_PROLONG, coarse->u, NULL, u,
+                   0.0, 0);
+  }
+
+  for (s = 0; s < num_sweeps; s++) {
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_SMOOTH, NULL, f, u, 0.0, 1);
+    runMultigridOp(solver, l, LSM_MULTIGRID_OP_SMOOTH, NULL, f, u, 0.0, 0);
+  }
+}
+
+
+/*
+ * faceFraction() returns the fraction of the segment between grid
+ * points p and q that lies inside of the domain.
+ */
+static LSMLIB_REAL faceFraction(const LSMLIB_REAL *mask, int p, int q)
+{
+  LSMLIB_REAL m1, m2, fraction;
+
+  if (!mask) return 1.0;
+  m1 = mask[p];
+  m2 = mask[q];
+  if ( (m1 >= 0) && (m2 >= 0) ) return 1.0;
+  if ( (m1 < 0) && (m2 < 0) ) return 0.0;
+  fraction = (m1 >= 0) ? m1/(m1 - m2) : m2/(m2 - m1);
+  return (fraction < LSM_MULTIGRID_MIN_FACE_FRACTION) ? 0.0 : fraction;
+}
+
+
+/*
+ * allocateMultigridLevel() allocates the arrays of a level with the
+ * given dimensions.
+ */
+static int allocateMultigridLevel(LSM_MultigridLevel *level,
+                                  const int *dims, int num_dims,
+                                  int is_finest)
+{
+  int l;
+
+  level->num_pts = 1;
+  for (l = 0; l < 3; l++) {
+    level->dims[l] = dims[l];
+    level->num_pts *= dims[l];
+  }
+  for (l = 0; l < num_dims; l++) {
+    level->face[l] = (LSMLIB_REAL*) calloc(level->num_pts,
+                                           sizeof(LSMLIB_REAL));
+    if (!level->face[l]) return LSM_MULTIGRID_ERR_MEMORY_ALLOCATION;
+  }
+  level->diag = (LSMLIB_REAL*) calloc(level->num_pts, sizeof(LSMLIB_REAL));
+  level->r = (LSMLIB_REAL*) malloc(level->num_pts*sizeof(LSMLIB_REAL));
+  if ( (!level->diag) || (!level->r) ) {
+    return LSM_MULTIGRID_ERR_MEMORY_ALLOCATION;
+  }
+  if (!is_finest) {
+    level->u = (LSMLIB_REAL*) malloc(level->num_pts*sizeof(LSMLIB_REAL));
+    level->f = (LSMLIB_REAL*) malloc(level->num_pts*sizeof(LSMLIB_REAL));
+    if ( (!level->u) || (!level->f) ) {
+      return LSM_MULTIGRID_ERR_MEMORY_ALLOCATION;
+    }
+  }
+
+  return LSM_MULTIGRID_ERR_SUCCESS;
+}
+
+
+/*
+ * sumFaces() returns the sum of the coefficients of the faces adjacent
+ * to grid point p = (i,j,k).
+ */
+static LSMLIB_REAL sumFaces(const LSM_MultigridLevel *level,
+                            int i, int j, int k, int p)
+{
+  const int nx = level->dims[0];
+  const int nxy = nx*level->dims[1];
+  LSMLIB_REAL sum = 0.0;
+
+  if (i > 0)                  sum += level->face[0][p-1];
+  if (i < nx-1)               sum += level->face[0][p];
+  if (j > 0)                  sum += level->face[1][p-nx];
+  if (j < level->dims[1]-1)   sum += level->face[1][p];
+  if (k > 0)                  sum += level->face[2][p-nxy];
+  if (k < level->dims[2]-1)   sum += level->face[2][p];
+
+  return sum;
+}
+
+
+/*
+ * coarsenMultigridLevel() computes the coarse operator of level 'fine'.
+ * The Galerkin operator P^T A P for piecewise constant interpolation P
+ * has faces that are the sums of the fine faces between the coarse
+ * cells (faces inside a coarse cell cancel) and diagonal terms (alpha
+ * and Dirichlet terms) that are the sums over the children.  Its
+ * diffusion part is twice as large as that of the operator
+ * rediscretized on the coarse grid, which makes the coarse grid
+ * correction too small, so the face sums are halved.
+ */
+static void coarsenMultigridLevel(const LSM_MultigridLevel *fine,
+                                  LSM_MultigridLevel *coarse, int num_dims)
+{
+  const int *fd = fine->dims;
+  const int *cd = coarse->dims;
+  int i, j, k, di, dj, dk, l;
+
+  for (k = 0; k < cd[2]; k++) {
+    for (j = 0; j < cd[1]; j++) {
+      for (i = 0; i < cd[0]; i++) {
+        const int c = i + cd[0]*(j + cd[1]*k);
+        LSMLIB_REAL extra = 0.0;
+        for (dk = 0; dk < 2 && 2*k + dk < fd[2]; dk++) {
+          for (dj = 0; dj < 2 && 2*j + dj < fd[1]; dj++) {
+            for (di = 0; di < 2 && 2*i + di < fd[0]; di++) {
+              const int fi = 2*i + di, fj = 2*j + dj, fk = 2*k + dk;
+              const int f = fi + fd[0]*(fj + fd[1]*fk);
+              const int child[3] = {di, dj, dk};
+              const int upper[3] = {i < cd[0]-1, j < cd[1]-1, k < cd[2]-1};
+              extra += fine->diag[f] - sumFaces(fine, fi, fj, fk, f);
+              for (l = 0; l < num_dims; l++) {
+                if ( (child[l] == 1) && upper[l] ) {
+                  coarse->face[l][c] += 0.5*fine->face[l][f];
+                }
+              }
+            }
+          }
+        }
+        coarse->diag[c] = extra;
+      }
+    }
+  }
+
+  for (k = 0; k < cd[2]; k++) {
+    for (j = 0; j < cd[1]; j++) {
+      for (i = 0; i < cd[0]; i++) {
+        const int c = i + cd[0]*(j + cd[1]*k);
+        coarse->diag[c] += sumFaces(coarse, i, j, k, c);
+      }
+    }
+  }
+}
+
+
+/*
+ * centralGradient() computes the gradient of a field at grid point p
+ * with index idx by central differences (one-sided differences at the
+ * boundary of the ghostbox).
+ */
+static void centralGradient(
+  const LSMLIB_REAL *field,
+  int p,
+  const int *idx,
+  const int *dims,
+  const int *strides,
+  const LSMLIB_REAL *dx,
+  int num_dims,
+  LSMLIB_REAL *grad)
+{
+  int l;
+
+  for (l = 0; l < 3; l++) {
+    grad[l] = 0.0;
+    if (l < num_dims) {
+      int lo = (idx[l] > 0) ? p - strides[l] : p;
+      int hi = (idx[l] < dims[l]-1) ? p + strides[l] : p;
+      if (hi != lo) {
+        grad[l] = (field[hi] - field[lo])/((hi - lo)/strides[l]*dx[l]);
+      }
+    }
+  }
+}
+
+
+/*==================== Function Definitions ==========================*/
+
+LSM_MultigridSolver *createMultigridSolver(
+  Grid *grid,
+  LSMLIB_REAL alpha,
+  LSMLIB_REAL beta,
+  const LSMLIB_REAL *mask,
+  LSM_MultigridBoundaryCondition boundary_condition)
+{
+  LSM_MultigridSolver *solver;
+  LSM_MultigridLevel *fine;
+  int dims[3], max_rows;
+  int i, j, k, l;
+
+  if ( (!grid) || (grid->num_dims < 2) || (grid->num_dims > 3)
+    || (alpha < 0) || (beta <= 0) ) {
+    return NULL;
+  }
+  if ( (boundary_condition != LSM_MULTIGRID_DIRICHLET)
+    && (boundary_condition != LSM_MULTIGRID_NEUMANN) ) {
+    return NULL;
+  }
+
+  solver = (LSM_MultigridSolver*) calloc(1, sizeof(LSM_MultigridSolver));
+  if (!solver) return NULL;
+  solver->num_dims = grid->num_dims;
+  solver->alpha = alpha;
+  solver->beta = beta;
+  solver->boundary_condition = boundary_condition;
+  solver->is_singular = (alpha == 0)
+                     && (boundary_condition == LSM_MULTIGRID_NEUMANN);
+  solver->tolerance = LSM_MULTIGRID_DEFAULT_TOLERANCE;
+  solver->max_iterations = LSM_MULTIGRID_DEFAULT_MAX_ITERATIONS;
+  solver->num_smoothing_sweeps = LSM_MULTIGRID_DEFAULT_SMOOTHING_SWEEPS;
+
+  /* finest level */
+  for (l = 0; l < 3; l++) {
+    dims[l] = (l < grid->num_dims) ? grid->grid_dims_ghostbox[l] : 1;
+  }
+  fine = &solver->levels[0];
+  solver->num_levels = 1;
+  if (allocateMultigridLevel(fine, dims, grid->num_dims, 1)
+      != LSM_MULTIGRID_ERR_SUCCESS) {
+    goto error;
+  }
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int p = i + dims[0]*(j + dims[1]*k);
+        const int idx[3] = {i, j, k};
+        int stride = 1;
+        LSMLIB_REAL volume = ( (!mask) || (mask[p] >= 0) ) ? 1.0 : 0.0;
+        fine->diag[p] = alpha*volume;
+        for (l = 0; l < grid->num_dims; l++) {
+          LSMLIB_REAL scale = beta/(grid->dx[l]*grid->dx[l]);
+          if (idx[l] < dims[l]-1) {
+            fine->face[l][p] = scale*faceFraction(mask, p, p + stride);
+          }
+          if ( (boundary_condition == LSM_MULTIGRID_DIRICHLET)
+            && ((idx[l] == 0) || (idx[l] == dims[l]-1)) ) {
+            fine->diag[p] += scale*volume;
+          }
+          stride *= dims[l];
+        }
+      }
+    }
+  }
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int p = i + dims[0]*(j + dims[1]*k);
+        fine->diag[p] += sumFaces(fine, i, j, k, p);
+      }
+    }
+  }
+
+  /* coarse levels (until at most 3 points remain in each direction) */
+  while (solver->num_levels < LSM_MULTIGRID_MAX_LEVELS) {
+    LSM_MultigridLevel *prev = &solver->levels[solver->num_levels - 1];
+    int max_dim = 0;
+    for (l = 0; l < 3; l++) {
+      if (prev->dims[l] > max_dim) max_dim = prev->dims[l];
+      dims[l] = (prev->dims[l] + 1)/2;
+    }
+    if (max_dim <= 3) break;
+    if (allocateMultigridLevel(&solver->levels[solver->num_levels], dims,
+                               grid->num_dims, 0)
+        != LSM_MULTIGRID_ERR_SUCCESS) {
+      solver->num_levels++;
+      goto error;
+    }
+    coarsenMultigridLevel(prev, &solver->levels[solver->num_levels],
+                          grid->num_dims);
+    solver->num_levels++;
+  }
+
+  /* conjugate gradient work vectors */
+  solver->r = (LSMLIB_REAL*) malloc(fine->num_pts*sizeof(LSMLIB_REAL));
+  solver->z = (LSMLIB_REAL*) malloc(fine->num_pts*sizeof(LSMLIB_REAL));
+  solver->p = (LSMLIB_REAL*) malloc(fine->num_pts*sizeof(LSMLIB_REAL));
+  solver->Ap = (LSMLIB_REAL*) malloc(fine->num_pts*sizeof(LSMLIB_REAL));
+  max_rows = fine->dims[1]*fine->dims[2];
+  solver->row_sums = (double*) malloc(max_rows*sizeof(double));
+  if ( (!solver->r) || (!solver->z) || (!solver->p) || (!solver->Ap)
+    || (!solver->row_sums) ) {
+    goto error;
+  }
+
+  return solver;
+
+error:
+  destroyMultigridSolver(solver);
+  return NULL;
+}
+
+
+void destroyMultigridSolver(LSM_MultigridSolver *solver)
+{
+  int n, l;
+
+  if (!solver) return;
+  for (n = 0; n < solver->num_levels; n++) {
+    LSM_MultigridLevel *level = &solver->levels[n];
+    for (l = 0; l < 3; l++) free(level->face[l]);
+    free(level->diag);
+    free(level->u);
+    free(level->f);
+    free(level->r);
+  }
+  free(solver->r);
+  free(solver->z);
+  free(solver->p);
+  free(solver->Ap);
+  free(solver->row_sums);
+  free(solver);
+}
+
+
+int solveMultigrid(
+  LSM_MultigridSolver *solver,
+  LSMLIB_REAL *u,
+  LSMLIB_REAL *f)
+{
+  LSM_MultigridLevel *fine;
+  LSMLIB_REAL *r;
+  double norm_f, rz = 0.0, rz_prev = 1.0;
+  int num_unknowns = 0;
+  int it;
+
+  if ( (!solver) || (!u) || (!f) ) return LSM_MULTIGRID_ERR_INVALID_ARGUMENT;
+  fine = &solver->levels[0];
+  r = solver->r;
+
+  /* restrict u to the unknowns */
+  runMultigridOp(solver, 0, LSM_MULTIGRID_OP_SHIFT, NULL, NULL, u, 0.0, 0);
+  if (solver->is_singular) {
+    int p;
+    for (p = 0; p < fine->num_pts; p++) {
+      if (fine->diag[p] > 0) num_unknowns++;
+    }
+    if (num_unknowns == 0) return LSM_MULTIGRID_ERR_SUCCESS;
+    removeMean(solver, f, num_unknowns);
+  }
+
+  norm_f = sqrt(runMultigridOp(solver, 0, LSM_MULTIGRID_OP_DOT, f, f, NULL,
+                               0.0, 0));
+  runMultigridOp(solver, 0, LSM_MULTIGRID_OP_RESIDUAL, u, f, r, 0.0, 0);
+
+  solver->num_iterations = 0;
+  solver->residual_norm = 0.0;
+  if (norm_f == 0.0) {
+    memset(u, 0, fine->num_pts*sizeof(LSMLIB_REAL));
+    return LSM_MULTIGRID_ERR_SUCCESS;
+  }
+
+  for (it = 0; ; it++) {
+    double pAp, step;
+
+    solver->residual_norm = (LSMLIB_REAL) (sqrt(runMultigridOp(
+        solver, 0, LSM_MULTIGRID_OP_DOT, r, r, NULL, 0.0, 0)) / norm_f);
+    if ( (solver->residual_norm <= solver->tolerance)
+      || (it == solver->max_iterations) ) {
+      break;
+    }
+
+    /* z = M r, p = z + (rz/rz_prev) p */
+    vCycle(solver, 0, solver->z, r);
+    if (solver->is_singular) removeMean(solver, solver->z, num_unknowns);
+    rz = runMultigridOp(solver, 0, LSM_MULTIGRID_OP_DOT, r, solver->z,
+                        NULL, 0.0, 0);
+    if (it == 0) {
+      memcpy(solver->p, solver->z, fine->num_pts*sizeof(LSMLIB_REAL));
+    } else {
+      runMultigridOp(solver, 0, LSM_MULTIGRID_OP_XPAY, solver->z, NULL,
+                     solver->p, (LSMLIB_REAL) (rz/rz_prev), 0);
+    }
+    rz_prev = rz;
+
+    /* u += step p, r -= step Ap */
+    runMultigridOp(solver, 0, LSM_MULTIGRID_OP_APPLY, solver->p, NULL,
+                   solver->Ap, 0.0, 0);
+    pAp = runMultigridOp(solver, 0, LSM_MULTIGRID_OP_DOT, solver->p,
+                         solver->Ap, NULL, 0.0, 0);
+    if (pAp <= 0.0) break;
+    step = rz/pAp;
+    runMultigridOp(solver, 0, LSM_MULTIGRID_OP_AXPY, solver->p, NULL, u,
+                   (LSMLIB_REAL) step, 0);
+    runMultigridOp(solver, 0, LSM_MULTIGRID_OP_AXPY, solver->Ap, NULL, r,
+                   (LSMLIB_REAL) -step, 0);
+  }
+  solver->num_iterations = it;
+  if (solver->is_singular) removeMean(solver, u, num_unknowns);
+
+  return (solver->residual_norm <= solver->tolerance)
+       ? LSM_MULTIGRID_ERR_SUCCESS : LSM_MULTIGRID_ERR_NOT_CONVERGED;
+}
+
+
+void applyMultigridOperator(
+  LSM_MultigridSolver *solver,
+  LSMLIB_REAL *Au,
+  const LSMLIB_REAL *u)
+{
+  runMultigridOp(solver, 0, LSM_MULTIGRID_OP_APPLY, u, NULL, Au, 0.0, 0);
+}
+
+
+int computeDistanceFunctionHeatMethod(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *mask,
+  Grid *grid)
+{
+  LSM_MultigridSolver *heat = NULL, *poisson = NULL;
+  LSMLIB_REAL *u = NULL, *source = NULL, *X[3] = {NULL, NULL, NULL};
+  unsigned char *near_interface = NULL;
+  LSMLIB_REAL h = 0.0, diameter = 0.0, sqrt_t, shift = 0.0;
+  const LSM_MultigridLevel *fine;
+  int dims[3], strides[3], num_dims, num_pts, num_near_interface = 0;
+  int i, j, k, l, p;
+  int err = LSM_MULTIGRID_ERR_SUCCESS;
+
+  if ( (!distance_function) || (!phi) || (!grid)
+    || (grid->num_dims < 2) || (grid->num_dims > 3) ) {
+    return LSM_MULTIGRID_ERR_INVALID_ARGUMENT;
+  }
+  num_dims = grid->num_dims;
+  for (l = 0; l < 3; l++) {
+    dims[l] = (l < num_dims) ? grid->grid_dims_ghostbox[l] : 1;
+  }
+  strides[0] = 1;
+  strides[1] = dims[0];
+  strides[2] = dims[0]*dims[1];
+  num_pts = dims[0]*dims[1]*dims[2];
+  for (l = 0; l < num_dims; l++) {
+    LSMLIB_REAL length = (dims[l] - 1)*grid->dx[l];
+    if (grid->dx[l] > h) h = grid->dx[l];
+    diameter += length*length;
+  }
+  diameter = sqrt(diameter);
+
+  /* the heat kernel decays like exp(-d/sqrt(t)), so t is increased on */
+  /* large grids to keep the decay resolvable by an iterative solve    */
+  sqrt_t = h;
+  if (diameter/sqrt_t > LSM_MULTIGRID_HEAT_MAX_DECAY) {
+    sqrt_t = diameter/LSM_MULTIGRID_HEAT_MAX_DECAY;
+  }
+
+  u = (LSMLIB_REAL*) calloc(num_pts, sizeof(LSMLIB_REAL));
+  source = (LSMLIB_REAL*) calloc(num_pts, sizeof(LSMLIB_REAL));
+  near_interface = (unsigned char*) calloc(num_pts, 1);
+  for (l = 0; l < num_dims; l++) {
+    X[l] = (LSMLIB_REAL*) calloc(num_pts, sizeof(LSMLIB_REAL));
+  }
+  heat = createMultigridSolver(grid, 1.0, sqrt_t*sqrt_t, mask,
+                               LSM_MULTIGRID_DIRICHLET);
+  poisson = createMultigridSolver(grid, 0.0, 1.0, mask,
+                                  LSM_MULTIGRID_NEUMANN);
+  if ( (!u) || (!source) || (!near_interface) || (!X[0]) || (!X[1])
+    || ((num_dims == 3) && (!X[2])) || (!heat) || (!poisson) ) {
+    err = LSM_MULTIGRID_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+  fine = &poisson->levels[0];
+
+  /* step 1:  heat flow from the interface (each crossing of a grid */
+  /* edge is distributed to the two grid points by linear weights)  */
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int idx[3] = {i, j, k};
+        p = i + dims[0]*(j + dims[1]*k);
+        if ( mask && (mask[p] < 0) ) continue;
+        for (l = 0; l < num_dims; l++) {
+          if (idx[l] < dims[l]-1) {
+            const int q = p + strides[l];
+            if ( ((phi[p] < 0) != (phi[q] < 0))
+              && ( (!mask) || (mask[q] >= 0) ) ) {
+              LSMLIB_REAL theta = phi[p]/(phi[p] - phi[q]);
+              source[p] += 1.0 - theta;
+              source[q] += theta;
+              near_interface[p] = 1;
+              near_interface[q] = 1;
+            }
+          }
+        }
+      }
+    }
+  }
+  for (p = 0; p < num_pts; p++) {
+    num_near_interface += near_interface[p];
+  }
+  if (num_near_interface == 0) {
+    err = LSM_MULTIGRID_ERR_INVALID_ARGUMENT;
+    goto cleanup;
+  }
+  heat->tolerance = LSM_MULTIGRID_HEAT_TOLERANCE;
+  err = solveMultigrid(heat, u, source);
+  if (err != LSM_MULTIGRID_ERR_SUCCESS) goto cleanup;
+
+  /* step 2:  X = -grad u / |grad u| */
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int idx[3] = {i, j, k};
+        LSMLIB_REAL grad[3], norm;
+        p = i + dims[0]*(j + dims[1]*k);
+        centralGradient(u, p, idx, dims, strides, grid->dx, num_dims, grad);
+        norm = sqrt(grad[0]*grad[0] + grad[1]*grad[1] + grad[2]*grad[2]);
+        for (l = 0; l < num_dims; l++) {
+          X[l][p] = (norm > 0) ? -grad[l]/norm : 0.0;
+        }
+      }
+    }
+  }
+
+  /* step 3:  solve Laplacian d = div X, i.e. A d = -div X in the */
+  /* flux form of the operator (so the system is consistent)     */
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int idx[3] = {i, j, k};
+        LSMLIB_REAL div = 0.0;
+        p = i + dims[0]*(j + dims[1]*k);
+        for (l = 0; l < num_dims; l++) {
+          if (idx[l] < dims[l]-1) {
+            const int q = p + strides[l];
+            div += fine->face[l][p]*grid->dx[l]*0.5*(X[l][p] + X[l][q]);
+          }
+          if (idx[l] > 0) {
+            const int q = p - strides[l];
+            div -= fine->face[l][q]*grid->dx[l]*0.5*(X[l][p] + X[l][q]);
+          }
+        }
+        source[p] = -div;
+      }
+    }
+  }
+  memset(distance_function, 0, num_pts*sizeof(LSMLIB_REAL));
+  err = solveMultigrid(poisson, distance_function, source);
+  if (err != LSM_MULTIGRID_ERR_SUCCESS) goto cleanup;
+
+  /* shift d so that it matches the first-order distance estimate   */
+  /* |phi|/|grad phi| (on average) in a layer of grid points between */
+  /* LSM_MULTIGRID_HEAT_SHIFT_LAYER_LO and _HI grid cells from the    */
+  /* interface (d is rounded off closer to the interface, where X    */
+  /* changes direction) and apply the sign of phi                    */
+  num_near_interface = 0;
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int idx[3] = {i, j, k};
+        LSMLIB_REAL grad[3], norm, estimate;
+        p = i + dims[0]*(j + dims[1]*k);
+        if (fine->diag[p] <= 0) continue;
+        centralGradient(phi, p, idx, dims, strides, grid->dx, num_dims,
+                        grad);
+        norm = sqrt(grad[0]*grad[0] + grad[1]*grad[1] + grad[2]*grad[2]);
+        if (norm <= 0) continue;
+        estimate = fabs(phi[p])/norm;
+        if ( (estimate >= LSM_MULTIGRID_HEAT_SHIFT_LAYER_LO*h)
+          && (estimate <= LSM_MULTIGRID_HEAT_SHIFT_LAYER_HI*h) ) {
+          shift += distance_function[p] - estimate;
+          num_near_interface++;
+        }
+      }
+    }
+  }
+  if (num_near_interface > 0) shift /= num_near_interface;
+
+  /* the grid points next to the interface are set to the first-order */
+  /* estimate (as when the fast marching method is initialized)       */
+  for (k = 0; k < dims[2]; k++) {
+    for (j = 0; j < dims[1]; j++) {
+      for (i = 0; i < dims[0]; i++) {
+        const int idx[3] = {i, j, k};
+        LSMLIB_REAL d = 0.0, grad[3], norm;
+        p = i + dims[0]*(j + dims[1]*k);
+        if ( (fine->diag[p] <= 0) || (mask && (mask[p] < 0)) ) {
+          distance_function[p] = 0.0;
+          continue;
+        }
+        if (near_interface[p]) {
+          centralGradient(phi, p, idx, dims, strides, grid->dx, num_dims,
+                          grad);
+          norm = sqrt(grad[0]*grad[0] + grad[1]*grad[1] + grad[2]*grad[2]);
+          d = (norm > 0) ? fabs(phi[p])/norm
+                         : fabs(distance_function[p] - shift);
+        } else {
+          d = fabs(distance_function[p] - shift);
+        }
+        distance_function[p] = (phi[p] < 0) ? -d : d;
+      }
+    }
+  }
+
+cleanup:
+  destroyMultigridSolver(heat);
+  destroyMultigridSolver(poisson);
+  free(u);
+  free(source);
+  free(near_interface);
+  for (l = 0; l < 3; l++) free(X[l]);
+  return err;
+}
@@ -0,0 +1,282 @@
+/*
+ * File:        lsm_multigrid.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for geometric multigrid Poisson/Helmholtz
+ *              solver and heat method distance computation
+ */
+
+#ifndef included_lsm_multigrid_h
+#define included_lsm_multigrid_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_multigrid.h
+ *
+ * \brief
+ * @ref lsm_multigrid.h provides a matrix-free geometric multigrid
+ * solver for the Helmholtz equation
+ *
+ *   alpha u - beta div(c grad u) = f
+ *
+ * (the Poisson equation for alpha = 0) on the ghostbox of a 2D or 3D
+ * Grid, and computeDistanceFunctionHeatMethod(), which computes a
+ * distance function with two such solves (the heat method).
+ *
+ * The equation is discretized with the standard 5-point (2D) or
+ * 7-point (3D) stencil.  The coefficient c of the face between two
+ * neighboring grid points is the fraction of the segment joining them
+ * that lies inside the domain { mask >= 0 }; the volume weight of the
+ * alpha term is 1 at grid points inside the domain and 0 outside.
+ * Thus, a mask imposes homogeneous Neumann conditions on its zero
+ * level set (an embedded boundary).  Grid points without any coupling
+ * to the domain are not unknowns.
+ *
+ * At the boundary of the ghostbox, either homogeneous Dirichlet
+ * conditions (u = 0 one grid cell outside of the ghostbox) or
+ * homogeneous Neumann conditions are imposed.
+ *
+ * The linear system is solved by the conjugate gradient method
+ * preconditioned with one multigrid V-cycle per iteration.  Coarse
+ * levels aggregate 2x2 (2D) or 2x2x2 (3D) grid points.  The coarse
+ * operators are built from sums of the fine coefficients (the Galerkin
+ * products for piecewise constant interpolation with the diffusion
+ * part scaled to match rediscretization), so the mask is carried to
+ * all levels without resampling it.  The smoother is red-black
+ * Gauss-Seidel, which is executed on the threads of the LSMLIB runtime
+ * (see @ref lsm_runtime.h), as are all other grid operations.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create a solver using createMultigridSolver().
+ * -# Optionally change the parameters (tolerance, max_iterations,
+ *    num_smoothing_sweeps) in the LSM_MultigridSolver structure.
+ * -# Solve for one or more right-hand sides using solveMultigrid().
+ * -# Free the solver using destroyMultigridSolver().
+ *
+ */
+
+
+/*!
+ * Error codes returned by multigrid functions.
+ */
+#define LSM_MULTIGRID_ERR_SUCCESS                   (0)
+#define LSM_MULTIGRID_ERR_INVALID_ARGUMENT          (1)
+#define LSM_MULTIGRID_ERR_MEMORY_ALLOCATION         (2)
+#define LSM_MULTIGRID_ERR_NOT_CONVERGED             (3)
+
+/*!
+ * Maximum number of multigrid levels.
+ */
+#define LSM_MULTIGRID_MAX_LEVELS                    (16)
+
+/*!
+ * Default relative residual tolerance, maximum number of iterations and
+ * number of pre- and post-smoothing sweeps.
+ */
+#define LSM_MULTIGRID_DEFAULT_TOLERANCE             (1.0e-8)
+#define LSM_MULTIGRID_DEFAULT_MAX_ITERATIONS        (100)
+#define LSM_MULTIGRID_DEFAULT_SMOOTHING_SWEEPS      (2)
+
+/*!
+ * LSM_MultigridBoundaryCondition selects the boundary condition at the
+ * boundary of the ghostbox.
+ */
+typedef enum {
+  LSM_MULTIGRID_DIRICHLET = 0,
+  LSM_MULTIGRID_NEUMANN   = 1
+} LSM_MultigridBoundaryCondition;
+
+/*!
+ * Structure 'LSM_MultigridLevel' holds the operator and work vectors of
+ * one multigrid level.
+ */
+typedef struct _LSM_MultigridLevel
+{
+  int           dims[3];          /* grid dimensions (1 in unused dims) */
+  int           num_pts;
+  LSMLIB_REAL  *face[3];          /* coefficient of the face between p  */
+                                  /* and p + e_l (0 at the upper end)   */
+  LSMLIB_REAL  *diag;             /* diagonal of the operator           */
+  LSMLIB_REAL  *u;                /* correction (coarse levels)         */
+  LSMLIB_REAL  *f;                /* right-hand side (coarse levels)    */
+  LSMLIB_REAL  *r;                /* residual                           */
+} LSM_MultigridLevel;
+
+/*!
+ * Structure 'LSM_MultigridSolver' holds the multigrid hierarchy, the
+ * solver parameters and the statistics of the last solve.
+ */
+typedef struct _LSM_MultigridSolver
+{
+  /* operator */
+  int           num_dims;
+  LSMLIB_REAL   alpha;
+  LSMLIB_REAL   beta;
+  LSM_MultigridBoundaryCondition boundary_condition;
+  int           is_singular;      /* constants are in the null space    */
+
+  /* multigrid hierarchy (level 0 is the Grid) */
+  int           num_levels;
+  LSM_MultigridLevel levels[LSM_MULTIGRID_MAX_LEVELS];
+
+  /* parameters */
+  LSMLIB_REAL   tolerance;        /* relative residual tolerance        */
+  int           max_iterations;
+  int           num_smoothing_sweeps;
+
+  /* conjugate gradient work vectors and per-row partial sums */
+  LSMLIB_REAL  *r;
+  LSMLIB_REAL  *z;
+  LSMLIB_REAL  *p;
+  LSMLIB_REAL  *Ap;
+  double       *row_sums;
+
+  /* statistics of the last solve */
+  int           num_iterations;
+  LSMLIB_REAL   residual_norm;    /* relative residual (2-norm)         */
+} LSM_MultigridSolver;
+
+
+/*!
+ * createMultigridSolver() creates a solver for the Helmholtz equation
+ * alpha u - beta div(c grad u) = f on a Grid.
+ *
+ * Arguments:
+ *  - grid (in):                Grid of the fields
+ *  - alpha (in):               coefficient of u (alpha >= 0)
+ *  - beta (in):                diffusion coefficient (beta > 0)
+ *  - mask (in):                domain of the problem (grid points outside
+ *                              of the domain are negative); may be NULL
+ *  - boundary_condition (in):  boundary condition at the boundary of
+ *                              the ghostbox
+ *
+ * Return value:                pointer to new solver (NULL on failure)
+ *
+ * NOTES:
+ *  - For alpha = 0 and Neumann boundary conditions, the operator is
+ *    singular.  solveMultigrid() then projects the constant out of the
+ *    right-hand side and returns the solution with zero mean.
+ *
+ */
+LSM_MultigridSolver *createMultigridSolver(
+  Grid *grid,
+  LSMLIB_REAL alpha,
+  LSMLIB_REAL beta,
+  const LSMLIB_REAL *mask,
+  LSM_MultigridBoundaryCondition boundary_condition);
+
+/*!
+ * destroyMultigridSolver() frees a solver.
+ *
+ * Arguments:
+ *  - solver (in):  pointer to solver (may be NULL)
+ *
+ * Return value:    none
+ *
+ */
+void destroyMultigridSolver(LSM_MultigridSolver *solver);
+
+/*!
+ * solveMultigrid() solves the Helmholtz equation.
+ *
+ * Arguments:
+ *  - solver (in/out):  solver
+ *  - u (in/out):       initial guess on input, solution on output
+ *  - f (in/out):       right-hand side (modified only if the operator
+ *                      is singular; see createMultigridSolver())
+ *
+ * Return value:        error code (LSM_MULTIGRID_ERR_NOT_CONVERGED if
+ *                      the tolerance was not reached in max_iterations
+ *                      iterations; u then holds the last iterate)
+ *
+ * NOTES:
+ *  - u is set to 0 at grid points that are not unknowns.
+ *
+ */
+int solveMultigrid(
+  LSM_MultigridSolver *solver,
+  LSMLIB_REAL *u,
+  LSMLIB_REAL *f);
+
+/*!
+ * applyMultigridOperator() computes Au = alpha u - beta div(c grad u).
+ *
+ * Arguments:
+ *  - solver (in):  solver
+ *  - Au (out):     result
+ *  - u (in):       field
+ *
+ * Return value:    none
+ *
+ */
+void applyMultigridOperator(
+  LSM_MultigridSolver *solver,
+  LSMLIB_REAL *Au,
+  const LSMLIB_REAL *u);
+
+/*!
+ * computeDistanceFunctionHeatMethod() computes the signed distance
+ * function to the zero level set of phi using the heat method:
+ *
+ * -# solve (I - t Laplacian) u = u0 (Dirichlet boundary conditions),
+ *    where u0 distributes the crossings of grid edges by the zero level
+ *    set to the grid points at their ends,
+ * -# compute the unit vector field X = -grad u / |grad u|, and
+ * -# solve the Poisson equation Laplacian d = div X (Neumann boundary
+ *    conditions) and shift d so that it matches |phi|/|grad phi| near
+ *    the zero level set.
+ *
+ * The grid points next to the zero level set are set to
+ * phi/|grad phi|.
+ *
+ * Arguments:
+ *  - distance_function (out):  signed distance function (sign of phi)
+ *  - phi (in):                 level set function
+ *  - mask (in):                domain of the problem (grid points outside
+ *                              of the domain are negative); may be NULL
+ *  - grid (in):                Grid of the fields
+ *
+ * Return value:                error code
+ *                                (LSM_MULTIGRID_ERR_INVALID_ARGUMENT if
+ *                                phi has no zero level set)
+ *
+ * NOTES:
+ *  - The result is a smooth approximation of the distance function
+ *    whose error is about one grid cell near the interface and a few
+ *    grid cells far from it.  It is an alternative to the fast marching
+ *    method when smoothness matters more than exact distances, and it
+ *    consists of grid-wide solves that run on all threads of the
+ *    LSMLIB runtime.
+ *
+ *  - t = max(dx)^2 unless the diameter of the ghostbox exceeds
+ *    24 sqrt(t); then t is increased so that the heat kernel, which
+ *    decays like exp(-d/sqrt(t)), stays above the solver tolerance on
+ *    the whole grid.
+ *
+ *  - For grid points that are masked out, the distance function is set
+ *    to 0.
+ *
+ */
+int computeDistanceFunctionHeatMethod(
+  LSMLIB_REAL *distance_function,
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *mask,
+  Grid *grid);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
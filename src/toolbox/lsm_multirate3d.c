@@ -0,0 +1,429 @@
+/*
+ * File:        lsm_multirate3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of multirate local time stepping in the
+ *              3D narrow band
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsmlib_config.h"
+#include "lsm_multirate3d.h"
+#include "lsm_runtime.h"
+#include "lsm_tvd_runge_kutta3d_local.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Bin value of grid points outside of the narrow band.
+ */
+#define LSM_MULTIRATE_NO_BIN                        (0xFF)
+
+/*
+ * Structure 'LSM_MultirateInterpArgs' holds the arguments of
+ * interpolateInTime().
+ */
+typedef struct _LSM_MultirateInterpArgs
+{
+  LSM_MultirateStepper3d *stepper;
+  const LSMLIB_REAL *phi;
+  int substep;                    /* time of the interpolated values    */
+                                  /* in units of dt_min                 */
+} LSM_MultirateInterpArgs;
+
+
+/*
+ * interpolateInTime() is the LSM_Runtime_parallelFor() body that sets
+ * phi_eval at points in the middle of a step to the linear interpolant
+ * in time between phi_start (beginning of the step) and phi (end of the
+ * step).  Iterations correspond to positions in the index_* arrays.
+ */
+static void interpolateInTime(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+  LSM_MultirateInterpArgs *args = (LSM_MultirateInterpArgs *) user_data;
+  LSM_MultirateStepper3d *stepper = args->stepper;
+  const Grid *grid = stepper->grid;
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  int m;
+
+  (void) thread_num;
+
+  for (m = begin; m < end; m++) {
+    int idx = stepper->index_x[m] + stepper->index_y[m]*nx
+            + stepper->index_z[m]*nxy;
+    int step = 1 << stepper->bin[idx];
+    LSMLIB_REAL w = (LSMLIB_REAL) (args->substep % step)/step;
+    if ( (w == 0) && (args->substep > 0) ) w = 1.0;
+    stepper->phi_eval[idx] = (1.0 - w)*stepper->phi_start[idx]
+                           + w*args->phi[idx];
+  }
+}
+
+
+/*
+ * rk1Step() calls LSM3D_RK1_STEP_LOCAL() for the points m_lo, ..., m_hi
+ * of the stepper.  The Fortran kernels declare the index arrays with
+ * bounds (nlo_index:nhi_index), so they are passed starting at m_lo.
+ */
+static void rk1Step(
+  LSM_MultirateStepper3d *stepper,
+  LSMLIB_REAL *u_next,
+  const LSMLIB_REAL *u_cur,
+  const LSMLIB_REAL *rhs,
+  LSMLIB_REAL dt,
+  int m_lo,
+  int m_hi,
+  const unsigned char *narrow_band,
+  unsigned char mark_fb)
+{
+  const Grid *g = stepper->grid;
+
+  LSM3D_RK1_STEP_LOCAL(
+    u_next, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    u_cur, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    rhs, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &dt,
+    stepper->index_x + m_lo, stepper->index_y + m_lo,
+    stepper->index_z + m_lo, &m_lo, &m_hi,
+    narrow_band, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &mark_fb);
+}
+
+
+/*
+ * rk2Stage2() calls LSM3D_TVD_RK2_STAGE2_LOCAL() for the points
+ * m_lo, ..., m_hi of the stepper.
+ */
+static void rk2Stage2(
+  LSM_MultirateStepper3d *stepper,
+  LSMLIB_REAL *u_next,
+  const LSMLIB_REAL *u_stage1,
+  const LSMLIB_REAL *u_cur,
+  const LSMLIB_REAL *rhs,
+  LSMLIB_REAL dt,
+  int m_lo,
+  int m_hi,
+  const unsigned char *narrow_band,
+  unsigned char mark_fb)
+{
+  const Grid *g = stepper->grid;
+
+  LSM3D_TVD_RK2_STAGE2_LOCAL(
+    u_next, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    u_stage1, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    u_cur, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    rhs, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &dt,
+    stepper->index_x + m_lo, stepper->index_y + m_lo,
+    stepper->index_z + m_lo, &m_lo, &m_hi,
+    narrow_band, &g->ilo_gb, &g->ihi_gb, &g->jlo_gb, &g->jhi_gb,
+    &g->klo_gb, &g->khi_gb,
+    &mark_fb);
+}
+
+
+/*
+ * gradeBins() lowers the bins of narrow band points until the bins of
+ * neighboring narrow band points differ by at most one.  Returns the
+ * largest bin.
+ */
+static int gradeBins(
+  LSM_MultirateStepper3d *stepper,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index)
+{
+  const Grid *grid = stepper->grid;
+  const int nx = grid->grid_dims_ghostbox[0];
+  const int nxy = nx*grid->grid_dims_ghostbox[1];
+  unsigned char *bin = stepper->bin;
+  int changed = 1, max_bin = 0;
+  int m;
+
+  /* Gauss-Seidel sweeps (bins only decrease, so this terminates) */
+  while (changed) {
+    changed = 0;
+    for (m = nlo_index; m <= nhi_index; m++) {
+      int i = index_x[m], j = index_y[m], k = index_z[m];
+      int idx = i + j*nx + k*nxy;
+      int b = bin[idx];
+      if (i > grid->ilo_gb && bin[idx-1] + 1 < b) b = bin[idx-1] + 1;
+      if (i < grid->ihi_gb && bin[idx+1] + 1 < b) b = bin[idx+1] + 1;
+      if (j > grid->jlo_gb && bin[idx-nx] + 1 < b) b = bin[idx-nx] + 1;
+      if (j < grid->jhi_gb && bin[idx+nx] + 1 < b) b = bin[idx+nx] + 1;
+      if (k > grid->klo_gb && bin[idx-nxy] + 1 < b) b = bin[idx-nxy] + 1;
+      if (k < grid->khi_gb && bin[idx+nxy] + 1 < b) b = bin[idx+nxy] + 1;
+      if (b < bin[idx]) {
+        bin[idx] = (unsigned char) b;
+        changed = 1;
+      }
+    }
+  }
+
+  for (m = nlo_index; m <= nhi_index; m++) {
+    int b = bin[index_x[m] + index_y[m]*nx + index_z[m]*nxy];
+    if (b > max_bin) max_bin = b;
+  }
+  return max_bin;
+}
+
+
+/*==================== Multirate Stepper Functions ===================*/
+
+LSM_MultirateStepper3d *createMultirateStepper3d(
+  const Grid *grid,
+  int order)
+{
+  LSM_MultirateStepper3d *stepper;
+  int n;
+
+  if ( (!grid) || (grid->num_dims != 3) || (order < 1) || (order > 2) ) {
+    return NULL;
+  }
+
+  stepper = (LSM_MultirateStepper3d *) calloc(1,
+    sizeof(LSM_MultirateStepper3d));
+  if (!stepper) return NULL;
+
+  n = grid->num_gridpts;
+  stepper->grid = grid;
+  stepper->order = order;
+  stepper->index_x = (int *) malloc(n*sizeof(int));
+  stepper->index_y = (int *) malloc(n*sizeof(int));
+  stepper->index_z = (int *) malloc(n*sizeof(int));
+  stepper->bin = (unsigned char *) malloc(n*sizeof(unsigned char));
+  stepper->phi_start = (LSMLIB_REAL *) malloc(n*sizeof(LSMLIB_REAL));
+  stepper->phi_eval = (LSMLIB_REAL *) malloc(n*sizeof(LSMLIB_REAL));
+  stepper->rhs_start = (LSMLIB_REAL *) malloc(n*sizeof(LSMLIB_REAL));
+  stepper->rhs_stage = (LSMLIB_REAL *) malloc(n*sizeof(LSMLIB_REAL));
+  if ( (!stepper->index_x) || (!stepper->index_y) || (!stepper->index_z)
+    || (!stepper->bin) || (!stepper->phi_start) || (!stepper->phi_eval)
+    || (!stepper->rhs_start) || (!stepper->rhs_stage) ) {
+    destroyMultirateStepper3d(stepper);
+    return NULL;
+  }
+  memset(stepper->bin, LSM_MULTIRATE_NO_BIN, n*sizeof(unsigned char));
+
+  return stepper;
+}
+
+
+void destroyMultirateStepper3d(LSM_MultirateStepper3d *stepper)
+{
+  if (!stepper) return;
+  free(stepper->index_x);
+  free(stepper->index_y);
+  free(stepper->index_z);
+  free(stepper->bin);
+  free(stepper->phi_start);
+  free(stepper->phi_eval);
+  free(stepper->rhs_start);
+  free(stepper->rhs_stage);
+  free(stepper);
+}
+
+
+int binNarrowBandByStableDt3d(
+  LSM_MultirateStepper3d *stepper,
+  const LSMLIB_REAL *dt_local,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index,
+  int max_num_bins)
+{
+  const Grid *grid;
+  int nx, nxy;
+  int count[LSM_MULTIRATE_MAX_BINS];
+  LSMLIB_REAL dt_min;
+  int b, m, max_bin;
+
+  if ( (!stepper) || (!dt_local) || (!index_x) || (!index_y)
+    || (!index_z) || (max_num_bins < 1)
+    || (max_num_bins > LSM_MULTIRATE_MAX_BINS)
+    || (nhi_index - nlo_index + 1 > stepper->grid->num_gridpts) ) {
+    return LSM_MULTIRATE_ERR_INVALID_ARGUMENT;
+  }
+  grid = stepper->grid;
+  nx = grid->grid_dims_ghostbox[0];
+  nxy = nx*grid->grid_dims_ghostbox[1];
+
+  /* smallest local stable time step */
+  dt_min = 0.0;
+  for (m = nlo_index; m <= nhi_index; m++) {
+    LSMLIB_REAL dt = dt_local[index_x[m] + index_y[m]*nx + index_z[m]*nxy];
+    if (!(dt > 0)) return LSM_MULTIRATE_ERR_INVALID_ARGUMENT;
+    if ( (m == nlo_index) || (dt < dt_min) ) dt_min = dt;
+  }
+
+  /* largest bin with dt_min * 2^b <= dt_local, then grade */
+  memset(stepper->bin, LSM_MULTIRATE_NO_BIN,
+         grid->num_gridpts*sizeof(unsigned char));
+  for (m = nlo_index; m <= nhi_index; m++) {
+    int idx = index_x[m] + index_y[m]*nx + index_z[m]*nxy;
+    LSMLIB_REAL dt_bin = dt_min;
+    b = 0;
+    while ( (b + 1 < max_num_bins) && (2*dt_bin <= dt_local[idx]) ) {
+      dt_bin *= 2;
+      b++;
+    }
+    stepper->bin[idx] = (unsigned char) b;
+  }
+  max_bin = (nhi_index >= nlo_index)
+          ? gradeBins(stepper, index_x, index_y, index_z,
+                      nlo_index, nhi_index)
+          : 0;
+
+  /* stable counting sort of the points by bin */
+  for (b = 0; b < LSM_MULTIRATE_MAX_BINS; b++) count[b] = 0;
+  for (m = nlo_index; m <= nhi_index; m++) {
+    count[stepper->bin[index_x[m] + index_y[m]*nx + index_z[m]*nxy]]++;
+  }
+  stepper->num_bins = max_bin + 1;
+  stepper->num_points = 0;
+  for (b = 0; b < stepper->num_bins; b++) {
+    stepper->bin_lo[b] = stepper->num_points;
+    stepper->num_points += count[b];
+    stepper->bin_hi[b] = stepper->num_points - 1;
+    count[b] = stepper->bin_lo[b];
+  }
+  for (m = nlo_index; m <= nhi_index; m++) {
+    int idx = index_x[m] + index_y[m]*nx + index_z[m]*nxy;
+    int pos = count[stepper->bin[idx]]++;
+    stepper->index_x[pos] = index_x[m];
+    stepper->index_y[pos] = index_y[m];
+    stepper->index_z[pos] = index_z[m];
+  }
+  stepper->dt_min = dt_min;
+
+  return LSM_MULTIRATE_ERR_SUCCESS;
+}
+
+
+int advanceMultirate3d(
+  LSM_MultirateStepper3d *stepper,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL t,
+  LSM_MultirateRHSFunction3d compute_rhs,
+  void *user_data,
+  const unsigned char *narrow_band,
+  unsigned char mark_fb)
+{
+  const Grid *grid;
+  LSM_MultirateInterpArgs interp_args;
+  int num_substeps, substep, b;
+
+  if ( (!stepper) || (!phi) || (!compute_rhs) || (!narrow_band) ) {
+    return LSM_MULTIRATE_ERR_INVALID_ARGUMENT;
+  }
+  grid = stepper->grid;
+  stepper->num_rhs_points = 0;
+  stepper->dt_macro = 0.0;
+  if (stepper->num_points == 0) return LSM_MULTIRATE_ERR_SUCCESS;
+
+  num_substeps = 1 << (stepper->num_bins - 1);
+  stepper->dt_macro = stepper->dt_min*num_substeps;
+
+  /* stencil values outside of the narrow band are time independent */
+  memcpy(stepper->phi_eval, phi, grid->num_gridpts*sizeof(LSMLIB_REAL));
+  memcpy(stepper->phi_start, phi, grid->num_gridpts*sizeof(LSMLIB_REAL));
+
+  interp_args.stepper = stepper;
+  interp_args.phi = phi;
+
+  for (substep = 0; substep < num_substeps; substep++) {
+    LSMLIB_REAL t_sub = t + substep*stepper->dt_min;
+    int b_max = 0;
+    int m_active_hi, m;
+
+    /* bins whose steps begin at this substep:  0, ..., b_max */
+    while ( (b_max + 1 < stepper->num_bins)
+         && (substep % (1 << (b_max + 1)) == 0) ) {
+      b_max++;
+    }
+    m_active_hi = stepper->bin_hi[b_max];
+
+    /*
+     * the steps of the active bins begin at the current values; the
+     * other bins are interpolated to the substep time
+     */
+    for (m = 0; m <= m_active_hi; m++) {
+      int idx = stepper->index_x[m]
+              + stepper->index_y[m]*grid->grid_dims_ghostbox[0]
+              + stepper->index_z[m]*grid->grid_dims_ghostbox[0]
+                                   *grid->grid_dims_ghostbox[1];
+      stepper->phi_start[idx] = phi[idx];
+      stepper->phi_eval[idx] = phi[idx];
+    }
+    interp_args.substep = substep;
+    LSM_Runtime_parallelFor(m_active_hi + 1, stepper->num_points,
+                            LSM_SCHEDULE_STATIC, 0, 0,
+                            interpolateInTime, &interp_args);
+
+    /* first stage:  right-hand side of all active points */
+    compute_rhs(stepper->rhs_start, stepper->phi_eval,
+                stepper->index_x, stepper->index_y, stepper->index_z,
+                0, m_active_hi, t_sub, user_data);
+    stepper->num_rhs_points += m_active_hi + 1;
+
+    for (b = 0; b <= b_max; b++) {
+      LSMLIB_REAL dt = stepper->dt_min*(1 << b);
+
+      if (stepper->bin_hi[b] < stepper->bin_lo[b]) continue;
+
+      if (stepper->order == 1) {
+        rk1Step(stepper, phi, stepper->phi_start, stepper->rhs_start, dt,
+                stepper->bin_lo[b], stepper->bin_hi[b],
+                narrow_band, mark_fb);
+        continue;
+      }
+
+      /*
+       * second stage at t_sub + dt:  forward Euler predictor with step dt
+       * for all active points, interpolation for the other bins
+       */
+      rk1Step(stepper, stepper->phi_eval, stepper->phi_start,
+              stepper->rhs_start, dt, 0, m_active_hi,
+              narrow_band, mark_fb);
+      interp_args.substep = substep + (1 << b);
+      LSM_Runtime_parallelFor(m_active_hi + 1, stepper->num_points,
+                              LSM_SCHEDULE_STATIC, 0, 0,
+                              interpolateInTime, &interp_args);
+
+      compute_rhs(stepper->rhs_stage, stepper->phi_eval,
+                  stepper->index_x, stepper->index_y, stepper->index_z,
+                  stepper->bin_lo[b], stepper->bin_hi[b], t_sub + dt,
+                  user_data);
+      stepper->num_rhs_points += stepper->bin_hi[b] - stepper->bin_lo[b] + 1;
+
+      rk2Stage2(stepper, phi, stepper->phi_eval, stepper->phi_start,
+                stepper->rhs_stage, dt,
+                stepper->bin_lo[b], stepper->bin_hi[b],
+                narrow_band, mark_fb);
+    }
+  }
+
+  return LSM_MULTIRATE_ERR_SUCCESS;
+}
@@ -0,0 +1,260 @@
+/*
+ * File:        lsm_multirate3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for multirate local time stepping in the
+ *              3D narrow band
+ */
+
+#ifndef included_lsm_multirate3d_h
+#define included_lsm_multirate3d_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_multirate3d.h
+ *
+ * \brief
+ * @ref lsm_multirate3d.h provides multirate local time stepping for
+ * level set equations on the 3D narrow band.
+ *
+ * Instead of advancing all narrow band points with the global stable
+ * time step (the minimum over the narrow band), the points are sorted
+ * into bins by their local stable time step:  bin b is advanced with
+ * dt_b = dt_min * 2^b, where dt_min is the smallest local stable time
+ * step.  Points are assigned to the largest bin with dt_b not exceeding
+ * their local stable time step, and the bins of neighboring points are
+ * graded (they differ by at most one), so every point is advanced with
+ * a stable time step and only the few points that limit the global time
+ * step take the smallest steps.
+ *
+ * One call to advanceMultirate3d() advances all points by the macro
+ * time step dt_min * 2^(num_bins-1).  The macro step is divided into
+ * 2^(num_bins-1) substeps of size dt_min.  At each substep, the bins
+ * whose steps begin there (bins 0, ..., b with substep divisible by
+ * 2^b) are advanced by one complete step each with the TVD Runge-Kutta
+ * stages of @ref lsm_tvd_runge_kutta3d_local.h.  The stencils of the
+ * Runge-Kutta stages are evaluated as follows:
+ *
+ * - Points in bins that are in the middle of a step (which was computed
+ *   completely when it began) are evaluated by linear interpolation in
+ *   time between the values at the beginning and the end of their step.
+ * - Points in bins that are advanced at the same substep are evaluated
+ *   at the stage times of bin b with the forward Euler predictor from
+ *   the beginning of the substep.
+ *
+ * All bins are synchronized at the end of the macro time step.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create a stepper using createMultirateStepper3d().
+ * -# Whenever the narrow band or the local stable time steps change
+ *    significantly, sort the narrow band into bins using
+ *    binNarrowBandByStableDt3d().
+ * -# Advance the level set function using advanceMultirate3d().
+ * -# Free the stepper using destroyMultirateStepper3d().
+ *
+ */
+
+
+/*!
+ * Error codes returned by multirate time stepping functions.
+ */
+#define LSM_MULTIRATE_ERR_SUCCESS                   (0)
+#define LSM_MULTIRATE_ERR_INVALID_ARGUMENT          (1)
+#define LSM_MULTIRATE_ERR_MEMORY_ALLOCATION         (2)
+
+/*!
+ * Maximum number of time step bins.
+ */
+#define LSM_MULTIRATE_MAX_BINS                      (16)
+
+/*!
+ * LSM_MultirateRHSFunction3d is the type of functions that compute the
+ * right-hand side of the level set equation at a range of narrow band
+ * points.
+ *
+ * Arguments:
+ *  - lse_rhs (out):    right-hand side (only the values at the points
+ *                      nlo_index, ..., nhi_index are used)
+ *  - phi (in):         level set function at time t
+ *  - index_* (in):     coordinates of narrow band points
+ *  - nlo_index,
+ *    nhi_index (in):   index range of the points to compute
+ *  - t (in):           time
+ *  - user_data (in):   user data passed to advanceMultirate3d()
+ *
+ * Return value:        none
+ *
+ * NOTES:
+ *  - index_* are the arrays of the stepper (sorted by bin), so they can
+ *    be passed to the *_LOCAL kernels together with nlo_index and
+ *    nhi_index.
+ *
+ */
+typedef void (*LSM_MultirateRHSFunction3d)(
+  LSMLIB_REAL *lse_rhs,
+  const LSMLIB_REAL *phi,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index,
+  LSMLIB_REAL t,
+  void *user_data);
+
+/*!
+ * Structure 'LSM_MultirateStepper3d' holds the narrow band points sorted
+ * by time step bin, the work arrays and the statistics of the last
+ * macro time step.
+ */
+typedef struct _LSM_MultirateStepper3d
+{
+  const Grid   *grid;
+  int           order;            /* order of the TVD Runge-Kutta method */
+
+  /* bins:  points of bin b are index_*[bin_lo[b]..bin_hi[b]] */
+  int           num_bins;
+  LSMLIB_REAL   dt_min;           /* time step of bin 0                 */
+  int           num_points;
+  int          *index_x;
+  int          *index_y;
+  int          *index_z;
+  int           bin_lo[LSM_MULTIRATE_MAX_BINS];
+  int           bin_hi[LSM_MULTIRATE_MAX_BINS];
+  unsigned char *bin;             /* bin of each grid point (0xFF       */
+                                  /* outside of the narrow band)        */
+
+  /* work arrays (grid->num_gridpts elements) */
+  LSMLIB_REAL  *phi_start;        /* value at the beginning of the step */
+  LSMLIB_REAL  *phi_eval;         /* value at the current stage time    */
+  LSMLIB_REAL  *rhs_start;        /* right-hand side at the substep     */
+  LSMLIB_REAL  *rhs_stage;        /* right-hand side at later stages    */
+
+  /* statistics of the last macro time step */
+  LSMLIB_REAL   dt_macro;
+  long          num_rhs_points;   /* number of point RHS evaluations    */
+} LSM_MultirateStepper3d;
+
+
+/*!
+ * createMultirateStepper3d() creates a multirate stepper.
+ *
+ * Arguments:
+ *  - grid (in):   pointer to Grid
+ *  - order (in):  order of the TVD Runge-Kutta method (1 or 2)
+ *
+ * Return value:   pointer to new stepper (NULL on failure)
+ *
+ * NOTES:
+ *  - The stepper allocates four real, three integer and one byte array
+ *    with grid->num_gridpts elements.
+ *
+ *  - Third-order TVD Runge-Kutta is not supported because its later
+ *    stages would require the intermediate stage values of all points
+ *    in the numerical domain of dependence, not only of the neighbors.
+ *
+ */
+LSM_MultirateStepper3d *createMultirateStepper3d(
+  const Grid *grid,
+  int order);
+
+/*!
+ * destroyMultirateStepper3d() frees a stepper.
+ *
+ * Arguments:
+ *  - stepper (in):  pointer to stepper (may be NULL)
+ *
+ * Return value:     none
+ *
+ */
+void destroyMultirateStepper3d(LSM_MultirateStepper3d *stepper);
+
+/*!
+ * binNarrowBandByStableDt3d() sorts the narrow band points into time
+ * step bins.
+ *
+ * Arguments:
+ *  - stepper (in/out):    stepper
+ *  - dt_local (in):       local stable time step at each narrow band
+ *                         point (e.g. from a CFL criterion evaluated at
+ *                         each point, such as
+ *                         LSM3D_COMPUTE_STABLE_NORMAL_VEL_DT_LOCAL()
+ *                         with nlo_index = nhi_index)
+ *  - index_* (in):        coordinates of narrow band points
+ *  - nlo_index,
+ *    nhi_index (in):      index range of the narrow band points
+ *  - max_num_bins (in):   maximum number of bins
+ *                         (1 <= max_num_bins <= LSM_MULTIRATE_MAX_BINS)
+ *
+ * Return value:           error code
+ *
+ * NOTES:
+ *  - All dt_local values in the narrow band must be positive.
+ *
+ *  - Within each bin, the points remain in the order of the index_*
+ *    arrays.
+ *
+ *  - With max_num_bins = 1, advanceMultirate3d() is the same as global
+ *    time stepping with the minimum local stable time step.
+ *
+ */
+int binNarrowBandByStableDt3d(
+  LSM_MultirateStepper3d *stepper,
+  const LSMLIB_REAL *dt_local,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int nlo_index,
+  int nhi_index,
+  int max_num_bins);
+
+/*!
+ * advanceMultirate3d() advances the level set function at the narrow
+ * band points by one macro time step.
+ *
+ * Arguments:
+ *  - stepper (in/out):     stepper
+ *  - phi (in/out):         level set function
+ *  - t (in):               time at the beginning of the macro step
+ *  - compute_rhs (in):     function that computes the right-hand side
+ *  - user_data (in):       data passed to compute_rhs
+ *  - narrow_band (in):     narrow band array passed to the TVD
+ *                          Runge-Kutta kernels
+ *  - mark_fb (in):         upper limit narrow band value for points that
+ *                          are updated
+ *
+ * Return value:            error code
+ *
+ * NOTES:
+ *  - The macro time step dt_min * 2^(num_bins-1) is stored in
+ *    stepper->dt_macro.
+ *
+ *  - Values of phi outside of the narrow band are not modified; they
+ *    are used as (time independent) stencil values.
+ *
+ */
+int advanceMultirate3d(
+  LSM_MultirateStepper3d *stepper,
+  LSMLIB_REAL *phi,
+  LSMLIB_REAL t,
+  LSM_MultirateRHSFunction3d compute_rhs,
+  void *user_data,
+  const unsigned char *narrow_band,
+  unsigned char mark_fb);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,999 @@
+/*
+ * File:        lsm_narrow_band3d.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation file for threaded 3D narrow band
+ *              construction
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsm_localization3d.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_runtime.h"
+
+
+/*================= Helper Data Structures and Functions =============*/
+
+/*
+ * Structure 'LSM_NarrowBandFrontier' is a growable buffer of (i,j,k)
+ * triples owned by a single thread.
+ */
+typedef struct _LSM_NarrowBandFrontier
+{
+  int *points;
+  int  num_points;
+  int  max_num_points;
+} LSM_NarrowBandFrontier;
+
+/*
+ * Structure 'LSM_NarrowBandArgs' holds the arguments shared by all
+ * threads during determineNarrowBand3d().
+ */
+typedef struct _LSM_NarrowBandArgs
+{
+  const LSMLIB_REAL       *phi;
+  const LSMLIB_REAL       *psi;              /* NULL if no psi  */
+  const LSMLIB_REAL       *mask;             /* NULL if no mask */
+  const unsigned char     *solid_narrow_band;
+  LSMLIB_REAL              max_dx;
+  unsigned char           *narrow_band;
+  int                     *index_x;
+  int                     *index_y;
+  int                     *index_z;
+  int                     *index_outer;
+  int                      num_index_outer;
+  LSMLIB_REAL              width;
+  LSMLIB_REAL              width_inner;
+  Grid                    *grid;
+
+  /* ghostbox dimensions */
+  int                      nx, ny, nz;
+
+  /* per-slab counts and offsets (offsets have nz+1 elements) */
+  int                     *slab_count;
+  int                     *slab_count_minus;
+  int                     *slab_count_plus;
+  int                     *slab_offset;
+  int                     *slab_offset_minus;
+  int                     *slab_offset_plus;
+  int                     *prev_slab_offset;
+
+  /* level expansion state */
+  unsigned char            mark;
+  int                      prev_level_lo;
+  int                      level_lo;
+  LSM_NarrowBandFrontier  *frontiers;     /* one buffer per thread */
+  int                     *slab_thread;
+  int                     *slab_start;
+  volatile int             memory_error;
+} LSM_NarrowBandArgs;
+
+
+/*
+ * flagNarrowBandSlabs() sets the level bits of narrow_band to 1 for the
+ * level 0 points in slabs [begin, end) (and to 0 elsewhere), sets the
+ * boundary layer bits from the grid's nb_layer_mask tables and counts
+ * the points.
+ *
+ * NOTES:
+ *  - If a mask is given, points of the solid narrow band where phi is
+ *    pinned to the mask (|phi - mask| <= max_dx) are not level 0 points.
+ *
+ *  - If psi is given, points with |psi| >= width are not level 0 points.
+ */
+static void flagNarrowBandSlabs(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandArgs *args = (LSM_NarrowBandArgs *) user_data;
+  unsigned char **layer_mask = args->grid->nb_layer_mask;
+  int i, j, k, idx;
+  (void) thread_num;
+
+  for (k = begin; k < end; k++) {
+    int count = 0, count_minus = 0, count_plus = 0;
+    idx = k*args->nx*args->ny;
+    for (j = 0; j < args->ny; j++) {
+      unsigned char layer_jk = layer_mask[1][j] | layer_mask[2][k];
+      for (i = 0; i < args->nx; i++, idx++) {
+        LSMLIB_REAL abs_phi = fabs(args->phi[idx]);
+        unsigned char layer = layer_mask[0][i] | layer_jk;
+        if ( (abs_phi < args->width)
+          && !( args->psi && (fabs(args->psi[idx]) >= args->width) )
+          && !( args->mask
+             && (args->solid_narrow_band[idx] & LSM_NB_LEVEL_BITS)
+             && (fabs(args->phi[idx] - args->mask[idx]) <= args->max_dx) ) ) {
+          args->narrow_band[idx] = layer | 1;
+          count++;
+          if (abs_phi >= args->width_inner) {
+            if (args->phi[idx] <= 0) {
+              count_minus++;
+            } else {
+              count_plus++;
+            }
+          }
+        } else {
+          args->narrow_band[idx] = layer;
+        }
+      }
+    }
+    args->slab_count[k] = count;
+    args->slab_count_minus[k] = count_minus;
+    args->slab_count_plus[k] = count_plus;
+  }
+}
+
+/*
+ * writeNarrowBandSlabs() writes the level 0 points in slabs [begin, end)
+ * to the index arrays in the same order as lsm3dDetermineNarrowBand().
+ */
+static void writeNarrowBandSlabs(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandArgs *args = (LSM_NarrowBandArgs *) user_data;
+  Grid *grid = args->grid;
+  int i, j, k;
+  (void) thread_num;
+
+  for (k = begin; k < end; k++) {
+    int pos = args->slab_offset[k];
+    int pos_minus = args->slab_offset_minus[k];
+    int pos_plus = args->num_index_outer - 1 - args->slab_offset_plus[k];
+    int idx = k*args->nx*args->ny;
+
+    for (j = 0; j < args->ny; j++) {
+      for (i = 0; i < args->nx; i++, idx++) {
+        LSMLIB_REAL abs_phi;
+        if ((args->narrow_band[idx] & LSM_NB_LEVEL_BITS) != 1) continue;
+
+        args->index_x[pos] = grid->ilo_gb + i;
+        args->index_y[pos] = grid->jlo_gb + j;
+        args->index_z[pos] = grid->klo_gb + k;
+
+        /* outer points with negative phi are stored at the front of */
+        /* index_outer and outer points with positive phi at the end */
+        abs_phi = fabs(args->phi[idx]);
+        if (abs_phi >= args->width_inner) {
+          if (args->phi[idx] <= 0) {
+            args->index_outer[pos_minus++] = pos;
+          } else {
+            args->index_outer[pos_plus--] = pos;
+          }
+        }
+        pos++;
+      }
+    }
+  }
+}
+
+/*
+ * addToFrontier() marks the point (i,j,k) (ghostbox-relative indices)
+ * and appends it to the frontier if it is not yet in the narrow band.
+ */
+static void addToFrontier(
+  LSM_NarrowBandArgs *args, LSM_NarrowBandFrontier *frontier,
+  int i, int j, int k)
+{
+  int idx = i + args->nx*(j + args->ny*k);
+  if ((args->narrow_band[idx] & LSM_NB_LEVEL_BITS) != 0) return;
+
+  if (frontier->num_points == frontier->max_num_points) {
+    int max_num_points = 2*frontier->max_num_points + 1024;
+    int *points = (int *) realloc(frontier->points,
+                                  3*max_num_points*sizeof(int));
+    if (!points) {
+      args->memory_error = 1;
+      return;
+    }
+    frontier->points = points;
+    frontier->max_num_points = max_num_points;
+  }
+
+  args->narrow_band[idx] |= args->mark;
+  frontier->points[3*frontier->num_points] = i;
+  frontier->points[3*frontier->num_points+1] = j;
+  frontier->points[3*frontier->num_points+2] = k;
+  frontier->num_points++;
+}
+
+/*
+ * expandNarrowBandSlabs() finds the new points in slabs [begin, end)
+ * that neighbor the previous level.
+ *
+ * NOTES:
+ *  - The previous level points in slabs k-1, k and k+1 are visited in
+ *    order and their neighbors are checked in the same order as in
+ *    lsm3dMarkNarrowBandNeighbors(), so the points of each slab are
+ *    found in the same order as in the serial algorithm.
+ */
+static void expandNarrowBandSlabs(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandArgs *args = (LSM_NarrowBandArgs *) user_data;
+  LSM_NarrowBandFrontier *frontier = &(args->frontiers[thread_num]);
+  Grid *grid = args->grid;
+  int k, m;
+
+  for (k = begin; k < end; k++) {
+    int start = frontier->num_points;
+    int m_lo = args->prev_level_lo
+             + args->prev_slab_offset[(k > 0) ? k-1 : 0];
+    int m_hi = args->prev_level_lo
+             + args->prev_slab_offset[(k < args->nz-1) ? k+2 : args->nz];
+
+    for (m = m_lo; m < m_hi; m++) {
+      int i = args->index_x[m] - grid->ilo_gb;
+      int j = args->index_y[m] - grid->jlo_gb;
+      int kk = args->index_z[m] - grid->klo_gb;
+
+      if (kk == k) {
+        if (i < args->nx-1) addToFrontier(args, frontier, i+1, j, k);
+        if (i > 0)          addToFrontier(args, frontier, i-1, j, k);
+        if (j < args->ny-1) addToFrontier(args, frontier, i, j+1, k);
+        if (j > 0)          addToFrontier(args, frontier, i, j-1, k);
+      } else {
+        /* upper (kk == k-1) or lower (kk == k+1) z-neighbor */
+        addToFrontier(args, frontier, i, j, k);
+      }
+    }
+
+    args->slab_thread[k] = thread_num;
+    args->slab_start[k] = start;
+    args->slab_count[k] = frontier->num_points - start;
+  }
+}
+
+/*
+ * copyNarrowBandSlabs() copies the frontier points of slabs [begin, end)
+ * to the index arrays.
+ */
+static void copyNarrowBandSlabs(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandArgs *args = (LSM_NarrowBandArgs *) user_data;
+  Grid *grid = args->grid;
+  int k, n;
+  (void) thread_num;
+
+  for (k = begin; k < end; k++) {
+    const int *points = args->frontiers[args->slab_thread[k]].points
+                      + 3*args->slab_start[k];
+    int pos = args->level_lo + args->slab_offset[k];
+    for (n = 0; n < args->slab_count[k]; n++, pos++) {
+      args->index_x[pos] = grid->ilo_gb + points[3*n];
+      args->index_y[pos] = grid->jlo_gb + points[3*n+1];
+      args->index_z[pos] = grid->klo_gb + points[3*n+2];
+    }
+  }
+}
+
+/*
+ * computeSlabOffsets() sets offset[k] to the sum of count[0..k-1] for
+ * k = 0, ..., nz and returns the total.
+ */
+static int computeSlabOffsets(int *offset, const int *count, int nz)
+{
+  int k;
+  offset[0] = 0;
+  for (k = 0; k < nz; k++) offset[k+1] = offset[k] + count[k];
+  return offset[nz];
+}
+
+
+/*
+ * buildNarrowBand3d() implements determineNarrowBand3d(),
+ * determineNarrowBandFromTwoLevelSets3d() (psi != NULL) and
+ * determineNarrowBandAwayFromMask3d() (mask != NULL).
+ */
+static int buildNarrowBand3d(
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi,
+  const LSMLIB_REAL *mask,
+  const unsigned char *solid_narrow_band,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid)
+{
+  LSM_NarrowBandArgs args;
+  int num_threads;
+  int num_minus, num_plus, num_points;
+  int *slab_data;
+  int err = LSM_NARROW_BAND_ERR_SUCCESS;
+  int l, t;
+
+  /* check arguments */
+  if ( !phi || !narrow_band || !index_x || !index_y || !index_z
+    || !n_lo || !n_hi || (!index_outer && (num_index_outer > 0))
+    || (num_index_outer < 0) || !nlo_outer_plus || !nhi_outer_plus
+    || !nlo_outer_minus || !nhi_outer_minus || (level < 0)
+    || (level > LSM_NB_MAX_LEVEL) || !grid || (grid->num_dims != 3)
+    || !grid->nb_layer_mask[0] ) {
+    return LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+  }
+
+  memset(&args, 0, sizeof(args));
+  args.phi = phi;
+  args.psi = psi;
+  args.mask = mask;
+  args.solid_narrow_band = solid_narrow_band;
+  if (mask) {
+    args.max_dx = grid->dx[0];
+    if (grid->dx[1] > args.max_dx) args.max_dx = grid->dx[1];
+    if (grid->dx[2] > args.max_dx) args.max_dx = grid->dx[2];
+  }
+  args.narrow_band = narrow_band;
+  args.index_x = index_x;
+  args.index_y = index_y;
+  args.index_z = index_z;
+  args.index_outer = index_outer;
+  args.num_index_outer = num_index_outer;
+  args.width = width;
+  args.width_inner = width_inner;
+  args.grid = grid;
+  args.nx = grid->grid_dims_ghostbox[0];
+  args.ny = grid->grid_dims_ghostbox[1];
+  args.nz = grid->grid_dims_ghostbox[2];
+
+  /* allocate per-slab and per-thread data */
+  num_threads = LSM_Runtime_getNumThreads();
+  slab_data = (int *) malloc((5*args.nz + 4*(args.nz+1))*sizeof(int));
+  args.frontiers = (LSM_NarrowBandFrontier *) calloc(
+    num_threads, sizeof(LSM_NarrowBandFrontier));
+  if (!slab_data || !args.frontiers) {
+    free(slab_data);
+    free(args.frontiers);
+    return LSM_NARROW_BAND_ERR_MEMORY_ALLOCATION;
+  }
+  args.slab_count        = slab_data;
+  args.slab_count_minus  = args.slab_count + args.nz;
+  args.slab_count_plus   = args.slab_count_minus + args.nz;
+  args.slab_thread       = args.slab_count_plus + args.nz;
+  args.slab_start        = args.slab_thread + args.nz;
+  args.slab_offset       = args.slab_start + args.nz;
+  args.slab_offset_minus = args.slab_offset + (args.nz+1);
+  args.slab_offset_plus  = args.slab_offset_minus + (args.nz+1);
+  args.prev_slab_offset  = args.slab_offset_plus + (args.nz+1);
+
+  /* level 0:  flag and count, compute offsets, write points */
+  LSM_Runtime_parallelFor(0, args.nz, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                          flagNarrowBandSlabs, &args);
+  num_points = computeSlabOffsets(args.slab_offset, args.slab_count,
+                                  args.nz);
+  num_minus = computeSlabOffsets(args.slab_offset_minus,
+                                 args.slab_count_minus, args.nz);
+  num_plus = computeSlabOffsets(args.slab_offset_plus,
+                                args.slab_count_plus, args.nz);
+  if (num_minus + num_plus > num_index_outer) {
+    err = LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+    goto cleanup;
+  }
+  LSM_Runtime_parallelFor(0, args.nz, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                          writeNarrowBandSlabs, &args);
+
+  n_lo[0] = 0;
+  n_hi[0] = num_points - 1;
+  *nlo_outer_minus = 0;
+  *nhi_outer_minus = num_minus - 1;
+  *nlo_outer_plus = num_index_outer - num_plus;
+  *nhi_outer_plus = num_index_outer - 1;
+
+  /* levels 1, ..., level:  expand, compute offsets, copy points */
+  for (l = 1; l <= level; l++) {
+    memcpy(args.prev_slab_offset, args.slab_offset,
+           (args.nz+1)*sizeof(int));
+    for (t = 0; t < num_threads; t++) args.frontiers[t].num_points = 0;
+    args.mark = (unsigned char) (l+1);
+    args.prev_level_lo = n_lo[l-1];
+
+    LSM_Runtime_parallelFor(0, args.nz, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                            expandNarrowBandSlabs, &args);
+    if (args.memory_error) {
+      err = LSM_NARROW_BAND_ERR_MEMORY_ALLOCATION;
+      goto cleanup;
+    }
+
+    num_points = computeSlabOffsets(args.slab_offset, args.slab_count,
+                                    args.nz);
+    n_lo[l] = n_hi[l-1] + 1;
+    n_hi[l] = n_lo[l] + num_points - 1;
+    args.level_lo = n_lo[l];
+    LSM_Runtime_parallelFor(0, args.nz, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                            copyNarrowBandSlabs, &args);
+  }
+
+cleanup:
+  for (t = 0; t < num_threads; t++) free(args.frontiers[t].points);
+  free(args.frontiers);
+  free(slab_data);
+
+  return err;
+}
+
+
+/*
+ * Radix of the Morton key sort.
+ */
+#define LSM_NB_RADIX_BITS                           (8)
+#define LSM_NB_RADIX                                (1 << LSM_NB_RADIX_BITS)
+
+/*
+ * Minimum number of keys per block of the parallel radix sort.
+ */
+#define LSM_NB_MIN_KEYS_PER_BLOCK                   (4096)
+
+/*
+ * spreadBits() inserts two zero bits between the lowest 21 bits of x.
+ */
+static uint64_t spreadBits(uint64_t x)
+{
+  x &= 0x1fffffULL;
+  x = (x | (x << 32)) & 0x1f00000000ffffULL;
+  x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+  x = (x | (x << 8))  & 0x100f00f00f00f00fULL;
+  x = (x | (x << 4))  & 0x10c30c30c30c30c3ULL;
+  x = (x | (x << 2))  & 0x1249249249249249ULL;
+  return x;
+}
+
+/*
+ * compactBits() is the inverse of spreadBits().
+ */
+static int compactBits(uint64_t x)
+{
+  x &= 0x1249249249249249ULL;
+  x = (x | (x >> 2))  & 0x10c30c30c30c30c3ULL;
+  x = (x | (x >> 4))  & 0x100f00f00f00f00fULL;
+  x = (x | (x >> 8))  & 0x1f0000ff0000ffULL;
+  x = (x | (x >> 16)) & 0x1f00000000ffffULL;
+  x = (x | (x >> 32)) & 0x1fffffULL;
+  return (int) x;
+}
+
+/*
+ * mortonKey() returns the Morton key of the point (i,j,k) (ghostbox-
+ * relative indices).
+ */
+static uint64_t mortonKey(int i, int j, int k)
+{
+  return spreadBits((uint64_t) i) | (spreadBits((uint64_t) j) << 1)
+       | (spreadBits((uint64_t) k) << 2);
+}
+
+/*
+ * Structure 'LSM_NarrowBandSortArgs' holds the arguments shared by all
+ * threads during sortNarrowBand3d().
+ */
+typedef struct _LSM_NarrowBandSortArgs
+{
+  Grid                    *grid;
+  int                     *index_x;
+  int                     *index_y;
+  int                     *index_z;
+  int                      offset;        /* first index_* element */
+
+  /* radix sort state */
+  const uint64_t          *src;
+  uint64_t                *dst;
+  int                      num_keys;
+  int                      num_blocks;
+  int                      shift;
+  int                     *block_count;   /* LSM_NB_RADIX per block */
+} LSM_NarrowBandSortArgs;
+
+/*
+ * computeMortonKeys() computes the Morton keys of the points
+ * offset+begin, ..., offset+end-1 of the index_* arrays.
+ */
+static void computeMortonKeys(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandSortArgs *args = (LSM_NarrowBandSortArgs *) user_data;
+  Grid *grid = args->grid;
+  int m;
+  (void) thread_num;
+
+  for (m = begin; m < end; m++) {
+    int n = args->offset + m;
+    args->dst[m] = mortonKey(args->index_x[n] - grid->ilo_gb,
+                             args->index_y[n] - grid->jlo_gb,
+                             args->index_z[n] - grid->klo_gb);
+  }
+}
+
+/*
+ * decodeMortonKeys() writes the points with the Morton keys
+ * src[begin], ..., src[end-1] to the index_* arrays.
+ */
+static void decodeMortonKeys(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandSortArgs *args = (LSM_NarrowBandSortArgs *) user_data;
+  Grid *grid = args->grid;
+  int m;
+  (void) thread_num;
+
+  for (m = begin; m < end; m++) {
+    int n = args->offset + m;
+    args->index_x[n] = grid->ilo_gb + compactBits(args->src[m]);
+    args->index_y[n] = grid->jlo_gb + compactBits(args->src[m] >> 1);
+    args->index_z[n] = grid->klo_gb + compactBits(args->src[m] >> 2);
+  }
+}
+
+/*
+ * countRadixDigits() counts the digits of the keys in blocks
+ * [begin, end).
+ */
+static void countRadixDigits(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandSortArgs *args = (LSM_NarrowBandSortArgs *) user_data;
+  int b, m;
+  (void) thread_num;
+
+  for (b = begin; b < end; b++) {
+    int *count = args->block_count + b*LSM_NB_RADIX;
+    int m_lo = (int) (((long) b*args->num_keys)/args->num_blocks);
+    int m_hi = (int) (((long) (b+1)*args->num_keys)/args->num_blocks);
+    memset(count, 0, LSM_NB_RADIX*sizeof(int));
+    for (m = m_lo; m < m_hi; m++) {
+      count[(args->src[m] >> args->shift) & (LSM_NB_RADIX-1)]++;
+    }
+  }
+}
+
+/*
+ * scatterRadixDigits() moves the keys in blocks [begin, end) to their
+ * positions in dst (block_count holds the positions).
+ */
+static void scatterRadixDigits(
+  int begin, int end, int thread_num, void *user_data)
+{
+  LSM_NarrowBandSortArgs *args = (LSM_NarrowBandSortArgs *) user_data;
+  int b, m;
+  (void) thread_num;
+
+  for (b = begin; b < end; b++) {
+    int *pos = args->block_count + b*LSM_NB_RADIX;
+    int m_lo = (int) (((long) b*args->num_keys)/args->num_blocks);
+    int m_hi = (int) (((long) (b+1)*args->num_keys)/args->num_blocks);
+    for (m = m_lo; m < m_hi; m++) {
+      uint64_t key = args->src[m];
+      args->dst[pos[(key >> args->shift) & (LSM_NB_RADIX-1)]++] = key;
+    }
+  }
+}
+
+/*
+ * sortMortonKeys() sorts keys[0], ..., keys[num_keys-1] using tmp as
+ * scratch space and returns a pointer to the sorted keys (keys or tmp).
+ * block_count must have LSM_NB_RADIX*num_blocks elements.
+ *
+ * NOTES:
+ *  - Each block of consecutive keys is counted and scattered by one
+ *    thread; the positions of the (digit, block) pairs are ordered by
+ *    digit and then by block, so every pass is stable and the result
+ *    does not depend on the number of threads.
+ *
+ *  - Passes in which all keys have the same digit are skipped.
+ */
+static uint64_t *sortMortonKeys(
+  LSM_NarrowBandSortArgs *args,
+  uint64_t *keys,
+  uint64_t *tmp,
+  int num_keys,
+  int num_key_bits,
+  int num_blocks)
+{
+  int shift, d, b;
+
+  if (num_blocks > num_keys/LSM_NB_MIN_KEYS_PER_BLOCK + 1) {
+    num_blocks = num_keys/LSM_NB_MIN_KEYS_PER_BLOCK + 1;
+  }
+  args->num_keys = num_keys;
+  args->num_blocks = num_blocks;
+
+  for (shift = 0; shift < num_key_bits; shift += LSM_NB_RADIX_BITS) {
+    int pos = 0, single_digit = 0;
+    uint64_t *swap;
+
+    args->src = keys;
+    args->dst = tmp;
+    args->shift = shift;
+    LSM_Runtime_parallelFor(0, num_blocks, LSM_SCHEDULE_STATIC, 1, 0,
+                            countRadixDigits, args);
+
+    for (d = 0; d < LSM_NB_RADIX; d++) {
+      int total = 0;
+      for (b = 0; b < num_blocks; b++) {
+        int count = args->block_count[b*LSM_NB_RADIX + d];
+        args->block_count[b*LSM_NB_RADIX + d] = pos;
+        pos += count;
+        total += count;
+      }
+      if (total == num_keys) single_digit = 1;
+    }
+    if (single_digit) continue;
+
+    LSM_Runtime_parallelFor(0, num_blocks, LSM_SCHEDULE_STATIC, 1, 0,
+                            scatterRadixDigits, args);
+    swap = keys; keys = tmp; tmp = swap;
+  }
+
+  return keys;
+}
+
+/*
+ * mortonKeyToIndex() returns the array index of the point with Morton
+ * key 'key'.
+ */
+static int mortonKeyToIndex(uint64_t key, const Grid *grid)
+{
+  return compactBits(key)
+       + grid->grid_dims_ghostbox[0]*(compactBits(key >> 1)
+       + grid->grid_dims_ghostbox[1]*compactBits(key >> 2));
+}
+
+
+/*==================== Function Definitions ==========================*/
+
+int determineNarrowBand3d(
+  const LSMLIB_REAL *phi,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid)
+{
+  return buildNarrowBand3d(phi, NULL, NULL, NULL, narrow_band,
+    index_x, index_y, index_z, n_lo, n_hi, index_outer, num_index_outer,
+    nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus,
+    width, width_inner, level, grid);
+}
+
+
+int determineNarrowBandFromTwoLevelSets3d(
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid)
+{
+  if (!psi) return LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+  return buildNarrowBand3d(phi, psi, NULL, NULL, narrow_band,
+    index_x, index_y, index_z, n_lo, n_hi, index_outer, num_index_outer,
+    nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus,
+    width, width_inner, level, grid);
+}
+
+
+int determineNarrowBandAwayFromMask3d(
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *mask,
+  const unsigned char *solid_narrow_band,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid)
+{
+  if ( !mask || !solid_narrow_band ) {
+    return LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+  }
+  return buildNarrowBand3d(phi, NULL, mask, solid_narrow_band, narrow_band,
+    index_x, index_y, index_z, n_lo, n_hi, index_outer, num_index_outer,
+    nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus,
+    width, width_inner, level, grid);
+}
+
+
+int determineSolidNarrowBand3d(
+  const LSMLIB_REAL *mask,
+  unsigned char *solid_narrow_band,
+  int *solid_index_x,
+  int *solid_index_y,
+  int *solid_index_z,
+  int *solid_n_lo,
+  int *solid_n_hi,
+  LSMLIB_REAL *solid_normal_x,
+  LSMLIB_REAL *solid_normal_y,
+  LSMLIB_REAL *solid_normal_z,
+  LSMLIB_REAL width,
+  int level,
+  Grid *grid)
+{
+  int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+  int err;
+
+  if ( !solid_normal_x || !solid_normal_y || !solid_normal_z ) {
+    return LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+  }
+
+  /* width_inner = width so that there are no outer layer points */
+  err = determineNarrowBand3d(mask, solid_narrow_band,
+    solid_index_x, solid_index_y, solid_index_z, solid_n_lo, solid_n_hi,
+    NULL, 0, &nlo_outer_plus, &nhi_outer_plus,
+    &nlo_outer_minus, &nhi_outer_minus, width, width, level, grid);
+  if (err != LSM_NARROW_BAND_ERR_SUCCESS) return err;
+
+  LSM3D_COMPUTE_SOLID_NORMALS_LOCAL(
+    solid_normal_x, solid_normal_y, solid_normal_z,
+    &(grid->ilo_gb), &(grid->ihi_gb), &(grid->jlo_gb), &(grid->jhi_gb),
+    &(grid->klo_gb), &(grid->khi_gb),
+    mask,
+    &(grid->ilo_gb), &(grid->ihi_gb), &(grid->jlo_gb), &(grid->jhi_gb),
+    &(grid->klo_gb), &(grid->khi_gb),
+    solid_index_x, solid_index_y, solid_index_z,
+    &(solid_n_lo[0]), &(solid_n_hi[level]),
+    &(grid->dx[0]), &(grid->dx[1]), &(grid->dx[2]));
+
+  return LSM_NARROW_BAND_ERR_SUCCESS;
+}
+
+
+LSM_NarrowBandOrdering *createNarrowBandOrdering3d(Grid *grid)
+{
+  LSM_NarrowBandOrdering *ordering;
+  int max_dim, num_bits, n;
+
+  if ( (!grid) || (grid->num_dims != 3) ) return NULL;
+
+  /* bits per dimension of the Morton keys */
+  max_dim = grid->grid_dims_ghostbox[0];
+  if (grid->grid_dims_ghostbox[1] > max_dim) {
+    max_dim = grid->grid_dims_ghostbox[1];
+  }
+  if (grid->grid_dims_ghostbox[2] > max_dim) {
+    max_dim = grid->grid_dims_ghostbox[2];
+  }
+  num_bits = 1;
+  while ((1 << num_bits) < max_dim) num_bits++;
+  if (num_bits > 21) return NULL;
+
+  ordering = (LSM_NarrowBandOrdering *) calloc(
+    1, sizeof(LSM_NarrowBandOrdering));
+  if (!ordering) return NULL;
+
+  n = grid->num_gridpts;
+  ordering->grid = grid;
+  ordering->num_key_bits = 3*num_bits;
+  ordering->keys = (uint64_t *) malloc(n*sizeof(uint64_t));
+  ordering->keys_tmp = (uint64_t *) malloc(n*sizeof(uint64_t));
+  ordering->prev_keys = (uint64_t *) malloc(n*sizeof(uint64_t));
+  ordering->outer_kind = (unsigned char *) calloc(n, sizeof(unsigned char));
+  ordering->prev_levels = (unsigned char *) calloc(n, sizeof(unsigned char));
+  if ( (!ordering->keys) || (!ordering->keys_tmp) || (!ordering->prev_keys)
+    || (!ordering->outer_kind) || (!ordering->prev_levels) ) {
+    destroyNarrowBandOrdering3d(ordering);
+    return NULL;
+  }
+
+  return ordering;
+}
+
+
+void destroyNarrowBandOrdering3d(LSM_NarrowBandOrdering *ordering)
+{
+  if (!ordering) return;
+  free(ordering->keys);
+  free(ordering->keys_tmp);
+  free(ordering->prev_keys);
+  free(ordering->outer_kind);
+  free(ordering->prev_levels);
+  free(ordering);
+}
+
+
+int sortNarrowBand3d(
+  LSM_NarrowBandOrdering *ordering,
+  const unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  const int *n_lo,
+  const int *n_hi,
+  int level,
+  int *index_outer,
+  int nlo_outer_plus,
+  int nhi_outer_plus,
+  int nlo_outer_minus,
+  int nhi_outer_minus)
+{
+  LSM_NarrowBandSortArgs args;
+  Grid *grid;
+  int nx, nxy, num_blocks;
+  int l, m;
+
+  /* check arguments */
+  if ( !ordering || !narrow_band || !index_x || !index_y || !index_z
+    || !n_lo || !n_hi || (level < 0) || (level > LSM_NB_MAX_LEVEL)
+    || ( !index_outer && ( (nhi_outer_plus >= nlo_outer_plus)
+                        || (nhi_outer_minus >= nlo_outer_minus) ) ) ) {
+    return LSM_NARROW_BAND_ERR_INVALID_ARGUMENT;
+  }
+  grid = ordering->grid;
+  nx = grid->grid_dims_ghostbox[0];
+  nxy = nx*grid->grid_dims_ghostbox[1];
+
+  num_blocks = LSM_Runtime_getNumThreads();
+  memset(&args, 0, sizeof(args));
+  args.grid = grid;
+  args.index_x = index_x;
+  args.index_y = index_y;
+  args.index_z = index_z;
+  args.block_count = (int *) malloc(LSM_NB_RADIX*num_blocks*sizeof(int));
+  if (!args.block_count) return LSM_NARROW_BAND_ERR_MEMORY_ALLOCATION;
+
+  /* flag the outer points of level 0 */
+  if (index_outer) {
+    for (m = nlo_outer_minus; m <= nhi_outer_minus; m++) {
+      int n = index_outer[m];
+      ordering->outer_kind[(index_x[n] - grid->ilo_gb)
+                           + (index_y[n] - grid->jlo_gb)*nx
+                           + (index_z[n] - grid->klo_gb)*nxy] = 1;
+    }
+    for (m = nlo_outer_plus; m <= nhi_outer_plus; m++) {
+      int n = index_outer[m];
+      ordering->outer_kind[(index_x[n] - grid->ilo_gb)
+                           + (index_y[n] - grid->jlo_gb)*nx
+                           + (index_z[n] - grid->klo_gb)*nxy] = 2;
+    }
+  }
+
+  /* sort each level */
+  ordering->num_merged_levels = 0;
+  for (l = 0; l <= level; l++) {
+    int num_points = n_hi[l] - n_lo[l] + 1;
+    int merged = 0;
+    uint64_t *sorted;
+    if (num_points <= 0) continue;
+    args.offset = n_lo[l];
+
+    if ( ordering->has_prev && (l <= ordering->prev_level) ) {
+      /* collect the points that are new in level l */
+      int num_new = 0;
+      for (m = n_lo[l]; m <= n_hi[l]; m++) {
+        int i = index_x[m] - grid->ilo_gb;
+        int j = index_y[m] - grid->jlo_gb;
+        int k = index_z[m] - grid->klo_gb;
+        if (ordering->prev_levels[i + j*nx + k*nxy] != l+1) {
+          ordering->keys[num_new++] = mortonKey(i, j, k);
+        }
+      }
+
+      /* merge the sorted new points with the remaining previous points */
+      if (4*num_new <= num_points) {
+        int m_prev = ordering->prev_n_lo[l];
+        int n = 0, pos = n_lo[l];
+        sorted = sortMortonKeys(&args, ordering->keys, ordering->keys_tmp,
+                                num_new, ordering->num_key_bits,
+                                num_blocks);
+        while ( (m_prev <= ordering->prev_n_hi[l]) || (n < num_new) ) {
+          uint64_t key;
+          if ( (m_prev <= ordering->prev_n_hi[l])
+            && ( (n == num_new)
+              || (ordering->prev_keys[m_prev] < sorted[n]) ) ) {
+            key = ordering->prev_keys[m_prev++];
+            if ( (narrow_band[mortonKeyToIndex(key, grid)]
+                & LSM_NB_LEVEL_BITS) != l+1 ) continue;
+          } else {
+            key = sorted[n++];
+          }
+          index_x[pos] = grid->ilo_gb + compactBits(key);
+          index_y[pos] = grid->jlo_gb + compactBits(key >> 1);
+          index_z[pos] = grid->klo_gb + compactBits(key >> 2);
+          pos++;
+        }
+        merged = 1;
+        ordering->num_merged_levels++;
+      }
+    }
+
+    if (!merged) {
+      args.dst = ordering->keys;
+      LSM_Runtime_parallelFor(0, num_points, LSM_SCHEDULE_STATIC, 0, 0,
+                              computeMortonKeys, &args);
+      sorted = sortMortonKeys(&args, ordering->keys, ordering->keys_tmp,
+                              num_points, ordering->num_key_bits,
+                              num_blocks);
+      args.src = sorted;
+      LSM_Runtime_parallelFor(0, num_points, LSM_SCHEDULE_STATIC, 0, 0,
+                              decodeMortonKeys, &args);
+    }
+  }
+  free(args.block_count);
+
+  /* list the outer points in the new order of level 0 */
+  if (index_outer) {
+    int m_minus = nlo_outer_minus, m_plus = nlo_outer_plus;
+    for (m = n_lo[0]; m <= n_hi[0]; m++) {
+      int idx = (index_x[m] - grid->ilo_gb) + (index_y[m] - grid->jlo_gb)*nx
+              + (index_z[m] - grid->klo_gb)*nxy;
+      if (ordering->outer_kind[idx] == 1) {
+        index_outer[m_minus++] = m;
+      } else if (ordering->outer_kind[idx] == 2) {
+        index_outer[m_plus++] = m;
+      }
+      ordering->outer_kind[idx] = 0;
+    }
+  }
+
+  /* save the sorted narrow band for the next call */
+  if (ordering->has_prev) {
+    for (m = ordering->prev_n_lo[0];
+         m <= ordering->prev_n_hi[ordering->prev_level]; m++) {
+      ordering->prev_levels[mortonKeyToIndex(ordering->prev_keys[m],
+                                             grid)] = 0;
+    }
+  }
+  args.offset = 0;
+  args.dst = ordering->prev_keys;
+  LSM_Runtime_parallelFor(n_lo[0], n_hi[level] + 1, LSM_SCHEDULE_STATIC, 0,
+                          0, computeMortonKeys, &args);
+  for (l = 0; l <= level; l++) {
+    for (m = n_lo[l]; m <= n_hi[l]; m++) {
+      ordering->prev_levels[mortonKeyToIndex(ordering->prev_keys[m],
+                                             grid)] = (unsigned char) (l+1);
+    }
+    ordering->prev_n_lo[l] = n_lo[l];
+    ordering->prev_n_hi[l] = n_hi[l];
+  }
+  ordering->prev_level = level;
+  ordering->has_prev = 1;
+
+  return LSM_NARROW_BAND_ERR_SUCCESS;
+}
@@ -0,0 +1,419 @@
+/*
+ * File:        lsm_narrow_band3d.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for threaded 3D narrow band construction
+ */
+
+#ifndef included_lsm_narrow_band3d_h
+#define included_lsm_narrow_band3d_h
+
+#include <stdint.h>
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+#include "lsm_grid.h"
+
+/*! \file lsm_narrow_band3d.h
+ *
+ * \brief
+ * @ref lsm_narrow_band3d.h provides threaded replacements for
+ * LSM3D_DETERMINE_NARROW_BAND(),
+ * LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS() and
+ * LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK() (see
+ * @ref lsm_localization3d.h).
+ *
+ * The narrow band is built slab by slab (a slab is a plane of grid
+ * points with fixed z-index), with the slabs distributed across the
+ * threads of the LSMLIB runtime (see @ref lsm_runtime.h):
+ *
+ * -# Level 0:  each slab is scanned to flag narrow band points and count
+ *    them.  A prefix sum over the slab counts gives the position of
+ *    each slab's points in the index_* arrays, and a second scan
+ *    writes the points.
+ *
+ * -# Level L > 0:  the new points in slab k are found by the thread that
+ *    owns slab k from the level L-1 points in slabs k-1, k and k+1 and
+ *    are collected in a per-thread frontier buffer.  A prefix sum over
+ *    the slab counts gives the output positions, and the frontier
+ *    buffers are then copied into the index_* arrays.
+ *
+ * Because only the owner of slab k writes narrow_band values in slab k,
+ * no atomic operations are required.  The set of points in each level
+ * is the same as the one computed by LSM3D_DETERMINE_NARROW_BAND().
+ * The level 0 points and the index_outer array are in the same order;
+ * points in levels L > 0 are ordered by slab.  The result does not
+ * depend on the number of threads.
+ *
+ * Since neighboring points of a level may be far apart in the index_*
+ * arrays, sortNarrowBand3d() can be called after the narrow band is
+ * built to reorder each level along a Morton (Z-order) curve, so that
+ * consecutive points of the local kernels have nearby stencils.
+ *
+ */
+
+
+/*!
+ * Error codes returned by narrow band construction functions.
+ */
+#define LSM_NARROW_BAND_ERR_SUCCESS                 (0)
+#define LSM_NARROW_BAND_ERR_INVALID_ARGUMENT        (1)
+#define LSM_NARROW_BAND_ERR_MEMORY_ALLOCATION       (2)
+
+
+/*!
+ * determineNarrowBand3d() finds the narrow band voxels around the zero
+ * level set of the specified width and marks their neighbors up to the
+ * desired level.
+ *
+ * Arguments:
+ *  - phi (in):                level set function (assumed signed distance
+ *                             function)
+ *  - narrow_band (out):       array with level bits L+1 for narrow band
+ *                             level L voxels (0 otherwise) and boundary
+ *                             layer bits of all voxels (see LSM_NB_* in
+ *                             @ref lsm_grid.h)
+ *  - index_* (out):           arrays with coordinates of narrow band
+ *                             voxels; indices of level L narrow band
+ *                             stored consecutively
+ *  - n_lo (out):              n_lo[L] is the starting index of the level
+ *                             L narrow band voxels
+ *  - n_hi (out):              n_hi[L] is the ending index of the level L
+ *                             narrow band voxels
+ *  - index_outer (out):       indices of the narrow band voxels such
+ *                             that width_inner <= abs(phi) < width
+ *  - num_index_outer (in):    allocated length of index_outer
+ *  - n*_outer_plus (out):     index range of index_outer elements with
+ *                             width_inner <= phi < width
+ *  - n*_outer_minus (out):    index range of index_outer elements with
+ *                             -width < phi <= -width_inner
+ *  - width (in):              narrow band width
+ *  - width_inner (in):        inner narrow band width
+ *  - level (in):              number of narrow band levels to mark
+ *  - grid (in):               pointer to Grid data structure
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - The arguments have the same meaning as the arguments of
+ *    LSM3D_DETERMINE_NARROW_BAND() with nlo_index = 0 and
+ *    nlo_index_outer = 0.
+ *
+ *  - narrow_band and the index_* arrays must have grid->num_gridpts
+ *    elements; n_lo and n_hi must have (level+1) elements.
+ *
+ *  - level may not exceed LSM_NB_MAX_LEVEL.
+ *
+ *  - Empty levels have n_hi[L] = n_lo[L] - 1.
+ *
+ *  - Voxels outside of the fillbox ARE included in the narrow band.
+ *    Their boundary layer bits are set from grid->nb_layer_mask, so
+ *    narrow_band can be passed directly to the local kernels with the
+ *    grid->mark_* values; no LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER()
+ *    passes are needed.
+ *
+ */
+int determineNarrowBand3d(
+  const LSMLIB_REAL *phi,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid);
+
+
+/*!
+ * determineNarrowBandFromTwoLevelSets3d() is the threaded replacement for
+ * LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS().  It finds the narrow
+ * band voxels around the intersection of the zero level sets of phi and
+ * psi (a curve) and marks their neighbors up to the desired level.
+ *
+ * Arguments:
+ *  - phi (in):                level set function 1 (assumed signed
+ *                             distance function)
+ *  - psi (in):                level set function 2 (assumed signed
+ *                             distance function)
+ *  - other arguments:         same as for determineNarrowBand3d()
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - Level 0 consists of the voxels with |phi| < width and
+ *    |psi| < width.  The outer layer (index_outer) is determined
+ *    according to phi.
+ *
+ *  - The boundary layer bits are set as in determineNarrowBand3d().
+ *
+ */
+int determineNarrowBandFromTwoLevelSets3d(
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *psi,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid);
+
+
+/*!
+ * determineNarrowBandAwayFromMask3d() is the threaded replacement for
+ * LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK().  It finds the narrow
+ * band voxels that are not pinned to the mask and marks their neighbors
+ * up to the desired level.
+ *
+ * Arguments:
+ *  - phi (in):                level set function (assumed signed distance
+ *                             function)
+ *  - mask (in):               masking level set function
+ *  - solid_narrow_band (in):  narrow band of the mask, e.g. computed once
+ *                             by determineSolidNarrowBand3d()
+ *  - other arguments:         same as for determineNarrowBand3d()
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - A voxel with |phi| < width is left out of level 0 if it lies in
+ *    the solid narrow band (any level) and |phi - mask| is not larger
+ *    than the largest grid spacing.  The mask is only read at solid
+ *    narrow band voxels.
+ *
+ *  - Since phi is pinned to the mask only where |mask| < width, the
+ *    result is the same as the one computed by
+ *    LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK() if the solid narrow
+ *    band contains all voxels with |mask| < width + max(dx).  Pinned
+ *    voxels outside of a narrower solid narrow band remain in the
+ *    narrow band.
+ *
+ *  - The boundary layer bits are set as in determineNarrowBand3d().
+ *
+ */
+int determineNarrowBandAwayFromMask3d(
+  const LSMLIB_REAL *phi,
+  const LSMLIB_REAL *mask,
+  const unsigned char *solid_narrow_band,
+  unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  int *n_lo,
+  int *n_hi,
+  int *index_outer,
+  int num_index_outer,
+  int *nlo_outer_plus,
+  int *nhi_outer_plus,
+  int *nlo_outer_minus,
+  int *nhi_outer_minus,
+  LSMLIB_REAL width,
+  LSMLIB_REAL width_inner,
+  int level,
+  Grid *grid);
+
+
+/*!
+ * determineSolidNarrowBand3d() builds the static narrow band around the
+ * zero level set of a (time independent) masking function and caches the
+ * unit normals of the mask at the narrow band voxels.
+ *
+ * Arguments:
+ *  - mask (in):               masking level set function (assumed signed
+ *                             distance function)
+ *  - solid_narrow_band (out): narrow band of the mask (same encoding as
+ *                             narrow_band in determineNarrowBand3d())
+ *  - solid_index_* (out):     arrays with coordinates of solid narrow band
+ *                             voxels; indices of level L stored
+ *                             consecutively
+ *  - solid_n_lo (out):        solid_n_lo[L] is the starting index of the
+ *                             level L solid narrow band voxels
+ *  - solid_n_hi (out):        solid_n_hi[L] is the ending index of the
+ *                             level L solid narrow band voxels
+ *  - solid_normal_* (out):    components of grad(mask)/|grad(mask)| at
+ *                             the solid narrow band voxels
+ *  - width (in):              solid narrow band width
+ *  - level (in):              number of narrow band levels to mark
+ *  - grid (in):               pointer to Grid data structure
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - The arguments match the solid_* fields of LSM_DataArrays (see
+ *    @ref lsm_data_arrays.h).  Since the mask does not change, this
+ *    function only needs to be called once; the result is used by
+ *    LSM3D_IMPOSE_MASK_CONTACT_LOCAL() to restrict the masking to the
+ *    contact region and, together with
+ *    determineNarrowBandAwayFromMask3d(), keeps all per step mask work
+ *    at O(narrow band) cost.
+ *
+ *  - The normals are computed at all levels of the solid narrow band;
+ *    solid_normal_* must have grid->num_gridpts elements.
+ *
+ */
+int determineSolidNarrowBand3d(
+  const LSMLIB_REAL *mask,
+  unsigned char *solid_narrow_band,
+  int *solid_index_x,
+  int *solid_index_y,
+  int *solid_index_z,
+  int *solid_n_lo,
+  int *solid_n_hi,
+  LSMLIB_REAL *solid_normal_x,
+  LSMLIB_REAL *solid_normal_y,
+  LSMLIB_REAL *solid_normal_z,
+  LSMLIB_REAL width,
+  int level,
+  Grid *grid);
+
+
+/*!
+ * Structure 'LSM_NarrowBandOrdering' holds the work arrays of
+ * sortNarrowBand3d() and the sorted narrow band of the previous call,
+ * which is reused when the narrow band changes little.
+ */
+typedef struct _LSM_NarrowBandOrdering
+{
+  Grid          *grid;
+  int            num_key_bits;     /* bits of the Morton keys            */
+
+  /* work arrays (grid->num_gridpts elements) */
+  uint64_t      *keys;
+  uint64_t      *keys_tmp;
+  unsigned char *outer_kind;       /* 1 (minus) or 2 (plus) for outer
+                                      points of level 0, 0 elsewhere     */
+
+  /* sorted narrow band of the previous call */
+  int            has_prev;
+  int            prev_level;
+  int            prev_n_lo[LSM_NB_MAX_LEVEL+1];
+  int            prev_n_hi[LSM_NB_MAX_LEVEL+1];
+  uint64_t      *prev_keys;        /* keys of level L at prev_n_lo[L],
+                                      ..., prev_n_hi[L]                  */
+  unsigned char *prev_levels;      /* L+1 for previous level L points,
+                                      0 elsewhere                        */
+
+  /* statistics of the last call */
+  int            num_merged_levels;
+} LSM_NarrowBandOrdering;
+
+
+/*!
+ * createNarrowBandOrdering3d() creates the work data for
+ * sortNarrowBand3d().
+ *
+ * Arguments:
+ *  - grid (in):  pointer to Grid data structure
+ *
+ * Return value:  pointer to new ordering (NULL on failure)
+ *
+ * NOTES:
+ *  - The ordering allocates three 64-bit integer and two byte arrays
+ *    with grid->num_gridpts elements.
+ *
+ */
+LSM_NarrowBandOrdering *createNarrowBandOrdering3d(Grid *grid);
+
+/*!
+ * destroyNarrowBandOrdering3d() frees the work data of sortNarrowBand3d().
+ *
+ * Arguments:
+ *  - ordering (in):  pointer to ordering (may be NULL)
+ *
+ * Return value:      none
+ *
+ */
+void destroyNarrowBandOrdering3d(LSM_NarrowBandOrdering *ordering);
+
+/*!
+ * sortNarrowBand3d() sorts the points of each narrow band level along a
+ * Morton (Z-order) curve and updates index_outer accordingly.
+ *
+ * Arguments:
+ *  - ordering (in/out):       ordering work data
+ *  - narrow_band (in):        narrow band (level bits as set by
+ *                             determineNarrowBand3d())
+ *  - index_* (in/out):        arrays with coordinates of narrow band
+ *                             voxels
+ *  - n_lo (in):               n_lo[L] is the starting index of the level
+ *                             L narrow band voxels
+ *  - n_hi (in):               n_hi[L] is the ending index of the level L
+ *                             narrow band voxels
+ *  - level (in):              number of narrow band levels
+ *  - index_outer (in/out):    indices of the outer narrow band voxels
+ *                             (may be NULL if there are none)
+ *  - n*_outer_plus (in):      index range of index_outer elements with
+ *                             phi > 0
+ *  - n*_outer_minus (in):     index range of index_outer elements with
+ *                             phi < 0
+ *
+ * Return value:               error code
+ *
+ * NOTES:
+ *  - The arguments are the outputs of determineNarrowBand3d() (or one of
+ *    its variants).  Each level keeps its index range; only the order
+ *    of the points within a level changes.  The points of the outer
+ *    ranges of index_outer are listed in Morton order.
+ *
+ *  - The keys are sorted with a least-significant-digit radix sort on
+ *    8-bit digits whose histogram and scatter passes are distributed
+ *    across the threads of the LSMLIB runtime.  The result does not
+ *    depend on the number of threads.
+ *
+ *  - If a level changed little since the previous call (at most a
+ *    quarter of its points are new), the points of the previous sorted
+ *    level that are still in the level are merged with the sorted new
+ *    points instead of sorting the whole level.  The number of levels
+ *    updated this way is stored in ordering->num_merged_levels.
+ *
+ *  - Since the threaded narrow band builders expect levels ordered by
+ *    slab, sortNarrowBand3d() must be called after the narrow band is
+ *    built, not in between levels.
+ *
+ */
+int sortNarrowBand3d(
+  LSM_NarrowBandOrdering *ordering,
+  const unsigned char *narrow_band,
+  int *index_x,
+  int *index_y,
+  int *index_z,
+  const int *n_lo,
+  const int *n_hi,
+  int level,
+  int *index_outer,
+  int nlo_outer_plus,
+  int nhi_outer_plus,
+  int nlo_outer_minus,
+  int nhi_outer_minus);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
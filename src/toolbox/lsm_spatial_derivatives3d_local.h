@@ -36,6 +36,11 @@ extern "C" {
 #define LSM3D_HJ_ENO1_LOCAL              lsm3dhjeno1local_
 #define LSM3D_HJ_ENO2_LOCAL              lsm3dhjeno2local_
 
+#define LSM3D_UPWIND_HJ_ENO1_LOCAL       lsm3dupwindhjeno1local_
+#define LSM3D_UPWIND_HJ_ENO2_LOCAL       lsm3dupwindhjeno2local_
+#define LSM3D_UPWIND_HJ_ENO3_LOCAL       lsm3dupwindhjeno3local_
+#define LSM3D_UPWIND_HJ_WENO5_LOCAL      lsm3dupwindhjweno5local_
+
 #define LSM3D_CENTRAL_GRAD_ORDER2_LOCAL  lsm3dcentralgradorder2local_
 #define LSM3D_CENTRAL_GRAD_ORDER4_LOCAL  lsm3dcentralgradorder4local_
 
@@ -44,10 +49,6 @@ extern "C" {
 #define LSM3D_GRADIENT_MAGNITUDE_LOCAL   lsm3dgradientmagnitudelocal_
 
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
 /*!
 *
 *  LSM3D_HJ_ENO1_LOCAL() computes the forward (plus) and backward (minus)
@@ -219,6 +220,367 @@ void LSM3D_HJ_ENO2_LOCAL(
   const unsigned char *mark_D1,
   const unsigned char *mark_D2);
 
+/*!
+*
+*  LSM3D_UPWIND_HJ_ENO1_LOCAL() computes the first-order Hamilton-Jacobi ENO
+*  upwind approximation to the gradient of phi.
+*  The routine loops only over local (narrow band) points.
+*
+*  Arguments:
+*    phi_* (out):        components of grad(phi)
+*    phi (in):           phi
+*    vel_* (in):         components of the velocity
+*    D1 (in):            scratch space for holding undivided first-differences
+*    dx, dy, dz (in):    grid spacing
+*    *_gb (in):          index range for ghostbox
+*    index_[xyz](in):    [xyz] coordinates of local (narrow band) points
+*    n*_index[01](in):   index range of points in index_* that are in
+*                        level [01] of the narrow band
+*    narrow_band(in):    array that marks voxels outside desired fillbox
+*    mark_*(in):         upper limit narrow band value for voxels in 
+*                        the appropriate fillbox
+*
+*  NOTES:
+*   - index_[xyz] arrays range at minimum from nlo_index0 to nhi_index1
+*   - phi_* are only computed at level 0 points in the fillbox;
+*     the upwind direction is selected by the sign of vel_* so
+*     that phi_* may be passed directly to
+*     LSM3D_ADD_ADVECTION_TERM_TO_LSE_RHS_LOCAL()
+*
+*/
+void LSM3D_UPWIND_HJ_ENO1_LOCAL(
+  LSMLIB_REAL *phi_x,
+  LSMLIB_REAL *phi_y,
+  LSMLIB_REAL *phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_phi_gb,
+  const int *ihi_phi_gb,
+  const int *jlo_phi_gb,
+  const int *jhi_phi_gb,
+  const int *klo_phi_gb,
+  const int *khi_phi_gb,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  const int *ilo_vel_gb,
+  const int *ihi_vel_gb,
+  const int *jlo_vel_gb,
+  const int *jhi_vel_gb,
+  const int *klo_vel_gb,
+  const int *khi_vel_gb,
+  LSMLIB_REAL *D1,
+  const int *ilo_D1_gb,
+  const int *ihi_D1_gb,
+  const int *jlo_D1_gb,
+  const int *jhi_D1_gb,
+  const int *klo_D1_gb,
+  const int *khi_D1_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index0,
+  const int *nhi_index0,
+  const int *nlo_index1,
+  const int *nhi_index1,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb,
+  const unsigned char *mark_D1);
+
+/*!
+*
+*  LSM3D_UPWIND_HJ_ENO2_LOCAL() computes the second-order Hamilton-Jacobi ENO
+*  upwind approximation to the gradient of phi.
+*  The routine loops only over local (narrow band) points.
+*
+*  Arguments:
+*    phi_* (out):        components of grad(phi)
+*    phi (in):           phi
+*    vel_* (in):         components of the velocity
+*    D1 (in):            scratch space for holding undivided first-differences
+*    D2 (in):            scratch space for holding undivided second-differences
+*    dx, dy, dz (in):    grid spacing
+*    *_gb (in):          index range for ghostbox
+*    index_[xyz](in):    [xyz] coordinates of local (narrow band) points
+*    n*_index[012](in):  index range of points in index_* that are in
+*                        level [012] of the narrow band
+*    narrow_band(in):    array that marks voxels outside desired fillbox
+*    mark_*(in):         upper limit narrow band value for voxels in 
+*                        the appropriate fillbox
+*
+*  NOTES:
+*   - index_[xyz] arrays range at minimum from nlo_index0 to nhi_index2
+*   - phi_* are only computed at level 0 points in the fillbox;
+*     the upwind direction is selected by the sign of vel_* so
+*     that phi_* may be passed directly to
+*     LSM3D_ADD_ADVECTION_TERM_TO_LSE_RHS_LOCAL()
+*
+*/
+void LSM3D_UPWIND_HJ_ENO2_LOCAL(
+  LSMLIB_REAL *phi_x,
+  LSMLIB_REAL *phi_y,
+  LSMLIB_REAL *phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_phi_gb,
+  const int *ihi_phi_gb,
+  const int *jlo_phi_gb,
+  const int *jhi_phi_gb,
+  const int *klo_phi_gb,
+  const int *khi_phi_gb,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  const int *ilo_vel_gb,
+  const int *ihi_vel_gb,
+  const int *jlo_vel_gb,
+  const int *jhi_vel_gb,
+  const int *klo_vel_gb,
+  const int *khi_vel_gb,
+  LSMLIB_REAL *D1,
+  const int *ilo_D1_gb,
+  const int *ihi_D1_gb,
+  const int *jlo_D1_gb,
+  const int *jhi_D1_gb,
+  const int *klo_D1_gb,
+  const int *khi_D1_gb,
+  LSMLIB_REAL *D2,
+  const int *ilo_D2_gb,
+  const int *ihi_D2_gb,
+  const int *jlo_D2_gb,
+  const int *jhi_D2_gb,
+  const int *klo_D2_gb,
+  const int *khi_D2_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index0,
+  const int *nhi_index0,
+  const int *nlo_index1,
+  const int *nhi_index1,
+  const int *nlo_index2,
+  const int *nhi_index2,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb,
+  const unsigned char *mark_D1,
+  const unsigned char *mark_D2);
+
+/*!
+*
+*  LSM3D_UPWIND_HJ_ENO3_LOCAL() computes the third-order Hamilton-Jacobi ENO
+*  upwind approximation to the gradient of phi.
+*  The routine loops only over local (narrow band) points.
+*
+*  Arguments:
+*    phi_* (out):        components of grad(phi)
+*    phi (in):           phi
+*    vel_* (in):         components of the velocity
+*    D1 (in):            scratch space for holding undivided first-differences
+*    D2 (in):            scratch space for holding undivided second-differences
+*    D3 (in):            scratch space for holding undivided third-differences
+*    dx, dy, dz (in):    grid spacing
+*    *_gb (in):          index range for ghostbox
+*    index_[xyz](in):    [xyz] coordinates of local (narrow band) points
+*    n*_index[0123](in): index range of points in index_* that are in
+*                        level [0123] of the narrow band
+*    narrow_band(in):    array that marks voxels outside desired fillbox
+*    mark_*(in):         upper limit narrow band value for voxels in 
+*                        the appropriate fillbox
+*
+*  NOTES:
+*   - index_[xyz] arrays range at minimum from nlo_index0 to nhi_index3
+*   - phi_* are only computed at level 0 points in the fillbox;
+*     the upwind direction is selected by the sign of vel_* so
+*     that phi_* may be passed directly to
+*     LSM3D_ADD_ADVECTION_TERM_TO_LSE_RHS_LOCAL()
+*
+*/
+void LSM3D_UPWIND_HJ_ENO3_LOCAL(
+  LSMLIB_REAL *phi_x,
+  LSMLIB_REAL *phi_y,
+  LSMLIB_REAL *phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_phi_gb,
+  const int *ihi_phi_gb,
+  const int *jlo_phi_gb,
+  const int *jhi_phi_gb,
+  const int *klo_phi_gb,
+  const int *khi_phi_gb,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  const int *ilo_vel_gb,
+  const int *ihi_vel_gb,
+  const int *jlo_vel_gb,
+  const int *jhi_vel_gb,
+  const int *klo_vel_gb,
+  const int *khi_vel_gb,
+  LSMLIB_REAL *D1,
+  const int *ilo_D1_gb,
+  const int *ihi_D1_gb,
+  const int *jlo_D1_gb,
+  const int *jhi_D1_gb,
+  const int *klo_D1_gb,
+  const int *khi_D1_gb,
+  LSMLIB_REAL *D2,
+  const int *ilo_D2_gb,
+  const int *ihi_D2_gb,
+  const int *jlo_D2_gb,
+  const int *jhi_D2_gb,
+  const int *klo_D2_gb,
+  const int *khi_D2_gb,
+  LSMLIB_REAL *D3,
+  const int *ilo_D3_gb,
+  const int *ihi_D3_gb,
+  const int *jlo_D3_gb,
+  const int *jhi_D3_gb,
+  const int *klo_D3_gb,
+  const int *khi_D3_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index0,
+  const int *nhi_index0,
+  const int *nlo_index1,
+  const int *nhi_index1,
+  const int *nlo_index2,
+  const int *nhi_index2,
+  const int *nlo_index3,
+  const int *nhi_index3,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb,
+  const unsigned char *mark_D1,
+  const unsigned char *mark_D2,
+  const unsigned char *mark_D3);
+
+/*!
+*
+*  LSM3D_UPWIND_HJ_WENO5_LOCAL() computes the fifth-order Hamilton-Jacobi WENO
+*  upwind approximation to the gradient of phi.
+*  The routine loops only over local (narrow band) points.
+*
+*  Arguments:
+*    phi_* (out):        components of grad(phi)
+*    phi (in):           phi
+*    vel_* (in):         components of the velocity
+*    D1 (in):            scratch space for holding undivided first-differences
+*    dx, dy, dz (in):    grid spacing
+*    *_gb (in):          index range for ghostbox
+*    index_[xyz](in):    [xyz] coordinates of local (narrow band) points
+*    n*_index[0123](in): index range of points in index_* that are in
+*                        level [0123] of the narrow band
+*    narrow_band(in):    array that marks voxels outside desired fillbox
+*    mark_*(in):         upper limit narrow band value for voxels in 
+*                        the appropriate fillbox
+*
+*  NOTES:
+*   - index_[xyz] arrays range at minimum from nlo_index0 to nhi_index3
+*   - phi_* are only computed at level 0 points in the fillbox;
+*     the upwind direction is selected by the sign of vel_* so
+*     that phi_* may be passed directly to
+*     LSM3D_ADD_ADVECTION_TERM_TO_LSE_RHS_LOCAL()
+*
+*/
+void LSM3D_UPWIND_HJ_WENO5_LOCAL(
+  LSMLIB_REAL *phi_x,
+  LSMLIB_REAL *phi_y,
+  LSMLIB_REAL *phi_z,
+  const int *ilo_grad_phi_gb,
+  const int *ihi_grad_phi_gb,
+  const int *jlo_grad_phi_gb,
+  const int *jhi_grad_phi_gb,
+  const int *klo_grad_phi_gb,
+  const int *khi_grad_phi_gb,
+  const LSMLIB_REAL *phi,
+  const int *ilo_phi_gb,
+  const int *ihi_phi_gb,
+  const int *jlo_phi_gb,
+  const int *jhi_phi_gb,
+  const int *klo_phi_gb,
+  const int *khi_phi_gb,
+  const LSMLIB_REAL *vel_x,
+  const LSMLIB_REAL *vel_y,
+  const LSMLIB_REAL *vel_z,
+  const int *ilo_vel_gb,
+  const int *ihi_vel_gb,
+  const int *jlo_vel_gb,
+  const int *jhi_vel_gb,
+  const int *klo_vel_gb,
+  const int *khi_vel_gb,
+  LSMLIB_REAL *D1,
+  const int *ilo_D1_gb,
+  const int *ihi_D1_gb,
+  const int *jlo_D1_gb,
+  const int *jhi_D1_gb,
+  const int *klo_D1_gb,
+  const int *khi_D1_gb,
+  const LSMLIB_REAL *dx,
+  const LSMLIB_REAL *dy,
+  const LSMLIB_REAL *dz,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  const int *nlo_index0,
+  const int *nhi_index0,
+  const int *nlo_index1,
+  const int *nhi_index1,
+  const int *nlo_index2,
+  const int *nhi_index2,
+  const int *nlo_index3,
+  const int *nhi_index3,
+  const unsigned char *narrow_band,
+  const int *ilo_nb_gb,
+  const int *ihi_nb_gb,
+  const int *jlo_nb_gb,
+  const int *jhi_nb_gb,
+  const int *klo_nb_gb,
+  const int *khi_nb_gb,
+  const unsigned char *mark_fb,
+  const unsigned char *mark_D1);
+
 /*!
 *
 *  LSM3D_CENTRAL_GRAD_ORDER2_LOCAL() computes the second-order central 
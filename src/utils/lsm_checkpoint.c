@@ -0,0 +1,735 @@
+/*
+ * File:        lsm_checkpoint.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of incremental checkpointing of level set
+ *              calculations
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsmlib_config.h"
+#include "lsm_checkpoint.h"
+
+
+/*===================== Checkpoint Constants ========================*/
+#define LSM_CHECKPOINT_FULL_MAGIC            (0x4643534cu)  /* "LSCF" */
+#define LSM_CHECKPOINT_DELTA_MAGIC           (0x4443534cu)  /* "LSCD" */
+#define LSM_CHECKPOINT_DELTA_END_MAGIC       (0x4543534cu)  /* "LSCE" */
+#define LSM_CHECKPOINT_VERSION               (1)
+#define LSM_CHECKPOINT_HASH_MULTIPLIER       (0x9e3779b97f4a7c15ull)
+
+
+/*=================== Checkpoint Data Structures ====================*/
+
+/*
+ * Structure 'LSM_CheckpointFullHeader' is the header of a full
+ * checkpoint file.  It is followed by the fields, one after another.
+ */
+typedef struct _LSM_CheckpointFullHeader
+{
+  uint32_t magic;
+  uint32_t version;
+  int32_t  real_size;
+  int32_t  num_dims;
+  int32_t  grid_dims[3];
+  int32_t  num_fields;
+  uint32_t generation;
+} LSM_CheckpointFullHeader;
+
+/*
+ * Structure 'LSM_CheckpointDeltaHeader' is the header of a delta record.
+ * It is followed by the indices of the bricks in the record, the data
+ * of the bricks (for each brick, the data of all fields in order) and
+ * an LSM_CheckpointDeltaTrailer.
+ */
+typedef struct _LSM_CheckpointDeltaHeader
+{
+  uint32_t magic;
+  uint32_t generation;
+  int32_t  sequence;
+  int32_t  brick_dims[3];
+  int32_t  num_bricks;
+} LSM_CheckpointDeltaHeader;
+
+typedef struct _LSM_CheckpointDeltaTrailer
+{
+  uint32_t magic;
+  int32_t  sequence;
+} LSM_CheckpointDeltaTrailer;
+
+
+/*==================== Helper Function Declarations =================*/
+
+/*
+ * lsm_checkpoint_fileName() returns a newly allocated string holding
+ * file_base followed by suffix.
+ */
+static char *lsm_checkpoint_fileName(const char *file_base, const char *suffix);
+
+/*
+ * lsm_checkpoint_brickBox() computes the index range [lo, hi) of a
+ * brick and returns its number of grid points.
+ */
+static int lsm_checkpoint_brickBox(
+  const int *grid_dims,
+  const int *brick_dims,
+  const int *num_bricks_dir,
+  int brick,
+  int *lo,
+  int *hi);
+
+/*
+ * lsm_checkpoint_hashBrick() computes the hash of a brick over all
+ * fields.
+ */
+static uint64_t lsm_checkpoint_hashBrick(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields,
+  int brick);
+
+/*
+ * lsm_checkpoint_brickInBand() returns 1 if a brick contains narrow
+ * band points.
+ */
+static int lsm_checkpoint_brickInBand(
+  LSM_Checkpoint *checkpoint,
+  const unsigned char *narrow_band,
+  int brick);
+
+/*
+ * lsm_checkpoint_copyBrick() copies the data of a brick between the
+ * fields and a contiguous buffer (to_buffer = 1:  fields -> buffer).
+ */
+static void lsm_checkpoint_copyBrick(
+  const int *grid_dims,
+  const int *brick_dims,
+  const int *num_bricks_dir,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  int brick,
+  LSMLIB_REAL *buffer,
+  int to_buffer);
+
+/*
+ * lsm_checkpoint_readFullHeader() reads and checks the header of a full
+ * checkpoint file.
+ */
+static int lsm_checkpoint_readFullHeader(
+  FILE *fp,
+  LSM_CheckpointFullHeader *header);
+
+
+/*======================= Checkpoint Functions ======================*/
+
+LSM_Checkpoint *createLSMCheckpoint(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  const int *brick_dims,
+  int full_interval)
+{
+  LSM_Checkpoint *checkpoint;
+  char *full_file;
+  FILE *fp;
+  int l;
+
+  if ( (!file_base) || (!grid) || (num_fields < 1) ) return NULL;
+  if ( (grid->num_dims < 2) || (grid->num_dims > 3) ) return NULL;
+  if (brick_dims) {
+    for (l = 0; l < grid->num_dims; l++) {
+      if (brick_dims[l] < 1) return NULL;
+    }
+  }
+
+  checkpoint = (LSM_Checkpoint*) calloc(1, sizeof(LSM_Checkpoint));
+  if (!checkpoint) return NULL;
+  checkpoint->file_base = (char*) malloc(strlen(file_base) + 1);
+  if (!checkpoint->file_base) {
+    destroyLSMCheckpoint(checkpoint);
+    return NULL;
+  }
+  strcpy(checkpoint->file_base, file_base);
+
+  checkpoint->num_dims = grid->num_dims;
+  checkpoint->num_gridpts = grid->num_gridpts;
+  checkpoint->num_fields = num_fields;
+  checkpoint->num_bricks = 1;
+  for (l = 0; l < 3; l++) {
+    if (l < grid->num_dims) {
+      checkpoint->grid_dims[l] = grid->grid_dims_ghostbox[l];
+      checkpoint->brick_dims[l] = brick_dims ? brick_dims[l]
+                                : LSM_CHECKPOINT_DEFAULT_BRICK_SIZE;
+    } else {
+      checkpoint->grid_dims[l] = 1;
+      checkpoint->brick_dims[l] = 1;
+    }
+    checkpoint->num_bricks_dir[l] =
+      (checkpoint->grid_dims[l] + checkpoint->brick_dims[l] - 1)
+      / checkpoint->brick_dims[l];
+    checkpoint->num_bricks *= checkpoint->num_bricks_dir[l];
+  }
+  checkpoint->full_interval = (full_interval > 0) ? full_interval
+                            : LSM_CHECKPOINT_DEFAULT_FULL_INTERVAL;
+
+  checkpoint->brick_hashes = (uint64_t*)
+    calloc(checkpoint->num_bricks, sizeof(uint64_t));
+  checkpoint->brick_in_band = (unsigned char*)
+    calloc(checkpoint->num_bricks, sizeof(unsigned char));
+  if ( (!checkpoint->brick_hashes) || (!checkpoint->brick_in_band) ) {
+    destroyLSMCheckpoint(checkpoint);
+    return NULL;
+  }
+
+  /* continue the generations of an existing checkpoint so that its */
+  /* deltas are never mistaken for deltas of a new full checkpoint  */
+  full_file = lsm_checkpoint_fileName(file_base, ".full");
+  if (!full_file) {
+    destroyLSMCheckpoint(checkpoint);
+    return NULL;
+  }
+  fp = fopen(full_file, "rb");
+  if (fp) {
+    LSM_CheckpointFullHeader header;
+    if (lsm_checkpoint_readFullHeader(fp, &header)
+        == LSM_CHECKPOINT_ERR_SUCCESS) {
+      checkpoint->generation = header.generation;
+    }
+    fclose(fp);
+  }
+  free(full_file);
+
+  /* the first checkpoint is full */
+  checkpoint->num_deltas = -1;
+
+  return checkpoint;
+}
+
+
+void destroyLSMCheckpoint(LSM_Checkpoint *checkpoint)
+{
+  if (!checkpoint) return;
+  free(checkpoint->file_base);
+  free(checkpoint->brick_hashes);
+  free(checkpoint->brick_in_band);
+  free(checkpoint);
+}
+
+
+int writeLSMCheckpoint(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields,
+  const unsigned char *narrow_band)
+{
+  LSM_CheckpointDeltaHeader header;
+  LSM_CheckpointDeltaTrailer trailer;
+  unsigned char *in_band = NULL;
+  uint64_t *hashes = NULL;
+  int32_t *dirty_bricks = NULL;
+  LSMLIB_REAL *buffer = NULL;
+  char *delta_file;
+  FILE *fp;
+  int num_dirty = 0, max_brick_size, b, f;
+  int err = LSM_CHECKPOINT_ERR_SUCCESS;
+  long bytes_written;
+
+  if ( (!checkpoint) || (!fields) ) {
+    return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+  for (f = 0; f < checkpoint->num_fields; f++) {
+    if (!fields[f]) return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+
+  /* bricks that contain narrow band points now */
+  if (narrow_band) {
+    in_band = (unsigned char*) malloc(checkpoint->num_bricks);
+    if (!in_band) return LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+    for (b = 0; b < checkpoint->num_bricks; b++) {
+      in_band[b] = lsm_checkpoint_brickInBand(checkpoint, narrow_band, b);
+    }
+  }
+
+  /* full checkpoint:  first checkpoint or consolidation of the deltas */
+  if ( (checkpoint->num_deltas < 0)
+    || (checkpoint->num_deltas >= checkpoint->full_interval) ) {
+    err = writeLSMCheckpointFull(checkpoint, fields);
+    if ( (err == LSM_CHECKPOINT_ERR_SUCCESS) && (in_band) ) {
+      memcpy(checkpoint->brick_in_band, in_band, checkpoint->num_bricks);
+    }
+    free(in_band);
+    return err;
+  }
+
+  /* find changed bricks */
+  hashes = (uint64_t*) malloc(checkpoint->num_bricks*sizeof(uint64_t));
+  dirty_bricks = (int32_t*) malloc(checkpoint->num_bricks*sizeof(int32_t));
+  if ( (!hashes) || (!dirty_bricks) ) {
+    err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+  for (b = 0; b < checkpoint->num_bricks; b++) {
+    hashes[b] = checkpoint->brick_hashes[b];
+    if ( (in_band) && (!in_band[b]) && (!checkpoint->brick_in_band[b]) ) {
+      continue;
+    }
+    hashes[b] = lsm_checkpoint_hashBrick(checkpoint, fields, b);
+    if (hashes[b] != checkpoint->brick_hashes[b]) {
+      dirty_bricks[num_dirty++] = b;
+    }
+  }
+
+  /* consolidate early when most of the grid has changed */
+  if (2*num_dirty > checkpoint->num_bricks) {
+    err = writeLSMCheckpointFull(checkpoint, fields);
+    if ( (err == LSM_CHECKPOINT_ERR_SUCCESS) && (in_band) ) {
+      memcpy(checkpoint->brick_in_band, in_band, checkpoint->num_bricks);
+    }
+    goto cleanup;
+  }
+
+  /* append delta record */
+  max_brick_size = checkpoint->num_fields*checkpoint->brick_dims[0]
+                 * checkpoint->brick_dims[1]*checkpoint->brick_dims[2];
+  buffer = (LSMLIB_REAL*) malloc(max_brick_size*sizeof(LSMLIB_REAL));
+  delta_file = lsm_checkpoint_fileName(checkpoint->file_base, ".delta");
+  if ( (!buffer) || (!delta_file) ) {
+    free(delta_file);
+    err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+  fp = fopen(delta_file, "ab");
+  free(delta_file);
+  if (!fp) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+    goto cleanup;
+  }
+
+  header.magic = LSM_CHECKPOINT_DELTA_MAGIC;
+  header.generation = checkpoint->generation;
+  header.sequence = checkpoint->num_deltas + 1;
+  for (f = 0; f < 3; f++) header.brick_dims[f] = checkpoint->brick_dims[f];
+  header.num_bricks = num_dirty;
+  trailer.magic = LSM_CHECKPOINT_DELTA_END_MAGIC;
+  trailer.sequence = header.sequence;
+
+  bytes_written = sizeof(header) + num_dirty*sizeof(int32_t) + sizeof(trailer);
+  if ( (fwrite(&header, sizeof(header), 1, fp) != 1)
+    || (fwrite(dirty_bricks, sizeof(int32_t), num_dirty, fp)
+        != (size_t) num_dirty) ) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+  }
+  for (b = 0; (b < num_dirty) && (err == LSM_CHECKPOINT_ERR_SUCCESS); b++) {
+    int lo[3], hi[3];
+    int size = checkpoint->num_fields
+             * lsm_checkpoint_brickBox(checkpoint->grid_dims,
+                                       checkpoint->brick_dims,
+                                       checkpoint->num_bricks_dir,
+                                       dirty_bricks[b], lo, hi);
+    lsm_checkpoint_copyBrick(checkpoint->grid_dims, checkpoint->brick_dims,
+                             checkpoint->num_bricks_dir,
+                             checkpoint->num_fields, fields,
+                             dirty_bricks[b], buffer, 1);
+    if (fwrite(buffer, sizeof(LSMLIB_REAL), size, fp) != (size_t) size) {
+      err = LSM_CHECKPOINT_ERR_FILE_IO;
+    }
+    bytes_written += size*sizeof(LSMLIB_REAL);
+  }
+  if ( (err == LSM_CHECKPOINT_ERR_SUCCESS)
+    && (fwrite(&trailer, sizeof(trailer), 1, fp) != 1) ) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+  }
+  if (fclose(fp) != 0) err = LSM_CHECKPOINT_ERR_FILE_IO;
+
+  if (err == LSM_CHECKPOINT_ERR_SUCCESS) {
+    memcpy(checkpoint->brick_hashes, hashes,
+           checkpoint->num_bricks*sizeof(uint64_t));
+    if (in_band) {
+      memcpy(checkpoint->brick_in_band, in_band, checkpoint->num_bricks);
+    }
+    checkpoint->num_deltas++;
+    checkpoint->last_num_bricks_written = num_dirty;
+    checkpoint->last_bytes_written = bytes_written;
+    checkpoint->last_was_full = 0;
+  } else {
+    /* a partial record may have been appended; deltas appended after */
+    /* it could not be replayed, so make the next checkpoint full,     */
+    /* which removes the delta file                                    */
+    checkpoint->num_deltas = -1;
+  }
+
+cleanup:
+  free(buffer);
+  free(dirty_bricks);
+  free(hashes);
+  free(in_band);
+  return err;
+}
+
+
+int writeLSMCheckpointFull(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields)
+{
+  LSM_CheckpointFullHeader header;
+  char *full_file, *tmp_file, *delta_file;
+  FILE *fp;
+  int b, f, l;
+  int err = LSM_CHECKPOINT_ERR_SUCCESS;
+
+  if ( (!checkpoint) || (!fields) ) {
+    return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+  for (f = 0; f < checkpoint->num_fields; f++) {
+    if (!fields[f]) return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+
+  full_file = lsm_checkpoint_fileName(checkpoint->file_base, ".full");
+  tmp_file = lsm_checkpoint_fileName(checkpoint->file_base, ".full.tmp");
+  delta_file = lsm_checkpoint_fileName(checkpoint->file_base, ".delta");
+  if ( (!full_file) || (!tmp_file) || (!delta_file) ) {
+    err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+
+  header.magic = LSM_CHECKPOINT_FULL_MAGIC;
+  header.version = LSM_CHECKPOINT_VERSION;
+  header.real_size = sizeof(LSMLIB_REAL);
+  header.num_dims = checkpoint->num_dims;
+  for (l = 0; l < 3; l++) header.grid_dims[l] = checkpoint->grid_dims[l];
+  header.num_fields = checkpoint->num_fields;
+  header.generation = checkpoint->generation + 1;
+
+  /* write the new full checkpoint next to the old one, then replace */
+  /* it and drop the deltas, which belong to the old generation      */
+  fp = fopen(tmp_file, "wb");
+  if (!fp) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+    goto cleanup;
+  }
+  if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+  }
+  for (f = 0; (f < checkpoint->num_fields)
+              && (err == LSM_CHECKPOINT_ERR_SUCCESS); f++) {
+    if (fwrite(fields[f], sizeof(LSMLIB_REAL), checkpoint->num_gridpts, fp)
+        != (size_t) checkpoint->num_gridpts) {
+      err = LSM_CHECKPOINT_ERR_FILE_IO;
+    }
+  }
+  if (fclose(fp) != 0) err = LSM_CHECKPOINT_ERR_FILE_IO;
+  if ( (err != LSM_CHECKPOINT_ERR_SUCCESS)
+    || (rename(tmp_file, full_file) != 0) ) {
+    remove(tmp_file);
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+    goto cleanup;
+  }
+  remove(delta_file);
+
+  for (b = 0; b < checkpoint->num_bricks; b++) {
+    checkpoint->brick_hashes[b] =
+      lsm_checkpoint_hashBrick(checkpoint, fields, b);
+    checkpoint->brick_in_band[b] = 1;
+  }
+  checkpoint->generation = header.generation;
+  checkpoint->num_deltas = 0;
+  checkpoint->last_num_bricks_written = checkpoint->num_bricks;
+  checkpoint->last_bytes_written = sizeof(header)
+    + (long) checkpoint->num_fields*checkpoint->num_gridpts
+      *sizeof(LSMLIB_REAL);
+  checkpoint->last_was_full = 1;
+
+cleanup:
+  free(full_file);
+  free(tmp_file);
+  free(delta_file);
+  return err;
+}
+
+
+int readLSMCheckpoint(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields)
+{
+  LSM_CheckpointFullHeader full_header;
+  int grid_dims[3], brick_dims[3], num_bricks_dir[3];
+  int32_t *bricks = NULL;
+  LSMLIB_REAL *data = NULL;
+  char *full_file, *delta_file;
+  FILE *fp;
+  int f, l;
+  int err = LSM_CHECKPOINT_ERR_SUCCESS;
+
+  if ( (!file_base) || (!grid) || (num_fields < 1) || (!fields) ) {
+    return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+  for (f = 0; f < num_fields; f++) {
+    if (!fields[f]) return LSM_CHECKPOINT_ERR_INVALID_ARGUMENT;
+  }
+
+  full_file = lsm_checkpoint_fileName(file_base, ".full");
+  delta_file = lsm_checkpoint_fileName(file_base, ".delta");
+  if ( (!full_file) || (!delta_file) ) {
+    err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+
+  /* full checkpoint */
+  fp = fopen(full_file, "rb");
+  if (!fp) {
+    err = LSM_CHECKPOINT_ERR_FILE_IO;
+    goto cleanup;
+  }
+  err = lsm_checkpoint_readFullHeader(fp, &full_header);
+  if (err == LSM_CHECKPOINT_ERR_SUCCESS) {
+    if ( (full_header.num_dims != grid->num_dims)
+      || (full_header.num_fields != num_fields) ) {
+      err = LSM_CHECKPOINT_ERR_INVALID_FILE;
+    }
+    for (l = 0; l < 3; l++) {
+      grid_dims[l] = (l < grid->num_dims) ? grid->grid_dims_ghostbox[l] : 1;
+      if (full_header.grid_dims[l] != grid_dims[l]) {
+        err = LSM_CHECKPOINT_ERR_INVALID_FILE;
+      }
+    }
+  }
+  for (f = 0; (f < num_fields) && (err == LSM_CHECKPOINT_ERR_SUCCESS); f++) {
+    if (fread(fields[f], sizeof(LSMLIB_REAL), grid->num_gridpts, fp)
+        != (size_t) grid->num_gridpts) {
+      err = LSM_CHECKPOINT_ERR_INVALID_FILE;
+    }
+  }
+  fclose(fp);
+  if (err != LSM_CHECKPOINT_ERR_SUCCESS) goto cleanup;
+
+  /* replay deltas */
+  fp = fopen(delta_file, "rb");
+  if (!fp) goto cleanup;
+  while (1) {
+    LSM_CheckpointDeltaHeader header;
+    LSM_CheckpointDeltaTrailer trailer;
+    long data_size = 0, offset = 0;
+    int b, nb;
+
+    if ( (fread(&header, sizeof(header), 1, fp) != 1)
+      || (header.magic != LSM_CHECKPOINT_DELTA_MAGIC)
+      || (header.num_bricks < 0) ) {
+      break;
+    }
+    nb = header.num_bricks;
+    free(bricks);
+    bricks = (int32_t*) malloc((nb > 0 ? nb : 1)*sizeof(int32_t));
+    if (!bricks) {
+      err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+      break;
+    }
+    if (fread(bricks, sizeof(int32_t), nb, fp) != (size_t) nb) break;
+    for (l = 0; l < 3; l++) {
+      brick_dims[l] = header.brick_dims[l];
+      if (brick_dims[l] < 1) break;
+      num_bricks_dir[l] = (grid_dims[l] + brick_dims[l] - 1)/brick_dims[l];
+    }
+    if (l < 3) break;
+    for (b = 0; b < nb; b++) {
+      int lo[3], hi[3];
+      if ( (bricks[b] < 0) || (bricks[b] >= num_bricks_dir[0]
+                               *num_bricks_dir[1]*num_bricks_dir[2]) ) {
+        break;
+      }
+      data_size += num_fields*lsm_checkpoint_brickBox(grid_dims, brick_dims,
+                                                      num_bricks_dir,
+                                                      bricks[b], lo, hi);
+    }
+    if (b < nb) break;
+
+    free(data);
+    data = (LSMLIB_REAL*) malloc((data_size > 0 ? data_size : 1)
+                                 *sizeof(LSMLIB_REAL));
+    if (!data) {
+      err = LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION;
+      break;
+    }
+    if ( (fread(data, sizeof(LSMLIB_REAL), data_size, fp)
+          != (size_t) data_size)
+      || (fread(&trailer, sizeof(trailer), 1, fp) != 1)
+      || (trailer.magic != LSM_CHECKPOINT_DELTA_END_MAGIC)
+      || (trailer.sequence != header.sequence) ) {
+      break;  /* incomplete record */
+    }
+
+    /* records of other generations are left over from an interrupted */
+    /* consolidation                                                  */
+    if (header.generation != full_header.generation) continue;
+
+    for (b = 0; b < nb; b++) {
+      int lo[3], hi[3];
+      lsm_checkpoint_copyBrick(grid_dims, brick_dims, num_bricks_dir,
+                               num_fields, fields, bricks[b],
+                               data + offset, 0);
+      offset += num_fields*lsm_checkpoint_brickBox(grid_dims, brick_dims,
+                                                   num_bricks_dir,
+                                                   bricks[b], lo, hi);
+    }
+  }
+  fclose(fp);
+
+cleanup:
+  free(bricks);
+  free(data);
+  free(full_file);
+  free(delta_file);
+  return err;
+}
+
+
+/*==================== Helper Function Definitions ==================*/
+
+static char *lsm_checkpoint_fileName(const char *file_base, const char *suffix)
+{
+  char *file_name = (char*) malloc(strlen(file_base) + strlen(suffix) + 1);
+  if (!file_name) return NULL;
+  strcpy(file_name, file_base);
+  strcat(file_name, suffix);
+  return file_name;
+}
+
+
+static int lsm_checkpoint_brickBox(
+  const int *grid_dims,
+  const int *brick_dims,
+  const int *num_bricks_dir,
+  int brick,
+  int *lo,
+  int *hi)
+{
+  int brick_idx[3], l;
+
+  brick_idx[0] = brick % num_bricks_dir[0];
+  brick_idx[1] = (brick / num_bricks_dir[0]) % num_bricks_dir[1];
+  brick_idx[2] = brick / (num_bricks_dir[0]*num_bricks_dir[1]);
+  for (l = 0; l < 3; l++) {
+    lo[l] = brick_idx[l]*brick_dims[l];
+    hi[l] = lo[l] + brick_dims[l];
+    if (hi[l] > grid_dims[l]) hi[l] = grid_dims[l];
+  }
+
+  return (hi[0] - lo[0])*(hi[1] - lo[1])*(hi[2] - lo[2]);
+}
+
+
+static uint64_t lsm_checkpoint_hashBrick(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields,
+  int brick)
+{
+  const int *grid_dims = checkpoint->grid_dims;
+  uint64_t hash = 0xcbf29ce484222325ull;
+  int lo[3], hi[3];
+  int f, j, k;
+
+  lsm_checkpoint_brickBox(grid_dims, checkpoint->brick_dims,
+                          checkpoint->num_bricks_dir, brick, lo, hi);
+  for (f = 0; f < checkpoint->num_fields; f++) {
+    for (k = lo[2]; k < hi[2]; k++) {
+      for (j = lo[1]; j < hi[1]; j++) {
+        const unsigned char *row = (const unsigned char*)
+          (fields[f] + lo[0] + grid_dims[0]*(j + grid_dims[1]*k));
+        size_t num_bytes = (hi[0] - lo[0])*sizeof(LSMLIB_REAL);
+        size_t pos;
+        for (pos = 0; pos + sizeof(uint64_t) <= num_bytes;
+             pos += sizeof(uint64_t)) {
+          uint64_t word;
+          memcpy(&word, row + pos, sizeof(word));
+          hash = (hash ^ word)*LSM_CHECKPOINT_HASH_MULTIPLIER;
+          hash ^= hash >> 29;
+        }
+        for (; pos < num_bytes; pos++) {
+          hash = (hash ^ row[pos])*LSM_CHECKPOINT_HASH_MULTIPLIER;
+          hash ^= hash >> 29;
+        }
+      }
+    }
+  }
+
+  return hash;
+}
+
+
+static int lsm_checkpoint_brickInBand(
+  LSM_Checkpoint *checkpoint,
+  const unsigned char *narrow_band,
+  int brick)
+{
+  const int *grid_dims = checkpoint->grid_dims;
+  int lo[3], hi[3];
+  int i, j, k;
+
+  lsm_checkpoint_brickBox(grid_dims, checkpoint->brick_dims,
+                          checkpoint->num_bricks_dir, brick, lo, hi);
+  for (k = lo[2]; k < hi[2]; k++) {
+    for (j = lo[1]; j < hi[1]; j++) {
+      const unsigned char *row =
+        narrow_band + grid_dims[0]*(j + grid_dims[1]*k);
+      for (i = lo[0]; i < hi[0]; i++) {
+        if (row[i] & LSM_NB_LEVEL_BITS) return 1;
+      }
+    }
+  }
+
+  return 0;
+}
+
+
+static void lsm_checkpoint_copyBrick(
+  const int *grid_dims,
+  const int *brick_dims,
+  const int *num_bricks_dir,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  int brick,
+  LSMLIB_REAL *buffer,
+  int to_buffer)
+{
+  int lo[3], hi[3];
+  int f, j, k;
+  size_t row_size;
+
+  lsm_checkpoint_brickBox(grid_dims, brick_dims, num_bricks_dir, brick,
+                          lo, hi);
+  row_size = (hi[0] - lo[0])*sizeof(LSMLIB_REAL);
+  for (f = 0; f < num_fields; f++) {
+    for (k = lo[2]; k < hi[2]; k++) {
+      for (j = lo[1]; j < hi[1]; j++) {
+        LSMLIB_REAL *row = fields[f] + lo[0]
+                         + grid_dims[0]*(j + grid_dims[1]*k);
+        if (to_buffer) {
+          memcpy(buffer, row, row_size);
+        } else {
+          memcpy(row, buffer, row_size);
+        }
+        buffer += hi[0] - lo[0];
+      }
+    }
+  }
+}
+
+
+static int lsm_checkpoint_readFullHeader(
+  FILE *fp,
+  LSM_CheckpointFullHeader *header)
+{
+  if ( (fread(header, sizeof(*header), 1, fp) != 1)
+    || (header->magic != LSM_CHECKPOINT_FULL_MAGIC)
+    || (header->version != LSM_CHECKPOINT_VERSION)
+    || (header->real_size != (int32_t) sizeof(LSMLIB_REAL)) ) {
+    return LSM_CHECKPOINT_ERR_INVALID_FILE;
+  }
+  return LSM_CHECKPOINT_ERR_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/*
+ * File:        lsm_checkpoint.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for incremental checkpointing of level set
+ *              calculations
+ */
+
+#ifndef included_lsm_checkpoint_h
+#define included_lsm_checkpoint_h
+
+#include <stdint.h>
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_checkpoint.h
+ *
+ * \brief
+ * @ref lsm_checkpoint.h provides incremental checkpointing of the
+ * fields of an evolving level set calculation.
+ *
+ * The grid is split into bricks.  A checkpoint only writes the bricks
+ * that have changed since the previous checkpoint (a "delta"); changed
+ * bricks are detected by comparing a hash of each brick with the hash
+ * stored when the brick was last written.  Because the level set
+ * function usually changes only near the interface, a delta is much
+ * smaller than the full data.
+ *
+ * A checkpoint named file_base consists of two files:
+ *
+ * - file_base.full:   all fields at the time of the last full checkpoint
+ * - file_base.delta:  the deltas written since then, in order
+ *
+ * Every full_interval checkpoints (or when most bricks have changed),
+ * the deltas are consolidated into a new full checkpoint and the delta
+ * file is removed.  readLSMCheckpoint() restores the fields by reading
+ * the full checkpoint and replaying the deltas.
+ *
+ * <h3> Usage: </h3>
+ *
+ * -# Create the checkpoint using createLSMCheckpoint().
+ * -# Call writeLSMCheckpoint() whenever the state should be saved.
+ * -# Free the checkpoint using destroyLSMCheckpoint().
+ * -# To restart, restore the fields using readLSMCheckpoint().
+ *
+ * <h3> NOTES: </h3>
+ *  - The first checkpoint written by a LSM_Checkpoint is always full.
+ *
+ *  - The files are not compressed; a delta is already limited to the
+ *    bricks near the interface.
+ *
+ *  - A delta that was only partially written (e.g. because the
+ *    calculation was interrupted) is ignored by readLSMCheckpoint().
+ *
+ */
+
+#include "lsm_grid.h"
+
+
+/*!
+ * Error codes returned by checkpoint functions.
+ */
+#define LSM_CHECKPOINT_ERR_SUCCESS                  (0)
+#define LSM_CHECKPOINT_ERR_INVALID_ARGUMENT         (1)
+#define LSM_CHECKPOINT_ERR_MEMORY_ALLOCATION        (2)
+#define LSM_CHECKPOINT_ERR_FILE_IO                  (3)
+#define LSM_CHECKPOINT_ERR_INVALID_FILE             (4)
+
+/*!
+ * Default brick size (in each direction) and number of checkpoints
+ * between full checkpoints.
+ */
+#define LSM_CHECKPOINT_DEFAULT_BRICK_SIZE           (16)
+#define LSM_CHECKPOINT_DEFAULT_FULL_INTERVAL        (16)
+
+/*!
+ * Structure 'LSM_Checkpoint' holds the state of an incremental
+ * checkpoint.
+ */
+typedef struct _LSM_Checkpoint
+{
+  /* file name base (without the .full and .delta suffixes) */
+  char          *file_base;
+
+  /* index space of the fields (ghostbox of the Grid) */
+  int            num_dims;
+  int            grid_dims[3];
+  int            num_gridpts;
+  int            num_fields;
+
+  /* bricks */
+  int            brick_dims[3];
+  int            num_bricks_dir[3];
+  int            num_bricks;
+
+  /* hash of each brick (over all fields) when it was last written */
+  uint64_t      *brick_hashes;
+
+  /* bricks that contained narrow band points at the last checkpoint */
+  unsigned char *brick_in_band;
+
+  /* number of deltas between full checkpoints */
+  int            full_interval;
+
+  /* number of deltas written since the last full checkpoint */
+  int            num_deltas;
+
+  /* generation of the last full checkpoint (0 if none was written) */
+  uint32_t       generation;
+
+  /* statistics of the last checkpoint */
+  int            last_num_bricks_written;
+  long           last_bytes_written;
+  int            last_was_full;
+} LSM_Checkpoint;
+
+
+/*!
+ * createLSMCheckpoint() creates an incremental checkpoint for fields
+ * defined on the ghostbox of a grid.
+ *
+ * Arguments:
+ *  - file_base (in):      name of the checkpoint (see above)
+ *  - grid (in):           Grid of the fields
+ *  - num_fields (in):     number of fields saved in each checkpoint
+ *  - brick_dims (in):     brick size in each direction (NULL for
+ *                         LSM_CHECKPOINT_DEFAULT_BRICK_SIZE)
+ *  - full_interval (in):  number of deltas between full checkpoints
+ *                         (if <= 0, LSM_CHECKPOINT_DEFAULT_FULL_INTERVAL)
+ *
+ * Return value:           pointer to new LSM_Checkpoint (NULL on error)
+ *
+ */
+LSM_Checkpoint *createLSMCheckpoint(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  const int *brick_dims,
+  int full_interval);
+
+/*!
+ * destroyLSMCheckpoint() frees a checkpoint (the files are kept).
+ */
+void destroyLSMCheckpoint(LSM_Checkpoint *checkpoint);
+
+/*!
+ * writeLSMCheckpoint() saves the fields, writing either a delta or a
+ * full checkpoint.
+ *
+ * Arguments:
+ *  - checkpoint (in/out):  checkpoint
+ *  - fields (in):          array of num_fields pointers to the fields
+ *  - narrow_band (in):     narrow band of the calculation (may be NULL;
+ *                          see NOTES)
+ *
+ * Return value:            error code
+ *
+ * NOTES:
+ *  - If narrow_band is not NULL, only the bricks that contain narrow
+ *    band points (i.e. (narrow_band & LSM_NB_LEVEL_BITS) != 0) now or
+ *    at the previous checkpoint are checked for changes; the fields are
+ *    assumed not to change outside of the narrow band.  Otherwise, all
+ *    bricks are checked.
+ *
+ *  - If writing a delta fails, the next checkpoint is a full
+ *    checkpoint, so that deltas are never appended after a partially
+ *    written record.
+ *
+ */
+int writeLSMCheckpoint(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields,
+  const unsigned char *narrow_band);
+
+/*!
+ * writeLSMCheckpointFull() writes a full checkpoint and removes the
+ * deltas written before it.
+ *
+ * Arguments:
+ *  - checkpoint (in/out):  checkpoint
+ *  - fields (in):          array of num_fields pointers to the fields
+ *
+ * Return value:            error code
+ *
+ */
+int writeLSMCheckpointFull(
+  LSM_Checkpoint *checkpoint,
+  LSMLIB_REAL **fields);
+
+/*!
+ * readLSMCheckpoint() restores fields from a checkpoint.
+ *
+ * Arguments:
+ *  - file_base (in):   name of the checkpoint
+ *  - grid (in):        Grid of the fields
+ *  - num_fields (in):  number of fields
+ *  - fields (out):     array of num_fields pointers to the fields to
+ *                      restore (allocated by the caller)
+ *
+ * Return value:        error code (LSM_CHECKPOINT_ERR_INVALID_FILE if
+ *                      the checkpoint does not match the grid or the
+ *                      number of fields)
+ *
+ */
+int readLSMCheckpoint(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -29,6 +29,42 @@
  *
  */
 Grid *allocateGrid(void);
+
+/*
+ * buildNarrowBandLayerMask() (re)builds the nb_layer_mask tables of
+ * the specified Grid from its index space limits.
+ *
+ * Arguments:
+ *  - grid (in/out):  Grid data structure containing grid configuration
+ *
+ * Return value:  0 on success; -1 if memory for the tables could not
+ *                 be allocated (nb_layer_mask is then set to NULL)
+ *
+ * NOTES:
+ *  - The boxes are assumed to be nested with the fillbox innermost;
+ *    an index is assigned to the innermost box that contains it.
+ *
+ *  - For 2D problems, the third dimension table is set to zero.
+ *
+ */
+int buildNarrowBandLayerMask(Grid *grid);
+
+/*
+ * resetNarrowBandMarks() sets the boundary layer marks of the specified
+ * Grid to LSM_NB_MARK_*.
+ *
+ * Arguments:
+ *  - grid (in/out):  Grid data structure containing grid configuration
+ *
+ * Return value:  none
+ *
+ * NOTES:
+ *  - Grid files written before the marks were encoded as layer bits
+ *    store the old marks (e.g. mark_fb = 117); the marks are therefore
+ *    not taken from the file when a Grid is read.
+ *
+ */
+static void resetNarrowBandMarks(Grid *grid);
  
    
 /*================= Grid structure manipulation ==================*/
@@ -110,6 +146,10 @@ Grid *createGridSetDx(
  
   
   setIndexSpaceLimits(accuracy,g);
+  if (!g->nb_layer_mask[0]) {
+    destroyGrid(g);
+    return NULL;
+  }
   
   return g;
 }
@@ -182,6 +222,10 @@ Grid *createGridSetDxDyDz(
  
   
   setIndexSpaceLimits(accuracy,g);
+  if (!g->nb_layer_mask[0]) {
+    destroyGrid(g);
+    return NULL;
+  }
   
   return g;
 }
@@ -245,6 +289,10 @@ Grid *createGridSetGridDims(
   }
   
   setIndexSpaceLimits(accuracy,g);
+  if (!g->nb_layer_mask[0]) {
+    destroyGrid(g);
+    return NULL;
+  }
   
   return g;
 }
@@ -310,13 +358,21 @@ Grid *copyGrid(Grid *grid)
    new_grid->beta = grid->beta;
    new_grid->gamma = grid->gamma;
    
+   if (buildNarrowBandLayerMask(new_grid)) {
+     destroyGrid(new_grid);
+     return NULL;
+   }
+   
    return new_grid;
 }
 
 
 void destroyGrid(Grid *grid)
 {
-  if (grid) free(grid);
+  if (grid) {
+    free(grid->nb_layer_mask[0]);
+    free(grid);
+  }
 }
     
 
@@ -447,6 +503,7 @@ Grid *readGridFromAsciiFile(char *file_name)
   float x_lo_float[3], x_hi_float[3];
   float x_lo_ghostbox_float[3], x_hi_ghostbox_float[3];
   float dx_float[3], beta_float, gamma_float;
+  unsigned int marks[5];
   char   *line[80];
   char   *file_base;
   int    zip_status;
@@ -525,12 +582,12 @@ Grid *readGridFromAsciiFile(char *file_name)
   if (grid->num_dims == 2) 
   {
     fscanf(fp,
-            "Ghost box: [%d,%d] x [%d,%d]\n",
+            "Ghost box index limits: [%d,%d] x [%d,%d]\n",
             &(grid->ilo_gb), &(grid->ihi_gb),
             &(grid->jlo_gb), &(grid->jhi_gb));
 	    
     fscanf(fp,
-            "Fill box: [%d,%d] x [%d,%d]\n",
+            "Fill box index limits: [%d,%d] x [%d,%d]\n",
             &(grid->ilo_fb), &(grid->ihi_fb),
             &(grid->jlo_fb), &(grid->jhi_fb));
 	    
@@ -550,12 +607,12 @@ Grid *readGridFromAsciiFile(char *file_name)
   else
   {
     fscanf(fp,
-            "Ghost box: [%d,%d] x [%d,%d] x [%d,%d]\n",
+            "Ghost box index limits: [%d,%d] x [%d,%d] x [%d,%d]\n",
             &(grid->ilo_gb), &(grid->ihi_gb),
             &(grid->jlo_gb), &(grid->jhi_gb),
 	    &(grid->klo_gb), &(grid->khi_gb));
     fscanf(fp,
-            "Fill box: [%d,%d] x [%d,%d] x [%d,%d]\n",
+            "Fill box index limits: [%d,%d] x [%d,%d] x [%d,%d]\n",
             &(grid->ilo_fb), &(grid->ihi_fb),
             &(grid->jlo_fb), &(grid->jhi_fb),
 	    &(grid->klo_fb), &(grid->khi_fb));
@@ -582,11 +639,10 @@ Grid *readGridFromAsciiFile(char *file_name)
   fscanf(fp,
           "Number of narrow band levels (local method) %d\n",
 	  &(grid->num_nb_levels));
+  /* the marks are reset to LSM_NB_MARK_* below */
   fscanf(fp,
-          "Boundary layer marks (local method) gb %c D1 %c D2 %c D3 %c fb %c\n",
-	  &(grid->mark_gb),
-	  &(grid->mark_D1),&(grid->mark_D2),
-	  &(grid->mark_D3),&(grid->mark_fb)); 
+          "Boundary layer marks (local method) gb %u D1 %u D2 %u D3 %u fb %u\n",
+	  &(marks[0]),&(marks[1]),&(marks[2]),&(marks[3]),&(marks[4]));
   fscanf(fp,
           "Narrow band width (local method) beta(inner) %g gamma(outer) %g\n",
 	  &beta_float, &gamma_float);
@@ -595,6 +651,12 @@ Grid *readGridFromAsciiFile(char *file_name)
   fclose(fp);
   zipFile(file_base,zip_status);
   free(file_base); 
+
+  resetNarrowBandMarks(grid);
+  if (buildNarrowBandLayerMask(grid)) {
+    destroyGrid(grid);
+    return NULL;
+  }
  
   return grid;
 }
@@ -754,6 +816,12 @@ Grid *readGridFromBinaryFile(char *file_name)
     fclose(fp);
     zipFile(file_base,zip_status);
     free(file_base);
+
+    resetNarrowBandMarks(grid);
+    if (buildNarrowBandLayerMask(grid)) {
+      destroyGrid(grid);
+      grid = NULL;
+    }
   }
   else
   {
@@ -987,13 +1055,9 @@ void setIndexSpaceLimitsWENO5(Grid *grid)
 void setIndexSpaceLimits(LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy, 
    Grid *grid)
 {  
-   grid->mark_gb = 120;
-   grid->mark_D1 = grid->mark_gb - 1;
-   grid->mark_D2 = grid->mark_gb - 2;
-   grid->mark_D3 = grid->mark_gb - 3;
+   resetNarrowBandMarks(grid);
 
    grid->num_nb_levels = lsmlib_num_ghostcells[accuracy];
-   grid->mark_fb = grid->mark_gb - grid->num_nb_levels;
    
    if( accuracy > MEDIUM)
    {
@@ -1032,5 +1096,75 @@ void setIndexSpaceLimits(LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy,
        setIndexSpaceLimitsENO2(grid);
      }
   }
+  
+  buildNarrowBandLayerMask(grid);
+}
+
+
+static void resetNarrowBandMarks(Grid *grid)
+{
+  grid->mark_gb = LSM_NB_MARK_GB;
+  grid->mark_D1 = LSM_NB_MARK_D1;
+  grid->mark_D2 = LSM_NB_MARK_D2;
+  grid->mark_D3 = LSM_NB_MARK_D3;
+  grid->mark_fb = LSM_NB_MARK_FB;
+}
+
+
+int buildNarrowBandLayerMask(Grid *grid)
+{
+  int lo[3][4], hi[3][4];
+  int dir, i, n;
+  unsigned char layer;
+
+  free(grid->nb_layer_mask[0]);
+  grid->nb_layer_mask[0] = (unsigned char *) malloc(
+    grid->grid_dims_ghostbox[0] + grid->grid_dims_ghostbox[1]
+    + grid->grid_dims_ghostbox[2]);
+  if (!grid->nb_layer_mask[0]) {
+    grid->nb_layer_mask[1] = NULL;
+    grid->nb_layer_mask[2] = NULL;
+    return -1;
+  }
+  grid->nb_layer_mask[1] = grid->nb_layer_mask[0]
+                         + grid->grid_dims_ghostbox[0];
+  grid->nb_layer_mask[2] = grid->nb_layer_mask[1]
+                         + grid->grid_dims_ghostbox[1];
+
+  /* fillbox, D3, D2 and D1 limits in each direction */
+  lo[0][0] = grid->ilo_fb;    hi[0][0] = grid->ihi_fb;
+  lo[1][0] = grid->jlo_fb;    hi[1][0] = grid->jhi_fb;
+  lo[2][0] = grid->klo_fb;    hi[2][0] = grid->khi_fb;
+  lo[0][1] = grid->ilo_D3_fb; hi[0][1] = grid->ihi_D3_fb;
+  lo[1][1] = grid->jlo_D3_fb; hi[1][1] = grid->jhi_D3_fb;
+  lo[2][1] = grid->klo_D3_fb; hi[2][1] = grid->khi_D3_fb;
+  lo[0][2] = grid->ilo_D2_fb; hi[0][2] = grid->ihi_D2_fb;
+  lo[1][2] = grid->jlo_D2_fb; hi[1][2] = grid->jhi_D2_fb;
+  lo[2][2] = grid->klo_D2_fb; hi[2][2] = grid->khi_D2_fb;
+  lo[0][3] = grid->ilo_D1_fb; hi[0][3] = grid->ihi_D1_fb;
+  lo[1][3] = grid->jlo_D1_fb; hi[1][3] = grid->jhi_D1_fb;
+  lo[2][3] = grid->klo_D1_fb; hi[2][3] = grid->khi_D1_fb;
+
+  for (dir = 0; dir < 3; dir++) {
+    n = grid->grid_dims_ghostbox[dir];
+    for (i = 0; i < n; i++) {
+      if ( (dir == 2) && (grid->num_dims == 2) ) {
+        layer = LSM_NB_LAYER_FB;
+      } else if ( (i >= lo[dir][0]) && (i <= hi[dir][0]) ) {
+        layer = LSM_NB_LAYER_FB;
+      } else if ( (i >= lo[dir][1]) && (i <= hi[dir][1]) ) {
+        layer = LSM_NB_LAYER_D3;
+      } else if ( (i >= lo[dir][2]) && (i <= hi[dir][2]) ) {
+        layer = LSM_NB_LAYER_D2;
+      } else if ( (i >= lo[dir][3]) && (i <= hi[dir][3]) ) {
+        layer = LSM_NB_LAYER_D1;
+      } else {
+        layer = LSM_NB_LAYER_GB;
+      }
+      grid->nb_layer_mask[dir][i] = layer;
+    }
+  }
+
+  return 0;
 }
 
@@ -87,6 +87,11 @@ typedef struct _Grid {
   
   /* marks used for boundary layers in local method */
   unsigned char mark_gb, mark_D1, mark_D2, mark_D3, mark_fb;
+
+  /* boundary layer bits of narrow band values in each coordinate  */
+  /* direction (local method); nb_layer_mask[0][i] | nb_layer_mask */
+  /* [1][j] | nb_layer_mask[2][k] is the boundary layer of (i,j,k) */
+  unsigned char *nb_layer_mask[3];
   
   /* inner and outer narrow band widths (local method) */
   LSMLIB_REAL beta, gamma;
@@ -107,6 +112,42 @@ typedef enum { LOW = 0, MEDIUM = 1, HIGH = 2, VERY_HIGH = 3 }
   LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE;
 
 
+/*!
+ * Narrow band value encoding used by the local method.
+ *
+ * A narrow band value is split into two bit fields:
+ *
+ * - bits 0-2 hold L+1 for a level L narrow band voxel (0 for voxels
+ *   that are not in the narrow band);
+ * - bits 3-6 hold the boundary layer of the voxel, i.e. the innermost of
+ *   the fillbox, D3, D2, D1 and ghost boxes of the Grid containing it.
+ *
+ * Boundary layers are stored as a thermometer code (each layer sets the
+ * bits of all layers inside it), so that the boundary layer of a voxel
+ * is the bitwise OR of the boundary layers of its indices in each
+ * coordinate direction (see the nb_layer_mask field of Grid).
+ *
+ * The marks stored in Grid (mark_fb, mark_D3, ...) are LSM_NB_MARK_*.
+ * For each of them 'narrow_band <= mark' is the same test as
+ * '(narrow_band & ~mark) == 0', so the local kernels check the level
+ * and boundary layer of a voxel with a single comparison.
+ */
+#define LSM_NB_LEVEL_BITS               (0x07)
+#define LSM_NB_MAX_LEVEL                (6)
+
+#define LSM_NB_LAYER_FB                 (0x00)
+#define LSM_NB_LAYER_D3                 (0x08)
+#define LSM_NB_LAYER_D2                 (0x18)
+#define LSM_NB_LAYER_D1                 (0x38)
+#define LSM_NB_LAYER_GB                 (0x78)
+
+#define LSM_NB_MARK_FB                  (LSM_NB_LAYER_FB | LSM_NB_LEVEL_BITS)
+#define LSM_NB_MARK_D3                  (LSM_NB_LAYER_D3 | LSM_NB_LEVEL_BITS)
+#define LSM_NB_MARK_D2                  (LSM_NB_LAYER_D2 | LSM_NB_LEVEL_BITS)
+#define LSM_NB_MARK_D1                  (LSM_NB_LAYER_D1 | LSM_NB_LEVEL_BITS)
+#define LSM_NB_MARK_GB                  (LSM_NB_LAYER_GB | LSM_NB_LEVEL_BITS)
+
+
 /*! @{ 
  ****************************************************************
  *
@@ -282,6 +323,10 @@ void writeGridToAsciiFile(Grid *grid, char *file_name, int zip_status);
  *
  * NOTES:
  * - The specified file must have been generated by writeGridToAsciiFile().
+ *
+ * - The boundary layer marks are set to LSM_NB_MARK_* rather than read
+ *   from the file, so files written by older versions of LSMLIB (which
+ *   stored different marks) are still valid.
  *  
  * - To avoid memory leaks, the grid returned by readGridFromAsciiFile() 
  *   should be destroyed using destroyGrid() when it is no longer needed.
@@ -325,6 +370,10 @@ void writeGridToBinaryFile(Grid *grid, char *file_name, int zip_status);
  *
  * NOTES:
  * - The specified file must have been generated by writeGridToBinaryFile().
+ *
+ * - The boundary layer marks are set to LSM_NB_MARK_* rather than read
+ *   from the file, so files written by older versions of LSMLIB (which
+ *   stored different marks) are still valid.
  *  
  * - To avoid memory leaks, the grid returned by readGridFromBinaryFile() 
  *   should be destroyed using destroyGrid() when it is no longer needed.
@@ -347,6 +396,11 @@ Grid *readGridFromBinaryFile(char *file_name);
  * 
  * NOTES:
  * - Grid elements other than index space limits assumed pre-set
+ *
+ * - setIndexSpaceLimits() also sets the boundary layer marks to
+ *   LSM_NB_MARK_* and (re)builds the nb_layer_mask tables of grid.
+ *   If memory for the tables cannot be allocated, nb_layer_mask is
+ *   set to NULL.
 */
 void setIndexSpaceLimits(LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracy, 
    Grid *grid);
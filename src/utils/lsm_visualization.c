@@ -0,0 +1,704 @@
+/*
+ * File:        lsm_visualization.c
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Implementation of visualization output (VTK and XDMF)
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lsmlib_config.h"
+#include "lsm_visualization.h"
+#include "lsm_runtime.h"
+
+#ifdef LSMLIB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+/*================== Visualization Data Structures ==================*/
+
+/*
+ * Structure 'LSM_VisArray' describes a data array of a VTK file and
+ * its encoding in the appended data section.
+ */
+typedef struct _LSM_VisArray
+{
+  const char  *name;
+  const char  *type;             /* VTK type name (e.g. "Float64") */
+  int          num_components;
+  const void  *data;
+  size_t       num_bytes;
+
+  /* compressed blocks (first_block, ..., first_block+num_blocks-1) */
+  int          first_block;
+  int          num_blocks;
+
+  /* size of the encoded array (header and data) */
+  size_t       encoded_size;
+} LSM_VisArray;
+
+/*
+ * Structure 'LSM_VisBlock' holds a block of an array and its compressed
+ * data.
+ */
+typedef struct _LSM_VisBlock
+{
+  const unsigned char *src;
+  size_t               src_size;
+  unsigned char       *dst;
+  size_t               dst_size;
+  int                  err;
+} LSM_VisBlock;
+
+
+/*==================== Helper Function Declarations =================*/
+
+/*
+ * lsm_vis_realType() returns the VTK type name of LSMLIB_REAL.
+ */
+static const char *lsm_vis_realType(void);
+
+/*
+ * lsm_vis_byteOrder() returns the byte order of the machine
+ * ("LittleEndian" or "BigEndian").
+ */
+static const char *lsm_vis_byteOrder(void);
+
+/*
+ * lsm_vis_encodeArrays() computes the encoded size of the arrays and,
+ * for zlib compression, compresses their blocks in parallel.
+ */
+static int lsm_vis_encodeArrays(
+  LSM_VisArray *arrays,
+  int num_arrays,
+  LSM_VisCompression compression,
+  LSM_VisBlock **blocks);
+
+/*
+ * lsm_vis_compressBlocks() is the parallel loop body that compresses
+ * blocks [begin, end).
+ */
+static void lsm_vis_compressBlocks(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data);
+
+/*
+ * lsm_vis_freeBlocks() frees the compressed blocks.
+ */
+static void lsm_vis_freeBlocks(LSM_VisBlock *blocks, int num_blocks);
+
+/*
+ * lsm_vis_writeHeader() writes the opening VTKFile tag.
+ */
+static void lsm_vis_writeHeader(
+  FILE *fp,
+  const char *type,
+  LSM_VisCompression compression);
+
+/*
+ * lsm_vis_writeDataArrayTag() writes the DataArray tag of an array and
+ * advances the offset into the appended data section.
+ */
+static void lsm_vis_writeDataArrayTag(
+  FILE *fp,
+  const LSM_VisArray *array,
+  size_t *offset,
+  const char *indent);
+
+/*
+ * lsm_vis_writeAppendedData() writes the appended data section and
+ * closes the VTKFile tag.
+ */
+static int lsm_vis_writeAppendedData(
+  FILE *fp,
+  const LSM_VisArray *arrays,
+  int num_arrays,
+  LSM_VisCompression compression,
+  const LSM_VisBlock *blocks);
+
+/*
+ * lsm_vis_checkFields() checks the field arguments.
+ */
+static int lsm_vis_checkFields(
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names);
+
+
+/*===================== Visualization Functions =====================*/
+
+int writeVTKImageData(
+  const char *file_name,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names,
+  LSM_VisCompression compression)
+{
+  LSM_VisArray *arrays;
+  LSM_VisBlock *blocks = NULL;
+  FILE *fp;
+  size_t offset = 0;
+  int dims[3], f, l;
+  int err;
+
+  if (!file_name) return LSM_VIS_ERR_INVALID_ARGUMENT;
+  err = lsm_vis_checkFields(grid, num_fields, fields, field_names);
+  if (err != LSM_VIS_ERR_SUCCESS) return err;
+
+  arrays = (LSM_VisArray*) calloc(num_fields, sizeof(LSM_VisArray));
+  if (!arrays) return LSM_VIS_ERR_MEMORY_ALLOCATION;
+  for (f = 0; f < num_fields; f++) {
+    arrays[f].name = field_names[f];
+    arrays[f].type = lsm_vis_realType();
+    arrays[f].num_components = 1;
+    arrays[f].data = fields[f];
+    arrays[f].num_bytes = (size_t) grid->num_gridpts*sizeof(LSMLIB_REAL);
+  }
+  err = lsm_vis_encodeArrays(arrays, num_fields, compression, &blocks);
+  if (err != LSM_VIS_ERR_SUCCESS) {
+    free(arrays);
+    return err;
+  }
+
+  fp = fopen(file_name, "wb");
+  if (!fp) {
+    err = LSM_VIS_ERR_FILE_IO;
+    goto cleanup;
+  }
+
+  for (l = 0; l < 3; l++) {
+    dims[l] = (l < grid->num_dims) ? grid->grid_dims_ghostbox[l] : 1;
+  }
+  lsm_vis_writeHeader(fp, "ImageData", compression);
+  fprintf(fp, "  <ImageData WholeExtent=\"0 %d 0 %d 0 %d\" "
+              "Origin=\"%.17g %.17g %.17g\" Spacing=\"%.17g %.17g %.17g\">\n",
+          dims[0] - 1, dims[1] - 1, dims[2] - 1,
+          (double) grid->x_lo_ghostbox[0], (double) grid->x_lo_ghostbox[1],
+          (grid->num_dims == 3) ? (double) grid->x_lo_ghostbox[2] : 0.0,
+          (double) grid->dx[0], (double) grid->dx[1],
+          (grid->num_dims == 3) ? (double) grid->dx[2] : 1.0);
+  fprintf(fp, "    <Piece Extent=\"0 %d 0 %d 0 %d\">\n",
+          dims[0] - 1, dims[1] - 1, dims[2] - 1);
+  fprintf(fp, "      <PointData Scalars=\"%s\">\n", field_names[0]);
+  for (f = 0; f < num_fields; f++) {
+    lsm_vis_writeDataArrayTag(fp, &arrays[f], &offset, "        ");
+  }
+  fprintf(fp, "      </PointData>\n");
+  fprintf(fp, "    </Piece>\n");
+  fprintf(fp, "  </ImageData>\n");
+  err = lsm_vis_writeAppendedData(fp, arrays, num_fields, compression,
+                                  blocks);
+  if (fclose(fp) != 0) err = LSM_VIS_ERR_FILE_IO;
+
+cleanup:
+  if (blocks) {
+    lsm_vis_freeBlocks(blocks, arrays[num_fields - 1].first_block
+                               + arrays[num_fields - 1].num_blocks);
+  }
+  free(arrays);
+  return err;
+}
+
+
+int writeXDMF(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names)
+{
+  char *xmf_file, *raw_file;
+  const char *raw_name;
+  const char *endian = strcmp(lsm_vis_byteOrder(), "LittleEndian") ? "Big"
+                                                                 : "Little";
+  char dims_str[64];
+  FILE *fp;
+  size_t len;
+  int num_dims, f;
+  int err = LSM_VIS_ERR_SUCCESS;
+
+  if (!file_base) return LSM_VIS_ERR_INVALID_ARGUMENT;
+  err = lsm_vis_checkFields(grid, num_fields, fields, field_names);
+  if (err != LSM_VIS_ERR_SUCCESS) return err;
+  num_dims = grid->num_dims;
+
+  len = strlen(file_base);
+  xmf_file = (char*) malloc(len + 5);
+  raw_file = (char*) malloc(len + 5);
+  if ( (!xmf_file) || (!raw_file) ) {
+    free(xmf_file);
+    free(raw_file);
+    return LSM_VIS_ERR_MEMORY_ALLOCATION;
+  }
+  sprintf(xmf_file, "%s.xmf", file_base);
+  sprintf(raw_file, "%s.raw", file_base);
+
+  /* raw data */
+  fp = fopen(raw_file, "wb");
+  if (!fp) {
+    err = LSM_VIS_ERR_FILE_IO;
+    goto cleanup;
+  }
+  for (f = 0; f < num_fields; f++) {
+    if (fwrite(fields[f], sizeof(LSMLIB_REAL), grid->num_gridpts, fp)
+        != (size_t) grid->num_gridpts) {
+      err = LSM_VIS_ERR_FILE_IO;
+      break;
+    }
+  }
+  if (fclose(fp) != 0) err = LSM_VIS_ERR_FILE_IO;
+  if (err != LSM_VIS_ERR_SUCCESS) goto cleanup;
+
+  /* XDMF description (the raw file is referred to relative to the */
+  /* directory of the XDMF file)                                   */
+  fp = fopen(xmf_file, "w");
+  if (!fp) {
+    err = LSM_VIS_ERR_FILE_IO;
+    goto cleanup;
+  }
+  raw_name = strrchr(raw_file, '/');
+  raw_name = raw_name ? raw_name + 1 : raw_file;
+  if (num_dims == 3) {
+    sprintf(dims_str, "%d %d %d", grid->grid_dims_ghostbox[2],
+            grid->grid_dims_ghostbox[1], grid->grid_dims_ghostbox[0]);
+  } else {
+    sprintf(dims_str, "%d %d", grid->grid_dims_ghostbox[1],
+            grid->grid_dims_ghostbox[0]);
+  }
+
+  fprintf(fp, "<?xml version=\"1.0\" ?>\n");
+  fprintf(fp, "<!DOCTYPE Xdmf SYSTEM \"Xdmf.dtd\" []>\n");
+  fprintf(fp, "<Xdmf Version=\"2.0\">\n");
+  fprintf(fp, "  <Domain>\n");
+  fprintf(fp, "    <Grid Name=\"LSMLIB\" GridType=\"Uniform\">\n");
+  fprintf(fp, "      <Topology TopologyType=\"%dDCoRectMesh\" "
+              "Dimensions=\"%s\"/>\n", num_dims, dims_str);
+  fprintf(fp, "      <Geometry GeometryType=\"%s\">\n",
+          (num_dims == 3) ? "ORIGIN_DXDYDZ" : "ORIGIN_DXDY");
+  if (num_dims == 3) {
+    fprintf(fp, "        <DataItem Dimensions=\"3\" NumberType=\"Float\" "
+                "Precision=\"8\" Format=\"XML\">%.17g %.17g %.17g"
+                "</DataItem>\n",
+            (double) grid->x_lo_ghostbox[2], (double) grid->x_lo_ghostbox[1],
+            (double) grid->x_lo_ghostbox[0]);
+    fprintf(fp, "        <DataItem Dimensions=\"3\" NumberType=\"Float\" "
+                "Precision=\"8\" Format=\"XML\">%.17g %.17g %.17g"
+                "</DataItem>\n",
+            (double) grid->dx[2], (double) grid->dx[1], (double) grid->dx[0]);
+  } else {
+    fprintf(fp, "        <DataItem Dimensions=\"2\" NumberType=\"Float\" "
+                "Precision=\"8\" Format=\"XML\">%.17g %.17g</DataItem>\n",
+            (double) grid->x_lo_ghostbox[1], (double) grid->x_lo_ghostbox[0]);
+    fprintf(fp, "        <DataItem Dimensions=\"2\" NumberType=\"Float\" "
+                "Precision=\"8\" Format=\"XML\">%.17g %.17g</DataItem>\n",
+            (double) grid->dx[1], (double) grid->dx[0]);
+  }
+  fprintf(fp, "      </Geometry>\n");
+  for (f = 0; f < num_fields; f++) {
+    fprintf(fp, "      <Attribute Name=\"%s\" AttributeType=\"Scalar\" "
+                "Center=\"Node\">\n", field_names[f]);
+    fprintf(fp, "        <DataItem Dimensions=\"%s\" NumberType=\"Float\" "
+                "Precision=\"%d\" Format=\"Binary\" Endian=\"%s\" "
+                "Seek=\"%lu\">%s</DataItem>\n",
+            dims_str, (int) sizeof(LSMLIB_REAL), endian,
+            (unsigned long) f*grid->num_gridpts*sizeof(LSMLIB_REAL),
+            raw_name);
+    fprintf(fp, "      </Attribute>\n");
+  }
+  fprintf(fp, "    </Grid>\n");
+  fprintf(fp, "  </Domain>\n");
+  fprintf(fp, "</Xdmf>\n");
+  if (fclose(fp) != 0) err = LSM_VIS_ERR_FILE_IO;
+
+cleanup:
+  free(xmf_file);
+  free(raw_file);
+  return err;
+}
+
+
+int writeNarrowBandVTU(
+  const char *file_name,
+  Grid *grid,
+  int num_pts,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names,
+  LSM_VisCompression compression)
+{
+  LSM_VisArray *arrays = NULL;
+  LSM_VisBlock *blocks = NULL;
+  LSMLIB_REAL *values = NULL, *points = NULL;
+  int64_t *connectivity = NULL, *offsets = NULL;
+  unsigned char *types = NULL;
+  int num_arrays = num_fields + 4;
+  const int *dims;
+  FILE *fp;
+  size_t offset = 0;
+  int f, n;
+  int err;
+
+  if ( (!file_name) || (num_pts < 0) || (!index_x) || (!index_y) ) {
+    return LSM_VIS_ERR_INVALID_ARGUMENT;
+  }
+  err = lsm_vis_checkFields(grid, num_fields, fields, field_names);
+  if (err != LSM_VIS_ERR_SUCCESS) return err;
+  if ( (grid->num_dims == 3) && (!index_z) ) {
+    return LSM_VIS_ERR_INVALID_ARGUMENT;
+  }
+  dims = grid->grid_dims_ghostbox;
+  for (n = 0; n < num_pts; n++) {
+    if ( (index_x[n] < 0) || (index_x[n] >= dims[0])
+      || (index_y[n] < 0) || (index_y[n] >= dims[1])
+      || ( (grid->num_dims == 3)
+        && ((index_z[n] < 0) || (index_z[n] >= dims[2])) ) ) {
+      return LSM_VIS_ERR_INVALID_ARGUMENT;
+    }
+  }
+
+  /* gather the field values and build the points and vertex cells */
+  arrays = (LSM_VisArray*) calloc(num_arrays, sizeof(LSM_VisArray));
+  values = (LSMLIB_REAL*) malloc(((size_t) num_fields*num_pts + 1)
+                                 *sizeof(LSMLIB_REAL));
+  points = (LSMLIB_REAL*) malloc((3*(size_t) num_pts + 1)
+                                 *sizeof(LSMLIB_REAL));
+  connectivity = (int64_t*) malloc((num_pts + 1)*sizeof(int64_t));
+  offsets = (int64_t*) malloc((num_pts + 1)*sizeof(int64_t));
+  types = (unsigned char*) malloc(num_pts + 1);
+  if ( (!arrays) || (!values) || (!points) || (!connectivity)
+    || (!offsets) || (!types) ) {
+    err = LSM_VIS_ERR_MEMORY_ALLOCATION;
+    goto cleanup;
+  }
+  for (n = 0; n < num_pts; n++) {
+    int k = (grid->num_dims == 3) ? index_z[n] : 0;
+    int idx = index_x[n] + dims[0]*(index_y[n] + dims[1]*k);
+    for (f = 0; f < num_fields; f++) {
+      values[(size_t) f*num_pts + n] = fields[f][idx];
+    }
+    points[3*n]   = grid->x_lo_ghostbox[0] + grid->dx[0]*index_x[n];
+    points[3*n+1] = grid->x_lo_ghostbox[1] + grid->dx[1]*index_y[n];
+    points[3*n+2] = (grid->num_dims == 3)
+                  ? grid->x_lo_ghostbox[2] + grid->dx[2]*k : 0;
+    connectivity[n] = n;
+    offsets[n] = n + 1;
+    types[n] = 1;  /* VTK_VERTEX */
+  }
+
+  for (f = 0; f < num_fields; f++) {
+    arrays[f].name = field_names[f];
+    arrays[f].type = lsm_vis_realType();
+    arrays[f].num_components = 1;
+    arrays[f].data = values + (size_t) f*num_pts;
+    arrays[f].num_bytes = num_pts*sizeof(LSMLIB_REAL);
+  }
+  arrays[num_fields].name = "Points";
+  arrays[num_fields].type = lsm_vis_realType();
+  arrays[num_fields].num_components = 3;
+  arrays[num_fields].data = points;
+  arrays[num_fields].num_bytes = 3*(size_t) num_pts*sizeof(LSMLIB_REAL);
+  arrays[num_fields+1].name = "connectivity";
+  arrays[num_fields+1].type = "Int64";
+  arrays[num_fields+1].num_components = 1;
+  arrays[num_fields+1].data = connectivity;
+  arrays[num_fields+1].num_bytes = num_pts*sizeof(int64_t);
+  arrays[num_fields+2].name = "offsets";
+  arrays[num_fields+2].type = "Int64";
+  arrays[num_fields+2].num_components = 1;
+  arrays[num_fields+2].data = offsets;
+  arrays[num_fields+2].num_bytes = num_pts*sizeof(int64_t);
+  arrays[num_fields+3].name = "types";
+  arrays[num_fields+3].type = "UInt8";
+  arrays[num_fields+3].num_components = 1;
+  arrays[num_fields+3].data = types;
+  arrays[num_fields+3].num_bytes = num_pts;
+
+  err = lsm_vis_encodeArrays(arrays, num_arrays, compression, &blocks);
+  if (err != LSM_VIS_ERR_SUCCESS) goto cleanup;
+
+  fp = fopen(file_name, "wb");
+  if (!fp) {
+    err = LSM_VIS_ERR_FILE_IO;
+    goto cleanup;
+  }
+  lsm_vis_writeHeader(fp, "UnstructuredGrid", compression);
+  fprintf(fp, "  <UnstructuredGrid>\n");
+  fprintf(fp, "    <Piece NumberOfPoints=\"%d\" NumberOfCells=\"%d\">\n",
+          num_pts, num_pts);
+  fprintf(fp, "      <PointData Scalars=\"%s\">\n", field_names[0]);
+  for (f = 0; f < num_fields; f++) {
+    lsm_vis_writeDataArrayTag(fp, &arrays[f], &offset, "        ");
+  }
+  fprintf(fp, "      </PointData>\n");
+  fprintf(fp, "      <Points>\n");
+  lsm_vis_writeDataArrayTag(fp, &arrays[num_fields], &offset, "        ");
+  fprintf(fp, "      </Points>\n");
+  fprintf(fp, "      <Cells>\n");
+  for (f = num_fields + 1; f < num_arrays; f++) {
+    lsm_vis_writeDataArrayTag(fp, &arrays[f], &offset, "        ");
+  }
+  fprintf(fp, "      </Cells>\n");
+  fprintf(fp, "    </Piece>\n");
+  fprintf(fp, "  </UnstructuredGrid>\n");
+  err = lsm_vis_writeAppendedData(fp, arrays, num_arrays, compression,
+                                  blocks);
+  if (fclose(fp) != 0) err = LSM_VIS_ERR_FILE_IO;
+
+cleanup:
+  if (blocks) {
+    lsm_vis_freeBlocks(blocks, arrays[num_arrays - 1].first_block
+                               + arrays[num_arrays - 1].num_blocks);
+  }
+  free(arrays);
+  free(values);
+  free(points);
+  free(connectivity);
+  free(offsets);
+  free(types);
+  return err;
+}
+
+
+/*==================== Helper Function Definitions ==================*/
+
+static const char *lsm_vis_realType(void)
+{
+  return (sizeof(LSMLIB_REAL) == 8) ? "Float64" : "Float32";
+}
+
+
+static const char *lsm_vis_byteOrder(void)
+{
+  const uint16_t one = 1;
+  return (*(const unsigned char*) &one) ? "LittleEndian" : "BigEndian";
+}
+
+
+static int lsm_vis_encodeArrays(
+  LSM_VisArray *arrays,
+  int num_arrays,
+  LSM_VisCompression compression,
+  LSM_VisBlock **blocks)
+{
+  int a;
+#ifdef LSMLIB_HAVE_ZLIB
+  int num_blocks = 0, b;
+#endif
+
+  *blocks = NULL;
+  if (compression == LSM_VIS_RAW) {
+    for (a = 0; a < num_arrays; a++) {
+      arrays[a].encoded_size = sizeof(uint64_t) + arrays[a].num_bytes;
+    }
+    return LSM_VIS_ERR_SUCCESS;
+  }
+  if (compression != LSM_VIS_ZLIB) return LSM_VIS_ERR_INVALID_ARGUMENT;
+#ifndef LSMLIB_HAVE_ZLIB
+  return LSM_VIS_ERR_COMPRESSION_NOT_SUPPORTED;
+#else
+
+  /* split all arrays into blocks */
+  for (a = 0; a < num_arrays; a++) {
+    arrays[a].first_block = num_blocks;
+    arrays[a].num_blocks = (int) ((arrays[a].num_bytes
+                                   + LSM_VIS_BLOCK_SIZE - 1)
+                                  / LSM_VIS_BLOCK_SIZE);
+    num_blocks += arrays[a].num_blocks;
+  }
+  *blocks = (LSM_VisBlock*) calloc(num_blocks + 1, sizeof(LSM_VisBlock));
+  if (!*blocks) return LSM_VIS_ERR_MEMORY_ALLOCATION;
+  for (a = 0; a < num_arrays; a++) {
+    for (b = 0; b < arrays[a].num_blocks; b++) {
+      LSM_VisBlock *block = &(*blocks)[arrays[a].first_block + b];
+      size_t start = (size_t) b*LSM_VIS_BLOCK_SIZE;
+      block->src = (const unsigned char*) arrays[a].data + start;
+      block->src_size = arrays[a].num_bytes - start;
+      if (block->src_size > LSM_VIS_BLOCK_SIZE) {
+        block->src_size = LSM_VIS_BLOCK_SIZE;
+      }
+    }
+  }
+
+  /* compress blocks concurrently */
+  LSM_Runtime_parallelFor(0, num_blocks, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                          lsm_vis_compressBlocks, *blocks);
+
+  for (a = 0; a < num_arrays; a++) {
+    arrays[a].encoded_size = (3 + arrays[a].num_blocks)*sizeof(uint64_t);
+    for (b = 0; b < arrays[a].num_blocks; b++) {
+      LSM_VisBlock *block = &(*blocks)[arrays[a].first_block + b];
+      if (block->err != LSM_VIS_ERR_SUCCESS) {
+        int err = block->err;
+        lsm_vis_freeBlocks(*blocks, num_blocks);
+        *blocks = NULL;
+        return err;
+      }
+      arrays[a].encoded_size += block->dst_size;
+    }
+  }
+
+  return LSM_VIS_ERR_SUCCESS;
+#endif
+}
+
+
+static void lsm_vis_compressBlocks(
+  int begin,
+  int end,
+  int thread_num,
+  void *user_data)
+{
+#ifdef LSMLIB_HAVE_ZLIB
+  LSM_VisBlock *blocks = (LSM_VisBlock*) user_data;
+  int b;
+
+  (void) thread_num;
+  for (b = begin; b < end; b++) {
+    LSM_VisBlock *block = &blocks[b];
+    uLongf dst_size = compressBound((uLong) block->src_size);
+    block->dst = (unsigned char*) malloc(dst_size);
+    if (!block->dst) {
+      block->err = LSM_VIS_ERR_MEMORY_ALLOCATION;
+      continue;
+    }
+    if (compress2(block->dst, &dst_size, block->src, (uLong) block->src_size,
+                  Z_DEFAULT_COMPRESSION) != Z_OK) {
+      block->err = LSM_VIS_ERR_COMPRESSION;
+      continue;
+    }
+    block->dst_size = dst_size;
+  }
+#else
+  (void) begin;
+  (void) end;
+  (void) thread_num;
+  (void) user_data;
+#endif
+}
+
+
+static void lsm_vis_freeBlocks(LSM_VisBlock *blocks, int num_blocks)
+{
+  int b;
+  for (b = 0; b < num_blocks; b++) free(blocks[b].dst);
+  free(blocks);
+}
+
+
+static void lsm_vis_writeHeader(
+  FILE *fp,
+  const char *type,
+  LSM_VisCompression compression)
+{
+  fprintf(fp, "<?xml version=\"1.0\"?>\n");
+  fprintf(fp, "<VTKFile type=\"%s\" version=\"1.0\" byte_order=\"%s\" "
+              "header_type=\"UInt64\"%s>\n",
+          type, lsm_vis_byteOrder(),
+          (compression == LSM_VIS_ZLIB)
+            ? " compressor=\"vtkZLibDataCompressor\"" : "");
+}
+
+
+static void lsm_vis_writeDataArrayTag(
+  FILE *fp,
+  const LSM_VisArray *array,
+  size_t *offset,
+  const char *indent)
+{
+  fprintf(fp, "%s<DataArray type=\"%s\" Name=\"%s\" ", indent, array->type,
+          array->name);
+  if (array->num_components > 1) {
+    fprintf(fp, "NumberOfComponents=\"%d\" ", array->num_components);
+  }
+  fprintf(fp, "format=\"appended\" offset=\"%lu\"/>\n",
+          (unsigned long) *offset);
+  *offset += array->encoded_size;
+}
+
+
+static int lsm_vis_writeAppendedData(
+  FILE *fp,
+  const LSM_VisArray *arrays,
+  int num_arrays,
+  LSM_VisCompression compression,
+  const LSM_VisBlock *blocks)
+{
+  int a, b;
+
+  fprintf(fp, "  <AppendedData encoding=\"raw\">\n   _");
+  for (a = 0; a < num_arrays; a++) {
+    const LSM_VisArray *array = &arrays[a];
+    if (compression == LSM_VIS_RAW) {
+      uint64_t num_bytes = array->num_bytes;
+      if ( (fwrite(&num_bytes, sizeof(num_bytes), 1, fp) != 1)
+        || (fwrite(array->data, 1, array->num_bytes, fp)
+            != array->num_bytes) ) {
+        return LSM_VIS_ERR_FILE_IO;
+      }
+    } else {
+      /* header:  number of blocks, block size, size of the last */
+      /* (partial) block and compressed size of each block       */
+      uint64_t header[3];
+      header[0] = array->num_blocks;
+      header[1] = LSM_VIS_BLOCK_SIZE;
+      header[2] = array->num_bytes % LSM_VIS_BLOCK_SIZE;
+      if (fwrite(header, sizeof(uint64_t), 3, fp) != 3) {
+        return LSM_VIS_ERR_FILE_IO;
+      }
+      for (b = 0; b < array->num_blocks; b++) {
+        uint64_t size = blocks[array->first_block + b].dst_size;
+        if (fwrite(&size, sizeof(size), 1, fp) != 1) {
+          return LSM_VIS_ERR_FILE_IO;
+        }
+      }
+      for (b = 0; b < array->num_blocks; b++) {
+        const LSM_VisBlock *block = &blocks[array->first_block + b];
+        if (fwrite(block->dst, 1, block->dst_size, fp) != block->dst_size) {
+          return LSM_VIS_ERR_FILE_IO;
+        }
+      }
+    }
+  }
+  fprintf(fp, "\n  </AppendedData>\n");
+  fprintf(fp, "</VTKFile>\n");
+
+  return LSM_VIS_ERR_SUCCESS;
+}
+
+
+static int lsm_vis_checkFields(
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names)
+{
+  int f;
+
+  if ( (!grid) || (num_fields < 1) || (!fields) || (!field_names) ) {
+    return LSM_VIS_ERR_INVALID_ARGUMENT;
+  }
+  if ( (grid->num_dims < 2) || (grid->num_dims > 3) ) {
+    return LSM_VIS_ERR_INVALID_ARGUMENT;
+  }
+  for (f = 0; f < num_fields; f++) {
+    if ( (!fields[f]) || (!field_names[f]) ) {
+      return LSM_VIS_ERR_INVALID_ARGUMENT;
+    }
+  }
+
+  return LSM_VIS_ERR_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+ * File:        lsm_visualization.h
+ * Copyrights:  (c) 2005 The Trustees of Princeton University and Board of
+ *                  Regents of the University of Texas.  All rights reserved.
+ *              (c) 2009 Kevin T. Chu.  All rights reserved.
+ * Revision:    $Revision$
+ * Modified:    $Date$
+ * Description: Header file for visualization output (VTK and XDMF)
+ */
+
+#ifndef included_lsm_visualization_h
+#define included_lsm_visualization_h
+
+#include "lsmlib_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/*! \file lsm_visualization.h
+ *
+ * \brief
+ * @ref lsm_visualization.h provides functions that write field data in
+ * formats read directly by visualization tools (e.g. ParaView and
+ * VisIt):
+ *
+ * - writeVTKImageData():  VTK image data (.vti) of the full grid
+ * - writeXDMF():          XDMF description (.xmf) of raw binary data
+ * - writeNarrowBandVTU(): VTK unstructured grid (.vtu) holding only the
+ *                         points of a narrow band, which is usually all
+ *                         that is needed to look at the interface
+ *
+ * The VTK writers store the data in the appended section of the file,
+ * either raw or compressed with zlib.  Compressed data are split into
+ * blocks of LSM_VIS_BLOCK_SIZE bytes that are compressed concurrently
+ * on the threads of the LSMLIB runtime (see @ref lsm_runtime.h).
+ *
+ * Grid point (i,j,k) is located at x_lo_ghostbox + (i,j,k)*dx, and all
+ * fields are defined on the ghostbox of the Grid.
+ *
+ */
+
+#include "lsm_grid.h"
+
+
+/*!
+ * Error codes returned by visualization output functions.
+ */
+#define LSM_VIS_ERR_SUCCESS                         (0)
+#define LSM_VIS_ERR_INVALID_ARGUMENT                (1)
+#define LSM_VIS_ERR_MEMORY_ALLOCATION               (2)
+#define LSM_VIS_ERR_FILE_IO                         (3)
+#define LSM_VIS_ERR_COMPRESSION                     (4)
+#define LSM_VIS_ERR_COMPRESSION_NOT_SUPPORTED       (5)
+
+/*!
+ * Size in bytes of the (uncompressed) blocks of compressed VTK data.
+ */
+#define LSM_VIS_BLOCK_SIZE                          (65536)
+
+/*!
+ * LSM_VisCompression selects the encoding of VTK appended data.
+ *
+ * - LSM_VIS_RAW:   uncompressed
+ * - LSM_VIS_ZLIB:  zlib-compressed (only available if LSMLIB was built
+ *                  with zlib, i.e. LSMLIB_HAVE_ZLIB is defined)
+ */
+typedef enum {
+  LSM_VIS_RAW  = 0,
+  LSM_VIS_ZLIB = 1
+} LSM_VisCompression;
+
+
+/*!
+ * writeVTKImageData() writes fields on the full grid to a VTK image
+ * data file.
+ *
+ * Arguments:
+ *  - file_name (in):    name of the file (usually ending in .vti)
+ *  - grid (in):         Grid of the fields
+ *  - num_fields (in):   number of fields
+ *  - fields (in):       array of num_fields pointers to the fields
+ *  - field_names (in):  array of num_fields field names
+ *  - compression (in):  encoding of the data
+ *
+ * Return value:         error code
+ *
+ */
+int writeVTKImageData(
+  const char *file_name,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names,
+  LSM_VisCompression compression);
+
+/*!
+ * writeXDMF() writes fields on the full grid to a raw binary file
+ * (file_base.raw) and an XDMF file describing it (file_base.xmf).
+ *
+ * Arguments:
+ *  - file_base (in):    name of the files without extension
+ *  - grid (in):         Grid of the fields
+ *  - num_fields (in):   number of fields
+ *  - fields (in):       array of num_fields pointers to the fields
+ *  - field_names (in):  array of num_fields field names
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - The fields are stored one after another in file_base.raw in the
+ *    byte order of the machine, exactly as they are stored in memory.
+ *
+ */
+int writeXDMF(
+  const char *file_base,
+  Grid *grid,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names);
+
+/*!
+ * writeNarrowBandVTU() writes the values of fields at a set of grid
+ * points (usually the narrow band) to a VTK unstructured grid file
+ * with one vertex cell per point.
+ *
+ * Arguments:
+ *  - file_name (in):    name of the file (usually ending in .vtu)
+ *  - grid (in):         Grid of the fields
+ *  - num_pts (in):      number of points
+ *  - index_x (in):      x-indices of the points
+ *  - index_y (in):      y-indices of the points
+ *  - index_z (in):      z-indices of the points (ignored for 2D grids)
+ *  - num_fields (in):   number of fields
+ *  - fields (in):       array of num_fields pointers to the fields
+ *                       (defined on the full grid)
+ *  - field_names (in):  array of num_fields field names
+ *  - compression (in):  encoding of the data
+ *
+ * Return value:         error code
+ *
+ * NOTES:
+ *  - For the narrow band of an LSM_DataArrays structure with level
+ *    'level', pass index_x + n_lo[0], index_y + n_lo[0],
+ *    index_z + n_lo[0] and num_pts = n_hi[level] - n_lo[0] + 1.
+ *
+ */
+int writeNarrowBandVTU(
+  const char *file_name,
+  Grid *grid,
+  int num_pts,
+  const int *index_x,
+  const int *index_y,
+  const int *index_z,
+  int num_fields,
+  LSMLIB_REAL **fields,
+  const char **field_names,
+  LSM_VisCompression compression);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Test program for the header-only C++ interface
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that the inline (point) forms of the C++ kernels
+ * agree with the Fortran kernels used by the field forms, that the
+ * kernels can be instantiated for a precision other than LSMLIB_REAL
+ * and that fmm_distance() computes a distance function.
+ */
+
+#include <math.h>                   // for fabs, sin, cos, sqrt
+#include <stddef.h>                 // for ptrdiff_t
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_cxx.h"
+#include "lsm_grid.h"
+
+/*
+ * Helper functions
+ */
+
+static LSMLIB_REAL testFunction(int i, int j, int k) {
+    return sin(0.3*i + 0.1*j*j)*cos(0.25*k - 0.05*i*j) + 0.01*i*k;
+}
+
+/*
+ * Tests
+ */
+
+TEST(LSMCxxTest, FieldIndexing) {
+    int dims[3] = {4, 3, 2};
+    LSMLIB_REAL dx[3] = {0.1, 0.2, 0.3};
+    lsm::Grid<3> g(dims, 2, dx);
+    EXPECT_EQ(g.gb_dims[0], 8);
+    EXPECT_EQ(g.fb_lo[1], 2);
+    EXPECT_EQ(g.fb_hi[2], 3);
+    EXPECT_EQ(g.num_gridpts(), (size_t) 8*7*6);
+
+    std::vector<float> data(g.num_gridpts());
+    lsm::Field<float,3> f(g, data.data());
+    EXPECT_EQ(f.offset(1, 2, 3), 1 + 8*(2 + 7*3));
+    f(1, 2, 3) = 5.0f;
+    EXPECT_EQ(data[1 + 8*(2 + 7*3)], 5.0f);
+
+    // every fillbox point is visited exactly once
+    std::vector<int> count(g.num_gridpts(), 0);
+    lsm::for_each_point(g, [&](ptrdiff_t p) { count[p]++; });
+    int num_visited = 0;
+    for (size_t p = 0; p < count.size(); p++) num_visited += count[p];
+    EXPECT_EQ(num_visited, 4*3*2);
+    EXPECT_EQ(count[f.offset(2, 2, 2)], 1);
+    EXPECT_EQ(count[f.offset(1, 2, 2)], 0);
+}
+
+TEST(LSMCxxTest, HJENO2MatchesFortran) {
+    int grid_dims[3] = {12, 10, 8};
+    LSMLIB_REAL x_lo[3] = {0.0, 0.0, 0.0};
+    LSMLIB_REAL x_hi[3] = {1.2, 1.0, 0.8};
+    Grid *grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+    ASSERT_TRUE(grid != NULL);
+    lsm::Grid<3> g(*grid);
+
+    size_t n = g.num_gridpts();
+    std::vector<LSMLIB_REAL> phi_data(n);
+    std::vector<float> phi_float_data(n);
+    lsm::Field<LSMLIB_REAL,3> phi(g, phi_data.data());
+    for (int k = 0; k < g.gb_dims[2]; k++) {
+        for (int j = 0; j < g.gb_dims[1]; j++) {
+            for (int i = 0; i < g.gb_dims[0]; i++) {
+                phi(i, j, k) = testFunction(i, j, k);
+                phi_float_data[phi.offset(i, j, k)] = phi(i, j, k);
+            }
+        }
+    }
+
+    // field form (Fortran kernel)
+    std::vector<LSMLIB_REAL> data[6];
+    for (int m = 0; m < 6; m++) data[m].assign(n, 0.0);
+    lsm::Field<LSMLIB_REAL,3> plus[3] = {
+        {g, data[0].data()}, {g, data[1].data()}, {g, data[2].data()}};
+    lsm::Field<LSMLIB_REAL,3> minus[3] = {
+        {g, data[3].data()}, {g, data[4].data()}, {g, data[5].data()}};
+    lsm::hj_eno2(plus, minus, phi, g);
+
+    // field form in single precision (inline kernel)
+    std::vector<float> float_data[6];
+    for (int m = 0; m < 6; m++) float_data[m].assign(n, 0.0f);
+    lsm::Field<float,3> phi_float(g, phi_float_data.data());
+    lsm::Field<float,3> plus_float[3] = {
+        {g, float_data[0].data()}, {g, float_data[1].data()},
+        {g, float_data[2].data()}};
+    lsm::Field<float,3> minus_float[3] = {
+        {g, float_data[3].data()}, {g, float_data[4].data()},
+        {g, float_data[5].data()}};
+    lsm::hj_eno2(plus_float, minus_float, phi_float, g);
+
+    // point form fused with the computation of |grad(phi)|^2
+    LSMLIB_REAL inv_dx[3] = {1/g.dx[0], 1/g.dx[1], 1/g.dx[2]};
+    int num_points = 0;
+    lsm::for_each_point(g, [&](ptrdiff_t p) {
+        lsm::Upwind<LSMLIB_REAL> d[3] = {
+            lsm::hj_eno2_at<0>(phi, p, inv_dx[0]),
+            lsm::hj_eno2_at<1>(phi, p, inv_dx[1]),
+            lsm::hj_eno2_at<2>(phi, p, inv_dx[2])};
+        for (int dir = 0; dir < 3; dir++) {
+            EXPECT_NEAR(d[dir].plus, plus[dir][p], 1e-12) << "p=" << p;
+            EXPECT_NEAR(d[dir].minus, minus[dir][p], 1e-12) << "p=" << p;
+            EXPECT_NEAR(plus_float[dir][p], plus[dir][p],
+                        1e-4*(1 + fabs(plus[dir][p]))) << "p=" << p;
+            EXPECT_NEAR(minus_float[dir][p], minus[dir][p],
+                        1e-4*(1 + fabs(minus[dir][p]))) << "p=" << p;
+        }
+        num_points++;
+    });
+    EXPECT_EQ(num_points, (grid->ihi_fb - grid->ilo_fb + 1)
+                        * (grid->jhi_fb - grid->jlo_fb + 1)
+                        * (grid->khi_fb - grid->klo_fb + 1));
+
+    destroyGrid(grid);
+}
+
+TEST(LSMCxxTest, RK3StagesMatchFortran) {
+    int dims[2] = {9, 7};
+    LSMLIB_REAL dx[2] = {0.1, 0.1};
+    lsm::Grid<2> g(dims, 3, dx);
+    size_t n = g.num_gridpts();
+
+    std::vector<LSMLIB_REAL> u_cur(n), rhs(n), u1(n, 0.0), u2(n, 0.0),
+                             u3(n, 0.0);
+    std::vector<float> u_cur_f(n), rhs_f(n), u1_f(n, 0.0f), u2_f(n, 0.0f),
+                       u3_f(n, 0.0f);
+    for (size_t p = 0; p < n; p++) {
+        u_cur[p] = u_cur_f[p] = sin(0.1*p);
+        rhs[p] = rhs_f[p] = cos(0.3*p);
+    }
+    LSMLIB_REAL dt = 0.05;
+
+    lsm::Field<LSMLIB_REAL,2> fc(g, u_cur.data()), fr(g, rhs.data()),
+                              f1(g, u1.data()), f2(g, u2.data()),
+                              f3(g, u3.data());
+    lsm::rk3_stage<1>(f1, f1, fc, fr, dt, g);
+    lsm::rk3_stage<2>(f2, f1, fc, fr, dt, g);
+    lsm::rk3_stage<3>(f3, f2, fc, fr, dt, g);
+
+    lsm::Field<float,2> gc(g, u_cur_f.data()), gr(g, rhs_f.data()),
+                        g1(g, u1_f.data()), g2(g, u2_f.data()),
+                        g3(g, u3_f.data());
+    lsm::rk3_stage<1>(g1, g1, gc, gr, (float) dt, g);
+    lsm::rk3_stage<2>(g2, g1, gc, gr, (float) dt, g);
+    lsm::rk3_stage<3>(g3, g2, gc, gr, (float) dt, g);
+
+    lsm::for_each_point(g, [&](ptrdiff_t p) {
+        LSMLIB_REAL v1 = lsm::rk3_stage_at<1>(u_cur[p], 0.0, rhs[p], dt);
+        LSMLIB_REAL v2 = lsm::rk3_stage_at<2>(u_cur[p], v1, rhs[p], dt);
+        LSMLIB_REAL v3 = lsm::rk3_stage_at<3>(u_cur[p], v2, rhs[p], dt);
+        EXPECT_NEAR(v1, u1[p], 1e-14);
+        EXPECT_NEAR(v2, u2[p], 1e-14);
+        EXPECT_NEAR(v3, u3[p], 1e-14);
+        EXPECT_NEAR(u3_f[p], u3[p], 1e-6);
+    });
+
+    // the ghostcells are not modified
+    EXPECT_EQ(u3[0], 0.0);
+    EXPECT_EQ(u3_f[n-1], 0.0f);
+}
+
+TEST(LSMCxxTest, FMMDistance) {
+    int dims[3] = {21, 21, 21};
+    LSMLIB_REAL dx[3] = {0.1, 0.1, 0.1};
+    lsm::Grid<3> g(dims, 2, dx);
+    size_t n = g.num_gridpts();
+
+    std::vector<LSMLIB_REAL> phi_data(n), distance_data(n);
+    lsm::Field<LSMLIB_REAL,3> phi(g, phi_data.data());
+    lsm::Field<LSMLIB_REAL,3> distance(g, distance_data.data());
+
+    // sphere of radius 0.6 centered in the domain; phi is not a
+    // distance function
+    LSMLIB_REAL r = 0.6;
+    for (int k = 0; k < g.gb_dims[2]; k++) {
+        for (int j = 0; j < g.gb_dims[1]; j++) {
+            for (int i = 0; i < g.gb_dims[0]; i++) {
+                LSMLIB_REAL x = (i - 12)*dx[0], y = (j - 12)*dx[1];
+                LSMLIB_REAL z = (k - 12)*dx[2];
+                phi(i, j, k) = (x*x + y*y + z*z) - r*r;
+            }
+        }
+    }
+
+    EXPECT_EQ(lsm::fmm_distance(distance, phi, g, 2), 0);
+
+    LSMLIB_REAL err = 0.0;
+    lsm::for_each_point(g, [&](ptrdiff_t p) {
+        int k = p/(g.gb_dims[0]*g.gb_dims[1]);
+        int j = (p/g.gb_dims[0]) % g.gb_dims[1];
+        int i = p % g.gb_dims[0];
+        LSMLIB_REAL x = (i - 12)*dx[0], y = (j - 12)*dx[1];
+        LSMLIB_REAL z = (k - 12)*dx[2];
+        LSMLIB_REAL exact = sqrt(x*x + y*y + z*z) - r;
+        if (fabs(distance[p] - exact) > err) err = fabs(distance[p] - exact);
+    });
+    EXPECT_LT(err, 0.05);
+}
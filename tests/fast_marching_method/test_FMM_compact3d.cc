@@ -0,0 +1,148 @@
+/*
+ * Test program for the compact fast marching method
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that computeExtensionFields3dCompact() and
+ * computeDistanceFunction3dCompact() produce the same results as
+ * computeExtensionFields3d() and computeDistanceFunction3d() on a
+ * porous domain (the complement of a packing of spheres).
+ */
+
+#include <math.h>                   // for sqrt, fmin
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_fast_marching_method.h"
+#include "FMM_Macros.h"
+
+/*
+ * Test fixtures
+ */
+class FMMCompact3dTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int n = grid_dims[0]*grid_dims[1]*grid_dims[2];
+        phi.resize(n);
+        mask.resize(n);
+        source.resize(n);
+
+        // solid spheres at pseudo-random positions
+        std::vector<LSMLIB_REAL> centers;
+        unsigned int seed = 12345;
+        for (int s = 0; s < 3*num_spheres; s++) {
+            seed = 1103515245u*seed + 12345u;
+            centers.push_back((seed >> 8) % 1000 / 1000.0);
+        }
+
+        int num_pore = 0;
+        for (int k = 0; k < grid_dims[2]; k++) {
+            for (int j = 0; j < grid_dims[1]; j++) {
+                for (int i = 0; i < grid_dims[0]; i++) {
+                    int idx = i + grid_dims[0]*(j + grid_dims[1]*k);
+                    LSMLIB_REAL x = (i+0.5)*dx[0];
+                    LSMLIB_REAL y = (j+0.5)*dx[1];
+                    LSMLIB_REAL z = (k+0.5)*dx[2];
+
+                    mask[idx] = 1.0;
+                    for (int s = 0; s < num_spheres; s++) {
+                        LSMLIB_REAL d = sqrt(
+                            (x-centers[3*s])*(x-centers[3*s])
+                          + (y-centers[3*s+1])*(y-centers[3*s+1])
+                          + (z-centers[3*s+2])*(z-centers[3*s+2])) - 0.17;
+                        mask[idx] = fmin(mask[idx], d);
+                    }
+                    if (mask[idx] >= 0) num_pore++;
+
+                    // fluid-fluid interface:  plane x + 0.3y = 0.45
+                    phi[idx] = x + 0.3*y - 0.45;
+                    source[idx] = y*z + x;
+                }
+            }
+        }
+        porosity = ((LSMLIB_REAL) num_pore)/n;
+    }
+
+    // --- Data members
+
+    int grid_dims[3] = {40, 36, 32};
+    LSMLIB_REAL dx[3] = {1.0/40, 1.0/36, 1.0/32};
+    const int num_spheres = 40;
+
+    std::vector<LSMLIB_REAL> phi, mask, source;
+    LSMLIB_REAL porosity;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(FMMCompact3dTest, MatchesFullGridExtensionFields) {
+    // the domain is porous
+    EXPECT_GT(porosity, 0.1);
+    EXPECT_LT(porosity, 0.7);
+
+    int n = (int) phi.size();
+    std::vector<LSMLIB_REAL> dist(n), ext(n), dist_compact(n),
+                             ext_compact(n);
+    LSMLIB_REAL *source_fields[1] = {source.data()};
+    LSMLIB_REAL *ext_fields[1] = {ext.data()};
+    LSMLIB_REAL *ext_fields_compact[1] = {ext_compact.data()};
+
+    ASSERT_EQ(computeExtensionFields3d(
+                  dist.data(), ext_fields, phi.data(), source_fields, 1,
+                  mask.data(), NULL, 1, grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+    ASSERT_EQ(computeExtensionFields3dCompact(
+                  dist_compact.data(), ext_fields_compact, phi.data(),
+                  source_fields, 1, mask.data(), NULL, 1, grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+
+    int num_reached = 0;
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(dist_compact[idx], dist[idx]) << "idx=" << idx;
+        ASSERT_EQ(ext_compact[idx], ext[idx]) << "idx=" << idx;
+        if ( (mask[idx] >= 0)
+          && (dist[idx] != LSM_FMM_DEFAULT_UPDATE_VALUE) ) {
+            num_reached++;
+        }
+    }
+    EXPECT_GT(num_reached, n/10);
+}
+
+TEST_F(FMMCompact3dTest, MatchesFullGridDistanceFunction) {
+    int n = (int) phi.size();
+    std::vector<LSMLIB_REAL> dist(n), dist_compact(n);
+
+    // without a mask, all grid points are active
+    ASSERT_EQ(computeDistanceFunction3d(
+                  dist.data(), phi.data(), NULL, 1, grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+    ASSERT_EQ(computeDistanceFunction3dCompact(
+                  dist_compact.data(), phi.data(), NULL, 1, grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(dist_compact[idx], dist[idx]) << "idx=" << idx;
+    }
+
+    // only the first-order discretization is supported
+    EXPECT_EQ(computeDistanceFunction3dCompact(
+                  dist_compact.data(), phi.data(), mask.data(), 2,
+                  grid_dims, dx),
+              LSM_FMM_ERR_INVALID_SPATIAL_DISCRETIZATION_ORDER);
+}
@@ -0,0 +1,206 @@
+/*
+ * Test program for fast marching method calculations on periodic grids
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests computeExtensionFields3dPeriodic(),
+ * computeDistanceFunction2dPeriodic() and
+ * solveEikonalEquation2dPeriodic().  The periodic results are compared
+ * with the results of the non-periodic solvers on a grid that tiles
+ * three copies of the domain along each periodic coordinate direction.
+ */
+
+#include <math.h>                   // for sqrt, sin, cos, fabs, fmin, ...
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_NEAR, ...
+
+#include "lsmlib_config.h"
+#include "lsm_fast_marching_method.h"
+#include "FMM_Macros.h"
+
+/*
+ * Helper functions
+ */
+
+// level set function of a sphere of radius 0.3 centered at (0.1, 0.9, 0.5)
+// that is periodic with period 1 in x and y
+static LSMLIB_REAL periodicSphere(LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL z)
+{
+    LSMLIB_REAL phi = 1.0;
+    for (int sx = -1; sx <= 1; sx++) {
+        for (int sy = -1; sy <= 1; sy++) {
+            LSMLIB_REAL dx = x - 0.1 - sx;
+            LSMLIB_REAL dy = y - 0.9 - sy;
+            LSMLIB_REAL dz = z - 0.5;
+            phi = fmin(phi, sqrt(dx*dx + dy*dy + dz*dz) - 0.3);
+        }
+    }
+    return phi;
+}
+
+/*
+ * Tests
+ */
+
+TEST(FMMPeriodicTest, ExtensionFields3dMatchTiledDomain) {
+    int grid_dims[3] = {24, 20, 16};
+    LSMLIB_REAL dx[3] = {1.0/24, 1.0/20, 1.0/16};
+    int periodic[3] = {1, 1, 0};
+    int tiled_dims[3] = {3*grid_dims[0], 3*grid_dims[1], grid_dims[2]};
+    const LSMLIB_REAL two_pi = 8.0*atan(1.0);
+
+    // phi and source field on the domain and on the tiled domain
+    int n = grid_dims[0]*grid_dims[1]*grid_dims[2];
+    int n_tiled = tiled_dims[0]*tiled_dims[1]*tiled_dims[2];
+    std::vector<LSMLIB_REAL> phi(n), source(n);
+    std::vector<LSMLIB_REAL> phi_tiled(n_tiled), source_tiled(n_tiled);
+    for (int k = 0; k < tiled_dims[2]; k++) {
+        for (int j = 0; j < tiled_dims[1]; j++) {
+            for (int i = 0; i < tiled_dims[0]; i++) {
+                LSMLIB_REAL x = (i+0.5)*dx[0];
+                LSMLIB_REAL y = (j+0.5)*dx[1];
+                LSMLIB_REAL z = (k+0.5)*dx[2];
+                int idx = i + tiled_dims[0]*(j + tiled_dims[1]*k);
+                phi_tiled[idx] = periodicSphere(x - 1.0, y - 1.0, z);
+                source_tiled[idx] = sin(two_pi*x)*cos(two_pi*y) + z;
+
+                int i_0 = i - grid_dims[0];
+                int j_0 = j - grid_dims[1];
+                if ( (i_0 >= 0) && (i_0 < grid_dims[0])
+                  && (j_0 >= 0) && (j_0 < grid_dims[1]) ) {
+                    int idx_0 = i_0 + grid_dims[0]*(j_0 + grid_dims[1]*k);
+                    phi[idx_0] = phi_tiled[idx];
+                    source[idx_0] = source_tiled[idx];
+                }
+            }
+        }
+    }
+
+    std::vector<LSMLIB_REAL> dist(n), ext(n), dist_nonperiodic(n);
+    std::vector<LSMLIB_REAL> dist_tiled(n_tiled), ext_tiled(n_tiled);
+    LSMLIB_REAL *source_fields[1] = {source.data()};
+    LSMLIB_REAL *ext_fields[1] = {ext.data()};
+    LSMLIB_REAL *source_fields_tiled[1] = {source_tiled.data()};
+    LSMLIB_REAL *ext_fields_tiled[1] = {ext_tiled.data()};
+
+    ASSERT_EQ(computeExtensionFields3dPeriodic(
+                  dist.data(), ext_fields, phi.data(), source_fields, 1,
+                  NULL, NULL, 1, grid_dims, dx, periodic),
+              LSM_FMM_ERR_SUCCESS);
+    ASSERT_EQ(computeExtensionFields3d(
+                  dist_tiled.data(), ext_fields_tiled, phi_tiled.data(),
+                  source_fields_tiled, 1, NULL, NULL, 1, tiled_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+    ASSERT_EQ(computeDistanceFunction3d(
+                  dist_nonperiodic.data(), phi.data(), NULL, 1,
+                  grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+
+    // the periodic results agree with the center tile, and the periodic
+    // distance function is more accurate than the non-periodic one
+    // (phi is the exact signed distance function)
+    LSMLIB_REAL max_diff_dist = 0.0;
+    LSMLIB_REAL max_diff_ext = 0.0;
+    LSMLIB_REAL max_err = 0.0;
+    LSMLIB_REAL max_err_nonperiodic = 0.0;
+    for (int k = 0; k < grid_dims[2]; k++) {
+        for (int j = 0; j < grid_dims[1]; j++) {
+            for (int i = 0; i < grid_dims[0]; i++) {
+                int idx = i + grid_dims[0]*(j + grid_dims[1]*k);
+                int idx_tiled = (i + grid_dims[0])
+                    + tiled_dims[0]*((j + grid_dims[1]) + tiled_dims[1]*k);
+                max_diff_dist = fmax(max_diff_dist,
+                    fabs(dist[idx] - dist_tiled[idx_tiled]));
+                max_diff_ext = fmax(max_diff_ext,
+                    fabs(ext[idx] - ext_tiled[idx_tiled]));
+                max_err = fmax(max_err, fabs(dist[idx] - phi[idx]));
+                max_err_nonperiodic = fmax(max_err_nonperiodic,
+                    fabs(dist_nonperiodic[idx] - phi[idx]));
+            }
+        }
+    }
+    EXPECT_LT(max_diff_dist, 1e-12);
+    EXPECT_LT(max_diff_ext, 1e-12);
+    EXPECT_LT(max_err, dx[0]);
+    EXPECT_LT(max_err, 0.6*max_err_nonperiodic);
+}
+
+TEST(FMMPeriodicTest, EikonalEquation2dWrapsAround) {
+    int grid_dims[2] = {32, 24};
+    LSMLIB_REAL dx[2] = {1.0/32, 1.0/24};
+    int periodic[2] = {1, 1};
+    int n = grid_dims[0]*grid_dims[1];
+
+    for (int order = 1; order <= 2; order++) {
+        // arrival time of a front starting at grid point (0, 0)
+        std::vector<LSMLIB_REAL> phi(n, -1.0), phi_nonperiodic(n, -1.0);
+        std::vector<LSMLIB_REAL> speed(n, 1.0);
+        phi[0] = 0.0;
+        phi_nonperiodic[0] = 0.0;
+
+        ASSERT_EQ(solveEikonalEquation2dPeriodic(
+                      phi.data(), speed.data(), NULL, order, grid_dims, dx,
+                      periodic),
+                  LSM_FMM_ERR_SUCCESS);
+        ASSERT_EQ(solveEikonalEquation2d(
+                      phi_nonperiodic.data(), speed.data(), NULL, order,
+                      grid_dims, dx),
+                  LSM_FMM_ERR_SUCCESS);
+
+        // the front reaches the last grid points across the boundary
+        int i_last = grid_dims[0] - 1;
+        int j_last = grid_dims[1] - 1;
+        EXPECT_NEAR(phi[i_last], dx[0], 1e-12);
+        EXPECT_NEAR(phi[grid_dims[0]*j_last], dx[1], 1e-12);
+        EXPECT_NEAR(phi_nonperiodic[i_last], i_last*dx[0], 1e-12);
+
+        // the arrival time is symmetric about the starting point
+        for (int j = 0; j < grid_dims[1]; j++) {
+            for (int i = 0; i < grid_dims[0]; i++) {
+                int i_mirror = (grid_dims[0] - i) % grid_dims[0];
+                int j_mirror = (grid_dims[1] - j) % grid_dims[1];
+                EXPECT_NEAR(phi[i + grid_dims[0]*j],
+                            phi[i_mirror + grid_dims[0]*j_mirror], 1e-12)
+                    << "i=" << i << ", j=" << j << ", order=" << order;
+            }
+        }
+    }
+}
+
+TEST(FMMPeriodicTest, NullPeriodicMatchesNonPeriodic) {
+    int grid_dims[2] = {30, 26};
+    LSMLIB_REAL dx[2] = {1.0/30, 1.0/26};
+    int n = grid_dims[0]*grid_dims[1];
+
+    std::vector<LSMLIB_REAL> phi(n), dist(n), dist_periodic(n);
+    for (int j = 0; j < grid_dims[1]; j++) {
+        for (int i = 0; i < grid_dims[0]; i++) {
+            LSMLIB_REAL x = (i+0.5)*dx[0] - 0.45;
+            LSMLIB_REAL y = (j+0.5)*dx[1] - 0.55;
+            phi[i + grid_dims[0]*j] = x*x + 2*y*y - 0.09;
+        }
+    }
+
+    ASSERT_EQ(computeDistanceFunction2d(
+                  dist.data(), phi.data(), NULL, 2, grid_dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+    ASSERT_EQ(computeDistanceFunction2dPeriodic(
+                  dist_periodic.data(), phi.data(), NULL, 2, grid_dims, dx,
+                  NULL),
+              LSM_FMM_ERR_SUCCESS);
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(dist_periodic[idx], dist[idx]) << "idx=" << idx;
+    }
+}
@@ -0,0 +1,271 @@
+/*
+ * Test program for 3D cut cell geometry
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests computeCutCells3d() on a plane (for which the cut
+ * cell geometry is exact) and on a sphere:  the total volume is
+ * compared with the exact volume and LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO(),
+ * and the discrete divergence theorem, the consistency of the apertures
+ * of shared faces and the independence of the number of threads are
+ * checked.
+ */
+
+#include <math.h>                   // for fabs, sqrt, M_PI
+#include <stdlib.h>                 // for malloc, free
+#include <map>                      // for map
+#include <tuple>                    // for make_tuple, tuple
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_NEAR, ...
+
+#include "lsmlib_config.h"
+#include "lsm_cut_cells3d.h"
+#include "lsm_geometry3d.h"
+#include "lsm_grid.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_runtime.h"
+
+/*
+ * Test fixtures
+ */
+class LSMCutCells3dTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {40, 40, 40};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+
+        int n = grid->num_gridpts;
+        phi = (LSMLIB_REAL *) malloc(n*sizeof(LSMLIB_REAL));
+        narrow_band = (unsigned char *) malloc(n*sizeof(unsigned char));
+        index_x = (int *) malloc(n*sizeof(int));
+        index_y = (int *) malloc(n*sizeof(int));
+        index_z = (int *) malloc(n*sizeof(int));
+        index_outer = (int *) malloc(n*sizeof(int));
+    }
+
+    void TearDown() override {
+        free(phi);
+        free(narrow_band);
+        free(index_x);
+        free(index_y);
+        free(index_z);
+        free(index_outer);
+        destroyGrid(grid);
+    }
+
+    // --- Helper functions
+
+    int index(int i, int j, int k) {
+        return i + j*grid->grid_dims_ghostbox[0]
+                 + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+    }
+
+    LSMLIB_REAL x(int n, int i) {
+        return grid->x_lo_ghostbox[n] + (i+0.5)*grid->dx[n];
+    }
+
+    // sets phi to the signed distance function of a sphere
+    void setSphere(LSMLIB_REAL radius) {
+        for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+            for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+                for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                    phi[index(i, j, k)] = sqrt(x(0,i)*x(0,i) + x(1,j)*x(1,j)
+                                             + x(2,k)*x(2,k)) - radius;
+                }
+            }
+        }
+    }
+
+    // computes the cut cells of phi from its level 0 narrow band
+    std::vector<LSM_CutCell3d> computeCutCells() {
+        int n_lo[1], n_hi[1];
+        int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+        LSMLIB_REAL width = 1.01*sqrt(grid->dx[0]*grid->dx[0]
+                                    + grid->dx[1]*grid->dx[1]
+                                    + grid->dx[2]*grid->dx[2]);
+        EXPECT_EQ(determineNarrowBand3d(
+                      phi, narrow_band, index_x, index_y, index_z,
+                      n_lo, n_hi, index_outer, grid->num_gridpts,
+                      &nlo_outer_plus, &nhi_outer_plus,
+                      &nlo_outer_minus, &nhi_outer_minus,
+                      width, 0.5*width, 0, grid),
+                  LSM_NARROW_BAND_ERR_SUCCESS);
+
+        std::vector<LSM_CutCell3d> cut_cells(n_hi[0] - n_lo[0] + 1);
+        int num_cut_cells = -1;
+        EXPECT_EQ(computeCutCells3d(cut_cells.data(), &num_cut_cells, phi,
+                                    grid, index_x, index_y, index_z,
+                                    n_lo[0], n_hi[0]),
+                  LSM_CUT_CELLS_ERR_SUCCESS);
+        cut_cells.resize(num_cut_cells);
+        return cut_cells;
+    }
+
+    // --- Data members
+
+    Grid *grid;
+    LSMLIB_REAL *phi;
+    unsigned char *narrow_band;
+    int *index_x, *index_y, *index_z, *index_outer;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMCutCells3dTest, Plane) {
+    // plane x = x0 in the interior of the cells with i = i0
+    int i0 = 17;
+    LSMLIB_REAL x0 = x(0, i0) + 0.2*grid->dx[0];
+    for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+        for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+            for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                phi[index(i, j, k)] = x(0, i) - x0;
+            }
+        }
+    }
+    std::vector<LSM_CutCell3d> cut_cells = computeCutCells();
+
+    // all interior cells with i = i0 (and no others) are cut
+    EXPECT_EQ((int) cut_cells.size(),
+              (grid->grid_dims_ghostbox[1] - 2)
+              * (grid->grid_dims_ghostbox[2] - 2));
+    for (const LSM_CutCell3d &cell : cut_cells) {
+        ASSERT_EQ(cell.index[0], i0);
+        EXPECT_NEAR(cell.volume_fraction, 0.7, 1e-12);
+        EXPECT_NEAR(cell.aperture[LSM_CUT_CELL_FACE_X_LO], 1.0, 1e-12);
+        EXPECT_NEAR(cell.aperture[LSM_CUT_CELL_FACE_X_HI], 0.0, 1e-12);
+        for (int face = LSM_CUT_CELL_FACE_Y_LO; face < 6; face++) {
+            EXPECT_NEAR(cell.aperture[face], 0.7, 1e-12);
+        }
+        EXPECT_NEAR(cell.interface_area, grid->dx[1]*grid->dx[2], 1e-12);
+        EXPECT_NEAR(cell.interface_centroid[0], x0, 1e-12);
+        EXPECT_NEAR(cell.interface_centroid[1], x(1, cell.index[1]), 1e-12);
+        EXPECT_NEAR(cell.interface_centroid[2], x(2, cell.index[2]), 1e-12);
+        EXPECT_NEAR(cell.interface_normal[0], 1.0, 1e-12);
+        EXPECT_NEAR(cell.interface_normal[1], 0.0, 1e-12);
+        EXPECT_NEAR(cell.interface_normal[2], 0.0, 1e-12);
+    }
+}
+
+TEST_F(LSMCutCells3dTest, SphereVolumeAndArea) {
+    LSMLIB_REAL radius = 0.5;
+    setSphere(radius);
+    std::vector<LSM_CutCell3d> cut_cells = computeCutCells();
+    ASSERT_GT(cut_cells.size(), 0u);
+
+    // volume:  cut cells plus uncut cells with phi < 0
+    std::vector<char> is_cut(grid->num_gridpts, 0);
+    LSMLIB_REAL volume = 0.0, area = 0.0;
+    LSMLIB_REAL cell_volume = grid->dx[0]*grid->dx[1]*grid->dx[2];
+    for (const LSM_CutCell3d &cell : cut_cells) {
+        is_cut[index(cell.index[0], cell.index[1], cell.index[2])] = 1;
+        volume += cell.volume_fraction*cell_volume;
+        area += cell.interface_area;
+
+        // interface centroids lie on the sphere; normals point outward
+        const LSMLIB_REAL *c = cell.interface_centroid;
+        LSMLIB_REAL r = sqrt(c[0]*c[0] + c[1]*c[1] + c[2]*c[2]);
+        EXPECT_NEAR(r, radius, 0.2*grid->dx[0]);
+        LSMLIB_REAL n_dot_r = (cell.interface_normal[0]*c[0]
+                             + cell.interface_normal[1]*c[1]
+                             + cell.interface_normal[2]*c[2])/r;
+        EXPECT_GT(n_dot_r, 0.99);
+    }
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        if ( (!is_cut[p]) && (phi[p] < 0) ) volume += cell_volume;
+    }
+
+    LSMLIB_REAL exact_volume = 4.0/3.0*M_PI*radius*radius*radius;
+    EXPECT_NEAR(volume, exact_volume, 1e-2*exact_volume);
+    EXPECT_NEAR(area, 4.0*M_PI*radius*radius, 1e-2*4.0*M_PI*radius*radius);
+
+    // consistent with the smoothed Heaviside volume
+    LSMLIB_REAL volume_heaviside, epsilon = grid->dx[0];
+    LSM3D_VOLUME_REGION_PHI_LESS_THAN_ZERO(
+        &volume_heaviside, phi,
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->ilo_fb, &grid->ihi_fb, &grid->jlo_fb, &grid->jhi_fb,
+        &grid->klo_fb, &grid->khi_fb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2], &epsilon);
+    EXPECT_NEAR(volume, volume_heaviside, 1e-2*exact_volume);
+}
+
+TEST_F(LSMCutCells3dTest, DivergenceTheoremAndSharedFaces) {
+    setSphere(0.43);
+    std::vector<LSM_CutCell3d> cut_cells = computeCutCells();
+
+    std::map<std::tuple<int,int,int>, const LSM_CutCell3d *> cells;
+    for (const LSM_CutCell3d &cell : cut_cells) {
+        cells[std::make_tuple(cell.index[0], cell.index[1],
+                              cell.index[2])] = &cell;
+    }
+
+    const LSMLIB_REAL *dx = grid->dx;
+    LSMLIB_REAL face_area[3] = {dx[1]*dx[2], dx[0]*dx[2], dx[0]*dx[1]};
+    int num_shared_faces = 0;
+    for (const LSM_CutCell3d &cell : cut_cells) {
+        for (int n = 0; n < 3; n++) {
+            // closed surface of the region phi < 0 in the cell
+            LSMLIB_REAL flux = (cell.aperture[2*n+1] - cell.aperture[2*n])
+                             * face_area[n]
+                             + cell.interface_area*cell.interface_normal[n];
+            EXPECT_NEAR(flux, 0.0, 1e-12);
+
+            // apertures of faces shared with the upper neighbor
+            int upper[3] = {cell.index[0], cell.index[1], cell.index[2]};
+            upper[n]++;
+            auto it = cells.find(std::make_tuple(upper[0], upper[1],
+                                                 upper[2]));
+            if (it != cells.end()) {
+                EXPECT_EQ(cell.aperture[2*n+1], it->second->aperture[2*n]);
+                num_shared_faces++;
+            }
+        }
+    }
+    EXPECT_GT(num_shared_faces, 0);
+}
+
+TEST_F(LSMCutCells3dTest, IndependentOfNumThreads) {
+    setSphere(0.61);
+    LSM_Runtime_initialize(1, LSM_AFFINITY_NONE);
+    std::vector<LSM_CutCell3d> serial = computeCutCells();
+    LSM_Runtime_finalize();
+    LSM_Runtime_initialize(4, LSM_AFFINITY_NONE);
+    std::vector<LSM_CutCell3d> threaded = computeCutCells();
+    LSM_Runtime_finalize();
+
+    ASSERT_EQ(serial.size(), threaded.size());
+    for (size_t m = 0; m < serial.size(); m++) {
+        for (int n = 0; n < 3; n++) {
+            ASSERT_EQ(serial[m].index[n], threaded[m].index[n]);
+            EXPECT_EQ(serial[m].interface_normal[n],
+                      threaded[m].interface_normal[n]);
+        }
+        EXPECT_EQ(serial[m].volume_fraction, threaded[m].volume_fraction);
+        EXPECT_EQ(serial[m].interface_area, threaded[m].interface_area);
+    }
+
+    // invalid arguments
+    int num_cut_cells;
+    EXPECT_EQ(computeCutCells3d(serial.data(), &num_cut_cells, NULL, grid,
+                                index_x, index_y, index_z, 0, 0),
+              LSM_CUT_CELLS_ERR_INVALID_ARGUMENT);
+}
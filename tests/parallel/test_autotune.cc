@@ -0,0 +1,200 @@
+/*
+ * Test program for the kernel autotuner
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that tuned configurations are stored in and
+ * reloaded from the cache file, that cache keys are shared by similar
+ * shapes and that the strided view kernels use the tuned configuration
+ * without changing their results.
+ */
+
+#include <math.h>                   // for sin
+#include <stdio.h>                  // for remove
+#include <string.h>                 // for strlen
+#include <unistd.h>                 // for getpid
+#include <string>                   // for string, to_string
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_autotune.h"
+#include "lsm_grid.h"
+#include "lsm_strided_view.h"
+
+/*
+ * Helper functions
+ */
+
+static std::string cacheFileName() {
+    return testing::TempDir() + "lsm_autotune_test_"
+         + std::to_string(getpid()) + ".cache";
+}
+
+/*
+ * Tests
+ */
+
+TEST(LSMAutotuneTest, CacheRoundTrip) {
+    std::string cache_file = cacheFileName();
+    remove(cache_file.c_str());
+    ASSERT_EQ(LSM_Autotune_setCacheFile(cache_file.c_str()),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    ASSERT_EQ(LSM_Autotune_setMode(LSM_AUTOTUNE_CACHED),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+
+    int dims[3] = {12, 10, 7};
+    LSM_AutotuneConfig config, tuned;
+
+    // not tuned yet:  default configuration
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                     dims),
+              LSM_AUTOTUNE_ERR_NOT_FOUND);
+    EXPECT_EQ(config.tile_dims[0], LSM_VIEW_DEFAULT_TILE_SIZE);
+    EXPECT_EQ(config.num_threads, 0);
+
+    ASSERT_EQ(LSM_Autotune_tune(&tuned, LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                dims),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    for (int l = 0; l < 3; l++) {
+        EXPECT_GE(tuned.tile_dims[l], 1);
+        EXPECT_LE(tuned.tile_dims[l], dims[l]);
+    }
+    EXPECT_GE(tuned.num_threads, 1);
+    EXPECT_GT(tuned.time, 0.0);
+
+    // reload the cache file
+    LSM_Autotune_clearCache();
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                     dims),
+              LSM_AUTOTUNE_ERR_NOT_FOUND);
+    ASSERT_EQ(LSM_Autotune_setCacheFile(cache_file.c_str()),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+
+    // similar shapes share the entry; other variants do not
+    int similar_dims[3] = {16, 9, 5};
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                     similar_dims),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    for (int l = 0; l < 3; l++) {
+        EXPECT_EQ(config.tile_dims[l], tuned.tile_dims[l]);
+    }
+    EXPECT_EQ(config.num_threads, tuned.num_threads);
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 4,
+                                     dims),
+              LSM_AUTOTUNE_ERR_NOT_FOUND);
+    int other_dims[3] = {17, 10, 7};
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                     other_dims),
+              LSM_AUTOTUNE_ERR_NOT_FOUND);
+
+    // "off" mode ignores the cache
+    ASSERT_EQ(LSM_Autotune_setMode(LSM_AUTOTUNE_OFF),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    EXPECT_EQ(LSM_Autotune_getConfig(&config,
+                                     LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 2,
+                                     dims),
+              LSM_AUTOTUNE_ERR_NOT_FOUND);
+
+    // "auto" mode tunes on first use
+    ASSERT_EQ(LSM_Autotune_setMode(LSM_AUTOTUNE_AUTO),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    EXPECT_EQ(LSM_Autotune_getConfig(&config, LSM_AUTOTUNE_TVD_RK_3D, 0,
+                                     dims),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    EXPECT_GE(config.num_threads, 1);
+
+    LSM_Autotune_setMode(LSM_AUTOTUNE_CACHED);
+    LSM_Autotune_setCacheFile(NULL);
+    remove(cache_file.c_str());
+}
+
+TEST(LSMAutotuneTest, TunedKernelMatchesDefault) {
+    LSM_Autotune_setCacheFile(NULL);
+    LSM_Autotune_setMode(LSM_AUTOTUNE_CACHED);
+
+    const int nx = 19, ny = 13, nz = 11;
+    int dims[3] = {nx, ny, nz};
+    int n = nx*ny*nz;
+    std::vector<LSMLIB_REAL> phi_data(n), ref_data(6*n), tuned_data(6*n);
+    for (int p = 0; p < n; p++) phi_data[p] = sin(0.37*p) + 0.001*p;
+
+    LSM_StridedView3d phi = makeStridedView3d(phi_data.data(), nx, ny, nz,
+                                              1, nx, nx*ny);
+    LSM_StridedView3d ref[6], tuned[6];
+    for (int f = 0; f < 6; f++) {
+        ref[f] = makeStridedView3d(ref_data.data() + f*n, nx, ny, nz,
+                                   1, nx, nx*ny);
+        tuned[f] = makeStridedView3d(tuned_data.data() + f*n, nx, ny, nz,
+                                     1, nx, nx*ny);
+    }
+    LSM_ViewBoundary3d bdry;
+    setViewBoundary3d(&bdry, LSM_VIEW_BC_COPY_EXTRAPOLATION, 0);
+
+    int tile_dims[3] = {LSM_VIEW_DEFAULT_TILE_SIZE,
+                        LSM_VIEW_DEFAULT_TILE_SIZE,
+                        LSM_VIEW_DEFAULT_TILE_SIZE};
+    ASSERT_EQ(computeUpwindGradientStridedView3d(
+                  &ref[0], &ref[1], &ref[2], &ref[3], &ref[4], &ref[5],
+                  &phi, &bdry, HIGH, 0.1, 0.1, 0.1, tile_dims, 1),
+              LSM_VIEW_ERR_SUCCESS);
+
+    ASSERT_EQ(LSM_Autotune_tune(NULL, LSM_AUTOTUNE_UPWIND_GRADIENT_3D, HIGH,
+                                dims),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    ASSERT_EQ(computeUpwindGradientStridedView3d(
+                  &tuned[0], &tuned[1], &tuned[2],
+                  &tuned[3], &tuned[4], &tuned[5],
+                  &phi, &bdry, HIGH, 0.1, 0.1, 0.1, NULL, 0),
+              LSM_VIEW_ERR_SUCCESS);
+    for (int p = 0; p < 6*n; p++) {
+        ASSERT_EQ(tuned_data[p], ref_data[p]) << "p=" << p;
+    }
+
+    LSM_Autotune_clearCache();
+}
+
+TEST(LSMAutotuneTest, InvalidArguments) {
+    int dims[3] = {8, 8, 8};
+    int bad_dims[3] = {8, 0, 8};
+    LSM_AutotuneConfig config;
+
+    EXPECT_EQ(LSM_Autotune_tune(&config, LSM_AUTOTUNE_UPWIND_GRADIENT_3D, 7,
+                                dims),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(LSM_Autotune_tune(&config, LSM_AUTOTUNE_CENTRAL_GRADIENT_3D, 3,
+                                dims),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(LSM_Autotune_tune(&config, LSM_AUTOTUNE_TVD_RK_3D, 0,
+                                bad_dims),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(LSM_Autotune_getConfig(NULL, LSM_AUTOTUNE_TVD_RK_3D, 0, dims),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(LSM_Autotune_getConfig(&config, (LSM_AutotuneKernel) 9, 0,
+                                     dims),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(LSM_Autotune_setMode((LSM_AutotuneMode) 5),
+              LSM_AUTOTUNE_ERR_INVALID_ARGUMENT);
+
+    char model[LSM_AUTOTUNE_MAX_CPU_MODEL_LENGTH];
+    EXPECT_EQ(LSM_Autotune_getCPUModel(model, sizeof(model)),
+              LSM_AUTOTUNE_ERR_SUCCESS);
+    EXPECT_GT(strlen(model), 0u);
+}
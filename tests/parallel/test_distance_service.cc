@@ -0,0 +1,287 @@
+/*
+ * Test program for the local distance-transform service
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that jobs submitted to a server running in a
+ * separate thread produce the same results as the direct FMM calls,
+ * that the server reuses its FMM workspaces and that invalid jobs and
+ * unsealed shared memory files are rejected.
+ */
+
+#include <math.h>                   // for sqrt
+#include <sys/mman.h>               // for memfd_create
+#include <unistd.h>                 // for getpid, ftruncate, close
+#include <string>                   // for string, to_string
+#include <thread>                   // for thread
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_distance_service.h"
+#include "lsm_fast_marching_method.h"
+#include "FMM_Macros.h"
+
+/*
+ * Helper functions
+ */
+
+static std::string socketPath() {
+    return testing::TempDir() + "lsm_distance_service_"
+         + std::to_string(getpid()) + ".sock";
+}
+
+// Level set function of a sphere (circle in 2D) of radius 0.3
+static void setSphere(LSMLIB_REAL *phi, const int *dims, int num_dims,
+                      LSMLIB_REAL dx) {
+    int nz = (num_dims == 3) ? dims[2] : 1;
+    for (int k = 0; k < nz; k++) {
+        for (int j = 0; j < dims[1]; j++) {
+            for (int i = 0; i < dims[0]; i++) {
+                LSMLIB_REAL x = i*dx - 0.5, y = j*dx - 0.5;
+                LSMLIB_REAL z = (num_dims == 3) ? k*dx - 0.5 : 0;
+                phi[i + dims[0]*(j + dims[1]*k)] =
+                    sqrt(x*x + y*y + z*z) - 0.3;
+            }
+        }
+    }
+}
+
+class LSMDistanceServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = socketPath();
+        server = createLSMDistanceServer(path.c_str(), 2, 8);
+        ASSERT_NE(server, nullptr);
+        server_thread = std::thread([this] {
+            run_status = runLSMDistanceServer(server);
+        });
+    }
+
+    void TearDown() override {
+        if (!server) return;
+        stopLSMDistanceServer(server);
+        server_thread.join();
+        EXPECT_EQ(run_status, LSM_SERVICE_ERR_SUCCESS);
+        destroyLSMDistanceServer(server);
+        EXPECT_NE(access(path.c_str(), F_OK), 0);
+    }
+
+    std::string path;
+    LSM_DistanceServer *server = nullptr;
+    std::thread server_thread;
+    int run_status = -1;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMDistanceServiceTest, DistanceFunctionMatchesDirect) {
+    LSM_ServiceClient *client = connectLSMServiceClient(path.c_str());
+    ASSERT_NE(client, nullptr);
+
+    int dims[3] = {21, 18, 15};
+    LSMLIB_REAL dx = 0.05;
+    LSM_ServiceBuffer *buffer = createLSMServiceBuffer(3, dims, 2);
+    ASSERT_NE(buffer, nullptr);
+    int n = buffer->num_gridpts;
+    LSMLIB_REAL *phi = getLSMServiceBufferField(buffer, 0);
+    setSphere(phi, dims, 3, dx);
+
+    LSM_ServiceJob job;
+    job.type = LSM_SERVICE_DISTANCE_FUNCTION;
+    job.spatial_discretization_order = 2;
+    job.dx[0] = job.dx[1] = job.dx[2] = dx;
+    job.phi_field = 0;
+    job.output_field = 1;
+    job.speed_field = -1;
+    job.mask_field = -1;
+
+    std::vector<LSMLIB_REAL> expected(n), phi_copy(phi, phi + n);
+    LSMLIB_REAL dx3[3] = {dx, dx, dx};
+    ASSERT_EQ(computeDistanceFunction3d(expected.data(), phi_copy.data(),
+                                        NULL, 2, dims, dx3),
+              LSM_FMM_ERR_SUCCESS);
+
+    // the second job on the same grid reuses the warm workspace
+    for (int pass = 0; pass < 2; pass++) {
+        ASSERT_EQ(submitLSMServiceJob(client, buffer, &job),
+                  LSM_SERVICE_ERR_SUCCESS);
+        LSMLIB_REAL *distance = getLSMServiceBufferField(buffer, 1);
+        for (int p = 0; p < n; p++) {
+            ASSERT_EQ(distance[p], expected[p]) << "p=" << p;
+        }
+    }
+
+    LSM_DistanceServerStatistics statistics;
+    getLSMDistanceServerStatistics(server, &statistics);
+    EXPECT_EQ(statistics.jobs_completed, 2);
+    EXPECT_LE(statistics.workspaces_created, 2);
+
+    destroyLSMServiceBuffer(buffer);
+    disconnectLSMServiceClient(client);
+}
+
+TEST_F(LSMDistanceServiceTest, EikonalMatchesDirect) {
+    int dims[2] = {33, 27};
+    LSMLIB_REAL dx[3] = {0.03, 0.04, 1.0};
+    const int num_clients = 4;
+    std::vector<std::thread> clients;
+    std::vector<int> status(num_clients, -1);
+    std::vector<int> mismatches(num_clients, 0);
+
+    // reference solution:  distance from the centre with speed 2
+    int n = dims[0]*dims[1];
+    std::vector<LSMLIB_REAL> expected(n, -1), speed(n, 2.0);
+    int center = dims[0]/2 + dims[0]*(dims[1]/2);
+    expected[center] = 0;
+    ASSERT_EQ(solveEikonalEquation2d(expected.data(), speed.data(), NULL,
+                                     1, dims, dx),
+              LSM_FMM_ERR_SUCCESS);
+
+    // several clients submit concurrently
+    for (int c = 0; c < num_clients; c++) {
+        clients.emplace_back([&, c] {
+            LSM_ServiceClient *client = connectLSMServiceClient(path.c_str());
+            LSM_ServiceBuffer *buffer = createLSMServiceBuffer(2, dims, 2);
+            if ( (!client) || (!buffer) ) return;
+            LSMLIB_REAL *phi = getLSMServiceBufferField(buffer, 0);
+            LSMLIB_REAL *speed_field = getLSMServiceBufferField(buffer, 1);
+            for (int p = 0; p < n; p++) {
+                phi[p] = -1;
+                speed_field[p] = 2.0;
+            }
+            phi[center] = 0;
+
+            LSM_ServiceJob job;
+            job.type = LSM_SERVICE_EIKONAL_EQUATION;
+            job.spatial_discretization_order = 1;
+            job.dx[0] = dx[0];
+            job.dx[1] = dx[1];
+            job.dx[2] = dx[2];
+            job.phi_field = 0;
+            job.output_field = -1;
+            job.speed_field = 1;
+            job.mask_field = -1;
+            status[c] = submitLSMServiceJob(client, buffer, &job);
+            for (int p = 0; p < n; p++) {
+                if (phi[p] != expected[p]) mismatches[c]++;
+            }
+            destroyLSMServiceBuffer(buffer);
+            disconnectLSMServiceClient(client);
+        });
+    }
+    for (auto &t : clients) t.join();
+
+    for (int c = 0; c < num_clients; c++) {
+        EXPECT_EQ(status[c], LSM_SERVICE_ERR_SUCCESS) << "client " << c;
+        EXPECT_EQ(mismatches[c], 0) << "client " << c;
+    }
+    LSM_DistanceServerStatistics statistics;
+    getLSMDistanceServerStatistics(server, &statistics);
+    EXPECT_EQ(statistics.jobs_completed, num_clients);
+    EXPECT_LE(statistics.workspaces_created, 2);
+}
+
+TEST_F(LSMDistanceServiceTest, InvalidJobs) {
+    LSM_ServiceClient *client = connectLSMServiceClient(path.c_str());
+    ASSERT_NE(client, nullptr);
+
+    int dims[3] = {8, 8, 8};
+    LSM_ServiceBuffer *buffer = createLSMServiceBuffer(3, dims, 2);
+    ASSERT_NE(buffer, nullptr);
+
+    LSM_ServiceJob job;
+    job.type = LSM_SERVICE_DISTANCE_FUNCTION;
+    job.spatial_discretization_order = 2;
+    job.dx[0] = job.dx[1] = job.dx[2] = 0.1;
+    job.phi_field = 0;
+    job.output_field = 2;  // out of range
+    job.speed_field = -1;
+    job.mask_field = -1;
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_INVALID_ARGUMENT);
+
+    job.output_field = 0;  // same as phi
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_INVALID_ARGUMENT);
+
+    job.output_field = 1;
+    job.spatial_discretization_order = 3;
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_INVALID_ARGUMENT);
+
+    job.spatial_discretization_order = 1;
+    job.type = LSM_SERVICE_EIKONAL_EQUATION;  // requires a speed field
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_INVALID_ARGUMENT);
+
+    // the connection remains usable after rejected jobs
+    job.type = LSM_SERVICE_DISTANCE_FUNCTION;
+    setSphere(getLSMServiceBufferField(buffer, 0), dims, 3, 0.1);
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_SUCCESS);
+
+    LSM_DistanceServerStatistics statistics;
+    getLSMDistanceServerStatistics(server, &statistics);
+    EXPECT_EQ(statistics.jobs_failed, 4);
+    EXPECT_EQ(statistics.jobs_completed, 1);
+
+    EXPECT_EQ(createLSMServiceBuffer(4, dims, 1), nullptr);
+    EXPECT_EQ(connectLSMServiceClient("/nonexistent/lsm.sock"), nullptr);
+    EXPECT_EQ(createLSMDistanceServer(path.c_str(), 1, 1), nullptr);
+
+    destroyLSMServiceBuffer(buffer);
+    disconnectLSMServiceClient(client);
+}
+
+TEST_F(LSMDistanceServiceTest, UnsealedBuffersAreRejected) {
+    LSM_ServiceClient *client = connectLSMServiceClient(path.c_str());
+    ASSERT_NE(client, nullptr);
+
+    int dims[3] = {8, 8, 8};
+    LSM_ServiceBuffer *buffer = createLSMServiceBuffer(3, dims, 2);
+    ASSERT_NE(buffer, nullptr);
+    setSphere(getLSMServiceBufferField(buffer, 0), dims, 3, 0.1);
+
+    // buffers cannot be shrunk
+    EXPECT_NE(ftruncate(buffer->fd, 0), 0);
+
+    LSM_ServiceJob job;
+    job.type = LSM_SERVICE_DISTANCE_FUNCTION;
+    job.spatial_discretization_order = 1;
+    job.dx[0] = job.dx[1] = job.dx[2] = 0.1;
+    job.phi_field = 0;
+    job.output_field = 1;
+    job.speed_field = -1;
+    job.mask_field = -1;
+
+    // a shared memory file of the right size without the seal
+    int sealed_fd = buffer->fd;
+    buffer->fd = memfd_create("unsealed", MFD_CLOEXEC);
+    ASSERT_GE(buffer->fd, 0);
+    ASSERT_EQ(ftruncate(buffer->fd, (off_t) buffer->size), 0);
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_SHARED_MEMORY);
+    close(buffer->fd);
+    buffer->fd = sealed_fd;
+
+    EXPECT_EQ(submitLSMServiceJob(client, buffer, &job),
+              LSM_SERVICE_ERR_SUCCESS);
+
+    destroyLSMServiceBuffer(buffer);
+    disconnectLSMServiceClient(client);
+}
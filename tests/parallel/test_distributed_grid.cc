@@ -0,0 +1,265 @@
+/*
+ * Test program for LSM_DistributedGrid (run with mpiexec)
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+#include <math.h>                   // for fabs, sqrt
+#include <stdlib.h>                 // for malloc, free
+
+#include <mpi.h>
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, ASSERT_TRUE, ...
+
+#include "lsmlib_config.h"
+#include "lsm_distributed_grid.h"
+#include "lsm_fast_marching_method.h"
+#include "lsm_grid.h"
+
+/*
+ * Helper functions
+ */
+static LSMLIB_REAL globalIndexValue(int i, int j, int k)
+{
+    return 10000.0*k + 100.0*j + i;
+}
+
+static void initializeSphere(LSMLIB_REAL *phi, Grid *grid, LSMLIB_REAL scale)
+{
+    int nz = (grid->num_dims == 3) ? grid->grid_dims_ghostbox[2] : 1;
+    for (int k = 0; k < nz; k++) {
+        for (int j = 0; j < grid->grid_dims_ghostbox[1]; j++) {
+            for (int i = 0; i < grid->grid_dims_ghostbox[0]; i++) {
+                LSMLIB_REAL x = grid->x_lo_ghostbox[0] + (i+0.5)*grid->dx[0];
+                LSMLIB_REAL y = grid->x_lo_ghostbox[1] + (j+0.5)*grid->dx[1];
+                LSMLIB_REAL z = (grid->num_dims == 3) ?
+                    grid->x_lo_ghostbox[2] + (k+0.5)*grid->dx[2] : 0.0;
+                int idx = i + j*grid->grid_dims_ghostbox[0]
+                        + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+                phi[idx] = scale*(sqrt(x*x + y*y + z*z) - 0.5);
+            }
+        }
+    }
+}
+
+/*
+ * Test fixtures
+ */
+class LSMDistributedGridTest : public ::testing::TestWithParam<int> {
+  protected:
+    LSM_DistributedGrid *dgrid;
+    int num_dims;
+
+    LSMDistributedGridTest() {
+        num_dims = GetParam();
+        int grid_dims[3] = {30, 26, 22};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        dgrid = createDistributedGrid(MPI_COMM_WORLD, num_dims, grid_dims,
+                                      x_lo, x_hi, MEDIUM, NULL, NULL);
+    }
+
+    ~LSMDistributedGridTest() {
+        destroyDistributedGrid(dgrid);
+    }
+};
+
+/*
+ * Tests
+ */
+TEST_P(LSMDistributedGridTest, HaloExchange) {
+    ASSERT_TRUE(dgrid != NULL);
+    Grid *grid = dgrid->local_grid;
+    int g = dgrid->num_ghostcells;
+    int nz = (num_dims == 3) ? grid->grid_dims_ghostbox[2] : 1;
+
+    LSMLIB_REAL *field =
+        (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+    for (int idx = 0; idx < grid->num_gridpts; idx++) field[idx] = -1.0;
+
+    // Fill interior with a function of the global index
+    int klo = (num_dims == 3) ? g : 0;
+    int khi = (num_dims == 3) ? g + grid->grid_dims[2] : 1;
+    for (int k = klo; k < khi; k++) {
+        for (int j = g; j < g + grid->grid_dims[1]; j++) {
+            for (int i = g; i < g + grid->grid_dims[0]; i++) {
+                int idx = i + j*grid->grid_dims_ghostbox[0]
+                        + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+                field[idx] = globalIndexValue(
+                    i - g + dgrid->global_offset[0],
+                    j - g + dgrid->global_offset[1],
+                    (num_dims == 3) ? k - g + dgrid->global_offset[2] : 0);
+            }
+        }
+    }
+
+    ASSERT_EQ(exchangeDistributedGridHalos(dgrid, field),
+              LSM_DISTRIBUTED_ERR_SUCCESS);
+
+    // Every ghostcell inside the global domain (including edges and
+    // corners) must hold the value of the corresponding global point
+    int num_checked = 0;
+    for (int k = 0; k < nz; k++) {
+        for (int j = 0; j < grid->grid_dims_ghostbox[1]; j++) {
+            for (int i = 0; i < grid->grid_dims_ghostbox[0]; i++) {
+                int gi = i - g + dgrid->global_offset[0];
+                int gj = j - g + dgrid->global_offset[1];
+                int gk = (num_dims == 3) ? k - g + dgrid->global_offset[2] : 0;
+                if ( (gi < 0) || (gi >= dgrid->global_grid->grid_dims[0]) ||
+                     (gj < 0) || (gj >= dgrid->global_grid->grid_dims[1]) ||
+                     (gk < 0) || (gk >= dgrid->global_grid->grid_dims[2]) ) {
+                    continue;
+                }
+                int idx = i + j*grid->grid_dims_ghostbox[0]
+                        + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+                ASSERT_EQ(field[idx], globalIndexValue(gi, gj, gk));
+                num_checked++;
+            }
+        }
+    }
+    EXPECT_GT(num_checked, 0);
+
+    free(field);
+}
+
+TEST_P(LSMDistributedGridTest, GlobalReductions) {
+    ASSERT_TRUE(dgrid != NULL);
+    Grid *grid = dgrid->local_grid;
+
+    LSMLIB_REAL num_local_pts = grid->grid_dims[0]*grid->grid_dims[1]
+                              * ( (num_dims == 3) ? grid->grid_dims[2] : 1 );
+    LSMLIB_REAL num_global_pts = 30*26*( (num_dims == 3) ? 22 : 1 );
+    EXPECT_EQ(computeDistributedSum(dgrid, num_local_pts), num_global_pts);
+    EXPECT_EQ(computeDistributedMin(dgrid, (LSMLIB_REAL) dgrid->rank), 0.0);
+    EXPECT_EQ(computeDistributedMax(dgrid, (LSMLIB_REAL) dgrid->rank),
+              (LSMLIB_REAL) (dgrid->num_procs - 1));
+}
+
+TEST_P(LSMDistributedGridTest, DistanceFunction) {
+    ASSERT_TRUE(dgrid != NULL);
+    Grid *grid = dgrid->local_grid;
+    Grid *global_grid = dgrid->global_grid;
+
+    LSMLIB_REAL *phi =
+        (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+    LSMLIB_REAL *dist =
+        (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+    initializeSphere(phi, grid, 3.0);
+    ASSERT_EQ(computeDistributedDistanceFunction(dgrid, dist, phi, 0),
+              LSM_DISTRIBUTED_ERR_SUCCESS);
+
+    LSMLIB_REAL *global_dist = NULL;
+    if (dgrid->rank == 0) {
+        global_dist = (LSMLIB_REAL *)
+            malloc(global_grid->num_gridpts*sizeof(LSMLIB_REAL));
+    }
+    ASSERT_EQ(gatherDistributedField(dgrid, global_dist, dist, 0),
+              LSM_DISTRIBUTED_ERR_SUCCESS);
+
+    // Compare with the same algorithm on a single block, with the fast
+    // marching method on the same grid and with the exact distance
+    // function
+    if (dgrid->rank == 0) {
+        int grid_dims[3] = {30, 26, 22};
+        LSM_DistributedGrid *serial = createDistributedGrid(
+            MPI_COMM_SELF, num_dims, grid_dims,
+            global_grid->x_lo, global_grid->x_hi, MEDIUM, NULL, NULL);
+        ASSERT_TRUE(serial != NULL);
+
+        LSMLIB_REAL *serial_phi = (LSMLIB_REAL *)
+            malloc(global_grid->num_gridpts*sizeof(LSMLIB_REAL));
+        LSMLIB_REAL *serial_dist = (LSMLIB_REAL *)
+            malloc(global_grid->num_gridpts*sizeof(LSMLIB_REAL));
+        LSMLIB_REAL *fmm_dist = (LSMLIB_REAL *)
+            malloc(global_grid->num_gridpts*sizeof(LSMLIB_REAL));
+        LSMLIB_REAL *exact = (LSMLIB_REAL *)
+            malloc(global_grid->num_gridpts*sizeof(LSMLIB_REAL));
+        initializeSphere(serial_phi, global_grid, 3.0);
+        initializeSphere(exact, global_grid, 1.0);
+        ASSERT_EQ(computeDistributedDistanceFunction(serial, serial_dist,
+                                                     serial_phi, 0),
+                  LSM_DISTRIBUTED_ERR_SUCCESS);
+
+        initializeSphere(serial_phi, global_grid, 3.0);
+        if (num_dims == 3) {
+            ASSERT_EQ(computeDistanceFunction3d(
+                          fmm_dist, serial_phi, NULL, 1,
+                          global_grid->grid_dims_ghostbox,
+                          global_grid->dx), 0);
+        } else {
+            ASSERT_EQ(computeDistanceFunction2d(
+                          fmm_dist, serial_phi, NULL, 1,
+                          global_grid->grid_dims_ghostbox,
+                          global_grid->dx), 0);
+        }
+
+        int g = serial->num_ghostcells;
+        int nz = (num_dims == 3) ? global_grid->grid_dims[2] : 1;
+        int goff = (num_dims == 3) ? g : 0;
+        for (int k = 0; k < nz; k++) {
+            for (int j = 0; j < global_grid->grid_dims[1]; j++) {
+                for (int i = 0; i < global_grid->grid_dims[0]; i++) {
+                    int idx = (i+g) + (j+g)*global_grid->grid_dims_ghostbox[0]
+                            + (k+goff)*global_grid->grid_dims_ghostbox[0]
+                                      *global_grid->grid_dims_ghostbox[1];
+                    ASSERT_NEAR(global_dist[idx], serial_dist[idx], 1e-10);
+                    // (same first-order upwind discretization)
+                    ASSERT_NEAR(global_dist[idx], fmm_dist[idx],
+                                0.02*global_grid->dx[0]);
+                    ASSERT_NEAR(global_dist[idx], exact[idx],
+                                2.0*global_grid->dx[0]);
+                }
+            }
+        }
+
+        free(serial_phi);
+        free(serial_dist);
+        free(fmm_dist);
+        free(exact);
+        free(global_dist);
+        destroyDistributedGrid(serial);
+    }
+
+    free(phi);
+    free(dist);
+}
+
+INSTANTIATE_TEST_SUITE_P(Dimensions, LSMDistributedGridTest,
+                         ::testing::Values(2, 3));
+
+/*
+ * Main program
+ */
+int main(int argc, char **argv)
+{
+    MPI_Init(&argc, &argv);
+    ::testing::InitGoogleTest(&argc, argv);
+
+    // Only report results from the root process
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank != 0) {
+        ::testing::TestEventListeners &listeners =
+            ::testing::UnitTest::GetInstance()->listeners();
+        delete listeners.Release(listeners.default_result_printer());
+    }
+
+    int result = RUN_ALL_TESTS();
+
+    // Fail on all processes if any process failed
+    int global_result;
+    MPI_Allreduce(&result, &global_result, 1, MPI_INT, MPI_MAX,
+                  MPI_COMM_WORLD);
+
+    MPI_Finalize();
+    return global_result;
+}
@@ -0,0 +1,192 @@
+/*
+ * Test program for LSM_Ensemble
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+#include <stdlib.h>                 // for malloc, free
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, ASSERT_TRUE, ...
+
+#include "lsmlib_config.h"
+#include "lsm_ensemble.h"
+#include "lsm_fast_marching_method.h"
+#include "lsm_grid.h"
+#include "lsm_initialization2d.h"
+#include "lsm_spatial_derivatives2d.h"
+
+/*
+ * Constants
+ */
+#define NUM_MEMBERS (7)
+#define NUM_FIELDS  (6)
+#define NUM_THREADS (3)
+
+/*
+ * Test fixtures
+ */
+class LSMEnsembleTest : public ::testing::Test {
+  protected:
+    // Data members
+    Grid *grid;
+    LSM_Ensemble *ensemble;
+
+    // Constructor
+    LSMEnsembleTest() {
+        LSMLIB_REAL x_lo[2] = {-1.0, -1.0};
+        LSMLIB_REAL x_hi[2] = {1.0, 1.0};
+        int grid_dims[2] = {40, 40};
+
+        grid = createGridSetGridDims(2, grid_dims, x_lo, x_hi, MEDIUM);
+        ensemble = createLSMEnsemble(grid, NUM_MEMBERS, NUM_FIELDS,
+                                     NUM_THREADS);
+
+        // Initialize field 0 of each member with a circle of a
+        // different radius (scaled so that phi is not a distance
+        // function)
+        for (int m = 0; m < NUM_MEMBERS; m++) {
+            LSMLIB_REAL *phi = getLSMEnsembleField(ensemble, m, 0);
+            createCircle(phi, 0.1, -0.05, 0.2 + 0.08*m, -1, grid);
+            for (int idx = 0; idx < grid->num_gridpts; idx++) {
+                phi[idx] *= 2.0 + m;
+            }
+        }
+    }
+
+    // Destructor
+    ~LSMEnsembleTest() {
+        destroyLSMEnsemble(ensemble);
+        destroyGrid(grid);
+    }
+};
+
+/*
+ * Tests
+ */
+TEST_F(LSMEnsembleTest, ContiguousStorage) {
+    ASSERT_TRUE(ensemble != NULL);
+    EXPECT_EQ(getLSMEnsembleField(ensemble, 0, 1),
+              ensemble->data + grid->num_gridpts);
+    EXPECT_EQ(getLSMEnsembleField(ensemble, 1, 0),
+              ensemble->data + NUM_FIELDS*grid->num_gridpts);
+}
+
+TEST_F(LSMEnsembleTest, DistanceFunction) {
+    int num_gridpts = grid->num_gridpts;
+    LSMLIB_REAL *expected =
+        (LSMLIB_REAL *) malloc(num_gridpts*sizeof(LSMLIB_REAL));
+
+    // Compute distance functions twice to exercise workspace reuse
+    for (int pass = 0; pass < 2; pass++) {
+        ASSERT_EQ(computeLSMEnsembleDistanceFunction2d(ensemble, 1, 0, -1, 2),
+                  LSM_ENSEMBLE_ERR_SUCCESS);
+    }
+
+    // Compare with serial computation
+    for (int m = 0; m < NUM_MEMBERS; m++) {
+        computeDistanceFunction2d(expected,
+                                  getLSMEnsembleField(ensemble, m, 0),
+                                  NULL, 2,
+                                  grid->grid_dims_ghostbox, grid->dx);
+        LSMLIB_REAL *dist = getLSMEnsembleField(ensemble, m, 1);
+        for (int idx = 0; idx < num_gridpts; idx++) {
+            ASSERT_EQ(dist[idx], expected[idx]);
+        }
+    }
+
+    free(expected);
+}
+
+TEST_F(LSMEnsembleTest, HJENO2AndRungeKutta) {
+    int num_gridpts = grid->num_gridpts;
+    LSMLIB_REAL *expected[4];
+    LSMLIB_REAL *D1 = (LSMLIB_REAL *) malloc(num_gridpts*sizeof(LSMLIB_REAL));
+    LSMLIB_REAL *D2 = (LSMLIB_REAL *) malloc(num_gridpts*sizeof(LSMLIB_REAL));
+    for (int i = 0; i < 4; i++) {
+        expected[i] = (LSMLIB_REAL *) calloc(num_gridpts, sizeof(LSMLIB_REAL));
+    }
+
+    ASSERT_EQ(computeLSMEnsembleHJENO2_2d(ensemble, 1, 2, 3, 4, 0),
+              LSM_ENSEMBLE_ERR_SUCCESS);
+
+    for (int m = 0; m < NUM_MEMBERS; m++) {
+        Grid *g = grid;
+        LSM2D_HJ_ENO2(
+            expected[0], expected[1],
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            expected[2], expected[3],
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            getLSMEnsembleField(ensemble, m, 0),
+            &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            D1, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            D2, &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+            &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+            &(g->dx[0]), &(g->dx[1]));
+
+        for (int f = 0; f < 4; f++) {
+            LSMLIB_REAL *grad = getLSMEnsembleField(ensemble, m, f+1);
+            for (int j = g->jlo_fb; j <= g->jhi_fb; j++) {
+                for (int i = g->ilo_fb; i <= g->ihi_fb; i++) {
+                    int idx = i + j*g->grid_dims_ghostbox[0];
+                    ASSERT_EQ(grad[idx], expected[f][idx]);
+                }
+            }
+        }
+    }
+
+    // Use phi_x_plus as a right-hand side for a TVD RK2 step
+    LSMLIB_REAL dt[NUM_MEMBERS];
+    for (int m = 0; m < NUM_MEMBERS; m++) dt[m] = 0.01*(m+1);
+    ASSERT_EQ(advanceLSMEnsembleTVDRK2d(ensemble, 2, 1, 5, -1, 0, 1, dt),
+              LSM_ENSEMBLE_ERR_SUCCESS);
+    ASSERT_EQ(advanceLSMEnsembleTVDRK2d(ensemble, 2, 2, 4, 5, 0, 1, dt),
+              LSM_ENSEMBLE_ERR_SUCCESS);
+    for (int m = 0; m < NUM_MEMBERS; m++) {
+        LSMLIB_REAL *u_cur = getLSMEnsembleField(ensemble, m, 0);
+        LSMLIB_REAL *rhs = getLSMEnsembleField(ensemble, m, 1);
+        LSMLIB_REAL *u_next = getLSMEnsembleField(ensemble, m, 4);
+        int idx = grid->ilo_fb + 3 + (grid->jlo_fb + 5)*grid->grid_dims_ghostbox[0];
+        LSMLIB_REAL u_stage1 = u_cur[idx] + dt[m]*rhs[idx];
+        EXPECT_NEAR(u_next[idx],
+                    0.5*(u_cur[idx] + u_stage1 + dt[m]*rhs[idx]), 1e-12);
+    }
+
+    ASSERT_EQ(advanceLSMEnsembleTVDRK2d(ensemble, 2, 3, 4, 5, 0, 1, dt),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+
+    for (int i = 0; i < 4; i++) free(expected[i]);
+    free(D1);
+    free(D2);
+}
+
+TEST_F(LSMEnsembleTest, InvalidIndices) {
+    EXPECT_EQ(getLSMEnsembleField(ensemble, -1, 0), nullptr);
+    EXPECT_EQ(getLSMEnsembleField(ensemble, NUM_MEMBERS, 0), nullptr);
+    EXPECT_EQ(getLSMEnsembleField(ensemble, 0, -1), nullptr);
+    EXPECT_EQ(getLSMEnsembleField(ensemble, 0, NUM_FIELDS), nullptr);
+
+    EXPECT_EQ(computeLSMEnsembleDistanceFunction2d(ensemble, NUM_FIELDS, 0,
+                                                   -1, 1),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(computeLSMEnsembleDistanceFunction2d(ensemble, 1, -1, -1, 1),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(computeLSMEnsembleDistanceFunction2d(ensemble, 1, 0,
+                                                   NUM_FIELDS, 1),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(computeLSMEnsembleHJENO2_2d(ensemble, 1, 2, 3, NUM_FIELDS, 0),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+
+    LSMLIB_REAL dt[NUM_MEMBERS] = {0};
+    EXPECT_EQ(advanceLSMEnsembleTVDRK2d(ensemble, 2, 2, 1, NUM_FIELDS, 0, 2,
+                                        dt),
+              LSM_ENSEMBLE_ERR_INVALID_ARGUMENT);
+}
@@ -0,0 +1,143 @@
+/*
+ * Test program for LSM_Runtime
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+#include <atomic>                   // for std::atomic
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, ASSERT_TRUE, ...
+
+#include "lsmlib_config.h"
+#include "lsm_runtime.h"
+
+/*
+ * Constants
+ */
+#define NUM_THREADS    (4)
+#define NUM_ITERATIONS (1000)
+
+/*
+ * Helper functions
+ */
+struct CountData {
+    std::atomic<int> counts[NUM_ITERATIONS];
+    std::atomic<int> bad_thread_num;
+};
+
+static void countIterations(int begin, int end, int thread_num,
+                            void *user_data)
+{
+    CountData *data = static_cast<CountData *>(user_data);
+    if ( (thread_num < 0) || (thread_num >= LSM_Runtime_getNumThreads()) ||
+         (thread_num != LSM_Runtime_getThreadNum()) ||
+         (!LSM_Runtime_inParallel()) ) {
+        data->bad_thread_num++;
+    }
+    for (int i = begin; i < end; i++) data->counts[i]++;
+}
+
+struct NestedData {
+    std::atomic<int> mismatches;
+    std::atomic<int> inner_iterations;
+};
+
+static void innerBody(int begin, int end, int thread_num, void *user_data)
+{
+    NestedData *data = static_cast<NestedData *>(user_data);
+    data->inner_iterations += end - begin;
+    (void) thread_num;
+}
+
+static void outerBody(int begin, int end, int thread_num, void *user_data)
+{
+    NestedData *data = static_cast<NestedData *>(user_data);
+    for (int i = begin; i < end; i++) {
+        int num_threads = LSM_Runtime_parallelFor(
+            0, 10, LSM_SCHEDULE_DYNAMIC, 0, 0, innerBody, data);
+        if ( (num_threads != 1) ||
+             (LSM_Runtime_getThreadNum() != thread_num) ) {
+            data->mismatches++;
+        }
+    }
+}
+
+/*
+ * Test fixtures
+ */
+class LSMRuntimeTest : public ::testing::Test {
+  protected:
+    // Constructor
+    LSMRuntimeTest() {
+        LSM_Runtime_initialize(NUM_THREADS, LSM_AFFINITY_NONE);
+    }
+
+    // Destructor
+    ~LSMRuntimeTest() {
+        LSM_Runtime_finalize();
+    }
+
+    void checkCoverage(LSM_ScheduleType schedule, int chunk_size) {
+        CountData data;
+        for (int i = 0; i < NUM_ITERATIONS; i++) data.counts[i] = 0;
+        data.bad_thread_num = 0;
+
+        LSM_Runtime_parallelFor(0, NUM_ITERATIONS, schedule, chunk_size, 0,
+                                countIterations, &data);
+
+        for (int i = 0; i < NUM_ITERATIONS; i++) {
+            ASSERT_EQ(data.counts[i], 1);
+        }
+        EXPECT_EQ(data.bad_thread_num, 0);
+        EXPECT_FALSE(LSM_Runtime_inParallel());
+    }
+};
+
+/*
+ * Tests
+ */
+TEST_F(LSMRuntimeTest, NumThreads) {
+    EXPECT_EQ(LSM_Runtime_getNumThreads(), NUM_THREADS);
+    EXPECT_EQ(LSM_Runtime_setNumThreads(2), LSM_RUNTIME_ERR_SUCCESS);
+    EXPECT_EQ(LSM_Runtime_getNumThreads(), 2);
+    EXPECT_EQ(LSM_Runtime_getThreadNum(), 0);
+}
+
+TEST_F(LSMRuntimeTest, StaticSchedule) {
+    checkCoverage(LSM_SCHEDULE_STATIC, 0);
+    checkCoverage(LSM_SCHEDULE_STATIC, 7);
+}
+
+TEST_F(LSMRuntimeTest, DynamicSchedule) {
+    checkCoverage(LSM_SCHEDULE_DYNAMIC, 0);
+    checkCoverage(LSM_SCHEDULE_DYNAMIC, 1);
+    checkCoverage(LSM_SCHEDULE_DYNAMIC, 13);
+}
+
+TEST_F(LSMRuntimeTest, NestedLoopsRunSerially) {
+    NestedData data;
+    data.mismatches = 0;
+    data.inner_iterations = 0;
+
+    LSM_Runtime_parallelFor(0, 50, LSM_SCHEDULE_DYNAMIC, 1, 0,
+                            outerBody, &data);
+
+    EXPECT_EQ(data.mismatches, 0);
+    EXPECT_EQ(data.inner_iterations, 500);
+}
+
+TEST_F(LSMRuntimeTest, EmptyRange) {
+    CountData data;
+    data.bad_thread_num = 0;
+    EXPECT_EQ(LSM_Runtime_parallelFor(5, 5, LSM_SCHEDULE_STATIC, 0, 0,
+                                      countIterations, &data), 0);
+}
@@ -0,0 +1,336 @@
+/*
+ * Test program for kernels operating on strided views
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+#include <math.h>                   // for sin, cos
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_boundary_conditions.h"
+#include "lsm_grid.h"
+#include "lsm_spatial_derivatives3d.h"
+#include "lsm_strided_view.h"
+
+/*
+ * Constants
+ */
+#define NX (13)
+#define NY (11)
+#define NZ (9)
+#define NUM_THREADS (3)
+
+static const int TILE_DIMS[3] = {5, 4, 3};
+
+/*
+ * Helper functions
+ */
+
+static LSMLIB_REAL testFunction(int i, int j, int k) {
+    return sin(0.3*i + 0.1*j*j) * cos(0.25*k - 0.05*i*j) + 0.01*i*k;
+}
+
+// interior values stored in C order a[i][j][k] (k varies fastest)
+static LSM_StridedView3d makeCOrderView(std::vector<LSMLIB_REAL> &a) {
+    a.assign(NX*NY*NZ, 0.0);
+    return makeStridedView3d(a.data(), NX, NY, NZ, NY*NZ, NZ, 1);
+}
+
+/*
+ * Tests
+ */
+
+TEST(LSMStridedViewTest, UpwindGradientMatchesPaddedGrid) {
+    int grid_dims[3] = {NX, NY, NZ};
+    LSMLIB_REAL x_lo[3] = {0.0, 0.0, 0.0};
+    LSMLIB_REAL x_hi[3] = {1.3, 1.1, 0.9};
+    Grid *grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, VERY_HIGH);
+    ASSERT_TRUE(grid != NULL);
+
+    // the Grid fillbox depends on the accuracy and need not coincide
+    // with the interior, so the reference uses the interior as fillbox
+    Grid interior = *grid;
+    Grid *g = &interior;
+    int o = (g->grid_dims_ghostbox[0] - NX)/2;
+    g->ilo_fb = o;  g->ihi_fb = o + NX - 1;
+    g->jlo_fb = o;  g->jhi_fb = o + NY - 1;
+    g->klo_fb = o;  g->khi_fb = o + NZ - 1;
+
+    int nx = g->grid_dims_ghostbox[0];
+    int ny = g->grid_dims_ghostbox[1];
+    std::vector<LSMLIB_REAL> phi_padded(g->num_gridpts, 0.0);
+    for (int k = 0; k < NZ; k++) {
+        for (int j = 0; j < NY; j++) {
+            for (int i = 0; i < NX; i++) {
+                int idx = (i + g->ilo_fb) + nx*((j + g->jlo_fb)
+                        + ny*(k + g->klo_fb));
+                phi_padded[idx] = testFunction(i, j, k);
+            }
+        }
+    }
+    linearExtrapolationBC(phi_padded.data(), g, ALL_BOUNDARIES);
+
+    std::vector<LSMLIB_REAL> phi_data;
+    LSM_StridedView3d phi = makeCOrderView(phi_data);
+    for (int i = 0; i < NX; i++) {
+        for (int j = 0; j < NY; j++) {
+            for (int k = 0; k < NZ; k++) {
+                phi_data[(i*NY + j)*NZ + k] = testFunction(i, j, k);
+            }
+        }
+    }
+
+    LSM_ViewBoundary3d bdry;
+    setViewBoundary3d(&bdry, LSM_VIEW_BC_LINEAR_EXTRAPOLATION, 0);
+
+    LSMLIB_SPATIAL_DERIVATIVE_ACCURACY_TYPE accuracies[2] =
+        {MEDIUM, VERY_HIGH};
+    for (int a = 0; a < 2; a++) {
+        std::vector<LSMLIB_REAL> expected[6], D1(g->num_gridpts),
+                                 D2(g->num_gridpts);
+        for (int f = 0; f < 6; f++) expected[f].assign(g->num_gridpts, 0.0);
+        if (accuracies[a] == MEDIUM) {
+            LSM3D_HJ_ENO2(expected[0].data(), expected[1].data(),
+                expected[2].data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                expected[3].data(), expected[4].data(), expected[5].data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                phi_padded.data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                D1.data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                D2.data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+                &(g->klo_fb), &(g->khi_fb),
+                &(g->dx[0]), &(g->dx[1]), &(g->dx[2]));
+        } else {
+            LSM3D_HJ_WENO5(expected[0].data(), expected[1].data(),
+                expected[2].data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                expected[3].data(), expected[4].data(), expected[5].data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                phi_padded.data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                D1.data(),
+                &(g->ilo_gb), &(g->ihi_gb), &(g->jlo_gb), &(g->jhi_gb),
+                &(g->klo_gb), &(g->khi_gb),
+                &(g->ilo_fb), &(g->ihi_fb), &(g->jlo_fb), &(g->jhi_fb),
+                &(g->klo_fb), &(g->khi_fb),
+                &(g->dx[0]), &(g->dx[1]), &(g->dx[2]));
+        }
+
+        std::vector<LSMLIB_REAL> grad_data[6];
+        LSM_StridedView3d grad[6];
+        for (int f = 0; f < 6; f++) grad[f] = makeCOrderView(grad_data[f]);
+        ASSERT_EQ(computeUpwindGradientStridedView3d(
+                      &grad[0], &grad[1], &grad[2],
+                      &grad[3], &grad[4], &grad[5],
+                      &phi, &bdry, accuracies[a],
+                      g->dx[0], g->dx[1], g->dx[2],
+                      TILE_DIMS, NUM_THREADS),
+                  LSM_VIEW_ERR_SUCCESS);
+
+        for (int f = 0; f < 6; f++) {
+            for (int k = 0; k < NZ; k++) {
+                for (int j = 0; j < NY; j++) {
+                    for (int i = 0; i < NX; i++) {
+                        int idx = (i + g->ilo_fb) + nx*((j + g->jlo_fb)
+                                + ny*(k + g->klo_fb));
+                        ASSERT_NEAR(grad_data[f][(i*NY + j)*NZ + k],
+                                    expected[f][idx], 1e-12)
+                            << "accuracy=" << accuracies[a] << " f=" << f
+                            << " (" << i << "," << j << "," << k << ")";
+                    }
+                }
+            }
+        }
+    }
+
+    destroyGrid(grid);
+}
+
+TEST(LSMStridedViewTest, HaloMatchesPeriodic) {
+    int w = 2;
+
+    // phi is a sub-array of a larger Fortran-order array
+    int mx = NX + 4, my = NY + 1;
+    std::vector<LSMLIB_REAL> storage(mx*my*(NZ+1), -99.0);
+    LSM_StridedView3d phi = makeStridedView3d(storage.data() + 1 + mx,
+                                              NX, NY, NZ, 1, mx, mx*my);
+    for (int k = 0; k < NZ; k++) {
+        for (int j = 0; j < NY; j++) {
+            for (int i = 0; i < NX; i++) {
+                phi.data[i + mx*(j + my*k)] = testFunction(i, j, k);
+            }
+        }
+    }
+
+    // halo buffers filled with periodic images
+    std::vector<LSMLIB_REAL> halo[6];
+    halo[0].resize(w*NY*NZ); halo[1].resize(w*NY*NZ);
+    halo[2].resize(NX*w*NZ); halo[3].resize(NX*w*NZ);
+    halo[4].resize(NX*NY*w); halo[5].resize(NX*NY*w);
+    for (int k = 0; k < NZ; k++) {
+        for (int j = 0; j < NY; j++) {
+            for (int h = 0; h < w; h++) {
+                halo[0][h + w*(j + NY*k)] = testFunction(NX - w + h, j, k);
+                halo[1][h + w*(j + NY*k)] = testFunction(h, j, k);
+            }
+        }
+    }
+    for (int k = 0; k < NZ; k++) {
+        for (int h = 0; h < w; h++) {
+            for (int i = 0; i < NX; i++) {
+                halo[2][i + NX*(h + w*k)] = testFunction(i, NY - w + h, k);
+                halo[3][i + NX*(h + w*k)] = testFunction(i, h, k);
+            }
+        }
+    }
+    for (int h = 0; h < w; h++) {
+        for (int j = 0; j < NY; j++) {
+            for (int i = 0; i < NX; i++) {
+                halo[4][i + NX*(j + NY*h)] = testFunction(i, j, NZ - w + h);
+                halo[5][i + NX*(j + NY*h)] = testFunction(i, j, h);
+            }
+        }
+    }
+
+    LSM_ViewBoundary3d periodic, halo_bdry;
+    setViewBoundary3d(&periodic, LSM_VIEW_BC_PERIODIC, 0);
+    setViewBoundary3d(&halo_bdry, LSM_VIEW_BC_HALO, w);
+    for (int f = 0; f < 6; f++) halo_bdry.halo[f] = halo[f].data();
+
+    for (int order = 2; order <= 4; order += 2) {
+        std::vector<LSMLIB_REAL> a_data[3], b_data[3];
+        LSM_StridedView3d a[3], b[3];
+        for (int d = 0; d < 3; d++) {
+            a[d] = makeCOrderView(a_data[d]);
+            b[d] = makeCOrderView(b_data[d]);
+        }
+        ASSERT_EQ(computeCentralGradientStridedView3d(&a[0], &a[1], &a[2],
+                      &phi, &periodic, order, 0.1, 0.1, 0.1,
+                      TILE_DIMS, NUM_THREADS),
+                  LSM_VIEW_ERR_SUCCESS);
+        ASSERT_EQ(computeCentralGradientStridedView3d(&b[0], &b[1], &b[2],
+                      &phi, &halo_bdry, order, 0.1, 0.1, 0.1,
+                      NULL, 1),
+                  LSM_VIEW_ERR_SUCCESS);
+        for (int d = 0; d < 3; d++) {
+            for (int n = 0; n < NX*NY*NZ; n++) {
+                ASSERT_EQ(a_data[d][n], b_data[d][n])
+                    << "order=" << order << " d=" << d << " n=" << n;
+            }
+        }
+
+        // spot check the periodic x-derivative at i = 0
+        LSMLIB_REAL expected = (testFunction(1, 3, 4)
+                             - testFunction(NX-1, 3, 4))/0.2;
+        if (order == 2) {
+            EXPECT_NEAR(a_data[0][(0*NY + 3)*NZ + 4], expected, 1e-12);
+        }
+    }
+
+    // padding of the enclosing array is not modified
+    EXPECT_EQ(storage[0], -99.0);
+    EXPECT_EQ(storage[mx*my*(NZ+1) - 1], -99.0);
+}
+
+TEST(LSMStridedViewTest, TVDRungeKutta) {
+    std::vector<LSMLIB_REAL> u_cur_data, u_stage_data, rhs_data, u_next_data;
+    LSM_StridedView3d u_cur = makeCOrderView(u_cur_data);
+    LSM_StridedView3d u_stage = makeCOrderView(u_stage_data);
+    LSM_StridedView3d rhs = makeCOrderView(rhs_data);
+    LSM_StridedView3d u_next = makeCOrderView(u_next_data);
+    for (int n = 0; n < NX*NY*NZ; n++) {
+        u_cur_data[n] = sin(0.1*n);
+        u_stage_data[n] = cos(0.2*n);
+        rhs_data[n] = 0.01*n;
+    }
+    LSMLIB_REAL dt = 0.3;
+
+    ASSERT_EQ(advanceTVDRKStridedView3d(2, 2, &u_next, &u_stage, &u_cur,
+                                        &rhs, dt, NUM_THREADS),
+              LSM_VIEW_ERR_SUCCESS);
+    for (int n = 0; n < NX*NY*NZ; n++) {
+        ASSERT_DOUBLE_EQ(u_next_data[n],
+            0.5*(u_cur_data[n] + u_stage_data[n] + dt*rhs_data[n]));
+    }
+
+    ASSERT_EQ(advanceTVDRKStridedView3d(3, 2, &u_next, &u_stage, &u_cur,
+                                        &rhs, dt, NUM_THREADS),
+              LSM_VIEW_ERR_SUCCESS);
+    for (int n = 0; n < NX*NY*NZ; n++) {
+        ASSERT_DOUBLE_EQ(u_next_data[n],
+            0.75*u_cur_data[n] + 0.25*(u_stage_data[n] + dt*rhs_data[n]));
+    }
+
+    // in place (u_next = u_cur)
+    std::vector<LSMLIB_REAL> u_ref(u_cur_data);
+    ASSERT_EQ(advanceTVDRKStridedView3d(1, 1, &u_cur, NULL, &u_cur,
+                                        &rhs, dt, NUM_THREADS),
+              LSM_VIEW_ERR_SUCCESS);
+    for (int n = 0; n < NX*NY*NZ; n++) {
+        ASSERT_DOUBLE_EQ(u_cur_data[n], u_ref[n] + dt*rhs_data[n]);
+    }
+}
+
+TEST(LSMStridedViewTest, InvalidArguments) {
+    std::vector<LSMLIB_REAL> phi_data, grad_data, small_data(8);
+    LSM_StridedView3d phi = makeCOrderView(phi_data);
+    LSM_StridedView3d grad = makeCOrderView(grad_data);
+    LSM_StridedView3d small = makeStridedView3d(small_data.data(),
+                                                2, 2, 2, 1, 2, 4);
+    LSM_ViewBoundary3d bdry;
+
+    // dims mismatch
+    setViewBoundary3d(&bdry, LSM_VIEW_BC_COPY_EXTRAPOLATION, 0);
+    EXPECT_EQ(computeCentralGradientStridedView3d(&grad, &grad, &small,
+                  &phi, &bdry, 2, 1.0, 1.0, 1.0, NULL, 1),
+              LSM_VIEW_ERR_INVALID_ARGUMENT);
+
+    // unsupported order
+    EXPECT_EQ(computeCentralGradientStridedView3d(&grad, &grad, &grad,
+                  &phi, &bdry, 3, 1.0, 1.0, 1.0, NULL, 1),
+              LSM_VIEW_ERR_INVALID_ARGUMENT);
+
+    // halo narrower than the stencil
+    setViewBoundary3d(&bdry, LSM_VIEW_BC_HALO, 1);
+    for (int f = 0; f < 6; f++) bdry.halo[f] = small_data.data();
+    EXPECT_EQ(computeUpwindGradientStridedView3d(&grad, &grad, &grad,
+                  &grad, &grad, &grad, &phi, &bdry, MEDIUM,
+                  1.0, 1.0, 1.0, NULL, 1),
+              LSM_VIEW_ERR_INVALID_ARGUMENT);
+
+    // periodic on one face only
+    setViewBoundary3d(&bdry, LSM_VIEW_BC_COPY_EXTRAPOLATION, 0);
+    bdry.type[2] = LSM_VIEW_BC_PERIODIC;
+    EXPECT_EQ(computeCentralGradientStridedView3d(&grad, &grad, &grad,
+                  &phi, &bdry, 2, 1.0, 1.0, 1.0, NULL, 1),
+              LSM_VIEW_ERR_INVALID_ARGUMENT);
+
+    // invalid Runge-Kutta stage
+    EXPECT_EQ(advanceTVDRKStridedView3d(2, 3, &grad, &phi, &phi, &phi,
+                                        0.1, 1),
+              LSM_VIEW_ERR_INVALID_ARGUMENT);
+}
@@ -0,0 +1,303 @@
+/*
+ * Test program for direct geometric reinitialization
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests computeDirectDistanceFunction3d() and
+ * computeDirectDistanceFunction3dLocal() by reinitializing a scaled
+ * level set function for a sphere and comparing the result with the
+ * exact distance function.  It also tests the tetrahedron and triangle
+ * helper functions that the direct reinitialization is built on.
+ */
+
+#include <math.h>                   // for fabs, sqrt
+#include <stdlib.h>                 // for malloc, free
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_NEAR, ...
+
+#include "lsmlib_config.h"
+#include "lsm_direct_reinitialization3d.h"
+#include "lsm_geometry3d.h"
+#include "lsm_grid.h"
+#include "lsm_narrow_band3d.h"
+
+/*
+ * Test fixtures
+ */
+class LSMDirectReinitializationTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {24, 24, 24};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+
+        phi = (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+        dist = (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+        exact = (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+
+        // phi is a scaled (non-distance) level set function for a sphere
+        for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+            for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+                for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                    int idx = index(i, j, k);
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + (i+0.5)*grid->dx[0];
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + (j+0.5)*grid->dx[1];
+                    LSMLIB_REAL z = grid->x_lo_ghostbox[2] + (k+0.5)*grid->dx[2];
+                    exact[idx] = sqrt(x*x + y*y + z*z) - radius;
+                    phi[idx] = 3.0*exact[idx]*(1.0 + x*x);
+                    dist[idx] = 1000.0;
+                }
+            }
+        }
+    }
+
+    void TearDown() override {
+        free(phi);
+        free(dist);
+        free(exact);
+        destroyGrid(grid);
+    }
+
+    // --- Helper functions
+
+    int index(int i, int j, int k) {
+        return i + j*grid->grid_dims_ghostbox[0]
+                 + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+    }
+
+    // --- Data members
+
+    const LSMLIB_REAL radius = 0.5;
+
+    Grid *grid;
+    LSMLIB_REAL *phi;
+    LSMLIB_REAL *dist;
+    LSMLIB_REAL *exact;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMDirectReinitializationTest, DistanceToTriangle) {
+    LSMLIB_REAL v1[3] = {0.0, 0.0, 0.0};
+    LSMLIB_REAL v2[3] = {1.0, 0.0, 0.0};
+    LSMLIB_REAL v3[3] = {0.0, 1.0, 0.0};
+
+    // closest point in interior of triangle
+    LSMLIB_REAL x_face[3] = {0.25, 0.25, 2.0};
+    EXPECT_NEAR(LSM3D_computeDistanceToTriangle(x_face, v1, v2, v3), 2.0,
+                LSMLIB_ZERO_TOL);
+
+    // closest point on edge
+    LSMLIB_REAL x_edge[3] = {1.0, 1.0, 0.0};
+    EXPECT_NEAR(LSM3D_computeDistanceToTriangle(x_edge, v1, v2, v3),
+                sqrt(0.5), LSMLIB_ZERO_TOL);
+
+    // closest point at vertex
+    LSMLIB_REAL x_vertex[3] = {-3.0, -4.0, 0.0};
+    EXPECT_NEAR(LSM3D_computeDistanceToTriangle(x_vertex, v1, v2, v3), 5.0,
+                LSMLIB_ZERO_TOL);
+}
+
+TEST_F(LSMDirectReinitializationTest, CubeTetrahedraFillCube) {
+    // every tetrahedron contains the diagonal from corner 0 to corner 7
+    // and the six tetrahedra have total volume 1 (unit cube)
+    LSMLIB_REAL volume = 0.0;
+    for (int tet = 0; tet < LSM3D_NUM_CUBE_TETRAHEDRA; tet++) {
+        int corners[4];
+        LSMLIB_REAL x[4][3];
+        LSM3D_getCubeTetrahedron(tet, corners);
+        EXPECT_EQ(corners[0], 0);
+        EXPECT_EQ(corners[3], 7);
+        for (int n = 0; n < 4; n++) {
+            for (int d = 0; d < 3; d++) x[n][d] = (corners[n] >> d) & 1;
+        }
+        LSMLIB_REAL a[3], b[3], c[3];
+        for (int d = 0; d < 3; d++) {
+            a[d] = x[1][d] - x[0][d];
+            b[d] = x[2][d] - x[0][d];
+            c[d] = x[3][d] - x[0][d];
+        }
+        volume += fabs(a[0]*(b[1]*c[2] - b[2]*c[1])
+                     - a[1]*(b[0]*c[2] - b[2]*c[0])
+                     + a[2]*(b[0]*c[1] - b[1]*c[0]))/6.0;
+    }
+    EXPECT_NEAR(volume, 1.0, LSMLIB_ZERO_TOL);
+}
+
+TEST_F(LSMDirectReinitializationTest, SphereFillbox) {
+    const int search_radius = 4;
+    ASSERT_EQ(computeDirectDistanceFunction3d(dist, phi, grid,
+                                              search_radius, 0.0),
+              LSM_DIRECT_REINIT_ERR_SUCCESS);
+
+    LSMLIB_REAL band_width = 2.0*grid->dx[0];
+    int num_checked = 0;
+    for (int k = grid->klo_fb; k <= grid->khi_fb; k++) {
+        for (int j = grid->jlo_fb; j <= grid->jhi_fb; j++) {
+            for (int i = grid->ilo_fb; i <= grid->ihi_fb; i++) {
+                int idx = index(i, j, k);
+                EXPECT_GT(dist[idx]*exact[idx], -LSMLIB_ZERO_TOL);
+                if (fabs(exact[idx]) < band_width) {
+                    EXPECT_NEAR(dist[idx], exact[idx], 0.1*grid->dx[0]);
+                    num_checked++;
+                }
+            }
+        }
+    }
+    EXPECT_GT(num_checked, 0);
+
+    // ghostcells are not modified
+    EXPECT_EQ(dist[index(0, 0, 0)], 1000.0);
+}
+
+TEST_F(LSMDirectReinitializationTest, SphereNarrowBandWithCutoff) {
+    // build a single-level narrow band of fillbox points near the sphere
+    int *index_x = (int *) malloc(grid->num_gridpts*sizeof(int));
+    int *index_y = (int *) malloc(grid->num_gridpts*sizeof(int));
+    int *index_z = (int *) malloc(grid->num_gridpts*sizeof(int));
+    int n = 0;
+    for (int k = grid->klo_fb; k <= grid->khi_fb; k++) {
+        for (int j = grid->jlo_fb; j <= grid->jhi_fb; j++) {
+            for (int i = grid->ilo_fb; i <= grid->ihi_fb; i++) {
+                if (fabs(exact[index(i, j, k)]) < 4.0*grid->dx[0]) {
+                    index_x[n] = i; index_y[n] = j; index_z[n] = k;
+                    n++;
+                }
+            }
+        }
+    }
+    int n_lo[1] = {0};
+    int n_hi[1] = {n - 1};
+
+    const LSMLIB_REAL cutoff = 2.0*grid->dx[0];
+    ASSERT_EQ(computeDirectDistanceFunction3dLocal(
+                  dist, phi, grid, index_x, index_y, index_z,
+                  n_lo, n_hi, NULL, 1, 3, cutoff),
+              LSM_DIRECT_REINIT_ERR_SUCCESS);
+
+    for (int m = 0; m < n; m++) {
+        int idx = index(index_x[m], index_y[m], index_z[m]);
+        EXPECT_LE(fabs(dist[idx]), cutoff + LSMLIB_ZERO_TOL);
+        if (fabs(exact[idx]) < cutoff - 0.1*grid->dx[0]) {
+            EXPECT_NEAR(dist[idx], exact[idx], 0.1*grid->dx[0]);
+        } else if (fabs(exact[idx]) > cutoff + 0.1*grid->dx[0]) {
+            EXPECT_NEAR(fabs(dist[idx]), cutoff, LSMLIB_ZERO_TOL);
+        }
+    }
+
+    // points outside of the narrow band are not modified
+    EXPECT_EQ(dist[index(grid->ilo_fb, grid->jlo_fb, grid->klo_fb)], 1000.0);
+
+    // distance_function and phi must be distinct
+    EXPECT_EQ(computeDirectDistanceFunction3dLocal(
+                  phi, phi, grid, index_x, index_y, index_z,
+                  n_lo, n_hi, NULL, 1, 3, cutoff),
+              LSM_DIRECT_REINIT_ERR_INVALID_ARGUMENT);
+
+    free(index_x);
+    free(index_y);
+    free(index_z);
+}
+
+TEST_F(LSMDirectReinitializationTest, OuterLayersFillbox) {
+    // with a search radius of one cell, most of the fillbox is computed
+    // by the outer layer sweeps
+    ASSERT_EQ(computeDirectDistanceFunction3d(dist, phi, grid, 1, 0.0),
+              LSM_DIRECT_REINIT_ERR_SUCCESS);
+
+    LSMLIB_REAL max_err = 0.0;
+    for (int k = grid->klo_fb; k <= grid->khi_fb; k++) {
+        for (int j = grid->jlo_fb; j <= grid->jhi_fb; j++) {
+            for (int i = grid->ilo_fb; i <= grid->ihi_fb; i++) {
+                int idx = index(i, j, k);
+                EXPECT_GT(dist[idx]*exact[idx], 0.0);
+                LSMLIB_REAL err = fabs(dist[idx] - exact[idx]);
+                if (err > max_err) max_err = err;
+            }
+        }
+    }
+    // first-order accurate away from the band (including the kink of
+    // the distance function at the center of the sphere)
+    EXPECT_LT(max_err, grid->dx[0]);
+}
+
+TEST_F(LSMDirectReinitializationTest, OuterLayersNarrowBand) {
+    int n = grid->num_gridpts;
+    int num_levels = 3;
+    unsigned char *narrow_band =
+        (unsigned char *) malloc(n*sizeof(unsigned char));
+    int *index_x = (int *) malloc(n*sizeof(int));
+    int *index_y = (int *) malloc(n*sizeof(int));
+    int *index_z = (int *) malloc(n*sizeof(int));
+    int *index_outer = (int *) malloc(n*sizeof(int));
+    int n_lo[3], n_hi[3];
+    int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+    ASSERT_EQ(determineNarrowBand3d(
+                  exact, narrow_band, index_x, index_y, index_z,
+                  n_lo, n_hi, index_outer, n,
+                  &nlo_outer_plus, &nhi_outer_plus,
+                  &nlo_outer_minus, &nhi_outer_minus,
+                  grid->dx[0], 0.5*grid->dx[0], num_levels - 1, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+
+    // levels 1 and 2 are beyond the search radius of one cell
+    ASSERT_EQ(computeDirectDistanceFunction3dLocal(
+                  dist, phi, grid, index_x, index_y, index_z,
+                  n_lo, n_hi, narrow_band, num_levels, 1, 0.0),
+              LSM_DIRECT_REINIT_ERR_SUCCESS);
+
+    for (int level = 0; level < num_levels; level++) {
+        EXPECT_GE(n_hi[level], n_lo[level]);
+        for (int m = n_lo[level]; m <= n_hi[level]; m++) {
+            int idx = index(index_x[m], index_y[m], index_z[m]);
+            EXPECT_GT(dist[idx]*exact[idx], 0.0) << "m=" << m;
+            EXPECT_NEAR(dist[idx], exact[idx], 0.5*grid->dx[0])
+                << "level=" << level << " m=" << m;
+        }
+    }
+
+    free(narrow_band);
+    free(index_x);
+    free(index_y);
+    free(index_z);
+    free(index_outer);
+}
+
+TEST_F(LSMDirectReinitializationTest, ZeroAtGridPoint) {
+    // phi vanishes only at grid point (i0,j0,k0), where the zero level
+    // set touches the grid cells around it
+    int i0 = 12, j0 = 10, k0 = 11;
+    for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+        for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+            for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                LSMLIB_REAL x = (i - i0)*grid->dx[0];
+                LSMLIB_REAL y = (j - j0)*grid->dx[1];
+                LSMLIB_REAL z = (k - k0)*grid->dx[2];
+                phi[index(i, j, k)] = x*x + y*y + z*z;
+            }
+        }
+    }
+    ASSERT_EQ(computeDirectDistanceFunction3d(dist, phi, grid, 2, 0.0),
+              LSM_DIRECT_REINIT_ERR_SUCCESS);
+
+    EXPECT_EQ(dist[index(i0, j0, k0)], 0.0);
+    EXPECT_NEAR(dist[index(i0+1, j0, k0)], grid->dx[0], LSMLIB_ZERO_TOL);
+    EXPECT_NEAR(dist[index(i0+1, j0-1, k0+1)], sqrt(3.0)*grid->dx[0],
+                LSMLIB_ZERO_TOL);
+}
@@ -0,0 +1,204 @@
+/*
+ * Test program for Anderson acceleration
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that Anderson acceleration speeds up a slowly
+ * converging fixed-point iteration, that it reduces to the plain
+ * iteration for depth 0 and that the narrow band version agrees with
+ * the vector version.
+ */
+
+#include <math.h>                   // for fabs, sin
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_anderson.h"
+#include "lsm_grid.h"
+
+/*
+ * Helper functions
+ */
+
+// Jacobi iteration for -u'' = 1 on (0,1) with u(0) = u(1) = 0
+static void jacobi(const std::vector<LSMLIB_REAL> &x,
+                   std::vector<LSMLIB_REAL> &g) {
+    int n = x.size();
+    LSMLIB_REAL h = 1.0/(n+1);
+    for (int i = 0; i < n; i++) {
+        LSMLIB_REAL left = (i > 0) ? x[i-1] : 0.0;
+        LSMLIB_REAL right = (i < n-1) ? x[i+1] : 0.0;
+        g[i] = 0.5*(left + right + h*h);
+    }
+}
+
+static LSMLIB_REAL maxNormDiff(const std::vector<LSMLIB_REAL> &a,
+                               const std::vector<LSMLIB_REAL> &b) {
+    LSMLIB_REAL err = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (fabs(a[i] - b[i]) > err) err = fabs(a[i] - b[i]);
+    }
+    return err;
+}
+
+// number of iterations until |G(x) - x| < tol (max_iter if not reached)
+static int solve(int depth, int max_iter, LSMLIB_REAL tol,
+                 std::vector<LSMLIB_REAL> &x) {
+    LSM_AndersonAcceleration *acc =
+        createAndersonAcceleration(x.size(), depth, 1.0);
+    EXPECT_TRUE(acc != NULL);
+    std::vector<LSMLIB_REAL> g(x.size());
+    int iter;
+    for (iter = 0; iter < max_iter; iter++) {
+        jacobi(x, g);
+        if (maxNormDiff(x, g) < tol) break;
+        EXPECT_EQ(applyAndersonAcceleration(acc, x.data(), g.data(),
+                                            x.size()),
+                  LSM_ANDERSON_ERR_SUCCESS);
+    }
+    destroyAndersonAcceleration(acc);
+    return iter;
+}
+
+/*
+ * Tests
+ */
+
+TEST(LSMAndersonTest, AcceleratesJacobiIteration) {
+    int n = 20;
+    LSMLIB_REAL tol = 1e-10;
+
+    std::vector<LSMLIB_REAL> x_plain(n, 0.0), x_anderson(n, 0.0);
+    int iter_plain = solve(0, 400, tol, x_plain);
+    int iter_anderson = solve(8, 400, tol, x_anderson);
+
+    EXPECT_EQ(iter_plain, 400);
+    EXPECT_LT(iter_anderson, 100);
+
+    // exact solution u = x(1-x)/2 (second order differences are exact)
+    LSMLIB_REAL h = 1.0/(n+1);
+    for (int i = 0; i < n; i++) {
+        LSMLIB_REAL s = (i+1)*h;
+        EXPECT_NEAR(x_anderson[i], 0.5*s*(1-s), 1e-8) << "i=" << i;
+    }
+}
+
+TEST(LSMAndersonTest, DepthZeroIsPlainIteration) {
+    int n = 10;
+    LSM_AndersonAcceleration *acc = createAndersonAcceleration(n, 0, 0.5);
+    ASSERT_TRUE(acc != NULL);
+
+    std::vector<LSMLIB_REAL> x(n), x_ref(n), g(n);
+    for (int i = 0; i < n; i++) x[i] = x_ref[i] = sin(i + 1.0);
+    for (int iter = 0; iter < 5; iter++) {
+        jacobi(x, g);
+        ASSERT_EQ(applyAndersonAcceleration(acc, x.data(), g.data(), n),
+                  LSM_ANDERSON_ERR_SUCCESS);
+        jacobi(x_ref, g);
+        for (int i = 0; i < n; i++) x_ref[i] += 0.5*(g[i] - x_ref[i]);
+    }
+    EXPECT_LT(maxNormDiff(x, x_ref), 1e-14);
+
+    destroyAndersonAcceleration(acc);
+}
+
+TEST(LSMAndersonTest, LocalMatchesVector) {
+    int grid_dims[3] = {6, 5, 4};
+    LSMLIB_REAL x_lo[3] = {0.0, 0.0, 0.0};
+    LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+    Grid *grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+    ASSERT_TRUE(grid != NULL);
+    int nx = grid->grid_dims_ghostbox[0];
+    int ny = grid->grid_dims_ghostbox[1];
+
+    // "narrow band":  every third grid point
+    std::vector<int> index_x, index_y, index_z, idx;
+    for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+        for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+            for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                int p = (i - grid->ilo_gb)
+                      + nx*((j - grid->jlo_gb) + ny*(k - grid->klo_gb));
+                if (p % 3 == 0) {
+                    index_x.push_back(i);
+                    index_y.push_back(j);
+                    index_z.push_back(k);
+                    idx.push_back(p);
+                }
+            }
+        }
+    }
+    int n = idx.size();
+
+    LSM_AndersonAcceleration *acc =
+        createAndersonAcceleration(grid->num_gridpts, 3, 1.0);
+    LSM_AndersonAcceleration *acc_ref = createAndersonAcceleration(n, 3, 1.0);
+    ASSERT_TRUE(acc != NULL);
+    ASSERT_TRUE(acc_ref != NULL);
+
+    std::vector<LSMLIB_REAL> phi(grid->num_gridpts, -7.0);
+    std::vector<LSMLIB_REAL> phi_g(grid->num_gridpts, 3.0);
+    std::vector<LSMLIB_REAL> x(n), g(n);
+    for (int m = 0; m < n; m++) x[m] = phi[idx[m]] = sin(0.1*m);
+    for (int iter = 0; iter < 8; iter++) {
+        // nonlinear map G(x) = cos(x)
+        for (int m = 0; m < n; m++) {
+            g[m] = phi_g[idx[m]] = cos(x[m]);
+        }
+        ASSERT_EQ(applyAndersonAccelerationLocal3d(
+                      acc, phi.data(), phi_g.data(),
+                      index_x.data(), index_y.data(), index_z.data(),
+                      0, n-1, grid),
+                  LSM_ANDERSON_ERR_SUCCESS);
+        ASSERT_EQ(applyAndersonAcceleration(acc_ref, x.data(), g.data(), n),
+                  LSM_ANDERSON_ERR_SUCCESS);
+        for (int m = 0; m < n; m++) {
+            ASSERT_EQ(phi[idx[m]], x[m]) << "iter=" << iter << " m=" << m;
+        }
+    }
+
+    // points outside of the narrow band are not modified
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        if (p % 3 != 0) EXPECT_EQ(phi[p], -7.0) << "p=" << p;
+    }
+
+    // fixed point of cos
+    for (int m = 0; m < n; m++) EXPECT_NEAR(x[m], 0.739085, 1e-3);
+
+    destroyAndersonAcceleration(acc);
+    destroyAndersonAcceleration(acc_ref);
+    destroyGrid(grid);
+}
+
+TEST(LSMAndersonTest, InvalidArguments) {
+    EXPECT_TRUE(createAndersonAcceleration(0, 2, 1.0) == NULL);
+    EXPECT_TRUE(createAndersonAcceleration(10, -1, 1.0) == NULL);
+    EXPECT_TRUE(createAndersonAcceleration(
+                    10, LSM_ANDERSON_MAX_DEPTH+1, 1.0) == NULL);
+    EXPECT_TRUE(createAndersonAcceleration(10, 2, 0.0) == NULL);
+    EXPECT_TRUE(createAndersonAcceleration(10, 2, 1.5) == NULL);
+
+    LSM_AndersonAcceleration *acc = createAndersonAcceleration(4, 2, 1.0);
+    ASSERT_TRUE(acc != NULL);
+    LSMLIB_REAL x[5] = {0}, g[5] = {0};
+    EXPECT_EQ(applyAndersonAcceleration(acc, x, g, 5),
+              LSM_ANDERSON_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(applyAndersonAcceleration(acc, NULL, g, 4),
+              LSM_ANDERSON_ERR_INVALID_ARGUMENT);
+    EXPECT_EQ(applyAndersonAcceleration(NULL, x, g, 4),
+              LSM_ANDERSON_ERR_INVALID_ARGUMENT);
+    destroyAndersonAcceleration(acc);
+    destroyAndersonAcceleration(NULL);
+}
@@ -0,0 +1,241 @@
+/*
+ * Test program for CSG initialization functions
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that evaluateCSGTree3d() reproduces the level set
+ * functions obtained by combining the full-grid initialization functions
+ * from lsm_initialization3d.h with the macros from lsm_macros.h, both
+ * with and without bounding-box culling.
+ */
+
+#include <math.h>                   // for fabs
+#include <stdlib.h>                 // for malloc, free
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_NEAR, ...
+
+#include "lsmlib_config.h"
+#include "lsm_csg3d.h"
+#include "lsm_grid.h"
+#include "lsm_initialization3d.h"
+#include "lsm_macros.h"
+
+/*
+ * Test fixtures
+ */
+class LSMCSG3DTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {40, 36, 30};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+
+        phi = allocate();
+        phi_ref = allocate();
+        tmp = allocate();
+    }
+
+    void TearDown() override {
+        free(phi);
+        free(phi_ref);
+        free(tmp);
+        destroyGrid(grid);
+    }
+
+    // --- Helper functions
+
+    LSMLIB_REAL *allocate() {
+        return (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+    }
+
+    // check phi against phi_ref; with culling, phi must be exact where
+    // |phi_ref| < band_width and have the correct sign elsewhere
+    void checkResult(LSMLIB_REAL band_width) {
+        int num_exact = 0;
+        for (int idx = 0; idx < grid->num_gridpts; idx++) {
+            if ((band_width <= 0) || (fabs(phi_ref[idx]) < band_width)) {
+                ASSERT_NEAR(phi[idx], phi_ref[idx], 1e-12) << "idx=" << idx;
+                num_exact++;
+            } else {
+                ASSERT_GT(phi[idx]*phi_ref[idx], 0) << "idx=" << idx;
+                ASSERT_GE(fabs(phi[idx]), band_width) << "idx=" << idx;
+            }
+        }
+        EXPECT_GT(num_exact, 0);
+    }
+
+    // --- Data members
+
+    Grid *grid;
+    LSMLIB_REAL *phi;
+    LSMLIB_REAL *phi_ref;
+    LSMLIB_REAL *tmp;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMCSG3DTest, CombinedPrimitives) {
+    // (box minus sphere) union cylinder-in-half-space union polyhedron
+    LSMLIB_REAL normal_x[4] = {1.0, -1.0, 0.0, 0.0};
+    LSMLIB_REAL normal_y[4] = {1.0, 1.0, -1.0, 0.0};
+    LSMLIB_REAL normal_z[4] = {1.0, 0.0, 0.0, -1.0};
+    LSMLIB_REAL point_x[4] = {-0.2, -0.8, -0.8, -0.8};
+    LSMLIB_REAL point_y[4] = {-0.2, -0.8, -0.8, -0.8};
+    LSMLIB_REAL point_z[4] = {-0.2, -0.8, -0.8, -0.8};
+
+    LSM_CSGNode *root = createCSGUnion(
+        createCSGUnion(
+            createCSGDifference(
+                createCSGBox(-0.1, -0.2, -0.3, 0.9, 0.8, 0.7),
+                createCSGSphere(0.4, 0.3, 0.2, 0.35)),
+            createCSGIntersection(
+                createCSGCylinder(0.0, 0.0, 1.0, 0.5, -0.5, 0.0, 0.2),
+                createCSGHalfSpace(0.0, 0.0, 1.0, 0.0, 0.0, 0.25))),
+        createCSGPolyhedron(4, normal_x, normal_y, normal_z,
+                            point_x, point_y, point_z));
+    ASSERT_TRUE(root != NULL);
+    EXPECT_EQ(root->depth, 4);
+
+    // reference solution
+    createBox(phi_ref, -0.1, -0.2, -0.3, 0.9, 0.8, 0.7, -1, grid);
+    createSphere(tmp, 0.4, 0.3, 0.2, 0.35, 1, grid);
+    IMPOSE_MASK(phi_ref, tmp, phi_ref, grid);
+    LSMLIB_REAL *cyl = allocate();
+    createCylinder(cyl, 0.0, 0.0, 1.0, 0.5, -0.5, 0.0, 0.2, -1, grid);
+    createPlane(tmp, 0.0, 0.0, 1.0, 0.0, 0.0, 0.25, grid);
+    IMPOSE_MASK(cyl, tmp, cyl, grid);
+    IMPOSE_MIN(phi_ref, phi_ref, cyl, grid);
+    createPolyhedron3d(tmp, 4, normal_x, normal_y, normal_z,
+                       point_x, point_y, point_z, grid);
+    IMPOSE_MIN(phi_ref, phi_ref, tmp, grid);
+    free(cyl);
+
+    // exact evaluation
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 0.0, grid), LSM_CSG_ERR_SUCCESS);
+    checkResult(0.0);
+
+    // evaluation with culling
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 4*grid->dx[0], grid),
+              LSM_CSG_ERR_SUCCESS);
+    checkResult(4*grid->dx[0]);
+
+    destroyCSGTree(root);
+}
+
+TEST_F(LSMCSG3DTest, ManySpheres) {
+    // union of many small spheres minus a complement (i.e. intersected
+    // with a large sphere)
+    const int num_spheres = 64;
+    LSM_CSGNode *spheres = NULL;
+    for (int l = 0; l < num_spheres; l++) {
+        LSMLIB_REAL cx = -0.8 + 0.2*(l % 8) + 0.01*(l % 3);
+        LSMLIB_REAL cy = -0.8 + 0.2*(l / 8) - 0.01*(l % 5);
+        LSMLIB_REAL cz = -0.5 + 0.125*(l % 7);
+        LSMLIB_REAL r = 0.06 + 0.005*(l % 4);
+        LSM_CSGNode *sphere = createCSGSphere(cx, cy, cz, r);
+
+        createSphere(tmp, cx, cy, cz, r, -1, grid);
+        if (l == 0) {
+            spheres = sphere;
+            COPY_DATA(phi_ref, tmp, grid);
+        } else {
+            spheres = createCSGUnion(spheres, sphere);
+            IMPOSE_MIN(phi_ref, phi_ref, tmp, grid);
+        }
+    }
+    LSM_CSGNode *root = createCSGDifference(
+        spheres, createCSGComplement(createCSGSphere(0.0, 0.0, 0.0, 0.7)));
+    ASSERT_TRUE(root != NULL);
+    createSphere(tmp, 0.0, 0.0, 0.0, 0.7, -1, grid);
+    IMPOSE_MASK(phi_ref, tmp, phi_ref, grid);
+
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 0.0, grid), LSM_CSG_ERR_SUCCESS);
+    checkResult(0.0);
+
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 3*grid->dx[0], grid),
+              LSM_CSG_ERR_SUCCESS);
+    checkResult(3*grid->dx[0]);
+
+    destroyCSGTree(root);
+}
+
+TEST_F(LSMCSG3DTest, ConeAndHyperboloid) {
+    // (cone union hyperboloid) intersected with a box; the axes do not
+    // pass through grid points
+    LSM_CSGNode *root = createCSGIntersection(
+        createCSGUnion(
+            createCSGCone(1.0, 0.5, 2.0, 0.013, -0.021, 0.017, 1.0, 0.4),
+            createCSGHyperboloid(0.0, 1.0, 0.2, -0.31, 0.027, 0.33,
+                                 0.5, 0.2)),
+        createCSGBox(-0.7, -0.8, -0.6, 0.7, 0.7, 0.7));
+    ASSERT_TRUE(root != NULL);
+
+    createCone(phi_ref, 1.0, 0.5, 2.0, 0.013, -0.021, 0.017, 1.0, 0.4,
+               -1, grid);
+    createHyperboloid(tmp, 0.0, 1.0, 0.2, -0.31, 0.027, 0.33, 0.5, 0.2,
+                      -1, grid);
+    IMPOSE_MIN(phi_ref, phi_ref, tmp, grid);
+    createBox(tmp, -0.7, -0.8, -0.6, 0.7, 0.7, 0.7, -1, grid);
+    IMPOSE_MASK(phi_ref, tmp, phi_ref, grid);
+
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 0.0, grid), LSM_CSG_ERR_SUCCESS);
+    checkResult(0.0);
+
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 3*grid->dx[0], grid),
+              LSM_CSG_ERR_SUCCESS);
+    checkResult(3*grid->dx[0]);
+
+    destroyCSGTree(root);
+}
+
+TEST_F(LSMCSG3DTest, SharpPolyhedronCulling) {
+    // thin tetrahedron with a sharp vertex at (0.8, 0, 0); near the
+    // vertex, the level set function is much smaller than the distance
+    // to the polyhedron
+    LSMLIB_REAL normal_x[4] = {0.05, 0.05, 0.05, -1.0};
+    LSMLIB_REAL normal_y[4] = {1.0, -0.5, -0.5, 0.0};
+    LSMLIB_REAL normal_z[4] = {0.0, 0.866, -0.866, 0.0};
+    LSMLIB_REAL point_x[4] = {0.8, 0.8, 0.8, -0.8};
+    LSMLIB_REAL point_y[4] = {0.0, 0.0, 0.0, 0.0};
+    LSMLIB_REAL point_z[4] = {0.0, 0.0, 0.0, 0.0};
+
+    LSM_CSGNode *root = createCSGPolyhedron(4, normal_x, normal_y, normal_z,
+                                            point_x, point_y, point_z);
+    ASSERT_TRUE(root != NULL);
+    createPolyhedron3d(phi_ref, 4, normal_x, normal_y, normal_z,
+                       point_x, point_y, point_z, grid);
+
+    ASSERT_EQ(evaluateCSGTree3d(phi, root, 2*grid->dx[0], grid),
+              LSM_CSG_ERR_SUCCESS);
+    checkResult(2*grid->dx[0]);
+
+    destroyCSGTree(root);
+}
+
+TEST_F(LSMCSG3DTest, InvalidArguments) {
+    // NULL operands are propagated (and the other operand is freed)
+    EXPECT_TRUE(createCSGUnion(createCSGSphere(0, 0, 0, 1), NULL) == NULL);
+    EXPECT_TRUE(createCSGHalfSpace(0, 0, 0, 0, 0, 0) == NULL);
+    EXPECT_TRUE(createCSGCone(0, 0, 0, 0, 0, 0, 1, 1) == NULL);
+    EXPECT_TRUE(createCSGHyperboloid(0, 0, 1, 0, 0, 0, 0, 1) == NULL);
+    EXPECT_TRUE(createCSGPolyhedron(0, NULL, NULL, NULL,
+                                    NULL, NULL, NULL) == NULL);
+    EXPECT_EQ(evaluateCSGTree3d(phi, NULL, 0.0, grid),
+              LSM_CSG_ERR_INVALID_ARGUMENT);
+}
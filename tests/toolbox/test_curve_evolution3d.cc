@@ -0,0 +1,164 @@
+/*
+ * Test program for narrow-band evolution of curves in 3D
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests advanceCurve3d() on curve shortening flow of a
+ * circle represented as the intersection of a plane (phi) and a cylinder
+ * (psi).  The radius of the circle satisfies R(t)^2 = R(0)^2 - 2t.
+ */
+
+#include <math.h>                   // for fabs, sqrt
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_LT, ...
+
+#include "lsmlib_config.h"
+#include "lsm_curve_evolution3d.h"
+#include "lsm_grid.h"
+#include "lsm_runtime.h"
+
+/*
+ * Test fixtures
+ */
+class LSMCurveEvolution3dTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {40, 40, 40};
+        LSMLIB_REAL x_lo[3] = {0.0, 0.0, 0.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, LOW);
+
+        // circle of radius R0 in the plane z = zc centered at a grid point
+        ic = grid->ilo_fb + 20;
+        jc = grid->jlo_fb + 20;
+        kc = grid->klo_fb + 20;
+        LSMLIB_REAL xc = coordinate(0, ic);
+        LSMLIB_REAL yc = coordinate(1, jc);
+        LSMLIB_REAL zc = coordinate(2, kc);
+        int n = grid->num_gridpts;
+        phi.assign(n, 0.0);
+        psi.assign(n, 0.0);
+        plane.assign(n, 0.0);
+        for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+            for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+                for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                    LSMLIB_REAL x = coordinate(0, i) - xc;
+                    LSMLIB_REAL y = coordinate(1, j) - yc;
+                    int idx = index(i, j, k);
+                    phi[idx] = coordinate(2, k) - zc;
+                    psi[idx] = sqrt(x*x + y*y) - R0;
+                    plane[idx] = phi[idx];
+                }
+            }
+        }
+    }
+
+    void TearDown() override {
+        destroyGrid(grid);
+        LSM_Runtime_finalize();
+    }
+
+    // --- Helper functions
+
+    int index(int i, int j, int k) {
+        return i + j*grid->grid_dims_ghostbox[0]
+                 + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+    }
+
+    LSMLIB_REAL coordinate(int dir, int i) {
+        return grid->x_lo_ghostbox[dir] + (i+0.5)*grid->dx[dir];
+    }
+
+    // radius of the circle along the +x axis through its center
+    LSMLIB_REAL radius() {
+        for (int i = ic; i < grid->ihi_fb; i++) {
+            LSMLIB_REAL psi_0 = psi[index(i, jc, kc)];
+            LSMLIB_REAL psi_1 = psi[index(i+1, jc, kc)];
+            if ( (psi_0 <= 0) && (psi_1 > 0) ) {
+                return coordinate(0, i) - coordinate(0, ic)
+                     + grid->dx[0]*psi_0/(psi_0 - psi_1);
+            }
+        }
+        return -1.0;
+    }
+
+    // --- Data members
+
+    const LSMLIB_REAL R0 = 0.3;
+    Grid *grid;
+    int ic, jc, kc;
+    std::vector<LSMLIB_REAL> phi, psi, plane;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMCurveEvolution3dTest, CurveShorteningOfCircle) {
+    LSM_CurveTube3d *tube = createCurveTube3d(grid, 4.0*grid->dx[0],
+                                              3.0*grid->dx[0]);
+    ASSERT_NE(tube, nullptr);
+
+    LSMLIB_REAL dt = 0.1*grid->dx[0]*grid->dx[0];
+    LSMLIB_REAL t_final = 0.02;
+    int num_steps = (int) (t_final/dt + 0.5);
+    for (int step = 0; step < num_steps; step++) {
+        // reinitialize and orthogonalize every 20 steps
+        int num_reinit_steps = (step % 20 == 19) ? 1 : 0;
+        ASSERT_EQ(advanceCurve3d(tube, phi.data(), psi.data(),
+                                 NULL, NULL, NULL, 1.0, dt,
+                                 num_reinit_steps),
+                  LSM_CURVE_EVOLUTION_ERR_SUCCESS);
+
+        // the tube is a small fraction of the grid
+        if (step == 0) {
+            EXPECT_LT(tube->n_hi[0] - tube->n_lo[0] + 1,
+                      grid->num_gridpts/10);
+        }
+    }
+
+    // radius of the circle
+    LSMLIB_REAL R_exact = sqrt(R0*R0 - 2*num_steps*dt);
+    EXPECT_NEAR(radius(), R_exact, 0.2*grid->dx[0]);
+
+    // the plane does not move
+    LSMLIB_REAL max_err = 0.0;
+    for (int m = tube->n_lo[0]; m <= tube->n_hi[0]; m++) {
+        int idx = index(tube->index_x[m], tube->index_y[m],
+                        tube->index_z[m]);
+        max_err = fmax(max_err, fabs(phi[idx] - plane[idx]));
+    }
+    EXPECT_LT(max_err, 0.1*grid->dx[0]);
+
+    destroyCurveTube3d(tube);
+}
+
+TEST_F(LSMCurveEvolution3dTest, InvalidArguments) {
+    EXPECT_EQ(createCurveTube3d(NULL, 0.1, 0.05), nullptr);
+    EXPECT_EQ(createCurveTube3d(grid, 0.1, 0.2), nullptr);
+
+    LSM_CurveTube3d *tube = createCurveTube3d(grid, 0.1, 0.05);
+    ASSERT_NE(tube, nullptr);
+    EXPECT_EQ(buildCurveTube3d(tube, phi.data(), NULL),
+              LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT);
+    ASSERT_EQ(buildCurveTube3d(tube, phi.data(), psi.data()),
+              LSM_CURVE_EVOLUTION_ERR_SUCCESS);
+    EXPECT_EQ(computeCurveVelocity3d(tube, phi.data(), psi.data(),
+                                     phi.data(), NULL, NULL, 1.0),
+              LSM_CURVE_EVOLUTION_ERR_INVALID_ARGUMENT);
+    destroyCurveTube3d(tube);
+}
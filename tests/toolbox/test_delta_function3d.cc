@@ -0,0 +1,284 @@
+/*
+ * Test program for 3D second order delta function
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests surface integrals computed with the second order
+ * accurate 3D delta function (global and narrow band versions).
+ */
+
+#include <math.h>                   // for fabs, log, sqrt, M_PI
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, EXPECT_NEAR, EXPECT_LT, ...
+
+#include "lsmlib_config.h"
+#include "lsm_calculus_toolbox3d.h"
+#include "lsm_calculus_toolbox3d_local.h"
+#include "lsm_grid.h"
+#include "lsm_localization3d.h"
+
+/*
+ * Sphere on a grid with normals computed by central differences
+ */
+struct SphereData {
+    Grid *grid;
+    std::vector<LSMLIB_REAL> phi, F;
+    std::vector<LSMLIB_REAL> norm_x, norm_y, norm_z;
+
+    SphereData(int n, LSMLIB_REAL radius) {
+        int grid_dims[3] = {n, n, n};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+
+        int nx = grid->grid_dims_ghostbox[0];
+        int ny = grid->grid_dims_ghostbox[1];
+        int nz = grid->grid_dims_ghostbox[2];
+        LSMLIB_REAL dx = grid->dx[0];
+        phi.resize(grid->num_gridpts);
+        F.resize(grid->num_gridpts);
+        norm_x.assign(grid->num_gridpts, 0.0);
+        norm_y.assign(grid->num_gridpts, 0.0);
+        norm_z.assign(grid->num_gridpts, 0.0);
+        for (int k = 0; k < nz; k++) {
+            for (int j = 0; j < ny; j++) {
+                for (int i = 0; i < nx; i++) {
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*dx - 0.03;
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*dx + 0.02;
+                    LSMLIB_REAL z = grid->x_lo_ghostbox[2] + k*dx - 0.01;
+                    int idx = i + nx*(j + ny*k);
+                    phi[idx] = sqrt(x*x + y*y + z*z) - radius;
+                    F[idx] = 1.0 + z;
+                }
+            }
+        }
+        for (int k = 1; k < nz-1; k++) {
+            for (int j = 1; j < ny-1; j++) {
+                for (int i = 1; i < nx-1; i++) {
+                    int idx = i + nx*(j + ny*k);
+                    LSMLIB_REAL gx = phi[idx+1] - phi[idx-1];
+                    LSMLIB_REAL gy = phi[idx+nx] - phi[idx-nx];
+                    LSMLIB_REAL gz = phi[idx+nx*ny] - phi[idx-nx*ny];
+                    LSMLIB_REAL g = sqrt(gx*gx + gy*gy + gz*gz);
+                    norm_x[idx] = gx/g;
+                    norm_y[idx] = gy/g;
+                    norm_z[idx] = gz/g;
+                }
+            }
+        }
+    }
+
+    ~SphereData() { destroyGrid(grid); }
+
+    LSMLIB_REAL area() {
+        LSMLIB_REAL area;
+        LSM3D_SURFACE_AREA_DELTA_ORDER2(
+            &area, phi.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            norm_x.data(), norm_y.data(), norm_z.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            &grid->ilo_fb, &grid->ihi_fb, &grid->jlo_fb, &grid->jhi_fb,
+            &grid->klo_fb, &grid->khi_fb,
+            &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+        return area;
+    }
+
+    LSMLIB_REAL areaOrder1() {
+        std::vector<LSMLIB_REAL> delta(grid->num_gridpts, 0.0);
+        LSM3D_DELTA_FUNCTION_ORDER1(
+            phi.data(), delta.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            norm_x.data(), norm_y.data(), norm_z.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            &grid->ilo_fb, &grid->ihi_fb, &grid->jlo_fb, &grid->jhi_fb,
+            &grid->klo_fb, &grid->khi_fb,
+            &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+        LSMLIB_REAL area = 0.0;
+        for (size_t idx = 0; idx < delta.size(); idx++) area += delta[idx];
+        return area*grid->dx[0]*grid->dx[1]*grid->dx[2];
+    }
+};
+
+/*
+ * Tests
+ */
+
+TEST(LSMDeltaFunction3DTest, SecondOrderSurfaceArea) {
+    const LSMLIB_REAL radius = 0.5;
+    const LSMLIB_REAL exact = 4.0*M_PI*radius*radius;
+
+    SphereData coarse(20, radius);
+    SphereData fine(40, radius);
+    LSMLIB_REAL err_coarse = fabs(coarse.area() - exact);
+    LSMLIB_REAL err_fine = fabs(fine.area() - exact);
+
+    // second order is more accurate than first order on the coarse grid
+    EXPECT_LT(err_coarse, fabs(coarse.areaOrder1() - exact));
+    EXPECT_LT(err_coarse/exact, 0.01);
+
+    // convergence rate
+    EXPECT_GT(log(err_coarse/err_fine)/log(2.0), 1.5);
+}
+
+TEST(LSMDeltaFunction3DTest, LocalMatchesGlobal) {
+    SphereData sphere(24, 0.5);
+    Grid *grid = sphere.grid;
+    int n = grid->num_gridpts;
+
+    // global delta function and surface integral
+    std::vector<LSMLIB_REAL> delta(n, 0.0);
+    LSM3D_DELTA_FUNCTION_ORDER2(
+        sphere.phi.data(), delta.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.norm_x.data(), sphere.norm_y.data(), sphere.norm_z.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->ilo_fb, &grid->ihi_fb, &grid->jlo_fb, &grid->jhi_fb,
+        &grid->klo_fb, &grid->khi_fb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+    LSMLIB_REAL int_F;
+    LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2(
+        &int_F, sphere.F.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.norm_x.data(), sphere.norm_y.data(), sphere.norm_z.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->ilo_fb, &grid->ihi_fb, &grid->jlo_fb, &grid->jhi_fb,
+        &grid->klo_fb, &grid->khi_fb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+
+    LSMLIB_REAL sum_F_delta = 0.0;
+    for (int idx = 0; idx < n; idx++) {
+        sum_F_delta += sphere.F[idx]*delta[idx];
+    }
+    EXPECT_NEAR(int_F,
+                sum_F_delta*grid->dx[0]*grid->dx[1]*grid->dx[2], 1e-12);
+
+    // narrow band
+    int level = 0;
+    std::vector<unsigned char> narrow_band(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n), index_outer(n);
+    int n_lo[1], n_hi[1];
+    int nlo_index = 0, nhi_index = n - 1;
+    int nlo_index_outer = 0, nhi_index_outer = n - 1;
+    int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+    LSMLIB_REAL width = 2.0*grid->dx[0], width_inner = grid->dx[0];
+    LSM3D_DETERMINE_NARROW_BAND(
+        sphere.phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &nlo_index, &nhi_index, n_lo, n_hi,
+        index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &nlo_outer_plus, &nhi_outer_plus,
+        &nlo_outer_minus, &nhi_outer_minus,
+        &width, &width_inner, &level);
+    unsigned char mark_fb = LSM_NB_MARK_FB;
+
+    std::vector<LSMLIB_REAL> delta_local(n, 0.0);
+    LSM3D_DELTA_FUNCTION_ORDER2_LOCAL(
+        delta_local.data(), sphere.phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.norm_x.data(), sphere.norm_y.data(), sphere.norm_z.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0],
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &mark_fb);
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(delta_local[idx], delta[idx]) << "idx=" << idx;
+    }
+
+    LSMLIB_REAL int_F_local, area_local;
+    LSM3D_SURFACE_INTEGRAL_DELTA_ORDER2_LOCAL(
+        &int_F_local, sphere.F.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.norm_x.data(), sphere.norm_y.data(), sphere.norm_z.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0],
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &mark_fb);
+    LSM3D_SURFACE_AREA_DELTA_ORDER2_LOCAL(
+        &area_local, sphere.phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        sphere.norm_x.data(), sphere.norm_y.data(), sphere.norm_z.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0],
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        &mark_fb);
+
+    EXPECT_NEAR(int_F_local, int_F, 1e-10);
+    EXPECT_NEAR(area_local, sphere.area(), 1e-10);
+}
+
+TEST(LSMDeltaFunction3DTest, FirstOrderPlaneNormalToZ) {
+    // plane z = z0 with unit normal (0, 0, 1); the area inside the fillbox
+    // is only picked up by the z-direction terms of the delta function
+    SphereData plane(16, 0.5);
+    Grid *grid = plane.grid;
+    int nx = grid->grid_dims_ghostbox[0];
+    int ny = grid->grid_dims_ghostbox[1];
+    int nz = grid->grid_dims_ghostbox[2];
+    LSMLIB_REAL dz = grid->dx[2];
+    for (int k = 0; k < nz; k++) {
+        for (int j = 0; j < ny; j++) {
+            for (int i = 0; i < nx; i++) {
+                int idx = i + nx*(j + ny*k);
+                plane.phi[idx] = grid->x_lo_ghostbox[2] + k*dz - 0.013;
+                plane.norm_x[idx] = 0.0;
+                plane.norm_y[idx] = 0.0;
+                plane.norm_z[idx] = 1.0;
+            }
+        }
+    }
+
+    // exact area of the plane inside the fillbox [-1,1]^2
+    LSMLIB_REAL exact = (grid->x_hi[0] - grid->x_lo[0])
+                      * (grid->x_hi[1] - grid->x_lo[1]);
+    EXPECT_NEAR(plane.areaOrder1(), exact, 1e-10);
+    EXPECT_NEAR(plane.area(), exact, 1e-10);
+}
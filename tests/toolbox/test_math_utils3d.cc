@@ -0,0 +1,91 @@
+/*
+ * Test program for reductions in the 3d math utilities
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that the volume integrals are accumulated with
+ * compensated summation.  The integrand is one everywhere except at the
+ * first and last grid points, where it is +big and -big with big large
+ * enough that adding one to big is not exact.  Naive summation loses
+ * all of the ones; compensated summation recovers the exact integral.
+ */
+
+#include <limits>                   // for numeric_limits
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_math_utils3d.h"
+
+/*
+ * Test fixtures
+ */
+class LSMMathUtils3dTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int n = grid_dims[0]*grid_dims[1]*grid_dims[2];
+        LSMLIB_REAL big = 2/std::numeric_limits<LSMLIB_REAL>::epsilon();
+
+        F.assign(n, 1.0);
+        F[0] = big;
+        F[n-1] = -big;
+        phi.assign(n, -1.0);
+        control_vol.assign(n, 1.0);
+        int_F_expected = n - 2;
+    }
+
+    // --- Data members
+
+    int grid_dims[3] = {10, 10, 10};
+    int ilo = 0, ihi = 9;
+    LSMLIB_REAL dx = 1.0;
+    LSMLIB_REAL epsilon = 0.5;
+
+    std::vector<LSMLIB_REAL> F, phi, control_vol;
+    LSMLIB_REAL int_F_expected;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMMathUtils3dTest, VolumeIntegralIsCompensated) {
+    LSMLIB_REAL int_F = 0.0;
+    LSM3D_VOLUME_INTEGRAL_PHI_LESS_THAN_ZERO(
+        &int_F,
+        F.data(), &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        phi.data(), &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        &dx, &dx, &dx,
+        &epsilon);
+    EXPECT_EQ(int_F, int_F_expected);
+}
+
+TEST_F(LSMMathUtils3dTest, ControlVolumeIntegralIsCompensated) {
+    LSMLIB_REAL int_F = 0.0;
+    int control_vol_sgn = 1;
+    LSM3D_VOLUME_INTEGRAL_PHI_LESS_THAN_ZERO_CONTROL_VOLUME(
+        &int_F,
+        F.data(), &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        phi.data(), &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        control_vol.data(), &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        &control_vol_sgn,
+        &ilo, &ihi, &ilo, &ihi, &ilo, &ihi,
+        &dx, &dx, &dx,
+        &epsilon);
+    EXPECT_EQ(int_F, int_F_expected);
+}
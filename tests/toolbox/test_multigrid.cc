@@ -0,0 +1,233 @@
+/*
+ * Test program for the multigrid solver and the heat method
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that the multigrid solver recovers fields from
+ * their images under the (Dirichlet, Neumann and masked) operators in
+ * a grid-independent number of iterations and independently of the
+ * number of threads, and that the heat method approximates the distance
+ * function of a sphere and a circle.
+ */
+
+#include <math.h>                   // for cos, fabs, sin, sqrt
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+#include "lsm_multigrid.h"
+#include "lsm_runtime.h"
+
+/*
+ * Helper functions
+ */
+
+static Grid *createTestGrid(int num_dims, LSMLIB_REAL dx) {
+    LSMLIB_REAL x_lo[3] = {-1, -1, -1}, x_hi[3] = {1, 1, 1};
+    return createGridSetDx(num_dims, dx, x_lo, x_hi, LOW);
+}
+
+// evaluates f(x, y, z) at the grid points
+template <typename F>
+static std::vector<LSMLIB_REAL> sample(Grid *grid, F f) {
+    int nz = (grid->num_dims == 3) ? grid->grid_dims_ghostbox[2] : 1;
+    const int *dims = grid->grid_dims_ghostbox;
+    std::vector<LSMLIB_REAL> values(grid->num_gridpts);
+    for (int k = 0; k < nz; k++) {
+        for (int j = 0; j < dims[1]; j++) {
+            for (int i = 0; i < dims[0]; i++) {
+                LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*grid->dx[0];
+                LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*grid->dx[1];
+                LSMLIB_REAL z = (grid->num_dims == 3)
+                              ? grid->x_lo_ghostbox[2] + k*grid->dx[2] : 0;
+                values[i + dims[0]*(j + dims[1]*k)] = f(x, y, z);
+            }
+        }
+    }
+    return values;
+}
+
+static LSMLIB_REAL smoothField(LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL z) {
+    return sin(2*x + 1)*cos(3*y) + 0.5*x*z;
+}
+
+// solves A u = A u_exact from u = 0 and returns max |u - u_exact|
+static LSMLIB_REAL recoverField(LSM_MultigridSolver *solver,
+                                const std::vector<LSMLIB_REAL> &u_exact,
+                                std::vector<LSMLIB_REAL> &u) {
+    std::vector<LSMLIB_REAL> f(u_exact.size());
+    applyMultigridOperator(solver, f.data(), u_exact.data());
+    u.assign(u_exact.size(), 0.0);
+    EXPECT_EQ(solveMultigrid(solver, u.data(), f.data()),
+              LSM_MULTIGRID_ERR_SUCCESS);
+    LSMLIB_REAL err = 0.0;
+    for (size_t p = 0; p < u.size(); p++) {
+        err = fmax(err, fabs(u[p] - u_exact[p]));
+    }
+    return err;
+}
+
+/*
+ * Tests
+ */
+
+TEST(LSMMultigrid, DirichletPoisson) {
+    int num_iterations[2];
+    LSMLIB_REAL dx[2] = {0.1, 0.05};
+    for (int n = 0; n < 2; n++) {
+        Grid *grid = createTestGrid(3, dx[n]);
+        LSM_MultigridSolver *solver = createMultigridSolver(
+            grid, 0.0, 1.0, NULL, LSM_MULTIGRID_DIRICHLET);
+        ASSERT_NE(solver, nullptr);
+        EXPECT_GT(solver->num_levels, 2);
+
+        std::vector<LSMLIB_REAL> u_exact = sample(grid, smoothField), u;
+        EXPECT_LT(recoverField(solver, u_exact, u), 1e-6);
+        EXPECT_LE(solver->residual_norm, solver->tolerance);
+        num_iterations[n] = solver->num_iterations;
+
+        destroyMultigridSolver(solver);
+        destroyGrid(grid);
+    }
+
+    // the number of iterations does not grow with the grid size
+    EXPECT_LT(num_iterations[0], 25);
+    EXPECT_LE(num_iterations[1], num_iterations[0] + 3);
+}
+
+TEST(LSMMultigrid, SingularNeumannPoisson) {
+    Grid *grid = createTestGrid(2, 0.02);
+    LSM_MultigridSolver *solver = createMultigridSolver(
+        grid, 0.0, 2.0, NULL, LSM_MULTIGRID_NEUMANN);
+    ASSERT_NE(solver, nullptr);
+    EXPECT_TRUE(solver->is_singular);
+
+    // solution with zero mean
+    std::vector<LSMLIB_REAL> u_exact = sample(grid, smoothField), u;
+    LSMLIB_REAL mean = 0.0;
+    for (LSMLIB_REAL v : u_exact) mean += v;
+    mean /= u_exact.size();
+    for (LSMLIB_REAL &v : u_exact) v -= mean;
+    EXPECT_LT(recoverField(solver, u_exact, u), 1e-6);
+    EXPECT_LT(solver->num_iterations, 25);
+
+    destroyMultigridSolver(solver);
+    destroyGrid(grid);
+}
+
+TEST(LSMMultigrid, MaskedHelmholtz) {
+    Grid *grid = createTestGrid(3, 0.05);
+    std::vector<LSMLIB_REAL> mask = sample(grid,
+        [](LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL z) {
+            return 0.8 - sqrt(x*x + y*y + z*z);
+        });
+    LSM_MultigridSolver *solver = createMultigridSolver(
+        grid, 1.0, 0.1, mask.data(), LSM_MULTIGRID_DIRICHLET);
+    ASSERT_NE(solver, nullptr);
+
+    // grid points without coupling to the domain are not unknowns
+    std::vector<LSMLIB_REAL> u_exact = sample(grid, smoothField), u;
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        if (solver->levels[0].diag[p] <= 0) u_exact[p] = 0.0;
+    }
+    EXPECT_LT(recoverField(solver, u_exact, u), 1e-6);
+    EXPECT_LT(solver->num_iterations, 25);
+    EXPECT_EQ(u[0], 0.0);
+
+    destroyMultigridSolver(solver);
+    destroyGrid(grid);
+}
+
+TEST(LSMMultigrid, IndependentOfNumThreads) {
+    Grid *grid = createTestGrid(3, 0.05);
+    std::vector<LSMLIB_REAL> u_exact = sample(grid, smoothField);
+    std::vector<LSMLIB_REAL> u[2];
+    int num_threads[2] = {1, 4};
+    for (int n = 0; n < 2; n++) {
+        LSM_Runtime_initialize(num_threads[n], LSM_AFFINITY_NONE);
+        LSM_MultigridSolver *solver = createMultigridSolver(
+            grid, 0.0, 1.0, NULL, LSM_MULTIGRID_DIRICHLET);
+        ASSERT_NE(solver, nullptr);
+        recoverField(solver, u_exact, u[n]);
+        destroyMultigridSolver(solver);
+    }
+    LSM_Runtime_finalize();
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        ASSERT_EQ(u[0][p], u[1][p]) << "p=" << p;
+    }
+
+    destroyGrid(grid);
+}
+
+TEST(LSMMultigrid, HeatMethodSphere) {
+    Grid *grid = createTestGrid(3, 0.05);
+    std::vector<LSMLIB_REAL> exact = sample(grid,
+        [](LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL z) {
+            return sqrt(x*x + y*y + z*z) - 0.5;
+        });
+    std::vector<LSMLIB_REAL> distance(grid->num_gridpts);
+    ASSERT_EQ(computeDistanceFunctionHeatMethod(distance.data(),
+                                                exact.data(), NULL, grid),
+              LSM_MULTIGRID_ERR_SUCCESS);
+
+    LSMLIB_REAL err_near = 0.0, err = 0.0;
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        ASSERT_EQ(distance[p] < 0, exact[p] < 0) << "p=" << p;
+        LSMLIB_REAL e = fabs(distance[p] - exact[p]);
+        err = fmax(err, e);
+        if (fabs(exact[p]) < 0.25) err_near = fmax(err_near, e);
+    }
+    EXPECT_LT(err_near, 1.5*grid->dx[0]);
+    EXPECT_LT(err, 0.2);
+
+    destroyGrid(grid);
+}
+
+TEST(LSMMultigrid, HeatMethodCircleWithMask) {
+    Grid *grid = createTestGrid(2, 0.02);
+    std::vector<LSMLIB_REAL> exact = sample(grid,
+        [](LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL) {
+            return sqrt(x*x + y*y) - 0.4;
+        });
+    // the domain excludes a corner far from the circle
+    std::vector<LSMLIB_REAL> mask = sample(grid,
+        [](LSMLIB_REAL x, LSMLIB_REAL y, LSMLIB_REAL) {
+            return 1.4 - x - y;
+        });
+    std::vector<LSMLIB_REAL> distance(grid->num_gridpts);
+    ASSERT_EQ(computeDistanceFunctionHeatMethod(distance.data(),
+                                                exact.data(), mask.data(),
+                                                grid),
+              LSM_MULTIGRID_ERR_SUCCESS);
+
+    LSMLIB_REAL err_near = 0.0;
+    for (int p = 0; p < grid->num_gridpts; p++) {
+        if (mask[p] < 0) {
+            ASSERT_EQ(distance[p], 0.0);
+        } else if (fabs(exact[p]) < 0.2) {
+            err_near = fmax(err_near, fabs(distance[p] - exact[p]));
+        }
+    }
+    EXPECT_LT(err_near, 2*grid->dx[0]);
+
+    // no interface
+    std::vector<LSMLIB_REAL> positive(grid->num_gridpts, 1.0);
+    EXPECT_EQ(computeDistanceFunctionHeatMethod(distance.data(),
+                                                positive.data(), NULL, grid),
+              LSM_MULTIGRID_ERR_INVALID_ARGUMENT);
+
+    destroyGrid(grid);
+}
@@ -0,0 +1,203 @@
+/*
+ * Test program for multirate local time stepping
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests binNarrowBandByStableDt3d() and advanceMultirate3d()
+ * on the advection equation phi_t + c(x) phi_x = 0 with a speed that is
+ * large in a thin slab (which limits the global time step), discretized
+ * by first-order upwind differences.  The multirate solution is compared
+ * with global time stepping.
+ */
+
+#include <math.h>                   // for fabs, sin, M_PI
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_LT, ...
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+#include "lsm_multirate3d.h"
+
+/*
+ * Test fixtures
+ */
+class LSMMultirate3dTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {80, 2, 2};
+        LSMLIB_REAL x_lo[3] = {0.0, 0.0, 0.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 0.025, 0.025};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, LOW);
+
+        int n = grid->num_gridpts;
+        speed.assign(n, 1.0);
+        dt_local.assign(n, 0.0);
+        phi0.assign(n, 0.0);
+        narrow_band.assign(n, 0);
+
+        // narrow band:  all points with an upwind neighbor
+        for (int k = grid->klo_gb; k <= grid->khi_gb; k++) {
+            for (int j = grid->jlo_gb; j <= grid->jhi_gb; j++) {
+                for (int i = grid->ilo_gb; i <= grid->ihi_gb; i++) {
+                    int idx = index(i, j, k);
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0]
+                                  + (i+0.5)*grid->dx[0];
+                    phi0[idx] = sin(2*M_PI*x);
+                    if ( (x > 0.6) && (x < 0.62) ) speed[idx] = 8.0;
+                    dt_local[idx] = 0.5*grid->dx[0]/speed[idx];
+                    if (i > grid->ilo_gb) {
+                        index_x.push_back(i);
+                        index_y.push_back(j);
+                        index_z.push_back(k);
+                    }
+                }
+            }
+        }
+    }
+
+    void TearDown() override {
+        destroyGrid(grid);
+    }
+
+    // --- Helper functions
+
+    int index(int i, int j, int k) {
+        return i + j*grid->grid_dims_ghostbox[0]
+                 + k*grid->grid_dims_ghostbox[0]*grid->grid_dims_ghostbox[1];
+    }
+
+    // first-order upwind discretization of -c(x) phi_x
+    static void computeAdvectionRHS(
+        LSMLIB_REAL *lse_rhs, const LSMLIB_REAL *phi,
+        const int *index_x, const int *index_y, const int *index_z,
+        int nlo_index, int nhi_index, LSMLIB_REAL, void *user_data) {
+        LSMMultirate3dTest *test = (LSMMultirate3dTest *) user_data;
+        for (int m = nlo_index; m <= nhi_index; m++) {
+            int idx = test->index(index_x[m], index_y[m], index_z[m]);
+            lse_rhs[idx] = -test->speed[idx]*(phi[idx] - phi[idx-1])
+                         / test->grid->dx[0];
+        }
+    }
+
+    // advances phi0 to time t_final and returns the number of point RHS
+    // evaluations
+    long advance(std::vector<LSMLIB_REAL> &phi, int order, int max_num_bins,
+                 LSMLIB_REAL t_final) {
+        LSM_MultirateStepper3d *stepper =
+            createMultirateStepper3d(grid, order);
+        EXPECT_NE(stepper, nullptr);
+        EXPECT_EQ(binNarrowBandByStableDt3d(
+                      stepper, dt_local.data(), index_x.data(),
+                      index_y.data(), index_z.data(), 0,
+                      (int) index_x.size() - 1, max_num_bins),
+                  LSM_MULTIRATE_ERR_SUCCESS);
+        num_bins = stepper->num_bins;
+
+        phi = phi0;
+        long num_rhs_points = 0;
+        LSMLIB_REAL t = 0.0;
+        while (t < t_final - 1e-12) {
+            EXPECT_EQ(advanceMultirate3d(stepper, phi.data(), t,
+                                         computeAdvectionRHS, this,
+                                         narrow_band.data(), 0),
+                      LSM_MULTIRATE_ERR_SUCCESS);
+            t += stepper->dt_macro;
+            num_rhs_points += stepper->num_rhs_points;
+        }
+        EXPECT_NEAR(t, t_final, 1e-12);
+        destroyMultirateStepper3d(stepper);
+        return num_rhs_points;
+    }
+
+    // --- Data members
+
+    Grid *grid;
+    std::vector<LSMLIB_REAL> speed, dt_local, phi0;
+    std::vector<unsigned char> narrow_band;
+    std::vector<int> index_x, index_y, index_z;
+    int num_bins;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMMultirate3dTest, Binning) {
+    LSM_MultirateStepper3d *stepper = createMultirateStepper3d(grid, 2);
+    ASSERT_NE(stepper, nullptr);
+    ASSERT_EQ(binNarrowBandByStableDt3d(
+                  stepper, dt_local.data(), index_x.data(), index_y.data(),
+                  index_z.data(), 0, (int) index_x.size() - 1, 8),
+              LSM_MULTIRATE_ERR_SUCCESS);
+
+    // the slab is in bin 0 and the bins are graded towards bin 3
+    EXPECT_EQ(stepper->num_bins, 4);
+    EXPECT_EQ(stepper->dt_min, 0.5*grid->dx[0]/8.0);
+    EXPECT_EQ(stepper->num_points, (int) index_x.size());
+    for (int b = 0; b < stepper->num_bins; b++) {
+        for (int m = stepper->bin_lo[b]; m <= stepper->bin_hi[b]; m++) {
+            int i = stepper->index_x[m];
+            int idx = index(i, stepper->index_y[m], stepper->index_z[m]);
+            EXPECT_EQ(stepper->bin[idx], b);
+            EXPECT_LE(stepper->dt_min*(1 << b), dt_local[idx]);
+            if (i > grid->ilo_gb + 1) {
+                EXPECT_LE(abs(stepper->bin[idx] - stepper->bin[idx-1]), 1);
+            }
+        }
+    }
+    EXPECT_LT(stepper->bin_hi[0] - stepper->bin_lo[0] + 1,
+              (int) index_x.size()/20);
+
+    // invalid local time step
+    dt_local[index(index_x[0], index_y[0], index_z[0])] = 0.0;
+    EXPECT_EQ(binNarrowBandByStableDt3d(
+                  stepper, dt_local.data(), index_x.data(), index_y.data(),
+                  index_z.data(), 0, (int) index_x.size() - 1, 8),
+              LSM_MULTIRATE_ERR_INVALID_ARGUMENT);
+    destroyMultirateStepper3d(stepper);
+
+    // third-order Runge-Kutta is not supported
+    EXPECT_EQ(createMultirateStepper3d(grid, 3), nullptr);
+}
+
+TEST_F(LSMMultirate3dTest, AgreesWithGlobalTimeStepping) {
+    for (int order = 1; order <= 2; order++) {
+        std::vector<LSMLIB_REAL> phi_global, phi_multirate;
+        LSMLIB_REAL t_final = 0.25;
+        long work_global = advance(phi_global, order, 1, t_final);
+        EXPECT_EQ(num_bins, 1);
+        long work_multirate = advance(phi_multirate, order, 8, t_final);
+        EXPECT_EQ(num_bins, 4);
+
+        // much less work, same solution up to the time stepping error
+        // (for forward Euler, the numerical diffusion of the upwind scheme
+        // depends on the Courant number, which is 8 times larger in most
+        // of the multirate narrow band)
+        LSMLIB_REAL tol = (order == 1) ? 0.05 : 0.02;
+        EXPECT_LT(work_multirate, work_global/3);
+        LSMLIB_REAL diff = 0.0, max_phi = 0.0;
+        for (size_t m = 0; m < index_x.size(); m++) {
+            int idx = index(index_x[m], index_y[m], index_z[m]);
+            diff = fmax(diff, fabs(phi_multirate[idx] - phi_global[idx]));
+            max_phi = fmax(max_phi, fabs(phi_multirate[idx]));
+        }
+        EXPECT_LT(diff, tol) << "order=" << order;
+
+        // no spurious oscillations (the upwind scheme is monotone)
+        EXPECT_LE(max_phi, 1.0 + 1e-12) << "order=" << order;
+    }
+}
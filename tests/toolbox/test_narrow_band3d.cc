@@ -0,0 +1,535 @@
+/*
+ * Test program for threaded 3D narrow band construction
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that determineNarrowBand3d() produces the same
+ * narrow band as LSM3D_DETERMINE_NARROW_BAND(), that its boundary layer
+ * bits agree with LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER() and that its
+ * result does not depend on the number of threads.  It also tests that
+ * determineNarrowBandFromTwoLevelSets3d() produces the same narrow band
+ * as LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS() and that
+ * sortNarrowBand3d() only reorders the points of each level.
+ */
+
+#include <math.h>                   // for sqrt
+#include <stdio.h>                  // for remove
+#include <stdlib.h>                 // for malloc, free
+#include <stdint.h>                 // for uint64_t
+#include <algorithm>                // for sort
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_file.h"
+#include "lsm_grid.h"
+#include "lsm_localization3d.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_runtime.h"
+
+/*
+ * Narrow band data
+ */
+struct NarrowBand {
+    std::vector<unsigned char> narrow_band;
+    std::vector<int> index_x, index_y, index_z;
+    std::vector<int> n_lo, n_hi;
+    std::vector<int> index_outer;
+    int nlo_outer_plus, nhi_outer_plus;
+    int nlo_outer_minus, nhi_outer_minus;
+
+    NarrowBand(int num_gridpts, int level)
+        : narrow_band(num_gridpts, 255), index_x(num_gridpts),
+          index_y(num_gridpts), index_z(num_gridpts),
+          n_lo(level+1), n_hi(level+1), index_outer(num_gridpts) {}
+};
+
+/*
+ * Test fixtures
+ */
+class LSMNarrowBand3DTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {30, 26, 34};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+
+        // two overlapping spheres (not a distance function everywhere)
+        phi = (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+        int nx = grid->grid_dims_ghostbox[0];
+        int ny = grid->grid_dims_ghostbox[1];
+        int nz = grid->grid_dims_ghostbox[2];
+        for (int k = 0; k < nz; k++) {
+            for (int j = 0; j < ny; j++) {
+                for (int i = 0; i < nx; i++) {
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*grid->dx[0];
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*grid->dx[1];
+                    LSMLIB_REAL z = grid->x_lo_ghostbox[2] + k*grid->dx[2];
+                    LSMLIB_REAL d1 = sqrt((x-0.3)*(x-0.3) + y*y + z*z) - 0.4;
+                    LSMLIB_REAL d2 = sqrt((x+0.4)*(x+0.4) + (y-0.2)*(y-0.2)
+                                          + (z+0.5)*(z+0.5)) - 0.45;
+                    phi[i + nx*(j + ny*k)] = (d1 < d2) ? d1 : d2;
+                }
+            }
+        }
+
+        width = 3.0*grid->dx[0];
+        width_inner = 2.0*grid->dx[0];
+    }
+
+    void TearDown() override {
+        free(phi);
+        destroyGrid(grid);
+        LSM_Runtime_finalize();
+    }
+
+    // --- Helper functions
+
+    void computeReference(NarrowBand &nb) {
+        int nlo_index = 0, nhi_index = grid->num_gridpts - 1;
+        int nlo_index_outer = 0, nhi_index_outer = grid->num_gridpts - 1;
+        LSM3D_DETERMINE_NARROW_BAND(
+            phi,
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            nb.narrow_band.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+            &nlo_index, &nhi_index,
+            nb.n_lo.data(), nb.n_hi.data(),
+            nb.index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+            &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+            &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+            &width, &width_inner, &level);
+    }
+
+    void compute(NarrowBand &nb) {
+        ASSERT_EQ(determineNarrowBand3d(
+                      phi, nb.narrow_band.data(),
+                      nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                      nb.n_lo.data(), nb.n_hi.data(),
+                      nb.index_outer.data(), grid->num_gridpts,
+                      &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                      &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                      width, width_inner, level, grid),
+                  LSM_NARROW_BAND_ERR_SUCCESS);
+    }
+
+    // sorted linear indices of the points in level l
+    std::vector<int> levelPoints(const NarrowBand &nb, int l) {
+        std::vector<int> points;
+        int nx = grid->grid_dims_ghostbox[0];
+        int ny = grid->grid_dims_ghostbox[1];
+        for (int m = nb.n_lo[l]; m <= nb.n_hi[l]; m++) {
+            points.push_back(nb.index_x[m] + nx*(nb.index_y[m]
+                                                 + ny*nb.index_z[m]));
+        }
+        std::sort(points.begin(), points.end());
+        return points;
+    }
+
+    // Morton key of the point at m (bit by bit)
+    uint64_t mortonKey(const NarrowBand &nb, int m) {
+        int ijk[3] = {nb.index_x[m] - grid->ilo_gb,
+                      nb.index_y[m] - grid->jlo_gb,
+                      nb.index_z[m] - grid->klo_gb};
+        uint64_t key = 0;
+        for (int b = 0; b < 21; b++) {
+            for (int d = 0; d < 3; d++) {
+                key |= (uint64_t) ((ijk[d] >> b) & 1) << (3*b + d);
+            }
+        }
+        return key;
+    }
+
+    // sorted linear indices of the points in index_outer[lo..hi]
+    std::vector<int> outerPoints(const NarrowBand &nb, int lo, int hi) {
+        std::vector<int> points;
+        int nx = grid->grid_dims_ghostbox[0];
+        int ny = grid->grid_dims_ghostbox[1];
+        for (int m = lo; m <= hi; m++) {
+            int n = nb.index_outer[m];
+            points.push_back(nb.index_x[n] + nx*(nb.index_y[n]
+                                                 + ny*nb.index_z[n]));
+        }
+        std::sort(points.begin(), points.end());
+        return points;
+    }
+
+    int sort(LSM_NarrowBandOrdering *ordering, NarrowBand &nb) {
+        return sortNarrowBand3d(
+            ordering, nb.narrow_band.data(),
+            nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+            nb.n_lo.data(), nb.n_hi.data(), level, nb.index_outer.data(),
+            nb.nlo_outer_plus, nb.nhi_outer_plus,
+            nb.nlo_outer_minus, nb.nhi_outer_minus);
+    }
+
+    // --- Data members
+
+    const int level = 3;
+
+    Grid *grid;
+    LSMLIB_REAL *phi;
+    LSMLIB_REAL width, width_inner;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMNarrowBand3DTest, MatchesSerialNarrowBand) {
+    NarrowBand ref(grid->num_gridpts, level);
+    NarrowBand nb(grid->num_gridpts, level);
+    computeReference(ref);
+    LSM_Runtime_initialize(4, LSM_AFFINITY_NONE);
+    compute(nb);
+
+    // narrow band levels
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        ASSERT_EQ(nb.narrow_band[idx] & LSM_NB_LEVEL_BITS,
+                  ref.narrow_band[idx]) << "idx=" << idx;
+    }
+
+    // level 0 points and outer layer are stored in the same order
+    ASSERT_EQ(nb.n_lo[0], ref.n_lo[0]);
+    ASSERT_EQ(nb.n_hi[0], ref.n_hi[0]);
+    for (int m = ref.n_lo[0]; m <= ref.n_hi[0]; m++) {
+        ASSERT_EQ(nb.index_x[m], ref.index_x[m]);
+        ASSERT_EQ(nb.index_y[m], ref.index_y[m]);
+        ASSERT_EQ(nb.index_z[m], ref.index_z[m]);
+    }
+    EXPECT_EQ(nb.nlo_outer_minus, ref.nlo_outer_minus);
+    EXPECT_EQ(nb.nhi_outer_minus, ref.nhi_outer_minus);
+    EXPECT_EQ(nb.nlo_outer_plus, ref.nlo_outer_plus);
+    EXPECT_EQ(nb.nhi_outer_plus, ref.nhi_outer_plus);
+    EXPECT_GT(ref.nhi_outer_minus, ref.nlo_outer_minus);
+    EXPECT_GT(ref.nhi_outer_plus, ref.nlo_outer_plus);
+    for (int m = ref.nlo_outer_minus; m <= ref.nhi_outer_minus; m++) {
+        ASSERT_EQ(nb.index_outer[m], ref.index_outer[m]);
+    }
+    for (int m = ref.nlo_outer_plus; m <= ref.nhi_outer_plus; m++) {
+        ASSERT_EQ(nb.index_outer[m], ref.index_outer[m]);
+    }
+
+    // higher levels contain the same points
+    for (int l = 1; l <= level; l++) {
+        EXPECT_EQ(nb.n_lo[l], ref.n_lo[l]);
+        EXPECT_EQ(nb.n_hi[l], ref.n_hi[l]);
+        EXPECT_TRUE(levelPoints(nb, l) == levelPoints(ref, l)) << "l=" << l;
+    }
+}
+
+TEST_F(LSMNarrowBand3DTest, TwoLevelSetsMatchSerialNarrowBand) {
+    // psi:  signed distance to the plane y = 0.1, so the zero level sets
+    // intersect in two circles
+    std::vector<LSMLIB_REAL> psi(grid->num_gridpts);
+    int nx = grid->grid_dims_ghostbox[0];
+    int ny = grid->grid_dims_ghostbox[1];
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        int j = (idx/nx) % ny;
+        psi[idx] = grid->x_lo_ghostbox[1] + j*grid->dx[1] - 0.1;
+    }
+
+    NarrowBand ref(grid->num_gridpts, level);
+    NarrowBand nb(grid->num_gridpts, level);
+    int nlo_index = 0, nhi_index = grid->num_gridpts - 1;
+    int nlo_index_outer = 0, nhi_index_outer = grid->num_gridpts - 1;
+    LSM3D_DETERMINE_NARROW_BAND_FROM_TWO_LEVEL_SETS(
+        phi, psi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        ref.narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        ref.index_x.data(), ref.index_y.data(), ref.index_z.data(),
+        &nlo_index, &nhi_index,
+        ref.n_lo.data(), ref.n_hi.data(),
+        ref.index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &ref.nlo_outer_plus, &ref.nhi_outer_plus,
+        &ref.nlo_outer_minus, &ref.nhi_outer_minus,
+        &width, &width_inner, &level);
+
+    LSM_Runtime_initialize(4, LSM_AFFINITY_NONE);
+    ASSERT_EQ(determineNarrowBandFromTwoLevelSets3d(
+                  phi, psi.data(), nb.narrow_band.data(),
+                  nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                  nb.n_lo.data(), nb.n_hi.data(),
+                  nb.index_outer.data(), grid->num_gridpts,
+                  &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                  &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                  width, width_inner, level, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+
+    // level 0 is the tube around the intersection
+    int num_level0 = 0;
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        ASSERT_EQ(nb.narrow_band[idx] & LSM_NB_LEVEL_BITS,
+                  ref.narrow_band[idx]) << "idx=" << idx;
+        bool in_tube = (fabs(phi[idx]) < width) && (fabs(psi[idx]) < width);
+        EXPECT_EQ(ref.narrow_band[idx] == 1, in_tube) << "idx=" << idx;
+        if (in_tube) num_level0++;
+    }
+    EXPECT_EQ(ref.n_hi[0] - ref.n_lo[0] + 1, num_level0);
+    EXPECT_GT(num_level0, 0);
+
+    // same order of level 0 points and outer layer
+    ASSERT_EQ(nb.n_hi[0], ref.n_hi[0]);
+    for (int m = ref.n_lo[0]; m <= ref.n_hi[0]; m++) {
+        ASSERT_EQ(nb.index_x[m], ref.index_x[m]);
+        ASSERT_EQ(nb.index_y[m], ref.index_y[m]);
+        ASSERT_EQ(nb.index_z[m], ref.index_z[m]);
+    }
+    EXPECT_EQ(nb.nhi_outer_minus, ref.nhi_outer_minus);
+    EXPECT_EQ(nb.nlo_outer_plus, ref.nlo_outer_plus);
+    for (int l = 1; l <= level; l++) {
+        EXPECT_EQ(nb.n_hi[l], ref.n_hi[l]);
+        EXPECT_TRUE(levelPoints(nb, l) == levelPoints(ref, l)) << "l=" << l;
+    }
+
+    // psi is required
+    EXPECT_EQ(determineNarrowBandFromTwoLevelSets3d(
+                  phi, NULL, nb.narrow_band.data(),
+                  nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                  nb.n_lo.data(), nb.n_hi.data(),
+                  nb.index_outer.data(), grid->num_gridpts,
+                  &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                  &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                  width, width_inner, level, grid),
+              LSM_NARROW_BAND_ERR_INVALID_ARGUMENT);
+}
+
+TEST_F(LSMNarrowBand3DTest, BoundaryLayerMarks) {
+    NarrowBand ref(grid->num_gridpts, level);
+    NarrowBand nb(grid->num_gridpts, level);
+    computeReference(ref);
+    std::vector<unsigned char> ref_level(ref.narrow_band);
+    LSM_Runtime_initialize(4, LSM_AFFINITY_NONE);
+    compute(nb);
+
+    // mark the boundary layers as done by the local examples
+    int *lo_hi[3][6] = {
+        {&grid->ilo_D2_fb, &grid->ihi_D2_fb, &grid->jlo_D2_fb,
+         &grid->jhi_D2_fb, &grid->klo_D2_fb, &grid->khi_D2_fb},
+        {&grid->ilo_D1_fb, &grid->ihi_D1_fb, &grid->jlo_D1_fb,
+         &grid->jhi_D1_fb, &grid->klo_D1_fb, &grid->khi_D1_fb},
+        {&grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb,
+         &grid->jhi_gb, &grid->klo_gb, &grid->khi_gb}};
+    unsigned char marks[3] = {grid->mark_D2, grid->mark_D1, grid->mark_gb};
+    for (int m = 0; m < 3; m++) {
+        LSM3D_MARK_NARROW_BAND_BOUNDARY_LAYER(
+            ref.narrow_band.data(),
+            &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+            &grid->klo_gb, &grid->khi_gb,
+            lo_hi[m][0], lo_hi[m][1], lo_hi[m][2], lo_hi[m][3],
+            lo_hi[m][4], lo_hi[m][5], &marks[m]);
+    }
+
+    // narrow band points are classified the same way by the kernel tests
+    unsigned char tests[4] = {grid->mark_fb, grid->mark_D2, grid->mark_D1,
+                              grid->mark_gb};
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        if (ref_level[idx] == 0) continue;
+        for (int t = 0; t < 4; t++) {
+            ASSERT_EQ(nb.narrow_band[idx] <= tests[t],
+                      ref.narrow_band[idx] <= tests[t])
+                << "idx=" << idx << " mark=" << (int) tests[t];
+        }
+    }
+}
+
+TEST_F(LSMNarrowBand3DTest, MarksResetWhenGridIsRead) {
+    // grid files written by older versions store the old marks
+    grid->mark_gb = 255;
+    grid->mark_D1 = 250;
+    grid->mark_D2 = 200;
+    grid->mark_D3 = 150;
+    grid->mark_fb = 117;
+    char ascii_file[] = "test_narrow_band3d_grid.ascii";
+    char binary_file[] = "test_narrow_band3d_grid.bin";
+    writeGridToAsciiFile(grid, ascii_file, NO_ZIP);
+    writeGridToBinaryFile(grid, binary_file, NO_ZIP);
+
+    Grid *grids[2] = {readGridFromAsciiFile(ascii_file),
+                      readGridFromBinaryFile(binary_file)};
+    for (int g = 0; g < 2; g++) {
+        ASSERT_TRUE(grids[g] != NULL);
+        EXPECT_EQ(grids[g]->mark_gb, LSM_NB_MARK_GB);
+        EXPECT_EQ(grids[g]->mark_D1, LSM_NB_MARK_D1);
+        EXPECT_EQ(grids[g]->mark_D2, LSM_NB_MARK_D2);
+        EXPECT_EQ(grids[g]->mark_D3, LSM_NB_MARK_D3);
+        EXPECT_EQ(grids[g]->mark_fb, LSM_NB_MARK_FB);
+        for (int dir = 0; dir < 3; dir++) {
+            ASSERT_TRUE(grids[g]->nb_layer_mask[dir] != NULL);
+            for (int i = 0; i < grid->grid_dims_ghostbox[dir]; i++) {
+                EXPECT_EQ(grids[g]->nb_layer_mask[dir][i],
+                          grid->nb_layer_mask[dir][i]);
+            }
+        }
+        destroyGrid(grids[g]);
+    }
+    remove(ascii_file);
+    remove(binary_file);
+}
+
+TEST_F(LSMNarrowBand3DTest, IndependentOfNumThreads) {
+    NarrowBand nb_serial(grid->num_gridpts, level);
+    NarrowBand nb_threaded(grid->num_gridpts, level);
+
+    LSM_Runtime_initialize(1, LSM_AFFINITY_NONE);
+    compute(nb_serial);
+    LSM_Runtime_initialize(7, LSM_AFFINITY_NONE);
+    compute(nb_threaded);
+
+    EXPECT_TRUE(nb_threaded.narrow_band == nb_serial.narrow_band);
+    EXPECT_TRUE(nb_threaded.n_lo == nb_serial.n_lo);
+    EXPECT_TRUE(nb_threaded.n_hi == nb_serial.n_hi);
+    EXPECT_TRUE(nb_threaded.index_x == nb_serial.index_x);
+    EXPECT_TRUE(nb_threaded.index_y == nb_serial.index_y);
+    EXPECT_TRUE(nb_threaded.index_z == nb_serial.index_z);
+}
+
+TEST_F(LSMNarrowBand3DTest, MortonOrdering) {
+    LSM_Runtime_initialize(4, LSM_AFFINITY_NONE);
+    NarrowBand nb(grid->num_gridpts, level);
+    compute(nb);
+    NarrowBand unsorted = nb;
+
+    LSM_NarrowBandOrdering *ordering = createNarrowBandOrdering3d(grid);
+    ASSERT_NE(ordering, nullptr);
+    ASSERT_EQ(sort(ordering, nb), LSM_NARROW_BAND_ERR_SUCCESS);
+    EXPECT_EQ(ordering->num_merged_levels, 0);
+
+    // same points in each level, in Morton order
+    for (int l = 0; l <= level; l++) {
+        EXPECT_TRUE(levelPoints(nb, l) == levelPoints(unsorted, l))
+            << "l=" << l;
+        for (int m = nb.n_lo[l]; m < nb.n_hi[l]; m++) {
+            ASSERT_LT(mortonKey(nb, m), mortonKey(nb, m+1)) << "l=" << l;
+        }
+    }
+
+    // same outer points, listed in the new order
+    EXPECT_TRUE(outerPoints(nb, nb.nlo_outer_minus, nb.nhi_outer_minus)
+        == outerPoints(unsorted, nb.nlo_outer_minus, nb.nhi_outer_minus));
+    EXPECT_TRUE(outerPoints(nb, nb.nlo_outer_plus, nb.nhi_outer_plus)
+        == outerPoints(unsorted, nb.nlo_outer_plus, nb.nhi_outer_plus));
+    for (int m = nb.nlo_outer_minus; m < nb.nhi_outer_minus; m++) {
+        ASSERT_LT(nb.index_outer[m], nb.index_outer[m+1]);
+    }
+    for (int m = nb.nlo_outer_plus; m < nb.nhi_outer_plus; m++) {
+        ASSERT_LT(nb.index_outer[m], nb.index_outer[m+1]);
+    }
+
+    // after a small motion of the zero level set, the previous order is
+    // reused and the result is the same as sorting from scratch
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        phi[idx] += 0.2*grid->dx[0];
+    }
+    NarrowBand moved(grid->num_gridpts, level);
+    compute(moved);
+    NarrowBand ref = moved;
+    ASSERT_EQ(sort(ordering, moved), LSM_NARROW_BAND_ERR_SUCCESS);
+    EXPECT_EQ(ordering->num_merged_levels, level+1);
+
+    LSM_NarrowBandOrdering *ref_ordering = createNarrowBandOrdering3d(grid);
+    ASSERT_EQ(sort(ref_ordering, ref), LSM_NARROW_BAND_ERR_SUCCESS);
+    EXPECT_EQ(ref_ordering->num_merged_levels, 0);
+    for (int m = ref.n_lo[0]; m <= ref.n_hi[level]; m++) {
+        ASSERT_EQ(moved.index_x[m], ref.index_x[m]);
+        ASSERT_EQ(moved.index_y[m], ref.index_y[m]);
+        ASSERT_EQ(moved.index_z[m], ref.index_z[m]);
+    }
+    for (int m = ref.nlo_outer_minus; m <= ref.nhi_outer_minus; m++) {
+        ASSERT_EQ(moved.index_outer[m], ref.index_outer[m]);
+    }
+    for (int m = ref.nlo_outer_plus; m <= ref.nhi_outer_plus; m++) {
+        ASSERT_EQ(moved.index_outer[m], ref.index_outer[m]);
+    }
+
+    destroyNarrowBandOrdering3d(ref_ordering);
+    destroyNarrowBandOrdering3d(ordering);
+}
+
+TEST_F(LSMNarrowBand3DTest, InvalidArguments) {
+    NarrowBand nb(grid->num_gridpts, level);
+
+    // index_outer too small for the outer layer
+    EXPECT_EQ(determineNarrowBand3d(
+                  phi, nb.narrow_band.data(),
+                  nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                  nb.n_lo.data(), nb.n_hi.data(),
+                  nb.index_outer.data(), 1,
+                  &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                  &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                  width, width_inner, level, grid),
+              LSM_NARROW_BAND_ERR_INVALID_ARGUMENT);
+
+    EXPECT_EQ(determineNarrowBand3d(
+                  phi, nb.narrow_band.data(),
+                  nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                  nb.n_lo.data(), nb.n_hi.data(),
+                  nb.index_outer.data(), grid->num_gridpts,
+                  &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                  &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                  width, width_inner, level, NULL),
+              LSM_NARROW_BAND_ERR_INVALID_ARGUMENT);
+
+    // too many levels for the narrow band level bits
+    EXPECT_EQ(determineNarrowBand3d(
+                  phi, nb.narrow_band.data(),
+                  nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+                  nb.n_lo.data(), nb.n_hi.data(),
+                  nb.index_outer.data(), grid->num_gridpts,
+                  &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+                  &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+                  width, width_inner, LSM_NB_MAX_LEVEL+1, grid),
+              LSM_NARROW_BAND_ERR_INVALID_ARGUMENT);
+}
+
+TEST_F(LSMNarrowBand3DTest, SerialNarrowBandLevelsAreCapped) {
+    // levels above LSM_NB_MAX_LEVEL would overflow into the boundary
+    // layer bits, so they are left empty
+    int max_level = LSM_NB_MAX_LEVEL + 2;
+    NarrowBand nb(grid->num_gridpts, max_level);
+    int nlo_index = 0, nhi_index = grid->num_gridpts - 1;
+    int nlo_index_outer = 0, nhi_index_outer = grid->num_gridpts - 1;
+    LSM3D_DETERMINE_NARROW_BAND(
+        phi,
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        nb.narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        nb.index_x.data(), nb.index_y.data(), nb.index_z.data(),
+        &nlo_index, &nhi_index,
+        nb.n_lo.data(), nb.n_hi.data(),
+        nb.index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &nb.nlo_outer_plus, &nb.nhi_outer_plus,
+        &nb.nlo_outer_minus, &nb.nhi_outer_minus,
+        &width, &width_inner, &max_level);
+
+    EXPECT_GE(nb.n_hi[LSM_NB_MAX_LEVEL], nb.n_lo[LSM_NB_MAX_LEVEL]);
+    for (int l = LSM_NB_MAX_LEVEL+1; l <= max_level; l++) {
+        EXPECT_EQ(nb.n_hi[l], nb.n_lo[l] - 1) << "l=" << l;
+    }
+    for (int idx = 0; idx < grid->num_gridpts; idx++) {
+        EXPECT_LE(nb.narrow_band[idx], LSM_NB_LEVEL_BITS) << "idx=" << idx;
+    }
+}
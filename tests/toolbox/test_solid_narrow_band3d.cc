@@ -0,0 +1,374 @@
+/*
+ * Test program for 3D narrow bands near a static solid mask
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK(),
+ * determineNarrowBandAwayFromMask3d(), determineSolidNarrowBand3d() and
+ * LSM3D_IMPOSE_MASK_CONTACT_LOCAL().
+ */
+
+#include <math.h>                   // for fabs, sin, sqrt
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+#include "lsm_localization3d.h"
+#include "lsm_narrow_band3d.h"
+#include "lsm_runtime.h"
+
+/*
+ * Test fixtures
+ */
+class LSMSolidNarrowBand3DTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void SetUp() override {
+        int grid_dims[3] = {24, 24, 24};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(3, grid_dims, x_lo, x_hi, MEDIUM);
+        dx = grid->dx[0];
+
+        // solid ball (mask > 0) and a plane interface masked by it
+        int n = grid->num_gridpts;
+        mask.resize(n);
+        phi.resize(n);
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+        int nx = grid->grid_dims_ghostbox[0];
+        int ny = grid->grid_dims_ghostbox[1];
+        int nz = grid->grid_dims_ghostbox[2];
+        for (int k = 0; k < nz; k++) {
+            for (int j = 0; j < ny; j++) {
+                for (int i = 0; i < nx; i++) {
+                    int idx = i + nx*(j + ny*k);
+                    x[idx] = grid->x_lo_ghostbox[0] + i*dx;
+                    y[idx] = grid->x_lo_ghostbox[1] + j*dx;
+                    z[idx] = grid->x_lo_ghostbox[2] + k*dx;
+                    LSMLIB_REAL r = sqrt(x[idx]*x[idx] + y[idx]*y[idx]
+                                         + z[idx]*z[idx]);
+                    mask[idx] = 0.5 - r;
+                    LSMLIB_REAL plane = z[idx] - 0.1;
+                    phi[idx] = (mask[idx] > plane) ? mask[idx] : plane;
+                }
+            }
+        }
+
+        LSM_Runtime_initialize(2, LSM_AFFINITY_NONE);
+    }
+
+    void TearDown() override {
+        destroyGrid(grid);
+        LSM_Runtime_finalize();
+    }
+
+    // --- Data members
+
+    Grid *grid;
+    LSMLIB_REAL dx;
+    std::vector<LSMLIB_REAL> mask, phi;
+    std::vector<LSMLIB_REAL> x, y, z;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMSolidNarrowBand3DTest, NarrowBandAwayFromMask) {
+    int n = grid->num_gridpts;
+    int level = 2;
+    std::vector<unsigned char> narrow_band(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n), index_outer(n);
+    std::vector<int> n_lo(level+1), n_hi(level+1);
+    int nlo_index = 0, nhi_index = n - 1;
+    int nlo_index_outer = 0, nhi_index_outer = n - 1;
+    int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+    LSMLIB_REAL width = 4*dx, width_inner = 2*dx;
+
+    LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK(
+        phi.data(), mask.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &nlo_index, &nhi_index, n_lo.data(), n_hi.data(),
+        index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &nlo_outer_plus, &nhi_outer_plus,
+        &nlo_outer_minus, &nhi_outer_minus,
+        &width, &width_inner, &level, &dx, &dx, &dx);
+
+    // level 0 consists of the near-interface points away from the mask
+    int num_level0 = 0, num_pinned = 0;
+    for (int idx = 0; idx < n; idx++) {
+        bool near = fabs(phi[idx]) < width;
+        bool pinned = fabs(phi[idx] - mask[idx]) <= dx;
+        if (near && pinned) num_pinned++;
+        if (near && !pinned) {
+            num_level0++;
+            EXPECT_EQ(narrow_band[idx], 1) << "idx=" << idx;
+        } else {
+            EXPECT_NE(narrow_band[idx], 1) << "idx=" << idx;
+        }
+    }
+    EXPECT_GT(num_pinned, 0);
+    EXPECT_EQ(n_hi[0] - n_lo[0] + 1, num_level0);
+
+    // higher levels are marked
+    for (int l = 1; l <= level; l++) {
+        EXPECT_EQ(n_lo[l], n_hi[l-1] + 1);
+        EXPECT_GE(n_hi[l], n_lo[l]);
+    }
+}
+
+TEST_F(LSMSolidNarrowBand3DTest, EmptyNarrowBandAwayFromMask) {
+    int n = grid->num_gridpts;
+    int level = 2;
+    std::vector<unsigned char> narrow_band(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n), index_outer(n);
+    std::vector<int> n_lo(level+1), n_hi(level+1);
+    int nlo_index = 0, nhi_index = n - 1;
+    int nlo_index_outer = 0, nhi_index_outer = n - 1;
+    int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+    LSMLIB_REAL width = 4*dx, width_inner = 2*dx;
+
+    // no zero level set:  phi is far from zero everywhere
+    std::vector<LSMLIB_REAL> far_phi(n, 1.0);
+
+    LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK(
+        far_phi.data(), mask.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &nlo_index, &nhi_index, n_lo.data(), n_hi.data(),
+        index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &nlo_outer_plus, &nhi_outer_plus,
+        &nlo_outer_minus, &nhi_outer_minus,
+        &width, &width_inner, &level, &dx, &dx, &dx);
+
+    for (int l = 0; l <= level; l++) {
+        EXPECT_EQ(n_hi[l], n_lo[l] - 1) << "l=" << l;
+    }
+    EXPECT_EQ(nhi_outer_minus, nlo_outer_minus - 1);
+    EXPECT_EQ(nhi_outer_plus, nlo_outer_plus - 1);
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(narrow_band[idx], 0) << "idx=" << idx;
+    }
+}
+
+TEST_F(LSMSolidNarrowBand3DTest, ThreadedNarrowBandAwayFromMask) {
+    int n = grid->num_gridpts;
+    int level = 2, solid_level = 0;
+    std::vector<unsigned char> ref_band(n), narrow_band(n);
+    std::vector<unsigned char> solid_narrow_band(n);
+    std::vector<int> ref_x(n), ref_y(n), ref_z(n), ref_outer(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n), index_outer(n);
+    std::vector<int> solid_x(n), solid_y(n), solid_z(n);
+    std::vector<int> ref_n_lo(level+1), ref_n_hi(level+1);
+    std::vector<int> n_lo(level+1), n_hi(level+1);
+    std::vector<int> solid_n_lo(1), solid_n_hi(1);
+    std::vector<LSMLIB_REAL> normal_x(n), normal_y(n), normal_z(n);
+    int nlo_index = 0, nhi_index = n - 1;
+    int nlo_index_outer = 0, nhi_index_outer = n - 1;
+    int ref_outer_range[4], outer_range[4];
+    LSMLIB_REAL width = 4*dx, width_inner = 2*dx;
+
+    LSM3D_DETERMINE_NARROW_BAND_AWAY_FROM_MASK(
+        phi.data(), mask.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        ref_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        ref_x.data(), ref_y.data(), ref_z.data(),
+        &nlo_index, &nhi_index, ref_n_lo.data(), ref_n_hi.data(),
+        ref_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &ref_outer_range[0], &ref_outer_range[1],
+        &ref_outer_range[2], &ref_outer_range[3],
+        &width, &width_inner, &level, &dx, &dx, &dx);
+
+    // the solid narrow band contains all voxels with |mask| < width + dx
+    ASSERT_EQ(determineSolidNarrowBand3d(
+                  mask.data(), solid_narrow_band.data(),
+                  solid_x.data(), solid_y.data(), solid_z.data(),
+                  solid_n_lo.data(), solid_n_hi.data(),
+                  normal_x.data(), normal_y.data(), normal_z.data(),
+                  width + 1.5*dx, solid_level, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+    ASSERT_EQ(determineNarrowBandAwayFromMask3d(
+                  phi.data(), mask.data(), solid_narrow_band.data(),
+                  narrow_band.data(),
+                  index_x.data(), index_y.data(), index_z.data(),
+                  n_lo.data(), n_hi.data(), index_outer.data(), n,
+                  &outer_range[0], &outer_range[1],
+                  &outer_range[2], &outer_range[3],
+                  width, width_inner, level, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+
+    // same levels; the boundary layer bits are set
+    for (int idx = 0; idx < n; idx++) {
+        ASSERT_EQ(narrow_band[idx] & LSM_NB_LEVEL_BITS, ref_band[idx])
+            << "idx=" << idx;
+    }
+    EXPECT_NE(narrow_band[0] & ~LSM_NB_LEVEL_BITS, 0);
+    for (int l = 0; l <= level; l++) {
+        EXPECT_EQ(n_hi[l] - n_lo[l], ref_n_hi[l] - ref_n_lo[l])
+            << "l=" << l;
+    }
+    EXPECT_EQ(outer_range[1] - outer_range[0],
+              ref_outer_range[1] - ref_outer_range[0]);
+    EXPECT_EQ(outer_range[3] - outer_range[2],
+              ref_outer_range[3] - ref_outer_range[2]);
+
+    // level 0 points are in the same order
+    for (int m = 0; m <= n_hi[0]; m++) {
+        ASSERT_EQ(index_x[m], ref_x[m]) << "m=" << m;
+        ASSERT_EQ(index_y[m], ref_y[m]) << "m=" << m;
+        ASSERT_EQ(index_z[m], ref_z[m]) << "m=" << m;
+    }
+
+    // missing solid narrow band
+    EXPECT_EQ(determineNarrowBandAwayFromMask3d(
+                  phi.data(), mask.data(), NULL, narrow_band.data(),
+                  index_x.data(), index_y.data(), index_z.data(),
+                  n_lo.data(), n_hi.data(), index_outer.data(), n,
+                  &outer_range[0], &outer_range[1],
+                  &outer_range[2], &outer_range[3],
+                  width, width_inner, level, grid),
+              LSM_NARROW_BAND_ERR_INVALID_ARGUMENT);
+}
+
+TEST_F(LSMSolidNarrowBand3DTest, SolidNormals) {
+    int n = grid->num_gridpts;
+    int level = 1;
+    std::vector<unsigned char> solid_narrow_band(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n);
+    std::vector<int> n_lo(level+1), n_hi(level+1);
+    std::vector<LSMLIB_REAL> normal_x(n), normal_y(n), normal_z(n);
+    LSMLIB_REAL width = 3*dx;
+
+    ASSERT_EQ(determineSolidNarrowBand3d(
+                  mask.data(), solid_narrow_band.data(),
+                  index_x.data(), index_y.data(), index_z.data(),
+                  n_lo.data(), n_hi.data(),
+                  normal_x.data(), normal_y.data(), normal_z.data(),
+                  width, level, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+
+    // level 0 is the band around the solid surface
+    int num_level0 = 0;
+    for (int idx = 0; idx < n; idx++) {
+        if (fabs(mask[idx]) < width) num_level0++;
+    }
+    EXPECT_EQ(n_hi[0] - n_lo[0] + 1, num_level0);
+
+    // normals point into the solid (towards the center of the ball)
+    int nx = grid->grid_dims_ghostbox[0];
+    int ny = grid->grid_dims_ghostbox[1];
+    for (int m = n_lo[0]; m <= n_hi[level]; m++) {
+        int idx = index_x[m] + nx*(index_y[m] + ny*index_z[m]);
+        LSMLIB_REAL r = sqrt(x[idx]*x[idx] + y[idx]*y[idx] + z[idx]*z[idx]);
+        EXPECT_NEAR(normal_x[idx], -x[idx]/r, 0.05) << "m=" << m;
+        EXPECT_NEAR(normal_y[idx], -y[idx]/r, 0.05) << "m=" << m;
+        EXPECT_NEAR(normal_z[idx], -z[idx]/r, 0.05) << "m=" << m;
+    }
+}
+
+TEST_F(LSMSolidNarrowBand3DTest, ImposeMaskContactLocal) {
+    int n = grid->num_gridpts;
+    int level = 1, solid_level = 0;
+    std::vector<unsigned char> narrow_band(n), solid_narrow_band(n);
+    std::vector<int> index_x(n), index_y(n), index_z(n), index_outer(n);
+    std::vector<int> solid_x(n), solid_y(n), solid_z(n);
+    std::vector<int> n_lo(level+1), n_hi(level+1);
+    std::vector<int> solid_n_lo(1), solid_n_hi(1);
+    std::vector<LSMLIB_REAL> normal_x(n), normal_y(n), normal_z(n);
+    int nlo_index = 0, nhi_index = n - 1;
+    int nlo_index_outer = 0, nhi_index_outer = n - 1;
+    int nlo_outer_plus, nhi_outer_plus, nlo_outer_minus, nhi_outer_minus;
+    LSMLIB_REAL width = 4*dx, width_inner = 2*dx;
+    unsigned char level_bits = LSM_NB_LEVEL_BITS;
+
+    LSM3D_DETERMINE_NARROW_BAND(
+        phi.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &nlo_index, &nhi_index, n_lo.data(), n_hi.data(),
+        index_outer.data(), &nlo_index_outer, &nhi_index_outer,
+        &nlo_outer_plus, &nhi_outer_plus,
+        &nlo_outer_minus, &nhi_outer_minus,
+        &width, &width_inner, &level);
+    ASSERT_EQ(determineSolidNarrowBand3d(
+                  mask.data(), solid_narrow_band.data(),
+                  solid_x.data(), solid_y.data(), solid_z.data(),
+                  solid_n_lo.data(), solid_n_hi.data(),
+                  normal_x.data(), normal_y.data(), normal_z.data(),
+                  10*dx, solid_level, grid),
+              LSM_NARROW_BAND_ERR_SUCCESS);
+
+    // perturbed level set function (as after a time step)
+    std::vector<LSMLIB_REAL> src(n);
+    for (int idx = 0; idx < n; idx++) {
+        src[idx] = phi[idx] + 0.3*dx*sin(7*x[idx] + 5*y[idx] + 3*z[idx]);
+    }
+
+    std::vector<LSMLIB_REAL> dest(src), dest_contact(src);
+    LSM3D_IMPOSE_MASK_LOCAL(
+        dest.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        src.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        mask.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[level]);
+    LSM3D_IMPOSE_MASK_CONTACT_LOCAL(
+        dest_contact.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        src.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        mask.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        solid_narrow_band.data(),
+        &grid->ilo_gb, &grid->ihi_gb, &grid->jlo_gb, &grid->jhi_gb,
+        &grid->klo_gb, &grid->khi_gb,
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[level], &level_bits);
+
+    int num_masked = 0;
+    for (int idx = 0; idx < n; idx++) {
+        EXPECT_EQ(dest_contact[idx], dest[idx]) << "idx=" << idx;
+        if (dest[idx] != src[idx]) num_masked++;
+    }
+    EXPECT_GT(num_masked, 0);
+}
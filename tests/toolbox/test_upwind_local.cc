@@ -0,0 +1,344 @@
+/*
+ * Test program for narrow-band upwind Hamilton-Jacobi derivatives
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that the LSM2D_UPWIND_HJ_*_LOCAL() and
+ * LSM3D_UPWIND_HJ_*_LOCAL() functions reproduce the results of the
+ * corresponding full-grid functions at the level 0 points of a narrow
+ * band around a circle/sphere.
+ */
+
+#include <math.h>                   // for cos, sin, sqrt, fabs
+#include <stdlib.h>                 // for malloc, free
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_NEAR, ...
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+#include "lsm_spatial_derivatives2d.h"
+#include "lsm_spatial_derivatives2d_local.h"
+#include "lsm_spatial_derivatives3d.h"
+#include "lsm_spatial_derivatives3d_local.h"
+
+// ghostbox index range arguments for a grid-sized array
+#define GB2D(grid) \
+    &(grid)->ilo_gb, &(grid)->ihi_gb, &(grid)->jlo_gb, &(grid)->jhi_gb
+#define GB3D(grid) \
+    GB2D(grid), &(grid)->klo_gb, &(grid)->khi_gb
+#define FB2D(grid) \
+    &(grid)->ilo_fb, &(grid)->ihi_fb, &(grid)->jlo_fb, &(grid)->jhi_fb
+#define FB3D(grid) \
+    FB2D(grid), &(grid)->klo_fb, &(grid)->khi_fb
+
+// number of narrow band levels required by the upwind schemes
+static const int NUM_LEVELS = 4;
+
+/*
+ * Test fixtures
+ */
+class LSMUpwindLocalTest : public ::testing::Test {
+  protected:
+    // --- Fixture set up and tear down
+
+    void setUpGrid(int num_dims) {
+        int grid_dims[3] = {26, 22, 18};
+        LSMLIB_REAL x_lo[3] = {-1.0, -1.0, -1.0};
+        LSMLIB_REAL x_hi[3] = {1.0, 1.0, 1.0};
+        grid = createGridSetGridDims(num_dims, grid_dims, x_lo, x_hi, HIGH);
+        dims = num_dims;
+        nx = grid->grid_dims_ghostbox[0];
+        ny = grid->grid_dims_ghostbox[1];
+        nz = (dims == 3) ? grid->grid_dims_ghostbox[2] : 1;
+
+        for (int n = 0; n < 3; n++) {
+            grad[n] = allocate();
+            grad_ref[n] = allocate();
+            vel[n] = allocate();
+        }
+        phi = allocate();
+        for (int n = 0; n < 3; n++) D[n] = allocate();
+        narrow_band = (unsigned char *) calloc(grid->num_gridpts, 1);
+
+        // smooth (non-distance) level set function and a velocity field
+        // that changes sign inside the band
+        for (int k = 0; k < nz; k++) {
+            for (int j = 0; j < ny; j++) {
+                for (int i = 0; i < nx; i++) {
+                    int idx = i + j*nx + k*nx*ny;
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*grid->dx[0];
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*grid->dx[1];
+                    LSMLIB_REAL z = (dims == 3) ?
+                        grid->x_lo_ghostbox[2] + k*grid->dx[2] : 0.0;
+                    phi[idx] = (sqrt(x*x + y*y + z*z) - 0.5)*(1.0 + 0.3*x*y);
+                    vel[0][idx] = sin(3.0*y + z) + 0.2;
+                    vel[1][idx] = cos(2.0*x - z) - 0.1;
+                    vel[2][idx] = sin(x + 2.0*y);
+                    for (int n = 0; n < 3; n++) {
+                        grad[n][idx] = 0.0;
+                        grad_ref[n][idx] = 0.0;
+                    }
+                }
+            }
+        }
+
+        buildNarrowBand();
+    }
+
+    void TearDown() override {
+        for (int n = 0; n < 3; n++) {
+            free(grad[n]);
+            free(grad_ref[n]);
+            free(vel[n]);
+            free(D[n]);
+        }
+        free(phi);
+        free(narrow_band);
+        destroyGrid(grid);
+    }
+
+    // --- Helper functions
+
+    LSMLIB_REAL *allocate() {
+        return (LSMLIB_REAL *) malloc(grid->num_gridpts*sizeof(LSMLIB_REAL));
+    }
+
+    // level 0 consists of fillbox points within 3 grid cells of the zero
+    // level set; level L consists of the points whose neighborhood (in
+    // the infinity-norm) contains a level L-1 point
+    void buildNarrowBand() {
+        int ilo = grid->ilo_fb, ihi = grid->ihi_fb;
+        int jlo = grid->jlo_fb, jhi = grid->jhi_fb;
+        int klo = (dims == 3) ? grid->klo_fb : 0;
+        int khi = (dims == 3) ? grid->khi_fb : 0;
+        for (int k = klo; k <= khi; k++) {
+            for (int j = jlo; j <= jhi; j++) {
+                for (int i = ilo; i <= ihi; i++) {
+                    int idx = i + j*nx + k*nx*ny;
+                    if (fabs(phi[idx]) < 3.0*grid->dx[0]) addPoint(i, j, k, 0);
+                }
+            }
+        }
+        n_lo[0] = 0;
+        n_hi[0] = (int) index_x.size() - 1;
+
+        for (int level = 1; level < NUM_LEVELS; level++) {
+            n_lo[level] = n_hi[level-1] + 1;
+            for (int l = n_lo[level-1]; l <= n_hi[level-1]; l++) {
+                for (int dk = (dims == 3) ? -1 : 0;
+                     dk <= ((dims == 3) ? 1 : 0); dk++) {
+                    for (int dj = -1; dj <= 1; dj++) {
+                        for (int di = -1; di <= 1; di++) {
+                            int i = index_x[l] + di;
+                            int j = index_y[l] + dj;
+                            int k = index_z[l] + dk;
+                            if (narrow_band[i + j*nx + k*nx*ny] == 0) {
+                                addPoint(i, j, k, level);
+                            }
+                        }
+                    }
+                }
+            }
+            n_hi[level] = (int) index_x.size() - 1;
+        }
+        ASSERT_GT(n_hi[0], n_lo[0]);
+    }
+
+    void addPoint(int i, int j, int k, int level) {
+        index_x.push_back(i);
+        index_y.push_back(j);
+        index_z.push_back(k);
+        narrow_band[i + j*nx + k*nx*ny] = (unsigned char) (level + 1);
+    }
+
+    // compare the local and full-grid results at level 0 points
+    void checkResult() {
+        for (int l = n_lo[0]; l <= n_hi[0]; l++) {
+            int idx = index_x[l] + index_y[l]*nx + index_z[l]*nx*ny;
+            for (int n = 0; n < dims; n++) {
+                ASSERT_NEAR(grad[n][idx], grad_ref[n][idx], 1e-12)
+                    << "l=" << l << ", n=" << n;
+            }
+        }
+    }
+
+    // --- Data members
+
+    Grid *grid;
+    int dims, nx, ny, nz;
+
+    LSMLIB_REAL *phi;
+    LSMLIB_REAL *vel[3];
+    LSMLIB_REAL *grad[3];
+    LSMLIB_REAL *grad_ref[3];
+    LSMLIB_REAL *D[3];
+
+    unsigned char *narrow_band;
+    std::vector<int> index_x, index_y, index_z;
+    int n_lo[NUM_LEVELS], n_hi[NUM_LEVELS];
+
+    const unsigned char mark_fb = 1;
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMUpwindLocalTest, ENO1_3D) {
+    setUpGrid(3);
+    LSM3D_UPWIND_HJ_ENO1(
+        grad_ref[0], grad_ref[1], grad_ref[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), FB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+
+    unsigned char mark_D1 = 2;
+    LSM3D_UPWIND_HJ_ENO1_LOCAL(
+        grad[0], grad[1], grad[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1],
+        narrow_band, GB3D(grid), &mark_fb, &mark_D1);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, ENO2_3D) {
+    setUpGrid(3);
+    LSM3D_UPWIND_HJ_ENO2(
+        grad_ref[0], grad_ref[1], grad_ref[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), D[1], GB3D(grid), FB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+
+    unsigned char mark_D1 = 3, mark_D2 = 2;
+    LSM3D_UPWIND_HJ_ENO2_LOCAL(
+        grad[0], grad[1], grad[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), D[1], GB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1], &n_lo[2], &n_hi[2],
+        narrow_band, GB3D(grid), &mark_fb, &mark_D1, &mark_D2);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, ENO3_3D) {
+    setUpGrid(3);
+    LSM3D_UPWIND_HJ_ENO3(
+        grad_ref[0], grad_ref[1], grad_ref[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), D[1], GB3D(grid), D[2], GB3D(grid), FB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+
+    unsigned char mark_D1 = 4, mark_D2 = 3, mark_D3 = 3;
+    LSM3D_UPWIND_HJ_ENO3_LOCAL(
+        grad[0], grad[1], grad[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), D[1], GB3D(grid), D[2], GB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1], &n_lo[2], &n_hi[2],
+        &n_lo[3], &n_hi[3],
+        narrow_band, GB3D(grid), &mark_fb, &mark_D1, &mark_D2, &mark_D3);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, WENO5_3D) {
+    setUpGrid(3);
+    LSM3D_UPWIND_HJ_WENO5(
+        grad_ref[0], grad_ref[1], grad_ref[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid), FB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2]);
+
+    unsigned char mark_D1 = 4;
+    LSM3D_UPWIND_HJ_WENO5_LOCAL(
+        grad[0], grad[1], grad[2], GB3D(grid),
+        phi, GB3D(grid), vel[0], vel[1], vel[2], GB3D(grid),
+        D[0], GB3D(grid),
+        &grid->dx[0], &grid->dx[1], &grid->dx[2],
+        index_x.data(), index_y.data(), index_z.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1], &n_lo[2], &n_hi[2],
+        &n_lo[3], &n_hi[3],
+        narrow_band, GB3D(grid), &mark_fb, &mark_D1);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, ENO1_2D) {
+    setUpGrid(2);
+    LSM2D_UPWIND_HJ_ENO1(
+        grad_ref[0], grad_ref[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), FB2D(grid), &grid->dx[0], &grid->dx[1]);
+
+    unsigned char mark_D1 = 2;
+    LSM2D_UPWIND_HJ_ENO1_LOCAL(
+        grad[0], grad[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), &grid->dx[0], &grid->dx[1],
+        index_x.data(), index_y.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1],
+        narrow_band, GB2D(grid), &mark_fb, &mark_D1);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, ENO3_2D) {
+    setUpGrid(2);
+    LSM2D_UPWIND_HJ_ENO3(
+        grad_ref[0], grad_ref[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), D[1], GB2D(grid), D[2], GB2D(grid), FB2D(grid),
+        &grid->dx[0], &grid->dx[1]);
+
+    unsigned char mark_D1 = 4, mark_D2 = 3, mark_D3 = 3;
+    LSM2D_UPWIND_HJ_ENO3_LOCAL(
+        grad[0], grad[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), D[1], GB2D(grid), D[2], GB2D(grid),
+        &grid->dx[0], &grid->dx[1],
+        index_x.data(), index_y.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1], &n_lo[2], &n_hi[2],
+        &n_lo[3], &n_hi[3],
+        narrow_band, GB2D(grid), &mark_fb, &mark_D1, &mark_D2, &mark_D3);
+
+    checkResult();
+}
+
+TEST_F(LSMUpwindLocalTest, WENO5_2D) {
+    setUpGrid(2);
+    LSM2D_UPWIND_HJ_WENO5(
+        grad_ref[0], grad_ref[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), FB2D(grid), &grid->dx[0], &grid->dx[1]);
+
+    unsigned char mark_D1 = 4;
+    LSM2D_UPWIND_HJ_WENO5_LOCAL(
+        grad[0], grad[1], GB2D(grid),
+        phi, GB2D(grid), vel[0], vel[1], GB2D(grid),
+        D[0], GB2D(grid), &grid->dx[0], &grid->dx[1],
+        index_x.data(), index_y.data(),
+        &n_lo[0], &n_hi[0], &n_lo[1], &n_hi[1], &n_lo[2], &n_hi[2],
+        &n_lo[3], &n_hi[3],
+        narrow_band, GB2D(grid), &mark_fb, &mark_D1);
+
+    checkResult();
+}
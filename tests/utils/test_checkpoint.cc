@@ -0,0 +1,250 @@
+/*
+ * Test program for incremental checkpointing
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that checkpoints only write the bricks that have
+ * changed, that deltas are consolidated into full checkpoints and that
+ * restoring replays the deltas (ignoring an incomplete one).
+ */
+
+#include <math.h>                   // for sqrt
+#include <stdio.h>                  // for fopen, remove
+#include <unistd.h>                 // for access, getpid
+#include <string>                   // for string, to_string
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_checkpoint.h"
+#include "lsm_grid.h"
+
+/*
+ * Helper functions
+ */
+
+static std::string checkpointName(const char *name) {
+    return testing::TempDir() + "lsm_checkpoint_" + name + "_"
+         + std::to_string(getpid());
+}
+
+static void removeCheckpoint(const std::string &file_base) {
+    remove((file_base + ".full").c_str());
+    remove((file_base + ".delta").c_str());
+}
+
+class LSMCheckpointTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        LSMLIB_REAL x_lo[3] = {-1, -1, -1}, x_hi[3] = {1, 1, 1};
+        grid = createGridSetDx(3, 0.05, x_lo, x_hi, LOW);
+        n = grid->num_gridpts;
+        phi.resize(n);
+        speed.resize(n);
+        const int *dims = grid->grid_dims_ghostbox;
+        for (int k = 0; k < dims[2]; k++) {
+            for (int j = 0; j < dims[1]; j++) {
+                for (int i = 0; i < dims[0]; i++) {
+                    int idx = i + dims[0]*(j + dims[1]*k);
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*grid->dx[0];
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*grid->dx[1];
+                    LSMLIB_REAL z = grid->x_lo_ghostbox[2] + k*grid->dx[2];
+                    phi[idx] = sqrt(x*x + y*y + z*z) - 0.5;
+                    speed[idx] = 1 + 0.1*x;
+                }
+            }
+        }
+        fields[0] = phi.data();
+        fields[1] = speed.data();
+    }
+
+    void TearDown() override { destroyGrid(grid); }
+
+    // moves the interface outwards at grid points with |phi| < width
+    void advance(LSMLIB_REAL width) {
+        for (int p = 0; p < n; p++) {
+            if (fabs(phi[p]) < width) phi[p] -= 0.01;
+        }
+    }
+
+    void expectRestored(const std::string &file_base) {
+        std::vector<LSMLIB_REAL> phi_in(n), speed_in(n);
+        LSMLIB_REAL *fields_in[2] = {phi_in.data(), speed_in.data()};
+        ASSERT_EQ(readLSMCheckpoint(file_base.c_str(), grid, 2, fields_in),
+                  LSM_CHECKPOINT_ERR_SUCCESS);
+        for (int p = 0; p < n; p++) {
+            ASSERT_EQ(phi_in[p], phi[p]) << "p=" << p;
+            ASSERT_EQ(speed_in[p], speed[p]) << "p=" << p;
+        }
+    }
+
+    Grid *grid;
+    int n;
+    std::vector<LSMLIB_REAL> phi, speed;
+    LSMLIB_REAL *fields[2];
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMCheckpointTest, DeltasOnlyWriteChangedBricks) {
+    std::string file_base = checkpointName("delta");
+    removeCheckpoint(file_base);
+    int brick_dims[3] = {8, 8, 8};
+    LSM_Checkpoint *checkpoint = createLSMCheckpoint(file_base.c_str(), grid,
+                                                     2, brick_dims, 10);
+    ASSERT_NE(checkpoint, nullptr);
+
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_was_full, 1);
+    long full_bytes = checkpoint->last_bytes_written;
+    expectRestored(file_base);
+
+    // unchanged state:  empty delta
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_was_full, 0);
+    EXPECT_EQ(checkpoint->last_num_bricks_written, 0);
+
+    // changes near the interface
+    for (int step = 0; step < 3; step++) {
+        advance(0.08);
+        ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+                  LSM_CHECKPOINT_ERR_SUCCESS);
+        EXPECT_EQ(checkpoint->last_was_full, 0);
+        EXPECT_GT(checkpoint->last_num_bricks_written, 0);
+        EXPECT_LT(checkpoint->last_num_bricks_written,
+                  checkpoint->num_bricks/2);
+        EXPECT_LT(checkpoint->last_bytes_written, full_bytes/2);
+        expectRestored(file_base);
+    }
+
+    destroyLSMCheckpoint(checkpoint);
+    removeCheckpoint(file_base);
+}
+
+TEST_F(LSMCheckpointTest, Consolidation) {
+    std::string file_base = checkpointName("consolidation");
+    removeCheckpoint(file_base);
+    std::string delta_file = file_base + ".delta";
+    LSM_Checkpoint *checkpoint = createLSMCheckpoint(file_base.c_str(), grid,
+                                                     2, NULL, 2);
+    ASSERT_NE(checkpoint, nullptr);
+
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    for (int step = 0; step < 2; step++) {
+        advance(0.08);
+        ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+                  LSM_CHECKPOINT_ERR_SUCCESS);
+        EXPECT_EQ(checkpoint->last_was_full, 0);
+    }
+    EXPECT_EQ(access(delta_file.c_str(), F_OK), 0);
+
+    // third delta is consolidated into a full checkpoint
+    advance(0.08);
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_was_full, 1);
+    EXPECT_NE(access(delta_file.c_str(), F_OK), 0);
+    expectRestored(file_base);
+
+    // changes everywhere:  early consolidation
+    for (int p = 0; p < n; p++) speed[p] *= 2;
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_was_full, 1);
+    expectRestored(file_base);
+
+    destroyLSMCheckpoint(checkpoint);
+    removeCheckpoint(file_base);
+}
+
+TEST_F(LSMCheckpointTest, NarrowBandHint) {
+    std::string file_base = checkpointName("band");
+    removeCheckpoint(file_base);
+    int brick_dims[3] = {8, 8, 8};
+    LSM_Checkpoint *checkpoint = createLSMCheckpoint(file_base.c_str(), grid,
+                                                     2, brick_dims, 10);
+    ASSERT_NE(checkpoint, nullptr);
+
+    std::vector<unsigned char> narrow_band(n);
+    for (int p = 0; p < n; p++) narrow_band[p] = (fabs(phi[p]) < 0.1) ? 1 : 0;
+
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, narrow_band.data()),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    advance(0.08);
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, narrow_band.data()),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    int num_band_bricks = checkpoint->last_num_bricks_written;
+    EXPECT_GT(num_band_bricks, 0);
+    expectRestored(file_base);
+
+    // changes outside of the narrow band are not checked for
+    phi[0] += 1;
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, narrow_band.data()),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_num_bricks_written, 0);
+
+    // ... unless no narrow band is given
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    EXPECT_EQ(checkpoint->last_num_bricks_written, 1);
+    expectRestored(file_base);
+
+    destroyLSMCheckpoint(checkpoint);
+    removeCheckpoint(file_base);
+}
+
+TEST_F(LSMCheckpointTest, IncompleteDeltaIsIgnored) {
+    std::string file_base = checkpointName("incomplete");
+    removeCheckpoint(file_base);
+    LSM_Checkpoint *checkpoint = createLSMCheckpoint(file_base.c_str(), grid,
+                                                     2, NULL, 10);
+    ASSERT_NE(checkpoint, nullptr);
+
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+    advance(0.08);
+    ASSERT_EQ(writeLSMCheckpoint(checkpoint, fields, NULL),
+              LSM_CHECKPOINT_ERR_SUCCESS);
+
+    // simulate an interrupted write of the next delta
+    FILE *fp = fopen((file_base + ".delta").c_str(), "ab");
+    ASSERT_NE(fp, nullptr);
+    unsigned int partial[4] = {0x4443534cu, 1, 2, 8};
+    fwrite(partial, sizeof(partial), 1, fp);
+    fclose(fp);
+    expectRestored(file_base);
+
+    // mismatched grid or number of fields
+    std::vector<LSMLIB_REAL> data(n);
+    LSMLIB_REAL *fields_in[2] = {data.data(), data.data()};
+    EXPECT_EQ(readLSMCheckpoint(file_base.c_str(), grid, 1, fields_in),
+              LSM_CHECKPOINT_ERR_INVALID_FILE);
+    LSMLIB_REAL x_lo[3] = {-1, -1, -1}, x_hi[3] = {1, 1, 0.5};
+    Grid *other_grid = createGridSetDx(3, 0.05, x_lo, x_hi, LOW);
+    EXPECT_EQ(readLSMCheckpoint(file_base.c_str(), other_grid, 2, fields_in),
+              LSM_CHECKPOINT_ERR_INVALID_FILE);
+    destroyGrid(other_grid);
+    EXPECT_EQ(readLSMCheckpoint((file_base + "_missing").c_str(), grid, 2,
+                                fields_in),
+              LSM_CHECKPOINT_ERR_FILE_IO);
+
+    destroyLSMCheckpoint(checkpoint);
+    removeCheckpoint(file_base);
+}
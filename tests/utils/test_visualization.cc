@@ -0,0 +1,294 @@
+/*
+ * Test program for visualization output
+ *
+ * ---------------------------------------------------------------------
+ * COPYRIGHT/LICENSE. This file is part of the LSMLIB package. It is
+ * subject to the license terms in the LICENSE file found in the
+ * top-level directory of this distribution. No part of the LSMLIB
+ * package, including this file, may be copied, modified, propagated,
+ * or distributed except according to the terms contained in the
+ * LICENSE file.
+ * ---------------------------------------------------------------------
+ */
+
+/*
+ * This program tests that the VTK and XDMF writers produce files whose
+ * (raw or compressed) data match the fields and that the narrow band
+ * output only contains the requested points.
+ */
+
+#include <math.h>                   // for fabs, sqrt
+#include <stdint.h>                 // for uint64_t, int64_t
+#include <stdio.h>                  // for remove
+#include <string.h>                 // for memcpy
+#include <unistd.h>                 // for getpid
+#include <fstream>                  // for ifstream
+#include <regex>                    // for regex, sregex_iterator
+#include <sstream>                  // for stringstream
+#include <string>                   // for string, to_string
+#include <vector>                   // for vector
+
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+#include <gtest/gtest_pred_impl.h>  // for Test, ASSERT_EQ, EXPECT_EQ, ...
+
+#include "lsmlib_config.h"
+#include "lsm_grid.h"
+#include "lsm_visualization.h"
+
+#ifdef LSMLIB_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/*
+ * Helper functions
+ */
+
+static std::string outputName(const char *name) {
+    return testing::TempDir() + "lsm_visualization_" + name + "_"
+         + std::to_string(getpid());
+}
+
+static std::string readFile(const std::string &file_name) {
+    std::ifstream in(file_name, std::ios::binary);
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+// offsets of the DataArray tags (in order)
+static std::vector<size_t> arrayOffsets(const std::string &contents) {
+    std::string xml = contents.substr(0, contents.find("<AppendedData"));
+    std::regex offset_re("offset=\"([0-9]+)\"");
+    std::vector<size_t> offsets;
+    for (std::sregex_iterator it(xml.begin(), xml.end(), offset_re);
+         it != std::sregex_iterator(); ++it) {
+        offsets.push_back(std::stoul((*it)[1]));
+    }
+    return offsets;
+}
+
+// start of the appended data
+static size_t appendedStart(const std::string &contents) {
+    return contents.find('_', contents.find("<AppendedData")) + 1;
+}
+
+// decodes the array at 'offset' of the appended data
+static std::string decodeArray(const std::string &contents, size_t offset,
+                               bool compressed) {
+    const char *data = contents.data() + appendedStart(contents) + offset;
+    uint64_t header[3];
+    if (!compressed) {
+        memcpy(header, data, sizeof(uint64_t));
+        return std::string(data + sizeof(uint64_t), header[0]);
+    }
+    memcpy(header, data, sizeof(header));
+    std::vector<uint64_t> sizes(header[0]);
+    memcpy(sizes.data(), data + sizeof(header), header[0]*sizeof(uint64_t));
+    const char *block = data + (3 + header[0])*sizeof(uint64_t);
+    std::string result;
+#ifdef LSMLIB_HAVE_ZLIB
+    for (uint64_t b = 0; b < header[0]; b++) {
+        uLongf size = ((b == header[0] - 1) && (header[2] > 0)) ? header[2]
+                                                                : header[1];
+        std::string out(size, '\0');
+        EXPECT_EQ(uncompress((Bytef *) &out[0], &size, (const Bytef *) block,
+                             sizes[b]),
+                  Z_OK);
+        result += out.substr(0, size);
+        block += sizes[b];
+    }
+#endif
+    return result;
+}
+
+template <typename T>
+static std::vector<T> asVector(const std::string &bytes) {
+    std::vector<T> v(bytes.size()/sizeof(T));
+    memcpy(v.data(), bytes.data(), v.size()*sizeof(T));
+    return v;
+}
+
+class LSMVisualizationTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        LSMLIB_REAL x_lo[3] = {-1, -1, -1}, x_hi[3] = {1, 1, 1};
+        grid = createGridSetDx(3, 0.05, x_lo, x_hi, LOW);
+        n = grid->num_gridpts;
+        phi.resize(n);
+        speed.resize(n);
+        const int *dims = grid->grid_dims_ghostbox;
+        for (int k = 0; k < dims[2]; k++) {
+            for (int j = 0; j < dims[1]; j++) {
+                for (int i = 0; i < dims[0]; i++) {
+                    int idx = i + dims[0]*(j + dims[1]*k);
+                    LSMLIB_REAL x = grid->x_lo_ghostbox[0] + i*grid->dx[0];
+                    LSMLIB_REAL y = grid->x_lo_ghostbox[1] + j*grid->dx[1];
+                    LSMLIB_REAL z = grid->x_lo_ghostbox[2] + k*grid->dx[2];
+                    phi[idx] = sqrt(x*x + y*y + z*z) - 0.5;
+                    speed[idx] = 1 + 0.1*x;
+                }
+            }
+        }
+        fields[0] = phi.data();
+        fields[1] = speed.data();
+    }
+
+    void TearDown() override { destroyGrid(grid); }
+
+    void checkImageData(LSM_VisCompression compression) {
+        std::string file_name = outputName("image") + ".vti";
+        ASSERT_EQ(writeVTKImageData(file_name.c_str(), grid, 2, fields,
+                                    names, compression),
+                  LSM_VIS_ERR_SUCCESS);
+        std::string contents = readFile(file_name);
+        remove(file_name.c_str());
+
+        const int *dims = grid->grid_dims_ghostbox;
+        std::string extent = "WholeExtent=\"0 " + std::to_string(dims[0] - 1)
+                           + " 0 " + std::to_string(dims[1] - 1) + " 0 "
+                           + std::to_string(dims[2] - 1) + "\"";
+        EXPECT_NE(contents.find(extent), std::string::npos);
+        EXPECT_NE(contents.find("Name=\"phi\""), std::string::npos);
+        EXPECT_EQ(contents.find("vtkZLibDataCompressor") != std::string::npos,
+                  compression == LSM_VIS_ZLIB);
+
+        std::vector<size_t> offsets = arrayOffsets(contents);
+        ASSERT_EQ(offsets.size(), 2u);
+        for (int f = 0; f < 2; f++) {
+            std::vector<LSMLIB_REAL> data = asVector<LSMLIB_REAL>(
+                decodeArray(contents, offsets[f],
+                            compression == LSM_VIS_ZLIB));
+            ASSERT_EQ(data.size(), (size_t) n);
+            for (int p = 0; p < n; p++) {
+                ASSERT_EQ(data[p], fields[f][p]) << "f=" << f << " p=" << p;
+            }
+        }
+    }
+
+    Grid *grid;
+    int n;
+    std::vector<LSMLIB_REAL> phi, speed;
+    LSMLIB_REAL *fields[2];
+    const char *names[2] = {"phi", "speed"};
+};
+
+/*
+ * Tests
+ */
+
+TEST_F(LSMVisualizationTest, ImageDataRaw) {
+    checkImageData(LSM_VIS_RAW);
+}
+
+TEST_F(LSMVisualizationTest, ImageDataCompressed) {
+#ifdef LSMLIB_HAVE_ZLIB
+    // more than one block per field
+    ASSERT_GT(n*sizeof(LSMLIB_REAL), (size_t) 2*LSM_VIS_BLOCK_SIZE);
+    checkImageData(LSM_VIS_ZLIB);
+#else
+    std::string file_name = outputName("image") + ".vti";
+    EXPECT_EQ(writeVTKImageData(file_name.c_str(), grid, 2, fields, names,
+                                LSM_VIS_ZLIB),
+              LSM_VIS_ERR_COMPRESSION_NOT_SUPPORTED);
+#endif
+}
+
+TEST_F(LSMVisualizationTest, XDMF) {
+    std::string file_base = outputName("xdmf");
+    ASSERT_EQ(writeXDMF(file_base.c_str(), grid, 2, fields, names),
+              LSM_VIS_ERR_SUCCESS);
+    std::string xmf = readFile(file_base + ".xmf");
+    std::vector<LSMLIB_REAL> raw = asVector<LSMLIB_REAL>(
+        readFile(file_base + ".raw"));
+    remove((file_base + ".xmf").c_str());
+    remove((file_base + ".raw").c_str());
+
+    const int *dims = grid->grid_dims_ghostbox;
+    std::string dims_str = std::to_string(dims[2]) + " "
+                         + std::to_string(dims[1]) + " "
+                         + std::to_string(dims[0]);
+    EXPECT_NE(xmf.find("3DCoRectMesh\" Dimensions=\"" + dims_str + "\""),
+              std::string::npos);
+    EXPECT_NE(xmf.find("Seek=\"0\""), std::string::npos);
+    EXPECT_NE(xmf.find("Seek=\"" + std::to_string(n*sizeof(LSMLIB_REAL))
+                       + "\""),
+              std::string::npos);
+
+    ASSERT_EQ(raw.size(), 2*(size_t) n);
+    for (int p = 0; p < n; p++) {
+        ASSERT_EQ(raw[p], phi[p]);
+        ASSERT_EQ(raw[n + p], speed[p]);
+    }
+}
+
+TEST_F(LSMVisualizationTest, NarrowBand) {
+    const int *dims = grid->grid_dims_ghostbox;
+    std::vector<int> index_x, index_y, index_z;
+    for (int k = 0; k < dims[2]; k++) {
+        for (int j = 0; j < dims[1]; j++) {
+            for (int i = 0; i < dims[0]; i++) {
+                if (fabs(phi[i + dims[0]*(j + dims[1]*k)]) < 0.1) {
+                    index_x.push_back(i);
+                    index_y.push_back(j);
+                    index_z.push_back(k);
+                }
+            }
+        }
+    }
+    int num_pts = (int) index_x.size();
+    ASSERT_GT(num_pts, 0);
+    ASSERT_LT(num_pts, n/4);
+
+    LSM_VisCompression compressions[2] = {LSM_VIS_RAW, LSM_VIS_ZLIB};
+    for (LSM_VisCompression compression : compressions) {
+#ifndef LSMLIB_HAVE_ZLIB
+        if (compression == LSM_VIS_ZLIB) continue;
+#endif
+        std::string file_name = outputName("band") + ".vtu";
+        ASSERT_EQ(writeNarrowBandVTU(file_name.c_str(), grid, num_pts,
+                                     index_x.data(), index_y.data(),
+                                     index_z.data(), 2, fields, names,
+                                     compression),
+                  LSM_VIS_ERR_SUCCESS);
+        std::string contents = readFile(file_name);
+        remove(file_name.c_str());
+        bool compressed = (compression == LSM_VIS_ZLIB);
+
+        std::string num_str = std::to_string(num_pts);
+        EXPECT_NE(contents.find("NumberOfPoints=\"" + num_str
+                                + "\" NumberOfCells=\"" + num_str + "\""),
+                  std::string::npos);
+
+        // phi, speed, Points, connectivity, offsets, types
+        std::vector<size_t> offsets = arrayOffsets(contents);
+        ASSERT_EQ(offsets.size(), 6u);
+        std::vector<LSMLIB_REAL> phi_out = asVector<LSMLIB_REAL>(
+            decodeArray(contents, offsets[0], compressed));
+        std::vector<LSMLIB_REAL> points = asVector<LSMLIB_REAL>(
+            decodeArray(contents, offsets[2], compressed));
+        std::vector<int64_t> cell_offsets = asVector<int64_t>(
+            decodeArray(contents, offsets[4], compressed));
+        std::string types = decodeArray(contents, offsets[5], compressed);
+        ASSERT_EQ(phi_out.size(), (size_t) num_pts);
+        ASSERT_EQ(points.size(), 3*(size_t) num_pts);
+        ASSERT_EQ(cell_offsets.size(), (size_t) num_pts);
+        ASSERT_EQ(types.size(), (size_t) num_pts);
+        for (int p = 0; p < num_pts; p++) {
+            int idx = index_x[p] + dims[0]*(index_y[p] + dims[1]*index_z[p]);
+            ASSERT_EQ(phi_out[p], phi[idx]);
+            LSMLIB_REAL x = points[3*p], y = points[3*p+1], z = points[3*p+2];
+            EXPECT_NEAR(sqrt(x*x + y*y + z*z) - 0.5, phi[idx], 1e-12);
+            EXPECT_EQ(cell_offsets[p], p + 1);
+            EXPECT_EQ(types[p], 1);
+        }
+    }
+
+    // out of range indices
+    index_x[0] = dims[0];
+    EXPECT_EQ(writeNarrowBandVTU(outputName("band").c_str(), grid, num_pts,
+                                 index_x.data(), index_y.data(),
+                                 index_z.data(), 2, fields, names,
+                                 LSM_VIS_RAW),
+              LSM_VIS_ERR_INVALID_ARGUMENT);
+}